@@ -120,6 +120,55 @@ class CommandBufferPushDescriptorSetOpConversion
   mutable IREE::VM::ImportOp importOp;
 };
 
+class CommandBufferPushDescriptorSetIndirectOpConversion
+    : public OpConversionPattern<
+          IREE::HAL::CommandBufferPushDescriptorSetIndirectOp> {
+ public:
+  CommandBufferPushDescriptorSetIndirectOpConversion(
+      MLIRContext *context, SymbolTable &importSymbols,
+      TypeConverter &typeConverter, StringRef importName)
+      : OpConversionPattern(context) {
+    importOp = importSymbols.lookup<IREE::VM::ImportOp>(importName);
+    assert(importOp);
+  }
+
+  LogicalResult matchAndRewrite(
+      IREE::HAL::CommandBufferPushDescriptorSetIndirectOp op, OpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const override {
+    auto importType = importOp.getFunctionType();
+
+    SmallVector<Value, 8> callOperands = {
+        adaptor.command_buffer(),
+        adaptor.executable_layout(),
+        adaptor.set(),
+    };
+    SmallVector<int16_t, 5> segmentSizes = {
+        /*command_buffer=*/-1,
+        /*executable_layout=*/-1,
+        /*set=*/-1,
+        /*bindings=*/
+        static_cast<int16_t>(adaptor.binding_ordinals().size()),
+    };
+    for (size_t i = 0; i < adaptor.binding_ordinals().size(); ++i) {
+      callOperands.push_back(adaptor.binding_ordinals()[i]);
+      callOperands.push_back(adaptor.binding_slots()[i]);
+      callOperands.push_back(castToImportType(adaptor.binding_offsets()[i],
+                                              rewriter.getI64Type(), rewriter));
+      callOperands.push_back(castToImportType(adaptor.binding_lengths()[i],
+                                              rewriter.getI64Type(), rewriter));
+    }
+
+    auto callOp = rewriter.replaceOpWithNewOp<IREE::VM::CallVariadicOp>(
+        op, SymbolRefAttr::get(importOp), importType.getResults(), segmentSizes,
+        importType.getInputs(), callOperands);
+    copyImportAttrs(importOp, callOp);
+    return success();
+  }
+
+ private:
+  mutable IREE::VM::ImportOp importOp;
+};
+
 }  // namespace
 
 void populateHALCommandBufferToVMPatterns(MLIRContext *context,
@@ -128,6 +177,10 @@ void populateHALCommandBufferToVMPatterns(MLIRContext *context,
                                           RewritePatternSet &patterns) {
   patterns.insert<VMImportOpConversion<IREE::HAL::CommandBufferCreateOp>>(
       context, importSymbols, typeConverter, "hal.command_buffer.create");
+  patterns
+      .insert<VMImportOpConversion<IREE::HAL::CommandBufferCreateReusableOp>>(
+          context, importSymbols, typeConverter,
+          "hal.command_buffer.create.reusable");
   patterns.insert<VMImportOpConversion<IREE::HAL::CommandBufferBeginOp>>(
       context, importSymbols, typeConverter, "hal.command_buffer.begin");
   patterns.insert<VMImportOpConversion<IREE::HAL::CommandBufferEndOp>>(
@@ -155,6 +208,9 @@ void populateHALCommandBufferToVMPatterns(MLIRContext *context,
   patterns.insert<CommandBufferPushDescriptorSetOpConversion>(
       context, importSymbols, typeConverter,
       "hal.command_buffer.push_descriptor_set");
+  patterns.insert<CommandBufferPushDescriptorSetIndirectOpConversion>(
+      context, importSymbols, typeConverter,
+      "hal.command_buffer.push_descriptor_set.indirect");
   patterns.insert<
       VMImportOpConversion<IREE::HAL::CommandBufferBindDescriptorSetOp>>(
       context, importSymbols, typeConverter,
@@ -19,6 +19,8 @@ void populateHALExperimentalToVMPatterns(MLIRContext *context,
       context, importSymbols, typeConverter, "hal.ex.shared_device");
   patterns.insert<VMImportOpConversion<IREE::HAL::ExSubmitAndWaitOp>>(
       context, importSymbols, typeConverter, "hal.ex.submit_and_wait");
+  patterns.insert<VMImportOpConversion<IREE::HAL::ExSubmitAndWaitIndirectOp>>(
+      context, importSymbols, typeConverter, "hal.ex.submit_and_wait.indirect");
 }
 
 }  // namespace iree_compiler
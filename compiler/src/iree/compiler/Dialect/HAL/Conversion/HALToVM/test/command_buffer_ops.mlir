@@ -9,6 +9,16 @@ func.func @command_buffer_create(%arg0: !hal.device) {
 
 // -----
 
+// CHECK-LABEL: @command_buffer_create_reusable
+func.func @command_buffer_create_reusable(%arg0: !hal.device) {
+  %c4 = arith.constant 4 : index
+  // CHECK: %ref = vm.call @hal.command_buffer.create.reusable(%arg0, %c3, %c4) : (!vm.ref<!hal.device>, i32, i32) -> !vm.ref<!hal.command_buffer>
+  %cmd = hal.command_buffer.create.reusable device(%arg0 : !hal.device) categories("Transfer|Dispatch") bindings(%c4) : !hal.command_buffer
+  return
+}
+
+// -----
+
 // CHECK-LABEL: @command_buffer_begin_end
 func.func @command_buffer_begin_end(%arg0: !hal.command_buffer) {
   // CHECK: vm.call @hal.command_buffer.begin(%arg0) : (!vm.ref<!hal.command_buffer>) -> ()
@@ -109,6 +119,28 @@ func.func @command_buffer_copy_buffer(
 
 // -----
 
+// CHECK-LABEL: @command_buffer_push_descriptor_set_indirect
+func.func @command_buffer_push_descriptor_set_indirect(
+  %arg0: !hal.command_buffer,
+  %arg1: !hal.executable_layout
+) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c4 = arith.constant 4 : index
+  %c4096 = arith.constant 4096 : index
+  // CHECK: vm.call.variadic @hal.command_buffer.push_descriptor_set.indirect
+  // CHECK-SAME: : (!vm.ref<!hal.command_buffer>, !vm.ref<!hal.executable_layout>, i32, tuple<i32, i32, i64, i64> ...)
+  hal.command_buffer.push_descriptor_set.indirect<%arg0 : !hal.command_buffer>
+      layout(%arg1 : !hal.executable_layout)[%c0]
+      ordinals([%c0, %c1])
+      slots([%c1, %c0])
+      offsets([%c4096, %c0])
+      lengths([%c4, %c4])
+  return
+}
+
+// -----
+
 // CHECK-LABEL: @command_buffer_bind_descriptor_set
 func.func @command_buffer_bind_descriptor_set(
   %arg0: !hal.command_buffer,
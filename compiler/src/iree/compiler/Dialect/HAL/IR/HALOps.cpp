@@ -431,6 +431,15 @@ void CommandBufferCreateOp::getAsmResultNames(
   setNameFn(result(), "cmd");
 }
 
+//===----------------------------------------------------------------------===//
+// hal.command_buffer.create.reusable
+//===----------------------------------------------------------------------===//
+
+void CommandBufferCreateReusableOp::getAsmResultNames(
+    function_ref<void(Value, StringRef)> setNameFn) {
+  setNameFn(result(), "cmd");
+}
+
 //===----------------------------------------------------------------------===//
 // hal.command_buffer.push_descriptor_set
 //===----------------------------------------------------------------------===//
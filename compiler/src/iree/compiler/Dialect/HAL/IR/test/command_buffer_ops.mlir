@@ -15,6 +15,23 @@ func.func @command_buffer_create(%device: !hal.device) {
 
 // -----
 
+// CHECK-LABEL: @command_buffer_create_reusable
+//  CHECK-SAME: (%[[DEVICE:.+]]: !hal.device)
+func.func @command_buffer_create_reusable(%device: !hal.device) {
+  // CHECK: %[[CAPACITY:.+]] = arith.constant 4
+  %capacity = arith.constant 4 : index
+  //      CHECK: %cmd = hal.command_buffer.create.reusable
+  // CHECK-SAME:   device(%[[DEVICE]] : !hal.device)
+  // CHECK-SAME:   categories("Transfer|Dispatch")
+  // CHECK-SAME:   bindings(%[[CAPACITY]]) : !hal.command_buffer
+  %cmd = hal.command_buffer.create.reusable device(%device : !hal.device)
+                                        categories("Transfer|Dispatch")
+                                          bindings(%capacity) : !hal.command_buffer
+  return
+}
+
+// -----
+
 // CHECK-LABEL: @command_buffer_begin_end
 //  CHECK-SAME: (%[[CMD:.+]]: !hal.command_buffer)
 func.func @command_buffer_begin_end(%cmd: !hal.command_buffer) {
@@ -101,6 +118,38 @@ func.func @command_buffer_copy_buffer(
 
 // -----
 
+// CHECK-LABEL: @command_buffer_push_descriptor_set_indirect
+//  CHECK-SAME: (%[[CMD:.+]]: !hal.command_buffer,
+//  CHECK-SAME: %[[LAYOUT:.+]]: !hal.executable_layout,
+//  CHECK-SAME: %[[OFFSET:.+]]: index,
+//  CHECK-SAME: %[[LENGTH:.+]]: index)
+func.func @command_buffer_push_descriptor_set_indirect(
+    %cmd: !hal.command_buffer,
+    %layout: !hal.executable_layout,
+    %offset: index,
+    %length: index
+  ) {
+  // CHECK-DAG: %[[C0:.+]] = arith.constant 0
+  %c0 = arith.constant 0 : index
+  // CHECK-DAG: %[[C1:.+]] = arith.constant 1
+  %c1 = arith.constant 1 : index
+  //      CHECK: hal.command_buffer.push_descriptor_set.indirect<%[[CMD]] : !hal.command_buffer>
+  // CHECK-SAME:   layout(%[[LAYOUT]] : !hal.executable_layout)[%[[C0]]]
+  // CHECK-SAME:   ordinals([%[[C0]], %[[C1]]])
+  // CHECK-SAME:   slots([%[[C1]], %[[C0]]])
+  // CHECK-SAME:   offsets([%[[OFFSET]], %[[C0]]])
+  // CHECK-SAME:   lengths([%[[LENGTH]], %[[LENGTH]]])
+  hal.command_buffer.push_descriptor_set.indirect<%cmd : !hal.command_buffer>
+      layout(%layout : !hal.executable_layout)[%c0]
+      ordinals([%c0, %c1])
+      slots([%c1, %c0])
+      offsets([%offset, %c0])
+      lengths([%length, %length])
+  return
+}
+
+// -----
+
 // CHECK-LABEL: @command_buffer_bind_descriptor_set
 //  CHECK-SAME: (%[[CMD:.+]]: !hal.command_buffer,
 //  CHECK-SAME: %[[LAYOUT:.+]]: !hal.executable_layout,
@@ -17,3 +17,15 @@ func.func @submit_and_wait() {
   hal.ex.submit_and_wait %0, %1
   return
 }
+
+// -----
+
+// CHECK-LABEL: @submit_and_wait_indirect
+func.func @submit_and_wait_indirect() {
+  %0 = "test_hal.device"() : () -> !hal.device
+  %1 = "test_hal.command_buffer"() : () -> !hal.command_buffer
+  %2 = "test_hal.buffer"() : () -> !hal.buffer
+  // CHECK: hal.ex.submit_and_wait.indirect %0, %1 bindings([%2, %2]) : !hal.buffer, !hal.buffer
+  hal.ex.submit_and_wait.indirect %0, %1 bindings([%2, %2]) : !hal.buffer, !hal.buffer
+  return
+}
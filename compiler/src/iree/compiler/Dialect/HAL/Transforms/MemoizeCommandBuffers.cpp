@@ -0,0 +1,317 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <string>
+#include <utility>
+
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "iree/compiler/Dialect/HAL/Transforms/Passes.h"
+#include "iree/compiler/Dialect/Util/IR/UtilDialect.h"
+#include "iree/compiler/Dialect/Util/IR/UtilOps.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SetVector.h"
+#include "mlir/Dialect/Arithmetic/IR/Arithmetic.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BlockAndValueMapping.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace HAL {
+
+namespace {
+
+// Maximum number of unique buffers a memoized command buffer may reference.
+// Must match IREE_HAL_MODULE_MAX_BINDING_TABLE_COUNT in the runtime HAL module.
+static constexpr size_t kMaxBindingTableCount = 256;
+
+// Maximum depth of the def-use chain walked when proving a value invariant.
+// Values computed from longer chains are treated as dynamic.
+static constexpr int kMaxInvariantDepth = 8;
+
+// A command buffer that is created, recorded, and submitted within a single
+// block using only values that are invariant across invocations (except for
+// the buffers bound, which are sourced from a binding table at submission).
+struct MemoizableCommandBuffer {
+  IREE::HAL::CommandBufferCreateOp createOp;
+  // All ops recording into the command buffer in program order.
+  SmallVector<Operation *> recordingOps;
+  // The single submission of the command buffer.
+  IREE::HAL::ExSubmitAndWaitOp submitOp;
+  // Unique buffers bound by the recording ops; indices are binding slots.
+  llvm::SetVector<Value> bindingBuffers;
+};
+
+// Caches whether values can be recomputed once at module initialization.
+class InvariantValueAnalysis {
+ public:
+  explicit InvariantValueAnalysis(SymbolTableCollection &symbolTables)
+      : symbolTables(symbolTables) {}
+
+  // Returns true if |value| is the same on every invocation of the function.
+  // Invariant values are constants, loads of immutable globals, the shared
+  // device, and side-effect free ops consuming only invariant values.
+  bool isInvariant(Value value, int depth = 0) {
+    auto it = cache.find(value);
+    if (it != cache.end()) return it->second;
+    bool result = computeInvariance(value, depth);
+    cache[value] = result;
+    return result;
+  }
+
+ private:
+  bool computeInvariance(Value value, int depth) {
+    if (depth > kMaxInvariantDepth) return false;
+    auto *definingOp = value.getDefiningOp();
+    if (!definingOp) return false;  // block arguments vary per invocation
+    if (matchPattern(value, m_Constant())) return true;
+    if (isa<IREE::HAL::ExSharedDeviceOp>(definingOp)) return true;
+    if (auto loadOp = dyn_cast<IREE::Util::GlobalLoadOp>(definingOp)) {
+      auto globalOp = loadOp.getGlobalOp(symbolTables);
+      return globalOp && !globalOp.isMutable();
+    }
+    if (definingOp->getNumRegions() != 0 ||
+        !MemoryEffectOpInterface::hasNoEffect(definingOp)) {
+      return false;
+    }
+    return llvm::all_of(definingOp->getOperands(), [&](Value operand) {
+      return isInvariant(operand, depth + 1);
+    });
+  }
+
+  SymbolTableCollection &symbolTables;
+  DenseMap<Value, bool> cache;
+};
+
+// Returns a populated MemoizableCommandBuffer if the command buffer produced
+// by |createOp| can be recorded once at initialization time.
+static Optional<MemoizableCommandBuffer> analyzeCommandBuffer(
+    IREE::HAL::CommandBufferCreateOp createOp,
+    InvariantValueAnalysis &invariantValues) {
+  MemoizableCommandBuffer result;
+  result.createOp = createOp;
+  if (!invariantValues.isInvariant(createOp.device())) return llvm::None;
+
+  // Walk ops in program order so that recording order is preserved.
+  auto commandBuffer = createOp.result();
+  auto *block = createOp->getBlock();
+  unsigned useCount = 0;
+  bool hasBegin = false;
+  bool hasEnd = false;
+  for (auto &op : llvm::make_range(std::next(Block::iterator(createOp)),
+                                   block->end())) {
+    if (!llvm::is_contained(op.getOperands(), commandBuffer)) continue;
+    ++useCount;
+    if (result.submitOp) return llvm::None;  // used after submission
+    if (auto submitOp = dyn_cast<IREE::HAL::ExSubmitAndWaitOp>(op)) {
+      if (!hasEnd) return llvm::None;
+      result.submitOp = submitOp;
+      continue;
+    }
+    if (isa<IREE::HAL::CommandBufferBeginOp>(op)) {
+      if (hasBegin) return llvm::None;
+      hasBegin = true;
+    } else if (isa<IREE::HAL::CommandBufferEndOp>(op)) {
+      if (!hasBegin || hasEnd) return llvm::None;
+      hasEnd = true;
+    } else if (!isa<IREE::HAL::CommandBufferExecutionBarrierOp,
+                    IREE::HAL::CommandBufferPushConstantsOp,
+                    IREE::HAL::CommandBufferPushDescriptorSetOp,
+                    IREE::HAL::CommandBufferDispatchOp,
+                    IREE::HAL::CommandBufferBeginDebugGroupOp,
+                    IREE::HAL::CommandBufferEndDebugGroupOp>(op)) {
+      // Fills/copies/indirect dispatches/etc reference buffers directly and
+      // can't be routed through the binding table.
+      return llvm::None;
+    }
+
+    // Buffers bound via descriptor sets move into the binding table and all
+    // other operands must be recomputable at initialization time.
+    SmallPtrSet<Value, 4> bindingBuffers;
+    if (auto pushOp =
+            dyn_cast<IREE::HAL::CommandBufferPushDescriptorSetOp>(op)) {
+      for (auto buffer : pushOp.binding_buffers()) {
+        bindingBuffers.insert(buffer);
+        result.bindingBuffers.insert(buffer);
+      }
+    }
+    for (auto operand : op.getOperands()) {
+      if (operand == commandBuffer || bindingBuffers.contains(operand)) {
+        continue;
+      }
+      if (!invariantValues.isInvariant(operand)) return llvm::None;
+    }
+    result.recordingOps.push_back(&op);
+  }
+
+  // All uses must have been accounted for within the block; any other use
+  // (such as a branch argument or call) could observe the command buffer.
+  if (!result.submitOp) return llvm::None;
+  if (!commandBuffer.hasNUses(useCount)) return llvm::None;
+  if (result.bindingBuffers.size() > kMaxBindingTableCount) return llvm::None;
+  return result;
+}
+
+// Clones the invariant |value| and its producers into the insertion point of
+// |builder|, reusing any values already mapped.
+static Value cloneInvariantValue(Value value, OpBuilder &builder,
+                                 BlockAndValueMapping &mapping) {
+  if (auto mappedValue = mapping.lookupOrNull(value)) return mappedValue;
+  auto *definingOp = value.getDefiningOp();
+  for (auto operand : definingOp->getOperands()) {
+    cloneInvariantValue(operand, builder, mapping);
+  }
+  builder.clone(*definingOp, mapping);
+  return mapping.lookup(value);
+}
+
+// Records |commandBuffer| into a global reusable command buffer initialized
+// at module load and replaces the original with an indirect submission.
+// |globalName| is uniqued in |symbolTable| if it conflicts with another symbol.
+static void memoizeCommandBuffer(MemoizableCommandBuffer &commandBuffer,
+                                 StringRef globalName, SymbolTable &symbolTable,
+                                 OpBuilder &moduleBuilder) {
+  auto createOp = commandBuffer.createOp;
+  auto loc = createOp.getLoc();
+  auto commandBufferType = createOp.result().getType();
+
+  auto globalOp = moduleBuilder.create<IREE::Util::GlobalOp>(
+      loc, globalName, /*isMutable=*/false, commandBufferType);
+  globalOp.setPrivate();
+  symbolTable.insert(globalOp);
+
+  // Record the command buffer in an initializer. Any invariant values used by
+  // the original recording are recomputed there.
+  auto initializerOp = moduleBuilder.create<IREE::Util::InitializerOp>(loc);
+  auto initBuilder = OpBuilder::atBlockBegin(initializerOp.addEntryBlock());
+  BlockAndValueMapping mapping;
+  auto device = cloneInvariantValue(createOp.device(), initBuilder, mapping);
+  auto bindingCapacity = initBuilder.create<arith::ConstantIndexOp>(
+      loc, commandBuffer.bindingBuffers.size());
+  auto reusableOp =
+      initBuilder.create<IREE::HAL::CommandBufferCreateReusableOp>(
+          loc, commandBufferType, device, createOp.command_categoriesAttr(),
+          bindingCapacity);
+  mapping.map(createOp.result(), reusableOp.result());
+  auto lookupValues = [&](ValueRange values) {
+    return llvm::to_vector(llvm::map_range(
+        values, [&](Value value) { return mapping.lookup(value); }));
+  };
+  for (auto *op : commandBuffer.recordingOps) {
+    auto pushOp = dyn_cast<IREE::HAL::CommandBufferPushDescriptorSetOp>(op);
+    for (auto operand : op->getOperands()) {
+      if (pushOp && llvm::is_contained(pushOp.binding_buffers(), operand)) {
+        continue;
+      }
+      cloneInvariantValue(operand, initBuilder, mapping);
+    }
+    if (!pushOp) {
+      initBuilder.clone(*op, mapping);
+      continue;
+    }
+    SmallVector<Value> bindingSlots;
+    for (auto buffer : pushOp.binding_buffers()) {
+      auto bindingSlot = llvm::find(commandBuffer.bindingBuffers, buffer) -
+                         commandBuffer.bindingBuffers.begin();
+      bindingSlots.push_back(initBuilder.create<arith::ConstantIndexOp>(
+          pushOp.getLoc(), bindingSlot));
+    }
+    initBuilder.create<IREE::HAL::CommandBufferPushDescriptorSetIndirectOp>(
+        pushOp.getLoc(), mapping.lookup(pushOp.command_buffer()),
+        mapping.lookup(pushOp.executable_layout()),
+        mapping.lookup(pushOp.set()),
+        lookupValues(pushOp.binding_ordinals()), bindingSlots,
+        lookupValues(pushOp.binding_offsets()),
+        lookupValues(pushOp.binding_lengths()));
+  }
+  initBuilder.create<IREE::Util::GlobalStoreOp>(loc, reusableOp.result(),
+                                                globalOp.getName());
+  initBuilder.create<IREE::Util::InitializerReturnOp>(loc);
+
+  // Submit the memoized command buffer with the buffers of this invocation.
+  auto submitOp = commandBuffer.submitOp;
+  OpBuilder builder(submitOp);
+  auto loadOp = builder.create<IREE::Util::GlobalLoadOp>(
+      submitOp.getLoc(), globalOp.type(), globalOp.getName());
+  builder.create<IREE::HAL::ExSubmitAndWaitIndirectOp>(
+      submitOp.getLoc(), submitOp.device(), loadOp.result(),
+      commandBuffer.bindingBuffers.getArrayRef());
+  submitOp.erase();
+  for (auto *op : llvm::reverse(commandBuffer.recordingOps)) op->erase();
+  createOp.erase();
+}
+
+}  // namespace
+
+// Finds command buffers that are recorded identically on every invocation and
+// records them once at initialization time. Only the buffers bound change
+// between invocations and those are provided as a binding table when the
+// memoized command buffer is submitted. The recordings are immutable after
+// initialization and may be shared by forked contexts as each submission binds
+// its own device command buffer.
+class MemoizeCommandBuffersPass
+    : public PassWrapper<MemoizeCommandBuffersPass, OperationPass<ModuleOp>> {
+ public:
+  StringRef getArgument() const override {
+    return "iree-hal-memoize-command-buffers";
+  }
+
+  StringRef getDescription() const override {
+    return "Records invariant command buffers once at initialization and "
+           "replays them with per-invocation binding tables";
+  }
+
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<arith::ArithmeticDialect>();
+    registry.insert<IREE::Util::UtilDialect>();
+  }
+
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+    SymbolTableCollection symbolTables;
+
+    // Command buffers recorded in initializers only execute once and gain
+    // nothing from memoization so only functions are considered.
+    SmallVector<MemoizableCommandBuffer> commandBuffers;
+    for (auto funcOp : moduleOp.getOps<func::FuncOp>()) {
+      InvariantValueAnalysis invariantValues(symbolTables);
+      funcOp.walk([&](IREE::HAL::CommandBufferCreateOp createOp) {
+        if (auto commandBuffer =
+                analyzeCommandBuffer(createOp, invariantValues)) {
+          commandBuffers.push_back(std::move(commandBuffer.getValue()));
+        }
+      });
+    }
+
+    // Initializers are appended to the end of the module so that all globals
+    // they depend on (executables, layouts, etc) have been initialized first.
+    SymbolTable symbolTable(moduleOp);
+    auto moduleBuilder = OpBuilder::atBlockEnd(moduleOp.getBody());
+    for (auto commandBuffer : llvm::enumerate(commandBuffers)) {
+      memoizeCommandBuffer(
+          commandBuffer.value(),
+          "_memoized_command_buffer_" + std::to_string(commandBuffer.index()),
+          symbolTable, moduleBuilder);
+    }
+  }
+};
+
+std::unique_ptr<OperationPass<ModuleOp>> createMemoizeCommandBuffersPass() {
+  return std::make_unique<MemoizeCommandBuffersPass>();
+}
+
+static PassRegistration<MemoizeCommandBuffersPass> pass;
+
+}  // namespace HAL
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -47,6 +47,13 @@ static llvm::cl::opt<unsigned> benchmarkDispatchRepeatCount{
         "meant for command buffers having linear dispatch structures."),
     llvm::cl::init(1)};
 
+static llvm::cl::opt<bool> memoizeCommandBuffers{
+    "iree-hal-memoize-command-buffers",
+    llvm::cl::desc(
+        "Records command buffers that are invariant across invocations once at "
+        "initialization time and replays them with per-invocation bindings."),
+    llvm::cl::init(true)};
+
 }  // namespace
 
 using FunctionLikeNest = MultiOpNest<func::FuncOp, IREE::Util::InitializerOp>;
@@ -183,6 +190,14 @@ void buildHALTransformPassPipeline(OpPassManager &passManager,
   // Elide redundant command buffer state ops created during conversion.
   FunctionLikeNest(passManager).addPass(createElideRedundantCommandsPass);
 
+  // Hoist invariant command buffer recording into initializers. This must
+  // happen after elision so that the memoized command buffers are minimal and
+  // before initializers are combined so that they are folded in with the
+  // resource caches they depend on.
+  if (memoizeCommandBuffers) {
+    passManager.addPass(createMemoizeCommandBuffersPass());
+  }
+
   // Fixup workgroup count calculations that may have used the affine dialect.
   // Kind of random here but can happen if the benchmarking code does things.
   passManager.addPass(createLowerAffinePass());
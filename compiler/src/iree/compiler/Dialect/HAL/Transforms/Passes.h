@@ -67,6 +67,11 @@ std::unique_ptr<OperationPass<void>> createInlineDeviceSwitchesPass();
 // Finds hal.device.query ops and creates variables initialized on startup.
 std::unique_ptr<OperationPass<mlir::ModuleOp>> createMemoizeDeviceQueriesPass();
 
+// Records command buffers that are invariant across invocations once at
+// initialization time and replays them with per-invocation binding tables.
+std::unique_ptr<OperationPass<mlir::ModuleOp>>
+createMemoizeCommandBuffersPass();
+
 //===----------------------------------------------------------------------===//
 // Executable translation
 //===----------------------------------------------------------------------===//
@@ -160,6 +165,7 @@ inline void registerHALPasses() {
   createLinkTargetExecutablesPass("");
   createMaterializeInterfacesPass();
   createMaterializeResourceCachesPass(targetOptions);
+  createMemoizeCommandBuffersPass();
   createMemoizeDeviceQueriesPass();
   createResolveExportOrdinalsPass();
   createSerializeExecutablesPass();
@@ -0,0 +1,152 @@
+// RUN: iree-opt --split-input-file --iree-hal-memoize-command-buffers --cse %s | FileCheck %s
+
+util.global private @_executable_layout : !hal.executable_layout
+util.global private @_executable : !hal.executable
+
+// CHECK-LABEL: func.func @invariant_dispatch
+//  CHECK-SAME: (%[[BUFFER0:.+]]: !hal.buffer, %[[BUFFER1:.+]]: !hal.buffer)
+func.func @invariant_dispatch(%buffer0: !hal.buffer, %buffer1: !hal.buffer) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c2 = arith.constant 2 : index
+  %c4 = arith.constant 4 : index
+  %c128 = arith.constant 128 : index
+  //      CHECK: %[[DEVICE:.+]] = hal.ex.shared_device
+  %device = hal.ex.shared_device : !hal.device
+  %layout = util.global.load @_executable_layout : !hal.executable_layout
+  %executable = util.global.load @_executable : !hal.executable
+  // CHECK-NOT: hal.command_buffer.create
+  %cmd = hal.command_buffer.create device(%device : !hal.device)
+                                     mode(OneShot)
+                               categories("Transfer|Dispatch") : !hal.command_buffer
+  hal.command_buffer.begin<%cmd : !hal.command_buffer>
+  hal.command_buffer.push_descriptor_set<%cmd : !hal.command_buffer>
+      layout(%layout : !hal.executable_layout)[%c0]
+      bindings([
+        %c0 = (%buffer0 : !hal.buffer)[%c0, %c128],
+        %c1 = (%buffer1 : !hal.buffer)[%c0, %c128],
+        %c2 = (%buffer0 : !hal.buffer)[%c128, %c128]
+      ])
+  hal.command_buffer.dispatch<%cmd : !hal.command_buffer>
+      target(%executable : !hal.executable)[0]
+      workgroups([%c4, %c1, %c1])
+  hal.command_buffer.execution_barrier<%cmd : !hal.command_buffer>
+      source("Dispatch|CommandRetire")
+      target("CommandIssue|Dispatch")
+      flags("None")
+  hal.command_buffer.end<%cmd : !hal.command_buffer>
+  //      CHECK: %[[CMD:.+]] = util.global.load @_memoized_command_buffer_0 : !hal.command_buffer
+  // CHECK-NEXT: hal.ex.submit_and_wait.indirect %[[DEVICE]], %[[CMD]]
+  // CHECK-SAME:   bindings([%[[BUFFER0]], %[[BUFFER1]]])
+  hal.ex.submit_and_wait %device, %cmd
+  return
+}
+
+//      CHECK: util.global private @_memoized_command_buffer_0 : !hal.command_buffer
+// CHECK-NEXT: util.initializer {
+//  CHECK-DAG:   %[[INIT_DEVICE:.+]] = hal.ex.shared_device
+//  CHECK-DAG:   %[[CAPACITY:.+]] = arith.constant 2 : index
+//      CHECK:   %[[INIT_CMD:.+]] = hal.command_buffer.create.reusable
+// CHECK-SAME:       device(%[[INIT_DEVICE]] : !hal.device)
+// CHECK-SAME:       categories("Transfer|Dispatch")
+// CHECK-SAME:       bindings(%[[CAPACITY]])
+//      CHECK:   hal.command_buffer.begin<%[[INIT_CMD]] : !hal.command_buffer>
+//  CHECK-DAG:   %[[LAYOUT:.+]] = util.global.load @_executable_layout
+//  CHECK-DAG:   %[[C0:.+]] = arith.constant 0 : index
+//  CHECK-DAG:   %[[C1:.+]] = arith.constant 1 : index
+//      CHECK:   hal.command_buffer.push_descriptor_set.indirect<%[[INIT_CMD]] : !hal.command_buffer>
+// CHECK-SAME:       layout(%[[LAYOUT]] : !hal.executable_layout)
+// CHECK-SAME:       slots([%[[C0]], %[[C1]], %[[C0]]])
+//      CHECK:   %[[EXECUTABLE:.+]] = util.global.load @_executable
+//      CHECK:   hal.command_buffer.dispatch<%[[INIT_CMD]] : !hal.command_buffer>
+// CHECK-SAME:       target(%[[EXECUTABLE]] : !hal.executable)[0]
+//      CHECK:   hal.command_buffer.execution_barrier<%[[INIT_CMD]] : !hal.command_buffer>
+//      CHECK:   hal.command_buffer.end<%[[INIT_CMD]] : !hal.command_buffer>
+//      CHECK:   util.global.store %[[INIT_CMD]], @_memoized_command_buffer_0 : !hal.command_buffer
+//      CHECK:   util.initializer.return
+
+// -----
+
+// Command buffers recording values that change per invocation (here the
+// workgroup count) must not be memoized.
+
+util.global private @_executable : !hal.executable
+
+// CHECK-LABEL: func.func @dynamic_workgroup_count
+func.func @dynamic_workgroup_count(%x: index) {
+  %c1 = arith.constant 1 : index
+  %device = hal.ex.shared_device : !hal.device
+  %executable = util.global.load @_executable : !hal.executable
+  // CHECK: hal.command_buffer.create
+  %cmd = hal.command_buffer.create device(%device : !hal.device)
+                                     mode(OneShot)
+                               categories("Transfer|Dispatch") : !hal.command_buffer
+  hal.command_buffer.begin<%cmd : !hal.command_buffer>
+  hal.command_buffer.dispatch<%cmd : !hal.command_buffer>
+      target(%executable : !hal.executable)[0]
+      workgroups([%x, %c1, %c1])
+  hal.command_buffer.end<%cmd : !hal.command_buffer>
+  // CHECK: hal.ex.submit_and_wait %
+  hal.ex.submit_and_wait %device, %cmd
+  return
+}
+
+// CHECK-NOT: util.initializer
+
+// -----
+
+// Buffers referenced outside of descriptor sets can't be sourced from the
+// binding table and prevent memoization.
+
+// CHECK-LABEL: func.func @fill_buffer
+func.func @fill_buffer(%buffer: !hal.buffer) {
+  %c0 = arith.constant 0 : index
+  %c128 = arith.constant 128 : index
+  %pattern = arith.constant 0 : i32
+  %device = hal.ex.shared_device : !hal.device
+  // CHECK: hal.command_buffer.create
+  %cmd = hal.command_buffer.create device(%device : !hal.device)
+                                     mode(OneShot)
+                               categories("Transfer|Dispatch") : !hal.command_buffer
+  hal.command_buffer.begin<%cmd : !hal.command_buffer>
+  hal.command_buffer.fill_buffer<%cmd : !hal.command_buffer>
+      target(%buffer : !hal.buffer)[%c0, %c128]
+      pattern(%pattern : i32)
+  hal.command_buffer.end<%cmd : !hal.command_buffer>
+  // CHECK: hal.ex.submit_and_wait %
+  hal.ex.submit_and_wait %device, %cmd
+  return
+}
+
+// CHECK-NOT: util.initializer
+
+// -----
+
+// Memoized command buffer globals are renamed to avoid conflicting with
+// existing symbols.
+
+util.global private @_executable : !hal.executable
+// CHECK: util.global private @_memoized_command_buffer_0 : index
+util.global private @_memoized_command_buffer_0 : index
+
+// CHECK-LABEL: func.func @conflicting_name
+func.func @conflicting_name() {
+  %c1 = arith.constant 1 : index
+  %device = hal.ex.shared_device : !hal.device
+  %executable = util.global.load @_executable : !hal.executable
+  // CHECK-NOT: hal.command_buffer.create
+  %cmd = hal.command_buffer.create device(%device : !hal.device)
+                                     mode(OneShot)
+                               categories("Transfer|Dispatch") : !hal.command_buffer
+  hal.command_buffer.begin<%cmd : !hal.command_buffer>
+  hal.command_buffer.dispatch<%cmd : !hal.command_buffer>
+      target(%executable : !hal.executable)[0]
+      workgroups([%c1, %c1, %c1])
+  hal.command_buffer.end<%cmd : !hal.command_buffer>
+  // CHECK: util.global.load @[[GLOBAL:_memoized_command_buffer_0_[0-9]+]] : !hal.command_buffer
+  hal.ex.submit_and_wait %device, %cmd
+  return
+}
+
+// CHECK: util.global private @[[GLOBAL]] : !hal.command_buffer
+// CHECK: util.global.store %{{.+}}, @[[GLOBAL]] : !hal.command_buffer
@@ -16,6 +16,12 @@ vm.import @ex.submit_and_wait(
   %command_buffer : !vm.ref<!hal.command_buffer>
 )
 
+vm.import @ex.submit_and_wait.indirect(
+  %device : !vm.ref<!hal.device>,
+  %command_buffer : !vm.ref<!hal.command_buffer>,
+  %binding_buffers : !vm.ref<!hal.buffer> ...
+)
+
 //===----------------------------------------------------------------------===//
 // iree_hal_allocator_t
 //===----------------------------------------------------------------------===//
@@ -176,6 +182,14 @@ vm.import @command_buffer.create(
   %command_categories : i32
 ) -> !vm.ref<!hal.command_buffer>
 
+// Returns a reusable command buffer that can be recorded once and submitted
+// many times with a binding table of up to |binding_capacity| buffers.
+vm.import @command_buffer.create.reusable(
+  %device : !vm.ref<!hal.device>,
+  %command_categories : i32,
+  %binding_capacity : i32
+) -> !vm.ref<!hal.command_buffer>
+
 // Resets and begins recording into the command buffer, clearing all previously
 // recorded contents.
 vm.import @command_buffer.begin(
@@ -245,6 +259,16 @@ vm.import @command_buffer.push_descriptor_set(
   %bindings : tuple<i32, !vm.ref<!hal.buffer>, i64, i64>...
 )
 
+// Pushes a descriptor set to the given set number with buffers sourced from the
+// binding table provided at submission time.
+vm.import @command_buffer.push_descriptor_set.indirect(
+  %command_buffer : !vm.ref<!hal.command_buffer>,
+  %executable_layout : !vm.ref<!hal.executable_layout>,
+  %set : i32,
+  // <binding, slot, offset, length>
+  %bindings : tuple<i32, i32, i64, i64>...
+)
+
 // Binds a descriptor set to the given set number.
 vm.import @command_buffer.bind_descriptor_set(
   %command_buffer : !vm.ref<!hal.command_buffer>,
@@ -44,18 +44,17 @@ class EraseNonVMOp : public ConversionPattern {
 
 // VMVX -> VM import conversion base for generic ops.
 // Handles signatures with integers, VM types, or simple buffers.
-template <typename T, typename Adaptor = typename T::Adaptor>
+template <typename T>
 class VMVXImportOpConversion : public OpConversionPattern<T> {
  public:
   VMVXImportOpConversion(MLIRContext *context, SymbolTable &importSymbols,
                          TypeConverter &typeConverter, StringRef importName)
-      : OpConversionPattern<T>(context),
+      : OpConversionPattern<T>(typeConverter, context),
         importSymbols(importSymbols),
-        typeConverter(typeConverter),
         importName(importName) {}
 
   LogicalResult matchAndRewrite(
-      T op, llvm::ArrayRef<Value> operands,
+      T op, typename T::Adaptor adaptor,
       ConversionPatternRewriter &rewriter) const override {
     std::string importFqName = importName + getImportSuffix(op);
     auto importOp =
@@ -65,8 +64,8 @@ class VMVXImportOpConversion : public OpConversionPattern<T> {
                      << importFqName;
       return failure();
     }
-    auto results =
-        rewriteToCall(op, Adaptor{operands}, importOp, typeConverter, rewriter);
+    auto results = rewriteToCall(op, adaptor, importOp,
+                                 *this->getTypeConverter(), rewriter);
     if (!results.hasValue()) return failure();
     rewriter.replaceOp(op, results.getValue());
     return success();
@@ -108,19 +107,49 @@ class VMVXImportOpConversion : public OpConversionPattern<T> {
 
  private:
   SymbolTable &importSymbols;
-  TypeConverter &typeConverter;
   std::string importName;
 };
 #define VMVX_IMPORT_OP(op_type, op_mnemonic)        \
   patterns.insert<VMVXImportOpConversion<op_type>>( \
       context, importSymbols, typeConverter, op_mnemonic);
 
+// vmvx.binary -> vmvx.<opcode>.2d.<type> (like vmvx.add.2d.f32).
+class BinaryOpConversion
+    : public VMVXImportOpConversion<IREE::VMVX::BinaryOp> {
+ public:
+  using VMVXImportOpConversion::VMVXImportOpConversion;
+
+ protected:
+  std::string getImportSuffix(IREE::VMVX::BinaryOp op) const override {
+    return op.opcode().str() + ".2d." + getTypedTypeStr(op.element_type());
+  }
+};
+
+// vmvx.copy -> vmvx.copy.2d.x<bitwidth>; only the bit width matters.
+class CopyOpConversion : public VMVXImportOpConversion<IREE::VMVX::CopyOp> {
+ public:
+  using VMVXImportOpConversion::VMVXImportOpConversion;
+
+ protected:
+  std::string getImportSuffix(IREE::VMVX::CopyOp op) const override {
+    return ".2d." + getSizedTypeStr(op.element_type());
+  }
+};
+
 }  // namespace
 
 void populateVMVXToVMPatterns(MLIRContext *context,
                               TypeConverter &typeConverter,
                               SymbolTable &importSymbols,
-                              RewritePatternSet &patterns) {}
+                              RewritePatternSet &patterns) {
+  patterns.insert<BinaryOpConversion>(context, importSymbols, typeConverter,
+                                      "vmvx.");
+  patterns.insert<CopyOpConversion>(context, importSymbols, typeConverter,
+                                    "vmvx.copy");
+  VMVX_IMPORT_OP(IREE::VMVX::Fill2DOp, "vmvx.fill.2d.x32");
+  VMVX_IMPORT_OP(IREE::VMVX::MatmulOp, "vmvx.matmul.f32f32f32");
+  VMVX_IMPORT_OP(IREE::VMVX::Mmt4DOp, "vmvx.mmt4d.f32f32f32");
+}
 
 }  // namespace iree_compiler
 }  // namespace mlir
@@ -0,0 +1,527 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "iree/compiler/Dialect/Modules/VMVX/IR/VMVXDialect.h"
+#include "iree/compiler/Dialect/Modules/VMVX/IR/VMVXOps.h"
+#include "iree/compiler/Dialect/Modules/VMVX/Transforms/Passes.h"
+#include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
+#include "llvm/ADT/SmallBitVector.h"
+#include "llvm/ADT/TypeSwitch.h"
+#include "mlir/Dialect/Arithmetic/IR/Arithmetic.h"
+#include "mlir/Dialect/Arithmetic/Utils/Utils.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace VMVX {
+
+namespace {
+
+//===----------------------------------------------------------------------===//
+// Buffer descriptors
+//===----------------------------------------------------------------------===//
+
+// A strided view of a rank-1 base buffer as consumed by the microkernels.
+// The offset and strides are in elements of the base buffer element type.
+struct BufferDescriptor {
+  Value baseBuffer;
+  Value offset;
+  SmallVector<Value> sizes;
+  SmallVector<Value> strides;
+
+  unsigned getRank() const { return sizes.size(); }
+};
+
+// Returns the values of all dimensions of the identity-layout |memrefType|
+// using |dynamicDims| for the dynamic ones.
+static SmallVector<Value> getDimValues(MemRefType memrefType,
+                                       ValueRange dynamicDims, Location loc,
+                                       OpBuilder &builder) {
+  SmallVector<Value> dims;
+  unsigned dynamicDimIndex = 0;
+  for (int64_t dim : memrefType.getShape()) {
+    if (ShapedType::isDynamic(dim)) {
+      dims.push_back(dynamicDims[dynamicDimIndex++]);
+    } else {
+      dims.push_back(builder.create<arith::ConstantIndexOp>(loc, dim));
+    }
+  }
+  return dims;
+}
+
+// Returns true if |memref| is produced by a chain of ops that
+// resolveBufferDescriptor can see through. This is checked before any IR is
+// created so that patterns only mutate the IR when they succeed.
+static bool isResolvableMemRef(Value memref) {
+  auto memrefType = memref.getType().dyn_cast<MemRefType>();
+  if (!memrefType || !memrefType.getElementType().isIntOrFloat()) {
+    return false;
+  }
+  Operation *definingOp = memref.getDefiningOp();
+  if (!definingOp) return false;
+  if (auto subviewOp = dyn_cast<memref::SubViewOp>(definingOp)) {
+    return isResolvableMemRef(subviewOp.getSource());
+  } else if (isa<IREE::HAL::InterfaceBindingSubspanOp>(definingOp)) {
+    return memrefType.getLayout().isIdentity();
+  }
+  // Rank-1 identity buffers (local allocations, constants) are already in the
+  // form the VM can consume.
+  return memrefType.getRank() == 1 && memrefType.getLayout().isIdentity() &&
+         isa<memref::AllocaOp, memref::AllocOp, memref::GetGlobalOp>(
+             definingOp);
+}
+
+// Returns the static strides of |memref| or an empty list if the layout is not
+// strided. Dynamic strides are ShapedType::kDynamicStrideOrOffset.
+static SmallVector<int64_t> getStaticStrides(Value memref) {
+  SmallVector<int64_t> strides;
+  int64_t offset = 0;
+  if (failed(getStridesAndOffset(memref.getType().cast<MemRefType>(), strides,
+                                 offset))) {
+    return {};
+  }
+  return strides;
+}
+
+// Resolves the descriptor of an identity-layout binding subspan.
+// The base buffer is a new rank-1 subspan of the same binding at offset 0 so
+// that it is untouched by memref flattening; the original byte offset is
+// folded into the element offset like FlattenMemRefSubspan does for loads.
+static BufferDescriptor resolveSubspanDescriptor(
+    IREE::HAL::InterfaceBindingSubspanOp subspanOp, Location loc,
+    OpBuilder &builder) {
+  auto memrefType = subspanOp.getType().cast<MemRefType>();
+  Type elementType = memrefType.getElementType();
+  int64_t elementSize = IREE::Util::getRoundedElementByteWidth(elementType);
+
+  BufferDescriptor desc;
+  desc.sizes =
+      getDimValues(memrefType, subspanOp.dynamic_dims(), loc, builder);
+  desc.strides.resize(desc.sizes.size());
+  Value stride = builder.create<arith::ConstantIndexOp>(loc, 1);
+  for (int i = desc.sizes.size() - 1; i >= 0; --i) {
+    desc.strides[i] = stride;
+    stride = builder.createOrFold<arith::MulIOp>(loc, stride, desc.sizes[i]);
+  }
+  Value elementCount = stride;
+
+  desc.offset = builder.create<arith::ConstantIndexOp>(loc, 0);
+  if (subspanOp.byte_offset() &&
+      !matchPattern(subspanOp.byte_offset(), m_Zero())) {
+    // We assume that upper layers guarantee the byte offset is perfectly
+    // divisible by the element byte count so the content is well aligned.
+    desc.offset = builder.createOrFold<arith::DivUIOp>(
+        loc, subspanOp.byte_offset(),
+        builder.create<arith::ConstantIndexOp>(loc, elementSize));
+  }
+
+  Value zero = builder.create<arith::ConstantIndexOp>(loc, 0);
+  auto baseType = MemRefType::get({ShapedType::kDynamicSize}, elementType,
+                                  AffineMap(), memrefType.getMemorySpace());
+  desc.baseBuffer = builder.create<IREE::HAL::InterfaceBindingSubspanOp>(
+      loc, baseType, subspanOp.set(), subspanOp.binding(), subspanOp.type(),
+      zero,
+      ValueRange{builder.createOrFold<arith::AddIOp>(loc, desc.offset,
+                                                     elementCount)},
+      subspanOp.alignmentAttr());
+  return desc;
+}
+
+static BufferDescriptor resolveBufferDescriptor(Value memref, Location loc,
+                                                OpBuilder &builder);
+
+// Composes the descriptor of the source of |subviewOp| with its offsets,
+// sizes, and strides, dropping any rank-reduced dimensions.
+static BufferDescriptor resolveSubViewDescriptor(memref::SubViewOp subviewOp,
+                                                 Location loc,
+                                                 OpBuilder &builder) {
+  BufferDescriptor sourceDesc =
+      resolveBufferDescriptor(subviewOp.getSource(), loc, builder);
+
+  auto offsets = subviewOp.getMixedOffsets();
+  auto sizes = subviewOp.getMixedSizes();
+  auto strides = subviewOp.getMixedStrides();
+  llvm::SmallBitVector droppedDims = subviewOp.getDroppedDims();
+
+  BufferDescriptor desc;
+  desc.baseBuffer = sourceDesc.baseBuffer;
+  desc.offset = sourceDesc.offset;
+  for (unsigned i = 0; i < sourceDesc.getRank(); ++i) {
+    Value offset = getValueOrCreateConstantIndexOp(builder, loc, offsets[i]);
+    desc.offset = builder.createOrFold<arith::AddIOp>(
+        loc, desc.offset,
+        builder.createOrFold<arith::MulIOp>(loc, offset,
+                                            sourceDesc.strides[i]));
+    if (droppedDims.test(i)) continue;
+    desc.sizes.push_back(
+        getValueOrCreateConstantIndexOp(builder, loc, sizes[i]));
+    desc.strides.push_back(builder.createOrFold<arith::MulIOp>(
+        loc, sourceDesc.strides[i],
+        getValueOrCreateConstantIndexOp(builder, loc, strides[i])));
+  }
+  return desc;
+}
+
+// Resolves |memref| to a rank-1 base buffer and a strided view into it.
+// Requires isResolvableMemRef(|memref|).
+static BufferDescriptor resolveBufferDescriptor(Value memref, Location loc,
+                                                OpBuilder &builder) {
+  assert(isResolvableMemRef(memref) && "unresolvable memref");
+  Operation *definingOp = memref.getDefiningOp();
+  if (auto subviewOp = dyn_cast<memref::SubViewOp>(definingOp)) {
+    return resolveSubViewDescriptor(subviewOp, loc, builder);
+  } else if (auto subspanOp =
+                 dyn_cast<IREE::HAL::InterfaceBindingSubspanOp>(definingOp)) {
+    return resolveSubspanDescriptor(subspanOp, loc, builder);
+  }
+  BufferDescriptor desc;
+  desc.baseBuffer = memref;
+  desc.offset = builder.create<arith::ConstantIndexOp>(loc, 0);
+  desc.sizes.push_back(builder.createOrFold<memref::DimOp>(loc, memref, 0));
+  desc.strides.push_back(builder.create<arith::ConstantIndexOp>(loc, 1));
+  return desc;
+}
+
+// Expands a descriptor of rank <= 2 to exactly rank 2 by prepending unit
+// dimensions.
+static void expandTo2D(BufferDescriptor &desc, Location loc,
+                       OpBuilder &builder) {
+  assert(desc.getRank() <= 2 && "only rank <= 2 views can be expanded");
+  while (desc.getRank() < 2) {
+    desc.sizes.insert(desc.sizes.begin(),
+                      builder.create<arith::ConstantIndexOp>(loc, 1));
+    desc.strides.insert(desc.strides.begin(),
+                        builder.create<arith::ConstantIndexOp>(loc, 0));
+  }
+}
+
+// Returns true if all |memrefs| are resolvable views of rank <= 2 and, if
+// |requireUnitInnerStride| is set, their innermost dimension is contiguous.
+static bool areResolvable2DMemRefs(ValueRange memrefs,
+                                   bool requireUnitInnerStride) {
+  for (Value memref : memrefs) {
+    if (!isResolvableMemRef(memref)) return false;
+    auto memrefType = memref.getType().cast<MemRefType>();
+    if (memrefType.getRank() > 2) return false;
+    if (requireUnitInnerStride && memrefType.getRank() > 0) {
+      auto strides = getStaticStrides(memref);
+      if (strides.empty() || strides.back() != 1) return false;
+    }
+  }
+  return true;
+}
+
+// Resolves all |memrefs| to 2D descriptors at the current builder position.
+// Requires areResolvable2DMemRefs(|memrefs|).
+static SmallVector<BufferDescriptor> resolve2DDescriptors(ValueRange memrefs,
+                                                          Location loc,
+                                                          OpBuilder &builder) {
+  SmallVector<BufferDescriptor> descs;
+  for (Value memref : memrefs) {
+    BufferDescriptor desc = resolveBufferDescriptor(memref, loc, builder);
+    expandTo2D(desc, loc, builder);
+    descs.push_back(std::move(desc));
+  }
+  return descs;
+}
+
+// Returns true if all operands of |op| are memrefs of the given element types.
+static bool hasMemRefOperandsOfType(Operation *op,
+                                    ArrayRef<Type> elementTypes) {
+  for (Value operand : op->getOperands()) {
+    auto memrefType = operand.getType().dyn_cast<MemRefType>();
+    if (!memrefType) continue;
+    if (!llvm::is_contained(elementTypes, memrefType.getElementType())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// Patterns
+//===----------------------------------------------------------------------===//
+
+// Emits a vmvx.copy of |in| to |out| (both rank <= 2 of the same shape).
+static LogicalResult rewriteAsCopy(Operation *op, Value in, Value out,
+                                   PatternRewriter &rewriter) {
+  if (!areResolvable2DMemRefs({in, out}, /*requireUnitInnerStride=*/false)) {
+    return failure();
+  }
+  auto elementType = out.getType().cast<MemRefType>().getElementType();
+  auto loc = op->getLoc();
+  auto descs = resolve2DDescriptors({in, out}, loc, rewriter);
+  auto &inDesc = descs[0];
+  auto &outDesc = descs[1];
+  rewriter.create<IREE::VMVX::CopyOp>(
+      loc, inDesc.baseBuffer, inDesc.offset, inDesc.strides[0],
+      inDesc.strides[1], outDesc.baseBuffer, outDesc.offset,
+      outDesc.strides[0], outDesc.strides[1], outDesc.sizes[0],
+      outDesc.sizes[1], TypeAttr::get(elementType));
+  rewriter.eraseOp(op);
+  return success();
+}
+
+struct LowerMemRefCopyOp : public OpRewritePattern<memref::CopyOp> {
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(memref::CopyOp copyOp,
+                                PatternRewriter &rewriter) const override {
+    auto sourceType = copyOp.getSource().getType().dyn_cast<MemRefType>();
+    auto targetType = copyOp.getTarget().getType().dyn_cast<MemRefType>();
+    if (!sourceType || !targetType ||
+        sourceType.getElementType() != targetType.getElementType()) {
+      return failure();
+    }
+    return rewriteAsCopy(copyOp, copyOp.getSource(), copyOp.getTarget(),
+                         rewriter);
+  }
+};
+
+struct LowerLinalgFillOp : public OpRewritePattern<linalg::FillOp> {
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(linalg::FillOp fillOp,
+                                PatternRewriter &rewriter) const override {
+    if (!fillOp.hasBufferSemantics()) return failure();
+    Value value = fillOp.getInputOperand(0)->get();
+    Value out = fillOp.getOutputOperand(0)->get();
+    Type valueType = value.getType();
+    if (!valueType.isF32() && !valueType.isInteger(32)) return failure();
+    // The fill kernel only takes a row stride.
+    if (!areResolvable2DMemRefs({out}, /*requireUnitInnerStride=*/true)) {
+      return failure();
+    }
+
+    auto loc = fillOp.getLoc();
+    auto descs = resolve2DDescriptors({out}, loc, rewriter);
+    auto &outDesc = descs[0];
+    if (valueType.isF32()) {
+      value = rewriter.create<arith::BitcastOp>(loc, rewriter.getI32Type(),
+                                                value);
+    }
+    rewriter.create<IREE::VMVX::Fill2DOp>(loc, value, outDesc.baseBuffer,
+                                          outDesc.offset, outDesc.strides[0],
+                                          outDesc.sizes[0], outDesc.sizes[1]);
+    rewriter.eraseOp(fillOp);
+    return success();
+  }
+};
+
+// Returns the VMVX binary opcode for the arithmetic op |op| or an empty string
+// if it is not supported.
+static StringRef getBinaryOpcode(Operation *op) {
+  return TypeSwitch<Operation *, StringRef>(op)
+      .Case<arith::AddFOp, arith::AddIOp>([](auto) { return "add"; })
+      .Case<arith::SubFOp, arith::SubIOp>([](auto) { return "sub"; })
+      .Case<arith::MulFOp, arith::MulIOp>([](auto) { return "mul"; })
+      .Default([](Operation *) { return ""; });
+}
+
+// Lowers elementwise linalg.generic ops with identity indexing maps that are
+// either copies (`yield %in`) or a single binary arithmetic op.
+struct LowerLinalgGenericOp : public OpRewritePattern<linalg::GenericOp> {
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(linalg::GenericOp genericOp,
+                                PatternRewriter &rewriter) const override {
+    if (!genericOp.hasBufferSemantics() || genericOp.getNumOutputs() != 1 ||
+        genericOp.getNumParallelLoops() != genericOp.getNumLoops() ||
+        genericOp.getNumLoops() > 2) {
+      return failure();
+    }
+    for (AffineMap map : genericOp.getIndexingMaps()) {
+      if (!map.isIdentity()) return failure();
+    }
+
+    Block *body = genericOp.getBody();
+    auto yieldOp = cast<linalg::YieldOp>(body->getTerminator());
+    Value yieldedValue = yieldOp.getOperand(0);
+    Value out = genericOp.getOutputOperand(0)->get();
+
+    // Copy: the body yields the only input unchanged.
+    if (genericOp.getNumInputs() == 1 && body->getOperations().size() == 1 &&
+        yieldedValue == body->getArgument(0)) {
+      return rewriteAsCopy(genericOp, genericOp.getInputOperand(0)->get(), out,
+                           rewriter);
+    }
+
+    // Binary: the body is a single arithmetic op on the two inputs.
+    if (genericOp.getNumInputs() != 2 || body->getOperations().size() != 2) {
+      return failure();
+    }
+    Operation *computeOp = yieldedValue.getDefiningOp();
+    if (!computeOp || computeOp->getNumOperands() != 2 ||
+        computeOp->getOperand(0) != body->getArgument(0) ||
+        computeOp->getOperand(1) != body->getArgument(1)) {
+      return failure();
+    }
+    StringRef opcode = getBinaryOpcode(computeOp);
+    if (opcode.empty()) return failure();
+    Type elementType = yieldedValue.getType();
+    if (!elementType.isF32() && !elementType.isInteger(32)) return failure();
+    if (!hasMemRefOperandsOfType(genericOp, {elementType})) return failure();
+    SmallVector<Value> memrefs = {genericOp.getInputOperand(0)->get(),
+                                  genericOp.getInputOperand(1)->get(), out};
+    if (!areResolvable2DMemRefs(memrefs, /*requireUnitInnerStride=*/false)) {
+      return failure();
+    }
+
+    auto loc = genericOp.getLoc();
+    auto descs = resolve2DDescriptors(memrefs, loc, rewriter);
+    auto &lhsDesc = descs[0];
+    auto &rhsDesc = descs[1];
+    auto &outDesc = descs[2];
+    rewriter.create<IREE::VMVX::BinaryOp>(
+        loc, rewriter.getStringAttr(opcode), lhsDesc.baseBuffer,
+        lhsDesc.offset, lhsDesc.strides[0], lhsDesc.strides[1],
+        rhsDesc.baseBuffer, rhsDesc.offset, rhsDesc.strides[0],
+        rhsDesc.strides[1], outDesc.baseBuffer, outDesc.offset,
+        outDesc.strides[0], outDesc.strides[1], outDesc.sizes[0],
+        outDesc.sizes[1], TypeAttr::get(elementType));
+    rewriter.eraseOp(genericOp);
+    return success();
+  }
+};
+
+struct LowerLinalgMatmulOp : public OpRewritePattern<linalg::MatmulOp> {
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(linalg::MatmulOp matmulOp,
+                                PatternRewriter &rewriter) const override {
+    if (!matmulOp.hasBufferSemantics() ||
+        !hasMemRefOperandsOfType(matmulOp, {rewriter.getF32Type()})) {
+      return failure();
+    }
+    SmallVector<Value> memrefs = {matmulOp.getInputOperand(0)->get(),
+                                  matmulOp.getInputOperand(1)->get(),
+                                  matmulOp.getOutputOperand(0)->get()};
+    if (!areResolvable2DMemRefs(memrefs, /*requireUnitInnerStride=*/true)) {
+      return failure();
+    }
+
+    auto loc = matmulOp.getLoc();
+    auto descs = resolve2DDescriptors(memrefs, loc, rewriter);
+    auto &lhsDesc = descs[0];
+    auto &rhsDesc = descs[1];
+    auto &outDesc = descs[2];
+    rewriter.create<IREE::VMVX::MatmulOp>(
+        loc, lhsDesc.baseBuffer, lhsDesc.offset, lhsDesc.strides[0],
+        rhsDesc.baseBuffer, rhsDesc.offset, rhsDesc.strides[0],
+        outDesc.baseBuffer, outDesc.offset, outDesc.strides[0],
+        /*m=*/lhsDesc.sizes[0], /*n=*/rhsDesc.sizes[1],
+        /*k=*/lhsDesc.sizes[1],
+        rewriter.getI32IntegerAttr(
+            static_cast<int32_t>(IREE::VMVX::MatmulFlags::Accumulate)));
+    rewriter.eraseOp(matmulOp);
+    return success();
+  }
+};
+
+// Returns true if |memref| is a resolvable rank-4 view whose inner 3
+// dimensions are densely packed with static inner tile sizes.
+static bool isPackedMmt4DOperand(Value memref) {
+  if (!isResolvableMemRef(memref)) return false;
+  auto memrefType = memref.getType().cast<MemRefType>();
+  if (memrefType.getRank() != 4) return false;
+  auto shape = memrefType.getShape();
+  if (ShapedType::isDynamic(shape[2]) || ShapedType::isDynamic(shape[3])) {
+    return false;
+  }
+  auto strides = getStaticStrides(memref);
+  return !strides.empty() && strides[3] == 1 && strides[2] == shape[3] &&
+         strides[1] == shape[2] * shape[3];
+}
+
+struct LowerLinalgMmt4DOp : public OpRewritePattern<linalg::Mmt4DOp> {
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(linalg::Mmt4DOp mmt4dOp,
+                                PatternRewriter &rewriter) const override {
+    if (!mmt4dOp.hasBufferSemantics() ||
+        !hasMemRefOperandsOfType(mmt4dOp, {rewriter.getF32Type()})) {
+      return failure();
+    }
+    SmallVector<Value> memrefs = {mmt4dOp.getInputOperand(0)->get(),
+                                  mmt4dOp.getInputOperand(1)->get(),
+                                  mmt4dOp.getOutputOperand(0)->get()};
+    if (!llvm::all_of(memrefs, isPackedMmt4DOperand)) return failure();
+
+    auto loc = mmt4dOp.getLoc();
+    SmallVector<BufferDescriptor> descs;
+    for (Value memref : memrefs) {
+      descs.push_back(resolveBufferDescriptor(memref, loc, rewriter));
+    }
+    auto &lhsDesc = descs[0];  // M1 x K1 x M0 x K0
+    auto &rhsDesc = descs[1];  // N1 x K1 x N0 x K0
+    auto &outDesc = descs[2];  // M1 x N1 x M0 x N0
+    rewriter.create<IREE::VMVX::Mmt4DOp>(
+        loc, lhsDesc.baseBuffer, lhsDesc.offset, lhsDesc.strides[0],
+        rhsDesc.baseBuffer, rhsDesc.offset, rhsDesc.strides[0],
+        outDesc.baseBuffer, outDesc.offset, outDesc.strides[0],
+        /*m=*/lhsDesc.sizes[0], /*n=*/rhsDesc.sizes[0],
+        /*k=*/lhsDesc.sizes[1], /*m0=*/lhsDesc.sizes[2],
+        /*n0=*/rhsDesc.sizes[2], /*k0=*/lhsDesc.sizes[3],
+        rewriter.getI32IntegerAttr(
+            static_cast<int32_t>(IREE::VMVX::MatmulFlags::Accumulate)));
+    rewriter.eraseOp(mmt4dOp);
+    return success();
+  }
+};
+
+//===----------------------------------------------------------------------===//
+// Pass
+//===----------------------------------------------------------------------===//
+
+// Rewrites linalg ops on buffers into VMVX microkernel ops when their operands
+// can be resolved to strided views of rank-1 base buffers. Anything that does
+// not match is left to the default linalg -> loops lowering.
+class LowerLinalgMicrokernelsPass
+    : public PassWrapper<LowerLinalgMicrokernelsPass,
+                         OperationPass<func::FuncOp>> {
+ public:
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<IREE::HAL::HALDialect, IREE::VMVX::VMVXDialect,
+                    arith::ArithmeticDialect, memref::MemRefDialect>();
+  }
+
+  StringRef getArgument() const override {
+    return "iree-vmvx-lower-linalg-microkernels";
+  }
+
+  StringRef getDescription() const override {
+    return "Lowers linalg ops on buffers to VMVX microkernel calls";
+  }
+
+  void runOnOperation() override {
+    RewritePatternSet patterns(&getContext());
+    patterns.insert<LowerLinalgFillOp, LowerLinalgGenericOp,
+                    LowerLinalgMatmulOp, LowerLinalgMmt4DOp,
+                    LowerMemRefCopyOp>(&getContext());
+    if (failed(applyPatternsAndFoldGreedily(getOperation(),
+                                            std::move(patterns)))) {
+      return signalPassFailure();
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+createLowerLinalgMicrokernelsPass() {
+  return std::make_unique<LowerLinalgMicrokernelsPass>();
+}
+
+static PassRegistration<LowerLinalgMicrokernelsPass> pass;
+
+}  // namespace VMVX
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -46,6 +46,10 @@ static void buildVectorVMVXTransformPassPipeline(OpPassManager &passManager) {
   // nestedModulePM.addNestedPass<func::FuncOp>(
   //     createLinalgTileAndVectorizeWorkgroupsPass());
 
+  // Linalg -> VMVX microkernels. Anything not matched falls through to loops.
+  nestedModulePM.addNestedPass<func::FuncOp>(
+      createLowerLinalgMicrokernelsPass());
+
   // Linalg -> SCF.
   nestedModulePM.addNestedPass<func::FuncOp>(
       IREE::LinalgExt::createLinalgExtToLoopsPass());
@@ -9,6 +9,7 @@
 
 #include "iree/compiler/Dialect/Modules/VMVX/IR/VMVXOps.h"
 #include "llvm/ADT/StringMap.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
@@ -37,6 +38,15 @@ void buildVMVXTransformPassPipeline(OpPassManager &passManager);
 
 void createVMVXTransformPassPipeline();
 
+//===----------------------------------------------------------------------===//
+// Linalg lowering
+//===----------------------------------------------------------------------===//
+
+// Rewrites linalg ops on buffers that have a VMVX runtime microkernel (fill,
+// copy, elementwise add/sub/mul, matmul, mmt4d) into VMVX dialect ops.
+std::unique_ptr<OperationPass<func::FuncOp>>
+createLowerLinalgMicrokernelsPass();
+
 //===----------------------------------------------------------------------===//
 // Dialect conversion
 //===----------------------------------------------------------------------===//
@@ -0,0 +1,81 @@
+// RUN: iree-opt --split-input-file --iree-vmvx-lower-linalg-microkernels --canonicalize %s | FileCheck %s
+
+// CHECK-LABEL: func.func @matmul_f32
+func.func @matmul_f32() {
+  %c0 = arith.constant 0 : index
+  // CHECK-DAG: %[[LHS:.+]] = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) offset(%c0) : memref<?xf32>{%c32}
+  // CHECK-DAG: %[[RHS:.+]] = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) offset(%c0) : memref<?xf32>{%c64}
+  // CHECK-DAG: %[[OUT:.+]] = hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) offset(%c0) : memref<?xf32>{%c32}
+  %lhs = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) offset(%c0) : memref<4x8xf32>
+  %rhs = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) offset(%c0) : memref<8x8xf32>
+  %out = hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) offset(%c0) : memref<4x8xf32>
+  //      CHECK: vmvx.matmul lhs(%[[LHS]] offset %c0 row_stride %c8 : memref<?xf32>)
+  // CHECK-SAME:   rhs(%[[RHS]] offset %c0 row_stride %c8 : memref<?xf32>)
+  // CHECK-SAME:   out(%[[OUT]] offset %c0 row_stride %c8 : memref<?xf32>)
+  // CHECK-SAME:   mnk(%c4, %c8, %c8) {flags = 1 : i32}
+  // CHECK-NOT: linalg.matmul
+  linalg.matmul ins(%lhs, %rhs : memref<4x8xf32>, memref<8x8xf32>) outs(%out : memref<4x8xf32>)
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func.func @fill_subview
+func.func @fill_subview(%offset: index) {
+  %c0 = arith.constant 0 : index
+  %cst = arith.constant 1.0 : f32
+  // CHECK: %[[OUT:.+]] = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) offset(%c0) : memref<?xf32>{%c128}
+  %out = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) offset(%c0) : memref<8x16xf32>
+  %view = memref.subview %out[%offset, 4] [2, 8] [1, 1] : memref<8x16xf32> to memref<2x8xf32, affine_map<(d0, d1)[s0] -> (d0 * 16 + s0 + d1)>>
+  // CHECK: %[[VALUE:.+]] = arith.bitcast %{{.+}} : f32 to i32
+  // CHECK: %[[VIEW_ROW:.+]] = arith.muli %{{.+}}, %c16 : index
+  // CHECK: %[[VIEW_OFFSET:.+]] = arith.addi %[[VIEW_ROW]], %c4 : index
+  // CHECK: vmvx.fill2d scalar(%[[VALUE]] : i32) out(%[[OUT]] offset %[[VIEW_OFFSET]] row_stride %c16 : memref<?xf32>) sizes(%c2, %c8)
+  linalg.fill ins(%cst : f32) outs(%view : memref<2x8xf32, affine_map<(d0, d1)[s0] -> (d0 * 16 + s0 + d1)>>)
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func.func @add_i32
+func.func @add_i32() {
+  %c0 = arith.constant 0 : index
+  %c64 = arith.constant 64 : index
+  %lhs = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) offset(%c0) : memref<16xi32>
+  %rhs = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) offset(%c64) : memref<16xi32>
+  %out = hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) offset(%c0) : memref<16xi32>
+  //      CHECK: vmvx.binary op("add" : i32)
+  // CHECK-SAME:   lhs(%{{.+}} offset %c0 strides{{.*}}%c0, %c1] : memref<?xi32>)
+  // CHECK-SAME:   rhs(%{{.+}} offset %c16 strides{{.*}}%c0, %c1] : memref<?xi32>)
+  // CHECK-SAME:   sizes(%c1, %c16)
+  linalg.generic {
+    indexing_maps = [affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>],
+    iterator_types = ["parallel"]
+  } ins(%lhs, %rhs : memref<16xi32>, memref<16xi32>) outs(%out : memref<16xi32>) {
+  ^bb0(%a: i32, %b: i32, %c: i32):
+    %sum = arith.addi %a, %b : i32
+    linalg.yield %sum : i32
+  }
+  return
+}
+
+// -----
+
+// Non-identity indexing maps stay on the scalar path.
+
+// CHECK-LABEL: func.func @transpose_not_lowered
+func.func @transpose_not_lowered() {
+  %c0 = arith.constant 0 : index
+  %in = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) offset(%c0) : memref<4x8xf32>
+  %out = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) offset(%c0) : memref<8x4xf32>
+  // CHECK-NOT: vmvx.copy
+  // CHECK: linalg.generic
+  linalg.generic {
+    indexing_maps = [affine_map<(d0, d1) -> (d1, d0)>, affine_map<(d0, d1) -> (d0, d1)>],
+    iterator_types = ["parallel", "parallel"]
+  } ins(%in : memref<4x8xf32>) outs(%out : memref<8x4xf32>) {
+  ^bb0(%a: f32, %b: f32):
+    linalg.yield %a : f32
+  }
+  return
+}
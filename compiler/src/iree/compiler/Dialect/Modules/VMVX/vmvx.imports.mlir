@@ -26,7 +26,110 @@
 vm.module @vmvx {
 
 //===----------------------------------------------------------------------===//
-// VMVX Ops: TODO
+// VMVX Ops: elementwise binary
 //===----------------------------------------------------------------------===//
+//
+// Buffer views are (buffer, element offset, element strides) with sizes
+// shared across all operands. See vmvx.binary.
+
+vm.import @add.2d.f32(
+  %lhs_buffer : !vm.buffer, %lhs_offset : i64, %lhs_stride0 : i64, %lhs_stride1 : i64,
+  %rhs_buffer : !vm.buffer, %rhs_offset : i64, %rhs_stride0 : i64, %rhs_stride1 : i64,
+  %out_buffer : !vm.buffer, %out_offset : i64, %out_stride0 : i64, %out_stride1 : i64,
+  %size0 : i64, %size1 : i64
+)
+
+vm.import @add.2d.i32(
+  %lhs_buffer : !vm.buffer, %lhs_offset : i64, %lhs_stride0 : i64, %lhs_stride1 : i64,
+  %rhs_buffer : !vm.buffer, %rhs_offset : i64, %rhs_stride0 : i64, %rhs_stride1 : i64,
+  %out_buffer : !vm.buffer, %out_offset : i64, %out_stride0 : i64, %out_stride1 : i64,
+  %size0 : i64, %size1 : i64
+)
+
+vm.import @mul.2d.f32(
+  %lhs_buffer : !vm.buffer, %lhs_offset : i64, %lhs_stride0 : i64, %lhs_stride1 : i64,
+  %rhs_buffer : !vm.buffer, %rhs_offset : i64, %rhs_stride0 : i64, %rhs_stride1 : i64,
+  %out_buffer : !vm.buffer, %out_offset : i64, %out_stride0 : i64, %out_stride1 : i64,
+  %size0 : i64, %size1 : i64
+)
+
+vm.import @mul.2d.i32(
+  %lhs_buffer : !vm.buffer, %lhs_offset : i64, %lhs_stride0 : i64, %lhs_stride1 : i64,
+  %rhs_buffer : !vm.buffer, %rhs_offset : i64, %rhs_stride0 : i64, %rhs_stride1 : i64,
+  %out_buffer : !vm.buffer, %out_offset : i64, %out_stride0 : i64, %out_stride1 : i64,
+  %size0 : i64, %size1 : i64
+)
+
+vm.import @sub.2d.f32(
+  %lhs_buffer : !vm.buffer, %lhs_offset : i64, %lhs_stride0 : i64, %lhs_stride1 : i64,
+  %rhs_buffer : !vm.buffer, %rhs_offset : i64, %rhs_stride0 : i64, %rhs_stride1 : i64,
+  %out_buffer : !vm.buffer, %out_offset : i64, %out_stride0 : i64, %out_stride1 : i64,
+  %size0 : i64, %size1 : i64
+)
+
+vm.import @sub.2d.i32(
+  %lhs_buffer : !vm.buffer, %lhs_offset : i64, %lhs_stride0 : i64, %lhs_stride1 : i64,
+  %rhs_buffer : !vm.buffer, %rhs_offset : i64, %rhs_stride0 : i64, %rhs_stride1 : i64,
+  %out_buffer : !vm.buffer, %out_offset : i64, %out_stride0 : i64, %out_stride1 : i64,
+  %size0 : i64, %size1 : i64
+)
+
+//===----------------------------------------------------------------------===//
+// VMVX Ops: copy/fill
+//===----------------------------------------------------------------------===//
+
+vm.import @copy.2d.x8(
+  %in_buffer : !vm.buffer, %in_offset : i64, %in_stride0 : i64, %in_stride1 : i64,
+  %out_buffer : !vm.buffer, %out_offset : i64, %out_stride0 : i64, %out_stride1 : i64,
+  %size0 : i64, %size1 : i64
+)
+
+vm.import @copy.2d.x16(
+  %in_buffer : !vm.buffer, %in_offset : i64, %in_stride0 : i64, %in_stride1 : i64,
+  %out_buffer : !vm.buffer, %out_offset : i64, %out_stride0 : i64, %out_stride1 : i64,
+  %size0 : i64, %size1 : i64
+)
+
+vm.import @copy.2d.x32(
+  %in_buffer : !vm.buffer, %in_offset : i64, %in_stride0 : i64, %in_stride1 : i64,
+  %out_buffer : !vm.buffer, %out_offset : i64, %out_stride0 : i64, %out_stride1 : i64,
+  %size0 : i64, %size1 : i64
+)
+
+vm.import @copy.2d.x64(
+  %in_buffer : !vm.buffer, %in_offset : i64, %in_stride0 : i64, %in_stride1 : i64,
+  %out_buffer : !vm.buffer, %out_offset : i64, %out_stride0 : i64, %out_stride1 : i64,
+  %size0 : i64, %size1 : i64
+)
+
+vm.import @fill.2d.x32(
+  %fill_value : i32,
+  %out_buffer : !vm.buffer, %out_offset : i64, %out_row_stride : i64,
+  %size0 : i64, %size1 : i64
+)
+
+//===----------------------------------------------------------------------===//
+// VMVX Ops: matmul
+//===----------------------------------------------------------------------===//
+//
+// Operands are row-major with contiguous inner dimensions. The flags are
+// VMVX_MatmulFlags (bit 0: accumulate into the existing output contents).
+
+vm.import @matmul.f32f32f32(
+  %lhs_buffer : !vm.buffer, %lhs_offset : i64, %lhs_row_stride : i64,
+  %rhs_buffer : !vm.buffer, %rhs_offset : i64, %rhs_row_stride : i64,
+  %out_buffer : !vm.buffer, %out_offset : i64, %out_row_stride : i64,
+  %m : i64, %n : i64, %k : i64,
+  %flags : i32
+)
+
+vm.import @mmt4d.f32f32f32(
+  %lhs_buffer : !vm.buffer, %lhs_offset : i64, %lhs_row_stride : i64,
+  %rhs_buffer : !vm.buffer, %rhs_offset : i64, %rhs_row_stride : i64,
+  %out_buffer : !vm.buffer, %out_offset : i64, %out_row_stride : i64,
+  %m : i64, %n : i64, %k : i64,
+  %m0 : i32, %n0 : i32, %k0 : i32,
+  %flags : i32
+)
 
 }  // module
@@ -12,6 +12,7 @@
 
 #include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
 #include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/FormatVariadic.h"
@@ -146,6 +147,20 @@ struct RegisterUsage {
     }
   }
 
+  // Returns true if all of the bank ordinals covered by |reg| are unused.
+  bool isRegisterAvailable(Register reg) {
+    int ordinalStart = reg.ordinal();
+    if (reg.isRef()) {
+      return !refRegisters.test(ordinalStart);
+    }
+    unsigned int ordinalEnd = ordinalStart + (reg.byteWidth() / 4) - 1;
+    for (unsigned int ordinal = ordinalStart; ordinal <= ordinalEnd;
+         ++ordinal) {
+      if (intRegisters.test(ordinal)) return false;
+    }
+    return true;
+  }
+
   void markRegisterUsed(Register reg) {
     int ordinalStart = reg.ordinal();
     if (reg.isRef()) {
@@ -202,6 +217,24 @@ static SmallVector<Block *, 8> sortBlocksInDominanceOrder(
   return orderedBlocks;
 }
 
+// Records the registers of the values |terminatorOp| forwards to its successor
+// block arguments in |blockArgHints|. The first predecessor allocated wins.
+static void recordBlockArgHints(
+    Operation *terminatorOp, RegisterAllocation &registerAllocation,
+    llvm::DenseMap<Value, Register> &blockArgHints) {
+  auto branchOp = dyn_cast<BranchOpInterface>(terminatorOp);
+  if (!branchOp) return;
+  for (unsigned i = 0; i < terminatorOp->getNumSuccessors(); ++i) {
+    auto *targetBlock = terminatorOp->getSuccessor(i);
+    auto operands = branchOp.getSuccessorOperands(i).getForwardedOperands();
+    for (auto it : llvm::enumerate(operands)) {
+      BlockArgument targetArg = targetBlock->getArgument(it.index());
+      blockArgHints.try_emplace(targetArg,
+                                registerAllocation.mapToRegister(it.value()));
+    }
+  }
+}
+
 // NOTE: this is not a good algorithm, nor is it a good allocator. If you're
 // looking at this and have ideas of how to do this for real please feel
 // free to rip it all apart :)
@@ -211,6 +244,10 @@ static SmallVector<Block *, 8> sortBlocksInDominanceOrder(
 // ensure we are avoiding as many moves as possible. The special case we need to
 // handle is when values are not defined within the current block (as values in
 // dominators are allowed to cross block boundaries outside of arguments).
+//
+// Block arguments are coalesced with the registers of the values forwarded to
+// them from the first predecessor allocated when those registers are free so
+// that the branch from that predecessor needs no register moves.
 LogicalResult RegisterAllocation::recalculate(IREE::VM::FuncOp funcOp) {
   map_.clear();
 
@@ -226,6 +263,7 @@ LogicalResult RegisterAllocation::recalculate(IREE::VM::FuncOp funcOp) {
   // We are accumulating value->register mappings in |map_| as we go and since
   // we are traversing in order know that for each block we will have values in
   // the |map_| for all implicitly captured values.
+  llvm::DenseMap<Value, Register> blockArgHints;
   auto orderedBlocks = sortBlocksInDominanceOrder(funcOp);
   for (auto *block : orderedBlocks) {
     // Use the block live-in info to populate the register usage info at block
@@ -237,8 +275,16 @@ LogicalResult RegisterAllocation::recalculate(IREE::VM::FuncOp funcOp) {
       registerUsage.markRegisterUsed(mapToRegister(liveInValue));
     }
 
-    // Allocate arguments first from left-to-right.
+    // Allocate arguments first from left-to-right, preferring the register the
+    // value is already in when coming from an allocated predecessor.
     for (auto blockArg : block->getArguments()) {
+      auto hintIt = blockArgHints.find(blockArg);
+      if (hintIt != blockArgHints.end() &&
+          registerUsage.isRegisterAvailable(hintIt->second)) {
+        registerUsage.markRegisterUsed(hintIt->second);
+        map_[blockArg] = hintIt->second;
+        continue;
+      }
       auto reg = registerUsage.allocateRegister(blockArg.getType());
       if (!reg.hasValue()) {
         return funcOp.emitError() << "register allocation failed for block arg "
@@ -277,6 +323,8 @@ LogicalResult RegisterAllocation::recalculate(IREE::VM::FuncOp funcOp) {
       }
     }
 
+    recordBlockArgHints(block->getTerminator(), *this, blockArgHints);
+
     // Track the maximum register of each type used.
     maxI32RegisterOrdinal_ =
         std::max(maxI32RegisterOrdinal_, registerUsage.maxI32RegisterOrdinal);
@@ -528,6 +576,7 @@ RegisterAllocation::remapSuccessorRegisters(Operation *op, int successorIndex) {
 
   // If there's no cycles we can simply use the sorted DAG produced.
   if (feedbackArcSet.feedbackEdges.empty()) {
+    markRemapMoves(targetBlock, feedbackArcSet.acyclicEdges);
     return feedbackArcSet.acyclicEdges;
   }
 
@@ -566,8 +615,46 @@ RegisterAllocation::remapSuccessorRegisters(Operation *op, int successorIndex) {
     }
   }
 
+  markRemapMoves(targetBlock, feedbackArcSet.acyclicEdges);
   return feedbackArcSet.acyclicEdges;
 }
 
+void RegisterAllocation::markRemapMoves(
+    Block *targetBlock,
+    MutableArrayRef<std::pair<Register, Register>> srcDstRegs) {
+  // Ref registers that must retain their value after the branch: those of
+  // values live into the target block and of block arguments forwarded
+  // in-place (which have no remapping writing to them).
+  llvm::SmallDenseSet<int, 8> preservedRefOrdinals;
+  auto preserveRegister = [&](Register reg) {
+    if (reg.isRef()) preservedRefOrdinals.insert(reg.ordinal());
+  };
+  for (auto liveInValue : liveness_.getBlockLiveIns(targetBlock)) {
+    preserveRegister(mapToRegister(liveInValue));
+  }
+  for (auto blockArg : targetBlock->getArguments()) {
+    preserveRegister(mapToRegister(blockArg));
+  }
+  for (auto &srcDstReg : srcDstRegs) {
+    if (srcDstReg.second.isRef()) {
+      preservedRefOrdinals.erase(srcDstReg.second.ordinal());
+    }
+  }
+
+  // Walk backwards so we know whether a source register is read again by a
+  // later remapping. The last read of a ref register that is not preserved can
+  // transfer ownership to the destination and avoid a retain/release pair.
+  llvm::SmallDenseSet<int, 8> laterSrcRefOrdinals;
+  for (auto &srcDstReg : llvm::reverse(srcDstRegs)) {
+    auto &srcReg = srcDstReg.first;
+    if (!srcReg.isRef()) continue;
+    if (!preservedRefOrdinals.count(srcReg.ordinal()) &&
+        !laterSrcRefOrdinals.count(srcReg.ordinal())) {
+      srcReg.setMove(true);
+    }
+    laterSrcRefOrdinals.insert(srcReg.ordinal());
+  }
+}
+
 }  // namespace iree_compiler
 }  // namespace mlir
@@ -203,6 +203,12 @@ class RegisterAllocation {
       Operation *op, int successorIndex);
 
  private:
+  // Sets the move bit on source ref registers in the ordered |srcDstRegs| list
+  // that are not read by a later remapping nor used in |targetBlock|.
+  void markRemapMoves(
+      Block *targetBlock,
+      MutableArrayRef<std::pair<Register, Register>> srcDstRegs);
+
   int maxI32RegisterOrdinal_ = -1;
   int maxRefRegisterOrdinal_ = -1;
   int scratchI32RegisterCount_ = 0;
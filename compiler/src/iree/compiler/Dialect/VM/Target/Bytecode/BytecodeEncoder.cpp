@@ -10,14 +10,26 @@
 #include "iree/compiler/Dialect/VM/Analysis/RegisterAllocation.h"
 #include "iree/compiler/Dialect/VM/IR/VMDialect.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Statistic.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Diagnostics.h"
 
+#define DEBUG_TYPE "iree-vm-bytecode-encoder"
+
 namespace mlir {
 namespace iree_compiler {
 namespace IREE {
 namespace VM {
 
+// Frame sizes and register traffic of encoded functions. Printed with -stats
+// when LLVM is built with statistics enabled.
+STATISTIC(NumI32Registers, "Number of i32 registers in function frames");
+STATISTIC(NumRefRegisters, "Number of ref registers in function frames");
+STATISTIC(NumBranchRemaps, "Number of register moves emitted on branches");
+STATISTIC(NumBranchRefMoves,
+          "Number of branch ref remaps transferring ownership");
+STATISTIC(NumOperandRefMoves, "Number of ref operands transferring ownership");
+
 namespace {
 
 // v0 bytecode spec. This is in extreme flux and not guaranteed to be a stable
@@ -190,7 +202,9 @@ class V0BytecodeEncoder : public BytecodeEncoder {
     if (failed(ensureAlignment(2)) || failed(writeUint16(srcDstRegs.size()))) {
       return failure();
     }
+    NumBranchRemaps += srcDstRegs.size();
     for (auto srcDstReg : srcDstRegs) {
+      if (srcDstReg.first.isMove()) ++NumBranchRefMoves;
       if (failed(writeUint16(srcDstReg.first.encode())) ||
           failed(writeUint16(srcDstReg.second.encode()))) {
         return failure();
@@ -201,10 +215,10 @@ class V0BytecodeEncoder : public BytecodeEncoder {
   }
 
   LogicalResult encodeOperand(Value value, int ordinal) override {
-    uint16_t reg =
-        registerAllocation_->mapUseToRegister(value, currentOp_, ordinal)
-            .encode();
-    return writeUint16(reg);
+    auto reg =
+        registerAllocation_->mapUseToRegister(value, currentOp_, ordinal);
+    if (reg.isMove()) ++NumOperandRefMoves;
+    return writeUint16(reg.encode());
   }
 
   LogicalResult encodeOperands(Operation::operand_range values) override {
@@ -213,10 +227,10 @@ class V0BytecodeEncoder : public BytecodeEncoder {
       return failure();
     }
     for (auto it : llvm::enumerate(values)) {
-      uint16_t reg = registerAllocation_
-                         ->mapUseToRegister(it.value(), currentOp_, it.index())
-                         .encode();
-      if (failed(writeUint16(reg))) {
+      auto reg = registerAllocation_->mapUseToRegister(it.value(), currentOp_,
+                                                       it.index());
+      if (reg.isMove()) ++NumOperandRefMoves;
+      if (failed(writeUint16(reg.encode()))) {
         return failure();
       }
     }
@@ -242,6 +256,55 @@ class V0BytecodeEncoder : public BytecodeEncoder {
     return success();
   }
 
+  // Encodes |cmpOp| and the |condBranchOp| consuming its result as a single
+  // fused compare-and-branch superinstruction. The comparison result is never
+  // written to its register.
+  LogicalResult encodeCondBranchCmp(Operation *cmpOp,
+                                    IREE::VM::CondBranchOp condBranchOp,
+                                    IREE::VM::Opcode opcode) {
+    if (failed(beginOp(cmpOp)) ||
+        failed(encodeOpcode(stringifyOpcode(opcode),
+                            static_cast<int>(opcode))) ||
+        failed(encodeOperand(cmpOp->getOperand(0), 0)) ||
+        failed(encodeOperand(cmpOp->getOperand(1), 1)) ||
+        failed(endOp(cmpOp))) {
+      return failure();
+    }
+    if (failed(beginOp(condBranchOp)) ||
+        failed(encodeBranch(condBranchOp.getTrueDest(),
+                            condBranchOp.getTrueOperands(), 0)) ||
+        failed(encodeBranch(condBranchOp.getFalseDest(),
+                            condBranchOp.getFalseOperands(), 1)) ||
+        failed(endOp(condBranchOp))) {
+      return failure();
+    }
+    return success();
+  }
+
+  // Encodes a vm.cmp.nz.i32 |cmpOp| and the |condBranchOp| consuming its
+  // result as a vm.cond_br directly on the operand of the comparison.
+  // vm.cond_br already tests its condition for non-zero so the comparison is
+  // redundant.
+  LogicalResult encodeCondBranchNZ(IREE::VM::CmpNZI32Op cmpOp,
+                                   IREE::VM::CondBranchOp condBranchOp) {
+    auto opcode = IREE::VM::Opcode::CondBranch;
+    if (failed(beginOp(cmpOp)) ||
+        failed(encodeOpcode(stringifyOpcode(opcode),
+                            static_cast<int>(opcode))) ||
+        failed(encodeOperand(cmpOp.operand(), 0)) || failed(endOp(cmpOp))) {
+      return failure();
+    }
+    if (failed(beginOp(condBranchOp)) ||
+        failed(encodeBranch(condBranchOp.getTrueDest(),
+                            condBranchOp.getTrueOperands(), 0)) ||
+        failed(encodeBranch(condBranchOp.getFalseDest(),
+                            condBranchOp.getFalseOperands(), 1)) ||
+        failed(endOp(condBranchOp))) {
+      return failure();
+    }
+    return success();
+  }
+
   Optional<std::vector<uint8_t>> finish() {
     if (failed(fixupOffsets())) {
       return llvm::None;
@@ -324,12 +387,58 @@ class V0BytecodeEncoder : public BytecodeEncoder {
   std::vector<std::pair<Block *, size_t>> blockOffsetFixups_;
 };
 
+// Returns the vm.cond_br immediately following |op| if it is the only user of
+// the result of |op| and the two can be fused into a single instruction.
+static IREE::VM::CondBranchOp getFusableCondBranch(Operation &op) {
+  if (op.getNumResults() != 1 || !op.getResult(0).hasOneUse()) return {};
+  auto condBranchOp =
+      dyn_cast_or_null<IREE::VM::CondBranchOp>(op.getNextNode());
+  if (!condBranchOp || condBranchOp.condition() != op.getResult(0)) return {};
+  return condBranchOp;
+}
+
+// Returns the compare-and-branch superinstruction opcode for a comparison op.
+static Optional<IREE::VM::Opcode> getCondBranchCmpOpcode(Operation &op) {
+  using IREE::VM::Opcode;
+  if (isa<IREE::VM::CmpEQI32Op>(op)) return Opcode::CondBranchCmpEQI32;
+  if (isa<IREE::VM::CmpNEI32Op>(op)) return Opcode::CondBranchCmpNEI32;
+  if (isa<IREE::VM::CmpLTI32SOp>(op)) return Opcode::CondBranchCmpLTI32S;
+  if (isa<IREE::VM::CmpLTI32UOp>(op)) return Opcode::CondBranchCmpLTI32U;
+  if (isa<IREE::VM::CmpEQI64Op>(op)) return Opcode::CondBranchCmpEQI64;
+  if (isa<IREE::VM::CmpNEI64Op>(op)) return Opcode::CondBranchCmpNEI64;
+  if (isa<IREE::VM::CmpLTI64SOp>(op)) return Opcode::CondBranchCmpLTI64S;
+  if (isa<IREE::VM::CmpLTI64UOp>(op)) return Opcode::CondBranchCmpLTI64U;
+  return llvm::None;
+}
+
+// Tries to encode |op| fused with the op following it as a superinstruction.
+// Returns true if |op| and its successor were both encoded.
+static FailureOr<bool> tryEncodeSuperinstruction(Operation &op,
+                                                 V0BytecodeEncoder &encoder) {
+  auto condBranchOp = getFusableCondBranch(op);
+  if (!condBranchOp) return false;
+  if (auto cmpNZOp = dyn_cast<IREE::VM::CmpNZI32Op>(op)) {
+    if (failed(encoder.encodeCondBranchNZ(cmpNZOp, condBranchOp))) {
+      return failure();
+    }
+    return true;
+  }
+  if (auto opcode = getCondBranchCmpOpcode(op)) {
+    if (failed(encoder.encodeCondBranchCmp(&op, condBranchOp, *opcode))) {
+      return failure();
+    }
+    return true;
+  }
+  return false;
+}
+
 }  // namespace
 
 // static
 Optional<EncodedBytecodeFunction> BytecodeEncoder::encodeFunction(
     IREE::VM::FuncOp funcOp, llvm::DenseMap<Type, int> &typeTable,
-    SymbolTable &symbolTable, DebugDatabaseBuilder &debugDatabase) {
+    SymbolTable &symbolTable, DebugDatabaseBuilder &debugDatabase,
+    BytecodeTargetOptions targetOptions) {
   EncodedBytecodeFunction result;
 
   // Perform register allocation first so that we can quickly lookup values as
@@ -350,7 +459,8 @@ Optional<EncodedBytecodeFunction> BytecodeEncoder::encodeFunction(
       return llvm::None;
     }
 
-    for (auto &op : block.getOperations()) {
+    for (auto it = block.begin(); it != block.end(); ++it) {
+      auto &op = *it;
       auto serializableOp = dyn_cast<IREE::VM::VMSerializableOp>(op);
       if (!serializableOp) {
         op.emitOpError() << "is not serializable";
@@ -358,6 +468,17 @@ Optional<EncodedBytecodeFunction> BytecodeEncoder::encodeFunction(
       }
       sourceMap.locations.push_back(
           {static_cast<int32_t>(encoder.getOffset()), op.getLoc()});
+      if (targetOptions.emitSuperinstructions) {
+        auto fused = tryEncodeSuperinstruction(op, encoder);
+        if (failed(fused)) {
+          op.emitOpError() << "failed to encode superinstruction";
+          return llvm::None;
+        }
+        if (*fused) {
+          ++it;  // skip the fused successor op
+          continue;
+        }
+      }
       if (failed(encoder.beginOp(&op)) ||
           failed(serializableOp.encode(symbolTable, encoder)) ||
           failed(encoder.endOp(&op))) {
@@ -386,6 +507,8 @@ Optional<EncodedBytecodeFunction> BytecodeEncoder::encodeFunction(
   result.bytecodeData = bytecodeData.getValue();
   result.i32RegisterCount = registerAllocation.getMaxI32RegisterOrdinal() + 1;
   result.refRegisterCount = registerAllocation.getMaxRefRegisterOrdinal() + 1;
+  NumI32Registers += result.i32RegisterCount;
+  NumRefRegisters += result.refRegisterCount;
   return result;
 }
 
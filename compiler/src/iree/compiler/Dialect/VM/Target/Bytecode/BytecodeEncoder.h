@@ -9,6 +9,7 @@
 
 #include "iree/compiler/Dialect/VM/IR/VMFuncEncoder.h"
 #include "iree/compiler/Dialect/VM/IR/VMOps.h"
+#include "iree/compiler/Dialect/VM/Target/Bytecode/BytecodeModuleTarget.h"
 #include "iree/compiler/Dialect/VM/Target/Bytecode/DebugDatabaseBuilder.h"
 #include "mlir/IR/SymbolTable.h"
 
@@ -34,14 +35,15 @@ class BytecodeEncoder : public VMFuncEncoder {
   // Matches IREE_VM_BYTECODE_VERSION_MAJOR.
   static constexpr uint32_t kVersionMajor = 4;
   // Matches IREE_VM_BYTECODE_VERSION_MINOR.
-  static constexpr uint32_t kVersionMinor = 0;
+  static constexpr uint32_t kVersionMinor = 1;
   static constexpr uint32_t kVersion = (kVersionMajor << 16) | kVersionMinor;
 
   // Encodes a vm.func to bytecode and returns the result.
   // Returns None on failure.
   static Optional<EncodedBytecodeFunction> encodeFunction(
       IREE::VM::FuncOp funcOp, llvm::DenseMap<Type, int> &typeTable,
-      SymbolTable &symbolTable, DebugDatabaseBuilder &debugDatabase);
+      SymbolTable &symbolTable, DebugDatabaseBuilder &debugDatabase,
+      BytecodeTargetOptions targetOptions);
 
   BytecodeEncoder() = default;
   ~BytecodeEncoder() = default;
@@ -7,6 +7,7 @@
 #include "iree/compiler/Dialect/VM/Target/Bytecode/BytecodeModuleTarget.h"
 
 #include <algorithm>
+#include <cstring>
 
 #include "iree/compiler/Dialect/Util/IR/UtilDialect.h"
 #include "iree/compiler/Dialect/Util/IR/UtilOps.h"
@@ -308,6 +309,44 @@ static iree_vm_FunctionSignatureDef_ref_t makeInternalFunctionSignatureDef(
                                     fbb);
 }
 
+// Returns the ordinals of ref globals that may be stored to after module
+// initialization. Global initialization marks all globals stored by __init as
+// mutable but the objects those reference are only ever assigned once and can
+// be shared across forked contexts at runtime.
+static SmallVector<int32_t, 8> findMutableGlobalRefOrdinals(
+    IREE::VM::ModuleOp moduleOp, SymbolTable &symbolTable) {
+  // Indirect stores have had their global addresses converted to ordinals and
+  // may target any global.
+  bool hasIndirectStores = false;
+  moduleOp.walk([&](IREE::VM::GlobalStoreIndirectRefOp op) {
+    hasIndirectStores = true;
+  });
+
+  SmallVector<int32_t, 8> ordinals;
+  for (auto globalOp : moduleOp.getOps<IREE::VM::GlobalRefOp>()) {
+    if (!globalOp.isMutable()) continue;
+    bool storedAfterInit =
+        hasIndirectStores ||
+        !cast<SymbolOpInterface>(globalOp.getOperation()).isPrivate();
+    auto uses = symbolTable.getSymbolUses(globalOp, moduleOp);
+    if (uses.hasValue()) {
+      for (auto use : uses.getValue()) {
+        auto *user = use.getUser();
+        if (!isa<IREE::VM::GlobalStoreRefOp>(user)) continue;
+        auto funcOp = user->getParentOfType<IREE::VM::FuncOp>();
+        if (!funcOp || (funcOp.getName() != "__init" &&
+                        funcOp.getName() != "__deinit")) {
+          storedAfterInit = true;
+        }
+      }
+    }
+    if (storedAfterInit) {
+      ordinals.push_back(globalOp.ordinal().getValue().getLimitedValue());
+    }
+  }
+  return ordinals;
+}
+
 // Builds a complete BytecodeModuleDef FlatBuffer object in |fbb|.
 // The order of the encoding is ordered to ensure that all metadata is at the
 // front of the resulting buffer. Large read-only data and bytecode blobs always
@@ -320,7 +359,8 @@ static iree_vm_FunctionSignatureDef_ref_t makeInternalFunctionSignatureDef(
 // representation at runtime.
 static LogicalResult buildFlatBufferModule(
     BytecodeTargetOptions targetOptions, IREE::VM::ModuleOp moduleOp,
-    MutableArrayRef<RodataRef> rodataRefs, FlatbufferBuilder &fbb) {
+    MutableArrayRef<RodataRef> rodataRefs,
+    ArrayRef<BytecodeNativeImage> nativeImages, FlatbufferBuilder &fbb) {
   // Start the buffer so that we can begin recording data prior to the root
   // table (which we do at the very end). This does not change the layout of the
   // file and is only used to prime the flatcc builder.
@@ -373,7 +413,8 @@ static LogicalResult buildFlatBufferModule(
   size_t totalBytecodeLength = 0;
   for (auto funcOp : llvm::enumerate(internalFuncOps)) {
     auto encodedFunction = BytecodeEncoder::encodeFunction(
-        funcOp.value(), typeOrdinalMap, symbolTable, debugDatabase);
+        funcOp.value(), typeOrdinalMap, symbolTable, debugDatabase,
+        targetOptions);
     if (!encodedFunction) {
       return funcOp.value().emitError() << "failed to encode function bytecode";
     }
@@ -495,11 +536,21 @@ static LogicalResult buildFlatBufferModule(
   int32_t globalRefs = ordinalCounts.global_refs();
   int32_t globalBytes = ordinalCounts.global_bytes();
 
+  auto mutableGlobalRefOrdinals =
+      findMutableGlobalRefOrdinals(moduleOp, symbolTable);
+
   iree_vm_ModuleStateDef_ref_t moduleStateDef = 0;
   if (globalBytes || globalRefs) {
+    flatbuffers_int32_vec_ref_t mutableGlobalRefsRef = 0;
+    if (!mutableGlobalRefOrdinals.empty()) {
+      mutableGlobalRefsRef = flatbuffers_int32_vec_create(
+          fbb, mutableGlobalRefOrdinals.data(),
+          mutableGlobalRefOrdinals.size());
+    }
     iree_vm_ModuleStateDef_start(fbb);
     iree_vm_ModuleStateDef_global_bytes_capacity_add(fbb, globalBytes);
     iree_vm_ModuleStateDef_global_ref_count_add(fbb, globalRefs);
+    iree_vm_ModuleStateDef_mutable_global_refs_add(fbb, mutableGlobalRefsRef);
     moduleStateDef = iree_vm_ModuleStateDef_end(fbb);
   }
 
@@ -508,6 +559,28 @@ static LogicalResult buildFlatBufferModule(
     debugDatabaseRef = debugDatabase.build(fbb);
   }
 
+  // Native images are ELF files and are aligned so that the loader can read
+  // the headers in-place.
+  flatbuffers_vec_ref_t nativeImagesRef = 0;
+  if (!nativeImages.empty()) {
+    SmallVector<iree_vm_NativeImageDef_ref_t> nativeImageRefs;
+    for (auto &nativeImage : nativeImages) {
+      auto targetTripleRef = fbb.createString(nativeImage.targetTriple);
+      flatcc_builder_start_vector(fbb, 1, kDefaultRodataAlignment,
+                                  FLATBUFFERS_COUNT_MAX(1));
+      uint8_t *imagePtr =
+          flatbuffers_uint8_vec_extend(fbb, nativeImage.data.size());
+      std::memcpy(imagePtr, nativeImage.data.data(), nativeImage.data.size());
+      auto imageRef = flatbuffers_uint8_vec_end(fbb);
+      iree_vm_NativeImageDef_start(fbb);
+      iree_vm_NativeImageDef_target_triple_add(fbb, targetTripleRef);
+      iree_vm_NativeImageDef_abi_version_add(fbb, nativeImage.abiVersion);
+      iree_vm_NativeImageDef_image_add(fbb, imageRef);
+      nativeImageRefs.push_back(iree_vm_NativeImageDef_end(fbb));
+    }
+    nativeImagesRef = fbb.createOffsetVecDestructive(nativeImageRefs);
+  }
+
   auto moduleNameRef = fbb.createString(
       moduleOp.sym_name().empty() ? "module" : moduleOp.sym_name());
 
@@ -524,14 +597,15 @@ static LogicalResult buildFlatBufferModule(
                                                  BytecodeEncoder::kVersion);
   iree_vm_BytecodeModuleDef_bytecode_data_add(fbb, bytecodeDataRef);
   iree_vm_BytecodeModuleDef_debug_database_add(fbb, debugDatabaseRef);
+  iree_vm_BytecodeModuleDef_native_images_add(fbb, nativeImagesRef);
   iree_vm_BytecodeModuleDef_end_as_root(fbb);
 
   return success();
 }
 
-LogicalResult translateModuleToBytecode(IREE::VM::ModuleOp moduleOp,
-                                        BytecodeTargetOptions targetOptions,
-                                        llvm::raw_ostream &output) {
+LogicalResult translateModuleToBytecode(
+    IREE::VM::ModuleOp moduleOp, BytecodeTargetOptions targetOptions,
+    llvm::raw_ostream &output, ArrayRef<BytecodeNativeImage> nativeImages) {
   moduleOp.getContext()->getOrLoadDialect<IREE::Util::UtilDialect>();
 
   if (failed(canonicalizeModule(targetOptions, moduleOp))) {
@@ -640,7 +714,8 @@ LogicalResult translateModuleToBytecode(IREE::VM::ModuleOp moduleOp,
   // the first few pages need to be accessed to get the metadata and the rest
   // can be large bulk data.
   FlatbufferBuilder fbb;
-  if (failed(buildFlatBufferModule(targetOptions, moduleOp, rodataRefs, fbb))) {
+  if (failed(buildFlatBufferModule(targetOptions, moduleOp, rodataRefs,
+                                   nativeImages, fbb))) {
     return failure();
   }
   if (failed(archiveWriter->flush(fbb))) {
@@ -651,15 +726,16 @@ LogicalResult translateModuleToBytecode(IREE::VM::ModuleOp moduleOp,
   return success();
 }
 
-LogicalResult translateModuleToBytecode(mlir::ModuleOp outerModuleOp,
-                                        BytecodeTargetOptions targetOptions,
-                                        llvm::raw_ostream &output) {
+LogicalResult translateModuleToBytecode(
+    mlir::ModuleOp outerModuleOp, BytecodeTargetOptions targetOptions,
+    llvm::raw_ostream &output, ArrayRef<BytecodeNativeImage> nativeImages) {
   auto moduleOps = outerModuleOp.getOps<IREE::VM::ModuleOp>();
   if (moduleOps.empty()) {
     return outerModuleOp.emitError()
            << "outer module does not contain a vm.module op";
   }
-  return translateModuleToBytecode(*moduleOps.begin(), targetOptions, output);
+  return translateModuleToBytecode(*moduleOps.begin(), targetOptions, output,
+                                   nativeImages);
 }
 
 void BytecodeTargetOptions::bindOptions(OptionsBinder &binder) {
@@ -696,6 +772,11 @@ void BytecodeTargetOptions::bindOptions(OptionsBinder &binder) {
   binder.opt<bool>("iree-vm-bytecode-module-strip-debug-ops", stripDebugOps,
                    llvm::cl::cat(vmBytecodeOptionsCategory),
                    llvm::cl::desc("Strips debug-only ops from the module"));
+  binder.opt<bool>(
+      "iree-vm-bytecode-module-emit-superinstructions", emitSuperinstructions,
+      llvm::cl::cat(vmBytecodeOptionsCategory),
+      llvm::cl::desc("Fuses common op sequences (such as compare-and-branch) "
+                     "into single superinstructions when encoding"));
   binder.opt<bool>(
       "iree-vm-emit-polyglot-zip", emitPolyglotZip,
       llvm::cl::cat(vmBytecodeOptionsCategory),
@@ -7,6 +7,9 @@
 #ifndef IREE_COMPILER_DIALECT_VM_TARGET_BYTECODE_BYTECODEMODULETARGET_H_
 #define IREE_COMPILER_DIALECT_VM_TARGET_BYTECODE_BYTECODEMODULETARGET_H_
 
+#include <string>
+#include <vector>
+
 #include "iree/compiler/Dialect/VM/IR/VMOps.h"
 #include "iree/compiler/Utils/OptionUtils.h"
 #include "llvm/Support/raw_ostream.h"
@@ -50,6 +53,10 @@ struct BytecodeTargetOptions {
   // Strips vm ops with the VM_DebugOnly trait.
   bool stripDebugOps = false;
 
+  // Fuses common sequences of ops into superinstructions during encoding.
+  // This reduces interpreter dispatch overhead in control-flow heavy code.
+  bool emitSuperinstructions = true;
+
   // Enables the output .vmfb to be inspected as a ZIP file.
   // This is useful for debugging/diagnosing issues as embedded executables can
   // be extracted and inspected. It adds several KB to the output files and
@@ -60,17 +67,32 @@ struct BytecodeTargetOptions {
   using FromFlags = OptionsFromFlags<BytecodeTargetOptions>;
 };
 
+// An ahead-of-time compiled native image of a vm.module embedded in the
+// bytecode module alongside the bytecode.
+// See NativeImageDef in iree/schemas/bytecode_module_def.fbs.
+struct BytecodeNativeImage {
+  // Target triple the image was compiled for.
+  std::string targetTriple;
+  // Runtime native image ABI version (IREE_VM_NATIVE_IMAGE_VERSION_*).
+  uint32_t abiVersion = 0;
+  // ELF shared object contents.
+  std::vector<uint8_t> data;
+};
+
 // Translates a vm.module to a bytecode module FlatBuffer.
 // See iree/schemas/bytecode_module_def.fbs for the description of the
-// serialized module format.
+// serialized module format. Any |nativeImages| of the module are embedded
+// as-is.
 //
 // Exposed via the --iree-vm-ir-to-bytecode-module translation.
-LogicalResult translateModuleToBytecode(IREE::VM::ModuleOp moduleOp,
-                                        BytecodeTargetOptions targetOptions,
-                                        llvm::raw_ostream &output);
-LogicalResult translateModuleToBytecode(mlir::ModuleOp outerModuleOp,
-                                        BytecodeTargetOptions targetOptions,
-                                        llvm::raw_ostream &output);
+LogicalResult translateModuleToBytecode(
+    IREE::VM::ModuleOp moduleOp, BytecodeTargetOptions targetOptions,
+    llvm::raw_ostream &output,
+    ArrayRef<BytecodeNativeImage> nativeImages = {});
+LogicalResult translateModuleToBytecode(
+    mlir::ModuleOp outerModuleOp, BytecodeTargetOptions targetOptions,
+    llvm::raw_ostream &output,
+    ArrayRef<BytecodeNativeImage> nativeImages = {});
 
 }  // namespace VM
 }  // namespace IREE
@@ -0,0 +1,44 @@
+// RUN: iree-compile --split-input-file --compile-mode=vm \
+// RUN: --iree-vm-bytecode-module-output-format=flatbuffer-text %s | FileCheck %s
+
+// Ref globals only stored by initializers can be shared by forked contexts.
+
+// CHECK-LABEL: "name": "initialized_module"
+// CHECK: "module_state":
+// CHECK-NOT: "mutable_global_refs"
+// CHECK: "function_descriptors"
+vm.module @initialized_module {
+  vm.global.ref private @g0 : !vm.buffer
+  vm.initializer {
+    %c16 = vm.const.i64 16
+    %buffer = vm.buffer.alloc %c16 : !vm.buffer
+    vm.global.store.ref %buffer, @g0 : !vm.buffer
+    vm.return
+  }
+  vm.export @get
+  vm.func @get() -> !vm.buffer {
+    %buffer = vm.global.load.ref @g0 : !vm.buffer
+    vm.return %buffer : !vm.buffer
+  }
+}
+
+// -----
+
+// Ref globals stored after initialization are recorded as mutable.
+
+// CHECK-LABEL: "name": "mutable_module"
+// CHECK: "module_state":
+// CHECK: "mutable_global_refs":
+vm.module @mutable_module {
+  vm.global.ref private mutable @g0 : !vm.buffer
+  vm.export @set
+  vm.func @set(%buffer : !vm.buffer) {
+    vm.global.store.ref %buffer, @g0 : !vm.buffer
+    vm.return
+  }
+  vm.export @get
+  vm.func @get() -> !vm.buffer {
+    %buffer = vm.global.load.ref @g0 : !vm.buffer
+    vm.return %buffer : !vm.buffer
+  }
+}
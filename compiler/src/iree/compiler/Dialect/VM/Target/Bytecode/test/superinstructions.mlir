@@ -0,0 +1,93 @@
+// RUN: iree-compile --split-input-file --compile-mode=vm \
+// RUN: --iree-vm-bytecode-module-output-format=flatbuffer-text %s | FileCheck %s
+// RUN: iree-compile --split-input-file --compile-mode=vm \
+// RUN: --iree-vm-bytecode-module-output-format=flatbuffer-text \
+// RUN: --iree-vm-bytecode-module-emit-superinstructions=false %s | \
+// RUN: FileCheck %s --check-prefix=NOFUSE
+
+// Comparisons only used by the following vm.cond_br are fused into a single
+// compare-and-branch instruction.
+
+vm.module @cmp_branch {
+  vm.export @func
+  vm.func @func(%arg0 : i32, %arg1 : i32) -> i32 {
+    %cmp = vm.cmp.lt.i32.s %arg0, %arg1 : i32
+    vm.cond_br %cmp, ^bb1, ^bb2
+  ^bb1:
+    vm.return %arg0 : i32
+  ^bb2:
+    vm.return %arg1 : i32
+  }
+
+  //      CHECK: "bytecode_data": [
+  // CondBranchCmpLTI32S %arg0, %arg1
+  // CHECK-NEXT:   121,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   1,
+  // CHECK-NEXT:   0,
+  // ^bb1 with no remapped registers
+  // CHECK-NEXT:   18,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+  // ^bb2 with no remapped registers
+  // CHECK-NEXT:   24,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+  // ^bb1: Return
+  // CHECK-NEXT:   90,
+
+  // CmpLTI32S followed by CondBranch
+  //      NOFUSE: "bytecode_data": [
+  // NOFUSE-NEXT:   75,
+}
+
+// -----
+
+// Comparisons with other uses must still write their result and are not fused.
+
+vm.module @cmp_multi_use {
+  vm.export @func
+  vm.func @func(%arg0 : i32, %arg1 : i32) -> i32 {
+    %cmp = vm.cmp.eq.i32 %arg0, %arg1 : i32
+    vm.cond_br %cmp, ^bb1, ^bb2
+  ^bb1:
+    vm.return %cmp : i32
+  ^bb2:
+    vm.return %arg1 : i32
+  }
+
+  // CmpEQI32 followed by CondBranch
+  //      CHECK: "bytecode_data": [
+  // CHECK-NEXT:   73,
+}
+
+// -----
+
+// vm.cond_br already tests for non-zero and branches directly on the operand
+// of a vm.cmp.nz.i32.
+
+vm.module @cmp_nz_branch {
+  vm.export @func
+  vm.func @func(%arg0 : i32, %arg1 : i32) -> i32 {
+    %nz = vm.cmp.nz.i32 %arg0 : i32
+    vm.cond_br %nz, ^bb1, ^bb2
+  ^bb1:
+    vm.return %arg0 : i32
+  ^bb2:
+    vm.return %arg1 : i32
+  }
+
+  // CondBranch %arg0
+  //      CHECK: "bytecode_data": [
+  // CHECK-NEXT:   87,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+}
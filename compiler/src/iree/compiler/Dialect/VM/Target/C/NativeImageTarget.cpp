@@ -0,0 +1,327 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/VM/Target/C/NativeImageTarget.h"
+
+#include "iree/compiler/Dialect/VM/Target/C/native_image_headers.h"
+#include "llvm/ADT/ScopeExit.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/IR/BuiltinOps.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace VM {
+
+// IREE_VM_NATIVE_IMAGE_VERSION_LATEST in iree/vm/native_image.h.
+// Must be bumped with the runtime when the API used by generated C modules
+// changes.
+static constexpr uint32_t kNativeImageABIVersion = 0;
+
+// Writes the C source of the native image for |moduleOp| to |os|.
+// The generated C module is followed by the exported query function the
+// runtime uses to create the module.
+static LogicalResult writeNativeImageSource(mlir::ModuleOp outerModuleOp,
+                                            IREE::VM::ModuleOp moduleOp,
+                                            CTargetOptions cTargetOptions,
+                                            llvm::raw_ostream &os) {
+  std::string moduleName = moduleOp.getName().str();
+  os << "#define EMITC_IMPLEMENTATION\n";
+  cTargetOptions.outputFormat = COutputFormat::kCode;
+  if (failed(translateModuleToC(outerModuleOp, cTargetOptions, os))) {
+    return failure();
+  }
+  os << "\n";
+  os << "#include \"iree/vm/native_image.h\"\n";
+  os << "\n";
+  os << "static const iree_vm_native_image_v0_t iree_vm_native_image_v0 = {\n";
+  os << "    /*.version=*/" << kNativeImageABIVersion << ",\n";
+  os << "    /*.name=*/\"" << moduleName << "\",\n";
+  os << "    /*.create_module=*/" << moduleName << "_create,\n";
+  os << "};\n";
+  os << "\n";
+  os << "__attribute__((visibility(\"default\")))\n";
+  os << "const iree_vm_native_image_v0_t* iree_vm_native_image_query(\n";
+  os << "    iree_vm_native_image_version_t max_version) {\n";
+  os << "  if (max_version < " << kNativeImageABIVersion << ") return NULL;\n";
+  os << "  return &iree_vm_native_image_v0;\n";
+  os << "}\n";
+  return success();
+}
+
+// Returns the absolute path of the first of |toolNames| found next to the
+// running executable, in the LLVM build tree, or on the system PATH.
+static std::string findTool(ArrayRef<StringRef> toolNames) {
+  std::string mainExecutablePath =
+      llvm::sys::fs::getMainExecutable(nullptr, nullptr);
+  SmallString<256> mainExecutableDir(mainExecutablePath);
+  llvm::sys::path::remove_filename(mainExecutableDir);
+  SmallString<256> buildTreeDir(mainExecutableDir);
+  llvm::sys::path::append(buildTreeDir, "..", "..", "third_party",
+                          "llvm-project", "llvm", "bin");
+  for (StringRef searchDir : {mainExecutableDir.str(), buildTreeDir.str()}) {
+    for (auto toolName : toolNames) {
+      if (auto toolPath = llvm::sys::findProgramByName(toolName, {searchDir})) {
+        return *toolPath;
+      }
+    }
+  }
+  for (auto toolName : toolNames) {
+    if (auto toolPath = llvm::sys::findProgramByName(toolName)) {
+      return *toolPath;
+    }
+  }
+  return "";
+}
+
+// Returns the path of |explicitPath| if specified and otherwise searches for
+// the first of |toolNames|.
+static FailureOr<std::string> resolveTool(Location loc, StringRef explicitPath,
+                                          ArrayRef<StringRef> toolNames,
+                                          StringRef optionName) {
+  if (!explicitPath.empty()) {
+    auto toolPath = llvm::sys::findProgramByName(explicitPath);
+    if (!toolPath) {
+      return mlir::emitError(loc)
+             << "native image tool '" << explicitPath
+             << "' not found: " << toolPath.getError().message();
+    }
+    return *toolPath;
+  }
+  std::string toolPath = findTool(toolNames);
+  if (toolPath.empty()) {
+    std::string toolList;
+    llvm::raw_string_ostream toolListStream(toolList);
+    llvm::interleaveComma(toolNames, toolListStream);
+    return mlir::emitError(loc)
+           << "native image tool not found next to the compiler or on the "
+              "system PATH (searched for "
+           << toolListStream.str() << "); specify one with --" << optionName;
+  }
+  return toolPath;
+}
+
+// Writes the runtime headers used by the generated C module to |includeDir|.
+// The headers are embedded in the compiler so that native images are always
+// compiled against the runtime ABI the compiler was built with.
+static LogicalResult writeRuntimeHeaders(Location loc, StringRef includeDir) {
+  for (const iree_file_toc_t *file = iree_vm_native_image_headers_create();
+       file->name != nullptr; ++file) {
+    SmallString<128> filePath(includeDir);
+    llvm::sys::path::append(filePath, file->name);
+    if (auto error = llvm::sys::fs::create_directories(
+            llvm::sys::path::parent_path(filePath))) {
+      return mlir::emitError(loc) << "failed to create directory for '"
+                                  << filePath << "': " << error.message();
+    }
+    std::error_code error;
+    llvm::raw_fd_ostream fileStream(filePath, error);
+    if (error) {
+      return mlir::emitError(loc)
+             << "failed to open '" << filePath << "': " << error.message();
+    }
+    fileStream.write(file->data, file->size);
+  }
+  return success();
+}
+
+// Runs |args| and returns failure with the command line if it fails.
+static LogicalResult runTool(Location loc, ArrayRef<StringRef> args) {
+  std::string errorMessage;
+  int exitCode = llvm::sys::ExecuteAndWait(
+      args[0], args, /*Env=*/llvm::None, /*Redirects=*/{},
+      /*SecondsToWait=*/0, /*MemoryLimit=*/0, &errorMessage);
+  if (exitCode != 0) {
+    std::string commandLine;
+    llvm::raw_string_ostream commandLineStream(commandLine);
+    llvm::interleave(args, commandLineStream, " ");
+    return mlir::emitError(loc)
+           << "native image compilation failed with exit code " << exitCode
+           << (errorMessage.empty() ? "" : ": ") << errorMessage
+           << "; command line: " << commandLineStream.str();
+  }
+  return success();
+}
+
+// Compiles |sourcePath| against the headers in |includeDir| into an object at
+// |objectPath| and links it into a shared object at |imagePath|.
+// The image is linked without any libraries: all runtime and C library
+// symbols are resolved by the runtime loader from its import table.
+static LogicalResult compileNativeImage(
+    Location loc, const NativeImageTargetOptions &targetOptions,
+    StringRef includeDir, StringRef sourcePath, StringRef objectPath,
+    StringRef imagePath) {
+  auto compilerPath =
+      resolveTool(loc, targetOptions.compilerPath, {"clang"},
+                  "iree-vm-native-image-compiler");
+  if (failed(compilerPath)) return failure();
+  auto linkerPath =
+      resolveTool(loc, targetOptions.linkerPath, {"iree-lld", "lld", "ld.lld"},
+                  "iree-vm-native-image-linker");
+  if (failed(linkerPath)) return failure();
+
+  std::string includeFlag = ("-I" + includeDir).str();
+  SmallVector<StringRef> compileArgs = {
+      *compilerPath,
+      "-target",
+      targetOptions.targetTriple,
+      "-x",
+      "c",
+      "-std=c11",
+      "-O3",
+      "-fPIC",
+      "-fvisibility=hidden",
+      "-fno-stack-protector",
+      "-fno-exceptions",
+      "-fno-asynchronous-unwind-tables",
+      includeFlag,
+  };
+  for (auto &flag : targetOptions.extraFlags) compileArgs.push_back(flag);
+  compileArgs.append({"-c", sourcePath, "-o", objectPath});
+  if (failed(runTool(loc, compileArgs))) return failure();
+
+  SmallVector<StringRef> linkArgs = {*linkerPath};
+  if (!llvm::sys::path::filename(*linkerPath).startswith("ld.lld")) {
+    // Forces lld to act like gnu ld and produce ELF files; must be first as
+    // lld sniffs argv[1]/argv[2] when not invoked as ld.lld.
+    linkArgs.append({"-flavor", "gnu"});
+  }
+  linkArgs.append({
+      "--build-id=none",
+      "-nostdlib",
+      "-shared",
+      "-z",
+      "now",
+      "--hash-style=sysv",
+      "--gc-sections",
+      objectPath,
+      "-o",
+      imagePath,
+  });
+  return runTool(loc, linkArgs);
+}
+
+LogicalResult buildNativeImages(
+    mlir::ModuleOp outerModuleOp, const NativeImageTargetOptions &targetOptions,
+    CTargetOptions cTargetOptions,
+    SmallVectorImpl<BytecodeNativeImage> &nativeImages) {
+  if (targetOptions.targetTriple.empty()) return success();
+
+  auto moduleOps = outerModuleOp.getOps<IREE::VM::ModuleOp>();
+  if (moduleOps.empty()) {
+    return outerModuleOp.emitError()
+           << "outer module does not contain a vm.module op";
+  }
+  auto moduleOp = *moduleOps.begin();
+  auto loc = moduleOp.getLoc();
+
+  // The C translation runs its own conversion pipeline in-place so we operate
+  // on a clone to leave the module untouched for bytecode serialization.
+  OwningOpRef<mlir::ModuleOp> clonedOuterModuleOp(outerModuleOp.clone());
+  auto clonedModuleOp =
+      *clonedOuterModuleOp->getOps<IREE::VM::ModuleOp>().begin();
+
+  // All intermediate files are placed in a single temporary directory that
+  // also contains the runtime headers.
+  SmallString<128> tempDir;
+  if (auto error = llvm::sys::fs::createUniqueDirectory(
+          "iree-native-image-" + moduleOp.getName(), tempDir)) {
+    return mlir::emitError(loc) << "failed to create temporary directory: "
+                                << error.message();
+  }
+  auto tempDirRemover = llvm::make_scope_exit([&]() {
+    if (!targetOptions.keepTemporaries) {
+      (void)llvm::sys::fs::remove_directories(tempDir);
+    }
+  });
+  if (targetOptions.keepTemporaries) {
+    llvm::errs() << "native image temporaries: " << tempDir << "\n";
+  }
+  SmallString<128> includeDir(tempDir);
+  llvm::sys::path::append(includeDir, "include");
+  SmallString<128> sourcePath(tempDir);
+  llvm::sys::path::append(sourcePath, moduleOp.getName() + ".c");
+  SmallString<128> objectPath(tempDir);
+  llvm::sys::path::append(objectPath, moduleOp.getName() + ".o");
+  SmallString<128> imagePath(tempDir);
+  llvm::sys::path::append(imagePath, moduleOp.getName() + ".so");
+
+  if (failed(writeRuntimeHeaders(loc, includeDir))) return failure();
+
+  {
+    std::error_code error;
+    llvm::raw_fd_ostream sourceStream(sourcePath, error);
+    if (error) {
+      return mlir::emitError(loc) << "failed to open '" << sourcePath
+                                  << "': " << error.message();
+    }
+    if (failed(writeNativeImageSource(*clonedOuterModuleOp, clonedModuleOp,
+                                      cTargetOptions, sourceStream))) {
+      return mlir::emitError(loc) << "failed to translate module to C";
+    }
+  }
+
+  if (failed(compileNativeImage(loc, targetOptions, includeDir, sourcePath,
+                                objectPath, imagePath))) {
+    return failure();
+  }
+
+  auto imageBuffer = llvm::MemoryBuffer::getFile(imagePath);
+  if (!imageBuffer) {
+    return mlir::emitError(loc) << "failed to read native image '" << imagePath
+                                << "': " << imageBuffer.getError().message();
+  }
+  auto imageData = imageBuffer.get()->getBuffer();
+
+  BytecodeNativeImage nativeImage;
+  nativeImage.targetTriple = targetOptions.targetTriple;
+  nativeImage.abiVersion = kNativeImageABIVersion;
+  nativeImage.data.assign(imageData.begin(), imageData.end());
+  nativeImages.push_back(std::move(nativeImage));
+  return success();
+}
+
+void NativeImageTargetOptions::bindOptions(OptionsBinder &binder) {
+  static llvm::cl::OptionCategory vmNativeImageOptionsCategory(
+      "IREE VM native image options");
+
+  binder.opt<std::string>(
+      "iree-vm-native-image-target-triple", targetTriple,
+      llvm::cl::cat(vmNativeImageOptionsCategory),
+      llvm::cl::desc("Compiles the VM module host code ahead-of-time to a "
+                     "native image for the given target triple and embeds it "
+                     "in bytecode modules (disabled when empty)"));
+  binder.opt<std::string>(
+      "iree-vm-native-image-compiler", compilerPath,
+      llvm::cl::cat(vmNativeImageOptionsCategory),
+      llvm::cl::desc("clang-compatible C compiler used to build native "
+                     "images (searched for when not specified)"));
+  binder.opt<std::string>(
+      "iree-vm-native-image-linker", linkerPath,
+      llvm::cl::cat(vmNativeImageOptionsCategory),
+      llvm::cl::desc("lld-compatible linker used to link native images "
+                     "(searched for when not specified)"));
+  binder.list<std::string>(
+      "iree-vm-native-image-flags", extraFlags,
+      llvm::cl::cat(vmNativeImageOptionsCategory), llvm::cl::ZeroOrMore,
+      llvm::cl::desc("Additional flags passed to the native image compiler"));
+  binder.opt<bool>(
+      "iree-vm-native-image-keep-temporaries", keepTemporaries,
+      llvm::cl::cat(vmNativeImageOptionsCategory),
+      llvm::cl::desc("Keeps the intermediate native image files for "
+                     "debugging"));
+}
+
+}  // namespace VM
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
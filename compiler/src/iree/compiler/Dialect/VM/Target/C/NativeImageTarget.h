@@ -0,0 +1,67 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_COMPILER_DIALECT_VM_TARGET_C_NATIVEIMAGETARGET_H_
+#define IREE_COMPILER_DIALECT_VM_TARGET_C_NATIVEIMAGETARGET_H_
+
+#include <string>
+#include <vector>
+
+#include "iree/compiler/Dialect/VM/Target/Bytecode/BytecodeModuleTarget.h"
+#include "iree/compiler/Dialect/VM/Target/C/CModuleTarget.h"
+#include "iree/compiler/Utils/OptionUtils.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Support/LogicalResult.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace VM {
+
+// Options controlling ahead-of-time compilation of the VM module host code to
+// native images embedded in bytecode modules.
+struct NativeImageTargetOptions {
+  // Target triple to compile the native image for (such as
+  // `x86_64-unknown-linux-gnu`). Native image compilation is disabled when
+  // empty.
+  std::string targetTriple;
+
+  // clang-compatible C compiler used to compile the generated C module.
+  // When empty the compiler is searched for next to the running executable
+  // and then on the system PATH.
+  std::string compilerPath;
+
+  // lld-compatible linker used to link the native image.
+  // When empty the linker is searched for next to the running executable
+  // and then on the system PATH.
+  std::string linkerPath;
+
+  // Additional flags passed to the compiler (such as --sysroot= when
+  // cross-compiling).
+  std::vector<std::string> extraFlags;
+
+  // Keeps the generated C source and linked image files for debugging.
+  bool keepTemporaries = false;
+
+  void bindOptions(OptionsBinder &binder);
+  using FromFlags = OptionsFromFlags<NativeImageTargetOptions>;
+};
+
+// Compiles the vm.module in |outerModuleOp| to native images as specified by
+// |targetOptions| and appends them to |nativeImages|. The module is translated
+// to C on a clone and |outerModuleOp| is not modified. No images are produced
+// if native image compilation is disabled.
+LogicalResult buildNativeImages(
+    mlir::ModuleOp outerModuleOp, const NativeImageTargetOptions &targetOptions,
+    CTargetOptions cTargetOptions,
+    SmallVectorImpl<BytecodeNativeImage> &nativeImages);
+
+}  // namespace VM
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
+
+#endif  // IREE_COMPILER_DIALECT_VM_TARGET_C_NATIVEIMAGETARGET_H_
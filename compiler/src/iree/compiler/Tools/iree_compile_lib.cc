@@ -43,6 +43,7 @@
 
 #ifdef IREE_HAVE_C_OUTPUT_FORMAT
 #include "iree/compiler/Dialect/VM/Target/C/CModuleTarget.h"
+#include "iree/compiler/Dialect/VM/Target/C/NativeImageTarget.h"
 #include "iree/compiler/Dialect/VM/Target/C/TranslationFlags.h"
 #endif  // IREE_HAVE_C_OUTPUT_FORMAT
 
@@ -174,6 +175,8 @@ int mlir::iree_compiler::runIreecMain(int argc, char **argv) {
 // Optional output formats.
 #ifdef IREE_HAVE_C_OUTPUT_FORMAT
   auto cTargetOptions = IREE::VM::getCTargetOptionsFromFlags();
+  auto &nativeImageTargetOptions =
+      IREE::VM::NativeImageTargetOptions::FromFlags::get();
 #endif
 
   llvm::cl::ParseCommandLineOptions(argc, argv, "IREE compilation driver\n");
@@ -280,9 +283,18 @@ int mlir::iree_compiler::runIreecMain(int argc, char **argv) {
       case OutputFormat::vm_asm:
         os << module.get();
         return success();
-      case OutputFormat::vm_bytecode:
+      case OutputFormat::vm_bytecode: {
+        SmallVector<IREE::VM::BytecodeNativeImage> nativeImages;
+#ifdef IREE_HAVE_C_OUTPUT_FORMAT
+        if (failed(IREE::VM::buildNativeImages(
+                module.get(), nativeImageTargetOptions, cTargetOptions,
+                nativeImages))) {
+          return failure();
+        }
+#endif  // IREE_HAVE_C_OUTPUT_FORMAT
         return translateModuleToBytecode(module.get(), bytecodeTargetOptions,
-                                         os);
+                                         os, nativeImages);
+      }
 #ifdef IREE_HAVE_C_OUTPUT_FORMAT
       case OutputFormat::vm_c:
         return mlir::iree_compiler::IREE::VM::translateModuleToC(
@@ -188,7 +188,7 @@ static iree_status_t iree_hal_rocm_allocator_allocate_buffer(
 
   if (iree_status_is_ok(status)) {
     IREE_STATISTICS(iree_hal_allocator_statistics_record_alloc(
-        &allocator->statistics, params->type, allocation_size));
+        &allocator->statistics, params->type, params->usage, allocation_size));
     *out_buffer = buffer;
   } else {
     if (!buffer) {
@@ -214,6 +214,7 @@ static void iree_hal_rocm_allocator_deallocate_buffer(
 
   IREE_STATISTICS(iree_hal_allocator_statistics_record_free(
       &allocator->statistics, memory_type,
+      iree_hal_buffer_allowed_usage(base_buffer),
       iree_hal_buffer_allocation_size(base_buffer)));
 
   iree_hal_buffer_destroy(base_buffer);
@@ -239,6 +240,13 @@ static iree_status_t iree_hal_rocm_allocator_export_buffer(
                           "exporting to external buffers not supported");
 }
 
+static iree_status_t iree_hal_rocm_allocator_enumerate_live_buffers(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_allocator_live_buffer_callback_t callback) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "live buffer tracking not supported");
+}
+
 static const iree_hal_allocator_vtable_t iree_hal_rocm_allocator_vtable = {
     .destroy = iree_hal_rocm_allocator_destroy,
     .host_allocator = iree_hal_rocm_allocator_host_allocator,
@@ -249,4 +257,5 @@ static const iree_hal_allocator_vtable_t iree_hal_rocm_allocator_vtable = {
     .deallocate_buffer = iree_hal_rocm_allocator_deallocate_buffer,
     .import_buffer = iree_hal_rocm_allocator_import_buffer,
     .export_buffer = iree_hal_rocm_allocator_export_buffer,
+    .enumerate_live_buffers = iree_hal_rocm_allocator_enumerate_live_buffers,
 };
@@ -254,6 +254,53 @@ iree_hal_rocm_device_query_semaphore_compatibility(
   return IREE_HAL_SEMAPHORE_COMPATIBILITY_HOST_ONLY;
 }
 
+// Signals all semaphores in |semaphore_list| from the host.
+static iree_status_t iree_hal_rocm_device_signal_semaphores(
+    const iree_hal_semaphore_list_t* semaphore_list) {
+  for (iree_host_size_t i = 0; i < semaphore_list->count; ++i) {
+    IREE_RETURN_IF_ERROR(iree_hal_semaphore_signal(
+        semaphore_list->semaphores[i], semaphore_list->payload_values[i]));
+  }
+  return iree_ok_status();
+}
+
+// Queue-ordered allocation is not pooled and the buffer is allocated directly
+// from the device allocator. ROCm semaphores are not implemented and
+// |wait_semaphore_list| is not waited on: each submission synchronizes the
+// stream before returning so prior device work has completed but waits on
+// values signaled later from the host are not honored.
+static iree_status_t iree_hal_rocm_device_queue_alloca(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_params_t params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_rocm_device_t* device = iree_hal_rocm_device_cast(base_device);
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+      device->device_allocator, params, allocation_size,
+      iree_const_byte_span_empty(), &buffer));
+  iree_status_t status =
+      iree_hal_rocm_device_signal_semaphores(&signal_semaphore_list);
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+  return status;
+}
+
+// The buffer is freed when the caller releases it. As with queue_alloca the
+// waits are not honored and all work using the buffer is assumed to have
+// completed by the time we are called.
+static iree_status_t iree_hal_rocm_device_queue_dealloca(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_t* buffer) {
+  return iree_hal_rocm_device_signal_semaphores(&signal_semaphore_list);
+}
+
 static iree_status_t iree_hal_rocm_device_queue_submit(
     iree_hal_device_t* base_device,
     iree_hal_command_category_t command_categories,
@@ -322,6 +369,8 @@ static const iree_hal_device_vtable_t iree_hal_rocm_device_vtable = {
     .query_semaphore_compatibility =
         iree_hal_rocm_device_query_semaphore_compatibility,
     .transfer_range = iree_hal_device_submit_transfer_range_and_wait,
+    .queue_alloca = iree_hal_rocm_device_queue_alloca,
+    .queue_dealloca = iree_hal_rocm_device_queue_dealloca,
     .queue_submit = iree_hal_rocm_device_queue_submit,
     .submit_and_wait = iree_hal_rocm_device_submit_and_wait,
     .wait_semaphores = iree_hal_rocm_device_wait_semaphores,
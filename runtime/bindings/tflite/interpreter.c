@@ -62,7 +62,8 @@ static iree_status_t _TfLiteInterpreterPrepareHAL(
       (int)driver_name.size, driver_name.data);
 
   IREE_RETURN_IF_ERROR(iree_hal_module_create(
-      interpreter->device, interpreter->allocator, &interpreter->hal_module));
+      interpreter->device, IREE_HAL_MODULE_FLAG_NONE, interpreter->allocator,
+      &interpreter->hal_module));
 
   return iree_ok_status();
 }
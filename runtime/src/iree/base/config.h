@@ -234,6 +234,23 @@ typedef IREE_DEVICE_SIZE_T iree_device_size_t;
 #define IREE_VM_EXECUTION_TRACING_SRC_LOC_ENABLE 0
 #endif  // !IREE_VM_EXECUTION_TRACING_SRC_LOC_ENABLE
 
+#if !defined(IREE_VM_EXECUTION_PROFILING_ENABLE)
+// Enables instruction-level profiling of vm bytecode execution. Contexts
+// created with IREE_VM_CONTEXT_FLAG_PROFILE_EXECUTION count the executions and
+// ticks spent per opcode, function, and bytecode offset. Adds overhead to every
+// instruction dispatched even when no context has profiling enabled.
+#define IREE_VM_EXECUTION_PROFILING_ENABLE 0
+#endif  // !IREE_VM_EXECUTION_PROFILING_ENABLE
+
+#if !defined(IREE_VM_BYTECODE_VERIFICATION_ENABLE)
+// Enables the load-time bytecode verifier. When enabled all bytecode modules
+// are verified as they are loaded and the interpreter elides the per-operation
+// register masking and static bounds checks made redundant by verification.
+// Disable to speed up module loading when only trusted inputs are used; the
+// interpreter will then fall back to defensively checking each operation.
+#define IREE_VM_BYTECODE_VERIFICATION_ENABLE 1
+#endif  // !IREE_VM_BYTECODE_VERIFICATION_ENABLE
+
 #if !defined(IREE_VM_EXT_F32_ENABLE)
 // Enables the 32-bit floating-point instruction extension.
 // Targeted from the compiler with `-iree-vm-target-extension-f32`.
@@ -13,6 +13,7 @@
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 
@@ -27,6 +28,18 @@
 #define IREE_SET_BINARY_MODE(handle) ((void)0)
 #endif  // IREE_PLATFORM_WINDOWS
 
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define IREE_FILE_IO_HAVE_MMAP 1
+#elif defined(IREE_PLATFORM_WINDOWS)
+#define IREE_FILE_IO_HAVE_MMAP 1
+#else
+#define IREE_FILE_IO_HAVE_MMAP 0
+#endif  // IREE_PLATFORM_*
+
 // We could take alignment as an arg, but roughly page aligned should be
 // acceptable for all uses - if someone cares about memory usage they won't
 // be using this method.
@@ -60,8 +73,7 @@ iree_status_t iree_file_contents_allocator_ctl(void* self,
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "only the file contents buffer is valid");
   }
-  iree_allocator_t allocator = contents->allocator;
-  iree_allocator_free(allocator, contents);
+  iree_file_contents_free(contents);
   return iree_ok_status();
 }
 
@@ -74,9 +86,14 @@ iree_allocator_t iree_file_contents_deallocator(
   return allocator;
 }
 
+static void iree_file_unmap(void* mapping, iree_host_size_t mapping_length);
+
 void iree_file_contents_free(iree_file_contents_t* contents) {
   if (!contents) return;
   IREE_TRACE_ZONE_BEGIN(z0);
+  if (contents->mapping) {
+    iree_file_unmap(contents->mapping, contents->mapping_length);
+  }
   iree_allocator_free(contents->allocator, contents);
   IREE_TRACE_ZONE_END(z0);
 }
@@ -112,9 +129,11 @@ static iree_status_t iree_file_read_contents_impl(
   contents->buffer.data = (void*)iree_host_align(
       (uintptr_t)contents + sizeof(*contents), IREE_FILE_BASE_ALIGNMENT);
   contents->buffer.data_length = file_size;
+  contents->mapping = NULL;
+  contents->mapping_length = 0;
 
   // Attempt to read the file into memory.
-  if (fread(contents->buffer.data, file_size, 1, file) != 1) {
+  if (file_size > 0 && fread(contents->buffer.data, file_size, 1, file) != 1) {
     iree_allocator_free(allocator, contents);
     return iree_make_status(iree_status_code_from_errno(errno),
                             "unable to read entire %zu file bytes", file_size);
@@ -126,17 +145,168 @@ static iree_status_t iree_file_read_contents_impl(
   return iree_ok_status();
 }
 
-iree_status_t iree_file_read_contents(const char* path,
-                                      iree_allocator_t allocator,
-                                      iree_file_contents_t** out_contents) {
-  IREE_TRACE_ZONE_BEGIN(z0);
-  IREE_ASSERT_ARGUMENT(path);
-  IREE_ASSERT_ARGUMENT(out_contents);
-  *out_contents = NULL;
+#if IREE_FILE_IO_HAVE_MMAP && defined(IREE_PLATFORM_WINDOWS)
+
+static void iree_file_unmap(void* mapping, iree_host_size_t mapping_length) {
+  UnmapViewOfFile(mapping);
+}
+
+// Maps the file at |path| into memory read-only.
+// Returns IREE_STATUS_UNAVAILABLE if the file exists but cannot be mapped.
+static iree_status_t iree_file_map_contents(
+    const char* path, iree_file_read_flags_t flags, iree_allocator_t allocator,
+    iree_file_contents_t** out_contents) {
+  HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    return iree_make_status(iree_status_code_from_win32_error(GetLastError()),
+                            "failed to open file '%s'", path);
+  }
+
+  iree_status_t status = iree_ok_status();
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size)) {
+    status = iree_make_status(iree_status_code_from_win32_error(GetLastError()),
+                              "size query");
+  } else if (file_size.QuadPart == 0 ||
+             (uint64_t)file_size.QuadPart > IREE_HOST_SIZE_MAX) {
+    status =
+        iree_make_status(IREE_STATUS_UNAVAILABLE, "file size not mappable");
+  }
+
+  HANDLE mapping = NULL;
+  if (iree_status_is_ok(status)) {
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+      status = iree_make_status(IREE_STATUS_UNAVAILABLE,
+                                "CreateFileMapping failed");
+    }
+  }
+  void* base_address = NULL;
+  if (iree_status_is_ok(status)) {
+    base_address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!base_address) {
+      status =
+          iree_make_status(IREE_STATUS_UNAVAILABLE, "MapViewOfFile failed");
+    }
+  }
+
+  // The view keeps the file mapping alive.
+  if (mapping) CloseHandle(mapping);
+  CloseHandle(file);
+
+  iree_file_contents_t* contents = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_malloc(allocator, sizeof(*contents),
+                                   (void**)&contents);
+  }
+  if (iree_status_is_ok(status)) {
+    contents->allocator = allocator;
+    contents->buffer.data = (uint8_t*)base_address;
+    contents->buffer.data_length = (iree_host_size_t)file_size.QuadPart;
+    contents->mapping = base_address;
+    contents->mapping_length = contents->buffer.data_length;
+    *out_contents = contents;
+  } else if (base_address) {
+    UnmapViewOfFile(base_address);
+  }
+  return status;
+}
+
+#elif IREE_FILE_IO_HAVE_MMAP
+
+static void iree_file_unmap(void* mapping, iree_host_size_t mapping_length) {
+  munmap(mapping, mapping_length);
+}
+
+// Applies the access pattern hints in |flags| to the mapped range.
+// Hints are best-effort and failures are ignored.
+static void iree_file_advise_mapping(void* mapping,
+                                     iree_host_size_t mapping_length,
+                                     iree_file_read_flags_t flags) {
+  if (iree_all_bits_set(flags, IREE_FILE_READ_FLAG_SEQUENTIAL)) {
+    madvise(mapping, mapping_length, MADV_SEQUENTIAL);
+  } else if (iree_all_bits_set(flags, IREE_FILE_READ_FLAG_RANDOM)) {
+    madvise(mapping, mapping_length, MADV_RANDOM);
+  }
+  if (iree_all_bits_set(flags, IREE_FILE_READ_FLAG_WILL_NEED)) {
+    madvise(mapping, mapping_length, MADV_WILLNEED);
+  }
+}
+
+// Maps the file at |path| into memory read-only.
+// Returns IREE_STATUS_UNAVAILABLE if the file exists but cannot be mapped.
+static iree_status_t iree_file_map_contents(
+    const char* path, iree_file_read_flags_t flags, iree_allocator_t allocator,
+    iree_file_contents_t** out_contents) {
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to open file '%s'", path);
+  }
 
+  iree_status_t status = iree_ok_status();
+  struct stat stat_buf;
+  if (fstat(fd, &stat_buf) == -1) {
+    status = iree_make_status(iree_status_code_from_errno(errno), "size query");
+  } else if (!S_ISREG(stat_buf.st_mode) || stat_buf.st_size == 0 ||
+             (uint64_t)stat_buf.st_size > IREE_HOST_SIZE_MAX) {
+    // Pipes and other special files can't be mapped and mapping an empty
+    // file fails; the caller will fall back to reading these.
+    status = iree_make_status(IREE_STATUS_UNAVAILABLE,
+                              "file type or size not mappable");
+  }
+
+  void* base_address = MAP_FAILED;
+  iree_host_size_t file_size = (iree_host_size_t)stat_buf.st_size;
+  if (iree_status_is_ok(status)) {
+    base_address = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (base_address == MAP_FAILED) {
+      status = iree_make_status(IREE_STATUS_UNAVAILABLE, "mmap failed: %s",
+                                strerror(errno));
+    }
+  }
+
+  // The mapping keeps its own reference to the file.
+  close(fd);
+
+  iree_file_contents_t* contents = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_malloc(allocator, sizeof(*contents),
+                                   (void**)&contents);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_file_advise_mapping(base_address, file_size, flags);
+    contents->allocator = allocator;
+    contents->buffer.data = (uint8_t*)base_address;
+    contents->buffer.data_length = file_size;
+    contents->mapping = base_address;
+    contents->mapping_length = file_size;
+    *out_contents = contents;
+  } else if (base_address != MAP_FAILED) {
+    munmap(base_address, file_size);
+  }
+  return status;
+}
+
+#else
+
+static void iree_file_unmap(void* mapping, iree_host_size_t mapping_length) {}
+
+static iree_status_t iree_file_map_contents(
+    const char* path, iree_file_read_flags_t flags, iree_allocator_t allocator,
+    iree_file_contents_t** out_contents) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "memory mapping not supported on this platform");
+}
+
+#endif  // IREE_FILE_IO_HAVE_MMAP
+
+static iree_status_t iree_file_preload_contents(
+    const char* path, iree_allocator_t allocator,
+    iree_file_contents_t** out_contents) {
   FILE* file = fopen(path, "rb");
   if (file == NULL) {
-    IREE_TRACE_ZONE_END(z0);
     return iree_make_status(iree_status_code_from_errno(errno),
                             "failed to open file '%s'", path);
   }
@@ -149,11 +319,42 @@ iree_status_t iree_file_read_contents(const char* path,
   }
 
   fclose(file);
+  return status;
+}
+
+iree_status_t iree_file_read_contents_with_flags(
+    const char* path, iree_file_read_flags_t flags, iree_allocator_t allocator,
+    iree_file_contents_t** out_contents) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_ASSERT_ARGUMENT(path);
+  IREE_ASSERT_ARGUMENT(out_contents);
+  *out_contents = NULL;
+
+  if (iree_all_bits_set(flags, IREE_FILE_READ_FLAG_MMAP)) {
+    iree_status_t status =
+        iree_file_map_contents(path, flags, allocator, out_contents);
+    if (!iree_status_is_unavailable(status)) {
+      IREE_TRACE_ZONE_END(z0);
+      return status;
+    }
+    // Not mappable; fall back to reading the file.
+    iree_status_ignore(status);
+  }
+
+  iree_status_t status =
+      iree_file_preload_contents(path, allocator, out_contents);
 
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
 
+iree_status_t iree_file_read_contents(const char* path,
+                                      iree_allocator_t allocator,
+                                      iree_file_contents_t** out_contents) {
+  return iree_file_read_contents_with_flags(path, IREE_FILE_READ_FLAG_PRELOAD,
+                                            allocator, out_contents);
+}
+
 iree_status_t iree_file_write_contents(const char* path,
                                        iree_const_byte_span_t content) {
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -232,6 +433,8 @@ static iree_status_t iree_stdin_read_contents_impl(
   contents->allocator = allocator;
   contents->buffer.data[size] = 0;  // NUL
   contents->buffer.data_length = size;
+  contents->mapping = NULL;
+  contents->mapping_length = 0;
   *out_contents = contents;
   return iree_ok_status();
 }
@@ -265,6 +468,12 @@ iree_status_t iree_file_read_contents(const char* path,
   return iree_make_status(IREE_STATUS_UNAVAILABLE, "File I/O is disabled");
 }
 
+iree_status_t iree_file_read_contents_with_flags(
+    const char* path, iree_file_read_flags_t flags, iree_allocator_t allocator,
+    iree_file_contents_t** out_contents) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE, "File I/O is disabled");
+}
+
 iree_status_t iree_file_write_contents(const char* path,
                                        iree_const_byte_span_t content) {
   return iree_make_status(IREE_STATUS_UNAVAILABLE, "File I/O is disabled");
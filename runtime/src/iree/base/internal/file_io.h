@@ -20,6 +20,38 @@ extern "C" {
 // Returns IREE_STATUS_NOT_FOUND if the file does not exist.
 iree_status_t iree_file_exists(const char* path);
 
+// Bits controlling how file contents are loaded into memory.
+enum iree_file_read_flag_bits_t {
+  // Reads the entire file into a heap allocation. The contents will have a
+  // trailing NUL to allow use as a C-string (assuming the contents themselves
+  // don't contain NUL).
+  IREE_FILE_READ_FLAG_PRELOAD = 0u,
+
+  // Maps the file into memory read-only instead of reading it. Pages are
+  // demand-loaded from the file as they are accessed and may be shared with
+  // other processes mapping the same file. The base address is page-aligned
+  // and the contents are not NUL terminated. Falls back to
+  // IREE_FILE_READ_FLAG_PRELOAD on platforms without memory mapping support or
+  // if the file cannot be mapped (such as when it is empty).
+  //
+  // The file must not be modified while mapped.
+  IREE_FILE_READ_FLAG_MMAP = 1u << 0,
+
+  // Hints that mapped contents will be accessed sequentially (such as when
+  // parsing) and can be aggressively read ahead.
+  IREE_FILE_READ_FLAG_SEQUENTIAL = 1u << 1,
+
+  // Hints that mapped contents will be accessed randomly (such as large
+  // constants in a module that are only partially used) and that read-ahead
+  // should be limited to the pages accessed.
+  IREE_FILE_READ_FLAG_RANDOM = 1u << 2,
+
+  // Hints that mapped contents will be needed soon and should be prefetched
+  // asynchronously.
+  IREE_FILE_READ_FLAG_WILL_NEED = 1u << 3,
+};
+typedef uint32_t iree_file_read_flags_t;
+
 // Loaded file contents.
 typedef struct iree_file_contents_t {
   iree_allocator_t allocator;
@@ -27,6 +59,9 @@ typedef struct iree_file_contents_t {
     iree_byte_span_t buffer;
     iree_const_byte_span_t const_buffer;
   };
+  // Base address and size of the memory mapping backing |buffer|, if mapped.
+  void* mapping;
+  iree_host_size_t mapping_length;
 } iree_file_contents_t;
 
 // Returns an allocator that deallocates the |contents|.
@@ -45,6 +80,17 @@ iree_status_t iree_file_read_contents(const char* path,
                                       iree_allocator_t allocator,
                                       iree_file_contents_t** out_contents);
 
+// Synchronously loads a file's contents into memory as specified by |flags|.
+// Use IREE_FILE_READ_FLAG_MMAP to map the file read-only such that the
+// contents are paged in on demand instead of copied up front.
+//
+// Returns the contents of the file in |out_contents|.
+// |allocator| is used to allocate the memory and the caller must use
+// iree_file_contents_free to release the memory and any mapping.
+iree_status_t iree_file_read_contents_with_flags(
+    const char* path, iree_file_read_flags_t flags, iree_allocator_t allocator,
+    iree_file_contents_t** out_contents);
+
 // Synchronously writes a byte buffer into a file.
 // Existing contents are overwritten.
 iree_status_t iree_file_write_contents(const char* path,
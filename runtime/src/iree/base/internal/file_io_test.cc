@@ -77,6 +77,53 @@ TEST(FileIO, ReadWriteContents) {
   iree_file_contents_free(read_contents);
 }
 
+TEST(FileIO, MapContents) {
+  constexpr const char* kUniqueName = "MapContents";
+  auto path = GetUniquePath(kUniqueName);
+
+  // Generate file contents large enough to span multiple pages.
+  std::string write_contents;
+  while (write_contents.size() < 3 * 4096) {
+    write_contents += GetUniqueContents(kUniqueName);
+  }
+
+  // Write the contents to disk.
+  IREE_ASSERT_OK(iree_file_write_contents(
+      path.c_str(),
+      iree_make_const_byte_span(write_contents.data(), write_contents.size())));
+
+  // Map the contents from disk.
+  iree_file_contents_t* read_contents = NULL;
+  IREE_ASSERT_OK(iree_file_read_contents_with_flags(
+      path.c_str(), IREE_FILE_READ_FLAG_MMAP | IREE_FILE_READ_FLAG_RANDOM,
+      iree_allocator_system(), &read_contents));
+
+  // Expect the contents are equal and page aligned.
+  EXPECT_EQ(write_contents.size(), read_contents->const_buffer.data_length);
+  EXPECT_EQ(memcmp(write_contents.data(), read_contents->const_buffer.data,
+                   read_contents->const_buffer.data_length),
+            0);
+  EXPECT_EQ(0, (uintptr_t)read_contents->const_buffer.data % 4096);
+
+  iree_file_contents_free(read_contents);
+}
+
+TEST(FileIO, MapEmptyContents) {
+  constexpr const char* kUniqueName = "MapEmptyContents";
+  auto path = GetUniquePath(kUniqueName);
+
+  // Empty files can't be mapped and must fall back to reading.
+  IREE_ASSERT_OK(
+      iree_file_write_contents(path.c_str(), iree_const_byte_span_empty()));
+  iree_file_contents_t* read_contents = NULL;
+  IREE_ASSERT_OK(iree_file_read_contents_with_flags(
+      path.c_str(), IREE_FILE_READ_FLAG_MMAP, iree_allocator_system(),
+      &read_contents));
+  EXPECT_EQ(0, read_contents->const_buffer.data_length);
+
+  iree_file_contents_free(read_contents);
+}
+
 }  // namespace
 }  // namespace file_io
 }  // namespace iree
@@ -0,0 +1,186 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/numa.h"
+
+#include <string.h>
+
+#include "iree/base/target_platform.h"
+#include "iree/base/tracing.h"
+
+#if defined(IREE_PLATFORM_LINUX) || defined(IREE_PLATFORM_ANDROID)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(SYS_mbind)
+#define IREE_NUMA_MMAP 1
+#endif  // SYS_mbind
+#elif defined(IREE_PLATFORM_WINDOWS)
+#define IREE_NUMA_VIRTUAL_ALLOC 1
+#endif  // IREE_PLATFORM_*
+
+#if defined(IREE_NUMA_MMAP) || defined(IREE_NUMA_VIRTUAL_ALLOC)
+
+// Header stored at the base of each OS allocation. The pointer returned to
+// callers is offset by the header size, which preserves iree_max_align_t
+// alignment.
+typedef struct iree_numa_allocation_header_t {
+  // Total size of the OS allocation including the header.
+  iree_host_size_t total_length;
+  // Size of the allocation as requested by the user.
+  iree_host_size_t byte_length;
+} iree_numa_allocation_header_t;
+#define IREE_NUMA_HEADER_SIZE \
+  iree_host_align(sizeof(iree_numa_allocation_header_t), iree_max_align_t)
+
+#if defined(IREE_NUMA_MMAP)
+
+// From linux/mempolicy.h; defined here to avoid requiring kernel headers.
+#define IREE_NUMA_MPOL_PREFERRED 1
+
+// Maximum node ID supported by our node masks.
+#define IREE_NUMA_MAX_NODE_COUNT 1024
+
+static void* iree_numa_os_allocate(uint32_t node_id,
+                                   iree_host_size_t total_length) {
+  void* ptr = mmap(NULL, total_length, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED) return NULL;
+
+  // Prefer the node but allow the kernel to fall back to others if it is out
+  // of memory. Pages are not yet committed so this affects where they land on
+  // first touch. Failure here (no NUMA support, sandboxed, etc) is fine as the
+  // memory remains usable.
+  if (node_id < IREE_NUMA_MAX_NODE_COUNT) {
+    unsigned long node_mask[IREE_NUMA_MAX_NODE_COUNT /
+                            (8 * sizeof(unsigned long))];
+    memset(node_mask, 0, sizeof(node_mask));
+    node_mask[node_id / (8 * sizeof(unsigned long))] =
+        1ul << (node_id % (8 * sizeof(unsigned long)));
+    (void)syscall(SYS_mbind, ptr, total_length, IREE_NUMA_MPOL_PREFERRED,
+                  node_mask, (unsigned long)IREE_NUMA_MAX_NODE_COUNT + 1, 0);
+  }
+  return ptr;
+}
+
+static void iree_numa_os_free(void* ptr, iree_host_size_t total_length) {
+  munmap(ptr, total_length);
+}
+
+#elif defined(IREE_NUMA_VIRTUAL_ALLOC)
+
+static void* iree_numa_os_allocate(uint32_t node_id,
+                                   iree_host_size_t total_length) {
+  void* ptr = VirtualAllocExNuma(GetCurrentProcess(), NULL, total_length,
+                                 MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE,
+                                 (DWORD)node_id);
+  if (ptr) return ptr;
+  // Unlike mbind the node is a hard requirement and the call fails if it does
+  // not exist (or the system has no NUMA support). Match the Linux behavior of
+  // treating the node as a preference and fall back to any node.
+  return VirtualAlloc(NULL, total_length, MEM_RESERVE | MEM_COMMIT,
+                      PAGE_READWRITE);
+}
+
+static void iree_numa_os_free(void* ptr, iree_host_size_t total_length) {
+  VirtualFree(ptr, 0, MEM_RELEASE);
+}
+
+#endif  // IREE_NUMA_*
+
+static iree_status_t iree_numa_allocator_alloc(
+    uint32_t node_id, iree_allocator_command_t command,
+    const iree_allocator_alloc_params_t* params, void** inout_ptr) {
+  IREE_ASSERT_ARGUMENT(params);
+  IREE_ASSERT_ARGUMENT(inout_ptr);
+  iree_host_size_t byte_length = params->byte_length;
+  if (IREE_UNLIKELY(byte_length == 0)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "allocations must be >0 bytes");
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)byte_length);
+
+  // Both mmap and VirtualAlloc return zeroed pages so CALLOC is free.
+  iree_host_size_t total_length = IREE_NUMA_HEADER_SIZE + byte_length;
+  uint8_t* base_ptr = (uint8_t*)iree_numa_os_allocate(node_id, total_length);
+  if (!base_ptr) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "NUMA allocation of %" PRIhsz
+                            " bytes on node %u failed",
+                            byte_length, node_id);
+  }
+  iree_numa_allocation_header_t* header =
+      (iree_numa_allocation_header_t*)base_ptr;
+  header->total_length = total_length;
+  header->byte_length = byte_length;
+  void* new_ptr = base_ptr + IREE_NUMA_HEADER_SIZE;
+
+  // Reallocation always moves as the OS allocations are not resizable.
+  void* existing_ptr = *inout_ptr;
+  if (existing_ptr && command == IREE_ALLOCATOR_COMMAND_REALLOC) {
+    iree_numa_allocation_header_t* existing_header =
+        (iree_numa_allocation_header_t*)((uint8_t*)existing_ptr -
+                                         IREE_NUMA_HEADER_SIZE);
+    memcpy(new_ptr, existing_ptr,
+           iree_min(existing_header->byte_length, byte_length));
+    IREE_TRACE_FREE(existing_ptr);
+    iree_numa_os_free(existing_header, existing_header->total_length);
+  }
+  IREE_TRACE_ALLOC(new_ptr, byte_length);
+
+  *inout_ptr = new_ptr;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_numa_allocator_free(void** inout_ptr) {
+  IREE_ASSERT_ARGUMENT(inout_ptr);
+  void* ptr = *inout_ptr;
+  if (IREE_LIKELY(ptr != NULL)) {
+    IREE_TRACE_FREE(ptr);
+    iree_numa_allocation_header_t* header =
+        (iree_numa_allocation_header_t*)((uint8_t*)ptr - IREE_NUMA_HEADER_SIZE);
+    iree_numa_os_free(header, header->total_length);
+    *inout_ptr = NULL;
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_numa_allocator_ctl(void* self,
+                                             iree_allocator_command_t command,
+                                             const void* params,
+                                             void** inout_ptr) {
+  uint32_t node_id = (uint32_t)(uintptr_t)self;
+  switch (command) {
+    case IREE_ALLOCATOR_COMMAND_MALLOC:
+    case IREE_ALLOCATOR_COMMAND_CALLOC:
+    case IREE_ALLOCATOR_COMMAND_REALLOC:
+      return iree_numa_allocator_alloc(
+          node_id, command, (const iree_allocator_alloc_params_t*)params,
+          inout_ptr);
+    case IREE_ALLOCATOR_COMMAND_FREE:
+      return iree_numa_allocator_free(inout_ptr);
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unsupported NUMA allocator command");
+  }
+}
+
+iree_allocator_t iree_numa_node_allocator(uint32_t node_id) {
+  iree_allocator_t v = {(void*)(uintptr_t)node_id, iree_numa_allocator_ctl};
+  return v;
+}
+
+#else
+
+iree_allocator_t iree_numa_node_allocator(uint32_t node_id) {
+  return iree_allocator_system();
+}
+
+#endif  // IREE_NUMA_MMAP || IREE_NUMA_VIRTUAL_ALLOC
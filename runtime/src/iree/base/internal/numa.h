@@ -0,0 +1,33 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BASE_INTERNAL_NUMA_H_
+#define IREE_BASE_INTERNAL_NUMA_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Returns an allocator that places its allocations in memory local to the
+// NUMA node |node_id|. Allocations are made directly from the OS in whole
+// pages and are intended for large long-lived blocks such as device buffers;
+// small or frequent allocations should use the system allocator.
+//
+// Binding is best-effort: if the platform does not support NUMA placement or
+// the node has insufficient memory the allocation will be satisfied from any
+// node. On platforms without NUMA support this behaves like
+// iree_allocator_system().
+iree_allocator_t iree_numa_node_allocator(uint32_t node_id);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // IREE_BASE_INTERNAL_NUMA_H_
@@ -0,0 +1,63 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/numa.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+TEST(NumaAllocatorTest, MallocFree) {
+  iree_allocator_t allocator = iree_numa_node_allocator(0);
+  uint8_t* ptr = NULL;
+  IREE_ASSERT_OK(iree_allocator_malloc(allocator, 1024, (void**)&ptr));
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(0u, (uintptr_t)ptr % iree_max_align_t);
+  memset(ptr, 0xCD, 1024);
+  iree_allocator_free(allocator, ptr);
+}
+
+TEST(NumaAllocatorTest, MallocZeroes) {
+  iree_allocator_t allocator = iree_numa_node_allocator(0);
+  uint8_t* ptr = NULL;
+  IREE_ASSERT_OK(iree_allocator_malloc(allocator, 4096 * 3, (void**)&ptr));
+  for (size_t i = 0; i < 4096 * 3; ++i) {
+    ASSERT_EQ(0, ptr[i]);
+  }
+  iree_allocator_free(allocator, ptr);
+}
+
+TEST(NumaAllocatorTest, ReallocPreservesContents) {
+  iree_allocator_t allocator = iree_numa_node_allocator(0);
+  uint8_t* ptr = NULL;
+  IREE_ASSERT_OK(iree_allocator_malloc(allocator, 16, (void**)&ptr));
+  for (uint8_t i = 0; i < 16; ++i) ptr[i] = i;
+  IREE_ASSERT_OK(iree_allocator_realloc(allocator, 64 * 1024, (void**)&ptr));
+  for (uint8_t i = 0; i < 16; ++i) {
+    EXPECT_EQ(i, ptr[i]);
+  }
+  IREE_ASSERT_OK(iree_allocator_realloc(allocator, 8, (void**)&ptr));
+  for (uint8_t i = 0; i < 8; ++i) {
+    EXPECT_EQ(i, ptr[i]);
+  }
+  iree_allocator_free(allocator, ptr);
+}
+
+TEST(NumaAllocatorTest, ArbitraryNode) {
+  // Nodes that don't exist must still produce usable memory.
+  iree_allocator_t allocator = iree_numa_node_allocator(63);
+  uint8_t* ptr = NULL;
+  IREE_ASSERT_OK(iree_allocator_malloc(allocator, 128, (void**)&ptr));
+  memset(ptr, 0xCD, 128);
+  iree_allocator_free(allocator, ptr);
+}
+
+}  // namespace
@@ -36,6 +36,63 @@ IREE_API_EXPORT iree_status_t iree_hal_allocator_statistics_format(
       statistics->device_bytes_freed,
       (statistics->device_bytes_allocated - statistics->device_bytes_freed)));
 
+  // Only allocators that cache released buffers report cached bytes.
+  if (statistics->host_bytes_cached || statistics->device_bytes_cached) {
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder,
+        "      CACHED: %12" PRIdsz "B host  / %12" PRIdsz "B device\n",
+        statistics->host_bytes_cached, statistics->device_bytes_cached));
+  }
+
+  IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+      builder,
+      "      COUNTS: %12" PRIu64 "  allocs / %12" PRIu64
+      "  frees  / %12" PRIu64 "  live\n",
+      statistics->allocation_count, statistics->free_count,
+      (statistics->allocation_count - statistics->free_count)));
+
+  static const char* usage_category_names[] = {
+      "TRANSFER",
+      "DISPATCH",
+      "SHARING",
+      "MAPPING",
+  };
+  static_assert(IREE_ARRAYSIZE(usage_category_names) ==
+                    IREE_HAL_ALLOCATOR_USAGE_CATEGORY_COUNT,
+                "usage category names must match the category enum");
+  for (int i = 0; i < IREE_HAL_ALLOCATOR_USAGE_CATEGORY_COUNT; ++i) {
+    const iree_hal_allocator_byte_statistics_t* usage = &statistics->usage[i];
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder,
+        "%12s: %12" PRIdsz "B peak / %12" PRIdsz "B allocated / %12" PRIdsz
+        "B freed / %12" PRIdsz "B live\n",
+        usage_category_names[i], usage->bytes_peak, usage->bytes_allocated,
+        usage->bytes_freed, (usage->bytes_allocated - usage->bytes_freed)));
+  }
+
+  IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+      builder,
+      "         MAP: %12" PRIu64 "  ops    / %12" PRIdsz "B\n"
+      "       FLUSH: %12" PRIu64 "  ops    / %12" PRIdsz "B\n"
+      "  INVALIDATE: %12" PRIu64 "  ops    / %12" PRIdsz "B\n",
+      statistics->map_count, statistics->map_bytes, statistics->flush_count,
+      statistics->flush_bytes, statistics->invalidate_count,
+      statistics->invalidate_bytes));
+
+  // Only populated buckets are printed to keep the output compact.
+  IREE_RETURN_IF_ERROR(
+      iree_string_builder_append_cstring(builder, "  SIZE HISTOGRAM:\n"));
+  for (int i = 0; i < IREE_HAL_ALLOCATOR_STATISTICS_SIZE_BUCKET_COUNT; ++i) {
+    if (!statistics->size_histogram[i]) continue;
+    const uint64_t bucket_limit = 256ull << i;
+    const bool is_last =
+        i + 1 == IREE_HAL_ALLOCATOR_STATISTICS_SIZE_BUCKET_COUNT;
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder, "    %s %12" PRIu64 "B: %12" PRIu64 " allocs\n",
+        is_last ? "> " : "<=", is_last ? (bucket_limit >> 1) : bucket_limit,
+        statistics->size_histogram[i]));
+  }
+
 #else
   // No-op when disabled.
 #endif  // IREE_STATISTICS_ENABLE
@@ -73,6 +130,59 @@ IREE_API_EXPORT void iree_hal_allocator_query_statistics(
   });
 }
 
+#if IREE_STATISTICS_ENABLE
+
+static iree_status_t iree_hal_allocator_append_live_buffer(
+    void* user_data, const iree_hal_allocator_live_buffer_t* live_buffer) {
+  iree_string_builder_t* builder = (iree_string_builder_t*)user_data;
+  iree_bitfield_string_temp_t memory_type_temp;
+  iree_string_view_t memory_type_str =
+      iree_hal_memory_type_format(live_buffer->memory_type, &memory_type_temp);
+  iree_bitfield_string_temp_t usage_temp;
+  iree_string_view_t usage_str =
+      iree_hal_buffer_usage_format(live_buffer->allowed_usage, &usage_temp);
+  IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+      builder, "  %12" PRIdsz "B %.*s (%.*s) @ ",
+      live_buffer->allocation_size, (int)memory_type_str.size,
+      memory_type_str.data, (int)usage_str.size, usage_str.data));
+  const iree_hal_allocation_site_t* site = &live_buffer->site;
+  if (iree_string_view_is_empty(site->function_name)) {
+    return iree_string_builder_append_cstring(builder, "<unknown>\n");
+  }
+  return iree_string_builder_append_format(
+      builder, "%.*s.%.*s+%08" PRIX64 "\n", (int)site->module_name.size,
+      site->module_name.data, (int)site->function_name.size,
+      site->function_name.data, site->offset);
+}
+
+// Appends one line per live buffer in |allocator| to |builder|.
+// Returns IREE_STATUS_UNIMPLEMENTED if live buffers are not tracked.
+static iree_status_t iree_hal_allocator_live_buffers_format(
+    iree_hal_allocator_t* allocator, iree_string_builder_t* builder) {
+  iree_string_builder_t live_builder;
+  iree_string_builder_initialize(iree_hal_allocator_host_allocator(allocator),
+                                 &live_builder);
+  iree_hal_allocator_live_buffer_callback_t callback = {
+      .fn = iree_hal_allocator_append_live_buffer,
+      .user_data = &live_builder,
+  };
+  iree_status_t status =
+      iree_hal_allocator_enumerate_live_buffers(allocator, callback);
+  if (iree_status_is_ok(status)) {
+    status = iree_string_builder_append_cstring(builder, "  LIVE BUFFERS:\n");
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_string_builder_append_string(
+        builder,
+        iree_make_string_view(iree_string_builder_buffer(&live_builder),
+                              iree_string_builder_size(&live_builder)));
+  }
+  iree_string_builder_deinitialize(&live_builder);
+  return status;
+}
+
+#endif  // IREE_STATISTICS_ENABLE
+
 IREE_API_EXPORT iree_status_t iree_hal_allocator_statistics_fprint(
     FILE* file, iree_hal_allocator_t* IREE_RESTRICT allocator) {
 #if IREE_STATISTICS_ENABLE
@@ -92,6 +202,14 @@ IREE_API_EXPORT iree_status_t iree_hal_allocator_statistics_fprint(
     status = iree_hal_allocator_statistics_format(&statistics, &builder);
   }
 
+  // Live buffers are optional as not all allocators track them.
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_allocator_live_buffers_format(allocator, &builder);
+    if (iree_status_is_unimplemented(status)) {
+      status = iree_status_ignore(status);
+    }
+  }
+
   if (iree_status_is_ok(status)) {
     fprintf(file, "%.*s", (int)iree_string_builder_size(&builder),
             iree_string_builder_buffer(&builder));
@@ -105,6 +223,23 @@ IREE_API_EXPORT iree_status_t iree_hal_allocator_statistics_fprint(
 #endif  // IREE_STATISTICS_ENABLE
 }
 
+IREE_API_EXPORT iree_status_t iree_hal_allocator_enumerate_live_buffers(
+    iree_hal_allocator_t* IREE_RESTRICT allocator,
+    iree_hal_allocator_live_buffer_callback_t callback) {
+  IREE_ASSERT_ARGUMENT(allocator);
+  IREE_ASSERT_ARGUMENT(callback.fn);
+#if IREE_STATISTICS_ENABLE
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = _VTABLE_DISPATCH(allocator, enumerate_live_buffers)(
+      allocator, callback);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+#else
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "allocator statistics are not enabled");
+#endif  // IREE_STATISTICS_ENABLE
+}
+
 IREE_API_EXPORT iree_hal_buffer_compatibility_t
 iree_hal_allocator_query_compatibility(
     iree_hal_allocator_t* IREE_RESTRICT allocator,
@@ -38,6 +38,19 @@ typedef uint64_t iree_hal_queue_affinity_t;
 // Specifies that any queue may be selected.
 #define IREE_HAL_QUEUE_AFFINITY_ANY ((iree_hal_queue_affinity_t)(-1))
 
+// Identifies the code requesting an allocation so that live buffers can be
+// attributed when diagnosing memory usage. When allocating on behalf of a VM
+// program this is the calling function and the bytecode offset of the call.
+typedef struct iree_hal_allocation_site_t {
+  // Name of the module containing the function, if known.
+  iree_string_view_t module_name;
+  // Name of the function requesting the allocation, if known.
+  iree_string_view_t function_name;
+  // Implementation-defined offset within the function (such as a VM program
+  // counter) of the allocation request.
+  uint64_t offset;
+} iree_hal_allocation_site_t;
+
 // Parameters defining how a buffer should be allocated.
 //
 // Designed to be zero-initialized: any field with a 0 value will be assigned
@@ -90,6 +103,13 @@ typedef struct iree_hal_buffer_params_t {
   // If 0 then the alignment will be decided by the allocator based on optimal
   // device parameters.
   iree_device_size_t min_alignment;
+
+  // Optional site of the allocation request used for attributing live buffers
+  // in allocator statistics. Allocators that track live buffers copy the
+  // names and the pointer need only remain valid for the duration of the call.
+  //
+  // If NULL then the allocation site is unknown.
+  const iree_hal_allocation_site_t* site;
 } iree_hal_buffer_params_t;
 
 // Canonicalizes |params| fields when zero initialization is used.
@@ -282,6 +302,33 @@ iree_hal_buffer_release_callback_null(void) {
 // Statistics/reporting
 //===----------------------------------------------------------------------===//
 
+// Number of buckets in the allocation size histogram.
+// Bucket 0 contains allocations <= 256B and each subsequent bucket doubles the
+// upper bound such that the last bucket contains all allocations > 64MiB.
+#define IREE_HAL_ALLOCATOR_STATISTICS_SIZE_BUCKET_COUNT 20
+
+// Categories of buffer usage tracked in allocator statistics.
+// A buffer is counted in every category it declares usage for and the
+// per-category totals may exceed the aggregate totals.
+typedef enum iree_hal_allocator_usage_category_e {
+  // IREE_HAL_BUFFER_USAGE_TRANSFER_*.
+  IREE_HAL_ALLOCATOR_USAGE_CATEGORY_TRANSFER = 0,
+  // IREE_HAL_BUFFER_USAGE_DISPATCH_*.
+  IREE_HAL_ALLOCATOR_USAGE_CATEGORY_DISPATCH,
+  // IREE_HAL_BUFFER_USAGE_SHARING_*.
+  IREE_HAL_ALLOCATOR_USAGE_CATEGORY_SHARING,
+  // IREE_HAL_BUFFER_USAGE_MAPPING_*.
+  IREE_HAL_ALLOCATOR_USAGE_CATEGORY_MAPPING,
+  IREE_HAL_ALLOCATOR_USAGE_CATEGORY_COUNT,
+} iree_hal_allocator_usage_category_t;
+
+// Byte counters for a subset of allocations.
+typedef struct iree_hal_allocator_byte_statistics_t {
+  iree_device_size_t bytes_peak;
+  iree_device_size_t bytes_allocated;
+  iree_device_size_t bytes_freed;
+} iree_hal_allocator_byte_statistics_t;
+
 // Aggregate allocation statistics.
 typedef struct iree_hal_allocator_statistics_t {
 #if IREE_STATISTICS_ENABLE
@@ -291,8 +338,30 @@ typedef struct iree_hal_allocator_statistics_t {
   iree_device_size_t device_bytes_peak;
   iree_device_size_t device_bytes_allocated;
   iree_device_size_t device_bytes_freed;
-  // TODO(benvanik): mapping information (discarded, mapping ranges,
-  //                 flushed/invalidated, etc).
+  // Bytes of released buffers retained by caching allocators for reuse. The
+  // storage remains allocated and is included in the allocated counters above
+  // such that live bytes minus cached bytes are those in use by the program.
+  iree_device_size_t host_bytes_cached;
+  iree_device_size_t device_bytes_cached;
+
+  // Total number of allocations and deallocations.
+  uint64_t allocation_count;
+  uint64_t free_count;
+  // Number of allocations made in each size bucket.
+  // See IREE_HAL_ALLOCATOR_STATISTICS_SIZE_BUCKET_COUNT.
+  uint64_t size_histogram[IREE_HAL_ALLOCATOR_STATISTICS_SIZE_BUCKET_COUNT];
+  // Byte counters for each iree_hal_allocator_usage_category_t.
+  iree_hal_allocator_byte_statistics_t
+      usage[IREE_HAL_ALLOCATOR_USAGE_CATEGORY_COUNT];
+
+  // Host mapping operations and the total number of bytes they covered.
+  // Allocators that do not route mappings through the HAL will report zero.
+  uint64_t map_count;
+  iree_device_size_t map_bytes;
+  uint64_t flush_count;
+  iree_device_size_t flush_bytes;
+  uint64_t invalidate_count;
+  iree_device_size_t invalidate_bytes;
 #else
   int reserved;
 #endif  // IREE_STATISTICS_ENABLE
@@ -303,6 +372,33 @@ IREE_API_EXPORT iree_status_t iree_hal_allocator_statistics_format(
     const iree_hal_allocator_statistics_t* statistics,
     iree_string_builder_t* builder);
 
+// Describes a live buffer as reported by
+// iree_hal_allocator_enumerate_live_buffers.
+typedef struct iree_hal_allocator_live_buffer_t {
+  // Buffer being described. Only valid for the duration of the callback and
+  // must not be retained; used to identify buffers across enumerations.
+  const iree_hal_buffer_t* buffer;
+  // Memory type of the buffer.
+  iree_hal_memory_type_t memory_type;
+  // Usage the buffer was allocated with.
+  iree_hal_buffer_usage_t allowed_usage;
+  // Total size of the allocation in bytes.
+  iree_device_size_t allocation_size;
+  // Site of the allocation request. Names are empty if unknown.
+  iree_hal_allocation_site_t site;
+} iree_hal_allocator_live_buffer_t;
+
+typedef iree_status_t(IREE_API_PTR* iree_hal_allocator_live_buffer_fn_t)(
+    void* user_data, const iree_hal_allocator_live_buffer_t* live_buffer);
+
+// A callback issued for each live buffer during enumeration.
+typedef struct {
+  // Callback function pointer.
+  iree_hal_allocator_live_buffer_fn_t fn;
+  // User data passed to the callback function. Unowned.
+  void* user_data;
+} iree_hal_allocator_live_buffer_callback_t;
+
 //===----------------------------------------------------------------------===//
 // iree_hal_allocator_t
 //===----------------------------------------------------------------------===//
@@ -334,11 +430,26 @@ IREE_API_EXPORT void iree_hal_allocator_query_statistics(
     iree_hal_allocator_t* IREE_RESTRICT allocator,
     iree_hal_allocator_statistics_t* IREE_RESTRICT out_statistics);
 
-// Prints the current allocation statistics of |allocator| to |file|.
+// Prints the current allocation statistics of |allocator| to |file| followed
+// by the live buffers if the allocator tracks them.
 // No-op if statistics are not enabled (IREE_STATISTICS_ENABLE).
 IREE_API_EXPORT iree_status_t iree_hal_allocator_statistics_fprint(
     FILE* file, iree_hal_allocator_t* IREE_RESTRICT allocator);
 
+// Issues |callback| for each buffer allocated from |allocator| that has not
+// yet been deallocated. Enumeration stops at the first failing status returned
+// by the callback and that status is returned to the caller. The names in the
+// reported allocation sites are only valid for the duration of the callback.
+//
+// The allocator may hold a lock during enumeration and the callback must not
+// allocate or deallocate buffers from |allocator|.
+//
+// Returns IREE_STATUS_UNIMPLEMENTED if the allocator does not track live
+// buffers or statistics are not enabled (IREE_STATISTICS_ENABLE).
+IREE_API_EXPORT iree_status_t iree_hal_allocator_enumerate_live_buffers(
+    iree_hal_allocator_t* IREE_RESTRICT allocator,
+    iree_hal_allocator_live_buffer_callback_t callback);
+
 // Returns a bitmask indicating what operations with buffers of the given type
 // are available on the allocator.
 //
@@ -488,6 +599,10 @@ typedef struct iree_hal_allocator_vtable_t {
       iree_hal_external_buffer_type_t requested_type,
       iree_hal_external_buffer_flags_t requested_flags,
       iree_hal_external_buffer_t* IREE_RESTRICT out_external_buffer);
+
+  iree_status_t(IREE_API_PTR* enumerate_live_buffers)(
+      iree_hal_allocator_t* IREE_RESTRICT allocator,
+      iree_hal_allocator_live_buffer_callback_t callback);
 } iree_hal_allocator_vtable_t;
 IREE_HAL_ASSERT_VTABLE_LAYOUT(iree_hal_allocator_vtable_t);
 
@@ -500,10 +615,50 @@ IREE_API_EXPORT void iree_hal_allocator_deallocate_buffer(
 
 #if IREE_STATISTICS_ENABLE
 
+// Returns the size histogram bucket of an allocation of |allocation_size|.
+static inline iree_host_size_t iree_hal_allocator_statistics_size_bucket(
+    iree_device_size_t allocation_size) {
+  iree_host_size_t bucket = 0;
+  iree_device_size_t bucket_limit = 256;
+  while (allocation_size > bucket_limit &&
+         bucket + 1 < IREE_HAL_ALLOCATOR_STATISTICS_SIZE_BUCKET_COUNT) {
+    bucket_limit <<= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+// Returns true if |usage| is included in the usage |category|.
+static inline bool iree_hal_allocator_statistics_usage_in_category(
+    iree_hal_buffer_usage_t usage,
+    iree_hal_allocator_usage_category_t category) {
+  switch (category) {
+    case IREE_HAL_ALLOCATOR_USAGE_CATEGORY_TRANSFER:
+      return iree_any_bit_set(usage, IREE_HAL_BUFFER_USAGE_TRANSFER);
+    case IREE_HAL_ALLOCATOR_USAGE_CATEGORY_DISPATCH:
+      return iree_any_bit_set(usage,
+                              IREE_HAL_BUFFER_USAGE_DISPATCH_INDIRECT_PARAMS |
+                                  IREE_HAL_BUFFER_USAGE_DISPATCH_UNIFORM_READ |
+                                  IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
+                                  IREE_HAL_BUFFER_USAGE_DISPATCH_IMAGE);
+    case IREE_HAL_ALLOCATOR_USAGE_CATEGORY_SHARING:
+      return iree_any_bit_set(usage,
+                              IREE_HAL_BUFFER_USAGE_SHARING_EXPORT |
+                                  IREE_HAL_BUFFER_USAGE_SHARING_REPLICATE |
+                                  IREE_HAL_BUFFER_USAGE_SHARING_CONCURRENT |
+                                  IREE_HAL_BUFFER_USAGE_SHARING_IMMUTABLE);
+    case IREE_HAL_ALLOCATOR_USAGE_CATEGORY_MAPPING:
+      return iree_any_bit_set(usage, IREE_HAL_BUFFER_USAGE_MAPPING);
+    default:
+      return false;
+  }
+}
+
 // Records a buffer allocation to |statistics|.
 static inline void iree_hal_allocator_statistics_record_alloc(
     iree_hal_allocator_statistics_t* statistics,
-    iree_hal_memory_type_t memory_type, iree_device_size_t allocation_size) {
+    iree_hal_memory_type_t memory_type, iree_hal_buffer_usage_t allowed_usage,
+    iree_device_size_t allocation_size) {
   if (iree_all_bits_set(memory_type, IREE_HAL_MEMORY_TYPE_HOST_LOCAL)) {
     statistics->host_bytes_allocated += allocation_size;
     statistics->host_bytes_peak =
@@ -515,22 +670,70 @@ static inline void iree_hal_allocator_statistics_record_alloc(
         statistics->device_bytes_peak,
         statistics->device_bytes_allocated - statistics->device_bytes_freed);
   }
+  ++statistics->allocation_count;
+  ++statistics->size_histogram[iree_hal_allocator_statistics_size_bucket(
+      allocation_size)];
+  for (int i = 0; i < IREE_HAL_ALLOCATOR_USAGE_CATEGORY_COUNT; ++i) {
+    if (!iree_hal_allocator_statistics_usage_in_category(
+            allowed_usage, (iree_hal_allocator_usage_category_t)i)) {
+      continue;
+    }
+    iree_hal_allocator_byte_statistics_t* usage = &statistics->usage[i];
+    usage->bytes_allocated += allocation_size;
+    usage->bytes_peak = iree_max(usage->bytes_peak,
+                                 usage->bytes_allocated - usage->bytes_freed);
+  }
 }
 
 // Records a buffer deallocation to |statistics|.
 static inline void iree_hal_allocator_statistics_record_free(
     iree_hal_allocator_statistics_t* statistics,
-    iree_hal_memory_type_t memory_type, iree_device_size_t allocation_size) {
+    iree_hal_memory_type_t memory_type, iree_hal_buffer_usage_t allowed_usage,
+    iree_device_size_t allocation_size) {
   if (iree_all_bits_set(memory_type, IREE_HAL_MEMORY_TYPE_HOST_LOCAL)) {
     statistics->host_bytes_freed += allocation_size;
   } else {
     statistics->device_bytes_freed += allocation_size;
   }
+  ++statistics->free_count;
+  for (int i = 0; i < IREE_HAL_ALLOCATOR_USAGE_CATEGORY_COUNT; ++i) {
+    if (iree_hal_allocator_statistics_usage_in_category(
+            allowed_usage, (iree_hal_allocator_usage_category_t)i)) {
+      statistics->usage[i].bytes_freed += allocation_size;
+    }
+  }
+}
+
+// Records a host mapping of |byte_length| bytes to |statistics|.
+static inline void iree_hal_allocator_statistics_record_map(
+    iree_hal_allocator_statistics_t* statistics,
+    iree_device_size_t byte_length) {
+  ++statistics->map_count;
+  statistics->map_bytes += byte_length;
+}
+
+// Records a flush of |byte_length| mapped bytes to |statistics|.
+static inline void iree_hal_allocator_statistics_record_flush(
+    iree_hal_allocator_statistics_t* statistics,
+    iree_device_size_t byte_length) {
+  ++statistics->flush_count;
+  statistics->flush_bytes += byte_length;
+}
+
+// Records an invalidation of |byte_length| mapped bytes to |statistics|.
+static inline void iree_hal_allocator_statistics_record_invalidate(
+    iree_hal_allocator_statistics_t* statistics,
+    iree_device_size_t byte_length) {
+  ++statistics->invalidate_count;
+  statistics->invalidate_bytes += byte_length;
 }
 
 #else
 #define iree_hal_allocator_statistics_record_alloc(...)
 #define iree_hal_allocator_statistics_record_free(...)
+#define iree_hal_allocator_statistics_record_map(...)
+#define iree_hal_allocator_statistics_record_flush(...)
+#define iree_hal_allocator_statistics_record_invalidate(...)
 #endif  // IREE_STATISTICS_ENABLE
 
 #ifdef __cplusplus
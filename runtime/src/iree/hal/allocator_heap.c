@@ -93,10 +93,8 @@ static void iree_hal_heap_allocator_query_statistics(
   IREE_STATISTICS({
     iree_hal_heap_allocator_t* allocator =
         iree_hal_heap_allocator_cast(base_allocator);
-    iree_slim_mutex_lock(&allocator->statistics.mutex);
-    memcpy(out_statistics, &allocator->statistics.base,
-           sizeof(*out_statistics));
-    iree_slim_mutex_unlock(&allocator->statistics.mutex);
+    iree_hal_heap_allocator_statistics_query(&allocator->statistics,
+                                             out_statistics);
   });
 }
 
@@ -193,6 +191,10 @@ static iree_status_t iree_hal_heap_allocator_import_buffer(
   iree_hal_buffer_params_t compat_params =
       iree_hal_heap_allocator_make_compatible(params);
 
+  // Imports are wrapped in-place with no copy and may reference read-only
+  // memory (such as constants in module rodata mapped from a file); callers
+  // request the access they require. Data not aligned to
+  // IREE_HAL_HEAP_BUFFER_ALIGNMENT is rejected with IREE_STATUS_OUT_OF_RANGE.
   return iree_hal_heap_buffer_wrap(
       base_allocator, compat_params.type, compat_params.access,
       compat_params.usage, external_buffer->size,
@@ -226,6 +228,20 @@ static iree_status_t iree_hal_heap_allocator_export_buffer(
   return iree_ok_status();
 }
 
+static iree_status_t iree_hal_heap_allocator_enumerate_live_buffers(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_allocator_live_buffer_callback_t callback) {
+#if IREE_STATISTICS_ENABLE
+  iree_hal_heap_allocator_t* allocator =
+      iree_hal_heap_allocator_cast(base_allocator);
+  return iree_hal_heap_allocator_statistics_enumerate_live_buffers(
+      &allocator->statistics, callback);
+#else
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "allocator statistics are not enabled");
+#endif  // IREE_STATISTICS_ENABLE
+}
+
 static const iree_hal_allocator_vtable_t iree_hal_heap_allocator_vtable = {
     .destroy = iree_hal_heap_allocator_destroy,
     .host_allocator = iree_hal_heap_allocator_host_allocator,
@@ -236,4 +252,5 @@ static const iree_hal_allocator_vtable_t iree_hal_heap_allocator_vtable = {
     .deallocate_buffer = iree_hal_heap_allocator_deallocate_buffer,
     .import_buffer = iree_hal_heap_allocator_import_buffer,
     .export_buffer = iree_hal_heap_allocator_export_buffer,
+    .enumerate_live_buffers = iree_hal_heap_allocator_enumerate_live_buffers,
 };
@@ -50,15 +50,35 @@ static_assert(sizeof(iree_hal_heap_buffer_t) <= 128,
               "header should be <= the minimum buffer alignment so that we "
               "don't introduce internal waste");
 
+// Maximum number of characters of the allocation site names retained per
+// buffer. Longer names are truncated.
+#define IREE_HAL_HEAP_BUFFER_SITE_NAME_CAPACITY 64
+
+// Live buffer tracking record allocated alongside buffers that have
+// statistics. In slab mode the record trails the data and in split mode it
+// trails the metadata such that no additional host allocations are required
+// and the buffer header size is unchanged.
+struct iree_hal_heap_buffer_record_t {
+  // Intrusive list of live buffers guarded by the statistics mutex.
+  iree_hal_heap_buffer_record_t* prev;
+  iree_hal_heap_buffer_record_t* next;
+  iree_hal_heap_buffer_t* buffer;
+  uint64_t site_offset;
+  uint8_t site_function_name_length;
+  uint8_t site_module_name_length;
+  // [function_name][module_name] without NUL terminators.
+  char site_names[IREE_HAL_HEAP_BUFFER_SITE_NAME_CAPACITY];
+};
+
 static const iree_hal_buffer_vtable_t iree_hal_heap_buffer_vtable;
 
 // Allocates a buffer with the metadata and storage split.
 // This results in an additional host allocation but allows for user-overridden
 // data storage allocations.
 static iree_status_t iree_hal_heap_buffer_allocate_split(
-    iree_device_size_t allocation_size, iree_allocator_t data_allocator,
-    iree_allocator_t host_allocator, iree_hal_heap_buffer_t** out_buffer,
-    iree_byte_span_t* out_data) {
+    iree_device_size_t allocation_size, iree_host_size_t record_size,
+    iree_allocator_t data_allocator, iree_allocator_t host_allocator,
+    iree_hal_heap_buffer_t** out_buffer, iree_byte_span_t* out_data) {
   // Try allocating the storage first as it's the most likely to fail if OOM.
   // It must be aligned to the minimum buffer alignment.
   out_data->data_length = allocation_size;
@@ -72,7 +92,8 @@ static iree_status_t iree_hal_heap_buffer_allocate_split(
 
   // Allocate the host metadata wrapper with natural alignment.
   iree_status_t status = iree_allocator_malloc(
-      host_allocator, sizeof(**out_buffer), (void**)out_buffer);
+      host_allocator, iree_sizeof_struct(**out_buffer) + record_size,
+      (void**)out_buffer);
   if (!iree_status_is_ok(status)) {
     // Need to free the storage we just allocated.
     iree_allocator_free_aligned(data_allocator, out_data->data);
@@ -84,14 +105,19 @@ static iree_status_t iree_hal_heap_buffer_allocate_split(
 // This results in a single allocation per buffer but requires that both the
 // metadata and storage live together.
 static iree_status_t iree_hal_heap_buffer_allocate_slab(
-    iree_device_size_t allocation_size, iree_allocator_t host_allocator,
-    iree_hal_heap_buffer_t** out_buffer, iree_byte_span_t* out_data) {
+    iree_device_size_t allocation_size, iree_host_size_t record_size,
+    iree_allocator_t host_allocator, iree_hal_heap_buffer_t** out_buffer,
+    iree_byte_span_t* out_data) {
   // The metadata header is always aligned and we want to ensure it's padded
   // out to the max alignment.
   iree_hal_heap_buffer_t* buffer = NULL;
   iree_host_size_t header_size =
       iree_host_align(iree_sizeof_struct(*buffer), iree_max_align_t);
-  iree_host_size_t total_size = header_size + allocation_size;
+  iree_host_size_t total_size =
+      header_size +
+      (record_size ? iree_host_align(allocation_size, iree_max_align_t)
+                   : allocation_size) +
+      record_size;
 
   // Allocate with the data starting at offset header_size aligned to the
   // minimum required buffer alignment. The header itself will still be aligned
@@ -111,6 +137,134 @@ static iree_status_t iree_hal_heap_buffer_allocate_slab(
   return iree_ok_status();
 }
 
+#if IREE_STATISTICS_ENABLE
+
+// Returns the live buffer tracking record of |buffer| or NULL if it has none.
+static iree_hal_heap_buffer_record_t* iree_hal_heap_buffer_record(
+    iree_hal_heap_buffer_t* buffer) {
+  if (!buffer->statistics) return NULL;
+  switch (buffer->base.flags) {
+    case IREE_HAL_HEAP_BUFFER_STORAGE_MODE_SLAB:
+      return (iree_hal_heap_buffer_record_t*)(buffer->data.data +
+                                              iree_host_align(
+                                                  buffer->data.data_length,
+                                                  iree_max_align_t));
+    case IREE_HAL_HEAP_BUFFER_STORAGE_MODE_SPLIT:
+      return (iree_hal_heap_buffer_record_t*)((uint8_t*)buffer +
+                                              iree_sizeof_struct(*buffer));
+    default:
+      return NULL;
+  }
+}
+
+// Initializes the |record| of |buffer| with the allocation |site| and links it
+// into the live buffer list. Requires the statistics mutex be held.
+static void iree_hal_heap_buffer_record_link(
+    iree_hal_heap_allocator_statistics_t* statistics,
+    iree_hal_heap_buffer_t* buffer, const iree_hal_allocation_site_t* site,
+    iree_hal_heap_buffer_record_t* record) {
+  record->buffer = buffer;
+  if (site) {
+    iree_host_size_t function_name_length =
+        iree_min(site->function_name.size,
+                 IREE_HAL_HEAP_BUFFER_SITE_NAME_CAPACITY);
+    iree_host_size_t module_name_length = iree_min(
+        site->module_name.size,
+        IREE_HAL_HEAP_BUFFER_SITE_NAME_CAPACITY - function_name_length);
+    memcpy(record->site_names, site->function_name.data,
+           function_name_length);
+    memcpy(record->site_names + function_name_length, site->module_name.data,
+           module_name_length);
+    record->site_function_name_length = (uint8_t)function_name_length;
+    record->site_module_name_length = (uint8_t)module_name_length;
+    record->site_offset = site->offset;
+  }
+  record->prev = NULL;
+  record->next = statistics->live_head;
+  if (statistics->live_head) statistics->live_head->prev = record;
+  statistics->live_head = record;
+}
+
+// Unlinks |record| from the live buffer list.
+// Requires the statistics mutex be held.
+static void iree_hal_heap_buffer_record_unlink(
+    iree_hal_heap_allocator_statistics_t* statistics,
+    iree_hal_heap_buffer_record_t* record) {
+  if (record->prev) {
+    record->prev->next = record->next;
+  } else {
+    statistics->live_head = record->next;
+  }
+  if (record->next) record->next->prev = record->prev;
+  record->prev = record->next = NULL;
+}
+
+iree_status_t iree_hal_heap_allocator_statistics_enumerate_live_buffers(
+    iree_hal_heap_allocator_statistics_t* statistics,
+    iree_hal_allocator_live_buffer_callback_t callback) {
+  iree_status_t status = iree_ok_status();
+  iree_slim_mutex_lock(&statistics->mutex);
+  for (iree_hal_heap_buffer_record_t* record = statistics->live_head;
+       record != NULL && iree_status_is_ok(status); record = record->next) {
+    iree_hal_buffer_t* buffer = &record->buffer->base;
+    iree_hal_allocator_live_buffer_t live_buffer = {
+        .buffer = buffer,
+        .memory_type = buffer->memory_type,
+        .allowed_usage = buffer->allowed_usage,
+        .allocation_size = buffer->allocation_size,
+        .site =
+            {
+                .module_name = iree_make_string_view(
+                    record->site_names + record->site_function_name_length,
+                    record->site_module_name_length),
+                .function_name =
+                    iree_make_string_view(record->site_names,
+                                          record->site_function_name_length),
+                .offset = record->site_offset,
+            },
+    };
+    status = callback.fn(callback.user_data, &live_buffer);
+  }
+  iree_slim_mutex_unlock(&statistics->mutex);
+  return status;
+}
+
+void iree_hal_heap_allocator_statistics_query(
+    iree_hal_heap_allocator_statistics_t* statistics,
+    iree_hal_allocator_statistics_t* out_statistics) {
+  iree_slim_mutex_lock(&statistics->mutex);
+  memcpy(out_statistics, &statistics->base, sizeof(*out_statistics));
+  iree_slim_mutex_unlock(&statistics->mutex);
+  out_statistics->map_count = (uint64_t)iree_atomic_load_int64(
+      &statistics->map_count, iree_memory_order_relaxed);
+  out_statistics->map_bytes = (iree_device_size_t)iree_atomic_load_int64(
+      &statistics->map_bytes, iree_memory_order_relaxed);
+  out_statistics->flush_count = (uint64_t)iree_atomic_load_int64(
+      &statistics->flush_count, iree_memory_order_relaxed);
+  out_statistics->flush_bytes = (iree_device_size_t)iree_atomic_load_int64(
+      &statistics->flush_bytes, iree_memory_order_relaxed);
+  out_statistics->invalidate_count = (uint64_t)iree_atomic_load_int64(
+      &statistics->invalidate_count, iree_memory_order_relaxed);
+  out_statistics->invalidate_bytes =
+      (iree_device_size_t)iree_atomic_load_int64(
+          &statistics->invalidate_bytes, iree_memory_order_relaxed);
+}
+
+#else
+
+void iree_hal_heap_allocator_statistics_query(
+    iree_hal_heap_allocator_statistics_t* statistics,
+    iree_hal_allocator_statistics_t* out_statistics) {}
+
+iree_status_t iree_hal_heap_allocator_statistics_enumerate_live_buffers(
+    iree_hal_heap_allocator_statistics_t* statistics,
+    iree_hal_allocator_live_buffer_callback_t callback) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "allocator statistics are not enabled");
+}
+
+#endif  // IREE_STATISTICS_ENABLE
+
 iree_status_t iree_hal_heap_buffer_create(
     iree_hal_allocator_t* allocator,
     iree_hal_heap_allocator_statistics_t* statistics,
@@ -128,14 +282,23 @@ iree_status_t iree_hal_heap_buffer_create(
   const bool same_allocator =
       memcmp(&data_allocator, &host_allocator, sizeof(data_allocator)) == 0;
 
+  // Buffers with statistics carry a live buffer tracking record.
+  iree_host_size_t record_size = 0;
+  IREE_STATISTICS({
+    if (statistics != NULL) {
+      record_size = sizeof(iree_hal_heap_buffer_record_t);
+    }
+  });
+
   iree_hal_heap_buffer_t* buffer = NULL;
   iree_byte_span_t data = iree_make_byte_span(NULL, 0);
   iree_status_t status =
       same_allocator
-          ? iree_hal_heap_buffer_allocate_slab(allocation_size, host_allocator,
-                                               &buffer, &data)
-          : iree_hal_heap_buffer_allocate_split(allocation_size, data_allocator,
-                                                host_allocator, &buffer, &data);
+          ? iree_hal_heap_buffer_allocate_slab(allocation_size, record_size,
+                                               host_allocator, &buffer, &data)
+          : iree_hal_heap_buffer_allocate_split(allocation_size, record_size,
+                                                data_allocator, host_allocator,
+                                                &buffer, &data);
 
   if (iree_status_is_ok(status)) {
     iree_hal_buffer_initialize(host_allocator, allocator, &buffer->base,
@@ -157,7 +320,9 @@ iree_status_t iree_hal_heap_buffer_create(
         buffer->statistics = statistics;
         iree_slim_mutex_lock(&statistics->mutex);
         iree_hal_allocator_statistics_record_alloc(
-            &statistics->base, params->type, allocation_size);
+            &statistics->base, params->type, params->usage, allocation_size);
+        iree_hal_heap_buffer_record_link(statistics, buffer, params->site,
+                                         iree_hal_heap_buffer_record(buffer));
         iree_slim_mutex_unlock(&statistics->mutex);
       }
     });
@@ -225,9 +390,11 @@ static void iree_hal_heap_buffer_destroy(iree_hal_buffer_t* base_buffer) {
   IREE_STATISTICS({
     if (buffer->statistics != NULL) {
       iree_slim_mutex_lock(&buffer->statistics->mutex);
-      iree_hal_allocator_statistics_record_free(&buffer->statistics->base,
-                                                base_buffer->memory_type,
-                                                base_buffer->allocation_size);
+      iree_hal_allocator_statistics_record_free(
+          &buffer->statistics->base, base_buffer->memory_type,
+          base_buffer->allowed_usage, base_buffer->allocation_size);
+      iree_hal_heap_buffer_record_unlink(buffer->statistics,
+                                         iree_hal_heap_buffer_record(buffer));
       iree_slim_mutex_unlock(&buffer->statistics->mutex);
     }
   });
@@ -238,7 +405,7 @@ static void iree_hal_heap_buffer_destroy(iree_hal_buffer_t* base_buffer) {
       break;
     }
     case IREE_HAL_HEAP_BUFFER_STORAGE_MODE_SPLIT: {
-      iree_allocator_free(buffer->data_allocator, buffer->data.data);
+      iree_allocator_free_aligned(buffer->data_allocator, buffer->data.data);
       iree_allocator_free(host_allocator, buffer);
       break;
     }
@@ -267,6 +434,16 @@ static iree_status_t iree_hal_heap_buffer_map_range(
   mapping->contents = iree_make_byte_span(buffer->data.data + local_byte_offset,
                                           local_byte_length);
 
+  IREE_STATISTICS({
+    if (buffer->statistics != NULL) {
+      iree_atomic_fetch_add_int64(&buffer->statistics->map_count, 1,
+                                  iree_memory_order_relaxed);
+      iree_atomic_fetch_add_int64(&buffer->statistics->map_bytes,
+                                  (int64_t)local_byte_length,
+                                  iree_memory_order_relaxed);
+    }
+  });
+
   // If we mapped for discard scribble over the bytes. This is not a mandated
   // behavior but it will make debugging issues easier. Alternatively for
   // heap buffers we could reallocate them such that ASAN yells, but that
@@ -291,6 +468,16 @@ static iree_status_t iree_hal_heap_buffer_invalidate_range(
     iree_hal_buffer_t* base_buffer, iree_device_size_t local_byte_offset,
     iree_device_size_t local_byte_length) {
   iree_atomic_thread_fence(iree_memory_order_acquire);
+  IREE_STATISTICS({
+    iree_hal_heap_buffer_t* buffer = (iree_hal_heap_buffer_t*)base_buffer;
+    if (buffer->statistics != NULL) {
+      iree_atomic_fetch_add_int64(&buffer->statistics->invalidate_count, 1,
+                                  iree_memory_order_relaxed);
+      iree_atomic_fetch_add_int64(&buffer->statistics->invalidate_bytes,
+                                  (int64_t)local_byte_length,
+                                  iree_memory_order_relaxed);
+    }
+  });
   return iree_ok_status();
 }
 
@@ -298,6 +485,16 @@ static iree_status_t iree_hal_heap_buffer_flush_range(
     iree_hal_buffer_t* base_buffer, iree_device_size_t local_byte_offset,
     iree_device_size_t local_byte_length) {
   iree_atomic_thread_fence(iree_memory_order_release);
+  IREE_STATISTICS({
+    iree_hal_heap_buffer_t* buffer = (iree_hal_heap_buffer_t*)base_buffer;
+    if (buffer->statistics != NULL) {
+      iree_atomic_fetch_add_int64(&buffer->statistics->flush_count, 1,
+                                  iree_memory_order_relaxed);
+      iree_atomic_fetch_add_int64(&buffer->statistics->flush_bytes,
+                                  (int64_t)local_byte_length,
+                                  iree_memory_order_relaxed);
+    }
+  });
   return iree_ok_status();
 }
 
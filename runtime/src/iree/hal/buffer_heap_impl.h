@@ -9,6 +9,7 @@
 
 #include "iree/base/api.h"
 #include "iree/base/internal/synchronization.h"
+#include "iree/hal/allocator.h"
 #include "iree/hal/buffer.h"
 
 #ifdef __cplusplus
@@ -19,13 +20,37 @@ extern "C" {
 // Private utilities for working with heap buffers
 //===----------------------------------------------------------------------===//
 
+typedef struct iree_hal_heap_buffer_record_t iree_hal_heap_buffer_record_t;
+
 // Shared heap allocator statistics; owned by a heap allocator.
-// Access to the base statistics must be guarded by |mutex|.
+// Access to the base statistics and live buffer list must be guarded by
+// |mutex|. Host mapping operations are frequent and only bump the atomic
+// counters, which are merged into the base statistics when queried.
 typedef struct iree_hal_heap_allocator_statistics_t {
   iree_slim_mutex_t mutex;
   iree_hal_allocator_statistics_t base;
+  // Intrusive list of buffers created with these statistics that have not yet
+  // been destroyed.
+  iree_hal_heap_buffer_record_t* live_head;
+  iree_atomic_int64_t map_count;
+  iree_atomic_int64_t map_bytes;
+  iree_atomic_int64_t flush_count;
+  iree_atomic_int64_t flush_bytes;
+  iree_atomic_int64_t invalidate_count;
+  iree_atomic_int64_t invalidate_bytes;
 } iree_hal_heap_allocator_statistics_t;
 
+// Captures the current values of |statistics| into |out_statistics|.
+void iree_hal_heap_allocator_statistics_query(
+    iree_hal_heap_allocator_statistics_t* statistics,
+    iree_hal_allocator_statistics_t* out_statistics);
+
+// Issues |callback| for each live buffer tracked in |statistics|.
+// The statistics mutex is held during enumeration.
+iree_status_t iree_hal_heap_allocator_statistics_enumerate_live_buffers(
+    iree_hal_heap_allocator_statistics_t* statistics,
+    iree_hal_allocator_live_buffer_callback_t callback);
+
 // Allocates a new heap buffer from the specified |data_allocator|.
 // |host_allocator| is used for the iree_hal_buffer_t metadata. If both
 // |data_allocator| and |host_allocator| are the same the buffer will be created
@@ -106,6 +106,61 @@ TEST_P(allocator_test, AllocateEmptyBuffer) {
   iree_hal_buffer_release(buffer);
 }
 
+// Allocators that track live buffers must report the allocation site of
+// outstanding buffers and stop reporting them once they are released.
+TEST_P(allocator_test, EnumerateLiveBuffers) {
+  iree_hal_allocation_site_t site = {
+      iree_make_cstring_view("cts"),
+      iree_make_cstring_view("EnumerateLiveBuffers"),
+      /*offset=*/123,
+  };
+  iree_hal_buffer_params_t params = {0};
+  params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+  params.usage = IREE_HAL_BUFFER_USAGE_TRANSFER;
+  params.site = &site;
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+      device_allocator_, params, kAllocationSize, iree_const_byte_span_empty(),
+      &buffer));
+
+  struct Match {
+    int count = 0;
+    uint64_t offset = 0;
+  };
+  iree_hal_allocator_live_buffer_callback_t callback;
+  callback.fn = +[](void* user_data,
+                    const iree_hal_allocator_live_buffer_t* live_buffer) {
+    if (iree_string_view_equal(live_buffer->site.function_name,
+                               IREE_SV("EnumerateLiveBuffers"))) {
+      auto* match = reinterpret_cast<Match*>(user_data);
+      ++match->count;
+      match->offset = live_buffer->site.offset;
+    }
+    return iree_ok_status();
+  };
+
+  Match live_match;
+  callback.user_data = &live_match;
+  iree_status_t status =
+      iree_hal_allocator_enumerate_live_buffers(device_allocator_, callback);
+  if (iree_status_is_unimplemented(status)) {
+    iree_status_ignore(status);
+    iree_hal_buffer_release(buffer);
+    GTEST_SKIP() << "allocator does not track live buffers";
+  }
+  IREE_ASSERT_OK(status);
+  EXPECT_EQ(live_match.count, 1);
+  EXPECT_EQ(live_match.offset, 123);
+
+  iree_hal_buffer_release(buffer);
+
+  Match released_match;
+  callback.user_data = &released_match;
+  IREE_ASSERT_OK(
+      iree_hal_allocator_enumerate_live_buffers(device_allocator_, callback));
+  EXPECT_EQ(released_match.count, 0);
+}
+
 }  // namespace cts
 }  // namespace hal
 }  // namespace iree
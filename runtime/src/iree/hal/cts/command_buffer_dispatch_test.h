@@ -7,10 +7,14 @@
 #ifndef IREE_HAL_CTS_COMMAND_BUFFER_DISPATCH_TEST_H_
 #define IREE_HAL_CTS_COMMAND_BUFFER_DISPATCH_TEST_H_
 
+#include <thread>
+
 #include "iree/base/api.h"
+#include "iree/base/internal/arena.h"
 #include "iree/base/string_view.h"
 #include "iree/hal/api.h"
 #include "iree/hal/cts/cts_test_base.h"
+#include "iree/hal/utils/deferred_command_buffer.h"
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
 
@@ -148,6 +152,110 @@ TEST_P(command_buffer_dispatch_test, DispatchAbs) {
   CleanupExecutable();
 }
 
+
+// Records a dispatch once with buffers sourced from a binding table and
+// submits it with different tables, checking that unbound device command
+// buffers are reused by later binds and that concurrent binds don't interfere.
+TEST_P(command_buffer_dispatch_test, DispatchAbsWithBindingTable) {
+  PrepareAbsExecutable();
+
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize(4096, iree_allocator_system(), &block_pool);
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_deferred_command_buffer_create(
+      device_, IREE_HAL_COMMAND_BUFFER_MODE_UNVALIDATED,
+      IREE_HAL_COMMAND_CATEGORY_DISPATCH, &block_pool, iree_allocator_system(),
+      &command_buffer));
+
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+  iree_hal_descriptor_set_binding_t descriptor_set_bindings[] = {
+      {/*binding=*/0, /*buffer=*/NULL, /*offset=*/0, sizeof(float)},
+      {/*binding=*/1, /*buffer=*/NULL, /*offset=*/0, sizeof(float)},
+  };
+  uint32_t buffer_slots[] = {0, 1};
+  IREE_ASSERT_OK(iree_hal_deferred_command_buffer_push_descriptor_set_indirect(
+      command_buffer, executable_layout_, /*set=*/0,
+      IREE_ARRAYSIZE(descriptor_set_bindings), descriptor_set_bindings,
+      buffer_slots));
+  IREE_ASSERT_OK(iree_hal_command_buffer_dispatch(
+      command_buffer, executable_, /*entry_point=*/0,
+      /*workgroup_x=*/1, /*workgroup_y=*/1, /*workgroup_z=*/1));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+  EXPECT_EQ(2, iree_hal_deferred_command_buffer_binding_capacity(
+                   command_buffer));
+
+  iree_hal_buffer_params_t params = {0};
+  params.type =
+      IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+  params.usage = IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
+                 IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_MAPPING;
+  float input_data[2] = {-2.5f, -4.0f};
+  iree_hal_buffer_t* input_buffers[2] = {NULL, NULL};
+  iree_hal_buffer_t* output_buffers[2] = {NULL, NULL};
+  for (int i = 0; i < 2; ++i) {
+    IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+        device_allocator_, params, sizeof(float),
+        iree_make_const_byte_span(&input_data[i], sizeof(float)),
+        &input_buffers[i]));
+    IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+        device_allocator_, params, sizeof(float), iree_const_byte_span_empty(),
+        &output_buffers[i]));
+  }
+
+  // Binds the |i|th input and output buffers, submits, unbinds, and returns
+  // the device command buffer that was submitted for identity comparison.
+  auto bind_and_submit = [&](int i) -> iree_hal_command_buffer_t* {
+    iree_hal_buffer_t* buffers[2] = {input_buffers[i], output_buffers[i]};
+    iree_hal_buffer_binding_table_t binding_table = {IREE_ARRAYSIZE(buffers),
+                                                     buffers};
+    iree_hal_command_buffer_t* target_command_buffer = NULL;
+    IREE_EXPECT_OK(iree_hal_deferred_command_buffer_bind(
+        command_buffer, device_, binding_table, &target_command_buffer));
+    if (!target_command_buffer) return NULL;
+    IREE_EXPECT_OK(SubmitCommandBufferAndWait(
+        IREE_HAL_COMMAND_CATEGORY_DISPATCH, target_command_buffer));
+    float output_value = 0.0f;
+    IREE_EXPECT_OK(iree_hal_device_transfer_d2h(
+        device_, output_buffers[i],
+        /*source_offset=*/0, &output_value, sizeof(output_value),
+        IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+    EXPECT_EQ(-input_data[i], output_value);
+    bool is_one_shot =
+        iree_all_bits_set(iree_hal_command_buffer_mode(target_command_buffer),
+                          IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT);
+    iree_hal_deferred_command_buffer_unbind(command_buffer, device_,
+                                            target_command_buffer);
+    return is_one_shot ? NULL : target_command_buffer;
+  };
+
+  // An unbound device command buffer is reused by the next bind unless the
+  // device only supports one-shot command buffers.
+  iree_hal_command_buffer_t* target_0 = bind_and_submit(0);
+  iree_hal_command_buffer_t* target_1 = bind_and_submit(1);
+  if (target_0) {
+    EXPECT_EQ(target_0, target_1);
+  }
+
+  // Each replay uses the buffers of its own bindings, including when the same
+  // recording is bound and submitted from multiple threads concurrently.
+  bind_and_submit(0);
+  std::thread threads[2];
+  for (int i = 0; i < 2; ++i) {
+    threads[i] = std::thread([&, i]() {
+      for (int j = 0; j < 8; ++j) bind_and_submit(i);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  iree_hal_command_buffer_release(command_buffer);
+  for (int i = 0; i < 2; ++i) {
+    iree_hal_buffer_release(output_buffers[i]);
+    iree_hal_buffer_release(input_buffers[i]);
+  }
+  iree_arena_block_pool_deinitialize(&block_pool);
+  CleanupExecutable();
+}
+
 }  // namespace cts
 }  // namespace hal
 }  // namespace iree
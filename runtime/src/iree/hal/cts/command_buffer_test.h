@@ -45,6 +45,31 @@ class command_buffer_test : public CtsTestBase {
     *out_buffer = device_buffer;
   }
 
+  // Records a new command buffer with |mode| that fills |buffer_a| with
+  // |pattern| and then copies |buffer_a| into |buffer_b|.
+  iree_hal_command_buffer_t* RecordFillAndCopy(
+      iree_hal_command_buffer_mode_t mode, iree_hal_buffer_t* buffer_a,
+      iree_hal_buffer_t* buffer_b, iree_device_size_t buffer_size,
+      uint8_t pattern) {
+    iree_hal_command_buffer_t* command_buffer = NULL;
+    IREE_CHECK_OK(iree_hal_command_buffer_create(
+        device_, mode, IREE_HAL_COMMAND_CATEGORY_ANY,
+        IREE_HAL_QUEUE_AFFINITY_ANY, &command_buffer));
+    IREE_CHECK_OK(iree_hal_command_buffer_begin(command_buffer));
+    IREE_CHECK_OK(iree_hal_command_buffer_fill_buffer(
+        command_buffer, buffer_a, /*target_offset=*/0, buffer_size, &pattern,
+        sizeof(pattern)));
+    IREE_CHECK_OK(iree_hal_command_buffer_execution_barrier(
+        command_buffer, IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE,
+        IREE_HAL_EXECUTION_STAGE_COMMAND_ISSUE,
+        IREE_HAL_EXECUTION_BARRIER_FLAG_NONE, 0, NULL, 0, NULL));
+    IREE_CHECK_OK(iree_hal_command_buffer_copy_buffer(
+        command_buffer, buffer_a, /*source_offset=*/0, buffer_b,
+        /*target_offset=*/0, buffer_size));
+    IREE_CHECK_OK(iree_hal_command_buffer_end(command_buffer));
+    return command_buffer;
+  }
+
   std::vector<uint8_t> RunFillBufferTest(iree_device_size_t buffer_size,
                                          iree_device_size_t target_offset,
                                          iree_device_size_t fill_length,
@@ -567,6 +592,241 @@ TEST_P(command_buffer_test, UpdateBufferSubspan) {
   iree_hal_buffer_release(device_buffer);
 }
 
+// Records independent commands on either side of barriers and verifies that
+// read-after-write, write-after-read, and write-after-write hazards across the
+// barriers are respected.
+TEST_P(command_buffer_test, BarrierHazards) {
+  iree_device_size_t buffer_size = 16;
+  std::vector<uint8_t> source_data{0x01, 0x02, 0x03, 0x04,  //
+                                   0x05, 0x06, 0x07, 0x08,  //
+                                   0x09, 0x0A, 0x0B, 0x0C,  //
+                                   0x0D, 0x0E, 0x0F, 0x10};
+
+  iree_hal_buffer_t* buffer_a = NULL;
+  CreateZeroedDeviceBuffer(buffer_size, &buffer_a);
+  iree_hal_buffer_t* buffer_b = NULL;
+  CreateZeroedDeviceBuffer(buffer_size, &buffer_b);
+  iree_hal_buffer_t* buffer_c = NULL;
+  CreateZeroedDeviceBuffer(buffer_size, &buffer_c);
+
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_CHECK_OK(iree_hal_command_buffer_create(
+      device_, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+      IREE_HAL_COMMAND_CATEGORY_ANY, IREE_HAL_QUEUE_AFFINITY_ANY,
+      &command_buffer));
+  IREE_CHECK_OK(iree_hal_command_buffer_begin(command_buffer));
+
+  uint8_t pattern_33 = 0x33;
+  uint8_t pattern_44 = 0x44;
+  uint8_t pattern_ff = 0xFF;
+
+  // A = source_data, C = 0x33...
+  IREE_CHECK_OK(iree_hal_command_buffer_update_buffer(
+      command_buffer, source_data.data(), /*source_offset=*/0, buffer_a,
+      /*target_offset=*/0, buffer_size));
+  IREE_CHECK_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer, buffer_c, /*target_offset=*/0, buffer_size, &pattern_33,
+      sizeof(pattern_33)));
+  IREE_CHECK_OK(iree_hal_command_buffer_execution_barrier(
+      command_buffer, IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE,
+      IREE_HAL_EXECUTION_STAGE_COMMAND_ISSUE,
+      IREE_HAL_EXECUTION_BARRIER_FLAG_NONE, 0, NULL, 0, NULL));
+
+  // B = A (read-after-write), C[0:8] = 0x44... (write-after-write)
+  IREE_CHECK_OK(iree_hal_command_buffer_copy_buffer(
+      command_buffer, buffer_a, /*source_offset=*/0, buffer_b,
+      /*target_offset=*/0, buffer_size));
+  IREE_CHECK_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer, buffer_c, /*target_offset=*/0, /*length=*/8, &pattern_44,
+      sizeof(pattern_44)));
+  IREE_CHECK_OK(iree_hal_command_buffer_execution_barrier(
+      command_buffer, IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE,
+      IREE_HAL_EXECUTION_STAGE_COMMAND_ISSUE,
+      IREE_HAL_EXECUTION_BARRIER_FLAG_NONE, 0, NULL, 0, NULL));
+
+  // A = 0xFF... (write-after-read), C[8:16] = B[0:8] (read-after-write)
+  IREE_CHECK_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer, buffer_a, /*target_offset=*/0, buffer_size, &pattern_ff,
+      sizeof(pattern_ff)));
+  IREE_CHECK_OK(iree_hal_command_buffer_copy_buffer(
+      command_buffer, buffer_b, /*source_offset=*/0, buffer_c,
+      /*target_offset=*/8, /*length=*/8));
+
+  IREE_CHECK_OK(iree_hal_command_buffer_end(command_buffer));
+  IREE_CHECK_OK(SubmitCommandBufferAndWait(IREE_HAL_COMMAND_CATEGORY_ANY,
+                                           command_buffer));
+
+  std::vector<uint8_t> actual_a(buffer_size);
+  IREE_ASSERT_OK(iree_hal_device_transfer_d2h(
+      device_, buffer_a, /*source_offset=*/0, actual_a.data(), actual_a.size(),
+      IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+  EXPECT_THAT(actual_a, ContainerEq(std::vector<uint8_t>(buffer_size, 0xFF)));
+  std::vector<uint8_t> actual_b(buffer_size);
+  IREE_ASSERT_OK(iree_hal_device_transfer_d2h(
+      device_, buffer_b, /*source_offset=*/0, actual_b.data(), actual_b.size(),
+      IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+  EXPECT_THAT(actual_b, ContainerEq(source_data));
+  std::vector<uint8_t> actual_c(buffer_size);
+  IREE_ASSERT_OK(iree_hal_device_transfer_d2h(
+      device_, buffer_c, /*source_offset=*/0, actual_c.data(), actual_c.size(),
+      IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+  std::vector<uint8_t> reference_c{0x44, 0x44, 0x44, 0x44,  //
+                                   0x44, 0x44, 0x44, 0x44,  //
+                                   0x01, 0x02, 0x03, 0x04,  //
+                                   0x05, 0x06, 0x07, 0x08};
+  EXPECT_THAT(actual_c, ContainerEq(reference_c));
+
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_buffer_release(buffer_c);
+  iree_hal_buffer_release(buffer_b);
+  iree_hal_buffer_release(buffer_a);
+}
+
+// Records reads of a buffer spread over several barriers followed by a write
+// that must wait for all of them, and writers to disjoint halves of a buffer
+// within the same barrier that a later read must wait for.
+TEST_P(command_buffer_test, BarrierHazardsAcrossEpochs) {
+  iree_device_size_t buffer_size = 16;
+  std::vector<uint8_t> source_data{0x01, 0x02, 0x03, 0x04,  //
+                                   0x05, 0x06, 0x07, 0x08,  //
+                                   0x09, 0x0A, 0x0B, 0x0C,  //
+                                   0x0D, 0x0E, 0x0F, 0x10};
+
+  iree_hal_buffer_t* buffer_a = NULL;
+  CreateZeroedDeviceBuffer(buffer_size, &buffer_a);
+  iree_hal_buffer_t* buffer_b = NULL;
+  CreateZeroedDeviceBuffer(buffer_size, &buffer_b);
+  iree_hal_buffer_t* buffer_c = NULL;
+  CreateZeroedDeviceBuffer(buffer_size, &buffer_c);
+
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_CHECK_OK(iree_hal_command_buffer_create(
+      device_, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+      IREE_HAL_COMMAND_CATEGORY_ANY, IREE_HAL_QUEUE_AFFINITY_ANY,
+      &command_buffer));
+  IREE_CHECK_OK(iree_hal_command_buffer_begin(command_buffer));
+  auto barrier = [&]() {
+    IREE_CHECK_OK(iree_hal_command_buffer_execution_barrier(
+        command_buffer, IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE,
+        IREE_HAL_EXECUTION_STAGE_COMMAND_ISSUE,
+        IREE_HAL_EXECUTION_BARRIER_FLAG_NONE, 0, NULL, 0, NULL));
+  };
+
+  // A = source_data
+  IREE_CHECK_OK(iree_hal_command_buffer_update_buffer(
+      command_buffer, source_data.data(), /*source_offset=*/0, buffer_a,
+      /*target_offset=*/0, buffer_size));
+  barrier();
+
+  // B[i*4:i*4+4] = A[i*4:i*4+4] with each copy in its own epoch.
+  for (iree_device_size_t i = 0; i < buffer_size / 4; ++i) {
+    IREE_CHECK_OK(iree_hal_command_buffer_copy_buffer(
+        command_buffer, buffer_a, /*source_offset=*/i * 4, buffer_b,
+        /*target_offset=*/i * 4, /*length=*/4));
+    barrier();
+  }
+
+  // A[0:8] = 0x11..., A[8:16] = 0x22... (write-after-read of all copies)
+  uint8_t pattern_11 = 0x11;
+  uint8_t pattern_22 = 0x22;
+  IREE_CHECK_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer, buffer_a, /*target_offset=*/0, /*length=*/8, &pattern_11,
+      sizeof(pattern_11)));
+  IREE_CHECK_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer, buffer_a, /*target_offset=*/8, /*length=*/8, &pattern_22,
+      sizeof(pattern_22)));
+  barrier();
+
+  // C = A (read-after-write of both fills)
+  IREE_CHECK_OK(iree_hal_command_buffer_copy_buffer(
+      command_buffer, buffer_a, /*source_offset=*/0, buffer_c,
+      /*target_offset=*/0, buffer_size));
+
+  IREE_CHECK_OK(iree_hal_command_buffer_end(command_buffer));
+  IREE_CHECK_OK(SubmitCommandBufferAndWait(IREE_HAL_COMMAND_CATEGORY_ANY,
+                                           command_buffer));
+
+  std::vector<uint8_t> actual_b(buffer_size);
+  IREE_ASSERT_OK(iree_hal_device_transfer_d2h(
+      device_, buffer_b, /*source_offset=*/0, actual_b.data(), actual_b.size(),
+      IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+  EXPECT_THAT(actual_b, ContainerEq(source_data));
+  std::vector<uint8_t> actual_c(buffer_size);
+  IREE_ASSERT_OK(iree_hal_device_transfer_d2h(
+      device_, buffer_c, /*source_offset=*/0, actual_c.data(), actual_c.size(),
+      IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+  std::vector<uint8_t> reference_c{0x11, 0x11, 0x11, 0x11,  //
+                                   0x11, 0x11, 0x11, 0x11,  //
+                                   0x22, 0x22, 0x22, 0x22,  //
+                                   0x22, 0x22, 0x22, 0x22};
+  EXPECT_THAT(actual_c, ContainerEq(reference_c));
+
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_buffer_release(buffer_c);
+  iree_hal_buffer_release(buffer_b);
+  iree_hal_buffer_release(buffer_a);
+}
+
+// Submits the same commands multiple times in every command buffer mode,
+// clobbering the results between submissions to ensure each execution runs all
+// of the recorded commands. Reusable command buffers are recorded once and
+// one-shot command buffers are recorded again for each submission.
+TEST_P(command_buffer_test, SubmitMultipleTimes) {
+  const iree_hal_command_buffer_mode_t modes[] = {
+      0,
+      IREE_HAL_COMMAND_BUFFER_MODE_UNVALIDATED,
+      IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+      IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT |
+          IREE_HAL_COMMAND_BUFFER_MODE_UNVALIDATED,
+      IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT |
+          IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION,
+  };
+
+  iree_device_size_t buffer_size = 16;
+  iree_hal_buffer_t* buffer_a = NULL;
+  CreateZeroedDeviceBuffer(buffer_size, &buffer_a);
+  iree_hal_buffer_t* buffer_b = NULL;
+  CreateZeroedDeviceBuffer(buffer_size, &buffer_b);
+
+  uint8_t pattern = 0x07;
+  std::vector<uint8_t> zeros(buffer_size, 0x00);
+  for (iree_hal_command_buffer_mode_t mode : modes) {
+    SCOPED_TRACE(::testing::Message() << "mode=" << mode);
+    const bool is_one_shot =
+        iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT);
+    iree_hal_command_buffer_t* command_buffer = NULL;
+    for (int i = 0; i < 3; ++i) {
+      if (!command_buffer) {
+        command_buffer =
+            RecordFillAndCopy(mode, buffer_a, buffer_b, buffer_size, pattern);
+      }
+      IREE_ASSERT_OK(iree_hal_device_transfer_h2d(
+          device_, zeros.data(), buffer_a, /*target_offset=*/0, zeros.size(),
+          IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+      IREE_ASSERT_OK(iree_hal_device_transfer_h2d(
+          device_, zeros.data(), buffer_b, /*target_offset=*/0, zeros.size(),
+          IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+      IREE_CHECK_OK(SubmitCommandBufferAndWait(IREE_HAL_COMMAND_CATEGORY_ANY,
+                                               command_buffer));
+      std::vector<uint8_t> actual_b(buffer_size);
+      IREE_ASSERT_OK(iree_hal_device_transfer_d2h(
+          device_, buffer_b, /*source_offset=*/0, actual_b.data(),
+          actual_b.size(), IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT,
+          iree_infinite_timeout()));
+      EXPECT_THAT(actual_b,
+                  ContainerEq(std::vector<uint8_t>(buffer_size, pattern)));
+      if (is_one_shot) {
+        iree_hal_command_buffer_release(command_buffer);
+        command_buffer = NULL;
+      }
+    }
+    iree_hal_command_buffer_release(command_buffer);
+  }
+
+  iree_hal_buffer_release(buffer_b);
+  iree_hal_buffer_release(buffer_a);
+}
+
 }  // namespace cts
 }  // namespace hal
 }  // namespace iree
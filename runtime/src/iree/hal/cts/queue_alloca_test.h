@@ -0,0 +1,113 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_CTS_QUEUE_ALLOCA_TEST_H_
+#define IREE_HAL_CTS_QUEUE_ALLOCA_TEST_H_
+
+#include <cstdint>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/cts/cts_test_base.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace cts {
+
+class queue_alloca_test : public CtsTestBase {
+ protected:
+  static iree_hal_buffer_params_t DefaultParams() {
+    iree_hal_buffer_params_t params = {0};
+    params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+    params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+    return params;
+  }
+};
+
+TEST_P(queue_alloca_test, AllocaWithSignal) {
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore));
+  uint64_t signal_value = 1ull;
+  iree_hal_semaphore_list_t wait_list = {0, NULL, NULL};
+  iree_hal_semaphore_list_t signal_list = {1, &semaphore, &signal_value};
+
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_device_queue_alloca(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, wait_list, signal_list,
+      DefaultParams(), /*allocation_size=*/1000, &buffer));
+  ASSERT_NE(buffer, nullptr);
+  EXPECT_EQ(iree_hal_buffer_byte_length(buffer), 1000);
+  IREE_ASSERT_OK(
+      iree_hal_semaphore_wait(semaphore, 1ull, iree_infinite_timeout()));
+
+  iree_hal_buffer_release(buffer);
+  iree_hal_semaphore_release(semaphore);
+}
+
+TEST_P(queue_alloca_test, AllocaThenDealloca) {
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore));
+  uint64_t alloca_value = 1ull;
+  uint64_t dealloca_value = 2ull;
+  iree_hal_semaphore_list_t empty_list = {0, NULL, NULL};
+  iree_hal_semaphore_list_t alloca_list = {1, &semaphore, &alloca_value};
+  iree_hal_semaphore_list_t dealloca_list = {1, &semaphore, &dealloca_value};
+
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_device_queue_alloca(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, empty_list, alloca_list,
+      DefaultParams(), /*allocation_size=*/4096, &buffer));
+
+  // The dealloca is ordered after the alloca and the buffer can be released
+  // immediately as the queue retains it until the wait is satisfied.
+  IREE_ASSERT_OK(iree_hal_device_queue_dealloca(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, alloca_list, dealloca_list,
+      buffer));
+  iree_hal_buffer_release(buffer);
+  IREE_ASSERT_OK(
+      iree_hal_semaphore_wait(semaphore, 2ull, iree_infinite_timeout()));
+
+  iree_hal_semaphore_release(semaphore);
+}
+
+TEST_P(queue_alloca_test, RepeatedAllocaDealloca) {
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore));
+
+  // Each iteration allocates after the previous iteration deallocated so that
+  // implementations with queue pools can reuse the storage.
+  uint64_t timepoint = 0ull;
+  for (int i = 0; i < 4; ++i) {
+    uint64_t wait_value = timepoint;
+    uint64_t alloca_value = timepoint + 1;
+    uint64_t dealloca_value = timepoint + 2;
+    iree_hal_semaphore_list_t wait_list = {1, &semaphore, &wait_value};
+    iree_hal_semaphore_list_t alloca_list = {1, &semaphore, &alloca_value};
+    iree_hal_semaphore_list_t dealloca_list = {1, &semaphore, &dealloca_value};
+
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_ASSERT_OK(iree_hal_device_queue_alloca(
+        device_, IREE_HAL_QUEUE_AFFINITY_ANY, wait_list, alloca_list,
+        DefaultParams(), /*allocation_size=*/64 * 1024, &buffer));
+    IREE_ASSERT_OK(iree_hal_device_queue_dealloca(
+        device_, IREE_HAL_QUEUE_AFFINITY_ANY, alloca_list, dealloca_list,
+        buffer));
+    iree_hal_buffer_release(buffer);
+    timepoint = dealloca_value;
+  }
+  IREE_ASSERT_OK(
+      iree_hal_semaphore_wait(semaphore, timepoint, iree_infinite_timeout()));
+
+  iree_hal_semaphore_release(semaphore);
+}
+
+}  // namespace cts
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_CTS_QUEUE_ALLOCA_TEST_H_
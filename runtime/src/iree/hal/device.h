@@ -326,6 +326,52 @@ IREE_API_EXPORT iree_status_t iree_hal_device_transfer_and_wait(
     const iree_hal_transfer_command_t* transfer_commands,
     iree_timeout_t timeout);
 
+// Reserves and returns a transient buffer ordered on a device queue.
+// The allocation is not made available until all of |wait_semaphore_list|
+// have been reached and once the storage is ready for use the
+// |signal_semaphore_list| will be signaled. The contents of the buffer are
+// undefined and it must not be used by work that does not wait on the
+// signals.
+//
+// Storage is drawn from a pool that the queue selected by |queue_affinity|
+// maintains and that may hold memory released by prior
+// iree_hal_device_queue_dealloca operations on the same queue. Queue-ordered
+// allocation allows transient memory to be reused across overlapping
+// submissions without the host having to wait for the work using it to
+// complete.
+//
+// NOTE: implementations may bind storage when this is called instead of when
+// the waits are reached. Storage released by deallocas that have not yet
+// retired at the time of the call may then only be reused if
+// |wait_semaphore_list| includes their signals and the buffer exactly matches
+// the request; otherwise a new allocation is made instead.
+//
+// The returned buffer should be released with iree_hal_device_queue_dealloca
+// so that its storage is returned to the pool in queue order. Dropping the
+// last reference without a dealloca returns the storage immediately and the
+// caller must ensure no in-flight work is still using it.
+IREE_API_EXPORT iree_status_t iree_hal_device_queue_alloca(
+    iree_hal_device_t* device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_params_t params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer);
+
+// Releases the storage of a |buffer| allocated with
+// iree_hal_device_queue_alloca back to the pool of the queue selected by
+// |queue_affinity| once all of |wait_semaphore_list| have been reached. The
+// |signal_semaphore_list| is signaled after the storage has been released.
+//
+// The queue retains |buffer| until the waits are satisfied and callers may
+// release their own reference immediately after this call returns. The
+// storage is recycled when the last reference to |buffer| is released and
+// callers must not access the buffer contents after issuing the dealloca.
+IREE_API_EXPORT iree_status_t iree_hal_device_queue_dealloca(
+    iree_hal_device_t* device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_t* buffer);
+
 // Submits one or more batches of work to a device queue.
 //
 // The queue is selected based on the flags set in |command_categories| and the
@@ -464,6 +510,19 @@ typedef struct iree_hal_device_vtable_t {
       iree_device_size_t target_offset, iree_device_size_t data_length,
       iree_hal_transfer_buffer_flags_t flags, iree_timeout_t timeout);
 
+  iree_status_t(IREE_API_PTR* queue_alloca)(
+      iree_hal_device_t* device, iree_hal_queue_affinity_t queue_affinity,
+      const iree_hal_semaphore_list_t wait_semaphore_list,
+      const iree_hal_semaphore_list_t signal_semaphore_list,
+      iree_hal_buffer_params_t params, iree_device_size_t allocation_size,
+      iree_hal_buffer_t** IREE_RESTRICT out_buffer);
+
+  iree_status_t(IREE_API_PTR* queue_dealloca)(
+      iree_hal_device_t* device, iree_hal_queue_affinity_t queue_affinity,
+      const iree_hal_semaphore_list_t wait_semaphore_list,
+      const iree_hal_semaphore_list_t signal_semaphore_list,
+      iree_hal_buffer_t* buffer);
+
   iree_status_t(IREE_API_PTR* queue_submit)(
       iree_hal_device_t* device, iree_hal_command_category_t command_categories,
       iree_hal_queue_affinity_t queue_affinity, iree_host_size_t batch_count,
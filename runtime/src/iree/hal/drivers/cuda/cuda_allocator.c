@@ -264,7 +264,7 @@ static iree_status_t iree_hal_cuda_allocator_allocate_buffer(
                            (void*)iree_hal_cuda_buffer_device_pointer(buffer),
                            allocation_size);
     IREE_STATISTICS(iree_hal_allocator_statistics_record_alloc(
-        &allocator->statistics, memory_type, allocation_size));
+        &allocator->statistics, memory_type, params->usage, allocation_size));
     *out_buffer = buffer;
   } else {
     if (!buffer) {
@@ -292,6 +292,7 @@ static void iree_hal_cuda_allocator_deallocate_buffer(
       (void*)iree_hal_cuda_buffer_device_pointer(base_buffer));
   IREE_STATISTICS(iree_hal_allocator_statistics_record_free(
       &allocator->statistics, memory_type,
+      iree_hal_buffer_allowed_usage(base_buffer),
       iree_hal_buffer_allocation_size(base_buffer)));
 
   iree_hal_buffer_destroy(base_buffer);
@@ -317,6 +318,13 @@ static iree_status_t iree_hal_cuda_allocator_export_buffer(
                           "exporting to external buffers not supported");
 }
 
+static iree_status_t iree_hal_cuda_allocator_enumerate_live_buffers(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_allocator_live_buffer_callback_t callback) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "live buffer tracking not supported");
+}
+
 static const iree_hal_allocator_vtable_t iree_hal_cuda_allocator_vtable = {
     .destroy = iree_hal_cuda_allocator_destroy,
     .host_allocator = iree_hal_cuda_allocator_host_allocator,
@@ -327,4 +335,5 @@ static const iree_hal_allocator_vtable_t iree_hal_cuda_allocator_vtable = {
     .deallocate_buffer = iree_hal_cuda_allocator_deallocate_buffer,
     .import_buffer = iree_hal_cuda_allocator_import_buffer,
     .export_buffer = iree_hal_cuda_allocator_export_buffer,
+    .enumerate_live_buffers = iree_hal_cuda_allocator_enumerate_live_buffers,
 };
@@ -19,6 +19,7 @@
 #include "iree/hal/local/local_executable_cache.h"
 #include "iree/hal/local/local_executable_layout.h"
 #include "iree/hal/utils/buffer_transfer.h"
+#include "iree/hal/utils/caching_allocator.h"
 
 typedef struct iree_hal_sync_device_t {
   iree_hal_resource_t resource;
@@ -27,6 +28,9 @@ typedef struct iree_hal_sync_device_t {
   iree_allocator_t host_allocator;
   iree_hal_allocator_t* device_allocator;
 
+  // Pool used for queue-ordered allocations on the single queue.
+  iree_hal_allocator_t* queue_pool;
+
   iree_hal_sync_semaphore_state_t semaphore_state;
 
   iree_host_size_t loader_count;
@@ -89,6 +93,12 @@ iree_status_t iree_hal_sync_device_create(
     }
 
     iree_hal_sync_semaphore_state_initialize(&device->semaphore_state);
+
+    iree_hal_caching_allocator_options_t pool_options;
+    iree_hal_caching_allocator_options_initialize(&pool_options);
+    status = iree_hal_caching_allocator_create(device_allocator, &pool_options,
+                                               host_allocator,
+                                               &device->queue_pool);
   }
 
   if (iree_status_is_ok(status)) {
@@ -107,6 +117,7 @@ static void iree_hal_sync_device_destroy(iree_hal_device_t* base_device) {
 
   iree_hal_sync_semaphore_state_deinitialize(&device->semaphore_state);
 
+  iree_hal_allocator_release(device->queue_pool);
   for (iree_host_size_t i = 0; i < device->loader_count; ++i) {
     iree_hal_executable_loader_release(device->loaders[i]);
   }
@@ -136,6 +147,7 @@ static iree_hal_allocator_t* iree_hal_sync_device_allocator(
 
 static iree_status_t iree_hal_sync_device_trim(iree_hal_device_t* base_device) {
   iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
+  IREE_RETURN_IF_ERROR(iree_hal_allocator_trim(device->queue_pool));
   return iree_hal_allocator_trim(device->device_allocator);
 }
 
@@ -246,6 +258,52 @@ iree_hal_sync_device_query_semaphore_compatibility(
   return IREE_HAL_SEMAPHORE_COMPATIBILITY_HOST_ONLY;
 }
 
+static iree_status_t iree_hal_sync_device_queue_alloca(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_params_t params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
+
+  // Everything prior to the waits has executed inline by the time they are
+  // satisfied and any storage released to the pool is safe to reuse.
+  IREE_RETURN_IF_ERROR(iree_hal_sync_semaphore_multi_wait(
+      &device->semaphore_state, IREE_HAL_WAIT_MODE_ALL, &wait_semaphore_list,
+      iree_infinite_timeout()));
+
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+      device->queue_pool, params, allocation_size, iree_const_byte_span_empty(),
+      &buffer));
+
+  iree_status_t status = iree_hal_sync_semaphore_multi_signal(
+      &device->semaphore_state, &signal_semaphore_list);
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+  return status;
+}
+
+static iree_status_t iree_hal_sync_device_queue_dealloca(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_t* buffer) {
+  iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
+
+  // Once the waits are satisfied all work using the buffer has completed and
+  // its storage returns to the pool when the caller releases it.
+  IREE_RETURN_IF_ERROR(iree_hal_sync_semaphore_multi_wait(
+      &device->semaphore_state, IREE_HAL_WAIT_MODE_ALL, &wait_semaphore_list,
+      iree_infinite_timeout()));
+
+  return iree_hal_sync_semaphore_multi_signal(&device->semaphore_state,
+                                              &signal_semaphore_list);
+}
+
 static iree_status_t iree_hal_sync_device_queue_submit(
     iree_hal_device_t* base_device,
     iree_hal_command_category_t command_categories,
@@ -326,6 +384,8 @@ static const iree_hal_device_vtable_t iree_hal_sync_device_vtable = {
     .query_semaphore_compatibility =
         iree_hal_sync_device_query_semaphore_compatibility,
     .transfer_range = iree_hal_device_transfer_mappable_range,
+    .queue_alloca = iree_hal_sync_device_queue_alloca,
+    .queue_dealloca = iree_hal_sync_device_queue_dealloca,
     .queue_submit = iree_hal_sync_device_queue_submit,
     .submit_and_wait = iree_hal_sync_device_submit_and_wait,
     .wait_semaphores = iree_hal_sync_device_wait_semaphores,
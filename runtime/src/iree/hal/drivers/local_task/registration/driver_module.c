@@ -10,10 +10,15 @@
 #include <stddef.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/numa.h"
 #include "iree/hal/drivers/local_task/task_driver.h"
 #include "iree/hal/local/loaders/registration/init.h"
 #include "iree/task/api.h"
 
+// Maximum number of executors (and thus devices) exposed by the driver.
+// Only reached when creating one executor per NUMA node.
+#define IREE_HAL_LOCAL_TASK_MAX_EXECUTOR_COUNT 16
+
 static iree_status_t iree_hal_local_task_driver_factory_enumerate(
     void* self, iree_host_size_t* out_driver_info_count,
     const iree_hal_driver_info_t** out_driver_infos) {
@@ -46,26 +51,41 @@ static iree_status_t iree_hal_local_task_driver_factory_try_create(
   iree_status_t status = iree_hal_create_all_available_executable_loaders(
       IREE_ARRAYSIZE(loaders), &loader_count, loaders, host_allocator);
 
-  iree_task_executor_t* executor = NULL;
+  // One executor is created per NUMA node if requested by flags. Each gets its
+  // own device allocator so that device memory is local to the node.
+  iree_task_executor_t* executors[IREE_HAL_LOCAL_TASK_MAX_EXECUTOR_COUNT] = {
+      NULL};
+  uint32_t executor_node_ids[IREE_HAL_LOCAL_TASK_MAX_EXECUTOR_COUNT] = {0};
+  iree_host_size_t executor_count = 0;
   if (iree_status_is_ok(status)) {
-    status = iree_task_executor_create_from_flags(host_allocator, &executor);
+    status = iree_task_executors_create_from_flags(
+        host_allocator, IREE_ARRAYSIZE(executors), executors, executor_node_ids,
+        &executor_count);
   }
 
-  iree_hal_allocator_t* device_allocator = NULL;
-  if (iree_status_is_ok(status)) {
+  iree_hal_allocator_t*
+      device_allocators[IREE_HAL_LOCAL_TASK_MAX_EXECUTOR_COUNT] = {NULL};
+  for (iree_host_size_t i = 0; i < executor_count && iree_status_is_ok(status);
+       ++i) {
+    iree_allocator_t data_allocator =
+        executor_node_ids[i] == IREE_TASK_TOPOLOGY_NODE_ID_ANY
+            ? host_allocator
+            : iree_numa_node_allocator(executor_node_ids[i]);
     status = iree_hal_allocator_create_heap(iree_make_cstring_view("local"),
-                                            host_allocator, host_allocator,
-                                            &device_allocator);
+                                            data_allocator, host_allocator,
+                                            &device_allocators[i]);
   }
 
   if (iree_status_is_ok(status)) {
     status = iree_hal_task_driver_create(
-        driver_name, &default_params, executor, loader_count, loaders,
-        device_allocator, host_allocator, out_driver);
+        driver_name, &default_params, executor_count, executors, loader_count,
+        loaders, device_allocators, host_allocator, out_driver);
   }
 
-  iree_hal_allocator_release(device_allocator);
-  iree_task_executor_release(executor);
+  for (iree_host_size_t i = 0; i < executor_count; ++i) {
+    iree_hal_allocator_release(device_allocators[i]);
+    iree_task_executor_release(executors[i]);
+  }
   for (iree_host_size_t i = 0; i < loader_count; ++i) {
     iree_hal_executable_loader_release(loaders[i]);
   }
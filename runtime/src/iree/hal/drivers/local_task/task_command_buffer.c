@@ -28,6 +28,81 @@
 // iree_hal_task_command_buffer_t
 //===----------------------------------------------------------------------===//
 
+// A memory range accessed by a recorded command.
+// Ranges are tracked relative to the allocated buffer so that different
+// subspans of the same allocation are compared against each other.
+typedef struct iree_hal_task_access_t {
+  iree_hal_buffer_t* allocated_buffer;
+  iree_device_size_t offset;
+  iree_device_size_t length;
+  bool is_write;
+} iree_hal_task_access_t;
+
+typedef struct iree_hal_task_node_t iree_hal_task_node_t;
+
+// An edge in the command DAG from a node to a node that must execute after it.
+typedef struct iree_hal_task_edge_t {
+  struct iree_hal_task_edge_t* next;
+  iree_hal_task_node_t* target;
+} iree_hal_task_edge_t;
+
+// A recorded command in the DAG.
+// Nodes only exist during recording and are resolved into task completion
+// dependencies (and fan-out barriers) when recording ends.
+struct iree_hal_task_node_t {
+  // Previously recorded node, if any.
+  iree_hal_task_node_t* prev;
+  // Task executing the command.
+  iree_task_t* task;
+  // Total number of edges into and out of the node.
+  uint32_t predecessor_count;
+  uint32_t successor_count;
+  // Nodes that must execute after this one, most recently added first.
+  iree_hal_task_edge_t* successors;
+};
+
+// An entry in a list of nodes that accessed a tracked range.
+typedef struct iree_hal_task_node_ref_t {
+  struct iree_hal_task_node_ref_t* next;
+  iree_hal_task_node_t* node;
+} iree_hal_task_node_ref_t;
+
+// The most recent accesses to a distinct range of an allocated buffer.
+// Accesses recorded in |epoch| are pending: commands within the same epoch are
+// unordered with respect to each other and only depend on the accesses
+// committed from prior epochs. The pending accesses are committed when the
+// range is next accessed from a later epoch.
+typedef struct iree_hal_task_range_t {
+  struct iree_hal_task_range_t* next;
+  iree_hal_buffer_t* allocated_buffer;
+  iree_device_size_t offset;
+  iree_device_size_t length;
+  // Barrier epoch of the pending accesses.
+  uint32_t epoch;
+  // Nodes from the most recent prior epoch that wrote the range. Any earlier
+  // access with a hazard is ordered before all of them.
+  iree_hal_task_node_ref_t* writers;
+  // Nodes from prior epochs that read the range since |writers|.
+  iree_hal_task_node_ref_t* readers;
+  // Nodes recorded in |epoch| that wrote or read the range.
+  iree_hal_task_node_ref_t* pending_writers;
+  iree_hal_task_node_ref_t* pending_readers;
+} iree_hal_task_range_t;
+
+// Number of buckets the tracked ranges are distributed across.
+// Must be a power of two.
+#define IREE_HAL_TASK_RANGE_BUCKET_COUNT 32
+
+// Initial state of a task in a reusable command buffer DAG.
+// Executing a task consumes its dependency count and completion edge so each
+// time the command buffer is issued the tasks are restored from these.
+typedef struct iree_hal_task_reset_entry_t {
+  iree_task_t* task;
+  iree_task_t* completion_task;
+  int32_t pending_dependency_count;
+  iree_task_flags_t flags;
+} iree_hal_task_reset_entry_t;
+
 // iree/task/-based command buffer.
 // We track a minimal amount of state here and incrementally build out the task
 // DAG that we can submit to the task system directly. There's no intermediate
@@ -36,6 +111,19 @@
 // additional allocations required during recording or execution. That means our
 // command buffer here is essentially just a builder for the task system types
 // and manager of the lifetime of the tasks.
+//
+// Barriers and events are not turned into global join points. Instead each
+// command records the buffer ranges it reads and writes and only depends on
+// the commands recorded prior to a barrier that it has a hazard with
+// (read-after-write, write-after-read, or write-after-write). Commands that
+// touch disjoint memory are free to execute concurrently even when separated
+// by barriers.
+//
+// Command buffers not recorded as one-shot may be issued any number of times
+// without re-recording: when recording ends the initial state of each task is
+// captured and restored in-place prior to each issue. Executions of the same
+// command buffer must not overlap and attempting to issue one that is still
+// executing will fail.
 typedef struct iree_hal_task_command_buffer_t {
   iree_hal_command_buffer_t base;
   iree_allocator_t host_allocator;
@@ -56,29 +144,38 @@ typedef struct iree_hal_task_command_buffer_t {
 
   // One or more tasks at the leaves of the DAG.
   // Only once all these tasks have completed execution will the command buffer
-  // be considered completed as a whole.
-  //
-  // An empty list indicates that root_tasks are also the leaves.
-  iree_task_list_t leaf_tasks;
+  // be considered completed as a whole. Tasks may be both roots and leaves and
+  // as such the leaves are stored in an arena-allocated array instead of a
+  // task list.
+  iree_host_size_t leaf_task_count;
+  iree_task_t** leaf_tasks;
+
+  // Reusable command buffers only: the root tasks of the DAG and the initial
+  // state of all tasks captured when recording ended. |root_tasks| is unused as
+  // the intrusive task list links are clobbered by each submission.
+  iree_host_size_t root_task_count;
+  iree_task_t** root_task_array;
+  iree_host_size_t reset_entry_count;
+  iree_hal_task_reset_entry_t* reset_entries;
+
+  // Nonzero while a reusable command buffer has been issued and not yet
+  // retired. Used to reject overlapping executions.
+  iree_atomic_int32_t is_executing;
 
   // TODO(benvanik): move this out of the struct and allocate from the arena -
   // we only need this during recording and it's ~4KB of waste otherwise.
   // State tracked within the command buffer during recording only.
   struct {
-    // The last global barrier that was inserted, if any.
-    // The barrier is allocated and inserted into the DAG when requested but the
-    // actual barrier dependency list is only allocated and set on flushes.
-    // This lets us allocate the appropriately sized barrier task list from the
-    // arena even though when the barrier is recorded we don't yet know what
-    // other tasks we'll be emitting as we walk the command stream.
-    iree_task_barrier_t* open_barrier;
+    // Current barrier epoch. Incremented each time a barrier or event wait is
+    // recorded and used to tell whether two commands may overlap.
+    uint32_t epoch;
 
-    // The number of tasks in the open barrier (|open_tasks|), used to quickly
-    // allocate storage for the task list without needing to walk the list.
-    iree_host_size_t open_task_count;
+    // The most recently recorded node; all nodes can be walked via |prev|.
+    iree_hal_task_node_t* last_node;
 
-    // All execution tasks emitted that must execute after |open_barrier|.
-    iree_task_list_t open_tasks;
+    // All distinct ranges accessed by recorded nodes bucketed by their
+    // allocated buffer. See iree_hal_task_range_bucket.
+    iree_hal_task_range_t* range_buckets[IREE_HAL_TASK_RANGE_BUCKET_COUNT];
 
     // A flattened list of all available descriptor set bindings.
     // As descriptor sets are pushed/bound the bindings will be updated to
@@ -91,6 +188,11 @@ typedef struct iree_hal_task_command_buffer_t {
         binding_lengths[IREE_HAL_LOCAL_MAX_DESCRIPTOR_SET_COUNT *
                         IREE_HAL_LOCAL_MAX_DESCRIPTOR_BINDING_COUNT];
 
+    // Memory ranges accessed through each binding in |bindings|.
+    iree_hal_task_access_t
+        binding_accesses[IREE_HAL_LOCAL_MAX_DESCRIPTOR_SET_COUNT *
+                         IREE_HAL_LOCAL_MAX_DESCRIPTOR_BINDING_COUNT];
+
     // All available push constants updated each time push_constants is called.
     // Reset only with the command buffer and otherwise will maintain its values
     // during recording to allow for partial push_constants updates.
@@ -116,20 +218,6 @@ iree_status_t iree_hal_task_command_buffer_create(
     iree_hal_command_buffer_t** out_command_buffer) {
   IREE_ASSERT_ARGUMENT(out_command_buffer);
   *out_command_buffer = NULL;
-  if (!iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT)) {
-    // If we want reuse we'd need to support duplicating the task DAG after
-    // recording or have some kind of copy-on-submit behavior that does so if
-    // a command buffer is submitted for execution twice. Allowing for the same
-    // command buffer to be enqueued multiple times would be fine so long as
-    // execution doesn't overlap (`cmdbuf|cmdbuf` vs
-    // `cmdbuf -> semaphore -> cmdbuf`) though we'd still need to be careful
-    // that we did the enqueuing and reset of the task structures at the right
-    // times. Definitely something that'll be useful in the future... but not
-    // today :)
-    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                            "only one-shot command buffer usage is supported");
-  }
-
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_hal_task_command_buffer_t* command_buffer = NULL;
@@ -143,7 +231,14 @@ iree_status_t iree_hal_task_command_buffer_create(
     command_buffer->scope = scope;
     iree_arena_initialize(block_pool, &command_buffer->arena);
     iree_task_list_initialize(&command_buffer->root_tasks);
-    iree_task_list_initialize(&command_buffer->leaf_tasks);
+    command_buffer->leaf_task_count = 0;
+    command_buffer->leaf_tasks = NULL;
+    command_buffer->root_task_count = 0;
+    command_buffer->root_task_array = NULL;
+    command_buffer->reset_entry_count = 0;
+    command_buffer->reset_entries = NULL;
+    iree_atomic_store_int32(&command_buffer->is_executing, 0,
+                            iree_memory_order_relaxed);
     memset(&command_buffer->state, 0, sizeof(command_buffer->state));
     status = iree_hal_resource_set_allocate(block_pool,
                                             &command_buffer->resource_set);
@@ -161,7 +256,12 @@ iree_status_t iree_hal_task_command_buffer_create(
 static void iree_hal_task_command_buffer_reset(
     iree_hal_task_command_buffer_t* command_buffer) {
   memset(&command_buffer->state, 0, sizeof(command_buffer->state));
-  iree_task_list_discard(&command_buffer->leaf_tasks);
+  command_buffer->leaf_task_count = 0;
+  command_buffer->leaf_tasks = NULL;
+  command_buffer->root_task_count = 0;
+  command_buffer->root_task_array = NULL;
+  command_buffer->reset_entry_count = 0;
+  command_buffer->reset_entries = NULL;
   iree_task_list_discard(&command_buffer->root_tasks);
   iree_hal_resource_set_reset(command_buffer->resource_set);
   iree_arena_reset(&command_buffer->arena);
@@ -201,7 +301,9 @@ static void* iree_hal_task_command_buffer_dyn_cast(
 // iree_hal_task_command_buffer_t recording
 //===----------------------------------------------------------------------===//
 
-static iree_status_t iree_hal_task_command_buffer_flush_tasks(
+static iree_status_t iree_hal_task_command_buffer_resolve_dag(
+    iree_hal_task_command_buffer_t* command_buffer);
+static iree_status_t iree_hal_task_command_buffer_capture_reset_state(
     iree_hal_task_command_buffer_t* command_buffer);
 
 static iree_status_t iree_hal_task_command_buffer_begin(
@@ -217,133 +319,321 @@ static iree_status_t iree_hal_task_command_buffer_end(
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
 
-  // Flush any open barriers.
+  // Link up all recorded tasks now that we know the full set of edges.
   IREE_RETURN_IF_ERROR(
-      iree_hal_task_command_buffer_flush_tasks(command_buffer));
-
-  // Move the tasks from the leaf list (tail) to the root list (head) if this
-  // was the first set of tasks recorded.
-  if (iree_task_list_is_empty(&command_buffer->root_tasks) &&
-      !iree_task_list_is_empty(&command_buffer->leaf_tasks)) {
-    iree_task_list_move(&command_buffer->leaf_tasks,
-                        &command_buffer->root_tasks);
+      iree_hal_task_command_buffer_resolve_dag(command_buffer));
+
+  // Reusable command buffers need to be able to restore the DAG after each
+  // execution consumes it.
+  if (!iree_all_bits_set(command_buffer->base.mode,
+                         IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT)) {
+    IREE_RETURN_IF_ERROR(
+        iree_hal_task_command_buffer_capture_reset_state(command_buffer));
   }
 
   return iree_ok_status();
 }
 
-// Flushes all open tasks to the previous barrier and prepares for more
-// recording. The root tasks are also populated here when required as this is
-// the one place where we can see both halves of the most recent synchronization
-// event: those tasks recorded prior (if any) and the task that marks the set of
-// tasks that will be recorded after (if any).
-static iree_status_t iree_hal_task_command_buffer_flush_tasks(
-    iree_hal_task_command_buffer_t* command_buffer) {
-  iree_task_barrier_t* open_barrier = command_buffer->state.open_barrier;
-  if (open_barrier != NULL) {
-    // There is an open barrier we need to fixup the fork out to all of the open
-    // tasks that were recorded after it.
-    iree_task_t* task_head =
-        iree_task_list_front(&command_buffer->state.open_tasks);
-    iree_host_size_t dependent_task_count =
-        command_buffer->state.open_task_count;
-    if (dependent_task_count == 1) {
-      // Special-case: only one open task so we can avoid the additional barrier
-      // overhead by reusing the completion task.
-      iree_task_set_completion_task(&open_barrier->header, task_head);
-    } else if (dependent_task_count > 1) {
-      // Allocate the list of tasks we'll stash back on the previous barrier.
-      // Since we couldn't know at the time how many tasks would end up in the
-      // barrier we had to defer it until now.
-      iree_task_t** dependent_tasks = NULL;
-      IREE_RETURN_IF_ERROR(iree_arena_allocate(
-          &command_buffer->arena, dependent_task_count * sizeof(iree_task_t*),
-          (void**)&dependent_tasks));
-      iree_task_t* task = task_head;
-      for (iree_host_size_t i = 0; i < dependent_task_count; ++i) {
-        dependent_tasks[i] = task;
-        task = task->next_task;
-      }
-      iree_task_barrier_set_dependent_tasks(open_barrier, dependent_task_count,
-                                            dependent_tasks);
-    }
+// Produces an access of |buffer| in the range [|offset|, |offset|+|length|)
+// relative to its allocated buffer.
+static iree_hal_task_access_t iree_hal_task_make_access(
+    iree_hal_buffer_t* buffer, iree_device_size_t offset,
+    iree_device_size_t length, bool is_write) {
+  if (length == IREE_WHOLE_BUFFER) {
+    length = iree_hal_buffer_byte_length(buffer) - offset;
   }
-  command_buffer->state.open_barrier = NULL;
-
-  // Move the open tasks to the tail as they represent the first half of the
-  // *next* barrier that will be inserted.
-  if (command_buffer->state.open_task_count > 0) {
-    iree_task_list_move(&command_buffer->state.open_tasks,
-                        &command_buffer->leaf_tasks);
-    command_buffer->state.open_task_count = 0;
+  iree_hal_task_access_t access = {
+      .allocated_buffer = iree_hal_buffer_allocated_buffer(buffer),
+      .offset = iree_hal_buffer_byte_offset(buffer) + offset,
+      .length = length,
+      .is_write = is_write,
+  };
+  return access;
+}
+
+// Returns true if |access| touches any byte of |range|.
+static bool iree_hal_task_access_overlaps(const iree_hal_task_access_t* access,
+                                          const iree_hal_task_range_t* range) {
+  return access->allocated_buffer == range->allocated_buffer &&
+         access->offset < range->offset + range->length &&
+         range->offset < access->offset + access->length;
+}
+
+// Returns true if |access| touches every byte of |range|.
+static bool iree_hal_task_access_covers(const iree_hal_task_access_t* access,
+                                        const iree_hal_task_range_t* range) {
+  return access->allocated_buffer == range->allocated_buffer &&
+         access->offset <= range->offset &&
+         access->offset + access->length >= range->offset + range->length;
+}
+
+// Returns the bucket of ranges in |command_buffer| that ranges of
+// |allocated_buffer| are tracked in. Ranges of other buffers may share the
+// bucket.
+static iree_hal_task_range_t** iree_hal_task_range_bucket(
+    iree_hal_task_command_buffer_t* command_buffer,
+    const iree_hal_buffer_t* allocated_buffer) {
+  uintptr_t hash = (uintptr_t)allocated_buffer;
+  hash = (hash >> 4) ^ (hash >> 12);
+  return &command_buffer->state
+              .range_buckets[hash & (IREE_HAL_TASK_RANGE_BUCKET_COUNT - 1)];
+}
+
+// Commits the pending accesses of |range| if they were recorded prior to
+// |epoch|. Pending writers replace all prior accesses as they were ordered
+// after them when recorded.
+static void iree_hal_task_range_commit(iree_hal_task_range_t* range,
+                                       uint32_t epoch) {
+  if (range->epoch == epoch) return;
+  if (range->pending_writers) {
+    range->writers = range->pending_writers;
+    range->readers = range->pending_readers;
+  } else if (range->pending_readers) {
+    iree_hal_task_node_ref_t* tail = range->pending_readers;
+    while (tail->next) tail = tail->next;
+    tail->next = range->readers;
+    range->readers = range->pending_readers;
   }
+  range->pending_writers = NULL;
+  range->pending_readers = NULL;
+  range->epoch = epoch;
+}
 
+// Prepends |node| to |list|.
+static iree_status_t iree_hal_task_command_buffer_push_node_ref(
+    iree_hal_task_command_buffer_t* command_buffer, iree_hal_task_node_t* node,
+    iree_hal_task_node_ref_t** list) {
+  iree_hal_task_node_ref_t* ref = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_arena_allocate(&command_buffer->arena, sizeof(*ref), (void**)&ref));
+  ref->next = *list;
+  ref->node = node;
+  *list = ref;
   return iree_ok_status();
 }
 
-// Emits a global barrier, splitting execution into all prior recorded tasks
-// and all subsequent recorded tasks. This is currently the critical piece that
-// limits our concurrency: changing to fine-grained barriers (via barrier
-// buffers or events) will allow more work to overlap at the cost of more brain
-// to build out the proper task graph.
-static iree_status_t iree_hal_task_command_buffer_emit_global_barrier(
-    iree_hal_task_command_buffer_t* command_buffer) {
-  // Flush open tasks to the previous barrier. This resets our state such that
-  // we can assign the new open barrier and start recording tasks for it.
-  // Previous tasks will be moved into the leaf_tasks list.
-  IREE_RETURN_IF_ERROR(
-      iree_hal_task_command_buffer_flush_tasks(command_buffer));
-
-  // Allocate the new open barrier.
-  // As we are recording forward we can't yet assign the dependent tasks (the
-  // second half of the synchronization domain) and instead are just inserting
-  // it so we can setup the join from previous tasks (the first half of the
-  // synchronization domain).
-  iree_task_barrier_t* barrier = NULL;
+// Adds an edge ordering |source| before |target|, if not already present.
+static iree_status_t iree_hal_task_command_buffer_add_edge(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_task_node_t* source, iree_hal_task_node_t* target) {
+  // Edges into a node are all added while it is being recorded and the most
+  // recent is always at the head of the list.
+  if (source->successors && source->successors->target == target) {
+    return iree_ok_status();
+  }
+  iree_hal_task_edge_t* edge = NULL;
   IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
-                                           sizeof(*barrier), (void**)&barrier));
-  iree_task_barrier_initialize_empty(command_buffer->scope, barrier);
+                                           sizeof(*edge), (void**)&edge));
+  edge->next = source->successors;
+  edge->target = target;
+  source->successors = edge;
+  ++source->successor_count;
+  ++target->predecessor_count;
+  return iree_ok_status();
+}
 
-  // If there were previous tasks then join them to the barrier.
-  for (iree_task_t* task = iree_task_list_front(&command_buffer->leaf_tasks);
-       task != NULL; task = task->next_task) {
-    iree_task_set_completion_task(task, &barrier->header);
+// Adds edges ordering each node in |list| before |target|.
+static iree_status_t iree_hal_task_command_buffer_add_edges(
+    iree_hal_task_command_buffer_t* command_buffer,
+    const iree_hal_task_node_ref_t* list, iree_hal_task_node_t* target) {
+  for (const iree_hal_task_node_ref_t* ref = list; ref; ref = ref->next) {
+    IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_add_edge(
+        command_buffer, ref->node, target));
   }
+  return iree_ok_status();
+}
 
-  // Move the tasks from the leaf list (tail) to the root list (head) if this
-  // was the first set of tasks recorded.
-  if (iree_task_list_is_empty(&command_buffer->root_tasks) &&
-      !iree_task_list_is_empty(&command_buffer->leaf_tasks)) {
-    iree_task_list_move(&command_buffer->leaf_tasks,
-                        &command_buffer->root_tasks);
+// Emits the given execution |task| into the DAG. The task will depend on all
+// previously recorded tasks separated from it by a barrier that access memory
+// overlapping |accesses| in a conflicting way.
+//
+// Only the most recent writers and the readers since then are tracked per
+// range such that the cost of recording a command is bounded by the number of
+// distinct ranges recorded for the allocations it accesses and not the number
+// of previously recorded commands. Ranges are bucketed by allocated buffer so
+// ranges of unrelated allocations are not visited. All ranges of the same
+// allocation are still scanned linearly.
+static iree_status_t iree_hal_task_command_buffer_emit_execution_task(
+    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* task,
+    iree_host_size_t access_count, const iree_hal_task_access_t* accesses) {
+  iree_hal_task_node_t* node = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
+                                           sizeof(*node), (void**)&node));
+  memset(node, 0, sizeof(*node));
+  node->prev = command_buffer->state.last_node;
+  node->task = task;
+  command_buffer->state.last_node = node;
+
+  const uint32_t epoch = command_buffer->state.epoch;
+  for (iree_host_size_t i = 0; i < access_count; ++i) {
+    const iree_hal_task_access_t* access = &accesses[i];
+    if (access->length == 0) continue;
+
+    // Depend on the committed accesses of every overlapping range: writes
+    // hazard with all of them and reads only with the writes. Ranges fully
+    // overwritten by this access also track it as a writer so that later
+    // accesses to them do not need to look further back.
+    iree_hal_task_range_t** bucket =
+        iree_hal_task_range_bucket(command_buffer, access->allocated_buffer);
+    iree_hal_task_range_t* exact_range = NULL;
+    for (iree_hal_task_range_t* range = *bucket; range; range = range->next) {
+      if (!iree_hal_task_access_overlaps(access, range)) continue;
+      iree_hal_task_range_commit(range, epoch);
+      IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_add_edges(
+          command_buffer, range->writers, node));
+      if (access->is_write) {
+        IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_add_edges(
+            command_buffer, range->readers, node));
+      }
+      if (range->offset == access->offset &&
+          range->length == access->length) {
+        exact_range = range;
+      } else if (access->is_write &&
+                 iree_hal_task_access_covers(access, range)) {
+        IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_push_node_ref(
+            command_buffer, node, &range->pending_writers));
+      }
+    }
+
+    if (!exact_range) {
+      IREE_RETURN_IF_ERROR(iree_arena_allocate(
+          &command_buffer->arena, sizeof(*exact_range), (void**)&exact_range));
+      memset(exact_range, 0, sizeof(*exact_range));
+      exact_range->allocated_buffer = access->allocated_buffer;
+      exact_range->offset = access->offset;
+      exact_range->length = access->length;
+      exact_range->epoch = epoch;
+      exact_range->next = *bucket;
+      *bucket = exact_range;
+    }
+    IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_push_node_ref(
+        command_buffer, node,
+        access->is_write ? &exact_range->pending_writers
+                         : &exact_range->pending_readers));
   }
 
-  // Reset the tail of the command buffer to the barrier. This leaves us in a
-  // consistent state if the recording ends immediate after this (the barrier
-  // will be the last task).
-  iree_task_list_initialize(&command_buffer->leaf_tasks);
-  iree_task_list_push_back(&command_buffer->leaf_tasks, &barrier->header);
+  return iree_ok_status();
+}
 
-  // NOTE: all new tasks emitted will be executed after this barrier.
-  command_buffer->state.open_barrier = barrier;
-  command_buffer->state.open_task_count = 0;
+// Resolves the edges between all recorded nodes into task dependencies.
+// Nodes with a single successor use it as their completion task and those with
+// multiple successors fan out through a barrier. Nodes without predecessors
+// become the root tasks and those without successors the leaf tasks that the
+// retire task is chained on to when issued.
+static iree_status_t iree_hal_task_command_buffer_resolve_dag(
+    iree_hal_task_command_buffer_t* command_buffer) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_host_size_t leaf_task_count = 0;
+  for (iree_hal_task_node_t* node = command_buffer->state.last_node;
+       node != NULL; node = node->prev) {
+    if (node->successor_count == 0) ++leaf_task_count;
+  }
+  iree_task_t** leaf_tasks = NULL;
+  if (leaf_task_count > 0) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_arena_allocate(&command_buffer->arena,
+                                leaf_task_count * sizeof(*leaf_tasks),
+                                (void**)&leaf_tasks));
+  }
 
+  // Walk in reverse recording order and push tasks to the front of the lists
+  // so that they end up in recording order.
+  iree_host_size_t leaf_index = leaf_task_count;
+  for (iree_hal_task_node_t* node = command_buffer->state.last_node;
+       node != NULL; node = node->prev) {
+    if (node->successor_count == 0) {
+      leaf_tasks[--leaf_index] = node->task;
+    } else if (node->successor_count == 1) {
+      iree_task_set_completion_task(node->task, node->successors->target->task);
+    } else {
+      // Allocate the barrier and its dependent task list together.
+      iree_task_barrier_t* barrier = NULL;
+      IREE_RETURN_AND_END_ZONE_IF_ERROR(
+          z0, iree_arena_allocate(&command_buffer->arena,
+                                  sizeof(*barrier) + node->successor_count *
+                                                         sizeof(iree_task_t*),
+                                  (void**)&barrier));
+      iree_task_t** dependent_tasks =
+          (iree_task_t**)((uint8_t*)barrier + sizeof(*barrier));
+      iree_host_size_t dependent_index = 0;
+      for (iree_hal_task_edge_t* edge = node->successors; edge != NULL;
+           edge = edge->next) {
+        dependent_tasks[dependent_index++] = edge->target->task;
+      }
+      iree_task_barrier_initialize(command_buffer->scope, node->successor_count,
+                                   dependent_tasks, barrier);
+      iree_task_set_completion_task(node->task, &barrier->header);
+    }
+    if (node->predecessor_count == 0) {
+      iree_task_list_push_front(&command_buffer->root_tasks, node->task);
+    }
+  }
+  command_buffer->leaf_task_count = leaf_task_count;
+  command_buffer->leaf_tasks = leaf_tasks;
+
+  IREE_TRACE_ZONE_END(z0);
   return iree_ok_status();
 }
 
-// Emits a the given execution |task| into the current open synchronization
-// scope (after state.open_barrier and before the next barrier).
-static iree_status_t iree_hal_task_command_buffer_emit_execution_task(
-    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* task) {
-  if (command_buffer->state.open_barrier == NULL) {
-    // If there is no open barrier then we are at the head and going right into
-    // the task DAG.
-    iree_task_list_push_back(&command_buffer->leaf_tasks, task);
-  } else {
-    // Append to the open task list that will be flushed to the open barrier.
-    iree_task_list_push_back(&command_buffer->state.open_tasks, task);
-    ++command_buffer->state.open_task_count;
+// Captures the initial state of all tasks in the resolved DAG such that it can
+// be restored each time a reusable command buffer is issued. The root tasks are
+// moved out of the root task list into an array as the list links are
+// clobbered when the tasks are enqueued.
+static iree_status_t iree_hal_task_command_buffer_capture_reset_state(
+    iree_hal_task_command_buffer_t* command_buffer) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Each node has its task and those fanning out have an additional barrier.
+  iree_host_size_t reset_entry_count = 0;
+  for (iree_hal_task_node_t* node = command_buffer->state.last_node;
+       node != NULL; node = node->prev) {
+    reset_entry_count += node->successor_count > 1 ? 2 : 1;
+  }
+  iree_host_size_t root_task_count = 0;
+  for (iree_task_t* task = iree_task_list_front(&command_buffer->root_tasks);
+       task != NULL; task = task->next_task) {
+    ++root_task_count;
   }
+  iree_hal_task_reset_entry_t* reset_entries = NULL;
+  iree_task_t** root_task_array = NULL;
+  if (reset_entry_count > 0) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_arena_allocate(
+                &command_buffer->arena,
+                reset_entry_count * sizeof(*reset_entries) +
+                    root_task_count * sizeof(*root_task_array),
+                (void**)&reset_entries));
+    root_task_array = (iree_task_t**)(reset_entries + reset_entry_count);
+  }
+
+  iree_host_size_t reset_entry_index = 0;
+  for (iree_hal_task_node_t* node = command_buffer->state.last_node;
+       node != NULL; node = node->prev) {
+    iree_task_t* task = node->task;
+    for (int i = 0; i < (node->successor_count > 1 ? 2 : 1); ++i) {
+      iree_hal_task_reset_entry_t* entry = &reset_entries[reset_entry_index++];
+      entry->task = task;
+      entry->completion_task = task->completion_task;
+      entry->pending_dependency_count = iree_atomic_load_int32(
+          &task->pending_dependency_count, iree_memory_order_relaxed);
+      entry->flags = task->flags;
+      task = task->completion_task;  // fan-out barrier, if any
+    }
+  }
+
+  iree_host_size_t root_task_index = 0;
+  while (!iree_task_list_is_empty(&command_buffer->root_tasks)) {
+    root_task_array[root_task_index++] =
+        iree_task_list_pop_front(&command_buffer->root_tasks);
+  }
+
+  command_buffer->root_task_count = root_task_count;
+  command_buffer->root_task_array = root_task_array;
+  command_buffer->reset_entry_count = reset_entry_count;
+  command_buffer->reset_entries = reset_entries;
+
+  IREE_TRACE_ZONE_END(z0);
   return iree_ok_status();
 }
 
@@ -351,6 +641,109 @@ static iree_status_t iree_hal_task_command_buffer_emit_execution_task(
 // iree_hal_task_command_buffer_t execution
 //===----------------------------------------------------------------------===//
 
+// Restores all tasks in a reusable command buffer to the state they were in
+// when recording ended. Must only be called when no prior execution is in
+// flight.
+static void iree_hal_task_command_buffer_reset_tasks(
+    iree_hal_task_command_buffer_t* command_buffer) {
+  for (iree_host_size_t i = 0; i < command_buffer->reset_entry_count; ++i) {
+    const iree_hal_task_reset_entry_t* entry =
+        &command_buffer->reset_entries[i];
+    iree_task_t* task = entry->task;
+    task->next_task = NULL;
+    task->completion_task = entry->completion_task;
+    task->flags = entry->flags;
+    iree_atomic_store_int32(&task->pending_dependency_count,
+                            entry->pending_dependency_count,
+                            iree_memory_order_relaxed);
+    switch (task->type) {
+      case IREE_TASK_TYPE_CALL: {
+        iree_task_call_t* call_task = (iree_task_call_t*)task;
+        iree_atomic_store_intptr(&call_task->status, 0,
+                                 iree_memory_order_relaxed);
+        break;
+      }
+      case IREE_TASK_TYPE_DISPATCH: {
+        iree_task_dispatch_t* dispatch_task = (iree_task_dispatch_t*)task;
+        iree_atomic_store_intptr(&dispatch_task->status, 0,
+                                 iree_memory_order_relaxed);
+        memset(&dispatch_task->statistics, 0,
+               sizeof(dispatch_task->statistics));
+        break;
+      }
+      default:
+        break;
+    }
+  }
+}
+
+// Task chained after the leaves of a reusable command buffer for each
+// execution. Keeps the command buffer (and the tasks in its arena) live until
+// all commands have retired and then allows it to be issued again.
+typedef struct iree_hal_task_command_buffer_fence_t {
+  iree_task_nop_t task;
+  iree_hal_task_command_buffer_t* command_buffer;
+} iree_hal_task_command_buffer_fence_t;
+
+static void iree_hal_task_command_buffer_fence_cleanup(
+    iree_task_t* task, iree_status_code_t status_code) {
+  iree_hal_task_command_buffer_fence_t* fence =
+      (iree_hal_task_command_buffer_fence_t*)task;
+  iree_hal_task_command_buffer_t* command_buffer = fence->command_buffer;
+  iree_atomic_store_int32(&command_buffer->is_executing, 0,
+                          iree_memory_order_release);
+  iree_hal_command_buffer_release(&command_buffer->base);
+}
+
+// Issues a reusable command buffer by restoring its tasks and enqueuing them.
+// The DAG is chained through a per-execution fence allocated from |arena| on to
+// |retire_task|.
+static iree_status_t iree_hal_task_command_buffer_issue_reusable(
+    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* retire_task,
+    iree_arena_allocator_t* arena, iree_task_submission_t* pending_submission) {
+  // If the command buffer is empty (valid!) then we are a no-op.
+  if (command_buffer->root_task_count == 0) {
+    return iree_ok_status();
+  }
+
+  // The tasks are reset in-place and we can't have a prior execution still
+  // using them.
+  if (iree_atomic_exchange_int32(&command_buffer->is_executing, 1,
+                                 iree_memory_order_acq_rel) != 0) {
+    return iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "reusable command buffer issued while a prior execution is still in "
+        "flight; executions of the same command buffer must not overlap");
+  }
+
+  iree_hal_task_command_buffer_fence_t* fence = NULL;
+  iree_status_t status =
+      iree_arena_allocate(arena, sizeof(*fence), (void**)&fence);
+  if (!iree_status_is_ok(status)) {
+    iree_atomic_store_int32(&command_buffer->is_executing, 0,
+                            iree_memory_order_release);
+    return status;
+  }
+  iree_task_nop_initialize(command_buffer->scope, &fence->task);
+  iree_task_set_cleanup_fn(&fence->task.header,
+                           iree_hal_task_command_buffer_fence_cleanup);
+  iree_task_set_completion_task(&fence->task.header, retire_task);
+  fence->command_buffer = command_buffer;
+  iree_hal_command_buffer_retain(&command_buffer->base);
+
+  iree_hal_task_command_buffer_reset_tasks(command_buffer);
+  for (iree_host_size_t i = 0; i < command_buffer->leaf_task_count; ++i) {
+    iree_task_set_completion_task(command_buffer->leaf_tasks[i],
+                                  &fence->task.header);
+  }
+  for (iree_host_size_t i = 0; i < command_buffer->root_task_count; ++i) {
+    iree_task_submission_enqueue(pending_submission,
+                                 command_buffer->root_task_array[i]);
+  }
+
+  return iree_ok_status();
+}
+
 iree_status_t iree_hal_task_command_buffer_issue(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_task_queue_state_t* queue_state, iree_task_t* retire_task,
@@ -360,27 +753,22 @@ iree_status_t iree_hal_task_command_buffer_issue(
                                        &iree_hal_task_command_buffer_vtable);
   IREE_ASSERT_TRUE(command_buffer);
 
+  if (!iree_all_bits_set(command_buffer->base.mode,
+                         IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT)) {
+    return iree_hal_task_command_buffer_issue_reusable(
+        command_buffer, retire_task, arena, pending_submission);
+  }
+
   // If the command buffer is empty (valid!) then we are a no-op.
   bool has_root_tasks = !iree_task_list_is_empty(&command_buffer->root_tasks);
   if (!has_root_tasks) {
     return iree_ok_status();
   }
 
-  bool has_leaf_tasks = !iree_task_list_is_empty(&command_buffer->leaf_tasks);
-  if (has_leaf_tasks) {
-    // Chain the retire task onto the leaf tasks as their completion indicates
-    // that all commands have completed.
-    for (iree_task_t* task = command_buffer->leaf_tasks.head; task != NULL;
-         task = task->next_task) {
-      iree_task_set_completion_task(task, retire_task);
-    }
-  } else {
-    // If we have no leaf tasks it means that this is a single layer DAG and
-    // after the root tasks complete the entire command buffer has completed.
-    for (iree_task_t* task = command_buffer->root_tasks.head; task != NULL;
-         task = task->next_task) {
-      iree_task_set_completion_task(task, retire_task);
-    }
+  // Chain the retire task onto the leaf tasks as their completion indicates
+  // that all commands have completed. Every DAG has at least one leaf.
+  for (iree_host_size_t i = 0; i < command_buffer->leaf_task_count; ++i) {
+    iree_task_set_completion_task(command_buffer->leaf_tasks[i], retire_task);
   }
 
   // Enqueue all root tasks that are ready to run immediately.
@@ -388,7 +776,8 @@ iree_status_t iree_hal_task_command_buffer_issue(
   // we need to ensure the command buffer doesn't try to discard them.
   iree_task_submission_enqueue_list(pending_submission,
                                     &command_buffer->root_tasks);
-  iree_task_list_initialize(&command_buffer->leaf_tasks);
+  command_buffer->leaf_task_count = 0;
+  command_buffer->leaf_tasks = NULL;
 
   return iree_ok_status();
 }
@@ -425,9 +814,11 @@ static iree_status_t iree_hal_task_command_buffer_execution_barrier(
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
 
-  // TODO(benvanik): actual DAG construction. Right now we are just doing simple
-  // global barriers each time and forcing a join-fork point.
-  return iree_hal_task_command_buffer_emit_global_barrier(command_buffer);
+  // Commands recorded after the barrier will depend on any command recorded
+  // before it that they have a memory hazard with. The memory and buffer
+  // barriers are ignored as hazards are derived from the commands themselves.
+  ++command_buffer->state.epoch;
+  return iree_ok_status();
 }
 
 //===----------------------------------------------------------------------===//
@@ -437,7 +828,8 @@ static iree_status_t iree_hal_task_command_buffer_execution_barrier(
 static iree_status_t iree_hal_task_command_buffer_signal_event(
     iree_hal_command_buffer_t* base_command_buffer, iree_hal_event_t* event,
     iree_hal_execution_stage_t source_stage_mask) {
-  // TODO(#4518): implement events. For now we just insert global barriers.
+  // Events are only ever waited on within the same command buffer and we
+  // order the commands around the wait instead (see wait_events).
   return iree_ok_status();
 }
 
@@ -448,7 +840,8 @@ static iree_status_t iree_hal_task_command_buffer_signal_event(
 static iree_status_t iree_hal_task_command_buffer_reset_event(
     iree_hal_command_buffer_t* base_command_buffer, iree_hal_event_t* event,
     iree_hal_execution_stage_t source_stage_mask) {
-  // TODO(#4518): implement events. For now we just insert global barriers.
+  // Events are only ever waited on within the same command buffer and we
+  // order the commands around the wait instead (see wait_events).
   return iree_ok_status();
 }
 
@@ -467,8 +860,12 @@ static iree_status_t iree_hal_task_command_buffer_wait_events(
     const iree_hal_buffer_barrier_t* buffer_barriers) {
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
-  // TODO(#4518): implement events. For now we just insert global barriers.
-  return iree_hal_task_command_buffer_emit_global_barrier(command_buffer);
+  // Waits are treated as barriers: commands recorded after the wait depend
+  // on the commands recorded before it (and thus before any signal of the
+  // events) that they have a memory hazard with. This is conservative for
+  // commands recorded between the signal and the wait.
+  ++command_buffer->state.epoch;
+  return iree_ok_status();
 }
 
 //===----------------------------------------------------------------------===//
@@ -559,8 +956,10 @@ static iree_status_t iree_hal_task_command_buffer_fill_buffer(
   memcpy(cmd->pattern, pattern, pattern_length);
   cmd->pattern_length = pattern_length;
 
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  iree_hal_task_access_t access = iree_hal_task_make_access(
+      target_buffer, target_offset, length, /*is_write=*/true);
+  return iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, 1, &access);
 }
 
 //===----------------------------------------------------------------------===//
@@ -615,8 +1014,10 @@ static iree_status_t iree_hal_task_command_buffer_update_buffer(
   memcpy(cmd->source_buffer, (const uint8_t*)source_buffer + source_offset,
          cmd->length);
 
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  iree_hal_task_access_t access = iree_hal_task_make_access(
+      target_buffer, target_offset, length, /*is_write=*/true);
+  return iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, 1, &access);
 }
 
 //===----------------------------------------------------------------------===//
@@ -699,8 +1100,14 @@ static iree_status_t iree_hal_task_command_buffer_copy_buffer(
   cmd->target_offset = target_offset;
   cmd->length = length;
 
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  iree_hal_task_access_t accesses[2] = {
+      iree_hal_task_make_access(source_buffer, source_offset, length,
+                                /*is_write=*/false),
+      iree_hal_task_make_access(target_buffer, target_offset, length,
+                                /*is_write=*/true),
+  };
+  return iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, IREE_ARRAYSIZE(accesses), accesses);
 }
 
 //===----------------------------------------------------------------------===//
@@ -770,6 +1177,18 @@ static iree_status_t iree_hal_task_command_buffer_push_descriptor_set(
         buffer_mapping.contents.data;
     command_buffer->state.binding_lengths[binding_ordinal] =
         buffer_mapping.contents.data_length;
+
+    // Bindings don't carry access information and so any buffer that allows
+    // writes must be assumed to be written by the dispatches using it.
+    // Read-only buffers (such as constants) can be shared between dispatches
+    // without ordering them.
+    bool is_write =
+        iree_all_bits_set(iree_hal_buffer_allowed_access(bindings[i].buffer),
+                          IREE_HAL_MEMORY_ACCESS_WRITE);
+    command_buffer->state.binding_accesses[binding_ordinal] =
+        iree_hal_task_make_access(bindings[i].buffer, bindings[i].offset,
+                                  buffer_mapping.contents.data_length,
+                                  is_write);
   }
 
   return iree_ok_status();
@@ -866,6 +1285,7 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_executable_t* executable, int32_t entry_point,
     uint32_t workgroup_x, uint32_t workgroup_y, uint32_t workgroup_z,
+    const iree_hal_task_access_t* workgroups_access,
     iree_hal_cmd_dispatch_t** out_cmd) {
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
@@ -935,6 +1355,10 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
   cmd_ptr += used_binding_count * sizeof(*binding_ptrs);
   size_t* binding_lengths = (size_t*)cmd_ptr;
   cmd_ptr += used_binding_count * sizeof(*binding_lengths);
+  iree_host_size_t access_count = 0;
+  iree_hal_task_access_t* accesses = (iree_hal_task_access_t*)iree_alloca(
+      (used_binding_count + 1) * sizeof(*accesses));
+  if (workgroups_access) accesses[access_count++] = *workgroups_access;
   iree_host_size_t binding_base = 0;
   for (iree_host_size_t i = 0; i < used_binding_count; ++i) {
     int mask_offset = iree_math_count_trailing_zeros_u64(used_binding_mask);
@@ -947,11 +1371,13 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
       return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
                               "(flat) binding %d is NULL", binding_ordinal);
     }
+    accesses[access_count++] =
+        command_buffer->state.binding_accesses[binding_ordinal];
   }
 
   *out_cmd = cmd;
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  return iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, access_count, accesses);
 }
 
 static iree_status_t iree_hal_task_command_buffer_dispatch(
@@ -965,7 +1391,7 @@ static iree_status_t iree_hal_task_command_buffer_dispatch(
   iree_hal_cmd_dispatch_t* cmd = NULL;
   return iree_hal_task_command_buffer_build_dispatch(
       base_command_buffer, executable, entry_point, workgroup_x, workgroup_y,
-      workgroup_z, &cmd);
+      workgroup_z, /*workgroups_access=*/NULL, &cmd);
 }
 
 static iree_status_t iree_hal_task_command_buffer_dispatch_indirect(
@@ -987,9 +1413,16 @@ static iree_status_t iree_hal_task_command_buffer_dispatch_indirect(
       IREE_HAL_MEMORY_ACCESS_READ, workgroups_offset, 3 * sizeof(uint32_t),
       &buffer_mapping));
 
+  // The workgroup count is read when the dispatch is issued and must be
+  // ordered after any command producing it.
+  iree_hal_task_access_t workgroups_access =
+      iree_hal_task_make_access(workgroups_buffer, workgroups_offset,
+                                3 * sizeof(uint32_t), /*is_write=*/false);
+
   iree_hal_cmd_dispatch_t* cmd = NULL;
   IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_build_dispatch(
-      base_command_buffer, executable, entry_point, 0, 0, 0, &cmd));
+      base_command_buffer, executable, entry_point, 0, 0, 0,
+      &workgroups_access, &cmd));
   cmd->task.workgroup_count.ptr = (const uint32_t*)buffer_mapping.contents.data;
   cmd->task.header.flags |= IREE_TASK_FLAG_DISPATCH_INDIRECT;
   return iree_ok_status();
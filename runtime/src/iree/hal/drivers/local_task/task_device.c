@@ -21,6 +21,7 @@
 #include "iree/hal/local/local_executable_cache.h"
 #include "iree/hal/local/local_executable_layout.h"
 #include "iree/hal/utils/buffer_transfer.h"
+#include "iree/hal/utils/caching_allocator.h"
 
 typedef struct iree_hal_task_device_t {
   iree_hal_resource_t resource;
@@ -57,6 +58,7 @@ void iree_hal_task_device_params_initialize(
     iree_hal_task_device_params_t* out_params) {
   out_params->arena_block_size = 32 * 1024;
   out_params->queue_count = 8;
+  out_params->queue_pool_max_cached_bytes = 16 * 1024 * 1024;
 }
 
 static iree_status_t iree_hal_task_device_check_params(
@@ -123,12 +125,22 @@ iree_status_t iree_hal_task_device_create(
       iree_hal_executable_loader_retain(device->loaders[i]);
     }
 
-    device->queue_count = params->queue_count;
-    for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+    // Each queue has its own pool for queue-ordered allocations so that
+    // storage is only recycled in the order of the queue that released it.
+    iree_hal_caching_allocator_options_t pool_options;
+    iree_hal_caching_allocator_options_initialize(&pool_options);
+    pool_options.max_cached_bytes = params->queue_pool_max_cached_bytes;
+    for (iree_host_size_t i = 0; i < params->queue_count; ++i) {
+      iree_hal_allocator_t* pool = NULL;
+      status = iree_hal_caching_allocator_create(
+          device->device_allocator, &pool_options, host_allocator, &pool);
+      if (!iree_status_is_ok(status)) break;
       // TODO(benvanik): add a number to each queue ID.
       iree_hal_task_queue_initialize(device->identifier, device->executor,
-                                     &device->small_block_pool,
+                                     &device->small_block_pool, pool,
                                      &device->queues[i]);
+      iree_hal_allocator_release(pool);
+      ++device->queue_count;
     }
   }
 
@@ -184,6 +196,9 @@ static iree_status_t iree_hal_task_device_trim(iree_hal_device_t* base_device) {
   iree_arena_block_pool_trim(&device->small_block_pool);
   iree_arena_block_pool_trim(&device->large_block_pool);
   iree_task_executor_trim(device->executor);
+  for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+    IREE_RETURN_IF_ERROR(iree_hal_allocator_trim(device->queues[i].pool));
+  }
   return iree_hal_allocator_trim(device->device_allocator);
 }
 
@@ -299,9 +314,8 @@ static iree_status_t iree_hal_task_device_create_semaphore(
     iree_hal_device_t* base_device, uint64_t initial_value,
     iree_hal_semaphore_t** out_semaphore) {
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
-  return iree_hal_task_semaphore_create(
-      iree_task_executor_event_pool(device->executor), initial_value,
-      device->host_allocator, out_semaphore);
+  return iree_hal_task_semaphore_create(device->executor, initial_value,
+                                        device->host_allocator, out_semaphore);
 }
 
 static iree_hal_semaphore_compatibility_t
@@ -331,6 +345,34 @@ static iree_status_t iree_hal_task_device_queue_submit(
                                     batches);
 }
 
+static iree_status_t iree_hal_task_device_queue_alloca(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_params_t params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  iree_host_size_t queue_index = iree_hal_task_device_select_queue(
+      device, IREE_HAL_COMMAND_CATEGORY_ANY, queue_affinity);
+  return iree_hal_task_queue_alloca(&device->queues[queue_index],
+                                    &wait_semaphore_list,
+                                    &signal_semaphore_list, params,
+                                    allocation_size, out_buffer);
+}
+
+static iree_status_t iree_hal_task_device_queue_dealloca(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_t* buffer) {
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  iree_host_size_t queue_index = iree_hal_task_device_select_queue(
+      device, IREE_HAL_COMMAND_CATEGORY_ANY, queue_affinity);
+  return iree_hal_task_queue_dealloca(&device->queues[queue_index],
+                                      &wait_semaphore_list,
+                                      &signal_semaphore_list, buffer);
+}
+
 static iree_status_t iree_hal_task_device_submit_and_wait(
     iree_hal_device_t* base_device,
     iree_hal_command_category_t command_categories,
@@ -338,22 +380,40 @@ static iree_status_t iree_hal_task_device_submit_and_wait(
     const iree_hal_submission_batch_t* batches,
     iree_hal_semaphore_t* wait_semaphore, uint64_t wait_value,
     iree_timeout_t timeout) {
-  // Submit...
-  IREE_RETURN_IF_ERROR(iree_hal_task_device_queue_submit(
-      base_device, command_categories, queue_affinity, batch_count, batches));
-
-  // ...and wait.
-  return iree_hal_semaphore_wait(wait_semaphore, wait_value, timeout);
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  iree_host_size_t queue_index = iree_hal_task_device_select_queue(
+      device, command_categories, queue_affinity);
+  return iree_hal_task_queue_submit_and_wait(&device->queues[queue_index],
+                                             batch_count, batches,
+                                             wait_semaphore, wait_value,
+                                             timeout);
 }
 
 static iree_status_t iree_hal_task_device_wait_semaphores(
     iree_hal_device_t* base_device, iree_hal_wait_mode_t wait_mode,
     const iree_hal_semaphore_list_t* semaphore_list, iree_timeout_t timeout) {
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
-  return iree_hal_task_semaphore_multi_wait(
-      wait_mode, semaphore_list, timeout,
-      iree_task_executor_event_pool(device->executor),
-      &device->large_block_pool);
+
+  // When waiting for all semaphores we can donate the calling thread to the
+  // executor for each in turn. This is required for threadless executors to
+  // make progress and avoids wakes otherwise.
+  if (semaphore_list->count == 1 || wait_mode == IREE_HAL_WAIT_MODE_ALL) {
+    iree_convert_timeout_to_absolute(&timeout);
+    for (iree_host_size_t i = 0; i < semaphore_list->count; ++i) {
+      IREE_RETURN_IF_ERROR(iree_task_executor_donate_caller(
+          device->executor,
+          iree_hal_semaphore_await(semaphore_list->semaphores[i],
+                                   semaphore_list->payload_values[i]),
+          timeout));
+    }
+    return iree_ok_status();
+  }
+
+  // Waiting for any semaphore; threadless executors will have the caller
+  // donated while polling the semaphores.
+  return iree_hal_task_semaphore_multi_wait(device->executor, wait_mode,
+                                            semaphore_list, timeout,
+                                            &device->large_block_pool);
 }
 
 static iree_status_t iree_hal_task_device_wait_idle(
@@ -387,6 +447,8 @@ static const iree_hal_device_vtable_t iree_hal_task_device_vtable = {
     .query_semaphore_compatibility =
         iree_hal_task_device_query_semaphore_compatibility,
     .transfer_range = iree_hal_device_transfer_mappable_range,
+    .queue_alloca = iree_hal_task_device_queue_alloca,
+    .queue_dealloca = iree_hal_task_device_queue_dealloca,
     .queue_submit = iree_hal_task_device_queue_submit,
     .submit_and_wait = iree_hal_task_device_submit_and_wait,
     .wait_semaphores = iree_hal_task_device_wait_semaphores,
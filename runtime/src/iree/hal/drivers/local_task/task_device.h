@@ -28,6 +28,11 @@ typedef struct iree_hal_task_device_params_t {
   // Larger sizes will lower overhead and ensure the heap isn't hit for
   // transient allocations while also increasing memory consumption.
   iree_host_size_t arena_block_size;
+
+  // Maximum number of bytes of released queue-ordered allocations each queue
+  // keeps cached for reuse by later allocations. Storage beyond this is
+  // returned to the device allocator. 0 disables caching.
+  iree_device_size_t queue_pool_max_cached_bytes;
 } iree_hal_task_device_params_t;
 
 // Initializes |out_params| to default values.
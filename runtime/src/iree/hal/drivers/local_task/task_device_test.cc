@@ -0,0 +1,255 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/local_task/task_device.h"
+
+#include <cstring>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/modules/hal/module.h"
+#include "iree/task/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+// Bounds waits so that a missing donation fails the test instead of hanging.
+static const iree_duration_t kTestTimeoutNs = 10 * 1000000000ll;
+
+// Tests a local-task device using a threadless executor. Nothing runs unless
+// a thread is donated to the executor and every blocking wait must do so.
+class ThreadlessTaskDeviceTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_task_topology_t topology;
+    iree_task_topology_initialize_from_group_count(/*group_count=*/0,
+                                                   &topology);
+    IREE_ASSERT_OK(iree_task_executor_create(
+        IREE_TASK_SCHEDULING_MODE_RESERVED, &topology,
+        /*worker_local_memory_size=*/0, iree_allocator_system(), &executor_));
+    iree_task_topology_deinitialize(&topology);
+    ASSERT_TRUE(iree_task_executor_is_threadless(executor_));
+
+    iree_hal_allocator_t* device_allocator = NULL;
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("local"), iree_allocator_system(),
+        iree_allocator_system(), &device_allocator));
+    iree_hal_task_device_params_t params;
+    iree_hal_task_device_params_initialize(&params);
+    IREE_ASSERT_OK(iree_hal_task_device_create(
+        iree_make_cstring_view("threadless"), &params, executor_,
+        /*loader_count=*/0, /*loaders=*/NULL, device_allocator,
+        iree_allocator_system(), &device_));
+    iree_hal_allocator_release(device_allocator);
+  }
+
+  void TearDown() override {
+    iree_hal_device_release(device_);
+    iree_task_executor_release(executor_);
+  }
+
+  // Submits an empty batch that signals |semaphore| to |value|. The signal is
+  // performed by executor tasks and only happens when a thread is donated.
+  void SubmitSignal(iree_hal_semaphore_t* semaphore, uint64_t value) {
+    iree_hal_submission_batch_t batch;
+    memset(&batch, 0, sizeof(batch));
+    batch.signal_semaphores.count = 1;
+    batch.signal_semaphores.semaphores = &semaphore;
+    batch.signal_semaphores.payload_values = &value;
+    IREE_ASSERT_OK(iree_hal_device_queue_submit(
+        device_, IREE_HAL_COMMAND_CATEGORY_ANY, IREE_HAL_QUEUE_AFFINITY_ANY,
+        1, &batch));
+  }
+
+  iree_task_executor_t* executor_ = NULL;
+  iree_hal_device_t* device_ = NULL;
+};
+
+// Tests that waiting for any of multiple semaphores donates the caller.
+TEST_F(ThreadlessTaskDeviceTest, WaitAny) {
+  iree_hal_semaphore_t* semaphore_a = NULL;
+  iree_hal_semaphore_t* semaphore_b = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore_a));
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore_b));
+
+  SubmitSignal(semaphore_b, 1ull);
+
+  iree_hal_semaphore_t* semaphore_ptrs[] = {semaphore_a, semaphore_b};
+  uint64_t payload_values[] = {1ull, 1ull};
+  iree_hal_semaphore_list_t semaphore_list;
+  semaphore_list.count = IREE_ARRAYSIZE(semaphore_ptrs);
+  semaphore_list.semaphores = semaphore_ptrs;
+  semaphore_list.payload_values = payload_values;
+  IREE_ASSERT_OK(iree_hal_device_wait_semaphores(
+      device_, IREE_HAL_WAIT_MODE_ANY, &semaphore_list,
+      iree_make_timeout_ns(kTestTimeoutNs)));
+
+  uint64_t value_a = 0, value_b = 0;
+  IREE_ASSERT_OK(iree_hal_semaphore_query(semaphore_a, &value_a));
+  IREE_ASSERT_OK(iree_hal_semaphore_query(semaphore_b, &value_b));
+  EXPECT_EQ(0ull, value_a);
+  EXPECT_EQ(1ull, value_b);
+
+  // Unresolvable waits time out instead of hanging.
+  payload_values[1] = 2ull;
+  EXPECT_THAT(Status(iree_hal_device_wait_semaphores(
+                  device_, IREE_HAL_WAIT_MODE_ANY, &semaphore_list,
+                  iree_make_timeout_ms(10))),
+              StatusIs(StatusCode::kDeadlineExceeded));
+
+  iree_hal_semaphore_release(semaphore_a);
+  iree_hal_semaphore_release(semaphore_b);
+}
+
+// Tests that waiting for all of multiple semaphores donates the caller.
+TEST_F(ThreadlessTaskDeviceTest, WaitAll) {
+  iree_hal_semaphore_t* semaphore_a = NULL;
+  iree_hal_semaphore_t* semaphore_b = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore_a));
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore_b));
+
+  SubmitSignal(semaphore_a, 1ull);
+  SubmitSignal(semaphore_b, 1ull);
+
+  iree_hal_semaphore_t* semaphore_ptrs[] = {semaphore_a, semaphore_b};
+  uint64_t payload_values[] = {1ull, 1ull};
+  iree_hal_semaphore_list_t semaphore_list;
+  semaphore_list.count = IREE_ARRAYSIZE(semaphore_ptrs);
+  semaphore_list.semaphores = semaphore_ptrs;
+  semaphore_list.payload_values = payload_values;
+  IREE_ASSERT_OK(iree_hal_device_wait_semaphores(
+      device_, IREE_HAL_WAIT_MODE_ALL, &semaphore_list,
+      iree_make_timeout_ns(kTestTimeoutNs)));
+
+  iree_hal_semaphore_release(semaphore_a);
+  iree_hal_semaphore_release(semaphore_b);
+}
+
+// Tests that a synchronous (non-yielding) hal.semaphore.await in the HAL
+// module donates the invoking thread.
+TEST_F(ThreadlessTaskDeviceTest, HalModuleSynchronousAwait) {
+  IREE_ASSERT_OK(iree_hal_module_register_types());
+  iree_vm_instance_t* instance = NULL;
+  IREE_ASSERT_OK(iree_vm_instance_create(iree_allocator_system(), &instance));
+  iree_vm_module_t* hal_module = NULL;
+  IREE_ASSERT_OK(iree_hal_module_create(device_, IREE_HAL_MODULE_FLAG_NONE,
+                                        iree_allocator_system(), &hal_module));
+  iree_vm_context_t* context = NULL;
+  IREE_ASSERT_OK(iree_vm_context_create_with_modules(
+      instance, IREE_VM_CONTEXT_FLAG_NONE, 1, &hal_module,
+      iree_allocator_system(), &context));
+  iree_vm_function_t await_function;
+  IREE_ASSERT_OK(iree_vm_context_resolve_function(
+      context, iree_make_cstring_view("hal.semaphore.await"),
+      &await_function));
+
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore));
+  SubmitSignal(semaphore, 1ull);
+
+  iree_vm_list_t* inputs = NULL;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(NULL, 2, iree_allocator_system(), &inputs));
+  iree_vm_ref_t semaphore_ref = iree_hal_semaphore_retain_ref(semaphore);
+  IREE_ASSERT_OK(iree_vm_list_push_ref_move(inputs, &semaphore_ref));
+  iree_vm_value_t value = iree_vm_value_make_i64(1);
+  IREE_ASSERT_OK(iree_vm_list_push_value(inputs, &value));
+  iree_vm_list_t* outputs = NULL;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(NULL, 1, iree_allocator_system(), &outputs));
+
+  // Without donation this would never return as no thread runs the signal.
+  IREE_ASSERT_OK(iree_vm_invoke(context, await_function,
+                                IREE_VM_INVOCATION_FLAG_NONE,
+                                /*policy=*/NULL, inputs, outputs,
+                                iree_allocator_system()));
+  iree_vm_value_t result;
+  IREE_ASSERT_OK(iree_vm_list_get_value(outputs, 0, &result));
+  EXPECT_EQ(0, result.i32);
+
+  uint64_t current_value = 0;
+  IREE_ASSERT_OK(iree_hal_semaphore_query(semaphore, &current_value));
+  EXPECT_EQ(1ull, current_value);
+
+  iree_vm_list_release(inputs);
+  iree_vm_list_release(outputs);
+  iree_hal_semaphore_release(semaphore);
+  iree_vm_context_release(context);
+  iree_vm_module_release(hal_module);
+  iree_vm_instance_release(instance);
+}
+
+#if IREE_STATISTICS_ENABLE
+// Tests that an alloca waiting on a dealloca that has not yet retired reuses
+// its storage. Nothing retires until the final wait donates the caller so
+// without reuse each iteration would make a new allocation.
+TEST_F(ThreadlessTaskDeviceTest, PipelinedAllocaReusesDeallocaStorage) {
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore));
+
+  iree_hal_buffer_params_t params = {0};
+  params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+  params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+  const iree_device_size_t allocation_size = 64 * 1024;
+  uint64_t timepoint = 0ull;
+  for (int i = 0; i < 4; ++i) {
+    uint64_t alloca_wait_value = timepoint;
+    uint64_t alloca_signal_value = timepoint + 1;
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_ASSERT_OK(iree_hal_device_queue_alloca(
+        device_, IREE_HAL_QUEUE_AFFINITY_ANY,
+        iree_hal_semaphore_list_t{1, &semaphore, &alloca_wait_value},
+        iree_hal_semaphore_list_t{1, &semaphore, &alloca_signal_value},
+        params, allocation_size, &buffer));
+    uint64_t dealloca_signal_value = timepoint + 2;
+    IREE_ASSERT_OK(iree_hal_device_queue_dealloca(
+        device_, IREE_HAL_QUEUE_AFFINITY_ANY,
+        iree_hal_semaphore_list_t{1, &semaphore, &alloca_signal_value},
+        iree_hal_semaphore_list_t{1, &semaphore, &dealloca_signal_value},
+        buffer));
+    iree_hal_buffer_release(buffer);
+    timepoint += 2;
+  }
+
+  IREE_ASSERT_OK(iree_hal_device_wait_idle(
+      device_, iree_make_timeout_ns(kTestTimeoutNs)));
+  uint64_t current_value = 0;
+  IREE_ASSERT_OK(iree_hal_semaphore_query(semaphore, &current_value));
+  EXPECT_EQ(timepoint, current_value);
+
+  iree_hal_allocator_statistics_t statistics;
+  iree_hal_allocator_query_statistics(iree_hal_device_allocator(device_),
+                                      &statistics);
+  EXPECT_EQ(1u, statistics.allocation_count);
+  EXPECT_LE(allocation_size, statistics.device_bytes_peak);
+  EXPECT_GT(2 * allocation_size, statistics.device_bytes_peak);
+
+  iree_hal_semaphore_release(semaphore);
+}
+#endif  // IREE_STATISTICS_ENABLE
+
+// Tests that device idle waits donate the caller.
+TEST_F(ThreadlessTaskDeviceTest, WaitIdle) {
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore));
+  SubmitSignal(semaphore, 1ull);
+  IREE_ASSERT_OK(iree_hal_device_wait_idle(
+      device_, iree_make_timeout_ns(kTestTimeoutNs)));
+  uint64_t current_value = 0;
+  IREE_ASSERT_OK(iree_hal_semaphore_query(semaphore, &current_value));
+  EXPECT_EQ(1ull, current_value);
+  iree_hal_semaphore_release(semaphore);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -7,21 +7,28 @@
 #include "iree/hal/drivers/local_task/task_driver.h"
 
 #include <stddef.h>
+#include <stdio.h>
 #include <string.h>
 
 #include "iree/base/tracing.h"
 
+// Device IDs are the executor index; the default device uses executor 0.
 #define IREE_HAL_TASK_DEVICE_ID_DEFAULT 0
 
+// Maximum length of a device path or name string including NUL.
+#define IREE_HAL_TASK_DEVICE_MAX_NAME_LENGTH 32
+
 typedef struct iree_hal_task_driver_t {
   iree_hal_resource_t resource;
   iree_allocator_t host_allocator;
-  iree_hal_allocator_t* device_allocator;
 
   iree_string_view_t identifier;
   iree_hal_task_device_params_t default_params;
 
-  iree_task_executor_t* executor;
+  // One entry per device that can be created; device IDs index into these.
+  iree_host_size_t executor_count;
+  iree_task_executor_t** executors;
+  iree_hal_allocator_t** device_allocators;
 
   iree_host_size_t loader_count;
   iree_hal_executable_loader_t* loaders[];
@@ -38,13 +45,15 @@ static iree_hal_task_driver_t* iree_hal_task_driver_cast(
 iree_status_t iree_hal_task_driver_create(
     iree_string_view_t identifier,
     const iree_hal_task_device_params_t* default_params,
-    iree_task_executor_t* executor, iree_host_size_t loader_count,
-    iree_hal_executable_loader_t** loaders,
-    iree_hal_allocator_t* device_allocator, iree_allocator_t host_allocator,
+    iree_host_size_t executor_count, iree_task_executor_t** executors,
+    iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
+    iree_hal_allocator_t** device_allocators, iree_allocator_t host_allocator,
     iree_hal_driver_t** out_driver) {
   IREE_ASSERT_ARGUMENT(default_params);
+  IREE_ASSERT_ARGUMENT(executor_count > 0);
+  IREE_ASSERT_ARGUMENT(executors);
   IREE_ASSERT_ARGUMENT(!loader_count || loaders);
-  IREE_ASSERT_ARGUMENT(device_allocator);
+  IREE_ASSERT_ARGUMENT(device_allocators);
   IREE_ASSERT_ARGUMENT(out_driver);
   *out_driver = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -52,23 +61,36 @@ iree_status_t iree_hal_task_driver_create(
   iree_hal_task_driver_t* driver = NULL;
   iree_host_size_t struct_size =
       sizeof(*driver) + loader_count * sizeof(*driver->loaders);
-  iree_host_size_t total_size = struct_size + identifier.size;
+  iree_host_size_t executors_size =
+      executor_count * sizeof(*driver->executors);
+  iree_host_size_t device_allocators_size =
+      executor_count * sizeof(*driver->device_allocators);
+  iree_host_size_t total_size =
+      struct_size + executors_size + device_allocators_size + identifier.size;
   iree_status_t status =
       iree_allocator_malloc(host_allocator, total_size, (void**)&driver);
   if (iree_status_is_ok(status)) {
     iree_hal_resource_initialize(&iree_hal_task_driver_vtable,
                                  &driver->resource);
     driver->host_allocator = host_allocator;
-    driver->device_allocator = device_allocator;
-    iree_hal_allocator_retain(device_allocator);
 
+    uint8_t* buffer_ptr = (uint8_t*)driver + struct_size;
+    driver->executors = (iree_task_executor_t**)buffer_ptr;
+    buffer_ptr += executors_size;
+    driver->device_allocators = (iree_hal_allocator_t**)buffer_ptr;
+    buffer_ptr += device_allocators_size;
     iree_string_view_append_to_buffer(identifier, &driver->identifier,
-                                      (char*)driver + struct_size);
+                                      (char*)buffer_ptr);
     memcpy(&driver->default_params, default_params,
            sizeof(driver->default_params));
 
-    driver->executor = executor;
-    iree_task_executor_retain(driver->executor);
+    driver->executor_count = executor_count;
+    for (iree_host_size_t i = 0; i < driver->executor_count; ++i) {
+      driver->executors[i] = executors[i];
+      iree_task_executor_retain(driver->executors[i]);
+      driver->device_allocators[i] = device_allocators[i];
+      iree_hal_allocator_retain(driver->device_allocators[i]);
+    }
 
     driver->loader_count = loader_count;
     for (iree_host_size_t i = 0; i < driver->loader_count; ++i) {
@@ -91,11 +113,13 @@ static void iree_hal_task_driver_destroy(iree_hal_driver_t* base_driver) {
   iree_allocator_t host_allocator = driver->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  iree_hal_allocator_release(driver->device_allocator);
+  for (iree_host_size_t i = 0; i < driver->executor_count; ++i) {
+    iree_hal_allocator_release(driver->device_allocators[i]);
+    iree_task_executor_release(driver->executors[i]);
+  }
   for (iree_host_size_t i = 0; i < driver->loader_count; ++i) {
     iree_hal_executable_loader_release(driver->loaders[i]);
   }
-  iree_task_executor_release(driver->executor);
   iree_allocator_free(host_allocator, driver);
 
   IREE_TRACE_ZONE_END(z0);
@@ -105,17 +129,39 @@ static iree_status_t iree_hal_task_driver_query_available_devices(
     iree_hal_driver_t* base_driver, iree_allocator_t host_allocator,
     iree_host_size_t* out_device_info_count,
     iree_hal_device_info_t** out_device_infos) {
-  static const iree_hal_device_info_t device_infos[1] = {
-      {
-          .device_id = IREE_HAL_TASK_DEVICE_ID_DEFAULT,
-          .name = iree_string_view_literal("default"),
-      },
-  };
-  *out_device_info_count = IREE_ARRAYSIZE(device_infos);
-  return iree_allocator_clone(
-      host_allocator,
-      iree_make_const_byte_span(device_infos, sizeof(device_infos)),
-      (void**)out_device_infos);
+  iree_hal_task_driver_t* driver = iree_hal_task_driver_cast(base_driver);
+
+  // When there's a single executor we expose it as the default device as we
+  // always have. Multiple executors are exposed by index so that they can be
+  // selected with paths like `local-task://1`.
+  iree_host_size_t device_count = driver->executor_count;
+  iree_host_size_t total_size =
+      device_count * (sizeof(iree_hal_device_info_t) +
+                      2 * IREE_HAL_TASK_DEVICE_MAX_NAME_LENGTH);
+  iree_hal_device_info_t* device_infos = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(host_allocator, total_size, (void**)&device_infos));
+  char* buffer_ptr =
+      (char*)device_infos + device_count * sizeof(iree_hal_device_info_t);
+  for (iree_host_size_t i = 0; i < device_count; ++i) {
+    iree_hal_device_info_t* device_info = &device_infos[i];
+    device_info->device_id = (iree_hal_device_id_t)i;
+    int path_length = snprintf(buffer_ptr, IREE_HAL_TASK_DEVICE_MAX_NAME_LENGTH,
+                               "%" PRIhsz, i);
+    device_info->path = iree_make_string_view(buffer_ptr, path_length);
+    buffer_ptr += IREE_HAL_TASK_DEVICE_MAX_NAME_LENGTH;
+    int name_length =
+        device_count == 1
+            ? snprintf(buffer_ptr, IREE_HAL_TASK_DEVICE_MAX_NAME_LENGTH,
+                       "default")
+            : snprintf(buffer_ptr, IREE_HAL_TASK_DEVICE_MAX_NAME_LENGTH,
+                       "executor%" PRIhsz, i);
+    device_info->name = iree_make_string_view(buffer_ptr, name_length);
+    buffer_ptr += IREE_HAL_TASK_DEVICE_MAX_NAME_LENGTH;
+  }
+  *out_device_info_count = device_count;
+  *out_device_infos = device_infos;
+  return iree_ok_status();
 }
 
 static iree_status_t iree_hal_task_driver_dump_device_info(
@@ -134,9 +180,16 @@ static iree_status_t iree_hal_task_driver_create_device_by_id(
     iree_host_size_t param_count, const iree_string_pair_t* params,
     iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
   iree_hal_task_driver_t* driver = iree_hal_task_driver_cast(base_driver);
+  if (device_id >= driver->executor_count) {
+    return iree_make_status(IREE_STATUS_NOT_FOUND,
+                            "device %" PRIu64 " not found (of %" PRIhsz
+                            " enumerated)",
+                            (uint64_t)device_id, driver->executor_count);
+  }
+  iree_host_size_t index = (iree_host_size_t)device_id;
   return iree_hal_task_device_create(
-      driver->identifier, &driver->default_params, driver->executor,
-      driver->loader_count, driver->loaders, driver->device_allocator,
+      driver->identifier, &driver->default_params, driver->executors[index],
+      driver->loader_count, driver->loaders, driver->device_allocators[index],
       host_allocator, out_device);
 }
 
@@ -145,13 +198,19 @@ static iree_status_t iree_hal_task_driver_create_device_by_path(
     iree_string_view_t device_path, iree_host_size_t param_count,
     const iree_string_pair_t* params, iree_allocator_t host_allocator,
     iree_hal_device_t** out_device) {
+  // Paths are the executor index as returned by query_available_devices.
+  iree_hal_device_id_t device_id = IREE_HAL_DEVICE_ID_DEFAULT;
   if (!iree_string_view_is_empty(device_path)) {
-    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                            "device paths not yet implemented");
+    uint64_t device_index = 0;
+    if (!iree_string_view_atoi_uint64(device_path, &device_index)) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "device path '%.*s' is not a device index",
+                              (int)device_path.size, device_path.data);
+    }
+    device_id = (iree_hal_device_id_t)device_index;
   }
   return iree_hal_task_driver_create_device_by_id(
-      base_driver, IREE_HAL_DEVICE_ID_DEFAULT, param_count, params,
-      host_allocator, out_device);
+      base_driver, device_id, param_count, params, host_allocator, out_device);
 }
 
 static const iree_hal_driver_vtable_t iree_hal_task_driver_vtable = {
@@ -17,15 +17,21 @@
 extern "C" {
 #endif  // __cplusplus
 
-// Creates a new iree/task/-based local CPU driver that creates devices sharing
-// the same |executor| for scheduling tasks. |loaders| is the set of executable
-// loaders that are available for loading in each device context.
+// Creates a new iree/task/-based local CPU driver that creates devices using
+// |executors| for scheduling tasks. |loaders| is the set of executable loaders
+// that are available for loading in each device context.
+//
+// One device is exposed per executor and each device uses the corresponding
+// entry in |device_allocators|. This allows hosting applications to partition
+// the machine (such as by NUMA node) and have devices allocate memory local to
+// the executor they schedule work on. All devices created for the same index
+// share the same executor and allocator.
 iree_status_t iree_hal_task_driver_create(
     iree_string_view_t identifier,
     const iree_hal_task_device_params_t* default_params,
-    iree_task_executor_t* executor, iree_host_size_t loader_count,
-    iree_hal_executable_loader_t** loaders,
-    iree_hal_allocator_t* device_allocator, iree_allocator_t host_allocator,
+    iree_host_size_t executor_count, iree_task_executor_t** executors,
+    iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
+    iree_hal_allocator_t** device_allocators, iree_allocator_t host_allocator,
     iree_hal_driver_t** out_driver);
 
 #ifdef __cplusplus
@@ -0,0 +1,160 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/local_task/task_driver.h"
+
+#include <string>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/task/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+static std::string ToString(iree_string_view_t value) {
+  return std::string(value.data, value.size);
+}
+
+// Tests a local-task driver with one executor and allocator per device as
+// created when partitioning the machine by NUMA node.
+class TaskDriverTest : public ::testing::Test {
+ protected:
+  // Creates |driver_| with |executor_count| single-worker executors.
+  void CreateDriver(iree_host_size_t executor_count) {
+    ASSERT_LE(executor_count, IREE_ARRAYSIZE(executors_));
+    for (iree_host_size_t i = 0; i < executor_count; ++i) {
+      iree_task_topology_t topology;
+      iree_task_topology_initialize_from_group_count(/*group_count=*/1,
+                                                     &topology);
+      IREE_ASSERT_OK(iree_task_executor_create(
+          IREE_TASK_SCHEDULING_MODE_RESERVED, &topology,
+          /*worker_local_memory_size=*/0, iree_allocator_system(),
+          &executors_[i]));
+      iree_task_topology_deinitialize(&topology);
+      IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+          iree_make_cstring_view("local"), iree_allocator_system(),
+          iree_allocator_system(), &device_allocators_[i]));
+    }
+    executor_count_ = executor_count;
+
+    iree_hal_task_device_params_t params;
+    iree_hal_task_device_params_initialize(&params);
+    IREE_ASSERT_OK(iree_hal_task_driver_create(
+        iree_make_cstring_view("local-task"), &params, executor_count,
+        executors_, /*loader_count=*/0, /*loaders=*/NULL, device_allocators_,
+        iree_allocator_system(), &driver_));
+  }
+
+  void TearDown() override {
+    iree_hal_driver_release(driver_);
+    for (iree_host_size_t i = 0; i < executor_count_; ++i) {
+      iree_hal_allocator_release(device_allocators_[i]);
+      iree_task_executor_release(executors_[i]);
+    }
+  }
+
+  iree_host_size_t executor_count_ = 0;
+  iree_task_executor_t* executors_[3] = {NULL};
+  iree_hal_allocator_t* device_allocators_[3] = {NULL};
+  iree_hal_driver_t* driver_ = NULL;
+};
+
+// Tests that a single executor is exposed as the default device.
+TEST_F(TaskDriverTest, QueryAvailableDevicesSingle) {
+  CreateDriver(1);
+  iree_host_size_t device_info_count = 0;
+  iree_hal_device_info_t* device_infos = NULL;
+  IREE_ASSERT_OK(iree_hal_driver_query_available_devices(
+      driver_, iree_allocator_system(), &device_info_count, &device_infos));
+  ASSERT_EQ(device_info_count, 1);
+  EXPECT_EQ(device_infos[0].device_id, 0);
+  EXPECT_EQ(ToString(device_infos[0].path), "0");
+  EXPECT_EQ(ToString(device_infos[0].name), "default");
+  iree_allocator_free(iree_allocator_system(), device_infos);
+}
+
+// Tests that each executor is exposed as a device with its index as the path.
+TEST_F(TaskDriverTest, QueryAvailableDevicesMultiple) {
+  CreateDriver(3);
+  iree_host_size_t device_info_count = 0;
+  iree_hal_device_info_t* device_infos = NULL;
+  IREE_ASSERT_OK(iree_hal_driver_query_available_devices(
+      driver_, iree_allocator_system(), &device_info_count, &device_infos));
+  ASSERT_EQ(device_info_count, 3);
+  for (iree_host_size_t i = 0; i < device_info_count; ++i) {
+    EXPECT_EQ(device_infos[i].device_id, i);
+    EXPECT_EQ(ToString(device_infos[i].path), std::to_string(i));
+    EXPECT_EQ(ToString(device_infos[i].name), "executor" + std::to_string(i));
+  }
+  iree_allocator_free(iree_allocator_system(), device_infos);
+}
+
+// Tests that devices created by ID use the executor allocator at that index.
+TEST_F(TaskDriverTest, CreateDeviceById) {
+  CreateDriver(3);
+  for (iree_host_size_t i = 0; i < executor_count_; ++i) {
+    iree_hal_device_t* device = NULL;
+    IREE_ASSERT_OK(iree_hal_driver_create_device_by_id(
+        driver_, (iree_hal_device_id_t)i, /*param_count=*/0, /*params=*/NULL,
+        iree_allocator_system(), &device));
+    EXPECT_EQ(iree_hal_device_allocator(device), device_allocators_[i]);
+    iree_hal_device_release(device);
+  }
+
+  iree_hal_device_t* device = NULL;
+  EXPECT_THAT(Status(iree_hal_driver_create_device_by_id(
+                  driver_, /*device_id=*/3, /*param_count=*/0,
+                  /*params=*/NULL, iree_allocator_system(), &device)),
+              StatusIs(StatusCode::kNotFound));
+  EXPECT_EQ(device, nullptr);
+}
+
+// Tests that `local-task://N` URIs select the device at index N and that
+// omitting the path selects the first device.
+TEST_F(TaskDriverTest, CreateDeviceByUri) {
+  CreateDriver(3);
+  struct {
+    const char* uri;
+    iree_host_size_t index;
+  } kCases[] = {
+      {"local-task", 0},
+      {"local-task://", 0},
+      {"local-task://0", 0},
+      {"local-task://1", 1},
+      {"local-task://2", 2},
+  };
+  for (const auto& test_case : kCases) {
+    SCOPED_TRACE(test_case.uri);
+    iree_hal_device_t* device = NULL;
+    IREE_ASSERT_OK(iree_hal_driver_create_device_by_uri(
+        driver_, iree_make_cstring_view(test_case.uri), iree_allocator_system(),
+        &device));
+    EXPECT_EQ(iree_hal_device_allocator(device),
+              device_allocators_[test_case.index]);
+    iree_hal_device_release(device);
+  }
+
+  iree_hal_device_t* device = NULL;
+  EXPECT_THAT(Status(iree_hal_driver_create_device_by_uri(
+                  driver_, iree_make_cstring_view("local-task://3"),
+                  iree_allocator_system(), &device)),
+              StatusIs(StatusCode::kNotFound));
+  EXPECT_THAT(Status(iree_hal_driver_create_device_by_uri(
+                  driver_, iree_make_cstring_view("local-task://numa1"),
+                  iree_allocator_system(), &device)),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_EQ(device, nullptr);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
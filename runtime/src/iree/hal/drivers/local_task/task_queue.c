@@ -271,10 +271,13 @@ static iree_status_t iree_hal_task_queue_issue_cmd_allocate(
 // it. The task is issued only once all commands from all command buffers in
 // the submission complete. Semaphores will be signaled and dependent
 // submissions may be issued.
-typedef struct iree_hal_task_queue_retire_cmd_t {
+struct iree_hal_task_queue_retire_cmd_t {
   // Call to iree_hal_task_queue_retire_cmd.
   iree_task_call_t task;
 
+  // Queue the submission was made on.
+  iree_hal_task_queue_t* queue;
+
   // Original arena used for all transient allocations required for the
   // submission. All queue-related commands are allocated from this, **including
   // this retire command**.
@@ -282,7 +285,30 @@ typedef struct iree_hal_task_queue_retire_cmd_t {
 
   // A list of semaphores to signal upon retiring.
   iree_hal_semaphore_list_t signal_semaphores;
-} iree_hal_task_queue_retire_cmd_t;
+
+  // Optional buffer being deallocated by the submission. It is released prior
+  // to signaling so that its storage can be recycled by the queue pool before
+  // any work waiting on the dealloca begins. Until then the command is in the
+  // queue pending dealloca list.
+  iree_hal_buffer_t* dealloca_buffer;
+};
+
+// Removes |cmd| from the pending dealloca list of its queue, if present.
+// Must be called before the dealloca buffer is released so that allocas can no
+// longer take it.
+static void iree_hal_task_queue_retire_cmd_unregister_dealloca(
+    iree_hal_task_queue_retire_cmd_t* cmd) {
+  iree_hal_task_queue_t* queue = cmd->queue;
+  iree_slim_mutex_lock(&queue->mutex);
+  for (iree_host_size_t i = 0; i < queue->pending_dealloca_count; ++i) {
+    if (queue->pending_deallocas[i] == cmd) {
+      queue->pending_deallocas[i] =
+          queue->pending_deallocas[--queue->pending_dealloca_count];
+      break;
+    }
+  }
+  iree_slim_mutex_unlock(&queue->mutex);
+}
 
 // Retires a submission by signaling semaphores to their desired value and
 // disposing of the temporary arena memory used for the submission.
@@ -293,6 +319,13 @@ static iree_status_t iree_hal_task_queue_retire_cmd(
       (iree_hal_task_queue_retire_cmd_t*)task;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // Return deallocated storage to the pool (if this was the last reference).
+  if (cmd->dealloca_buffer) {
+    iree_hal_task_queue_retire_cmd_unregister_dealloca(cmd);
+    iree_hal_buffer_release(cmd->dealloca_buffer);
+    cmd->dealloca_buffer = NULL;
+  }
+
   // Signal all semaphores to their new values.
   // Note that if any signal fails then the whole command will fail and all
   // semaphores will be signaled to the failure state.
@@ -325,8 +358,13 @@ static void iree_hal_task_queue_retire_cmd_cleanup(
     }
   }
 
-  // Release all semaphores.
+  // Release all semaphores and the deallocated buffer if the command failed
+  // before it could be released.
   iree_hal_semaphore_list_release(&cmd->signal_semaphores);
+  if (cmd->dealloca_buffer) {
+    iree_hal_task_queue_retire_cmd_unregister_dealloca(cmd);
+    iree_hal_buffer_release(cmd->dealloca_buffer);
+  }
 
   // Drop all memory used by the submission (**including cmd**).
   iree_arena_allocator_t arena = cmd->arena;
@@ -338,13 +376,13 @@ static void iree_hal_task_queue_retire_cmd_cleanup(
 // The command will own an arena that can be used for other submission-related
 // allocations.
 static iree_status_t iree_hal_task_queue_retire_cmd_allocate(
-    iree_task_scope_t* scope,
+    iree_hal_task_queue_t* queue,
     const iree_hal_semaphore_list_t* signal_semaphores,
-    iree_arena_block_pool_t* block_pool,
+    iree_hal_buffer_t* dealloca_buffer,
     iree_hal_task_queue_retire_cmd_t** out_cmd) {
   // Make an arena we'll use for allocating the command itself.
   iree_arena_allocator_t arena;
-  iree_arena_initialize(block_pool, &arena);
+  iree_arena_initialize(queue->block_pool, &arena);
 
   // Allocate the command from the arena.
   iree_hal_task_queue_retire_cmd_t* cmd = NULL;
@@ -352,7 +390,8 @@ static iree_status_t iree_hal_task_queue_retire_cmd_allocate(
       iree_arena_allocate(&arena, sizeof(*cmd), (void**)&cmd);
   if (iree_status_is_ok(status)) {
     iree_task_call_initialize(
-        scope, iree_task_make_call_closure(iree_hal_task_queue_retire_cmd, 0),
+        &queue->scope,
+        iree_task_make_call_closure(iree_hal_task_queue_retire_cmd, 0),
         &cmd->task);
     iree_task_set_cleanup_fn(&cmd->task.header,
                              iree_hal_task_queue_retire_cmd_cleanup);
@@ -366,6 +405,10 @@ static iree_status_t iree_hal_task_queue_retire_cmd_allocate(
   }
 
   if (iree_status_is_ok(status)) {
+    cmd->queue = queue;
+    cmd->dealloca_buffer = dealloca_buffer;
+    iree_hal_buffer_retain(cmd->dealloca_buffer);
+
     // Transfer ownership of the arena to command.
     memcpy(&cmd->arena, &arena, sizeof(cmd->arena));
     *out_cmd = cmd;
@@ -382,6 +425,7 @@ static iree_status_t iree_hal_task_queue_retire_cmd_allocate(
 void iree_hal_task_queue_initialize(iree_string_view_t identifier,
                                     iree_task_executor_t* executor,
                                     iree_arena_block_pool_t* block_pool,
+                                    iree_hal_allocator_t* pool,
                                     iree_hal_task_queue_t* out_queue) {
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_TEXT(z0, identifier.data, identifier.size);
@@ -391,36 +435,49 @@ void iree_hal_task_queue_initialize(iree_string_view_t identifier,
   out_queue->executor = executor;
   iree_task_executor_retain(out_queue->executor);
   out_queue->block_pool = block_pool;
+  out_queue->pool = pool;
+  iree_hal_allocator_retain(out_queue->pool);
 
   iree_task_scope_initialize(identifier, &out_queue->scope);
 
   iree_hal_task_queue_state_initialize(&out_queue->state);
 
+  iree_slim_mutex_initialize(&out_queue->mutex);
+
   IREE_TRACE_ZONE_END(z0);
 }
 
 void iree_hal_task_queue_deinitialize(iree_hal_task_queue_t* queue) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  iree_status_ignore(
-      iree_task_scope_wait_idle(&queue->scope, IREE_TIME_INFINITE_FUTURE));
+  // Donate while waiting as threadless executors would otherwise never drain.
+  iree_status_ignore(iree_task_executor_donate_caller(
+      queue->executor, iree_task_scope_await_idle(&queue->scope),
+      iree_infinite_timeout()));
 
+  IREE_ASSERT_EQ(queue->pending_dealloca_count, 0);
+  iree_slim_mutex_deinitialize(&queue->mutex);
   iree_hal_task_queue_state_deinitialize(&queue->state);
   iree_task_scope_deinitialize(&queue->scope);
   iree_task_executor_release(queue->executor);
+  iree_hal_allocator_release(queue->pool);
 
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Submits |batch| to |queue|. If |dealloca_buffer| is provided it is retained
+// until all commands in the batch have completed and released prior to
+// signaling the batch semaphores. Until then it may be taken by allocas that
+// wait on the batch signals.
 static iree_status_t iree_hal_task_queue_submit_batch(
-    iree_hal_task_queue_t* queue, const iree_hal_submission_batch_t* batch) {
+    iree_hal_task_queue_t* queue, const iree_hal_submission_batch_t* batch,
+    iree_hal_buffer_t* dealloca_buffer) {
   // Task to retire the submission and free the transient memory allocated for
   // it (including the command itself). We allocate this first so it can get an
   // arena which we will use to allocate all other commands.
   iree_hal_task_queue_retire_cmd_t* retire_cmd = NULL;
   IREE_RETURN_IF_ERROR(iree_hal_task_queue_retire_cmd_allocate(
-      &queue->scope, &batch->signal_semaphores, queue->block_pool,
-      &retire_cmd));
+      queue, &batch->signal_semaphores, dealloca_buffer, &retire_cmd));
 
   // NOTE: if we fail from here on we must drop the retire_cmd arena.
   iree_status_t status = iree_ok_status();
@@ -454,10 +511,23 @@ static iree_status_t iree_hal_task_queue_submit_batch(
 
   // Last chance for failure - from here on we are submitting.
   if (IREE_UNLIKELY(!iree_status_is_ok(status))) {
+    iree_hal_buffer_release(retire_cmd->dealloca_buffer);
     iree_arena_deinitialize(&retire_cmd->arena);
     return status;
   }
 
+  // Publish the dealloca before submitting as the retire command may run (and
+  // unregister it) as soon as it is in the executor. Deallocas that signal
+  // nothing cannot be ordered before an alloca and are not tracked.
+  if (dealloca_buffer && batch->signal_semaphores.count > 0) {
+    iree_slim_mutex_lock(&queue->mutex);
+    if (queue->pending_dealloca_count <
+        IREE_ARRAYSIZE(queue->pending_deallocas)) {
+      queue->pending_deallocas[queue->pending_dealloca_count++] = retire_cmd;
+    }
+    iree_slim_mutex_unlock(&queue->mutex);
+  }
+
   iree_task_submission_t submission;
   iree_task_submission_initialize(&submission);
 
@@ -486,7 +556,8 @@ static iree_status_t iree_hal_task_queue_submit_batches(
   // build the whole DAG prior to submitting.
   for (iree_host_size_t i = 0; i < batch_count; ++i) {
     const iree_hal_submission_batch_t* batch = &batches[i];
-    IREE_RETURN_IF_ERROR(iree_hal_task_queue_submit_batch(queue, batch));
+    IREE_RETURN_IF_ERROR(iree_hal_task_queue_submit_batch(
+        queue, batch, /*dealloca_buffer=*/NULL));
   }
   return iree_ok_status();
 }
@@ -519,11 +590,140 @@ iree_status_t iree_hal_task_queue_submit_and_wait(
   iree_status_t status =
       iree_hal_task_queue_submit_batches(queue, batch_count, batches);
   if (iree_status_is_ok(status)) {
-    // Flush the pending submissions and begin processing, then wait until idle.
-    // TODO(benvanik): get a wait_handle we can pass to
-    // iree_task_executor_donate_caller - it'll flush + do work.
+    // Flush the pending submissions and donate the calling thread to the
+    // executor until the wait is satisfied. With a threadless executor this
+    // runs the entire submission on this thread without any wakes.
+    status = iree_task_executor_donate_caller(
+        queue->executor, iree_hal_semaphore_await(wait_semaphore, wait_value),
+        timeout);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Returns true if waiting on |wait_semaphores| implies that all of
+// |signal_semaphores| have been signaled.
+static bool iree_hal_task_queue_waits_cover_signals(
+    const iree_hal_semaphore_list_t* wait_semaphores,
+    const iree_hal_semaphore_list_t* signal_semaphores) {
+  for (iree_host_size_t i = 0; i < signal_semaphores->count; ++i) {
+    bool found = false;
+    for (iree_host_size_t j = 0; j < wait_semaphores->count && !found; ++j) {
+      found = wait_semaphores->semaphores[j] ==
+                  signal_semaphores->semaphores[i] &&
+              wait_semaphores->payload_values[j] >=
+                  signal_semaphores->payload_values[i];
+    }
+    if (!found) return false;
+  }
+  return true;
+}
+
+// Takes the buffer of a pending dealloca on |queue| that |wait_semaphores|
+// orders before the caller and that exactly matches |params| and
+// |allocation_size|. Returns NULL if there is none.
+static iree_hal_buffer_t* iree_hal_task_queue_take_pending_dealloca(
+    iree_hal_task_queue_t* queue,
+    const iree_hal_semaphore_list_t* wait_semaphores,
+    iree_hal_buffer_params_t params, iree_device_size_t allocation_size) {
+  if (wait_semaphores->count == 0) return NULL;
+  iree_hal_buffer_params_canonicalize(&params);
+  iree_hal_buffer_t* buffer = NULL;
+  iree_slim_mutex_lock(&queue->mutex);
+  for (iree_host_size_t i = 0; i < queue->pending_dealloca_count; ++i) {
+    iree_hal_task_queue_retire_cmd_t* cmd = queue->pending_deallocas[i];
+    iree_hal_buffer_t* candidate = cmd->dealloca_buffer;
+    if (iree_hal_buffer_byte_length(candidate) == allocation_size &&
+        iree_hal_buffer_byte_offset(candidate) == 0 &&
+        iree_all_bits_set(iree_hal_buffer_memory_type(candidate),
+                          params.type) &&
+        iree_all_bits_set(iree_hal_buffer_allowed_usage(candidate),
+                          params.usage) &&
+        iree_hal_buffer_allowed_access(candidate) == params.access &&
+        iree_hal_task_queue_waits_cover_signals(wait_semaphores,
+                                                &cmd->signal_semaphores)) {
+      // The retire command keeps its reference and releases it as usual; the
+      // storage only returns to the pool once the caller releases theirs.
+      buffer = candidate;
+      iree_hal_buffer_retain(buffer);
+      queue->pending_deallocas[i] =
+          queue->pending_deallocas[--queue->pending_dealloca_count];
+      break;
+    }
+  }
+  iree_slim_mutex_unlock(&queue->mutex);
+  return buffer;
+}
+
+iree_status_t iree_hal_task_queue_alloca(
+    iree_hal_task_queue_t* queue,
+    const iree_hal_semaphore_list_t* wait_semaphores,
+    const iree_hal_semaphore_list_t* signal_semaphores,
+    iree_hal_buffer_params_t params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** out_buffer) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Storage is bound at the time of the call. If the waits are ordered after
+  // a pending dealloca of a matching buffer on this queue then that buffer is
+  // reused as all work using it will have completed before the waits are
+  // satisfied. Otherwise storage is acquired from the pool, which only
+  // contains memory whose deallocas have already retired. Availability is then
+  // ordered by a submission with no commands that signals once the waits are
+  // satisfied.
+  //
+  // NOTE: deallocas of buffers that do not exactly match the request are not
+  // reused until they retire even if the waits depend on them. Binding late
+  // would require buffers whose storage is attached on the queue timeline,
+  // which the HAL buffer types do not support yet.
+  iree_hal_buffer_t* buffer = iree_hal_task_queue_take_pending_dealloca(
+      queue, wait_semaphores, params, allocation_size);
+  if (!buffer) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_hal_allocator_allocate_buffer(queue->pool, params,
+                                               allocation_size,
+                                               iree_const_byte_span_empty(),
+                                               &buffer));
+  }
+
+  const iree_hal_submission_batch_t batch = {
+      .wait_semaphores = *wait_semaphores,
+      .command_buffer_count = 0,
+      .command_buffers = NULL,
+      .signal_semaphores = *signal_semaphores,
+  };
+  iree_status_t status =
+      iree_hal_task_queue_submit_batch(queue, &batch, /*dealloca_buffer=*/NULL);
+  if (iree_status_is_ok(status)) {
+    iree_task_executor_flush(queue->executor);
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_hal_task_queue_dealloca(
+    iree_hal_task_queue_t* queue,
+    const iree_hal_semaphore_list_t* wait_semaphores,
+    const iree_hal_semaphore_list_t* signal_semaphores,
+    iree_hal_buffer_t* buffer) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // The submission retains the buffer until the waits are satisfied so that
+  // the storage is only recycled once all work using it has completed.
+  const iree_hal_submission_batch_t batch = {
+      .wait_semaphores = *wait_semaphores,
+      .command_buffer_count = 0,
+      .command_buffers = NULL,
+      .signal_semaphores = *signal_semaphores,
+  };
+  iree_status_t status =
+      iree_hal_task_queue_submit_batch(queue, &batch, buffer);
+  if (iree_status_is_ok(status)) {
     iree_task_executor_flush(queue->executor);
-    status = iree_hal_semaphore_wait(wait_semaphore, wait_value, timeout);
   }
 
   IREE_TRACE_ZONE_END(z0);
@@ -533,8 +733,8 @@ iree_status_t iree_hal_task_queue_submit_and_wait(
 iree_status_t iree_hal_task_queue_wait_idle(iree_hal_task_queue_t* queue,
                                             iree_timeout_t timeout) {
   IREE_TRACE_ZONE_BEGIN(z0);
-  iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
-  iree_status_t status = iree_task_scope_wait_idle(&queue->scope, deadline_ns);
+  iree_status_t status = iree_task_executor_donate_caller(
+      queue->executor, iree_task_scope_await_idle(&queue->scope), timeout);
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
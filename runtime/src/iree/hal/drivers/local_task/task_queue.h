@@ -12,6 +12,7 @@
 #include "iree/base/api.h"
 #include "iree/base/internal/arena.h"
 #include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/hal/api.h"
 #include "iree/hal/drivers/local_task/task_queue_state.h"
 #include "iree/task/executor.h"
@@ -22,6 +23,13 @@
 extern "C" {
 #endif  // __cplusplus
 
+// Maximum number of in-flight deallocas per queue whose storage can be handed
+// directly to allocas ordered after them.
+#define IREE_HAL_TASK_QUEUE_MAX_PENDING_DEALLOCAS 8
+
+typedef struct iree_hal_task_queue_retire_cmd_t
+    iree_hal_task_queue_retire_cmd_t;
+
 typedef struct iree_hal_task_queue_t {
   // Shared executor that the queue submits tasks to.
   iree_task_executor_t* executor;
@@ -37,11 +45,25 @@ typedef struct iree_hal_task_queue_t {
   // The intra-queue synchronization (barriers/events) carries across command
   // buffers and this is used to rendezvous the tasks in each set.
   iree_hal_task_queue_state_t state;
+
+  // Pool used for queue-ordered allocations. Storage released by deallocas is
+  // returned here and reused by subsequent allocas on the queue.
+  iree_hal_allocator_t* pool;
+
+  // Guards the pending dealloca list.
+  iree_slim_mutex_t mutex;
+  // Retire commands of deallocas that have been submitted but not yet retired.
+  // Allocas that wait on the signals of one of these take its buffer instead of
+  // allocating new storage from |pool|.
+  iree_host_size_t pending_dealloca_count;
+  iree_hal_task_queue_retire_cmd_t*
+      pending_deallocas[IREE_HAL_TASK_QUEUE_MAX_PENDING_DEALLOCAS];
 } iree_hal_task_queue_t;
 
 void iree_hal_task_queue_initialize(iree_string_view_t identifier,
                                     iree_task_executor_t* executor,
                                     iree_arena_block_pool_t* block_pool,
+                                    iree_hal_allocator_t* pool,
                                     iree_hal_task_queue_t* out_queue);
 
 void iree_hal_task_queue_deinitialize(iree_hal_task_queue_t* queue);
@@ -56,6 +78,19 @@ iree_status_t iree_hal_task_queue_submit_and_wait(
     iree_hal_semaphore_t* wait_semaphore, uint64_t wait_value,
     iree_timeout_t timeout);
 
+iree_status_t iree_hal_task_queue_alloca(
+    iree_hal_task_queue_t* queue,
+    const iree_hal_semaphore_list_t* wait_semaphores,
+    const iree_hal_semaphore_list_t* signal_semaphores,
+    iree_hal_buffer_params_t params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** out_buffer);
+
+iree_status_t iree_hal_task_queue_dealloca(
+    iree_hal_task_queue_t* queue,
+    const iree_hal_semaphore_list_t* wait_semaphores,
+    const iree_hal_semaphore_list_t* signal_semaphores,
+    iree_hal_buffer_t* buffer);
+
 iree_status_t iree_hal_task_queue_wait_idle(iree_hal_task_queue_t* queue,
                                             iree_timeout_t timeout);
 
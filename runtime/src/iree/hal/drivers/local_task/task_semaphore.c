@@ -53,6 +53,8 @@ static iree_status_t iree_hal_task_semaphore_timepoint_callback(
 typedef struct iree_hal_task_semaphore_t {
   iree_hal_semaphore_t base;
   iree_allocator_t host_allocator;
+  // Executor performing the work that signals the semaphore. Retained.
+  iree_task_executor_t* executor;
   iree_event_pool_t* event_pool;
 
   // Guards all mutable fields. We expect low contention on semaphores and since
@@ -78,9 +80,9 @@ static iree_hal_task_semaphore_t* iree_hal_task_semaphore_cast(
 }
 
 iree_status_t iree_hal_task_semaphore_create(
-    iree_event_pool_t* event_pool, uint64_t initial_value,
+    iree_task_executor_t* executor, uint64_t initial_value,
     iree_allocator_t host_allocator, iree_hal_semaphore_t** out_semaphore) {
-  IREE_ASSERT_ARGUMENT(event_pool);
+  IREE_ASSERT_ARGUMENT(executor);
   IREE_ASSERT_ARGUMENT(out_semaphore);
   *out_semaphore = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -92,7 +94,9 @@ iree_status_t iree_hal_task_semaphore_create(
     iree_hal_semaphore_initialize(&iree_hal_task_semaphore_vtable,
                                   &semaphore->base);
     semaphore->host_allocator = host_allocator;
-    semaphore->event_pool = event_pool;
+    semaphore->executor = executor;
+    iree_task_executor_retain(executor);
+    semaphore->event_pool = iree_task_executor_event_pool(executor);
 
     iree_slim_mutex_initialize(&semaphore->mutex);
     semaphore->current_value = initial_value;
@@ -114,6 +118,7 @@ static void iree_hal_task_semaphore_destroy(
 
   iree_slim_mutex_deinitialize(&semaphore->mutex);
   iree_status_ignore(semaphore->failure_status);
+  iree_task_executor_release(semaphore->executor);
 
   iree_hal_semaphore_deinitialize(&semaphore->base);
   iree_allocator_free(host_allocator, semaphore);
@@ -299,6 +304,12 @@ static iree_status_t iree_hal_task_semaphore_wait(
     // Not satisfied but a poll, so can avoid the expensive wait handle work.
     iree_slim_mutex_unlock(&semaphore->mutex);
     return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  } else if (iree_task_executor_is_threadless(semaphore->executor)) {
+    // Threadless: nothing will signal the semaphore unless we run the work.
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    return iree_task_executor_donate_caller(
+        semaphore->executor, iree_hal_semaphore_await(base_semaphore, value),
+        timeout);
   }
 
   iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
@@ -323,10 +334,58 @@ static iree_status_t iree_hal_task_semaphore_wait(
   return status;
 }
 
+// Wait source control function for a semaphore list that resolves when any
+// semaphore reaches its payload value. Only supports queries and polling and
+// is used to donate threads to threadless executors during waits.
+static iree_status_t iree_hal_task_semaphore_list_any_wait_source_ctl(
+    iree_wait_source_t wait_source, iree_wait_source_command_t command,
+    const void* params, void** inout_ptr) {
+  const iree_hal_semaphore_list_t* semaphore_list =
+      (const iree_hal_semaphore_list_t*)wait_source.self;
+  switch (command) {
+    case IREE_WAIT_SOURCE_COMMAND_QUERY: {
+      iree_status_code_t* out_wait_status_code = (iree_status_code_t*)inout_ptr;
+      *out_wait_status_code = IREE_STATUS_DEFERRED;
+      for (iree_host_size_t i = 0; i < semaphore_list->count; ++i) {
+        uint64_t current_value = 0;
+        iree_status_t status = iree_hal_semaphore_query(
+            semaphore_list->semaphores[i], &current_value);
+        if (!iree_status_is_ok(status)) {
+          *out_wait_status_code = iree_status_code(status);
+          iree_status_ignore(status);
+          break;
+        } else if (current_value >= semaphore_list->payload_values[i]) {
+          *out_wait_status_code = IREE_STATUS_OK;
+          break;
+        }
+      }
+      return iree_ok_status();
+    }
+    case IREE_WAIT_SOURCE_COMMAND_WAIT_ONE: {
+      iree_status_code_t wait_status_code = IREE_STATUS_OK;
+      IREE_RETURN_IF_ERROR(iree_wait_source_query(wait_source,
+                                                  &wait_status_code));
+      if (wait_status_code == IREE_STATUS_OK) {
+        return iree_ok_status();
+      } else if (wait_status_code != IREE_STATUS_DEFERRED) {
+        return iree_status_from_code(IREE_STATUS_ABORTED);
+      }
+      const iree_timeout_t timeout =
+          ((const iree_wait_source_wait_params_t*)params)->timeout;
+      return iree_status_from_code(iree_timeout_is_immediate(timeout)
+                                       ? IREE_STATUS_DEADLINE_EXCEEDED
+                                       : IREE_STATUS_DEFERRED);
+    }
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unimplemented wait_source command");
+  }
+}
+
 iree_status_t iree_hal_task_semaphore_multi_wait(
-    iree_hal_wait_mode_t wait_mode,
+    iree_task_executor_t* executor, iree_hal_wait_mode_t wait_mode,
     const iree_hal_semaphore_list_t* semaphore_list, iree_timeout_t timeout,
-    iree_event_pool_t* event_pool, iree_arena_block_pool_t* block_pool) {
+    iree_arena_block_pool_t* block_pool) {
   IREE_ASSERT_ARGUMENT(semaphore_list);
   if (semaphore_list->count == 0) {
     return iree_ok_status();
@@ -336,8 +395,31 @@ iree_status_t iree_hal_task_semaphore_multi_wait(
                                    semaphore_list->payload_values[0], timeout);
   }
 
+  if (iree_task_executor_is_threadless(executor)) {
+    // Threadless: no wait handles can be used as the work that signals the
+    // semaphores only runs on donated threads. We donate until the condition
+    // is met instead, which will poll the semaphores between tasks.
+    iree_convert_timeout_to_absolute(&timeout);
+    if (wait_mode == IREE_HAL_WAIT_MODE_ANY) {
+      iree_wait_source_t wait_source = {
+          .self = (void*)semaphore_list,
+          .data = 0,
+          .ctl = iree_hal_task_semaphore_list_any_wait_source_ctl,
+      };
+      return iree_task_executor_donate_caller(executor, wait_source, timeout);
+    }
+    for (iree_host_size_t i = 0; i < semaphore_list->count; ++i) {
+      IREE_RETURN_IF_ERROR(
+          iree_hal_semaphore_wait(semaphore_list->semaphores[i],
+                                  semaphore_list->payload_values[i], timeout));
+    }
+    return iree_ok_status();
+  }
+
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  iree_event_pool_t* event_pool = iree_task_executor_event_pool(executor);
+
   iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
 
   // Avoid heap allocations by using the device block pool for the wait set.
@@ -13,6 +13,7 @@
 #include "iree/base/internal/arena.h"
 #include "iree/base/internal/event_pool.h"
 #include "iree/hal/api.h"
+#include "iree/task/executor.h"
 #include "iree/task/submission.h"
 #include "iree/task/task.h"
 
@@ -21,9 +22,11 @@ extern "C" {
 #endif  // __cplusplus
 
 // Creates a semaphore that integrates with the task system to allow for
-// pipelined wait and signal operations.
+// pipelined wait and signal operations. Host waits donate the waiting thread
+// to |executor| when it is threadless as otherwise the work the waiter depends
+// on would never run.
 iree_status_t iree_hal_task_semaphore_create(
-    iree_event_pool_t* event_pool, uint64_t initial_value,
+    iree_task_executor_t* executor, uint64_t initial_value,
     iree_allocator_t host_allocator, iree_hal_semaphore_t** out_semaphore);
 
 // Returns true if |semaphore| is a task system semaphore.
@@ -41,11 +44,12 @@ iree_status_t iree_hal_task_semaphore_enqueue_timepoint(
 
 // Performs a multi-wait on one or more semaphores.
 // Returns IREE_STATUS_DEADLINE_EXCEEDED if the wait does not complete before
-// |deadline_ns| elapses.
+// |deadline_ns| elapses. When |executor| is threadless the calling thread is
+// donated to it for the duration of the wait.
 iree_status_t iree_hal_task_semaphore_multi_wait(
-    iree_hal_wait_mode_t wait_mode,
+    iree_task_executor_t* executor, iree_hal_wait_mode_t wait_mode,
     const iree_hal_semaphore_list_t* semaphore_list, iree_timeout_t timeout,
-    iree_event_pool_t* event_pool, iree_arena_block_pool_t* block_pool);
+    iree_arena_block_pool_t* block_pool);
 
 #ifdef __cplusplus
 }  // extern "C"
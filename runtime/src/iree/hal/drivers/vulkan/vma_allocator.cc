@@ -54,6 +54,7 @@ static iree_hal_memory_type_t iree_hal_vulkan_vma_allocator_lookup_memory_type(
 }
 
 // Callback function called before vkAllocateMemory.
+// Device memory blocks are suballocated by VMA and have no buffer usage.
 static void VKAPI_PTR iree_hal_vulkan_vma_allocate_callback(
     VmaAllocator VMA_NOT_NULL vma, uint32_t memoryType,
     VkDeviceMemory VMA_NOT_NULL_NON_DISPATCHABLE memory, VkDeviceSize size,
@@ -63,7 +64,7 @@ static void VKAPI_PTR iree_hal_vulkan_vma_allocate_callback(
   iree_hal_allocator_statistics_record_alloc(
       &allocator->statistics,
       iree_hal_vulkan_vma_allocator_lookup_memory_type(allocator, memoryType),
-      (iree_device_size_t)size);
+      IREE_HAL_BUFFER_USAGE_NONE, (iree_device_size_t)size);
 }
 
 // Callback function called before vkFreeMemory.
@@ -76,7 +77,7 @@ static void VKAPI_PTR iree_hal_vulkan_vma_free_callback(
   iree_hal_allocator_statistics_record_free(
       &allocator->statistics,
       iree_hal_vulkan_vma_allocator_lookup_memory_type(allocator, memoryType),
-      (iree_device_size_t)size);
+      IREE_HAL_BUFFER_USAGE_NONE, (iree_device_size_t)size);
 }
 
 #endif  // IREE_STATISTICS_ENABLE
@@ -388,6 +389,13 @@ static iree_status_t iree_hal_vulkan_vma_allocator_export_buffer(
                           "exporting to external buffers not supported");
 }
 
+static iree_status_t iree_hal_vulkan_vma_allocator_enumerate_live_buffers(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_allocator_live_buffer_callback_t callback) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "live buffer tracking not supported");
+}
+
 namespace {
 const iree_hal_allocator_vtable_t iree_hal_vulkan_vma_allocator_vtable = {
     /*.destroy=*/iree_hal_vulkan_vma_allocator_destroy,
@@ -400,5 +408,7 @@ const iree_hal_allocator_vtable_t iree_hal_vulkan_vma_allocator_vtable = {
     /*.deallocate_buffer=*/iree_hal_vulkan_vma_allocator_deallocate_buffer,
     /*.import_buffer=*/iree_hal_vulkan_vma_allocator_import_buffer,
     /*.export_buffer=*/iree_hal_vulkan_vma_allocator_export_buffer,
+    /*.enumerate_live_buffers=*/
+    iree_hal_vulkan_vma_allocator_enumerate_live_buffers,
 };
 }  // namespace
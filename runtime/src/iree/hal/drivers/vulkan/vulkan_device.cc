@@ -1076,6 +1076,66 @@ iree_hal_vulkan_device_query_semaphore_compatibility(
   return IREE_HAL_SEMAPHORE_COMPATIBILITY_HOST_ONLY;
 }
 
+static iree_status_t iree_hal_vulkan_device_queue_alloca(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_params_t params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_vulkan_device_t* device = iree_hal_vulkan_device_cast(base_device);
+
+  // Queue-ordered allocation is not pooled: new memory is allocated
+  // immediately and the signal is ordered after the waits with an empty
+  // submission.
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+      device->device_allocator, params, allocation_size,
+      iree_const_byte_span_empty(), &buffer));
+
+  CommandQueue* queue = iree_hal_vulkan_device_select_queue(
+      device, IREE_HAL_COMMAND_CATEGORY_ANY, queue_affinity);
+  iree_hal_submission_batch_t batch = {
+      /*.wait_semaphores=*/wait_semaphore_list,
+      /*.command_buffer_count=*/0,
+      /*.command_buffers=*/NULL,
+      /*.signal_semaphores=*/signal_semaphore_list,
+  };
+  iree_status_t status = queue->Submit(1, &batch);
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+  return status;
+}
+
+static iree_status_t iree_hal_vulkan_device_queue_dealloca(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_t* buffer) {
+  iree_hal_vulkan_device_t* device = iree_hal_vulkan_device_cast(base_device);
+
+  // Deallocation is not queue-ordered: we wait on the host for all work using
+  // the buffer to complete so that the memory can be freed as soon as the
+  // caller releases it.
+  if (wait_semaphore_list.count > 0) {
+    IREE_RETURN_IF_ERROR(iree_hal_vulkan_native_semaphore_multi_wait(
+        device->logical_device, &wait_semaphore_list, iree_infinite_timeout(),
+        /*wait_flags=*/0));
+  }
+
+  CommandQueue* queue = iree_hal_vulkan_device_select_queue(
+      device, IREE_HAL_COMMAND_CATEGORY_ANY, queue_affinity);
+  iree_hal_submission_batch_t batch = {
+      /*.wait_semaphores=*/{0, NULL, NULL},
+      /*.command_buffer_count=*/0,
+      /*.command_buffers=*/NULL,
+      /*.signal_semaphores=*/signal_semaphore_list,
+  };
+  return queue->Submit(1, &batch);
+}
+
 static iree_status_t iree_hal_vulkan_device_queue_submit(
     iree_hal_device_t* base_device,
     iree_hal_command_category_t command_categories,
@@ -1144,6 +1204,8 @@ const iree_hal_device_vtable_t iree_hal_vulkan_device_vtable = {
     /*.query_semaphore_compatibility=*/
     iree_hal_vulkan_device_query_semaphore_compatibility,
     /*.transfer_range=*/iree_hal_device_submit_transfer_range_and_wait,
+    /*.queue_alloca=*/iree_hal_vulkan_device_queue_alloca,
+    /*.queue_dealloca=*/iree_hal_vulkan_device_queue_dealloca,
     /*.queue_submit=*/iree_hal_vulkan_device_queue_submit,
     /*.submit_and_wait=*/
     iree_hal_vulkan_device_submit_and_wait,
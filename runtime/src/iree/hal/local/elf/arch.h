@@ -31,8 +31,24 @@ typedef struct iree_elf_relocation_state_t {
   // PT_DYNAMIC table.
   iree_host_size_t dyn_table_count;
   const iree_elf_dyn_t* dyn_table;
+
+  // Dynamic symbol table (.dynsym) and its string table (.dynstr).
+  iree_host_size_t dynsym_count;
+  const iree_elf_sym_t* dynsym;
+  const char* dynstr;
+
+  // Host-provided symbols used to resolve undefined symbols, if any.
+  const struct iree_elf_import_table_t* import_table;
 } iree_elf_relocation_state_t;
 
+// Resolves the address of the symbol at |sym_index| in the dynamic symbol
+// table for use in symbol-relative relocations. Index 0 (STN_UNDEF) resolves to
+// 0, symbols defined in the module resolve to their loaded address, and
+// undefined symbols are resolved from the import table.
+iree_status_t iree_elf_relocation_state_resolve_symbol(
+    const iree_elf_relocation_state_t* state, iree_host_size_t sym_index,
+    iree_elf_addr_t* out_addr);
+
 // Applies architecture-specific relocations.
 iree_status_t iree_elf_arch_apply_relocations(
     iree_elf_relocation_state_t* state);
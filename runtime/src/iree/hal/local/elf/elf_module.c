@@ -466,20 +466,39 @@ static iree_status_t iree_elf_module_parse_dynamic_tables(
   return iree_ok_status();
 }
 
-// Verifies that there are no dynamic imports in the module as we don't support
-// them yet.
-static iree_status_t iree_elf_module_verify_no_imports(
-    iree_elf_module_load_state_t* load_state, iree_elf_module_t* module) {
+// Looks up |symbol_name| in the host-provided |import_table|.
+static const iree_elf_import_t* iree_elf_import_table_lookup(
+    const iree_elf_import_table_t* import_table, const char* symbol_name) {
+  if (!import_table) return NULL;
+  for (iree_host_size_t i = 0; i < import_table->import_count; ++i) {
+    const iree_elf_import_t* import = &import_table->imports[i];
+    if (strcmp(import->sym_name, symbol_name) == 0) return import;
+  }
+  return NULL;
+}
+
+// Verifies that all strong dynamic imports in the module can be resolved from
+// |import_table| so that we fail early instead of with obscure messages during
+// relocation.
+static iree_status_t iree_elf_module_verify_imports(
+    iree_elf_module_load_state_t* load_state, iree_elf_module_t* module,
+    const iree_elf_import_table_t* import_table) {
   // NOTE: slot 0 is always the 0 placeholder.
   for (iree_host_size_t i = 1; i < module->dynsym_count; ++i) {
     const iree_elf_sym_t* sym = &module->dynsym[i];
-    if (sym->st_shndx == IREE_ELF_SHN_UNDEF) {
-      const char* symname IREE_ATTRIBUTE_UNUSED =
-          sym->st_name ? module->dynstr + sym->st_name : NULL;
+    if (sym->st_shndx != IREE_ELF_SHN_UNDEF) continue;
+    if (IREE_ELF_ST_BIND(sym->st_info) == IREE_ELF_STB_WEAK) continue;
+    const char* symname = sym->st_name ? module->dynstr + sym->st_name : NULL;
+    if (!symname) continue;
+    if (!import_table || !import_table->import_count) {
       return iree_make_status(IREE_STATUS_UNAVAILABLE,
                               "ELF imports one or more symbols (trying "
-                              "'%s'); imports are not supported in the "
-                              "platform-agnostic loader",
+                              "'%s'); no import table was provided",
+                              symname);
+    } else if (!iree_elf_import_table_lookup(import_table, symname)) {
+      return iree_make_status(IREE_STATUS_NOT_FOUND,
+                              "ELF imports symbol '%s' which is not present "
+                              "in the provided import table",
                               symname);
     }
   }
@@ -490,15 +509,50 @@ static iree_status_t iree_elf_module_verify_no_imports(
 // Relocation
 //==============================================================================
 
+iree_status_t iree_elf_relocation_state_resolve_symbol(
+    const iree_elf_relocation_state_t* state, iree_host_size_t sym_index,
+    iree_elf_addr_t* out_addr) {
+  *out_addr = 0;
+  if (sym_index == 0) return iree_ok_status();  // STN_UNDEF
+  if (sym_index >= state->dynsym_count) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "relocation symbol index %" PRIhsz
+                            " out of range of the %" PRIhsz
+                            " dynamic symbols",
+                            sym_index, state->dynsym_count);
+  }
+  const iree_elf_sym_t* sym = &state->dynsym[sym_index];
+  if (sym->st_shndx != IREE_ELF_SHN_UNDEF) {
+    // Defined within the module.
+    *out_addr = (iree_elf_addr_t)(state->vaddr_bias + sym->st_value);
+    return iree_ok_status();
+  }
+  const char* symname = sym->st_name ? state->dynstr + sym->st_name : "";
+  const iree_elf_import_t* import =
+      iree_elf_import_table_lookup(state->import_table, symname);
+  if (import) {
+    *out_addr = (iree_elf_addr_t)import->thunk_ptr;
+  } else if (IREE_ELF_ST_BIND(sym->st_info) != IREE_ELF_STB_WEAK) {
+    return iree_make_status(IREE_STATUS_NOT_FOUND,
+                            "unresolved ELF import '%s'", symname);
+  }
+  return iree_ok_status();  // unresolved weak imports resolve to NULL
+}
+
 // Applies symbol and address base relocations to the loaded sections.
 static iree_status_t iree_elf_module_apply_relocations(
-    iree_elf_module_load_state_t* load_state, iree_elf_module_t* module) {
+    iree_elf_module_load_state_t* load_state, iree_elf_module_t* module,
+    const iree_elf_import_table_t* import_table) {
   // Redirect to the architecture-specific handler.
   iree_elf_relocation_state_t reloc_state;
   memset(&reloc_state, 0, sizeof(reloc_state));
   reloc_state.vaddr_bias = module->vaddr_bias;
   reloc_state.dyn_table = load_state->dyn_table;
   reloc_state.dyn_table_count = load_state->dyn_table_count;
+  reloc_state.dynsym_count = module->dynsym_count;
+  reloc_state.dynsym = module->dynsym;
+  reloc_state.dynstr = module->dynstr;
+  reloc_state.import_table = import_table;
   return iree_elf_arch_apply_relocations(&reloc_state);
 }
 
@@ -598,15 +652,16 @@ iree_status_t iree_elf_module_initialize_from_memory(
     status = iree_elf_module_parse_dynamic_tables(&load_state, out_module);
   }
 
-  // TODO(benvanik): imports would happen here. For now we just ensure there are
-  // no imports as otherwise things will fail with obscure messages later on.
+  // Ensure all imports can be resolved from the provided import table.
   if (iree_status_is_ok(status)) {
-    status = iree_elf_module_verify_no_imports(&load_state, out_module);
+    status =
+        iree_elf_module_verify_imports(&load_state, out_module, import_table);
   }
 
-  // Apply relocations to the loaded pages.
+  // Apply relocations to the loaded pages, resolving imports as we go.
   if (iree_status_is_ok(status)) {
-    status = iree_elf_module_apply_relocations(&load_state, out_module);
+    status = iree_elf_module_apply_relocations(&load_state, out_module,
+                                               import_table);
   }
 
   // Apply final protections to the loaded pages now that relocations have been
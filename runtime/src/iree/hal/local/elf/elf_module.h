@@ -17,6 +17,9 @@
 // ELF symbol import table
 //==============================================================================
 
+// A host symbol made available to resolve an undefined symbol in a module.
+// |thunk_ptr| is called directly from module code and must be compatible with
+// the module's ABI (which differs from the host ABI on Windows).
 typedef struct iree_elf_import_t {
   const char* sym_name;
   void* thunk_ptr;
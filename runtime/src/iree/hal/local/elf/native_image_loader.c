@@ -0,0 +1,71 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/elf/native_image_loader.h"
+
+#include "iree/base/tracing.h"
+#include "iree/hal/local/elf/elf_module.h"
+
+static iree_status_t IREE_API_PTR iree_elf_native_image_loader_load(
+    void* self, iree_const_byte_span_t image,
+    const iree_vm_native_image_import_table_t* import_table,
+    iree_allocator_t host_allocator, void** out_handle) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  *out_handle = NULL;
+
+  // The ELF linker only needs the imports while resolving relocations so the
+  // table is converted into a temporary allocation.
+  iree_elf_module_t* elf_module = NULL;
+  iree_elf_import_t* imports = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      host_allocator,
+      sizeof(*elf_module) + import_table->count * sizeof(*imports),
+      (void**)&elf_module);
+  if (iree_status_is_ok(status)) {
+    imports = (iree_elf_import_t*)((uint8_t*)elf_module + sizeof(*elf_module));
+    for (iree_host_size_t i = 0; i < import_table->count; ++i) {
+      imports[i].sym_name = import_table->values[i].name;
+      imports[i].thunk_ptr = import_table->values[i].address;
+    }
+    const iree_elf_import_table_t elf_import_table = {
+        .import_count = import_table->count,
+        .imports = imports,
+    };
+    status = iree_elf_module_initialize_from_memory(image, &elf_import_table,
+                                                    host_allocator, elf_module);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_handle = elf_module;
+  } else {
+    iree_allocator_free(host_allocator, elf_module);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t IREE_API_PTR iree_elf_native_image_loader_lookup_export(
+    void* self, void* handle, const char* symbol_name, void** out_address) {
+  return iree_elf_module_lookup_export((iree_elf_module_t*)handle, symbol_name,
+                                       out_address);
+}
+
+static void IREE_API_PTR iree_elf_native_image_loader_unload(void* self,
+                                                             void* handle) {
+  iree_elf_module_t* elf_module = (iree_elf_module_t*)handle;
+  iree_allocator_t host_allocator = elf_module->host_allocator;
+  iree_elf_module_deinitialize(elf_module);
+  iree_allocator_free(host_allocator, elf_module);
+}
+
+void iree_elf_native_image_loader_initialize(
+    iree_vm_native_image_loader_t* out_loader) {
+  IREE_ASSERT_ARGUMENT(out_loader);
+  out_loader->self = NULL;
+  out_loader->load = iree_elf_native_image_loader_load;
+  out_loader->lookup_export = iree_elf_native_image_loader_lookup_export;
+  out_loader->unload = iree_elf_native_image_loader_unload;
+}
@@ -0,0 +1,30 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_LOCAL_ELF_NATIVE_IMAGE_LOADER_H_
+#define IREE_HAL_LOCAL_ELF_NATIVE_IMAGE_LOADER_H_
+
+#include "iree/base/api.h"
+#include "iree/vm/native_image.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Initializes |out_loader| to load VM native images with the embedded ELF
+// loader. The loader has no state and does not need to be deinitialized.
+//
+// NOTE: native images contain arbitrary native code that is not verified.
+// Only pass the loader to iree_vm_native_image_module_create when the modules
+// being loaded are trusted.
+void iree_elf_native_image_loader_initialize(
+    iree_vm_native_image_loader_t* out_loader);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_LOCAL_ELF_NATIVE_IMAGE_LOADER_H_
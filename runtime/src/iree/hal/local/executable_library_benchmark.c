@@ -157,10 +157,13 @@ static iree_status_t iree_hal_executable_library_run(
   executable_params.executable_format =
       iree_make_cstring_view(FLAG_executable_format);
 
-  // Load the executable data.
+  // Map the executable data. Loaders copy out what they need in order so we
+  // hint that the contents will be read sequentially.
   iree_file_contents_t* file_contents = NULL;
-  IREE_RETURN_IF_ERROR(iree_file_read_contents(FLAG_executable_file,
-                                               host_allocator, &file_contents));
+  IREE_RETURN_IF_ERROR(iree_file_read_contents_with_flags(
+      FLAG_executable_file,
+      IREE_FILE_READ_FLAG_MMAP | IREE_FILE_READ_FLAG_SEQUENTIAL,
+      host_allocator, &file_contents));
   executable_params.executable_data = file_contents->const_buffer;
 
   // Setup the layouts defining how each entry point is interpreted.
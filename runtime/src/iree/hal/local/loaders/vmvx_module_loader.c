@@ -11,6 +11,8 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/math.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/api.h"
 #include "iree/hal/local/executable_library.h"
@@ -19,18 +21,353 @@
 #include "iree/modules/vmvx/module.h"
 #include "iree/vm/bytecode_module.h"
 
+//===----------------------------------------------------------------------===//
+// iree_hal_vmvx_worker_state_t
+//===----------------------------------------------------------------------===//
+
+// Call state prepared for a dispatch and reused across all workgroups a worker
+// executes for it. Only the workgroup ID/size/count call arguments differ
+// between workgroups and everything else - the VM buffers wrapping the
+// bindings, the binding list, and the VM stack - is built once per dispatch.
+//
+// The wrapped memory is referenced and never copied so any dispatch matching
+// the key can reuse the state even if it is not the one that prepared it.
+typedef struct iree_hal_vmvx_worker_state_t {
+  // Whether the key and the call objects below are valid.
+  bool is_prepared;
+
+  // Key of the dispatch the state was last prepared for.
+  iree_host_size_t ordinal;
+  const uint32_t* push_constants;
+  iree_host_size_t push_constant_count;
+  void* local_memory;
+  iree_host_size_t local_memory_size;
+  iree_host_size_t binding_count;
+  void** binding_ptrs;      // [binding_capacity]
+  size_t* binding_lengths;  // [binding_capacity]
+
+  // Call objects wrapping the dispatch memory.
+  iree_vm_buffer_t local_memory_buffer;
+  iree_vm_buffer_t constants_buffer;
+  iree_vm_list_t* binding_list;
+  iree_byte_span_t binding_list_storage;
+  iree_vm_buffer_t* binding_buffers;  // [binding_capacity]
+
+  // Maximum number of bindings the state has storage for.
+  iree_host_size_t binding_capacity;
+
+  // Stack reused for all calls; it is empty between calls.
+  iree_vm_state_resolver_t state_resolver;
+  iree_allocator_t host_allocator;
+  iree_byte_span_t stack_storage;
+  iree_vm_stack_t* stack;
+} iree_hal_vmvx_worker_state_t;
+
+// Returns the total size in bytes of a worker state with storage for up to
+// |binding_capacity| bindings, including all trailing storage.
+static iree_host_size_t iree_hal_vmvx_worker_state_size(
+    iree_host_size_t binding_capacity) {
+  iree_vm_type_def_t buffer_type =
+      iree_vm_type_def_make_ref_type(iree_vm_buffer_type_id());
+  return iree_sizeof_struct(iree_hal_vmvx_worker_state_t) +
+         iree_host_align(binding_capacity * sizeof(void*), iree_max_align_t) +
+         iree_host_align(binding_capacity * sizeof(size_t), iree_max_align_t) +
+         iree_host_align(binding_capacity * sizeof(iree_vm_buffer_t),
+                         iree_max_align_t) +
+         iree_host_align(
+             iree_vm_list_storage_size(&buffer_type, binding_capacity),
+             iree_max_align_t) +
+         IREE_VM_STACK_DEFAULT_SIZE;
+}
+
+static void iree_hal_vmvx_worker_state_reset_stack(
+    iree_hal_vmvx_worker_state_t* state) {
+  if (state->stack) iree_vm_stack_deinitialize(state->stack);
+  state->stack = NULL;
+  IREE_IGNORE_ERROR(iree_vm_stack_initialize(
+      state->stack_storage, IREE_VM_INVOCATION_FLAG_TRACE_INLINE,
+      state->state_resolver, state->host_allocator, &state->stack));
+}
+
+// Initializes a worker state in |storage| of at least
+// iree_hal_vmvx_worker_state_size bytes. The state is not prepared for any
+// dispatch until iree_hal_vmvx_worker_state_prepare is called.
+static iree_hal_vmvx_worker_state_t* iree_hal_vmvx_worker_state_initialize(
+    iree_vm_context_t* context, iree_host_size_t binding_capacity,
+    iree_allocator_t host_allocator, void* storage) {
+  iree_hal_vmvx_worker_state_t* state =
+      (iree_hal_vmvx_worker_state_t*)storage;
+  memset(state, 0, sizeof(*state));
+  state->binding_capacity = binding_capacity;
+  state->state_resolver = iree_vm_context_state_resolver(context);
+  state->host_allocator = host_allocator;
+
+  iree_vm_type_def_t buffer_type =
+      iree_vm_type_def_make_ref_type(iree_vm_buffer_type_id());
+  uint8_t* ptr = (uint8_t*)storage + iree_sizeof_struct(*state);
+  state->binding_ptrs = (void**)ptr;
+  ptr += iree_host_align(binding_capacity * sizeof(void*), iree_max_align_t);
+  state->binding_lengths = (size_t*)ptr;
+  ptr += iree_host_align(binding_capacity * sizeof(size_t), iree_max_align_t);
+  state->binding_buffers = (iree_vm_buffer_t*)ptr;
+  ptr += iree_host_align(binding_capacity * sizeof(iree_vm_buffer_t),
+                         iree_max_align_t);
+  state->binding_list_storage = iree_make_byte_span(
+      ptr, iree_vm_list_storage_size(&buffer_type, binding_capacity));
+  ptr += iree_host_align(state->binding_list_storage.data_length,
+                         iree_max_align_t);
+  state->stack_storage = iree_make_byte_span(ptr, IREE_VM_STACK_DEFAULT_SIZE);
+
+  iree_hal_vmvx_worker_state_reset_stack(state);
+  return state;
+}
+
+// Releases the call objects wrapping the dispatch memory, if any.
+static void iree_hal_vmvx_worker_state_reset(
+    iree_hal_vmvx_worker_state_t* state) {
+  if (!state->is_prepared) return;
+  state->is_prepared = false;
+  iree_vm_buffer_deinitialize(&state->local_memory_buffer);
+  iree_vm_buffer_deinitialize(&state->constants_buffer);
+  if (state->binding_list) {
+    iree_vm_list_deinitialize(state->binding_list);
+    state->binding_list = NULL;
+  }
+  for (iree_host_size_t i = 0; i < state->binding_count; ++i) {
+    iree_vm_buffer_deinitialize(&state->binding_buffers[i]);
+  }
+  state->binding_count = 0;
+}
+
+static void iree_hal_vmvx_worker_state_deinitialize(
+    iree_hal_vmvx_worker_state_t* state) {
+  iree_hal_vmvx_worker_state_reset(state);
+  iree_vm_stack_deinitialize(state->stack);
+  state->stack = NULL;
+}
+
+static bool iree_hal_vmvx_worker_state_matches(
+    const iree_hal_vmvx_worker_state_t* state, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state) {
+  return state->is_prepared && state->ordinal == ordinal &&
+         state->push_constants == dispatch_state->push_constants &&
+         state->push_constant_count == dispatch_state->push_constant_count &&
+         state->local_memory == workgroup_state->local_memory &&
+         state->local_memory_size == workgroup_state->local_memory_size &&
+         state->binding_count == dispatch_state->binding_count &&
+         memcmp(state->binding_ptrs, dispatch_state->binding_ptrs,
+                state->binding_count * sizeof(void*)) == 0 &&
+         memcmp(state->binding_lengths, dispatch_state->binding_lengths,
+                state->binding_count * sizeof(size_t)) == 0;
+}
+
+// Prepares |state| for calls within the given dispatch. This is a no-op if the
+// state was already prepared for a matching dispatch.
+static iree_status_t iree_hal_vmvx_worker_state_prepare(
+    iree_hal_vmvx_worker_state_t* state, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state) {
+  if (iree_hal_vmvx_worker_state_matches(state, ordinal, dispatch_state,
+                                         workgroup_state)) {
+    return iree_ok_status();
+  }
+  iree_hal_vmvx_worker_state_reset(state);
+  IREE_ASSERT_LE(dispatch_state->binding_count, state->binding_capacity);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  state->ordinal = ordinal;
+  state->push_constants = dispatch_state->push_constants;
+  state->push_constant_count = dispatch_state->push_constant_count;
+  state->local_memory = workgroup_state->local_memory;
+  state->local_memory_size = workgroup_state->local_memory_size;
+  memcpy(state->binding_ptrs, dispatch_state->binding_ptrs,
+         dispatch_state->binding_count * sizeof(void*));
+  memcpy(state->binding_lengths, dispatch_state->binding_lengths,
+         dispatch_state->binding_count * sizeof(size_t));
+
+  // Workgroup local memory for the dispatch.
+  iree_vm_buffer_initialize(
+      IREE_VM_BUFFER_ACCESS_MUTABLE | IREE_VM_BUFFER_ACCESS_ORIGIN_HOST,
+      iree_make_byte_span(workgroup_state->local_memory,
+                          workgroup_state->local_memory_size),
+      iree_allocator_null(), &state->local_memory_buffer);
+
+  // Map the push constant memory directly from the dispatch state.
+  iree_vm_buffer_initialize(
+      IREE_VM_BUFFER_ACCESS_ORIGIN_HOST,
+      iree_make_byte_span(
+          (void*)dispatch_state->push_constants,
+          sizeof(uint32_t) * dispatch_state->push_constant_count),
+      iree_allocator_null(), &state->constants_buffer);
+  state->is_prepared = true;
+
+  iree_vm_type_def_t buffer_type =
+      iree_vm_type_def_make_ref_type(iree_vm_buffer_type_id());
+  iree_status_t status = iree_vm_list_initialize(
+      state->binding_list_storage, &buffer_type, dispatch_state->binding_count,
+      &state->binding_list);
+
+  // Map bindings into VMVX buffers.
+  for (iree_host_size_t i = 0;
+       i < dispatch_state->binding_count && iree_status_is_ok(status); ++i) {
+    iree_vm_buffer_t* binding_buffer = &state->binding_buffers[i];
+    // TODO(benvanik): executable layout contains the required access
+    // information. We will likely want to encode a bitmap of mutable bindings
+    // such that we can quickly set the access bit, though.
+    iree_vm_buffer_access_t access =
+        IREE_VM_BUFFER_ACCESS_MUTABLE | IREE_VM_BUFFER_ACCESS_ORIGIN_HOST;
+    iree_vm_buffer_initialize(
+        access,
+        iree_make_byte_span(dispatch_state->binding_ptrs[i],
+                            dispatch_state->binding_lengths[i]),
+        iree_allocator_null(), binding_buffer);
+    state->binding_count = i + 1;
+    iree_vm_ref_t ref = {0};
+    status =
+        iree_vm_ref_wrap_assign(binding_buffer, iree_vm_buffer_type_id(), &ref);
+    if (iree_status_is_ok(status)) {
+      status = iree_vm_list_push_ref_retain(state->binding_list, &ref);
+    }
+  }
+
+  if (!iree_status_is_ok(status)) {
+    iree_hal_vmvx_worker_state_reset(state);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Calls |entry_fn| for a single workgroup using the prepared |state|.
+static iree_status_t iree_hal_vmvx_worker_state_call(
+    iree_hal_vmvx_worker_state_t* state, iree_vm_function_t entry_fn,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state) {
+  // The callee takes ownership of the argument references so we retain them
+  // here and the state keeps its own references across calls.
+  iree_vm_buffer_retain(&state->local_memory_buffer);
+  iree_vm_buffer_retain(&state->constants_buffer);
+  iree_vm_list_retain(state->binding_list);
+
+  // Prepare call argument buffer. We've verified the signature on creation and
+  // know the exact format we can assume here.
+  //
+  //   func.func @entry(
+  //       %local_memory: !vmvx.buffer,
+  //       %constants: !vmvx.buffer,
+  //       %bindings: !util.list<!vmvx.buffer>,
+  //       %workgroup_id_x: index,
+  //       %workgroup_id_y: index,
+  //       %workgroup_id_z: index,
+  //       %workgroup_size_x: index,
+  //       %workgroup_size_y: index,
+  //       %workgroup_size_z: index,
+  //       %workgroup_count_x: index,
+  //       %workgroup_count_y: index,
+  //       %workgroup_count_z: index
+  //    )
+  //
+  // NOTE: this level of the VM ABI is supported - but may change in the future.
+  // Users should prefer to use the invocation API that is more stable.
+  struct {
+    iree_vm_ref_t local_memory;
+    iree_vm_ref_t constants;
+    iree_vm_ref_t bindings;
+    uint32_t workgroup_id_x;
+    uint32_t workgroup_id_y;
+    uint32_t workgroup_id_z;
+    uint32_t workgroup_size_x;
+    uint32_t workgroup_size_y;
+    uint32_t workgroup_size_z;
+    uint32_t workgroup_count_x;
+    uint32_t workgroup_count_y;
+    uint32_t workgroup_count_z;
+  } call_args = {
+      .local_memory =
+          {
+              .type = iree_vm_buffer_type_id(),
+              .ptr = &state->local_memory_buffer,
+              .offsetof_counter = 0,
+          },
+      .constants =
+          {
+              .type = iree_vm_buffer_type_id(),
+              .ptr = &state->constants_buffer,
+              .offsetof_counter = 0,
+          },
+      .bindings =
+          {
+              .type = iree_vm_list_type_id(),
+              .ptr = state->binding_list,
+              .offsetof_counter = 0,
+          },
+      .workgroup_id_x = workgroup_state->workgroup_id_x,
+      .workgroup_id_y = workgroup_state->workgroup_id_y,
+      .workgroup_id_z = workgroup_state->workgroup_id_z,
+      .workgroup_size_x = dispatch_state->workgroup_size_x,
+      .workgroup_size_y = dispatch_state->workgroup_size_y,
+      .workgroup_size_z = dispatch_state->workgroup_size_z,
+      .workgroup_count_x = dispatch_state->workgroup_count_x,
+      .workgroup_count_y = dispatch_state->workgroup_count_y,
+      .workgroup_count_z = dispatch_state->workgroup_count_z,
+  };
+
+  // Direct call interface.
+  // This only works because we know the exact signature and that these will
+  // never block (if they do it'll be handled as if it's an error).
+  iree_vm_function_call_t call;
+  memset(&call, 0, sizeof(call));
+  call.function = entry_fn;
+  call.arguments = iree_make_byte_span(&call_args, sizeof(call_args));
+  call.results = iree_make_byte_span(NULL, 0);
+  iree_vm_execution_result_t result;
+  iree_status_t status = entry_fn.module->begin_call(
+      entry_fn.module->self, state->stack, &call, &result);
+
+  // Drop any argument references the callee did not take ownership of.
+  iree_vm_ref_release(&call_args.local_memory);
+  iree_vm_ref_release(&call_args.constants);
+  iree_vm_ref_release(&call_args.bindings);
+
+  // Successful calls leave the stack empty. Failed calls may leave frames (and
+  // the argument references they hold) behind and we drop them here so that
+  // the stack can be reused.
+  if (IREE_UNLIKELY(!iree_status_is_ok(status))) {
+    iree_hal_vmvx_worker_state_reset_stack(state);
+  }
+
+  return status;
+}
+
 //===----------------------------------------------------------------------===//
 // iree_hal_vmvx_executable_t
 //===----------------------------------------------------------------------===//
 
 #define IREE_VMVX_ENTRY_SIGNATURE "0rrriiiiiiiii_v"
 
+// Total number of cached worker state slots per executable.
+// Workers are assigned slots based on the processor they are running on and
+// any worker that finds its slot in use by another falls back to preparing a
+// transient state on the stack.
+#define IREE_HAL_VMVX_WORKER_STATE_SLOT_COUNT 64
+
+// Slot value indicating that the slot state is currently claimed by a worker.
+#define IREE_HAL_VMVX_WORKER_STATE_SLOT_BUSY ((intptr_t)1)
+
 typedef struct iree_hal_vmvx_executable_t {
   iree_hal_local_executable_t base;
 
   // Context containing both the VMVX module and the loaded executable.
   iree_vm_context_t* context;
 
+  // Maximum number of bindings used by any entry point.
+  iree_host_size_t max_binding_count;
+
+  // Lazily-allocated iree_hal_vmvx_worker_state_t slots indexed by processor.
+  // 0 indicates the slot has not yet been allocated and
+  // IREE_HAL_VMVX_WORKER_STATE_SLOT_BUSY that it is claimed by a worker.
+  iree_atomic_intptr_t worker_states[IREE_HAL_VMVX_WORKER_STATE_SLOT_COUNT];
+
   // Resolved entry functions from the module.
   iree_host_size_t entry_fn_count;
   iree_vm_function_t entry_fns[];
@@ -186,6 +523,14 @@ static iree_status_t iree_hal_vmvx_executable_create(
     executable->base.dispatch_attrs = dispatch_attrs;
     iree_vm_context_retain(executable->context);
 
+    for (iree_host_size_t i = 0;
+         i < executable_params->executable_layout_count; ++i) {
+      iree_host_size_t binding_count = iree_math_count_ones_u64(
+          executable->base.executable_layouts[i]->used_bindings);
+      executable->max_binding_count =
+          iree_max(executable->max_binding_count, binding_count);
+    }
+
     executable->entry_fn_count = entry_count;
     for (iree_host_size_t i = 0; i < executable->entry_fn_count; ++i) {
       status = iree_vm_module_lookup_function_by_ordinal(
@@ -238,6 +583,18 @@ static void iree_hal_vmvx_executable_destroy(
   iree_allocator_t host_allocator = executable->base.host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(executable->worker_states);
+       ++i) {
+    intptr_t slot_value = iree_atomic_load_intptr(
+        &executable->worker_states[i], iree_memory_order_acquire);
+    if (slot_value == 0) continue;
+    IREE_ASSERT_NE(slot_value, IREE_HAL_VMVX_WORKER_STATE_SLOT_BUSY);
+    iree_hal_vmvx_worker_state_t* worker_state =
+        (iree_hal_vmvx_worker_state_t*)slot_value;
+    iree_hal_vmvx_worker_state_deinitialize(worker_state);
+    iree_allocator_free(host_allocator, worker_state);
+  }
+
   iree_vm_context_release(executable->context);
   iree_hal_local_executable_deinitialize(
       (iree_hal_local_executable_t*)base_executable);
@@ -246,6 +603,43 @@ static void iree_hal_vmvx_executable_destroy(
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Claims the cached worker state for the processor executing the workgroup.
+// Returns NULL if the slot is in use by another worker or the state could not
+// be allocated, in which case the caller must use a transient state.
+static iree_hal_vmvx_worker_state_t*
+iree_hal_vmvx_executable_claim_worker_state(
+    iree_hal_vmvx_executable_t* executable,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
+    iree_atomic_intptr_t** out_slot) {
+  iree_atomic_intptr_t* slot =
+      &executable->worker_states[workgroup_state->processor_id %
+                                 IREE_HAL_VMVX_WORKER_STATE_SLOT_COUNT];
+  *out_slot = slot;
+  intptr_t slot_value = iree_atomic_exchange_intptr(
+      slot, IREE_HAL_VMVX_WORKER_STATE_SLOT_BUSY, iree_memory_order_acquire);
+  if (slot_value == IREE_HAL_VMVX_WORKER_STATE_SLOT_BUSY) {
+    // Another worker sharing the slot is using it.
+    return NULL;
+  } else if (slot_value != 0) {
+    return (iree_hal_vmvx_worker_state_t*)slot_value;
+  }
+
+  // First use of the slot; allocate the state that will be kept for the
+  // lifetime of the executable.
+  void* storage = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      executable->base.host_allocator,
+      iree_hal_vmvx_worker_state_size(executable->max_binding_count), &storage);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    iree_atomic_store_intptr(slot, 0, iree_memory_order_release);
+    return NULL;
+  }
+  return iree_hal_vmvx_worker_state_initialize(
+      executable->context, executable->max_binding_count,
+      executable->base.host_allocator, storage);
+}
+
 static iree_status_t iree_hal_vmvx_executable_issue_call(
     iree_hal_local_executable_t* base_executable, iree_host_size_t ordinal,
     const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
@@ -268,155 +662,43 @@ static iree_status_t iree_hal_vmvx_executable_issue_call(
                                       entry_point_name.size);
 #endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
 
-  // On-stack interface local to this invocation.
-  // Note that we _could_ share this across all invocations in a dispatch, but
-  // it's tricky to find a good place when threading is happening and it's
-  // intentionally fairly cheap to construct by matching the dispatch_state.
-  // The list would only need to be constructed once and we could avoid the
-  // extraneous retain/releases and mappings.
-  iree_vm_type_def_t buffer_type =
-      iree_vm_type_def_make_ref_type(iree_vm_buffer_type_id());
-  iree_host_size_t binding_list_size =
-      iree_vm_list_storage_size(&buffer_type, dispatch_state->binding_count);
-  void* binding_list_storage = iree_alloca(binding_list_size);
-  iree_vm_list_t* binding_list = NULL;
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_vm_list_initialize(
-              iree_make_byte_span(binding_list_storage, binding_list_size),
-              &buffer_type, dispatch_state->binding_count, &binding_list));
-  iree_vm_list_retain(binding_list);  // for call
-
-  // Map bindings into on-stack VMVX buffers.
-  iree_vm_buffer_t* binding_buffers = (iree_vm_buffer_t*)iree_alloca(
-      dispatch_state->binding_count * sizeof(iree_vm_buffer_t));
-  for (iree_host_size_t i = 0; i < dispatch_state->binding_count; ++i) {
-    iree_vm_buffer_t* binding_buffer = &binding_buffers[i];
-    // TODO(benvanik): executable layout contains the required access
-    // information. We will likely want to encode a bitmap of mutable bindings
-    // such that we can quickly set the access bit, though.
-    iree_vm_buffer_access_t access =
-        IREE_VM_BUFFER_ACCESS_MUTABLE | IREE_VM_BUFFER_ACCESS_ORIGIN_HOST;
-    iree_vm_buffer_initialize(
-        access,
-        iree_make_byte_span(dispatch_state->binding_ptrs[i],
-                            dispatch_state->binding_lengths[i]),
-        iree_allocator_null(), binding_buffer);
-    iree_vm_ref_t ref = {0};
-    IREE_RETURN_AND_END_ZONE_IF_ERROR(
-        z0, iree_vm_ref_wrap_assign(binding_buffer, iree_vm_buffer_type_id(),
-                                    &ref));
-    IREE_RETURN_AND_END_ZONE_IF_ERROR(
-        z0, iree_vm_list_push_ref_retain(binding_list, &ref));
+  // Reuse the state cached for this worker if it's available. Workers execute
+  // many workgroups of the same dispatch back-to-back and only the first will
+  // need to prepare the state.
+  iree_atomic_intptr_t* slot = NULL;
+  iree_hal_vmvx_worker_state_t* worker_state = NULL;
+  if (dispatch_state->binding_count <= executable->max_binding_count) {
+    worker_state = iree_hal_vmvx_executable_claim_worker_state(
+        executable, workgroup_state, &slot);
   }
 
-  // Acquire workgroup local memory for the dispatch.
-  iree_vm_buffer_t local_memory_buffer;
-  iree_vm_buffer_initialize(
-      IREE_VM_BUFFER_ACCESS_MUTABLE | IREE_VM_BUFFER_ACCESS_ORIGIN_HOST,
-      iree_make_byte_span(workgroup_state->local_memory,
-                          workgroup_state->local_memory_size),
-      iree_allocator_null(), &local_memory_buffer);
-  iree_vm_buffer_retain(&local_memory_buffer);  // for call
-
-  // Map the push constant memory directly from the dispatch state.
-  iree_vm_buffer_t constants_buffer;
-  iree_vm_buffer_initialize(
-      IREE_VM_BUFFER_ACCESS_ORIGIN_HOST,
-      iree_make_byte_span(
-          (void*)dispatch_state->push_constants,
-          sizeof(uint32_t) * dispatch_state->push_constant_count),
-      iree_allocator_null(), &constants_buffer);
-  iree_vm_buffer_retain(&constants_buffer);  // for call
-
-  // Prepare call argument buffer. We've verified the signature on creation and
-  // know the exact format we can assume here.
-  //
-  //   func.func @entry(
-  //       %local_memory: !vmvx.buffer,
-  //       %constants: !vmvx.buffer,
-  //       %bindings: !util.list<!vmvx.buffer>,
-  //       %workgroup_id_x: index,
-  //       %workgroup_id_y: index,
-  //       %workgroup_id_z: index,
-  //       %workgroup_size_x: index,
-  //       %workgroup_size_y: index,
-  //       %workgroup_size_z: index,
-  //       %workgroup_count_x: index,
-  //       %workgroup_count_y: index,
-  //       %workgroup_count_z: index
-  //    )
-  //
-  // NOTE: this level of the VM ABI is supported - but may change in the future.
-  // Users should prefer to use the invocation API that is more stable.
-  struct {
-    iree_vm_ref_t local_memory;
-    iree_vm_ref_t constants;
-    iree_vm_ref_t bindings;
-    uint32_t workgroup_id_x;
-    uint32_t workgroup_id_y;
-    uint32_t workgroup_id_z;
-    uint32_t workgroup_size_x;
-    uint32_t workgroup_size_y;
-    uint32_t workgroup_size_z;
-    uint32_t workgroup_count_x;
-    uint32_t workgroup_count_y;
-    uint32_t workgroup_count_z;
-  } call_args = {
-      .local_memory =
-          {
-              .type = iree_vm_buffer_type_id(),
-              .ptr = &local_memory_buffer,
-              .offsetof_counter = 0,
-          },
-      .constants =
-          {
-              .type = iree_vm_buffer_type_id(),
-              .ptr = &constants_buffer,
-              .offsetof_counter = 0,
-          },
-      .bindings =
-          {
-              .type = iree_vm_list_type_id(),
-              .ptr = binding_list,
-              .offsetof_counter = 0,
-          },
-      .workgroup_id_x = workgroup_state->workgroup_id_x,
-      .workgroup_id_y = workgroup_state->workgroup_id_y,
-      .workgroup_id_z = workgroup_state->workgroup_id_z,
-      .workgroup_size_x = dispatch_state->workgroup_size_x,
-      .workgroup_size_y = dispatch_state->workgroup_size_y,
-      .workgroup_size_z = dispatch_state->workgroup_size_z,
-      .workgroup_count_x = dispatch_state->workgroup_count_x,
-      .workgroup_count_y = dispatch_state->workgroup_count_y,
-      .workgroup_count_z = dispatch_state->workgroup_count_z,
-  };
-
-  // On-stack stack. We really do abuse the stack too much here.
-  // TODO(benvanik): pass in an iree_arena_t that can be used for this.
-  IREE_VM_INLINE_STACK_INITIALIZE(
-      stack, IREE_VM_INVOCATION_FLAG_TRACE_INLINE,
-      iree_vm_context_state_resolver(executable->context),
-      executable->base.host_allocator);
-
-  // Direct call interface.
-  // This only works because we know the exact signature and that these will
-  // never block (if they do it'll be handled as if it's an error).
-  iree_vm_function_call_t call;
-  memset(&call, 0, sizeof(call));
-  call.function = entry_fn;
-  call.arguments = iree_make_byte_span(&call_args, sizeof(call_args));
-  call.results = iree_make_byte_span(NULL, 0);
-  iree_vm_execution_result_t result;
-  iree_status_t status =
-      entry_fn.module->begin_call(entry_fn.module->self, stack, &call, &result);
-
-  iree_vm_stack_deinitialize(stack);
-
-  iree_vm_buffer_deinitialize(&local_memory_buffer);
-  iree_vm_buffer_deinitialize(&constants_buffer);
-  iree_vm_list_deinitialize(binding_list);
-  for (iree_host_size_t i = 0; i < dispatch_state->binding_count; ++i) {
-    iree_vm_buffer_deinitialize(&binding_buffers[i]);
+  iree_status_t status = iree_ok_status();
+  if (IREE_LIKELY(worker_state)) {
+    status = iree_hal_vmvx_worker_state_prepare(
+        worker_state, ordinal, dispatch_state, workgroup_state);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_vmvx_worker_state_call(worker_state, entry_fn,
+                                               dispatch_state, workgroup_state);
+    }
+    iree_atomic_store_intptr(slot, (intptr_t)worker_state,
+                             iree_memory_order_release);
+  } else {
+    // On-stack state local to this invocation.
+    // We really do abuse the stack too much here.
+    // TODO(benvanik): pass in an iree_arena_t that can be used for this.
+    void* storage = iree_alloca(
+        iree_hal_vmvx_worker_state_size(dispatch_state->binding_count));
+    iree_hal_vmvx_worker_state_t* transient_state =
+        iree_hal_vmvx_worker_state_initialize(
+            executable->context, dispatch_state->binding_count,
+            executable->base.host_allocator, storage);
+    status = iree_hal_vmvx_worker_state_prepare(
+        transient_state, ordinal, dispatch_state, workgroup_state);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_vmvx_worker_state_call(
+          transient_state, entry_fn, dispatch_state, workgroup_state);
+    }
+    iree_hal_vmvx_worker_state_deinitialize(transient_state);
   }
 
   IREE_TRACE_ZONE_END(z0);
@@ -0,0 +1,693 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/caching_allocator.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iree/base/internal/math.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+
+//===----------------------------------------------------------------------===//
+// Size classes
+//===----------------------------------------------------------------------===//
+
+// log2 of the smallest size class; smaller allocations are rounded up to it.
+#define IREE_HAL_CACHING_ALLOCATOR_MIN_CLASS_LOG2 8
+// log2 of the largest power-of-two size class.
+#define IREE_HAL_CACHING_ALLOCATOR_SMALL_CLASS_LOG2 16
+// log2 of the number of second-level classes per power of two above the small
+// classes. 8 subdivisions bound the rounding waste to 1/8 of the size.
+#define IREE_HAL_CACHING_ALLOCATOR_SECOND_LEVEL_LOG2 3
+// log2 of the first size that is never cached.
+#define IREE_HAL_CACHING_ALLOCATOR_MAX_CLASS_LOG2 48
+
+#define IREE_HAL_CACHING_ALLOCATOR_SMALL_BIN_COUNT    \
+  (IREE_HAL_CACHING_ALLOCATOR_SMALL_CLASS_LOG2 -      \
+   IREE_HAL_CACHING_ALLOCATOR_MIN_CLASS_LOG2 + 1)
+#define IREE_HAL_CACHING_ALLOCATOR_BIN_COUNT        \
+  (IREE_HAL_CACHING_ALLOCATOR_SMALL_BIN_COUNT +     \
+   ((IREE_HAL_CACHING_ALLOCATOR_MAX_CLASS_LOG2 -    \
+     IREE_HAL_CACHING_ALLOCATOR_SMALL_CLASS_LOG2)   \
+    << IREE_HAL_CACHING_ALLOCATOR_SECOND_LEVEL_LOG2))
+
+// Selects the size class bin for an allocation of |size| bytes and returns the
+// rounded up size of the class in |out_class_size|. Returns false if the size
+// is too large to be cached.
+static bool iree_hal_caching_allocator_select_bin(
+    iree_device_size_t size, iree_host_size_t* out_bin,
+    iree_device_size_t* out_class_size) {
+  uint64_t class_size = 0;
+  if (size <= (1ull << IREE_HAL_CACHING_ALLOCATOR_SMALL_CLASS_LOG2)) {
+    // Small sizes use power-of-two classes.
+    class_size = iree_math_round_up_to_pow2_u64(iree_max(
+        (uint64_t)size, 1ull << IREE_HAL_CACHING_ALLOCATOR_MIN_CLASS_LOG2));
+    *out_bin = iree_math_count_trailing_zeros_u64(class_size) -
+               IREE_HAL_CACHING_ALLOCATOR_MIN_CLASS_LOG2;
+    *out_class_size = (iree_device_size_t)class_size;
+    return true;
+  }
+
+  // Large sizes are rounded up to the next second-level subdivision of their
+  // power of two. Rounding may carry into the next power of two.
+  int first_level = 63 - iree_math_count_leading_zeros_u64((uint64_t)size);
+  uint64_t step =
+      1ull << (first_level - IREE_HAL_CACHING_ALLOCATOR_SECOND_LEVEL_LOG2);
+  class_size = ((uint64_t)size + step - 1) & ~(step - 1);
+  first_level = 63 - iree_math_count_leading_zeros_u64(class_size);
+  if (first_level >= IREE_HAL_CACHING_ALLOCATOR_MAX_CLASS_LOG2 ||
+      class_size > (uint64_t)IREE_DEVICE_SIZE_MAX) {
+    return false;
+  }
+  uint64_t second_level =
+      (class_size >>
+       (first_level - IREE_HAL_CACHING_ALLOCATOR_SECOND_LEVEL_LOG2)) &
+      ((1ull << IREE_HAL_CACHING_ALLOCATOR_SECOND_LEVEL_LOG2) - 1);
+  *out_bin = IREE_HAL_CACHING_ALLOCATOR_SMALL_BIN_COUNT +
+             ((first_level - IREE_HAL_CACHING_ALLOCATOR_SMALL_CLASS_LOG2)
+              << IREE_HAL_CACHING_ALLOCATOR_SECOND_LEVEL_LOG2) +
+             (iree_host_size_t)second_level;
+  *out_class_size = (iree_device_size_t)class_size;
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_caching_allocator_t
+//===----------------------------------------------------------------------===//
+
+// Maximum number of characters of the allocation site names retained for
+// reused buffers. Longer names are truncated.
+#define IREE_HAL_CACHING_ALLOCATOR_SITE_NAME_CAPACITY 64
+
+// A released buffer retained in a size class bin or an outstanding reused
+// buffer whose allocation site differs from the one the delegate recorded.
+typedef struct iree_hal_caching_allocator_entry_t {
+  struct iree_hal_caching_allocator_entry_t* next;
+  iree_hal_buffer_t* buffer;
+  // Site of the allocation that reused |buffer|; only valid while the entry
+  // is in one of the |reused| lists.
+  uint64_t site_offset;
+  uint8_t site_function_name_length;
+  uint8_t site_module_name_length;
+  // [function_name][module_name] without NUL terminators.
+  char site_names[IREE_HAL_CACHING_ALLOCATOR_SITE_NAME_CAPACITY];
+} iree_hal_caching_allocator_entry_t;
+
+typedef struct iree_hal_caching_allocator_t {
+  iree_hal_resource_t resource;
+  iree_allocator_t host_allocator;
+  iree_hal_allocator_t* delegate_allocator;
+  iree_hal_caching_allocator_options_t options;
+
+  // Guards the cache state below.
+  iree_slim_mutex_t mutex;
+  // Total allocation size of all buffers in |bins|.
+  iree_device_size_t cached_bytes;
+  // Portion of |cached_bytes| in host-local memory as classified by
+  // iree_hal_allocator_statistics_record_alloc.
+  iree_device_size_t cached_host_bytes;
+  // Entries not currently holding a buffer that can be reused.
+  iree_hal_caching_allocator_entry_t* free_entries;
+  // Cached buffers by size class with the most recently released first.
+  iree_hal_caching_allocator_entry_t*
+      bins[IREE_HAL_CACHING_ALLOCATOR_BIN_COUNT];
+  // Outstanding reused buffers by size class that were allocated with a site.
+  // Used to attribute live buffers to the allocation that reused them instead
+  // of the one that originally allocated them from the delegate.
+  iree_hal_caching_allocator_entry_t*
+      reused[IREE_HAL_CACHING_ALLOCATOR_BIN_COUNT];
+} iree_hal_caching_allocator_t;
+
+static const iree_hal_allocator_vtable_t iree_hal_caching_allocator_vtable;
+
+static iree_hal_caching_allocator_t* iree_hal_caching_allocator_cast(
+    iree_hal_allocator_t* IREE_RESTRICT base_value) {
+  return (iree_hal_caching_allocator_t*)base_value;
+}
+
+IREE_API_EXPORT void iree_hal_caching_allocator_options_initialize(
+    iree_hal_caching_allocator_options_t* out_options) {
+  memset(out_options, 0, sizeof(*out_options));
+  out_options->max_cached_bytes =
+      IREE_HAL_CACHING_ALLOCATOR_DEFAULT_MAX_CACHED_BYTES;
+  out_options->max_buffer_size =
+      IREE_HAL_CACHING_ALLOCATOR_DEFAULT_MAX_CACHED_BYTES;
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_caching_allocator_create(
+    iree_hal_allocator_t* delegate_allocator,
+    const iree_hal_caching_allocator_options_t* options,
+    iree_allocator_t host_allocator, iree_hal_allocator_t** out_allocator) {
+  IREE_ASSERT_ARGUMENT(delegate_allocator);
+  IREE_ASSERT_ARGUMENT(options);
+  IREE_ASSERT_ARGUMENT(out_allocator);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  *out_allocator = NULL;
+
+  iree_hal_caching_allocator_t* allocator = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      host_allocator, sizeof(*allocator), (void**)&allocator);
+  if (iree_status_is_ok(status)) {
+    memset(allocator, 0, sizeof(*allocator));
+    iree_hal_resource_initialize(&iree_hal_caching_allocator_vtable,
+                                 &allocator->resource);
+    allocator->host_allocator = host_allocator;
+    allocator->delegate_allocator = delegate_allocator;
+    iree_hal_allocator_retain(delegate_allocator);
+    allocator->options = *options;
+    iree_slim_mutex_initialize(&allocator->mutex);
+    *out_allocator = (iree_hal_allocator_t*)allocator;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Adds (if |cached|) or removes the size of |buffer| to the cached byte
+// counters. Must be called with the mutex held.
+static void iree_hal_caching_allocator_account_cached(
+    iree_hal_caching_allocator_t* allocator, const iree_hal_buffer_t* buffer,
+    bool cached) {
+  const iree_device_size_t size = buffer->allocation_size;
+  const bool is_host =
+      iree_all_bits_set(buffer->memory_type, IREE_HAL_MEMORY_TYPE_HOST_LOCAL);
+  if (cached) {
+    allocator->cached_bytes += size;
+    if (is_host) allocator->cached_host_bytes += size;
+  } else {
+    allocator->cached_bytes -= size;
+    if (is_host) allocator->cached_host_bytes -= size;
+  }
+}
+
+// Returns a buffer that was allocated through the caching allocator back to
+// the delegate allocator.
+static void iree_hal_caching_allocator_return_buffer(
+    iree_hal_caching_allocator_t* allocator, iree_hal_buffer_t* buffer) {
+  buffer->device_allocator = allocator->delegate_allocator;
+  iree_hal_allocator_deallocate_buffer(allocator->delegate_allocator, buffer);
+}
+
+// Returns all cached buffers to the delegate allocator.
+static void iree_hal_caching_allocator_flush(
+    iree_hal_caching_allocator_t* allocator) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Detach all buffers under the lock and return them outside of it as the
+  // delegate may take its own locks.
+  iree_hal_caching_allocator_entry_t* flushed_entries = NULL;
+  iree_slim_mutex_lock(&allocator->mutex);
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(allocator->bins); ++i) {
+    while (allocator->bins[i]) {
+      iree_hal_caching_allocator_entry_t* entry = allocator->bins[i];
+      allocator->bins[i] = entry->next;
+      entry->next = flushed_entries;
+      flushed_entries = entry;
+    }
+  }
+  allocator->cached_bytes = 0;
+  allocator->cached_host_bytes = 0;
+  iree_slim_mutex_unlock(&allocator->mutex);
+
+  iree_hal_caching_allocator_entry_t* last_entry = NULL;
+  for (iree_hal_caching_allocator_entry_t* entry = flushed_entries; entry;
+       entry = entry->next) {
+    iree_hal_caching_allocator_return_buffer(allocator, entry->buffer);
+    entry->buffer = NULL;
+    last_entry = entry;
+  }
+  if (last_entry) {
+    iree_slim_mutex_lock(&allocator->mutex);
+    last_entry->next = allocator->free_entries;
+    allocator->free_entries = flushed_entries;
+    iree_slim_mutex_unlock(&allocator->mutex);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static void iree_hal_caching_allocator_destroy(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_caching_allocator_t* allocator =
+      iree_hal_caching_allocator_cast(base_allocator);
+  iree_allocator_t host_allocator = allocator->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_caching_allocator_flush(allocator);
+  while (allocator->free_entries) {
+    iree_hal_caching_allocator_entry_t* entry = allocator->free_entries;
+    allocator->free_entries = entry->next;
+    iree_allocator_free(host_allocator, entry);
+  }
+
+  iree_slim_mutex_deinitialize(&allocator->mutex);
+  iree_hal_allocator_release(allocator->delegate_allocator);
+  iree_allocator_free(host_allocator, allocator);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_allocator_t iree_hal_caching_allocator_host_allocator(
+    const iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_caching_allocator_t* allocator =
+      (iree_hal_caching_allocator_t*)base_allocator;
+  return allocator->host_allocator;
+}
+
+static iree_status_t iree_hal_caching_allocator_trim(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_caching_allocator_t* allocator =
+      iree_hal_caching_allocator_cast(base_allocator);
+  iree_hal_caching_allocator_flush(allocator);
+  return iree_hal_allocator_trim(allocator->delegate_allocator);
+}
+
+static void iree_hal_caching_allocator_query_statistics(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_allocator_statistics_t* IREE_RESTRICT out_statistics) {
+  iree_hal_caching_allocator_t* allocator =
+      iree_hal_caching_allocator_cast(base_allocator);
+  iree_hal_allocator_query_statistics(allocator->delegate_allocator,
+                                      out_statistics);
+  IREE_STATISTICS({
+    iree_slim_mutex_lock(&allocator->mutex);
+    out_statistics->host_bytes_cached += allocator->cached_host_bytes;
+    out_statistics->device_bytes_cached +=
+        allocator->cached_bytes - allocator->cached_host_bytes;
+    iree_slim_mutex_unlock(&allocator->mutex);
+  });
+}
+
+static iree_hal_buffer_compatibility_t
+iree_hal_caching_allocator_query_compatibility(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size) {
+  iree_hal_caching_allocator_t* allocator =
+      iree_hal_caching_allocator_cast(base_allocator);
+  return iree_hal_allocator_query_compatibility(allocator->delegate_allocator,
+                                                *params, allocation_size);
+}
+
+// Returns true if a cached |buffer| can satisfy an allocation with |params|.
+// Delegates may round allocation sizes up such that a buffer lands in a larger
+// class than requested and so the size is checked as well.
+static bool iree_hal_caching_allocator_is_compatible(
+    const iree_hal_buffer_t* buffer,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size) {
+  return buffer->allocation_size >= allocation_size &&
+         iree_all_bits_set(buffer->memory_type, params->type) &&
+         iree_all_bits_set(buffer->allowed_usage, params->usage) &&
+         buffer->allowed_access == params->access;
+}
+
+// Records |site| in |entry| truncating the names to the entry capacity.
+static void iree_hal_caching_allocator_entry_set_site(
+    iree_hal_caching_allocator_entry_t* entry,
+    const iree_hal_allocation_site_t* site) {
+  iree_host_size_t function_name_length =
+      iree_min(site->function_name.size,
+               IREE_HAL_CACHING_ALLOCATOR_SITE_NAME_CAPACITY);
+  iree_host_size_t module_name_length =
+      iree_min(site->module_name.size,
+               IREE_HAL_CACHING_ALLOCATOR_SITE_NAME_CAPACITY -
+                   function_name_length);
+  memcpy(entry->site_names, site->function_name.data, function_name_length);
+  memcpy(entry->site_names + function_name_length, site->module_name.data,
+         module_name_length);
+  entry->site_function_name_length = (uint8_t)function_name_length;
+  entry->site_module_name_length = (uint8_t)module_name_length;
+  entry->site_offset = site->offset;
+}
+
+// Removes the entry tracking |buffer| from |list| and returns it, or NULL if
+// the buffer is not in the list. Must be called with the mutex held.
+static iree_hal_caching_allocator_entry_t*
+iree_hal_caching_allocator_unlink_entry(
+    iree_hal_caching_allocator_entry_t** list,
+    const iree_hal_buffer_t* buffer) {
+  for (iree_hal_caching_allocator_entry_t** entry_ptr = list; *entry_ptr;
+       entry_ptr = &(*entry_ptr)->next) {
+    iree_hal_caching_allocator_entry_t* entry = *entry_ptr;
+    if (entry->buffer == buffer) {
+      *entry_ptr = entry->next;
+      entry->next = NULL;
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+// Removes a buffer compatible with |params| from |bin| and returns it, or NULL
+// if no cached buffer is compatible. If the allocation has a |params->site|
+// the entry is kept in the |reused| list to attribute the buffer to it.
+static iree_hal_buffer_t* iree_hal_caching_allocator_take_buffer(
+    iree_hal_caching_allocator_t* allocator, iree_host_size_t bin,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size) {
+  iree_hal_buffer_t* buffer = NULL;
+  iree_slim_mutex_lock(&allocator->mutex);
+  iree_hal_caching_allocator_entry_t** entry_ptr = &allocator->bins[bin];
+  while (*entry_ptr) {
+    iree_hal_caching_allocator_entry_t* entry = *entry_ptr;
+    if (iree_hal_caching_allocator_is_compatible(entry->buffer, params,
+                                                 allocation_size)) {
+      buffer = entry->buffer;
+      iree_hal_caching_allocator_account_cached(allocator, buffer,
+                                                /*cached=*/false);
+      *entry_ptr = entry->next;
+      if (params->site) {
+        iree_hal_caching_allocator_entry_set_site(entry, params->site);
+        entry->next = allocator->reused[bin];
+        allocator->reused[bin] = entry;
+      } else {
+        entry->buffer = NULL;
+        entry->next = allocator->free_entries;
+        allocator->free_entries = entry;
+      }
+      break;
+    }
+    entry_ptr = &entry->next;
+  }
+  iree_slim_mutex_unlock(&allocator->mutex);
+  return buffer;
+}
+
+static iree_status_t iree_hal_caching_allocator_allocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size, iree_const_byte_span_t initial_data,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_caching_allocator_t* allocator =
+      iree_hal_caching_allocator_cast(base_allocator);
+
+  // Buffers that can never be cached are owned entirely by the delegate.
+  iree_host_size_t bin = 0;
+  iree_device_size_t class_size = 0;
+  if (allocation_size > allocator->options.max_buffer_size ||
+      !iree_hal_caching_allocator_select_bin(allocation_size, &bin,
+                                             &class_size)) {
+    return iree_hal_allocator_allocate_buffer(allocator->delegate_allocator,
+                                              *params, allocation_size,
+                                              initial_data, out_buffer);
+  }
+
+  // Reuse a cached buffer if possible. Cached buffers have undefined contents
+  // and may not satisfy the requested alignment so we only use them when
+  // neither was requested.
+  iree_hal_buffer_t* buffer = NULL;
+  if (iree_const_byte_span_is_empty(initial_data) &&
+      params->min_alignment == 0) {
+    buffer = iree_hal_caching_allocator_take_buffer(allocator, bin, params,
+                                                    allocation_size);
+  }
+  if (buffer) {
+    IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_hal_caching_allocator_reuse");
+    iree_atomic_ref_count_init(&buffer->resource.ref_count);
+    buffer->byte_length = allocation_size;
+    iree_hal_allocator_retain(base_allocator);
+    *out_buffer = buffer;
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+
+  // Allocate the full size class so that the buffer can be reused by any
+  // allocation in the class. If the delegate is out of memory we release all
+  // cached buffers and try again.
+  iree_status_t status = iree_hal_allocator_allocate_buffer(
+      allocator->delegate_allocator, *params, class_size, initial_data,
+      &buffer);
+  if (iree_status_is_resource_exhausted(status)) {
+    iree_slim_mutex_lock(&allocator->mutex);
+    bool has_cached_buffers = allocator->cached_bytes > 0;
+    iree_slim_mutex_unlock(&allocator->mutex);
+    if (has_cached_buffers) {
+      iree_status_ignore(status);
+      iree_hal_caching_allocator_flush(allocator);
+      status = iree_hal_allocator_allocate_buffer(
+          allocator->delegate_allocator, *params, class_size, initial_data,
+          &buffer);
+    }
+  }
+  IREE_RETURN_IF_ERROR(status);
+
+  // Route the buffer back to us when it is released. Each buffer retains the
+  // allocator so that it remains live as long as it may receive buffers.
+  buffer->device_allocator = base_allocator;
+  iree_hal_allocator_retain(base_allocator);
+  buffer->byte_length = allocation_size;
+  *out_buffer = buffer;
+  return iree_ok_status();
+}
+
+static void iree_hal_caching_allocator_deallocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_t* IREE_RESTRICT buffer) {
+  iree_hal_caching_allocator_t* allocator =
+      iree_hal_caching_allocator_cast(base_allocator);
+
+  // Buffers are allocated with the full size of their class.
+  iree_host_size_t bin = 0;
+  iree_device_size_t class_size = 0;
+  if (!iree_hal_caching_allocator_select_bin(buffer->allocation_size, &bin,
+                                             &class_size)) {
+    iree_hal_caching_allocator_return_buffer(allocator, buffer);
+    iree_hal_allocator_release(base_allocator);
+    return;
+  }
+
+  // The buffer is no longer outstanding so any entry tracking the site that
+  // reused it is freed (and most likely immediately used to cache it).
+  bool cached = false;
+  iree_slim_mutex_lock(&allocator->mutex);
+  iree_hal_caching_allocator_entry_t* reused_entry =
+      iree_hal_caching_allocator_unlink_entry(&allocator->reused[bin], buffer);
+  if (reused_entry) {
+    reused_entry->buffer = NULL;
+    reused_entry->next = allocator->free_entries;
+    allocator->free_entries = reused_entry;
+  }
+
+  // Retain the buffer if it fits under the high-water mark. New entries are
+  // only allocated when none are free; they are kept for reuse until destroy.
+  if (allocator->cached_bytes + buffer->allocation_size <=
+      allocator->options.max_cached_bytes) {
+    iree_hal_caching_allocator_entry_t* entry = allocator->free_entries;
+    if (entry) {
+      allocator->free_entries = entry->next;
+    } else {
+      iree_status_t status = iree_allocator_malloc(
+          allocator->host_allocator, sizeof(*entry), (void**)&entry);
+      if (!iree_status_is_ok(status)) {
+        iree_status_ignore(status);
+        entry = NULL;
+      }
+    }
+    if (entry) {
+      entry->buffer = buffer;
+      entry->next = allocator->bins[bin];
+      allocator->bins[bin] = entry;
+      iree_hal_caching_allocator_account_cached(allocator, buffer,
+                                                /*cached=*/true);
+      cached = true;
+    }
+  }
+  iree_slim_mutex_unlock(&allocator->mutex);
+
+  if (!cached) {
+    iree_hal_caching_allocator_return_buffer(allocator, buffer);
+  }
+
+  // Drop the reference the buffer held; this may destroy the allocator and
+  // return all cached buffers to the delegate.
+  iree_hal_allocator_release(base_allocator);
+}
+
+static iree_status_t iree_hal_caching_allocator_import_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_hal_external_buffer_t* IREE_RESTRICT external_buffer,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_caching_allocator_t* allocator =
+      iree_hal_caching_allocator_cast(base_allocator);
+  return iree_hal_allocator_import_buffer(allocator->delegate_allocator,
+                                          *params, external_buffer,
+                                          release_callback, out_buffer);
+}
+
+static iree_status_t iree_hal_caching_allocator_export_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_t* IREE_RESTRICT buffer,
+    iree_hal_external_buffer_type_t requested_type,
+    iree_hal_external_buffer_flags_t requested_flags,
+    iree_hal_external_buffer_t* IREE_RESTRICT out_external_buffer) {
+  iree_hal_caching_allocator_t* allocator =
+      iree_hal_caching_allocator_cast(base_allocator);
+  return iree_hal_allocator_export_buffer(allocator->delegate_allocator,
+                                          buffer, requested_type,
+                                          requested_flags, out_external_buffer);
+}
+
+// A copy of the cache state of a buffer taken for live buffer enumeration.
+typedef struct iree_hal_caching_allocator_snapshot_t {
+  const iree_hal_buffer_t* buffer;
+  // Cached buffers are not live and are skipped.
+  bool is_cached;
+  // Site of the allocation that reused the buffer if not cached.
+  uint64_t site_offset;
+  uint8_t site_function_name_length;
+  uint8_t site_module_name_length;
+  char site_names[IREE_HAL_CACHING_ALLOCATOR_SITE_NAME_CAPACITY];
+} iree_hal_caching_allocator_snapshot_t;
+
+static int iree_hal_caching_allocator_snapshot_compare(const void* a,
+                                                       const void* b) {
+  uintptr_t buffer_a =
+      (uintptr_t)((const iree_hal_caching_allocator_snapshot_t*)a)->buffer;
+  uintptr_t buffer_b =
+      (uintptr_t)((const iree_hal_caching_allocator_snapshot_t*)b)->buffer;
+  return buffer_a < buffer_b ? -1 : (buffer_a > buffer_b ? 1 : 0);
+}
+
+// Copies the state of all cached and reused buffers into a list sorted by
+// buffer that is returned in |out_snapshots| and must be freed by the caller.
+static iree_status_t iree_hal_caching_allocator_snapshot(
+    iree_hal_caching_allocator_t* allocator, iree_host_size_t* out_count,
+    iree_hal_caching_allocator_snapshot_t** out_snapshots) {
+  *out_count = 0;
+  *out_snapshots = NULL;
+  iree_slim_mutex_lock(&allocator->mutex);
+  iree_host_size_t count = 0;
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(allocator->bins); ++i) {
+    for (iree_hal_caching_allocator_entry_t* entry = allocator->bins[i]; entry;
+         entry = entry->next) {
+      ++count;
+    }
+    for (iree_hal_caching_allocator_entry_t* entry = allocator->reused[i];
+         entry; entry = entry->next) {
+      ++count;
+    }
+  }
+  iree_hal_caching_allocator_snapshot_t* snapshots = NULL;
+  iree_status_t status = iree_ok_status();
+  if (count > 0) {
+    status = iree_allocator_malloc(allocator->host_allocator,
+                                   count * sizeof(*snapshots),
+                                   (void**)&snapshots);
+  }
+  iree_host_size_t index = 0;
+  for (iree_host_size_t i = 0;
+       iree_status_is_ok(status) && i < IREE_ARRAYSIZE(allocator->bins); ++i) {
+    for (iree_hal_caching_allocator_entry_t* entry = allocator->bins[i]; entry;
+         entry = entry->next) {
+      iree_hal_caching_allocator_snapshot_t* snapshot = &snapshots[index++];
+      memset(snapshot, 0, sizeof(*snapshot));
+      snapshot->buffer = entry->buffer;
+      snapshot->is_cached = true;
+    }
+    for (iree_hal_caching_allocator_entry_t* entry = allocator->reused[i];
+         entry; entry = entry->next) {
+      iree_hal_caching_allocator_snapshot_t* snapshot = &snapshots[index++];
+      snapshot->buffer = entry->buffer;
+      snapshot->is_cached = false;
+      snapshot->site_offset = entry->site_offset;
+      snapshot->site_function_name_length = entry->site_function_name_length;
+      snapshot->site_module_name_length = entry->site_module_name_length;
+      memcpy(snapshot->site_names, entry->site_names,
+             sizeof(snapshot->site_names));
+    }
+  }
+  iree_slim_mutex_unlock(&allocator->mutex);
+  if (!iree_status_is_ok(status)) return status;
+
+  qsort(snapshots, count, sizeof(*snapshots),
+        iree_hal_caching_allocator_snapshot_compare);
+  *out_count = count;
+  *out_snapshots = snapshots;
+  return iree_ok_status();
+}
+
+typedef struct iree_hal_caching_allocator_enumerate_state_t {
+  iree_host_size_t snapshot_count;
+  const iree_hal_caching_allocator_snapshot_t* snapshots;
+  iree_hal_allocator_live_buffer_callback_t callback;
+} iree_hal_caching_allocator_enumerate_state_t;
+
+// Filters the live buffers reported by the delegate: cached buffers are not
+// live and reused buffers are attributed to the site that reused them.
+static iree_status_t iree_hal_caching_allocator_filter_live_buffer(
+    void* user_data, const iree_hal_allocator_live_buffer_t* live_buffer) {
+  iree_hal_caching_allocator_enumerate_state_t* state =
+      (iree_hal_caching_allocator_enumerate_state_t*)user_data;
+  iree_hal_caching_allocator_snapshot_t key;
+  key.buffer = live_buffer->buffer;
+  const iree_hal_caching_allocator_snapshot_t* snapshot =
+      state->snapshot_count > 0
+          ? (const iree_hal_caching_allocator_snapshot_t*)bsearch(
+                &key, state->snapshots, state->snapshot_count,
+                sizeof(*state->snapshots),
+                iree_hal_caching_allocator_snapshot_compare)
+          : NULL;
+  if (!snapshot) {
+    return state->callback.fn(state->callback.user_data, live_buffer);
+  } else if (snapshot->is_cached) {
+    return iree_ok_status();
+  }
+  iree_hal_allocator_live_buffer_t reused_buffer = *live_buffer;
+  reused_buffer.site.function_name = iree_make_string_view(
+      snapshot->site_names, snapshot->site_function_name_length);
+  reused_buffer.site.module_name = iree_make_string_view(
+      snapshot->site_names + snapshot->site_function_name_length,
+      snapshot->site_module_name_length);
+  reused_buffer.site.offset = snapshot->site_offset;
+  return state->callback.fn(state->callback.user_data, &reused_buffer);
+}
+
+static iree_status_t iree_hal_caching_allocator_enumerate_live_buffers(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_allocator_live_buffer_callback_t callback) {
+  iree_hal_caching_allocator_t* allocator =
+      iree_hal_caching_allocator_cast(base_allocator);
+
+  // The cache state is copied such that the callback is not called with the
+  // mutex held: it may allocate or release buffers through this allocator.
+  // Buffers cached or reused after the copy is taken are reported as the
+  // delegate reports them.
+  iree_hal_caching_allocator_enumerate_state_t state = {
+      .callback = callback,
+  };
+  iree_hal_caching_allocator_snapshot_t* snapshots = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_caching_allocator_snapshot(
+      allocator, &state.snapshot_count, &snapshots));
+  state.snapshots = snapshots;
+  iree_hal_allocator_live_buffer_callback_t filter_callback = {
+      .fn = iree_hal_caching_allocator_filter_live_buffer,
+      .user_data = &state,
+  };
+  iree_status_t status = iree_hal_allocator_enumerate_live_buffers(
+      allocator->delegate_allocator, filter_callback);
+  iree_allocator_free(allocator->host_allocator, snapshots);
+  return status;
+}
+
+static const iree_hal_allocator_vtable_t iree_hal_caching_allocator_vtable = {
+    .destroy = iree_hal_caching_allocator_destroy,
+    .host_allocator = iree_hal_caching_allocator_host_allocator,
+    .trim = iree_hal_caching_allocator_trim,
+    .query_statistics = iree_hal_caching_allocator_query_statistics,
+    .query_compatibility = iree_hal_caching_allocator_query_compatibility,
+    .allocate_buffer = iree_hal_caching_allocator_allocate_buffer,
+    .deallocate_buffer = iree_hal_caching_allocator_deallocate_buffer,
+    .import_buffer = iree_hal_caching_allocator_import_buffer,
+    .export_buffer = iree_hal_caching_allocator_export_buffer,
+    .enumerate_live_buffers = iree_hal_caching_allocator_enumerate_live_buffers,
+};
@@ -0,0 +1,75 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_UTILS_CACHING_ALLOCATOR_H_
+#define IREE_HAL_UTILS_CACHING_ALLOCATOR_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_hal_caching_allocator_t
+//===----------------------------------------------------------------------===//
+
+// Default maximum number of bytes of released buffers retained for reuse.
+#define IREE_HAL_CACHING_ALLOCATOR_DEFAULT_MAX_CACHED_BYTES \
+  (256ull * 1024ull * 1024ull)
+
+// Options controlling which buffers are retained by a caching allocator.
+typedef struct iree_hal_caching_allocator_options_t {
+  // Maximum total bytes of released buffers retained for reuse. Buffers
+  // released while the cache is at this high-water mark are returned to the
+  // delegate allocator immediately.
+  iree_device_size_t max_cached_bytes;
+  // Maximum allocation size of a single buffer that will be cached. Larger
+  // buffers are allocated and freed directly by the delegate allocator.
+  iree_device_size_t max_buffer_size;
+} iree_hal_caching_allocator_options_t;
+
+// Initializes |out_options| to their default values.
+IREE_API_EXPORT void iree_hal_caching_allocator_options_initialize(
+    iree_hal_caching_allocator_options_t* out_options);
+
+// Creates an allocator that caches buffers allocated from |delegate_allocator|
+// when they are released and reuses them for subsequent allocations. This
+// avoids the cost of allocating (and for large buffers page faulting) fresh
+// memory for transient buffers that are allocated and released in a loop.
+//
+// Released buffers are kept whole in a free list per size class and are only
+// reused for allocations in the same class; they are never split or merged.
+// Allocation sizes are rounded up to their class: sizes up to 64KiB use
+// power-of-two classes and larger sizes divide each power of two into 8 equal
+// steps, bounding the rounding waste to 12.5%. Cached buffers are reused for
+// requests with the same memory access and whose memory type and usage are a
+// subset of those of the cached buffer.
+//
+// Allocations with initial data or a minimum alignment bypass the cache
+// lookup. Imported buffers are never cached. iree_hal_allocator_trim returns
+// all cached buffers to the delegate allocator and then trims it.
+//
+// Buffers allocated through the caching allocator retain it until they are
+// released so that the allocator may be released while buffers are still
+// outstanding. The delegate allocator is retained and queries for
+// compatibility, import, export, and statistics are forwarded to it.
+// Statistics reported by the delegate include the cached buffers in the
+// allocated bytes as they remain allocated; the caching allocator reports them
+// separately in host_bytes_cached and device_bytes_cached. Live buffer
+// enumeration skips cached buffers and reports reused buffers with the site of
+// the allocation that reused them.
+IREE_API_EXPORT iree_status_t iree_hal_caching_allocator_create(
+    iree_hal_allocator_t* delegate_allocator,
+    const iree_hal_caching_allocator_options_t* options,
+    iree_allocator_t host_allocator, iree_hal_allocator_t** out_allocator);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_UTILS_CACHING_ALLOCATOR_H_
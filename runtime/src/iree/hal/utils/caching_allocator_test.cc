@@ -0,0 +1,326 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/caching_allocator.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+// Counts the buffer data allocations made by the heap allocator.
+struct DataAllocatorCounts {
+  int malloc_count = 0;
+  int free_count = 0;
+};
+
+static iree_status_t CountingAllocatorCtl(void* self,
+                                          iree_allocator_command_t command,
+                                          const void* params,
+                                          void** inout_ptr) {
+  auto* counts = reinterpret_cast<DataAllocatorCounts*>(self);
+  switch (command) {
+    case IREE_ALLOCATOR_COMMAND_MALLOC:
+    case IREE_ALLOCATOR_COMMAND_CALLOC:
+      ++counts->malloc_count;
+      break;
+    case IREE_ALLOCATOR_COMMAND_FREE:
+      ++counts->free_count;
+      break;
+    default:
+      break;
+  }
+  return iree_allocator_system_ctl(/*self=*/NULL, command, params, inout_ptr);
+}
+
+struct CachingAllocatorTest : public ::testing::Test {
+  iree_allocator_t host_allocator = iree_allocator_system();
+  DataAllocatorCounts counts;
+  iree_hal_allocator_t* heap_allocator = NULL;
+
+  void SetUp() override {
+    iree_allocator_t data_allocator = {&counts, CountingAllocatorCtl};
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("heap"), data_allocator, host_allocator,
+        &heap_allocator));
+  }
+
+  void TearDown() override { iree_hal_allocator_release(heap_allocator); }
+
+  iree_hal_allocator_t* CreateCachingAllocator(
+      iree_device_size_t max_cached_bytes) {
+    iree_hal_caching_allocator_options_t options;
+    iree_hal_caching_allocator_options_initialize(&options);
+    options.max_cached_bytes = max_cached_bytes;
+    iree_hal_allocator_t* allocator = NULL;
+    IREE_CHECK_OK(iree_hal_caching_allocator_create(
+        heap_allocator, &options, host_allocator, &allocator));
+    return allocator;
+  }
+
+  iree_hal_buffer_t* AllocateBuffer(
+      iree_hal_allocator_t* allocator, iree_device_size_t size,
+      const iree_hal_allocation_site_t* site = NULL) {
+    iree_hal_buffer_params_t params = {0};
+    params.type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL;
+    params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+    params.site = site;
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+        allocator, params, size, iree_const_byte_span_empty(), &buffer));
+    return buffer;
+  }
+};
+
+// Tests that a released buffer is reused for an allocation in the same class.
+TEST_F(CachingAllocatorTest, ReuseSameClass) {
+  iree_hal_allocator_t* allocator = CreateCachingAllocator(1024 * 1024);
+
+  iree_hal_buffer_t* buffer0 = AllocateBuffer(allocator, 1000);
+  EXPECT_EQ(iree_hal_buffer_byte_length(buffer0), 1000);
+  EXPECT_EQ(counts.malloc_count, 1);
+  iree_hal_buffer_release(buffer0);
+  EXPECT_EQ(counts.free_count, 0);
+
+  // 1000 and 1024 both round up to the 1024 byte class.
+  iree_hal_buffer_t* buffer1 = AllocateBuffer(allocator, 1024);
+  EXPECT_EQ(buffer1, buffer0);
+  EXPECT_EQ(iree_hal_buffer_byte_length(buffer1), 1024);
+  EXPECT_EQ(counts.malloc_count, 1);
+
+  // The buffer must be fully usable after reuse.
+  IREE_EXPECT_OK(iree_hal_buffer_map_fill(buffer1, 0, IREE_WHOLE_BUFFER,
+                                          "\xCD", 1));
+  iree_hal_buffer_release(buffer1);
+
+  iree_hal_allocator_release(allocator);
+  EXPECT_EQ(counts.free_count, 1);
+}
+
+// Tests that buffers in different size classes are not reused.
+TEST_F(CachingAllocatorTest, DifferentClasses) {
+  iree_hal_allocator_t* allocator = CreateCachingAllocator(1024 * 1024);
+
+  iree_hal_buffer_t* buffer0 = AllocateBuffer(allocator, 1024);
+  iree_hal_buffer_release(buffer0);
+  iree_hal_buffer_t* buffer1 = AllocateBuffer(allocator, 4096);
+  EXPECT_EQ(counts.malloc_count, 2);
+
+  // Large classes are subdivided: 128KiB and 144KiB are different classes.
+  iree_hal_buffer_t* buffer2 = AllocateBuffer(allocator, 128 * 1024);
+  iree_hal_buffer_release(buffer2);
+  iree_hal_buffer_t* buffer3 = AllocateBuffer(allocator, 128 * 1024 + 1);
+  EXPECT_EQ(counts.malloc_count, 4);
+  iree_hal_buffer_release(buffer3);
+  iree_hal_buffer_t* buffer4 = AllocateBuffer(allocator, 140 * 1024);
+  EXPECT_EQ(counts.malloc_count, 4);
+
+  iree_hal_buffer_release(buffer1);
+  iree_hal_buffer_release(buffer4);
+  iree_hal_allocator_release(allocator);
+  EXPECT_EQ(counts.free_count, counts.malloc_count);
+}
+
+// Tests that buffers released above the high-water mark are freed.
+TEST_F(CachingAllocatorTest, MaxCachedBytes) {
+  iree_hal_allocator_t* allocator = CreateCachingAllocator(4096);
+
+  iree_hal_buffer_t* buffer0 = AllocateBuffer(allocator, 4096);
+  iree_hal_buffer_t* buffer1 = AllocateBuffer(allocator, 4096);
+  iree_hal_buffer_release(buffer0);
+  EXPECT_EQ(counts.free_count, 0);
+  iree_hal_buffer_release(buffer1);
+  EXPECT_EQ(counts.free_count, 1);
+
+  iree_hal_allocator_release(allocator);
+  EXPECT_EQ(counts.free_count, 2);
+}
+
+// Tests that trimming returns all cached buffers to the delegate.
+TEST_F(CachingAllocatorTest, Trim) {
+  iree_hal_allocator_t* allocator = CreateCachingAllocator(1024 * 1024);
+
+  iree_hal_buffer_t* buffer0 = AllocateBuffer(allocator, 256);
+  iree_hal_buffer_t* buffer1 = AllocateBuffer(allocator, 300 * 1024);
+  iree_hal_buffer_release(buffer0);
+  iree_hal_buffer_release(buffer1);
+  EXPECT_EQ(counts.free_count, 0);
+
+  IREE_EXPECT_OK(iree_hal_allocator_trim(allocator));
+  EXPECT_EQ(counts.free_count, 2);
+
+  // New allocations must come from the delegate again.
+  iree_hal_buffer_t* buffer2 = AllocateBuffer(allocator, 256);
+  EXPECT_EQ(counts.malloc_count, 3);
+  iree_hal_buffer_release(buffer2);
+
+  iree_hal_allocator_release(allocator);
+  EXPECT_EQ(counts.free_count, 3);
+}
+
+// Tests that cached buffers are reported separately from those in use.
+TEST_F(CachingAllocatorTest, CachedBytesStatistics) {
+  if (!IREE_STATISTICS_ENABLE) {
+    GTEST_SKIP() << "statistics are not enabled";
+  }
+  iree_hal_allocator_t* allocator = CreateCachingAllocator(1024 * 1024);
+  iree_hal_allocator_statistics_t statistics;
+
+  iree_hal_buffer_t* buffer0 = AllocateBuffer(allocator, 1000);
+  iree_hal_allocator_query_statistics(allocator, &statistics);
+  EXPECT_EQ(statistics.host_bytes_allocated, 1024);
+  EXPECT_EQ(statistics.host_bytes_cached, 0);
+
+  // Released buffers remain allocated from the delegate but are cached.
+  iree_hal_buffer_release(buffer0);
+  iree_hal_allocator_query_statistics(allocator, &statistics);
+  EXPECT_EQ(statistics.host_bytes_allocated - statistics.host_bytes_freed,
+            1024);
+  EXPECT_EQ(statistics.host_bytes_cached, 1024);
+  EXPECT_EQ(statistics.device_bytes_cached, 0);
+
+  iree_hal_buffer_t* buffer1 = AllocateBuffer(allocator, 1000);
+  iree_hal_allocator_query_statistics(allocator, &statistics);
+  EXPECT_EQ(statistics.host_bytes_cached, 0);
+  iree_hal_buffer_release(buffer1);
+
+  IREE_EXPECT_OK(iree_hal_allocator_trim(allocator));
+  iree_hal_allocator_query_statistics(allocator, &statistics);
+  EXPECT_EQ(statistics.host_bytes_cached, 0);
+  EXPECT_EQ(statistics.host_bytes_allocated - statistics.host_bytes_freed, 0);
+
+  iree_hal_allocator_release(allocator);
+}
+
+struct LiveBuffer {
+  const iree_hal_buffer_t* buffer;
+  std::string function_name;
+  uint64_t offset;
+};
+
+// Returns the live buffers reported by |allocator|.
+static std::vector<LiveBuffer> EnumerateLiveBuffers(
+    iree_hal_allocator_t* allocator) {
+  std::vector<LiveBuffer> live_buffers;
+  iree_hal_allocator_live_buffer_callback_t callback;
+  callback.fn = +[](void* user_data,
+                    const iree_hal_allocator_live_buffer_t* live_buffer) {
+    reinterpret_cast<std::vector<LiveBuffer>*>(user_data)->push_back(
+        {live_buffer->buffer,
+         std::string(live_buffer->site.function_name.data,
+                     live_buffer->site.function_name.size),
+         live_buffer->site.offset});
+    return iree_ok_status();
+  };
+  callback.user_data = &live_buffers;
+  IREE_CHECK_OK(iree_hal_allocator_enumerate_live_buffers(allocator, callback));
+  return live_buffers;
+}
+
+// Tests that cached buffers are not reported as live and that reused buffers
+// are attributed to the allocation that reused them.
+TEST_F(CachingAllocatorTest, LiveBufferSites) {
+  if (!IREE_STATISTICS_ENABLE) {
+    GTEST_SKIP() << "heap allocator only tracks live buffers with statistics";
+  }
+  iree_hal_allocator_t* allocator = CreateCachingAllocator(1024 * 1024);
+
+  iree_hal_allocation_site_t site0 = {iree_string_view_empty(),
+                                      IREE_SV("site0"), 1};
+  iree_hal_buffer_t* buffer0 = AllocateBuffer(allocator, 1024, &site0);
+  auto live_buffers = EnumerateLiveBuffers(allocator);
+  ASSERT_EQ(live_buffers.size(), 1);
+  EXPECT_EQ(live_buffers[0].buffer, buffer0);
+  EXPECT_EQ(live_buffers[0].function_name, "site0");
+
+  // Cached buffers remain allocated by the delegate but are not live.
+  iree_hal_buffer_release(buffer0);
+  EXPECT_TRUE(EnumerateLiveBuffers(allocator).empty());
+
+  iree_hal_allocation_site_t site1 = {iree_string_view_empty(),
+                                      IREE_SV("site1"), 2};
+  iree_hal_buffer_t* buffer1 = AllocateBuffer(allocator, 1024, &site1);
+  ASSERT_EQ(buffer1, buffer0);
+  live_buffers = EnumerateLiveBuffers(allocator);
+  ASSERT_EQ(live_buffers.size(), 1);
+  EXPECT_EQ(live_buffers[0].function_name, "site1");
+  EXPECT_EQ(live_buffers[0].offset, 2);
+
+  // Reuse without a site falls back to the site recorded by the delegate.
+  iree_hal_buffer_release(buffer1);
+  iree_hal_buffer_t* buffer2 = AllocateBuffer(allocator, 1024);
+  ASSERT_EQ(buffer2, buffer0);
+  live_buffers = EnumerateLiveBuffers(allocator);
+  ASSERT_EQ(live_buffers.size(), 1);
+  EXPECT_EQ(live_buffers[0].function_name, "site0");
+  iree_hal_buffer_release(buffer2);
+
+  iree_hal_allocator_release(allocator);
+  EXPECT_TRUE(EnumerateLiveBuffers(heap_allocator).empty());
+}
+
+// Tests that other threads can reuse cached buffers while live buffers are
+// being enumerated.
+TEST_F(CachingAllocatorTest, EnumerationDoesNotBlockReuse) {
+  if (!IREE_STATISTICS_ENABLE) {
+    GTEST_SKIP() << "heap allocator only tracks live buffers with statistics";
+  }
+  iree_hal_allocator_t* allocator = CreateCachingAllocator(1024 * 1024);
+  iree_hal_buffer_t* live_buffer = AllocateBuffer(allocator, 4096);
+  iree_hal_buffer_release(AllocateBuffer(allocator, 1024));
+
+  struct State {
+    CachingAllocatorTest* test;
+    iree_hal_allocator_t* allocator;
+    std::atomic<bool> reused{false};
+    bool reused_during_callback = false;
+    std::thread thread;
+  } state;
+  state.test = this;
+  state.allocator = allocator;
+  iree_hal_allocator_live_buffer_callback_t callback;
+  callback.fn = +[](void* user_data,
+                    const iree_hal_allocator_live_buffer_t* live_buffer) {
+    auto* state = reinterpret_cast<State*>(user_data);
+    state->thread = std::thread([state]() {
+      iree_hal_buffer_release(
+          state->test->AllocateBuffer(state->allocator, 1024));
+      state->reused = true;
+    });
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!state->reused && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::yield();
+    }
+    state->reused_during_callback = state->reused;
+    return iree_ok_status();
+  };
+  callback.user_data = &state;
+  IREE_ASSERT_OK(
+      iree_hal_allocator_enumerate_live_buffers(allocator, callback));
+  state.thread.join();
+  EXPECT_TRUE(state.reused_during_callback);
+  // The cached buffer was reused rather than allocated from the delegate.
+  EXPECT_EQ(counts.malloc_count, 2);
+
+  iree_hal_buffer_release(live_buffer);
+  iree_hal_allocator_release(allocator);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
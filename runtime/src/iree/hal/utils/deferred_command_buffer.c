@@ -7,6 +7,7 @@
 #include "iree/hal/utils/deferred_command_buffer.h"
 
 #include "iree/base/internal/arena.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/utils/resource_set.h"
 
@@ -25,6 +26,7 @@ typedef enum iree_hal_command_type_e {
   IREE_HAL_CMD_COPY_BUFFER,
   IREE_HAL_CMD_PUSH_CONSTANTS,
   IREE_HAL_CMD_PUSH_DESCRIPTOR_SET,
+  IREE_HAL_CMD_PUSH_DESCRIPTOR_SET_INDIRECT,
   IREE_HAL_CMD_BIND_DESCRIPTOR_SET,
   IREE_HAL_CMD_DISPATCH,
   IREE_HAL_CMD_DISPATCH_INDIRECT,
@@ -52,6 +54,7 @@ typedef struct iree_hal_cmd_header_t {
 
 typedef iree_status_t (*iree_hal_cmd_apply_fn_t)(
     iree_hal_command_buffer_t* target_command_buffer,
+    const iree_hal_buffer_binding_table_t* binding_table,
     iree_hal_cmd_header_t* cmd_header);
 
 //===----------------------------------------------------------------------===//
@@ -132,6 +135,13 @@ static iree_status_t iree_hal_cmd_list_clone_data(iree_hal_cmd_list_t* cmd_list,
 // iree_hal_deferred_command_buffer_t implementation
 //===----------------------------------------------------------------------===//
 
+// Block size of the pool allocated by command buffers created without one.
+#define IREE_HAL_DEFERRED_COMMAND_BUFFER_BLOCK_SIZE (32 * 1024)
+
+// Maximum number of idle device command buffers retained for reuse by bind.
+// Bounds the memory held when a burst of concurrent binds has completed.
+#define IREE_HAL_DEFERRED_COMMAND_BUFFER_IDLE_CAPACITY 4
+
 typedef struct iree_hal_deferred_command_buffer_t {
   iree_hal_command_buffer_t base;
   iree_allocator_t host_allocator;
@@ -142,6 +152,30 @@ typedef struct iree_hal_deferred_command_buffer_t {
 
   // All commands in encoding order.
   iree_hal_cmd_list_t cmd_list;
+
+  // Minimum number of binding table slots required to replay the commands.
+  // Reset on each begin.
+  iree_host_size_t binding_capacity;
+
+  // Block pool used for recording when none was provided on creation.
+  iree_arena_block_pool_t* owned_block_pool;
+
+  // Guards the bind state below. Any number of callers may bind the recorded
+  // commands and submit the results concurrently.
+  iree_slim_mutex_t mutex;
+
+  // Set if the device is unable to create reusable command buffers and each
+  // bind must replay into a new one-shot command buffer.
+  bool bind_requires_one_shot;
+
+  // Empty reusable device command buffers returned by
+  // iree_hal_deferred_command_buffer_unbind and available to the next bind on
+  // the same device. Only the first |idle_count| entries are valid.
+  iree_host_size_t idle_count;
+  struct {
+    iree_hal_device_t* device;
+    iree_hal_command_buffer_t* command_buffer;
+  } idle[IREE_HAL_DEFERRED_COMMAND_BUFFER_IDLE_CAPACITY];
 } iree_hal_deferred_command_buffer_t;
 
 static const iree_hal_command_buffer_vtable_t
@@ -158,19 +192,30 @@ IREE_API_EXPORT iree_status_t iree_hal_deferred_command_buffer_create(
     iree_hal_command_category_t command_categories,
     iree_arena_block_pool_t* block_pool, iree_allocator_t host_allocator,
     iree_hal_command_buffer_t** out_command_buffer) {
-  IREE_ASSERT_ARGUMENT(block_pool);
   IREE_ASSERT_ARGUMENT(out_command_buffer);
   *out_command_buffer = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // The owned block pool is allocated along with the command buffer.
   iree_hal_deferred_command_buffer_t* command_buffer = NULL;
-  iree_status_t status = iree_allocator_malloc(
-      host_allocator, sizeof(*command_buffer), (void**)&command_buffer);
+  iree_host_size_t total_size = sizeof(*command_buffer);
+  if (!block_pool) total_size += sizeof(*block_pool);
+  iree_status_t status = iree_allocator_malloc(host_allocator, total_size,
+                                               (void**)&command_buffer);
   if (iree_status_is_ok(status)) {
     iree_hal_command_buffer_initialize(
         device, mode, command_categories, IREE_HAL_QUEUE_AFFINITY_ANY,
         &iree_hal_deferred_command_buffer_vtable, &command_buffer->base);
     command_buffer->host_allocator = host_allocator;
+    if (!block_pool) {
+      block_pool = (iree_arena_block_pool_t*)((uint8_t*)command_buffer +
+                                              sizeof(*command_buffer));
+      iree_arena_block_pool_initialize(
+          IREE_HAL_DEFERRED_COMMAND_BUFFER_BLOCK_SIZE, host_allocator,
+          block_pool);
+      command_buffer->owned_block_pool = block_pool;
+    }
+    iree_slim_mutex_initialize(&command_buffer->mutex);
     iree_hal_cmd_list_initialize(block_pool, &command_buffer->cmd_list);
 
     status = iree_hal_resource_set_allocate(block_pool,
@@ -186,6 +231,12 @@ IREE_API_EXPORT iree_status_t iree_hal_deferred_command_buffer_create(
   return status;
 }
 
+IREE_API_EXPORT bool iree_hal_deferred_command_buffer_isa(
+    iree_hal_command_buffer_t* command_buffer) {
+  return iree_hal_command_buffer_dyn_cast(
+             command_buffer, &iree_hal_deferred_command_buffer_vtable) != NULL;
+}
+
 static void iree_hal_deferred_command_buffer_destroy(
     iree_hal_command_buffer_t* base_command_buffer) {
   iree_hal_deferred_command_buffer_t* command_buffer =
@@ -193,8 +244,15 @@ static void iree_hal_deferred_command_buffer_destroy(
   iree_allocator_t host_allocator = command_buffer->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  for (iree_host_size_t i = 0; i < command_buffer->idle_count; ++i) {
+    iree_hal_command_buffer_release(command_buffer->idle[i].command_buffer);
+  }
   iree_hal_cmd_list_deinitialize(&command_buffer->cmd_list);
   iree_hal_resource_set_free(command_buffer->resource_set);
+  if (command_buffer->owned_block_pool) {
+    iree_arena_block_pool_deinitialize(command_buffer->owned_block_pool);
+  }
+  iree_slim_mutex_deinitialize(&command_buffer->mutex);
   iree_allocator_free(host_allocator, command_buffer);
 
   IREE_TRACE_ZONE_END(z0);
@@ -215,6 +273,7 @@ static iree_status_t iree_hal_deferred_command_buffer_begin(
       iree_hal_deferred_command_buffer_cast(base_command_buffer);
   iree_hal_cmd_list_reset(&command_buffer->cmd_list);
   iree_hal_resource_set_reset(command_buffer->resource_set);
+  command_buffer->binding_capacity = 0;
   return iree_ok_status();
 }
 
@@ -276,6 +335,7 @@ static iree_status_t iree_hal_deferred_command_buffer_execution_barrier(
 
 static iree_status_t iree_hal_deferred_command_buffer_apply_execution_barrier(
     iree_hal_command_buffer_t* target_command_buffer,
+    const iree_hal_buffer_binding_table_t* binding_table,
     const iree_hal_cmd_execution_barrier_t* cmd) {
   return iree_hal_command_buffer_execution_barrier(
       target_command_buffer, cmd->source_stage_mask, cmd->target_stage_mask,
@@ -311,6 +371,7 @@ static iree_status_t iree_hal_deferred_command_buffer_signal_event(
 
 static iree_status_t iree_hal_deferred_command_buffer_apply_signal_event(
     iree_hal_command_buffer_t* target_command_buffer,
+    const iree_hal_buffer_binding_table_t* binding_table,
     const iree_hal_cmd_signal_event_t* cmd) {
   return iree_hal_command_buffer_signal_event(target_command_buffer, cmd->event,
                                               cmd->source_stage_mask);
@@ -344,6 +405,7 @@ static iree_status_t iree_hal_deferred_command_buffer_reset_event(
 
 static iree_status_t iree_hal_deferred_command_buffer_apply_reset_event(
     iree_hal_command_buffer_t* target_command_buffer,
+    const iree_hal_buffer_binding_table_t* binding_table,
     const iree_hal_cmd_reset_event_t* cmd) {
   return iree_hal_command_buffer_reset_event(target_command_buffer, cmd->event,
                                              cmd->source_stage_mask);
@@ -408,6 +470,7 @@ static iree_status_t iree_hal_deferred_command_buffer_wait_events(
 
 static iree_status_t iree_hal_deferred_command_buffer_apply_wait_events(
     iree_hal_command_buffer_t* target_command_buffer,
+    const iree_hal_buffer_binding_table_t* binding_table,
     const iree_hal_cmd_wait_events_t* cmd) {
   return iree_hal_command_buffer_wait_events(
       target_command_buffer, cmd->event_count,
@@ -441,6 +504,7 @@ static iree_status_t iree_hal_deferred_command_buffer_discard_buffer(
 
 static iree_status_t iree_hal_deferred_command_buffer_apply_discard_buffer(
     iree_hal_command_buffer_t* target_command_buffer,
+    const iree_hal_buffer_binding_table_t* binding_table,
     const iree_hal_cmd_discard_buffer_t* cmd) {
   return iree_hal_command_buffer_discard_buffer(target_command_buffer,
                                                 cmd->buffer);
@@ -486,6 +550,7 @@ static iree_status_t iree_hal_deferred_command_buffer_fill_buffer(
 
 static iree_status_t iree_hal_deferred_command_buffer_apply_fill_buffer(
     iree_hal_command_buffer_t* target_command_buffer,
+    const iree_hal_buffer_binding_table_t* binding_table,
     const iree_hal_cmd_fill_buffer_t* cmd) {
   return iree_hal_command_buffer_fill_buffer(
       target_command_buffer, cmd->target_buffer, cmd->target_offset,
@@ -527,6 +592,7 @@ static iree_status_t iree_hal_deferred_command_buffer_update_buffer(
 
 static iree_status_t iree_hal_deferred_command_buffer_apply_update_buffer(
     iree_hal_command_buffer_t* target_command_buffer,
+    const iree_hal_buffer_binding_table_t* binding_table,
     const iree_hal_cmd_update_buffer_t* cmd) {
   return iree_hal_command_buffer_update_buffer(
       target_command_buffer, cmd->source_buffer, 0, cmd->target_buffer,
@@ -570,6 +636,7 @@ static iree_status_t iree_hal_deferred_command_buffer_copy_buffer(
 
 static iree_status_t iree_hal_deferred_command_buffer_apply_copy_buffer(
     iree_hal_command_buffer_t* target_command_buffer,
+    const iree_hal_buffer_binding_table_t* binding_table,
     const iree_hal_cmd_copy_buffer_t* cmd) {
   return iree_hal_command_buffer_copy_buffer(
       target_command_buffer, cmd->source_buffer, cmd->source_offset,
@@ -610,6 +677,7 @@ static iree_status_t iree_hal_deferred_command_buffer_push_constants(
 
 static iree_status_t iree_hal_deferred_command_buffer_apply_push_constants(
     iree_hal_command_buffer_t* target_command_buffer,
+    const iree_hal_buffer_binding_table_t* binding_table,
     const iree_hal_cmd_push_constants_t* cmd) {
   return iree_hal_command_buffer_push_constants(
       target_command_buffer, cmd->executable_layout, cmd->offset, cmd->values,
@@ -655,12 +723,80 @@ static iree_status_t iree_hal_deferred_command_buffer_push_descriptor_set(
 
 static iree_status_t iree_hal_deferred_command_buffer_apply_push_descriptor_set(
     iree_hal_command_buffer_t* target_command_buffer,
+    const iree_hal_buffer_binding_table_t* binding_table,
     const iree_hal_cmd_push_descriptor_set_t* cmd) {
   return iree_hal_command_buffer_push_descriptor_set(
       target_command_buffer, cmd->executable_layout, cmd->set,
       cmd->binding_count, cmd->bindings);
 }
 
+//===----------------------------------------------------------------------===//
+// IREE_HAL_CMD_PUSH_DESCRIPTOR_SET_INDIRECT
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_cmd_push_descriptor_set_indirect_t {
+  iree_hal_cmd_header_t header;
+  iree_hal_executable_layout_t* executable_layout;
+  uint32_t set;
+  iree_host_size_t binding_count;
+  const uint32_t* buffer_slots;
+  iree_hal_descriptor_set_binding_t bindings[];
+} iree_hal_cmd_push_descriptor_set_indirect_t;
+
+IREE_API_EXPORT iree_status_t
+iree_hal_deferred_command_buffer_push_descriptor_set_indirect(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_executable_layout_t* executable_layout, uint32_t set,
+    iree_host_size_t binding_count,
+    const iree_hal_descriptor_set_binding_t* bindings,
+    const uint32_t* buffer_slots) {
+  iree_hal_deferred_command_buffer_t* command_buffer =
+      iree_hal_deferred_command_buffer_cast(base_command_buffer);
+  iree_hal_cmd_list_t* cmd_list = &command_buffer->cmd_list;
+  IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
+      command_buffer->resource_set, 1, &executable_layout));
+  iree_hal_cmd_push_descriptor_set_indirect_t* cmd = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_cmd_list_append_command(
+      cmd_list, IREE_HAL_CMD_PUSH_DESCRIPTOR_SET_INDIRECT,
+      sizeof(*cmd) + sizeof(cmd->bindings[0]) * binding_count, (void**)&cmd));
+  cmd->executable_layout = executable_layout;
+  cmd->set = set;
+  cmd->binding_count = binding_count;
+  cmd->buffer_slots = NULL;
+  memcpy(cmd->bindings, bindings, sizeof(cmd->bindings[0]) * binding_count);
+  for (iree_host_size_t i = 0; i < binding_count; ++i) {
+    cmd->bindings[i].buffer = NULL;
+    command_buffer->binding_capacity =
+        iree_max(command_buffer->binding_capacity,
+                 (iree_host_size_t)buffer_slots[i] + 1);
+  }
+  if (binding_count > 0) {
+    IREE_RETURN_IF_ERROR(iree_hal_cmd_list_clone_data(
+        cmd_list, buffer_slots, sizeof(buffer_slots[0]) * binding_count,
+        (void**)&cmd->buffer_slots));
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t
+iree_hal_deferred_command_buffer_apply_push_descriptor_set_indirect(
+    iree_hal_command_buffer_t* target_command_buffer,
+    const iree_hal_buffer_binding_table_t* binding_table,
+    const iree_hal_cmd_push_descriptor_set_indirect_t* cmd) {
+  // The binding table capacity is verified once prior to replay so slots are
+  // always in bounds here.
+  iree_hal_descriptor_set_binding_t* bindings =
+      (iree_hal_descriptor_set_binding_t*)iree_alloca(
+          cmd->binding_count * sizeof(iree_hal_descriptor_set_binding_t));
+  memcpy(bindings, cmd->bindings, cmd->binding_count * sizeof(bindings[0]));
+  for (iree_host_size_t i = 0; i < cmd->binding_count; ++i) {
+    bindings[i].buffer = binding_table->buffers[cmd->buffer_slots[i]];
+  }
+  return iree_hal_command_buffer_push_descriptor_set(
+      target_command_buffer, cmd->executable_layout, cmd->set,
+      cmd->binding_count, bindings);
+}
+
 //===----------------------------------------------------------------------===//
 // IREE_HAL_CMD_BIND_DESCRIPTOR_SET
 //===----------------------------------------------------------------------===//
@@ -702,6 +838,7 @@ static iree_status_t iree_hal_deferred_command_buffer_bind_descriptor_set(
 
 static iree_status_t iree_hal_deferred_command_buffer_apply_bind_descriptor_set(
     iree_hal_command_buffer_t* target_command_buffer,
+    const iree_hal_buffer_binding_table_t* binding_table,
     const iree_hal_cmd_bind_descriptor_set_t* cmd) {
   return iree_hal_command_buffer_bind_descriptor_set(
       target_command_buffer, cmd->executable_layout, cmd->set,
@@ -743,6 +880,7 @@ static iree_status_t iree_hal_deferred_command_buffer_dispatch(
 
 static iree_status_t iree_hal_deferred_command_buffer_apply_dispatch(
     iree_hal_command_buffer_t* target_command_buffer,
+    const iree_hal_buffer_binding_table_t* binding_table,
     const iree_hal_cmd_dispatch_t* cmd) {
   return iree_hal_command_buffer_dispatch(
       target_command_buffer, cmd->executable, cmd->entry_point,
@@ -784,6 +922,7 @@ static iree_status_t iree_hal_deferred_command_buffer_dispatch_indirect(
 
 static iree_status_t iree_hal_deferred_command_buffer_apply_dispatch_indirect(
     iree_hal_command_buffer_t* target_command_buffer,
+    const iree_hal_buffer_binding_table_t* binding_table,
     const iree_hal_cmd_dispatch_indirect_t* cmd) {
   return iree_hal_command_buffer_dispatch_indirect(
       target_command_buffer, cmd->executable, cmd->entry_point,
@@ -815,6 +954,8 @@ static const iree_hal_cmd_apply_fn_t iree_hal_cmd_apply_table[] = {
         iree_hal_deferred_command_buffer_apply_push_constants,
     [IREE_HAL_CMD_PUSH_DESCRIPTOR_SET] = (iree_hal_cmd_apply_fn_t)
         iree_hal_deferred_command_buffer_apply_push_descriptor_set,
+    [IREE_HAL_CMD_PUSH_DESCRIPTOR_SET_INDIRECT] = (iree_hal_cmd_apply_fn_t)
+        iree_hal_deferred_command_buffer_apply_push_descriptor_set_indirect,
     [IREE_HAL_CMD_BIND_DESCRIPTOR_SET] = (iree_hal_cmd_apply_fn_t)
         iree_hal_deferred_command_buffer_apply_bind_descriptor_set,
     [IREE_HAL_CMD_DISPATCH] = (iree_hal_cmd_apply_fn_t)
@@ -823,9 +964,27 @@ static const iree_hal_cmd_apply_fn_t iree_hal_cmd_apply_table[] = {
         iree_hal_deferred_command_buffer_apply_dispatch_indirect,
 };
 
+IREE_API_EXPORT iree_host_size_t
+iree_hal_deferred_command_buffer_binding_capacity(
+    iree_hal_command_buffer_t* base_command_buffer) {
+  iree_hal_deferred_command_buffer_t* command_buffer =
+      iree_hal_deferred_command_buffer_cast(base_command_buffer);
+  return command_buffer->binding_capacity;
+}
+
 IREE_API_EXPORT iree_status_t iree_hal_deferred_command_buffer_apply(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_command_buffer_t* target_command_buffer) {
+  return iree_hal_deferred_command_buffer_apply_with_bindings(
+      base_command_buffer, target_command_buffer,
+      iree_hal_buffer_binding_table_empty());
+}
+
+IREE_API_EXPORT iree_status_t
+iree_hal_deferred_command_buffer_apply_with_bindings(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_command_buffer_t* target_command_buffer,
+    iree_hal_buffer_binding_table_t binding_table) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_hal_deferred_command_buffer_t* command_buffer =
@@ -833,11 +992,23 @@ IREE_API_EXPORT iree_status_t iree_hal_deferred_command_buffer_apply(
           base_command_buffer, &iree_hal_deferred_command_buffer_vtable);
   iree_hal_cmd_list_t* cmd_list = &command_buffer->cmd_list;
 
+  // Verify the binding table once up front so that each indirect command can
+  // index into it without checks.
+  if (IREE_UNLIKELY(binding_table.count < command_buffer->binding_capacity)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "binding table has %" PRIhsz
+                            " slots but the command buffer requires %" PRIhsz,
+                            binding_table.count,
+                            command_buffer->binding_capacity);
+  }
+
   iree_status_t status = iree_hal_command_buffer_begin(target_command_buffer);
   if (iree_status_is_ok(status)) {
     for (iree_hal_cmd_header_t* cmd = cmd_list->head; cmd != NULL;
          cmd = cmd->next) {
-      status = iree_hal_cmd_apply_table[cmd->type](target_command_buffer, cmd);
+      status = iree_hal_cmd_apply_table[cmd->type](target_command_buffer,
+                                                   &binding_table, cmd);
       if (!iree_status_is_ok(status)) break;
     }
   }
@@ -859,6 +1030,119 @@ IREE_API_EXPORT iree_status_t iree_hal_deferred_command_buffer_apply(
   return status;
 }
 
+// Returns an empty device command buffer for |device|, either one left idle by
+// a prior unbind or a newly created one.
+static iree_status_t iree_hal_deferred_command_buffer_acquire_target(
+    iree_hal_deferred_command_buffer_t* command_buffer,
+    iree_hal_device_t* device,
+    iree_hal_command_buffer_t** out_target_command_buffer) {
+  iree_slim_mutex_lock(&command_buffer->mutex);
+  for (iree_host_size_t i = command_buffer->idle_count; i > 0; --i) {
+    if (command_buffer->idle[i - 1].device != device) continue;
+    *out_target_command_buffer = command_buffer->idle[i - 1].command_buffer;
+    command_buffer->idle[i - 1] =
+        command_buffer->idle[--command_buffer->idle_count];
+    iree_slim_mutex_unlock(&command_buffer->mutex);
+    return iree_ok_status();
+  }
+  bool requires_one_shot = command_buffer->bind_requires_one_shot;
+  iree_slim_mutex_unlock(&command_buffer->mutex);
+
+  // Devices that only support inline execution (such as local-sync) reject
+  // reusable command buffers. Those get a new one-shot command buffer on each
+  // bind and we remember not to try again.
+  if (!requires_one_shot) {
+    iree_status_t status = iree_hal_command_buffer_create(
+        device, /*mode=*/0, command_buffer->base.allowed_categories,
+        IREE_HAL_QUEUE_AFFINITY_ANY, out_target_command_buffer);
+    if (!iree_status_is_invalid_argument(status)) return status;
+    iree_status_ignore(status);
+    iree_slim_mutex_lock(&command_buffer->mutex);
+    command_buffer->bind_requires_one_shot = true;
+    iree_slim_mutex_unlock(&command_buffer->mutex);
+  }
+  return iree_hal_command_buffer_create(
+      device,
+      IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT |
+          IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION,
+      command_buffer->base.allowed_categories, IREE_HAL_QUEUE_AFFINITY_ANY,
+      out_target_command_buffer);
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_deferred_command_buffer_bind(
+    iree_hal_command_buffer_t* base_command_buffer, iree_hal_device_t* device,
+    iree_hal_buffer_binding_table_t binding_table,
+    iree_hal_command_buffer_t** out_target_command_buffer) {
+  IREE_ASSERT_ARGUMENT(device);
+  IREE_ASSERT_ARGUMENT(out_target_command_buffer);
+  *out_target_command_buffer = NULL;
+  iree_hal_deferred_command_buffer_t* command_buffer =
+      iree_hal_deferred_command_buffer_cast(base_command_buffer);
+
+  if (IREE_UNLIKELY(iree_all_bits_set(command_buffer->base.mode,
+                                      IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT))) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "one-shot command buffers cannot be rebound");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Each bind replays into a device command buffer that no other caller is
+  // using so that concurrent binds and submissions never share one.
+  iree_hal_command_buffer_t* target_command_buffer = NULL;
+  iree_status_t status = iree_hal_deferred_command_buffer_acquire_target(
+      command_buffer, device, &target_command_buffer);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_deferred_command_buffer_apply_with_bindings(
+        base_command_buffer, target_command_buffer, binding_table);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_target_command_buffer = target_command_buffer;
+  } else {
+    iree_hal_command_buffer_release(target_command_buffer);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT void iree_hal_deferred_command_buffer_unbind(
+    iree_hal_command_buffer_t* base_command_buffer, iree_hal_device_t* device,
+    iree_hal_command_buffer_t* target_command_buffer) {
+  if (!target_command_buffer) return;
+  iree_hal_deferred_command_buffer_t* command_buffer =
+      iree_hal_deferred_command_buffer_cast(base_command_buffer);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Reusable command buffers are re-recorded empty to drop the bound buffers
+  // before being kept for the next bind. One-shot command buffers (and any
+  // that fail to reset) are released.
+  bool is_reusable =
+      !iree_all_bits_set(iree_hal_command_buffer_mode(target_command_buffer),
+                         IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT);
+  if (is_reusable) {
+    iree_status_t status = iree_hal_command_buffer_begin(target_command_buffer);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_command_buffer_end(target_command_buffer);
+    }
+    is_reusable = iree_status_is_ok(status);
+    iree_status_ignore(status);
+  }
+  if (is_reusable) {
+    iree_slim_mutex_lock(&command_buffer->mutex);
+    if (command_buffer->idle_count < IREE_ARRAYSIZE(command_buffer->idle)) {
+      command_buffer->idle[command_buffer->idle_count].device = device;
+      command_buffer->idle[command_buffer->idle_count].command_buffer =
+          target_command_buffer;
+      ++command_buffer->idle_count;
+      target_command_buffer = NULL;
+    }
+    iree_slim_mutex_unlock(&command_buffer->mutex);
+  }
+  iree_hal_command_buffer_release(target_command_buffer);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
 static const iree_hal_command_buffer_vtable_t
     iree_hal_deferred_command_buffer_vtable = {
         .destroy = iree_hal_deferred_command_buffer_destroy,
@@ -16,6 +16,22 @@ extern "C" {
 
 typedef struct iree_arena_block_pool_t iree_arena_block_pool_t;
 
+// A table of buffers referenced by slot ordinal from indirect commands recorded
+// into a deferred command buffer. Provided when the command buffer is replayed
+// so that the same recorded commands can be reused with different buffers.
+typedef struct iree_hal_buffer_binding_table_t {
+  // Total number of slots in the table.
+  iree_host_size_t count;
+  // Buffers indexed by slot ordinal. Entries may be NULL if the slot is unused.
+  iree_hal_buffer_t* const* buffers;
+} iree_hal_buffer_binding_table_t;
+
+static inline iree_hal_buffer_binding_table_t
+iree_hal_buffer_binding_table_empty(void) {
+  iree_hal_buffer_binding_table_t table = {0, NULL};
+  return table;
+}
+
 //===----------------------------------------------------------------------===//
 // iree_hal_command_buffer_t deferred record/replay wrapper
 //===----------------------------------------------------------------------===//
@@ -37,7 +53,8 @@ typedef struct iree_arena_block_pool_t iree_arena_block_pool_t;
 // allocations from the system. 16KB, 32KB, and 64KB are reasonable starting
 // points based on system availability.
 // NOTE: the |block_pool| must remain live for the lifetime of the command
-// buffers that use it.
+// buffers that use it. If |block_pool| is NULL the command buffer allocates its
+// own pool that lives as long as it does.
 //
 // After recording iree_hal_deferred_command_buffer_apply can be used to replay
 // the sequence of commands against a target command buffer implementation.
@@ -48,6 +65,32 @@ IREE_API_EXPORT iree_status_t iree_hal_deferred_command_buffer_create(
     iree_arena_block_pool_t* block_pool, iree_allocator_t host_allocator,
     iree_hal_command_buffer_t** out_command_buffer);
 
+// Returns true if |command_buffer| is a deferred command buffer.
+IREE_API_EXPORT bool iree_hal_deferred_command_buffer_isa(
+    iree_hal_command_buffer_t* command_buffer);
+
+// Records a descriptor set push whose buffers are sourced from the binding
+// table provided at replay time. |buffer_slots| has one entry per binding
+// indicating the binding table slot ordinal that provides its buffer; the
+// |bindings| buffer fields are ignored.
+//
+// Command buffers with indirect bindings can only be replayed with
+// iree_hal_deferred_command_buffer_apply_with_bindings and a table containing
+// at least iree_hal_deferred_command_buffer_binding_capacity slots.
+IREE_API_EXPORT iree_status_t
+iree_hal_deferred_command_buffer_push_descriptor_set_indirect(
+    iree_hal_command_buffer_t* command_buffer,
+    iree_hal_executable_layout_t* executable_layout, uint32_t set,
+    iree_host_size_t binding_count,
+    const iree_hal_descriptor_set_binding_t* bindings,
+    const uint32_t* buffer_slots);
+
+// Returns the minimum number of binding table slots required to replay the
+// recorded |command_buffer|. 0 if no indirect commands have been recorded.
+IREE_API_EXPORT iree_host_size_t
+iree_hal_deferred_command_buffer_binding_capacity(
+    iree_hal_command_buffer_t* command_buffer);
+
 // Replays a recorded |command_buffer| against a |target_command_buffer|.
 // If the command buffer was recorded in one-shot mode it will be reset upon
 // return.
@@ -55,6 +98,39 @@ IREE_API_EXPORT iree_status_t iree_hal_deferred_command_buffer_apply(
     iree_hal_command_buffer_t* command_buffer,
     iree_hal_command_buffer_t* target_command_buffer);
 
+// Replays a recorded |command_buffer| against a |target_command_buffer| using
+// |binding_table| to resolve the buffers of indirect commands.
+// If the command buffer was recorded in one-shot mode it will be reset upon
+// return.
+IREE_API_EXPORT iree_status_t
+iree_hal_deferred_command_buffer_apply_with_bindings(
+    iree_hal_command_buffer_t* command_buffer,
+    iree_hal_command_buffer_t* target_command_buffer,
+    iree_hal_buffer_binding_table_t binding_table);
+
+// Returns a |device| command buffer with the commands recorded in a reusable
+// |command_buffer| replayed against |binding_table|. The returned command
+// buffer is owned by the caller until passed to
+// iree_hal_deferred_command_buffer_unbind once all submissions of it have
+// completed.
+//
+// Binding is thread-safe and each call returns a device command buffer that is
+// not in use by any other caller so the same recording may be bound and
+// submitted concurrently. Devices that cannot create reusable command buffers
+// get a new one-shot command buffer on each call.
+IREE_API_EXPORT iree_status_t iree_hal_deferred_command_buffer_bind(
+    iree_hal_command_buffer_t* command_buffer, iree_hal_device_t* device,
+    iree_hal_buffer_binding_table_t binding_table,
+    iree_hal_command_buffer_t** out_target_command_buffer);
+
+// Returns a |target_command_buffer| acquired from
+// iree_hal_deferred_command_buffer_bind with the same |device|. All submissions
+// of it must have completed. The references to the bound buffers are dropped
+// and the device command buffer may be reused by a later bind.
+IREE_API_EXPORT void iree_hal_deferred_command_buffer_unbind(
+    iree_hal_command_buffer_t* command_buffer, iree_hal_device_t* device,
+    iree_hal_command_buffer_t* target_command_buffer);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -46,7 +46,8 @@ class CheckTest : public ::testing::Test {
     IREE_ASSERT_OK(iree_hal_driver_create_default_device(
         hal_driver, iree_allocator_system(), &device_));
     IREE_ASSERT_OK(
-        iree_hal_module_create(device_, iree_allocator_system(), &hal_module_));
+        iree_hal_module_create(device_, IREE_HAL_MODULE_FLAG_NONE,
+                               iree_allocator_system(), &hal_module_));
     iree_hal_driver_release(hal_driver);
 
     IREE_ASSERT_OK(
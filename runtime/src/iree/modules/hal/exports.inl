@@ -49,6 +49,7 @@ EXPORT_FN("command_buffer.begin_debug_group", iree_hal_module_command_buffer_beg
 EXPORT_FN("command_buffer.bind_descriptor_set", iree_hal_module_command_buffer_bind_descriptor_set, rrirCID, v)
 EXPORT_FN("command_buffer.copy_buffer", iree_hal_module_command_buffer_copy_buffer, rrIrII, v)
 EXPORT_FN("command_buffer.create", iree_hal_module_command_buffer_create, rii, r)
+EXPORT_FN("command_buffer.create.reusable", iree_hal_module_command_buffer_create_reusable, rii, r)
 EXPORT_FN("command_buffer.dispatch", iree_hal_module_command_buffer_dispatch, rriiii, v)
 EXPORT_FN("command_buffer.dispatch.indirect", iree_hal_module_command_buffer_dispatch_indirect, rrirI, v)
 EXPORT_FN("command_buffer.end", iree_hal_module_command_buffer_end, r, v)
@@ -57,6 +58,7 @@ EXPORT_FN("command_buffer.execution_barrier", iree_hal_module_command_buffer_exe
 EXPORT_FN("command_buffer.fill_buffer", iree_hal_module_command_buffer_fill_buffer, rrIIii, v)
 EXPORT_FN("command_buffer.push_constants", iree_hal_module_command_buffer_push_constants, rriCiD, v)
 EXPORT_FN("command_buffer.push_descriptor_set", iree_hal_module_command_buffer_push_descriptor_set, rriCirIID, v)
+EXPORT_FN("command_buffer.push_descriptor_set.indirect", iree_hal_module_command_buffer_push_descriptor_set_indirect, rriCiiIID, v)
 
 EXPORT_FN("descriptor_set.create", iree_hal_module_descriptor_set_create, rrCirIID, r)
 
@@ -67,6 +69,7 @@ EXPORT_FN("device.query.i32", iree_hal_module_device_query_i32, rrr, ii)
 
 EXPORT_FN("ex.shared_device", iree_hal_module_ex_shared_device, v, r)
 EXPORT_FN("ex.submit_and_wait", iree_hal_module_ex_submit_and_wait, rr, v)
+EXPORT_FN("ex.submit_and_wait.indirect", iree_hal_module_ex_submit_and_wait_indirect, rrCrD, v)
 
 EXPORT_FN("executable.create", iree_hal_module_executable_create, rrrrCrD, r)
 
@@ -16,12 +16,19 @@
 #include "iree/base/api.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/api.h"
+#include "iree/hal/utils/deferred_command_buffer.h"
 #include "iree/vm/api.h"
 
 // Limit the number of bindings we pass down through the HAL. This can be tuned
 // in the future but right now guards the stack from blowing up during calls.
 #define IREE_HAL_MODULE_MAX_DESCRIPTOR_BINDING_COUNT ((iree_host_size_t)32)
 
+// Limit the number of buffers provided in binding tables when submitting
+// reusable command buffers. Guards the stack as with descriptor bindings.
+#define IREE_HAL_MODULE_MAX_BINDING_TABLE_COUNT ((iree_host_size_t)256)
+
+// Size of the blocks used to record reusable command buffers.
+
 //===----------------------------------------------------------------------===//
 // Type registration
 //===----------------------------------------------------------------------===//
@@ -116,6 +123,7 @@ IREE_VM_DEFINE_TYPE_ADAPTERS(iree_hal_semaphore, iree_hal_semaphore_t);
 
 typedef struct iree_hal_module_t {
   iree_allocator_t host_allocator;
+  iree_hal_module_flags_t flags;
   iree_hal_device_t* shared_device;
   // TODO(benvanik): types.
 } iree_hal_module_t;
@@ -125,6 +133,7 @@ typedef struct iree_hal_module_t {
 
 typedef struct iree_hal_module_state_t {
   iree_allocator_t host_allocator;
+  iree_hal_module_flags_t flags;
   iree_hal_device_t* shared_device;
   iree_status_t loop_status;
   iree_hal_executable_cache_t* executable_cache;
@@ -150,6 +159,7 @@ iree_hal_module_alloc_state(void* self, iree_allocator_t host_allocator,
       iree_allocator_malloc(host_allocator, sizeof(*state), (void**)&state));
   memset(state, 0, sizeof(*state));
   state->host_allocator = host_allocator;
+  state->flags = module->flags;
   state->shared_device = module->shared_device;
   iree_hal_device_retain(state->shared_device);
 
@@ -208,15 +218,10 @@ IREE_VM_ABI_EXPORT(iree_hal_module_ex_shared_device,  //
   return iree_ok_status();
 }
 
-IREE_VM_ABI_EXPORT(iree_hal_module_ex_submit_and_wait,  //
-                   iree_hal_module_state_t,             //
-                   rr, v) {
-  iree_hal_device_t* device = NULL;
-  IREE_RETURN_IF_ERROR(iree_hal_device_check_deref(args->r0, &device));
-  iree_hal_command_buffer_t* command_buffer = NULL;
-  IREE_RETURN_IF_ERROR(
-      iree_hal_command_buffer_check_deref(args->r1, &command_buffer));
-
+// Submits |command_buffer| to |device| and waits for it to complete.
+static iree_status_t iree_hal_module_submit_and_wait(
+    iree_hal_module_state_t* state, iree_hal_device_t* device,
+    iree_hal_command_buffer_t* command_buffer) {
   // Batch with our single command buffer.
   iree_hal_submission_batch_t batch;
   memset(&batch, 0, sizeof(batch));
@@ -232,14 +237,66 @@ IREE_VM_ABI_EXPORT(iree_hal_module_ex_submit_and_wait,  //
   batch.signal_semaphores.semaphores = signal_semaphore_ptrs;
   batch.signal_semaphores.payload_values = signal_semaphore_values;
 
-  iree_status_t status = iree_hal_device_submit_and_wait(
+  return iree_hal_device_submit_and_wait(
       device, IREE_HAL_COMMAND_CATEGORY_ANY, 0, 1, &batch,
       state->submit_semaphore, next_semaphore_value, iree_infinite_timeout());
-  if (!iree_status_is_ok(status)) {
-    return status;
+}
+
+IREE_VM_ABI_EXPORT(iree_hal_module_ex_submit_and_wait,  //
+                   iree_hal_module_state_t,             //
+                   rr, v) {
+  iree_hal_device_t* device = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_device_check_deref(args->r0, &device));
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_command_buffer_check_deref(args->r1, &command_buffer));
+  return iree_hal_module_submit_and_wait(state, device, command_buffer);
+}
+
+IREE_VM_ABI_EXPORT(iree_hal_module_ex_submit_and_wait_indirect,  //
+                   iree_hal_module_state_t,                      //
+                   rrCrD, v) {
+  iree_hal_device_t* device = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_device_check_deref(args->r0, &device));
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_command_buffer_check_deref(args->r1, &command_buffer));
+  if (IREE_UNLIKELY(!iree_hal_deferred_command_buffer_isa(command_buffer))) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "indirect submissions require a reusable command buffer");
   }
 
-  return iree_ok_status();
+  iree_host_size_t binding_count = args->a2_count;
+  if (IREE_UNLIKELY(binding_count > IREE_HAL_MODULE_MAX_BINDING_TABLE_COUNT)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "binding table count %" PRIhsz " > %" PRIhsz,
+                            binding_count,
+                            IREE_HAL_MODULE_MAX_BINDING_TABLE_COUNT);
+  }
+  iree_hal_buffer_t** buffers =
+      (iree_hal_buffer_t**)iree_alloca(binding_count * sizeof(buffers[0]));
+  for (iree_host_size_t i = 0; i < binding_count; ++i) {
+    IREE_RETURN_IF_ERROR(
+        iree_hal_buffer_check_deref(args->a2[i].r0, &buffers[i]));
+  }
+  iree_hal_buffer_binding_table_t binding_table = {
+      .count = binding_count,
+      .buffers = buffers,
+  };
+
+  // The reusable commands are replayed into a device command buffer owned by
+  // this submission. The command buffer may be shared with forked contexts
+  // submitting concurrently and the bind/unbind keeps them from sharing the
+  // device command buffer.
+  iree_hal_command_buffer_t* target_command_buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_deferred_command_buffer_bind(
+      command_buffer, device, binding_table, &target_command_buffer));
+  iree_status_t status =
+      iree_hal_module_submit_and_wait(state, device, target_command_buffer);
+  iree_hal_deferred_command_buffer_unbind(command_buffer, device,
+                                          target_command_buffer);
+  return status;
 }
 
 //===----------------------------------------------------------------------===//
@@ -264,6 +321,25 @@ static iree_device_size_t iree_hal_cast_device_size(int64_t value) {
 // iree_hal_allocator_t
 //===----------------------------------------------------------------------===//
 
+// Populates |out_site| with the VM function calling into the HAL module and
+// returns it for use as the allocation site of buffers allocated on its
+// behalf. Returns NULL if statistics are disabled or the caller is unknown.
+static const iree_hal_allocation_site_t* iree_hal_module_allocation_site(
+    iree_vm_stack_t* stack, iree_hal_allocation_site_t* out_site) {
+#if IREE_STATISTICS_ENABLE
+  // The top frame is the native HAL module function and its parent is the
+  // caller that issued the import call.
+  iree_vm_stack_frame_t* caller_frame = iree_vm_stack_parent_frame(stack);
+  if (!caller_frame || !caller_frame->function.module) return NULL;
+  out_site->module_name = iree_vm_module_name(caller_frame->function.module);
+  out_site->function_name = iree_vm_function_name(&caller_frame->function);
+  out_site->offset = (uint64_t)caller_frame->pc;
+  return out_site;
+#else
+  return NULL;
+#endif  // IREE_STATISTICS_ENABLE
+}
+
 IREE_VM_ABI_EXPORT(iree_hal_module_allocator_allocate,  //
                    iree_hal_module_state_t,             //
                    riiI, r) {
@@ -273,9 +349,11 @@ IREE_VM_ABI_EXPORT(iree_hal_module_allocator_allocate,  //
   iree_hal_buffer_usage_t buffer_usage = (iree_hal_buffer_usage_t)args->i2;
   iree_device_size_t allocation_size = iree_hal_cast_device_size(args->i3);
 
+  iree_hal_allocation_site_t site;
   const iree_hal_buffer_params_t params = {
       .type = memory_types,
       .usage = buffer_usage,
+      .site = iree_hal_module_allocation_site(stack, &site),
   };
   iree_hal_buffer_t* buffer = NULL;
   IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
@@ -309,9 +387,11 @@ IREE_VM_ABI_EXPORT(iree_hal_module_allocator_allocate_initialized,  //
                             offset, (offset + length - 1), buffer_length);
   }
 
+  iree_hal_allocation_site_t site;
   const iree_hal_buffer_params_t params = {
       .type = memory_types,
       .usage = buffer_usage,
+      .site = iree_hal_module_allocation_site(stack, &site),
   };
   iree_hal_buffer_t* buffer = NULL;
   IREE_RETURN_IF_ERROR(
@@ -407,10 +487,41 @@ IREE_VM_ABI_EXPORT(iree_hal_module_allocator_map_byte_buffer,  //
     return iree_ok_status();
   }
 
+  // Allocators reject host memory that does not meet their alignment
+  // requirements with IREE_STATUS_OUT_OF_RANGE (as rodata may be if the module
+  // was not produced with sufficient alignment). Immutable contents cannot be
+  // observed to differ between a mapping and a copy so we copy them instead of
+  // failing or forcing the caller to do so.
+  if (iree_status_is_out_of_range(status) &&
+      iree_all_bits_set(buffer_usage,
+                        IREE_HAL_BUFFER_USAGE_SHARING_IMMUTABLE)) {
+    IREE_TRACE_MESSAGE(WARNING,
+                       "hal.allocator.map.byte_buffer source misaligned; "
+                       "constants will be copied");
+    iree_status_ignore(status);
+    const iree_hal_buffer_params_t copy_params = {
+        .type = memory_types,
+        .usage = buffer_usage,
+    };
+    status = iree_hal_allocator_allocate_buffer(
+        allocator, copy_params, length,
+        iree_make_const_byte_span(source->data.data + offset, length),
+        &buffer);
+    if (iree_status_is_ok(status)) {
+      rets->r0 = iree_hal_buffer_move_ref(buffer);
+      return iree_ok_status();
+    }
+  }
+
   // Failed to map - if this was a try then don't fail and just rely on the
-  // result being nullptr to indicate to the caller that things failed.
+  // result being nullptr to indicate to the caller that things failed. The
+  // caller will fall back to allocating and copying the data so we make the
+  // failure visible in traces.
   memset(&rets->r0, 0, sizeof(rets->r0));
   if (is_try) {
+    IREE_TRACE_MESSAGE(WARNING,
+                       "hal.allocator.map.byte_buffer failed; constants "
+                       "will be copied");
     iree_status_ignore(status);
     return iree_ok_status();
   }
@@ -895,6 +1006,33 @@ IREE_VM_ABI_EXPORT(iree_hal_module_command_buffer_create,  //
   return iree_ok_status();
 }
 
+IREE_VM_ABI_EXPORT(iree_hal_module_command_buffer_create_reusable,  //
+                   iree_hal_module_state_t,                         //
+                   rii, r) {
+  iree_hal_device_t* device = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_device_check_deref(args->r0, &device));
+  iree_hal_command_category_t command_categories =
+      (iree_hal_command_category_t)args->i1;
+  iree_host_size_t binding_capacity = (iree_host_size_t)args->i2;
+  if (IREE_UNLIKELY(binding_capacity >
+                    IREE_HAL_MODULE_MAX_BINDING_TABLE_COUNT)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "binding capacity %" PRIhsz " > %" PRIhsz,
+                            binding_capacity,
+                            IREE_HAL_MODULE_MAX_BINDING_TABLE_COUNT);
+  }
+
+  // Reusable command buffers are recorded once into host memory and replayed
+  // into a device command buffer on each submission. They own their block pool
+  // as they may outlive this state when shared with forked contexts.
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_deferred_command_buffer_create(
+      device, IREE_HAL_COMMAND_BUFFER_MODE_UNVALIDATED, command_categories,
+      /*block_pool=*/NULL, state->host_allocator, &command_buffer));
+  rets->r0 = iree_hal_command_buffer_move_ref(command_buffer);
+  return iree_ok_status();
+}
+
 IREE_VM_ABI_EXPORT(iree_hal_module_command_buffer_begin,  //
                    iree_hal_module_state_t,               //
                    r, v) {
@@ -1055,6 +1193,54 @@ IREE_VM_ABI_EXPORT(iree_hal_module_command_buffer_push_descriptor_set,  //
       command_buffer, executable_layout, set, binding_count, bindings);
 }
 
+IREE_VM_ABI_EXPORT(iree_hal_module_command_buffer_push_descriptor_set_indirect,
+                   iree_hal_module_state_t,  //
+                   rriCiiIID, v) {
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_command_buffer_check_deref(args->r0, &command_buffer));
+  if (IREE_UNLIKELY(!iree_hal_deferred_command_buffer_isa(command_buffer))) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "indirect bindings require a reusable command buffer");
+  }
+  iree_hal_executable_layout_t* executable_layout = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_executable_layout_check_deref(args->r1, &executable_layout));
+  iree_vm_size_t set = args->i2;
+
+  iree_host_size_t binding_count = args->a3_count;
+  if (IREE_UNLIKELY(binding_count >
+                    IREE_HAL_MODULE_MAX_DESCRIPTOR_BINDING_COUNT)) {
+    return iree_make_status(
+        IREE_STATUS_OUT_OF_RANGE, "binding count %" PRIhsz " > %" PRIhsz,
+        binding_count, IREE_HAL_MODULE_MAX_DESCRIPTOR_BINDING_COUNT);
+  }
+  iree_hal_descriptor_set_binding_t* bindings =
+      (iree_hal_descriptor_set_binding_t*)iree_alloca(
+          binding_count * sizeof(iree_hal_descriptor_set_binding_t));
+  uint32_t* buffer_slots =
+      (uint32_t*)iree_alloca(binding_count * sizeof(uint32_t));
+  for (iree_host_size_t i = 0; i < binding_count; ++i) {
+    if (IREE_UNLIKELY(args->a3[i].i1 < 0 ||
+                      (iree_host_size_t)args->a3[i].i1 >=
+                          IREE_HAL_MODULE_MAX_BINDING_TABLE_COUNT)) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "binding table slot %d out of range",
+                              args->a3[i].i1);
+    }
+    bindings[i].binding = (uint32_t)args->a3[i].i0;
+    bindings[i].buffer = NULL;
+    bindings[i].offset = iree_hal_cast_device_size(args->a3[i].i2);
+    bindings[i].length = iree_hal_cast_device_size(args->a3[i].i3);
+    buffer_slots[i] = (uint32_t)args->a3[i].i1;
+  }
+
+  return iree_hal_deferred_command_buffer_push_descriptor_set_indirect(
+      command_buffer, executable_layout, set, binding_count, bindings,
+      buffer_slots);
+}
+
 IREE_VM_ABI_EXPORT(iree_hal_module_command_buffer_bind_descriptor_set,  //
                    iree_hal_module_state_t,                             //
                    rrirCID, v) {
@@ -1366,13 +1552,40 @@ IREE_VM_ABI_EXPORT(iree_hal_module_semaphore_fail,  //
 IREE_VM_ABI_EXPORT(iree_hal_module_semaphore_await,  //
                    iree_hal_module_state_t,          //
                    rI, i) {
-  iree_hal_semaphore_t* semaphore = NULL;
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_check_deref(args->r0, &semaphore));
-  uint64_t new_value = (uint64_t)args->i1;
-
-  // TODO(benvanik): coroutine magic.
-  iree_status_t status =
-      iree_hal_semaphore_wait(semaphore, new_value, iree_infinite_timeout());
+  iree_status_t status = iree_ok_status();
+  iree_vm_stack_frame_t* current_frame = iree_vm_stack_current_frame(stack);
+  if (current_frame->type == IREE_VM_STACK_FRAME_WAIT) {
+    // Resuming after the wait we yielded below; the arguments are not
+    // available and only the result of the wait matters.
+    iree_vm_wait_result_t wait_result;
+    IREE_RETURN_IF_ERROR(iree_vm_stack_wait_leave(stack, &wait_result));
+    status = wait_result.status;
+  } else {
+    iree_hal_semaphore_t* semaphore = NULL;
+    IREE_RETURN_IF_ERROR(iree_hal_semaphore_check_deref(args->r0, &semaphore));
+    uint64_t new_value = (uint64_t)args->i1;
+
+    // Yield to the scheduler if the semaphore has not yet been reached and
+    // the invocation is able to suspend. The semaphore is kept live by the
+    // caller while we are suspended.
+    uint64_t current_value = 0;
+    status = iree_hal_semaphore_query(semaphore, &current_value);
+    if (iree_status_is_ok(status) && current_value < new_value &&
+        iree_all_bits_set(state->flags, IREE_HAL_MODULE_FLAG_ASYNCHRONOUS)) {
+      iree_vm_wait_frame_t* wait_frame = NULL;
+      IREE_RETURN_IF_ERROR(iree_vm_stack_wait_enter(
+          stack, IREE_VM_WAIT_ALL, 1, iree_infinite_timeout(), 0,
+          &wait_frame));
+      wait_frame->wait_sources[0] =
+          iree_hal_semaphore_await(semaphore, new_value);
+      return iree_status_from_code(IREE_STATUS_DEFERRED);
+    } else if (iree_status_is_ok(status)) {
+      // Blocking wait. Drivers whose work only progresses on waiting threads
+      // (such as local-task with a threadless executor) donate the caller.
+      status = iree_hal_semaphore_wait(semaphore, new_value,
+                                       iree_infinite_timeout());
+    }
+  }
   if (iree_status_is_ok(status)) {
     rets->i0 = 0;
   } else if (iree_status_is_deadline_exceeded(status)) {
@@ -1429,9 +1642,9 @@ static const iree_vm_native_module_descriptor_t iree_hal_module_descriptor_ = {
     .reflection_attrs = NULL,
 };
 
-IREE_API_EXPORT iree_status_t
-iree_hal_module_create(iree_hal_device_t* device, iree_allocator_t allocator,
-                       iree_vm_module_t** out_module) {
+IREE_API_EXPORT iree_status_t iree_hal_module_create(
+    iree_hal_device_t* device, iree_hal_module_flags_t flags,
+    iree_allocator_t allocator, iree_vm_module_t** out_module) {
   IREE_ASSERT_ARGUMENT(device);
   IREE_ASSERT_ARGUMENT(out_module);
   *out_module = NULL;
@@ -1461,6 +1674,7 @@ iree_hal_module_create(iree_hal_device_t* device, iree_allocator_t allocator,
 
   iree_hal_module_t* module = IREE_HAL_MODULE_CAST(base_module);
   module->host_allocator = allocator;
+  module->flags = flags;
   module->shared_device = device;
   iree_hal_device_retain(module->shared_device);
 
@@ -39,12 +39,25 @@ extern "C" {
 // WARNING: not thread-safe; call at startup before using.
 IREE_API_EXPORT iree_status_t iree_hal_module_register_types(void);
 
+// Controls HAL module behavior.
+enum iree_hal_module_flag_bits_t {
+  IREE_HAL_MODULE_FLAG_NONE = 0u,
+
+  // Waits on semaphores suspend the invocation by yielding a VM wait frame
+  // instead of blocking the calling thread. Invocations must be driven by a
+  // scheduler that handles IREE_STATUS_DEFERRED such as iree_vm_invoke or
+  // iree_vm_async_invoke and all callers of the module must support yielding
+  // imports (bytecode modules do; C modules do not).
+  IREE_HAL_MODULE_FLAG_ASYNCHRONOUS = 1u << 0,
+};
+typedef uint32_t iree_hal_module_flags_t;
+
 // Creates the HAL module initialized to use a specific |device|.
 // Each context using this module will share the device and have compatible
 // allocations.
-IREE_API_EXPORT iree_status_t
-iree_hal_module_create(iree_hal_device_t* device, iree_allocator_t allocator,
-                       iree_vm_module_t** out_module);
+IREE_API_EXPORT iree_status_t iree_hal_module_create(
+    iree_hal_device_t* device, iree_hal_module_flags_t flags,
+    iree_allocator_t allocator, iree_vm_module_t** out_module);
 
 // Returns the device currently in use by the HAL module.
 // Returns NULL if no device has been initialized yet.
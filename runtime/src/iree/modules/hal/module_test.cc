@@ -0,0 +1,362 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Tests covering the HAL module exports that interact with VM scheduling and
+// with forked contexts. Exports are called directly on a VM stack such that
+// yields can be observed.
+
+#include "iree/modules/hal/module.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/status_cc.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_sync/sync_device.h"
+#include "iree/hal/drivers/local_task/task_device.h"
+#include "iree/task/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+
+namespace iree {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+// Arguments of hal.semaphore.await matching its `0rI_i` calling convention.
+typedef struct {
+  iree_vm_ref_t semaphore;
+  int64_t min_value;
+} IREE_ATTRIBUTE_PACKED SemaphoreAwaitArgs;
+
+// Arguments of hal.command_buffer.create.reusable matching `rii`.
+typedef struct {
+  iree_vm_ref_t device;
+  int32_t command_categories;
+  int32_t binding_capacity;
+} IREE_ATTRIBUTE_PACKED CommandBufferCreateReusableArgs;
+
+// Arguments of hal.ex.submit_and_wait.indirect matching `rrCrD` with an empty
+// binding table.
+typedef struct {
+  iree_vm_ref_t device;
+  iree_vm_ref_t command_buffer;
+  iree_vm_size_t binding_count;
+} IREE_ATTRIBUTE_PACKED SubmitAndWaitIndirectArgs;
+
+// Calls |function_name| in |context| on a new stack with packed |args| and
+// |rets| storage.
+static iree_status_t CallFunction(iree_vm_context_t* context,
+                                  const char* function_name,
+                                  iree_byte_span_t args,
+                                  iree_byte_span_t rets) {
+  iree_vm_function_t function;
+  IREE_RETURN_IF_ERROR(iree_vm_context_resolve_function(
+      context, iree_make_cstring_view(function_name), &function));
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_CONTEXT_FLAG_NONE,
+                                  iree_vm_context_state_resolver(context),
+                                  iree_allocator_system());
+  iree_vm_function_call_t call;
+  memset(&call, 0, sizeof(call));
+  call.function = function;
+  call.arguments = args;
+  call.results = rets;
+  iree_vm_execution_result_t execution_result;
+  iree_status_t status = function.module->begin_call(
+      function.module->self, stack, &call, &execution_result);
+  iree_vm_stack_deinitialize(stack);
+  return status;
+}
+
+class HALModuleTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    IREE_CHECK_OK(iree_vm_register_builtin_types());
+    IREE_CHECK_OK(iree_hal_module_register_types());
+  }
+
+  void SetUp() override {
+    IREE_CHECK_OK(iree_vm_instance_create(iree_allocator_system(), &instance_));
+
+    iree_hal_allocator_t* device_allocator = NULL;
+    IREE_CHECK_OK(iree_hal_allocator_create_heap(
+        IREE_SV("test"), iree_allocator_system(), iree_allocator_system(),
+        &device_allocator));
+    iree_hal_sync_device_params_t params;
+    iree_hal_sync_device_params_initialize(&params);
+    IREE_CHECK_OK(iree_hal_sync_device_create(
+        IREE_SV("test"), &params, /*loader_count=*/0, /*loaders=*/NULL,
+        device_allocator, iree_allocator_system(), &device_));
+    iree_hal_allocator_release(device_allocator);
+
+    IREE_CHECK_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore_));
+  }
+
+  void TearDown() override {
+    iree_vm_context_release(context_);
+    iree_vm_module_release(hal_module_);
+    iree_hal_semaphore_release(semaphore_);
+    iree_hal_device_release(device_);
+    iree_vm_instance_release(instance_);
+  }
+
+  // Creates |context_| with a HAL module using |flags| and resolves
+  // hal.semaphore.await into |await_function_|.
+  void CreateContext(iree_hal_module_flags_t flags) {
+    IREE_ASSERT_OK(iree_hal_module_create(
+        device_, flags, iree_allocator_system(), &hal_module_));
+    IREE_ASSERT_OK(iree_vm_context_create_with_modules(
+        instance_, IREE_VM_CONTEXT_FLAG_NONE, 1, &hal_module_,
+        iree_allocator_system(), &context_));
+    IREE_ASSERT_OK(iree_vm_context_resolve_function(
+        context_, IREE_SV("hal.semaphore.await"), &await_function_));
+  }
+
+  // Begins a call to hal.semaphore.await on |stack| for |min_value|.
+  // |args| must remain live until the call completes.
+  iree_status_t BeginAwait(iree_vm_stack_t* stack, uint64_t min_value,
+                           SemaphoreAwaitArgs* args, int32_t* result) {
+    memset(args, 0, sizeof(*args));
+    args->semaphore = iree_hal_semaphore_retain_ref(semaphore_);
+    args->min_value = (int64_t)min_value;
+    iree_vm_function_call_t call;
+    memset(&call, 0, sizeof(call));
+    call.function = await_function_;
+    call.arguments = iree_make_byte_span(args, sizeof(*args));
+    call.results = iree_make_byte_span(result, sizeof(*result));
+    iree_vm_execution_result_t execution_result;
+    return await_function_.module->begin_call(await_function_.module->self,
+                                              stack, &call, &execution_result);
+  }
+
+  iree_vm_instance_t* instance_ = nullptr;
+  iree_hal_device_t* device_ = nullptr;
+  iree_hal_semaphore_t* semaphore_ = nullptr;
+  iree_vm_module_t* hal_module_ = nullptr;
+  iree_vm_context_t* context_ = nullptr;
+  iree_vm_function_t await_function_;
+};
+
+// Tests that awaiting an unsignaled semaphore in an asynchronous HAL module
+// yields a wait frame on the semaphore and completes when resumed after the
+// wait is satisfied.
+TEST_F(HALModuleTest, AsyncAwaitYieldsWaitFrame) {
+  CreateContext(IREE_HAL_MODULE_FLAG_ASYNCHRONOUS);
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_CONTEXT_FLAG_NONE,
+                                  iree_vm_context_state_resolver(context_),
+                                  iree_allocator_system());
+
+  SemaphoreAwaitArgs args;
+  int32_t result = -1;
+  ASSERT_THAT(Status(BeginAwait(stack, 1ull, &args, &result)),
+              StatusIs(StatusCode::kDeferred));
+
+  // The invocation is suspended on a wait frame with the semaphore timepoint
+  // as its only wait source and the semaphore is still unsignaled.
+  iree_vm_stack_frame_t* wait_stack_frame = iree_vm_stack_current_frame(stack);
+  ASSERT_NE(wait_stack_frame, nullptr);
+  ASSERT_EQ(wait_stack_frame->type, IREE_VM_STACK_FRAME_WAIT);
+  iree_vm_wait_frame_t* wait_frame =
+      (iree_vm_wait_frame_t*)iree_vm_stack_frame_storage(wait_stack_frame);
+  ASSERT_EQ(wait_frame->count, 1);
+  iree_status_code_t wait_status_code = IREE_STATUS_OK;
+  IREE_ASSERT_OK(iree_wait_source_query(wait_frame->wait_sources[0],
+                                        &wait_status_code));
+  EXPECT_EQ(wait_status_code, IREE_STATUS_DEFERRED);
+
+  // Satisfy the wait as a scheduler would and resume the import.
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(semaphore_, 1ull));
+  wait_frame->wait_status = iree_wait_source_wait_one(
+      wait_frame->wait_sources[0], iree_immediate_timeout());
+  iree_vm_execution_result_t execution_result;
+  IREE_ASSERT_OK(await_function_.module->resume_call(
+      await_function_.module->self, stack,
+      iree_make_byte_span(&result, sizeof(result)), &execution_result));
+  EXPECT_EQ(result, 0);
+  EXPECT_EQ(iree_vm_stack_current_frame(stack), nullptr);
+
+  iree_vm_ref_release(&args.semaphore);
+  iree_vm_stack_deinitialize(stack);
+}
+
+// Tests that awaiting a semaphore that has already reached the value completes
+// without yielding.
+TEST_F(HALModuleTest, AsyncAwaitSignaledCompletesInline) {
+  CreateContext(IREE_HAL_MODULE_FLAG_ASYNCHRONOUS);
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_CONTEXT_FLAG_NONE,
+                                  iree_vm_context_state_resolver(context_),
+                                  iree_allocator_system());
+
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(semaphore_, 2ull));
+  SemaphoreAwaitArgs args;
+  int32_t result = -1;
+  IREE_ASSERT_OK(BeginAwait(stack, 1ull, &args, &result));
+  EXPECT_EQ(result, 0);
+  EXPECT_EQ(iree_vm_stack_current_frame(stack), nullptr);
+
+  iree_vm_ref_release(&args.semaphore);
+  iree_vm_stack_deinitialize(stack);
+}
+
+// Tests that the resumed await fails if the semaphore fails while suspended.
+TEST_F(HALModuleTest, AsyncAwaitFailedSemaphore) {
+  CreateContext(IREE_HAL_MODULE_FLAG_ASYNCHRONOUS);
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_CONTEXT_FLAG_NONE,
+                                  iree_vm_context_state_resolver(context_),
+                                  iree_allocator_system());
+
+  SemaphoreAwaitArgs args;
+  int32_t result = -1;
+  ASSERT_THAT(Status(BeginAwait(stack, 1ull, &args, &result)),
+              StatusIs(StatusCode::kDeferred));
+
+  iree_hal_semaphore_fail(semaphore_,
+                          iree_make_status(IREE_STATUS_DATA_LOSS, "failed"));
+  iree_vm_wait_frame_t* wait_frame =
+      (iree_vm_wait_frame_t*)iree_vm_stack_frame_storage(
+          iree_vm_stack_current_frame(stack));
+  wait_frame->wait_status = iree_wait_source_wait_one(
+      wait_frame->wait_sources[0], iree_immediate_timeout());
+  iree_vm_execution_result_t execution_result;
+  EXPECT_THAT(Status(await_function_.module->resume_call(
+                  await_function_.module->self, stack,
+                  iree_make_byte_span(&result, sizeof(result)),
+                  &execution_result)),
+              StatusIs(StatusCode::kAborted));
+
+  iree_vm_ref_release(&args.semaphore);
+  iree_vm_stack_deinitialize(stack);
+}
+
+// Tests that forks of a context can concurrently submit a reusable command
+// buffer shared through an immutable global (as produced by command buffer
+// memoization) after the context that created it has been released.
+TEST(HALModuleForkTest, ConcurrentForksSubmitSharedReusableCommandBuffer) {
+  IREE_ASSERT_OK(iree_vm_register_builtin_types());
+  IREE_ASSERT_OK(iree_hal_module_register_types());
+  iree_vm_instance_t* instance = NULL;
+  IREE_ASSERT_OK(iree_vm_instance_create(iree_allocator_system(), &instance));
+
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/2, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(
+      IREE_TASK_SCHEDULING_MODE_RESERVED, &topology,
+      /*worker_local_memory_size=*/0, iree_allocator_system(), &executor));
+  iree_task_topology_deinitialize(&topology);
+  iree_hal_allocator_t* device_allocator = NULL;
+  IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+      IREE_SV("test"), iree_allocator_system(), iree_allocator_system(),
+      &device_allocator));
+  iree_hal_task_device_params_t params;
+  iree_hal_task_device_params_initialize(&params);
+  iree_hal_device_t* device = NULL;
+  IREE_ASSERT_OK(iree_hal_task_device_create(
+      IREE_SV("test"), &params, executor, /*loader_count=*/0, /*loaders=*/NULL,
+      device_allocator, iree_allocator_system(), &device));
+  iree_hal_allocator_release(device_allocator);
+  iree_task_executor_release(executor);
+
+  iree_vm_module_t* hal_module = NULL;
+  IREE_ASSERT_OK(iree_hal_module_create(device, IREE_HAL_MODULE_FLAG_NONE,
+                                        iree_allocator_system(), &hal_module));
+
+  // Create the reusable command buffer from a context that is released before
+  // any submissions such that nothing depends on its module state.
+  iree_vm_context_t* creator_context = NULL;
+  IREE_ASSERT_OK(iree_vm_context_create_with_modules(
+      instance, IREE_VM_CONTEXT_FLAG_NONE, 1, &hal_module,
+      iree_allocator_system(), &creator_context));
+  CommandBufferCreateReusableArgs create_args;
+  create_args.device = iree_hal_device_retain_ref(device);
+  create_args.command_categories = IREE_HAL_COMMAND_CATEGORY_ANY;
+  create_args.binding_capacity = 0;
+  iree_vm_ref_t command_buffer_ref = {0};
+  IREE_ASSERT_OK(CallFunction(
+      creator_context, "hal.command_buffer.create.reusable",
+      iree_make_byte_span(&create_args, sizeof(create_args)),
+      iree_make_byte_span(&command_buffer_ref, sizeof(command_buffer_ref))));
+  iree_vm_ref_release(&create_args.device);
+  iree_vm_context_release(creator_context);
+  iree_hal_command_buffer_t* command_buffer =
+      iree_hal_command_buffer_deref(command_buffer_ref);
+  ASSERT_NE(command_buffer, nullptr);
+
+  const uint32_t pattern = 0xCAFEF00Du;
+  const iree_device_size_t buffer_size = 1024 * 1024;
+  iree_hal_buffer_params_t buffer_params = {0};
+  buffer_params.type =
+      IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+  buffer_params.usage =
+      IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_MAPPING;
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+      iree_hal_device_allocator(device), buffer_params, buffer_size,
+      iree_const_byte_span_empty(), &buffer));
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+  IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer, buffer, /*target_offset=*/0, buffer_size, &pattern,
+      sizeof(pattern)));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+
+  // Each fork submits the same command buffer from its own thread.
+  iree_vm_context_t* context = NULL;
+  IREE_ASSERT_OK(iree_vm_context_create_with_modules(
+      instance, IREE_VM_CONTEXT_FLAG_NONE, 1, &hal_module,
+      iree_allocator_system(), &context));
+  constexpr int kForkCount = 4;
+  constexpr int kSubmitCount = 32;
+  iree_vm_context_t* forks[kForkCount] = {NULL};
+  for (int i = 0; i < kForkCount; ++i) {
+    IREE_ASSERT_OK(
+        iree_vm_context_fork(context, iree_allocator_system(), &forks[i]));
+  }
+  iree_status_code_t status_codes[kForkCount];
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kForkCount; ++i) {
+    threads.emplace_back([&, i]() {
+      iree_status_t status = iree_ok_status();
+      for (int j = 0; j < kSubmitCount && iree_status_is_ok(status); ++j) {
+        SubmitAndWaitIndirectArgs submit_args;
+        submit_args.device = iree_hal_device_retain_ref(device);
+        submit_args.command_buffer =
+            iree_hal_command_buffer_retain_ref(command_buffer);
+        submit_args.binding_count = 0;
+        int unused_result = 0;
+        status = CallFunction(
+            forks[i], "hal.ex.submit_and_wait.indirect",
+            iree_make_byte_span(&submit_args, sizeof(submit_args)),
+            iree_make_byte_span(&unused_result, sizeof(unused_result)));
+        iree_vm_ref_release(&submit_args.command_buffer);
+        iree_vm_ref_release(&submit_args.device);
+      }
+      status_codes[i] = iree_status_consume_code(status);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  for (int i = 0; i < kForkCount; ++i) {
+    EXPECT_EQ(status_codes[i], IREE_STATUS_OK) << "fork " << i;
+    iree_vm_context_release(forks[i]);
+  }
+  iree_vm_context_release(context);
+
+  uint32_t value = 0;
+  IREE_ASSERT_OK(iree_hal_buffer_map_read(buffer, buffer_size - sizeof(value),
+                                          &value, sizeof(value)));
+  EXPECT_EQ(value, pattern);
+
+  iree_hal_buffer_release(buffer);
+  iree_vm_ref_release(&command_buffer_ref);
+  iree_vm_module_release(hal_module);
+  iree_hal_device_release(device);
+  iree_vm_instance_release(instance);
+}
+
+}  // namespace
+}  // namespace iree
@@ -23,6 +23,18 @@
 
 // clang-format off
 
-EXPORT_FN("_placeholder", iree_vmvx_module_placeholder, v, v)
+EXPORT_FN("add.2d.f32", iree_vmvx_add2d_f32, rIIIrIIIrIIIII, v)
+EXPORT_FN("add.2d.i32", iree_vmvx_add2d_i32, rIIIrIIIrIIIII, v)
+EXPORT_FN("copy.2d.x16", iree_vmvx_copy2d_x16, rIIIrIIIII, v)
+EXPORT_FN("copy.2d.x32", iree_vmvx_copy2d_x32, rIIIrIIIII, v)
+EXPORT_FN("copy.2d.x64", iree_vmvx_copy2d_x64, rIIIrIIIII, v)
+EXPORT_FN("copy.2d.x8", iree_vmvx_copy2d_x8, rIIIrIIIII, v)
+EXPORT_FN("fill.2d.x32", iree_vmvx_fill2d_x32, irIIII, v)
+EXPORT_FN("matmul.f32f32f32", iree_vmvx_matmul_f32f32f32, rIIrIIrIIIIIi, v)
+EXPORT_FN("mmt4d.f32f32f32", iree_vmvx_mmt4d_f32f32f32, rIIrIIrIIIIIiiii, v)
+EXPORT_FN("mul.2d.f32", iree_vmvx_mul2d_f32, rIIIrIIIrIIIII, v)
+EXPORT_FN("mul.2d.i32", iree_vmvx_mul2d_i32, rIIIrIIIrIIIII, v)
+EXPORT_FN("sub.2d.f32", iree_vmvx_sub2d_f32, rIIIrIIIrIIIII, v)
+EXPORT_FN("sub.2d.i32", iree_vmvx_sub2d_i32, rIIIrIIIrIIIII, v)
 
 // clang-format on
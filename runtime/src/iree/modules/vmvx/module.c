@@ -6,6 +6,7 @@
 
 #include "iree/modules/vmvx/module.h"
 
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -91,13 +92,332 @@ iree_vmvx_module_free_state(void* self, iree_vm_module_state_t* module_state) {
 }
 
 //===----------------------------------------------------------------------===//
-// TODO
+// Buffer view utilities
 //===----------------------------------------------------------------------===//
 
-// Placeholder to make the function pointer arrays happy (they can't be empty).
-IREE_VM_ABI_EXPORT(iree_vmvx_module_placeholder,  //
-                   iree_vmvx_module_state_t,      //
-                   v, v) {
+// Computes `|a| * |b| + |c|` into |out_value| and returns false if the result
+// does not fit in 64 bits.
+static bool iree_vmvx_mul_add_u64(uint64_t a, uint64_t b, uint64_t c,
+                                  uint64_t* out_value) {
+  if (b != 0 && a > (UINT64_MAX - c) / b) return false;
+  *out_value = a * b + c;
+  return true;
+}
+
+// Computes `|a| * |b| * |c|` of non-negative sizes into |out_value| and
+// returns false if any is negative or the result does not fit in an int64_t.
+static bool iree_vmvx_mul3_size(int64_t a, int64_t b, int64_t c,
+                                int64_t* out_value) {
+  if (a < 0 || b < 0 || c < 0) return false;
+  uint64_t value = 0;
+  if (!iree_vmvx_mul_add_u64((uint64_t)a, (uint64_t)b, 0, &value) ||
+      !iree_vmvx_mul_add_u64(value, (uint64_t)c, 0, &value) ||
+      value > (uint64_t)INT64_MAX) {
+    return false;
+  }
+  *out_value = (int64_t)value;
+  return true;
+}
+
+// Maps a strided 2D view of |buffer_ref| for the kernels below.
+// |offset| and |strides| are in elements of |element_size| bytes. Bounds are
+// checked once for the whole view so that the inner loops can run unchecked.
+// When |size0| or |size1| is 0 the view is empty and |out_ptr| may be NULL.
+static iree_status_t iree_vmvx_map_2d(iree_vm_ref_t buffer_ref, bool writable,
+                                      int64_t offset, int64_t stride0,
+                                      int64_t stride1, int64_t size0,
+                                      int64_t size1,
+                                      iree_host_size_t element_size,
+                                      uint8_t** out_ptr) {
+  *out_ptr = NULL;
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_buffer_check_deref(buffer_ref, &buffer));
+  if (IREE_UNLIKELY(writable && !iree_all_bits_set(
+                                    buffer->access,
+                                    IREE_VM_BUFFER_ACCESS_MUTABLE))) {
+    return iree_make_status(
+        IREE_STATUS_PERMISSION_DENIED,
+        "buffer is read-only and cannot be mapped for mutation");
+  }
+  if (IREE_UNLIKELY(offset < 0 || stride0 < 0 || stride1 < 0 || size0 < 0 ||
+                    size1 < 0)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "negative offset/stride/size in buffer view");
+  }
+  if (size0 == 0 || size1 == 0) return iree_ok_status();
+  // All operands come from the program and the arithmetic is checked such that
+  // large values cannot wrap around into a seemingly in-bounds view.
+  iree_byte_span_t data = buffer->data;
+  uint64_t last_element = 0;
+  uint64_t end_byte = 0;
+  bool in_bounds =
+      iree_vmvx_mul_add_u64((uint64_t)(size0 - 1), (uint64_t)stride0,
+                            (uint64_t)offset, &last_element) &&
+      iree_vmvx_mul_add_u64((uint64_t)(size1 - 1), (uint64_t)stride1,
+                            last_element, &last_element) &&
+      iree_vmvx_mul_add_u64(last_element, element_size, element_size,
+                            &end_byte) &&
+      end_byte <= data.data_length;
+  if (IREE_UNLIKELY(!in_bounds)) {
+    return iree_make_status(
+        IREE_STATUS_OUT_OF_RANGE,
+        "out-of-bounds view access (offset=%" PRId64 ", strides=[%" PRId64
+        ", %" PRId64 "], sizes=[%" PRId64 ", %" PRId64
+        "], element size=%zu, buffer length=%zu)",
+        offset, stride0, stride1, size0, size1, element_size,
+        data.data_length);
+  }
+  *out_ptr = data.data + offset * element_size;
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Elementwise binary ops
+//===----------------------------------------------------------------------===//
+
+// Defines a 2D elementwise binary kernel `out = lhs OP rhs`.
+// The contiguous case (all inner strides 1) is split out so that the compiler
+// can vectorize the inner loop.
+#define IREE_VMVX_DEFINE_BINARY_2D(name, type, element_size, expr)             \
+  IREE_VM_ABI_EXPORT(iree_vmvx_##name, iree_vmvx_module_state_t,               \
+                     rIIIrIIIrIIIII, v) {                                      \
+    const int64_t size0 = args->i12;                                           \
+    const int64_t size1 = args->i13;                                           \
+    uint8_t* lhs_ptr = NULL;                                                   \
+    IREE_RETURN_IF_ERROR(iree_vmvx_map_2d(args->r0, /*writable=*/false,        \
+                                          args->i1, args->i2, args->i3, size0, \
+                                          size1, element_size, &lhs_ptr));     \
+    uint8_t* rhs_ptr = NULL;                                                   \
+    IREE_RETURN_IF_ERROR(iree_vmvx_map_2d(args->r4, /*writable=*/false,        \
+                                          args->i5, args->i6, args->i7, size0, \
+                                          size1, element_size, &rhs_ptr));     \
+    uint8_t* out_ptr = NULL;                                                   \
+    IREE_RETURN_IF_ERROR(iree_vmvx_map_2d(args->r8, /*writable=*/true,         \
+                                          args->i9, args->i10, args->i11,      \
+                                          size0, size1, element_size,          \
+                                          &out_ptr));                          \
+    const type* lhs = (const type*)lhs_ptr;                                    \
+    const type* rhs = (const type*)rhs_ptr;                                    \
+    type* out = (type*)out_ptr;                                                \
+    if (args->i3 == 1 && args->i7 == 1 && args->i11 == 1) {                    \
+      for (int64_t i = 0; i < size0; ++i) {                                    \
+        const type* IREE_RESTRICT lhs_row = lhs + i * args->i2;                \
+        const type* IREE_RESTRICT rhs_row = rhs + i * args->i6;                \
+        type* IREE_RESTRICT out_row = out + i * args->i10;                     \
+        for (int64_t j = 0; j < size1; ++j) {                                  \
+          const type a = lhs_row[j];                                           \
+          const type b = rhs_row[j];                                           \
+          out_row[j] = (expr);                                                 \
+        }                                                                      \
+      }                                                                        \
+    } else {                                                                   \
+      for (int64_t i = 0; i < size0; ++i) {                                    \
+        for (int64_t j = 0; j < size1; ++j) {                                  \
+          const type a = lhs[i * args->i2 + j * args->i3];                     \
+          const type b = rhs[i * args->i6 + j * args->i7];                     \
+          out[i * args->i10 + j * args->i11] = (expr);                         \
+        }                                                                      \
+      }                                                                        \
+    }                                                                          \
+    return iree_ok_status();                                                   \
+  }
+
+IREE_VMVX_DEFINE_BINARY_2D(add2d_f32, float, sizeof(float), a + b);
+IREE_VMVX_DEFINE_BINARY_2D(add2d_i32, int32_t, sizeof(int32_t),
+                           (int32_t)((uint32_t)a + (uint32_t)b));
+IREE_VMVX_DEFINE_BINARY_2D(mul2d_f32, float, sizeof(float), a* b);
+IREE_VMVX_DEFINE_BINARY_2D(mul2d_i32, int32_t, sizeof(int32_t),
+                           (int32_t)((uint32_t)a * (uint32_t)b));
+IREE_VMVX_DEFINE_BINARY_2D(sub2d_f32, float, sizeof(float), a - b);
+IREE_VMVX_DEFINE_BINARY_2D(sub2d_i32, int32_t, sizeof(int32_t),
+                           (int32_t)((uint32_t)a - (uint32_t)b));
+
+//===----------------------------------------------------------------------===//
+// Copy/fill
+//===----------------------------------------------------------------------===//
+
+// Defines a 2D strided copy kernel for elements of the given bit width.
+// Rows that are contiguous in both the source and target are copied with
+// memcpy.
+#define IREE_VMVX_DEFINE_COPY_2D(name, type)                                  \
+  IREE_VM_ABI_EXPORT(iree_vmvx_##name, iree_vmvx_module_state_t, rIIIrIIIII, \
+                     v) {                                                     \
+    const int64_t size0 = args->i8;                                           \
+    const int64_t size1 = args->i9;                                           \
+    uint8_t* in_ptr = NULL;                                                   \
+    IREE_RETURN_IF_ERROR(iree_vmvx_map_2d(args->r0, /*writable=*/false,       \
+                                          args->i1, args->i2, args->i3,       \
+                                          size0, size1, sizeof(type),         \
+                                          &in_ptr));                          \
+    uint8_t* out_ptr = NULL;                                                  \
+    IREE_RETURN_IF_ERROR(iree_vmvx_map_2d(args->r4, /*writable=*/true,        \
+                                          args->i5, args->i6, args->i7,       \
+                                          size0, size1, sizeof(type),         \
+                                          &out_ptr));                         \
+    const type* in = (const type*)in_ptr;                                     \
+    type* out = (type*)out_ptr;                                               \
+    if (args->i3 == 1 && args->i7 == 1) {                                     \
+      for (int64_t i = 0; i < size0; ++i) {                                   \
+        memmove(out + i * args->i6, in + i * args->i2, size1 * sizeof(type)); \
+      }                                                                       \
+    } else {                                                                  \
+      for (int64_t i = 0; i < size0; ++i) {                                   \
+        for (int64_t j = 0; j < size1; ++j) {                                 \
+          out[i * args->i6 + j * args->i7] = in[i * args->i2 + j * args->i3]; \
+        }                                                                     \
+      }                                                                       \
+    }                                                                         \
+    return iree_ok_status();                                                  \
+  }
+
+IREE_VMVX_DEFINE_COPY_2D(copy2d_x8, uint8_t);
+IREE_VMVX_DEFINE_COPY_2D(copy2d_x16, uint16_t);
+IREE_VMVX_DEFINE_COPY_2D(copy2d_x32, uint32_t);
+IREE_VMVX_DEFINE_COPY_2D(copy2d_x64, uint64_t);
+
+IREE_VM_ABI_EXPORT(iree_vmvx_fill2d_x32, iree_vmvx_module_state_t, irIIII, v) {
+  const uint32_t value = (uint32_t)args->i0;
+  const int64_t row_stride = args->i3;
+  const int64_t size0 = args->i4;
+  const int64_t size1 = args->i5;
+  uint8_t* out_ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_vmvx_map_2d(args->r1, /*writable=*/true, args->i2,
+                                        row_stride, 1, size0, size1,
+                                        sizeof(uint32_t), &out_ptr));
+  uint32_t* out = (uint32_t*)out_ptr;
+  for (int64_t i = 0; i < size0; ++i) {
+    uint32_t* IREE_RESTRICT out_row = out + i * row_stride;
+    for (int64_t j = 0; j < size1; ++j) {
+      out_row[j] = value;
+    }
+  }
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Matmul
+//===----------------------------------------------------------------------===//
+
+// Accumulates into the existing contents of the output instead of overwriting
+// it: `out += lhs * rhs` (matches linalg.matmul/linalg.mmt4d semantics).
+// This must match the VMVX_MatmulFlags values in the compiler.
+#define IREE_VMVX_MATMUL_FLAG_ACCUMULATE 1
+
+// `out[m, n] (+)= lhs[m, k] * rhs[k, n]` with row-major operands whose inner
+// dimension is contiguous. The loop order (m, k, n) keeps the innermost loop
+// streaming over contiguous rows of rhs/out so that it vectorizes.
+IREE_VM_ABI_EXPORT(iree_vmvx_matmul_f32f32f32, iree_vmvx_module_state_t,
+                   rIIrIIrIIIIIi, v) {
+  const int64_t m = args->i9;
+  const int64_t n = args->i10;
+  const int64_t k = args->i11;
+  const int32_t flags = args->i12;
+  const int64_t lhs_stride = args->i2;
+  const int64_t rhs_stride = args->i5;
+  const int64_t out_stride = args->i8;
+  uint8_t* lhs_ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_vmvx_map_2d(args->r0, /*writable=*/false, args->i1,
+                                        lhs_stride, 1, m, k, sizeof(float),
+                                        &lhs_ptr));
+  uint8_t* rhs_ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_vmvx_map_2d(args->r3, /*writable=*/false, args->i4,
+                                        rhs_stride, 1, k, n, sizeof(float),
+                                        &rhs_ptr));
+  uint8_t* out_ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_vmvx_map_2d(args->r6, /*writable=*/true, args->i7,
+                                        out_stride, 1, m, n, sizeof(float),
+                                        &out_ptr));
+  const float* lhs = (const float*)lhs_ptr;
+  const float* rhs = (const float*)rhs_ptr;
+  float* out = (float*)out_ptr;
+  for (int64_t i = 0; i < m; ++i) {
+    float* IREE_RESTRICT out_row = out + i * out_stride;
+    if (!(flags & IREE_VMVX_MATMUL_FLAG_ACCUMULATE)) {
+      memset(out_row, 0, n * sizeof(float));
+    }
+    for (int64_t kk = 0; kk < k; ++kk) {
+      const float a = lhs[i * lhs_stride + kk];
+      const float* IREE_RESTRICT rhs_row = rhs + kk * rhs_stride;
+      for (int64_t j = 0; j < n; ++j) {
+        out_row[j] += a * rhs_row[j];
+      }
+    }
+  }
+  return iree_ok_status();
+}
+
+// linalg.mmt4d: `out[m1, n1, m0, n0] (+)= lhs[m1, k1, m0, k0] *
+// rhs[n1, k1, n0, k0]`. The inner tiles (m0 x k0, n0 x k0, m0 x n0) are dense
+// and the strides passed are those of the outermost dimension of each operand.
+IREE_VM_ABI_EXPORT(iree_vmvx_mmt4d_f32f32f32, iree_vmvx_module_state_t,
+                   rIIrIIrIIIIIiiii, v) {
+  const int64_t m1 = args->i9;
+  const int64_t n1 = args->i10;
+  const int64_t k1 = args->i11;
+  const int64_t m0 = args->i12;
+  const int64_t n0 = args->i13;
+  const int64_t k0 = args->i14;
+  const int32_t flags = args->i15;
+  const int64_t lhs_stride = args->i2;
+  const int64_t rhs_stride = args->i5;
+  const int64_t out_stride = args->i8;
+  if (IREE_UNLIKELY(m0 <= 0 || n0 <= 0 || k0 <= 0)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "invalid mmt4d tile size %" PRId64 "x%" PRId64
+                            "x%" PRId64,
+                            m0, n0, k0);
+  }
+  // Each row of the 2D views is one run of k1/n1 packed tiles.
+  int64_t lhs_row_size = 0;
+  int64_t rhs_row_size = 0;
+  int64_t out_row_size = 0;
+  if (IREE_UNLIKELY(!iree_vmvx_mul3_size(k1, m0, k0, &lhs_row_size) ||
+                    !iree_vmvx_mul3_size(k1, n0, k0, &rhs_row_size) ||
+                    !iree_vmvx_mul3_size(n1, m0, n0, &out_row_size))) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "invalid mmt4d size %" PRId64 "x%" PRId64
+                            "x%" PRId64 " with tile size %" PRId64 "x%" PRId64
+                            "x%" PRId64,
+                            m1, n1, k1, m0, n0, k0);
+  }
+  uint8_t* lhs_ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_vmvx_map_2d(args->r0, /*writable=*/false, args->i1,
+                                        lhs_stride, 1, m1, lhs_row_size,
+                                        sizeof(float), &lhs_ptr));
+  uint8_t* rhs_ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_vmvx_map_2d(args->r3, /*writable=*/false, args->i4,
+                                        rhs_stride, 1, n1, rhs_row_size,
+                                        sizeof(float), &rhs_ptr));
+  uint8_t* out_ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_vmvx_map_2d(args->r6, /*writable=*/true, args->i7,
+                                        out_stride, 1, m1, out_row_size,
+                                        sizeof(float), &out_ptr));
+  const float* lhs = (const float*)lhs_ptr;
+  const float* rhs = (const float*)rhs_ptr;
+  float* out = (float*)out_ptr;
+  for (int64_t i1 = 0; i1 < m1; ++i1) {
+    for (int64_t j1 = 0; j1 < n1; ++j1) {
+      float* IREE_RESTRICT out_tile = out + i1 * out_stride + j1 * m0 * n0;
+      if (!(flags & IREE_VMVX_MATMUL_FLAG_ACCUMULATE)) {
+        memset(out_tile, 0, m0 * n0 * sizeof(float));
+      }
+      for (int64_t l1 = 0; l1 < k1; ++l1) {
+        const float* IREE_RESTRICT lhs_tile =
+            lhs + i1 * lhs_stride + l1 * m0 * k0;
+        const float* IREE_RESTRICT rhs_tile =
+            rhs + j1 * rhs_stride + l1 * n0 * k0;
+        for (int64_t i0 = 0; i0 < m0; ++i0) {
+          for (int64_t j0 = 0; j0 < n0; ++j0) {
+            float acc = out_tile[i0 * n0 + j0];
+            for (int64_t l0 = 0; l0 < k0; ++l0) {
+              acc += lhs_tile[i0 * k0 + l0] * rhs_tile[j0 * k0 + l0];
+            }
+            out_tile[i0 * n0 + j0] = acc;
+          }
+        }
+      }
+    }
+  }
   return iree_ok_status();
 }
 
@@ -0,0 +1,291 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Tests the VMVX microkernels by invoking them directly on VM buffers.
+
+#include "iree/modules/vmvx/module.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/status_cc.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+#include "iree/vm/ref_cc.h"
+
+namespace iree {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+
+// An argument to a VMVX function: either a buffer or a primitive value.
+struct Arg {
+  iree_vm_buffer_t* buffer = nullptr;
+  iree_vm_value_t value;
+};
+static Arg Buffer(iree_vm_buffer_t* buffer) {
+  Arg arg;
+  arg.buffer = buffer;
+  return arg;
+}
+static Arg I32(int32_t value) {
+  Arg arg;
+  arg.value = iree_vm_value_make_i32(value);
+  return arg;
+}
+static Arg I64(int64_t value) {
+  Arg arg;
+  arg.value = iree_vm_value_make_i64(value);
+  return arg;
+}
+
+class VMVXModuleTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    IREE_CHECK_OK(iree_vm_register_builtin_types());
+  }
+
+  void SetUp() override {
+    IREE_CHECK_OK(iree_vm_instance_create(iree_allocator_system(), &instance_));
+    IREE_CHECK_OK(iree_vmvx_module_create(iree_allocator_system(), &module_));
+    IREE_CHECK_OK(iree_vm_context_create_with_modules(
+        instance_, IREE_VM_CONTEXT_FLAG_NONE, 1, &module_,
+        iree_allocator_system(), &context_));
+  }
+
+  void TearDown() override {
+    for (iree_vm_buffer_t* buffer : buffers_) iree_vm_buffer_release(buffer);
+    iree_vm_context_release(context_);
+    iree_vm_module_release(module_);
+    iree_vm_instance_release(instance_);
+  }
+
+  // Creates a buffer with the given |contents| that is released with the test.
+  template <typename T>
+  iree_vm_buffer_t* CreateBuffer(const std::vector<T>& contents) {
+    iree_vm_buffer_t* buffer = nullptr;
+    IREE_CHECK_OK(iree_vm_buffer_create(
+        IREE_VM_BUFFER_ACCESS_ORIGIN_HOST | IREE_VM_BUFFER_ACCESS_MUTABLE,
+        contents.size() * sizeof(T), iree_allocator_system(), &buffer));
+    IREE_CHECK_OK(iree_vm_buffer_write_elements(
+        contents.data(), buffer, /*target_offset=*/0, contents.size(),
+        sizeof(T)));
+    buffers_.push_back(buffer);
+    return buffer;
+  }
+
+  // Returns the contents of |buffer| as elements of type T.
+  template <typename T>
+  static std::vector<T> ReadBuffer(iree_vm_buffer_t* buffer) {
+    std::vector<T> contents(iree_vm_buffer_length(buffer) / sizeof(T));
+    IREE_CHECK_OK(iree_vm_buffer_read_elements(
+        buffer, /*source_offset=*/0, contents.data(), contents.size(),
+        sizeof(T)));
+    return contents;
+  }
+
+  Status Invoke(const char* function_name, const std::vector<Arg>& args) {
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(iree_vm_module_lookup_function_by_name(
+                             module_, IREE_VM_FUNCTION_LINKAGE_EXPORT,
+                             iree_make_cstring_view(function_name), &function),
+                         "exported function '%s' not found", function_name);
+    vm::ref<iree_vm_list_t> inputs;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(
+        /*element_type=*/nullptr, args.size(), iree_allocator_system(),
+        &inputs));
+    for (const Arg& arg : args) {
+      if (arg.buffer) {
+        iree_vm_ref_t ref = iree_vm_buffer_retain_ref(arg.buffer);
+        IREE_RETURN_IF_ERROR(iree_vm_list_push_ref_move(inputs.get(), &ref));
+      } else {
+        IREE_RETURN_IF_ERROR(
+            iree_vm_list_push_value(inputs.get(), &arg.value));
+      }
+    }
+    return iree_vm_invoke(context_, function, IREE_VM_INVOCATION_FLAG_NONE,
+                          /*policy=*/nullptr, inputs.get(),
+                          /*outputs=*/nullptr, iree_allocator_system());
+  }
+
+  iree_vm_instance_t* instance_ = nullptr;
+  iree_vm_module_t* module_ = nullptr;
+  iree_vm_context_t* context_ = nullptr;
+  std::vector<iree_vm_buffer_t*> buffers_;
+};
+
+// Copies a 2x3 matrix into the transposed 3x2 layout.
+TEST_F(VMVXModuleTest, Copy2DStrided) {
+  auto* in = CreateBuffer<uint32_t>({1, 2, 3, 4, 5, 6});
+  auto* out = CreateBuffer<uint32_t>(std::vector<uint32_t>(6, 0));
+  IREE_ASSERT_OK(Invoke("copy.2d.x32",
+                        {Buffer(in), I64(0), I64(3), I64(1),  //
+                         Buffer(out), I64(0), I64(1), I64(2),  //
+                         I64(2), I64(3)}));
+  EXPECT_THAT(ReadBuffer<uint32_t>(out), ElementsAre(1, 4, 2, 5, 3, 6));
+}
+
+// Copies contiguous rows with an offset into a larger row stride.
+TEST_F(VMVXModuleTest, Copy2DContiguousRows) {
+  auto* in = CreateBuffer<uint8_t>({1, 2, 3, 4});
+  auto* out = CreateBuffer<uint8_t>(std::vector<uint8_t>(8, 0));
+  IREE_ASSERT_OK(Invoke("copy.2d.x8",
+                        {Buffer(in), I64(0), I64(2), I64(1),  //
+                         Buffer(out), I64(1), I64(4), I64(1),  //
+                         I64(2), I64(2)}));
+  EXPECT_THAT(ReadBuffer<uint8_t>(out), ElementsAre(0, 1, 2, 0, 0, 3, 4, 0));
+}
+
+// Fills a 2x2 window of a 3x3 buffer.
+TEST_F(VMVXModuleTest, Fill2D) {
+  auto* out = CreateBuffer<uint32_t>(std::vector<uint32_t>(9, 0));
+  IREE_ASSERT_OK(Invoke("fill.2d.x32", {I32(7), Buffer(out), I64(4), I64(3),
+                                        I64(2), I64(2)}));
+  EXPECT_THAT(ReadBuffer<uint32_t>(out),
+              ElementsAre(0, 0, 0, 0, 7, 7, 0, 7, 7));
+}
+
+// Elementwise ops on contiguous 2x2 operands.
+TEST_F(VMVXModuleTest, Elementwise2D) {
+  auto* lhs = CreateBuffer<int32_t>({1, 2, 3, 4});
+  auto* rhs = CreateBuffer<int32_t>({10, 20, 30, 40});
+  auto* out = CreateBuffer<int32_t>(std::vector<int32_t>(4, 0));
+  auto args = [&]() -> std::vector<Arg> {
+    return {Buffer(lhs), I64(0), I64(2), I64(1),  //
+            Buffer(rhs), I64(0), I64(2), I64(1),  //
+            Buffer(out), I64(0), I64(2), I64(1),  //
+            I64(2),      I64(2)};
+  };
+  IREE_ASSERT_OK(Invoke("add.2d.i32", args()));
+  EXPECT_THAT(ReadBuffer<int32_t>(out), ElementsAre(11, 22, 33, 44));
+  IREE_ASSERT_OK(Invoke("sub.2d.i32", args()));
+  EXPECT_THAT(ReadBuffer<int32_t>(out), ElementsAre(-9, -18, -27, -36));
+  IREE_ASSERT_OK(Invoke("mul.2d.i32", args()));
+  EXPECT_THAT(ReadBuffer<int32_t>(out), ElementsAre(10, 40, 90, 160));
+}
+
+// Elementwise ops with a broadcast (stride 0) and strided operand.
+TEST_F(VMVXModuleTest, Elementwise2DBroadcast) {
+  auto* lhs = CreateBuffer<float>({1.0f, 2.0f});
+  auto* rhs = CreateBuffer<float>({0.5f, 2.5f, 1.5f, 3.5f});
+  auto* out = CreateBuffer<float>(std::vector<float>(4, 0.0f));
+  IREE_ASSERT_OK(Invoke("add.2d.f32",
+                        {Buffer(lhs), I64(0), I64(0), I64(1),  //
+                         Buffer(rhs), I64(0), I64(1), I64(2),  //
+                         Buffer(out), I64(0), I64(2), I64(1),  //
+                         I64(2), I64(2)}));
+  EXPECT_THAT(ReadBuffer<float>(out), ElementsAre(1.5f, 3.5f, 3.5f, 5.5f));
+}
+
+// `out (+)= lhs * rhs` with 2x3 lhs and 3x2 rhs.
+TEST_F(VMVXModuleTest, Matmul) {
+  auto* lhs = CreateBuffer<float>({1, 2, 3, 4, 5, 6});
+  auto* rhs = CreateBuffer<float>({7, 8, 9, 10, 11, 12});
+  auto* out = CreateBuffer<float>({1, 1, 1, 1});
+  auto args = [&](int32_t flags) -> std::vector<Arg> {
+    return {Buffer(lhs), I64(0), I64(3),  //
+            Buffer(rhs), I64(0), I64(2),  //
+            Buffer(out), I64(0), I64(2),  //
+            I64(2),      I64(2), I64(3),  //
+            I32(flags)};
+  };
+  IREE_ASSERT_OK(Invoke("matmul.f32f32f32", args(/*flags=*/0)));
+  EXPECT_THAT(ReadBuffer<float>(out), ElementsAre(58, 64, 139, 154));
+  IREE_ASSERT_OK(Invoke("matmul.f32f32f32", args(/*flags=*/1)));
+  EXPECT_THAT(ReadBuffer<float>(out), ElementsAre(116, 128, 278, 308));
+}
+
+// mmt4d with 2x1 lhs tiles and 2x1 rhs tiles over k1=2 checked against a
+// reference matmul of the unpacked operands.
+TEST_F(VMVXModuleTest, Mmt4d) {
+  const int m1 = 1, n1 = 2, k1 = 2, m0 = 2, n0 = 2, k0 = 1;
+  const int m = m1 * m0, n = n1 * n0, k = k1 * k0;
+  std::vector<float> lhs(m * k), rhs(n * k);
+  for (int i = 0; i < m * k; ++i) lhs[i] = (float)(i + 1);
+  for (int i = 0; i < n * k; ++i) rhs[i] = (float)(i * 2 - 3);
+  // Packs lhs[m][k] as [m1][k1][m0][k0] and rhs[n][k] as [n1][k1][n0][k0].
+  std::vector<float> packed_lhs(m * k), packed_rhs(n * k);
+  for (int i = 0; i < m; ++i) {
+    for (int l = 0; l < k; ++l) {
+      packed_lhs[((i / m0) * k1 + l / k0) * m0 * k0 + (i % m0) * k0 + l % k0] =
+          lhs[i * k + l];
+    }
+  }
+  for (int j = 0; j < n; ++j) {
+    for (int l = 0; l < k; ++l) {
+      packed_rhs[((j / n0) * k1 + l / k0) * n0 * k0 + (j % n0) * k0 + l % k0] =
+          rhs[j * k + l];
+    }
+  }
+  // Unpacks out[m1][n1][m0][n0] into out[m][n].
+  std::vector<float> expected(m * n, 0.0f);
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < n; ++j) {
+      for (int l = 0; l < k; ++l) {
+        expected[i * n + j] += lhs[i * k + l] * rhs[j * k + l];
+      }
+    }
+  }
+
+  auto* lhs_buffer = CreateBuffer<float>(packed_lhs);
+  auto* rhs_buffer = CreateBuffer<float>(packed_rhs);
+  auto* out_buffer = CreateBuffer<float>(std::vector<float>(m * n, 0.0f));
+  IREE_ASSERT_OK(Invoke(
+      "mmt4d.f32f32f32",
+      {Buffer(lhs_buffer), I64(0), I64(k1 * m0 * k0),  //
+       Buffer(rhs_buffer), I64(0), I64(k1 * n0 * k0),  //
+       Buffer(out_buffer), I64(0), I64(n1 * m0 * n0),  //
+       I64(m1), I64(n1), I64(k1), I32(m0), I32(n0), I32(k0), I32(0)}));
+  std::vector<float> packed_out = ReadBuffer<float>(out_buffer);
+  std::vector<float> actual(m * n);
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < n; ++j) {
+      actual[i * n + j] =
+          packed_out[((i / m0) * n1 + j / n0) * m0 * n0 + (i % m0) * n0 +
+                     j % n0];
+    }
+  }
+  EXPECT_THAT(actual, ElementsAreArray(expected));
+}
+
+// Views extending past the end of the buffer are rejected, including those
+// whose size computation would overflow.
+TEST_F(VMVXModuleTest, OutOfBoundsView) {
+  auto* in = CreateBuffer<uint32_t>({1, 2, 3, 4});
+  auto* out = CreateBuffer<uint32_t>(std::vector<uint32_t>(4, 0));
+  EXPECT_THAT(Invoke("copy.2d.x32", {Buffer(in), I64(1), I64(2), I64(1),  //
+                                     Buffer(out), I64(0), I64(2), I64(1),  //
+                                     I64(2), I64(2)}),
+              StatusIs(StatusCode::kOutOfRange));
+  EXPECT_THAT(
+      Invoke("copy.2d.x32", {Buffer(in), I64(0), I64(INT64_C(1) << 62), I64(1),
+                             Buffer(out), I64(0), I64(2), I64(1),  //
+                             I64(5), I64(1)}),
+      StatusIs(StatusCode::kOutOfRange));
+  EXPECT_THAT(Invoke("fill.2d.x32", {I32(7), Buffer(out), I64(0),
+                                     I64(INT64_MAX), I64(2), I64(1)}),
+              StatusIs(StatusCode::kOutOfRange));
+  EXPECT_THAT(ReadBuffer<uint32_t>(out), ElementsAre(0, 0, 0, 0));
+}
+
+// Read-only buffers cannot be used as outputs.
+TEST_F(VMVXModuleTest, ReadOnlyOutput) {
+  iree_vm_buffer_t* out = nullptr;
+  IREE_ASSERT_OK(iree_vm_buffer_create(IREE_VM_BUFFER_ACCESS_ORIGIN_HOST,
+                                       2 * sizeof(uint32_t),
+                                       iree_allocator_system(), &out));
+  buffers_.push_back(out);
+  EXPECT_THAT(Invoke("fill.2d.x32", {I32(7), Buffer(out), I64(0), I64(2),
+                                     I64(1), I64(2)}),
+              StatusIs(StatusCode::kPermissionDenied));
+}
+
+}  // namespace
+}  // namespace iree
@@ -94,7 +94,8 @@ IREE_API_EXPORT iree_status_t iree_runtime_session_create_with_device(
   // Lower-level usage of the VM can avoid the HAL if it's not required.
   iree_vm_module_t* hal_module = NULL;
   if (iree_status_is_ok(status)) {
-    status = iree_hal_module_create(device, host_allocator, &hal_module);
+    status = iree_hal_module_create(device, IREE_HAL_MODULE_FLAG_NONE,
+                                    host_allocator, &hal_module);
   }
   if (iree_status_is_ok(status)) {
     status = iree_vm_context_register_modules(
@@ -225,13 +226,14 @@ iree_runtime_session_append_bytecode_module_from_file(
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_TEXT(z0, file_path);
 
-  // TODO(#3909): actually map the memory here. For now we just load the
-  // contents.
+  // Map the file such that rodata (large constants and executables) is paged
+  // in on demand and shared with other processes mapping the same file.
   iree_file_contents_t* flatbuffer_contents = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_file_read_contents(file_path,
-                                  iree_runtime_session_host_allocator(session),
-                                  &flatbuffer_contents));
+      z0, iree_file_read_contents_with_flags(
+              file_path, IREE_FILE_READ_FLAG_MMAP,
+              iree_runtime_session_host_allocator(session),
+              &flatbuffer_contents));
 
   iree_status_t status =
       iree_runtime_session_append_bytecode_module_from_memory(
@@ -161,6 +161,8 @@ iree_runtime_session_append_bytecode_module_from_memory(
     iree_allocator_t flatbuffer_allocator);
 
 // Appends a bytecode module to the context loaded from the given |file_path|.
+// The file is memory mapped read-only where supported and must not be modified
+// for the lifetime of the session.
 //
 // NOTE: only valid if the context is not yet frozen; see
 // iree_vm_context_freeze for more information.
@@ -7,6 +7,7 @@
 #include "iree/task/api.h"
 
 #include <stdbool.h>
+#include <stdio.h>
 #include <string.h>
 
 #include "iree/base/internal/flags.h"
@@ -45,7 +46,21 @@ IREE_FLAG(
     "   Uses whatever the specified group count is and ignores the set mode.\n"
     " 'physical_cores':\n"
     "   Creates one group per physical core in the machine up to\n"
-    "   the value specified by --task_topology_max_group_count.\n");
+    "   the value specified by --task_topology_max_group_count.\n"
+    " 'l2_cache':\n"
+    "   Creates one group per physical core distributed across L2 caches.\n"
+    "   Workers prefer stealing from others sharing the same L2 cache.\n"
+    " 'l3_cache':\n"
+    "   Creates one group per physical core distributed across L3 caches.\n"
+    "   Workers prefer stealing from others sharing the same L3 cache.\n"
+    " 'numa_node':\n"
+    "   Creates one group per physical core distributed across NUMA nodes.\n"
+    "   Workers only steal from others on the same node. Combine with\n"
+    "   --task_topology_node_id= to use only a single node.\n"
+    " 'threadless':\n"
+    "   Creates no worker threads; all tasks are executed by the threads\n"
+    "   waiting on their results. Only for hosting applications that donate\n"
+    "   threads when waiting (such as the local-task HAL driver).\n");
 
 IREE_FLAG(
     int32_t, task_topology_group_count, 0,
@@ -60,18 +75,35 @@ IREE_FLAG(
     "detected and used when --task_topology_group_count=0 and is ignored\n"
     "otherwise.\n");
 
-// TODO(benvanik): add --task_topology_dump to dump out the current machine
-// configuration as seen by the topology utilities.
+IREE_FLAG(
+    int32_t, task_topology_node_id, -1,
+    "Restricts workers to cores on the given NUMA node when using one of the\n"
+    "cache or node --task_topology_mode= values. -1 uses all nodes.");
+
+IREE_FLAG(
+    bool, task_topology_dump, false,
+    "Prints the task system topology to stderr when the executor is created,\n"
+    "including worker placement and cache/node sharing.");
+
+IREE_FLAG(
+    bool, task_executor_per_node, false,
+    "Creates one executor per NUMA node when supported by the hosting\n"
+    "application (such as the local-task HAL driver, which exposes one device\n"
+    "per node). Each executor uses --task_topology_mode= restricted to its\n"
+    "node, with 'physical_cores' treated as 'numa_node', and\n"
+    "--task_topology_max_group_count= applies per node.");
 
 //===----------------------------------------------------------------------===//
 // Task system factory functions
 //===----------------------------------------------------------------------===//
 
-iree_status_t iree_task_executor_create_from_flags(
-    iree_allocator_t host_allocator, iree_task_executor_t** out_executor) {
-  IREE_ASSERT_ARGUMENT(out_executor);
-  *out_executor = NULL;
+// Creates an executor from flags restricted to |node_id|.
+// |node_id| may be IREE_TASK_TOPOLOGY_NODE_ID_ANY to use all nodes.
+static iree_status_t iree_task_executor_create_from_flags_for_node(
+    uint32_t node_id, iree_allocator_t host_allocator,
+    iree_task_executor_t** out_executor) {
   IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, node_id);
 
   iree_task_scheduling_mode_t scheduling_mode = 0;
   if (FLAG_task_scheduling_defer_worker_startup) {
@@ -90,8 +122,28 @@ iree_status_t iree_task_executor_create_from_flags(
     iree_task_topology_initialize_from_group_count(
         FLAG_task_topology_group_count, &topology);
   } else if (strcmp(FLAG_task_topology_mode, "physical_cores") == 0) {
-    iree_task_topology_initialize_from_physical_cores(
+    if (node_id == IREE_TASK_TOPOLOGY_NODE_ID_ANY) {
+      iree_task_topology_initialize_from_physical_cores(
+          FLAG_task_topology_max_group_count, &topology);
+    } else {
+      iree_task_topology_initialize_from_sharing_level(
+          IREE_TASK_TOPOLOGY_SHARING_LEVEL_NUMA_NODE, node_id,
+          FLAG_task_topology_max_group_count, &topology);
+    }
+  } else if (strcmp(FLAG_task_topology_mode, "l2_cache") == 0) {
+    iree_task_topology_initialize_from_sharing_level(
+        IREE_TASK_TOPOLOGY_SHARING_LEVEL_L2_CACHE, node_id,
         FLAG_task_topology_max_group_count, &topology);
+  } else if (strcmp(FLAG_task_topology_mode, "l3_cache") == 0) {
+    iree_task_topology_initialize_from_sharing_level(
+        IREE_TASK_TOPOLOGY_SHARING_LEVEL_L3_CACHE, node_id,
+        FLAG_task_topology_max_group_count, &topology);
+  } else if (strcmp(FLAG_task_topology_mode, "numa_node") == 0) {
+    iree_task_topology_initialize_from_sharing_level(
+        IREE_TASK_TOPOLOGY_SHARING_LEVEL_NUMA_NODE, node_id,
+        FLAG_task_topology_max_group_count, &topology);
+  } else if (strcmp(FLAG_task_topology_mode, "threadless") == 0) {
+    iree_task_topology_initialize_from_group_count(0, &topology);
   } else {
     status = iree_make_status(
         IREE_STATUS_INVALID_ARGUMENT,
@@ -100,6 +152,15 @@ iree_status_t iree_task_executor_create_from_flags(
         FLAG_task_topology_mode);
   }
 
+  if (iree_status_is_ok(status) && FLAG_task_topology_dump) {
+    fprintf(stderr, "--task_topology_mode=%s", FLAG_task_topology_mode);
+    if (node_id != IREE_TASK_TOPOLOGY_NODE_ID_ANY) {
+      fprintf(stderr, " (node %u)", node_id);
+    }
+    fprintf(stderr, "\n");
+    iree_task_topology_fprint(stderr, &topology);
+  }
+
   if (iree_status_is_ok(status)) {
     status = iree_task_executor_create(scheduling_mode, &topology,
                                        worker_local_memory, host_allocator,
@@ -111,3 +172,73 @@ iree_status_t iree_task_executor_create_from_flags(
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
+
+// Returns the node ID specified by --task_topology_node_id, if any.
+static uint32_t iree_task_topology_node_id_from_flags(void) {
+  return FLAG_task_topology_node_id < 0
+             ? IREE_TASK_TOPOLOGY_NODE_ID_ANY
+             : (uint32_t)FLAG_task_topology_node_id;
+}
+
+iree_status_t iree_task_executor_create_from_flags(
+    iree_allocator_t host_allocator, iree_task_executor_t** out_executor) {
+  IREE_ASSERT_ARGUMENT(out_executor);
+  *out_executor = NULL;
+  return iree_task_executor_create_from_flags_for_node(
+      iree_task_topology_node_id_from_flags(), host_allocator, out_executor);
+}
+
+iree_status_t iree_task_executors_create_from_flags(
+    iree_allocator_t host_allocator, iree_host_size_t executor_capacity,
+    iree_task_executor_t** out_executors, uint32_t* out_node_ids,
+    iree_host_size_t* out_executor_count) {
+  IREE_ASSERT_ARGUMENT(!executor_capacity || out_executors);
+  IREE_ASSERT_ARGUMENT(!executor_capacity || out_node_ids);
+  IREE_ASSERT_ARGUMENT(out_executor_count);
+  *out_executor_count = 0;
+  if (executor_capacity == 0) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "at least one executor must be requested");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Determine which nodes we'll be creating executors for. A node specified
+  // explicitly with --task_topology_node_id always results in one executor.
+  uint32_t base_node_id = iree_task_topology_node_id_from_flags();
+  iree_host_size_t executor_count = 1;
+  if (FLAG_task_executor_per_node &&
+      base_node_id == IREE_TASK_TOPOLOGY_NODE_ID_ANY) {
+    executor_count = iree_task_topology_query_node_count();
+    if (executor_count > executor_capacity) {
+      IREE_TRACE_ZONE_END(z0);
+      return iree_make_status(
+          IREE_STATUS_OUT_OF_RANGE,
+          "machine has %" PRIhsz " NUMA nodes but only %" PRIhsz
+          " executors can be created",
+          executor_count, executor_capacity);
+    }
+  }
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, executor_count);
+
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < executor_count; ++i) {
+    uint32_t node_id = base_node_id;
+    if (executor_count > 1) node_id = (uint32_t)i;
+    out_node_ids[i] = node_id;
+    status = iree_task_executor_create_from_flags_for_node(
+        node_id, host_allocator, &out_executors[i]);
+    if (!iree_status_is_ok(status)) {
+      for (iree_host_size_t j = 0; j < i; ++j) {
+        iree_task_executor_release(out_executors[j]);
+        out_executors[j] = NULL;
+      }
+      break;
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    *out_executor_count = executor_count;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -31,6 +31,20 @@ extern "C" {
 iree_status_t iree_task_executor_create_from_flags(
     iree_allocator_t host_allocator, iree_task_executor_t** out_executor);
 
+// Creates one or more task system executors from the current command line
+// flags. When --task_executor_per_node is set one executor is created for each
+// NUMA node in the machine with its workers pinned to that node; otherwise a
+// single executor is created as with iree_task_executor_create_from_flags.
+//
+// Up to |executor_capacity| executors are returned in |out_executors| and must
+// be released by the caller. |out_node_ids| receives the NUMA node each
+// executor is bound to or IREE_TASK_TOPOLOGY_NODE_ID_ANY if it spans nodes.
+// Callers can use the node ID to allocate memory local to the executor.
+iree_status_t iree_task_executors_create_from_flags(
+    iree_allocator_t host_allocator, iree_host_size_t executor_capacity,
+    iree_task_executor_t** out_executors, uint32_t* out_node_ids,
+    iree_host_size_t* out_executor_count);
+
 //===----------------------------------------------------------------------===//
 // Task system simple invocation utilities
 //===----------------------------------------------------------------------===//
@@ -10,6 +10,7 @@
 #include <stddef.h>
 #include <string.h>
 
+#include "iree/base/internal/fpu_state.h"
 #include "iree/base/internal/math.h"
 #include "iree/base/tracing.h"
 #include "iree/task/affinity_set.h"
@@ -22,6 +23,17 @@
 #include "iree/task/tuning.h"
 #include "iree/task/worker.h"
 
+#if defined(IREE_COMPILER_MSVC)
+#define IREE_TASK_THREAD_LOCAL __declspec(thread)
+#else
+#define IREE_TASK_THREAD_LOCAL _Thread_local
+#endif  // IREE_COMPILER_MSVC
+
+// The executor the current thread holds the donor_mutex of, if any. Used to
+// detect reentrant donation from tasks executing on a donated thread.
+static IREE_TASK_THREAD_LOCAL iree_task_executor_t*
+    iree_task_executor_current_donee_ = NULL;
+
 static void iree_task_executor_destroy(iree_task_executor_t* executor);
 
 iree_status_t iree_task_executor_create(
@@ -37,18 +49,19 @@ iree_status_t iree_task_executor_create(
         IREE_TASK_EXECUTOR_MAX_WORKER_COUNT);
   }
 
-  // TODO(benvanik): support a threadless mode where we have one dummy worker
-  // that just holds the lists but is pumped from donate_caller.
-  if (worker_count == 0) {
-    return iree_make_status(
-        IREE_STATUS_UNIMPLEMENTED,
-        "threadless donate-only executor mode not yet implemented");
-  }
-
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_ASSERT_ARGUMENT(out_executor);
   *out_executor = NULL;
 
+  // Threadless executors have a single worker without a thread that holds the
+  // task lists and is pumped by donated threads. Otherwise we allocate one
+  // additional threadless worker past the end of the workers list for use by
+  // donated threads.
+  const bool threadless = worker_count == 0;
+  if (threadless) worker_count = 1;
+  iree_host_size_t worker_storage_count =
+      threadless ? worker_count : worker_count + 1;
+
   // The executor is followed in memory by worker[] + worker_local_memory[].
   // The whole point is that we don't want destructive sharing between workers
   // so ensure we are aligned to at least the destructive interference size.
@@ -59,10 +72,11 @@ iree_status_t iree_task_executor_create(
       iree_host_align(sizeof(iree_task_executor_t),
                       iree_hardware_destructive_interference_size);
   iree_host_size_t worker_list_size =
-      iree_host_align(worker_count * sizeof(iree_task_worker_t),
+      iree_host_align(worker_storage_count * sizeof(iree_task_worker_t),
                       iree_hardware_destructive_interference_size);
-  iree_host_size_t executor_size = executor_base_size + worker_list_size +
-                                   worker_count * worker_local_memory_size;
+  iree_host_size_t executor_size =
+      executor_base_size + worker_list_size +
+      worker_storage_count * worker_local_memory_size;
 
   iree_task_executor_t* executor = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
@@ -73,6 +87,7 @@ iree_status_t iree_task_executor_create(
   executor->scheduling_mode = scheduling_mode;
   iree_atomic_task_slist_initialize(&executor->incoming_ready_slist);
   iree_slim_mutex_initialize(&executor->coordinator_mutex);
+  iree_slim_mutex_initialize(&executor->donor_mutex);
 
   // Simple PRNG used to generate seeds for the per-worker PRNGs used to
   // distribute work. This isn't strong (and doesn't need to be); it's just
@@ -83,8 +98,6 @@ iree_status_t iree_task_executor_create(
   iree_prng_splitmix64_state_t seed_prng;
   iree_prng_splitmix64_initialize(/*seed=*/(uint64_t)(out_executor),
                                   &seed_prng);
-  iree_prng_minilcg128_initialize(iree_prng_splitmix64_next(&seed_prng),
-                                  &executor->donation_theft_prng);
 
   iree_status_t status = iree_ok_status();
 
@@ -127,6 +140,32 @@ iree_status_t iree_task_executor_create(
     uint8_t* worker_local_memory =
         (uint8_t*)executor->workers + worker_list_size;
 
+    // The donor worker is initialized first as it cannot fail. When not
+    // threadless it steals from any worker but is never itself a target for
+    // task placement or theft.
+    if (threadless) {
+      executor->donor_worker = &executor->workers[0];
+      iree_task_topology_group_t donor_group;
+      iree_task_topology_group_initialize(0, &donor_group);
+      iree_task_worker_initialize_threadless(
+          executor, 0, &donor_group,
+          iree_make_byte_span(worker_local_memory, worker_local_memory_size),
+          &seed_prng, executor->donor_worker);
+    } else {
+      executor->donor_worker = &executor->workers[worker_count];
+      iree_task_topology_group_t donor_group;
+      iree_task_topology_group_initialize((uint8_t)worker_count, &donor_group);
+      donor_group.constructive_sharing_mask = 0;
+      iree_task_worker_initialize_threadless(
+          executor, worker_count, &donor_group,
+          iree_make_byte_span(
+              worker_local_memory + worker_count * worker_local_memory_size,
+              worker_local_memory_size),
+          &seed_prng, executor->donor_worker);
+      executor->donor_worker->worker_bit = 0;
+      executor->donor_worker->max_theft_attempts = (uint32_t)worker_count;
+    }
+
     iree_task_affinity_set_t worker_idle_mask = 0;
     iree_task_affinity_set_t worker_live_mask = 0;
     iree_task_affinity_set_t worker_suspend_mask = 0;
@@ -134,6 +173,7 @@ iree_status_t iree_task_executor_create(
       iree_task_affinity_set_t worker_bit = iree_task_affinity_for_worker(i);
       worker_idle_mask |= worker_bit;
       worker_live_mask |= worker_bit;
+      if (threadless) break;  // donor worker already initialized
       if (executor->scheduling_mode &
           IREE_TASK_SCHEDULING_MODE_DEFER_WORKER_STARTUP) {
         worker_suspend_mask |= worker_bit;
@@ -202,9 +242,14 @@ static void iree_task_executor_destroy(iree_task_executor_t* executor) {
     iree_task_worker_t* worker = &executor->workers[i];
     iree_task_worker_deinitialize(worker);
   }
+  if (executor->donor_worker &&
+      !iree_task_executor_is_threadless(executor)) {
+    iree_task_worker_deinitialize(executor->donor_worker);
+  }
   iree_task_poller_deinitialize(&executor->poller);
 
   iree_event_pool_free(executor->event_pool);
+  iree_slim_mutex_deinitialize(&executor->donor_mutex);
   iree_slim_mutex_deinitialize(&executor->coordinator_mutex);
   iree_atomic_task_slist_deinitialize(&executor->incoming_ready_slist);
   iree_task_pool_deinitialize(&executor->transient_task_pool);
@@ -239,6 +284,10 @@ iree_host_size_t iree_task_executor_worker_count(
   return executor->worker_count;
 }
 
+bool iree_task_executor_is_threadless(iree_task_executor_t* executor) {
+  return executor->donor_worker == &executor->workers[0];
+}
+
 iree_event_pool_t* iree_task_executor_event_pool(
     iree_task_executor_t* executor) {
   return executor->event_pool;
@@ -463,37 +512,38 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Returns the index of the |n|th set bit in |mask|.
+// |mask| must have more than |n| bits set.
+static int iree_task_affinity_set_select_nth_one(iree_task_affinity_set_t mask,
+                                                 int n) {
+  for (; n > 0; --n) mask &= mask - 1;  // clear lowest set bit
+  return iree_task_affinity_set_count_trailing_zeros(mask);
+}
+
 static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
     iree_task_executor_t* executor, iree_task_affinity_set_t victim_mask,
-    uint32_t max_theft_attempts, int rotation_offset,
+    uint32_t max_theft_attempts, iree_prng_minilcg128_state_t* theft_prng,
     iree_task_queue_t* local_task_queue) {
   if (!victim_mask) return NULL;
-  max_theft_attempts = iree_min(max_theft_attempts,
-                                iree_task_affinity_set_count_ones(victim_mask));
-  victim_mask = iree_task_affinity_set_rotr(victim_mask, rotation_offset);
-
-  int worker_index = rotation_offset;
-  iree_task_affinity_set_t mask =
-      iree_task_affinity_set_rotr(victim_mask, worker_index);
+  int victim_count = iree_task_affinity_set_count_ones(victim_mask);
+  max_theft_attempts = iree_min(max_theft_attempts, (uint32_t)victim_count);
   for (uint32_t i = 0; i < max_theft_attempts; ++i) {
-    // Find the last set bit and skip to it. This avoids the need for doing
-    // a full O(n) scan and instead gets us at O(popcnt) * O(ctz).
+    // Select a victim uniformly at random from those we haven't yet tried.
+    // Removing each victim from the mask as we go ensures we never try the same
+    // worker twice and prevents biasing any particular try ordering.
     //
-    // Example: sharing mask = 0b01010101
-    //          mask_rotation = 3 (randomly selected)
-    //          mask = 0b01010101 rotr 3 = 0b10101010
-    //          for (i = 0; i < 4; ++i)
-    //            offset = ctz(0b10101010) = 1
-    //            mask_rotation += 1 = 4
-    //            mask >>= 1 = 0b01010101
-    //            victim_index = 4 % 64 = 4
-    int offset = iree_task_affinity_set_count_trailing_zeros(mask);
-    int victim_index = (worker_index + offset) % executor->worker_count;
-    worker_index += offset + 1;
-    mask = iree_shr(mask, offset + 1);
+    // Example: victim_mask = 0b01010100 (3 victims)
+    //          n = prng % 3 = 1
+    //          victim_index = 4 (second set bit)
+    //          victim_mask = 0b01000100
+    int n = (int)(iree_prng_minilcg128_next_uint8(theft_prng) %
+                  (uint32_t)victim_count);
+    int victim_index = iree_task_affinity_set_select_nth_one(victim_mask, n);
+    victim_mask &= ~iree_task_affinity_for_worker(victim_index);
+    --victim_count;
     iree_task_worker_t* victim_worker = &executor->workers[victim_index];
 
-    // Policy: steal a chunk of tasks at the tail of the victim queue.
+    // Policy: steal a chunk of tasks at the top of the victim deque.
     // This will steal multiple tasks from the victim up to the specified max
     // and move the them into our local task queue. Not all tasks will be stolen
     // and the assumption is that over a large-enough random distribution of
@@ -516,17 +566,16 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
 // We do a scan through ideal victims indicated by the
 // |constructive_sharing_mask|; these are the workers most likely to have some
 // cache benefits to taking their work as they share some level of the cache
-// hierarchy and should be better to steal from than any random worker.
+// hierarchy (L2/L3) and should be better to steal from than any random worker.
 //
 // To prevent biasing any particular victim we use a fast prng function to
-// select where in the set of potential victims defined by the topology
-// group we steal. We (probably) don't need anything super complex here so
-// instead of bouncing around at random we just select the starting point in
-// our search and then go in-order.
+// select each victim uniformly at random from the remaining candidates in the
+// set of potential victims defined by the topology group.
 iree_task_t* iree_task_executor_try_steal_task(
     iree_task_executor_t* executor,
     iree_task_affinity_set_t constructive_sharing_mask,
-    uint32_t max_theft_attempts, iree_prng_minilcg128_state_t* theft_prng,
+    iree_task_affinity_set_t theft_mask, uint32_t max_theft_attempts,
+    iree_prng_minilcg128_state_t* theft_prng,
     iree_task_queue_t* local_task_queue) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -537,16 +586,10 @@ iree_task_t* iree_task_executor_try_steal_task(
       iree_atomic_task_affinity_set_load(&executor->worker_idle_mask,
                                          iree_memory_order_relaxed);
   // Limit the workers we will steal from to the ones that are currently live
-  // and not idle.
-  iree_task_affinity_set_t victim_mask = worker_live_mask & ~worker_idle_mask;
-
-  // TODO(benvanik): it may be possible to rework this such that we better
-  // use the prng; for example, instead of all this rotating stuff we could just
-  // generate an 8-bit number (or even split it into two 4-bit numbers) per
-  // theft attempt. The current rotation strategy is biased toward the same try
-  // ordering vs. what we may really want with an unbiased random selection.
-  int rotation_offset = iree_prng_minilcg128_next_uint8(theft_prng) &
-                        (8 * sizeof(iree_task_affinity_set_t) - 1);
+  // and not idle and that the topology allows us to steal from (such as those
+  // on the same NUMA node).
+  iree_task_affinity_set_t victim_mask =
+      worker_live_mask & ~worker_idle_mask & theft_mask;
 
   // Try first with the workers we may have some caches shared with. This
   // helps to prevent cache invalidations/availability updates as it's likely
@@ -554,13 +597,13 @@ iree_task_t* iree_task_executor_try_steal_task(
   // event that the thief and victim are running close to each other in time.
   iree_task_t* task = iree_task_executor_try_steal_task_from_affinity_set(
       executor, victim_mask & constructive_sharing_mask, max_theft_attempts,
-      rotation_offset, local_task_queue);
+      theft_prng, local_task_queue);
   if (task) {
     IREE_TRACE_ZONE_APPEND_TEXT(z0, "local");
   } else {
     task = iree_task_executor_try_steal_task_from_affinity_set(
         executor, victim_mask & ~constructive_sharing_mask, max_theft_attempts,
-        rotation_offset, local_task_queue);
+        theft_prng, local_task_queue);
     if (task) {
       IREE_TRACE_ZONE_APPEND_TEXT(z0, "non-local");
     }
@@ -570,20 +613,147 @@ iree_task_t* iree_task_executor_try_steal_task(
   return task;
 }
 
+// Hands any tasks the donor worker stole but did not execute back to the worker
+// threads. The donor is never a target for theft and the tasks would otherwise
+// not run until the next donation.
+static void iree_task_executor_return_donor_tasks(
+    iree_task_executor_t* executor) {
+  iree_task_worker_t* donor_worker = executor->donor_worker;
+  if (iree_task_queue_is_empty(&donor_worker->local_task_queue)) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_task_post_batch_t* post_batch =
+      iree_alloca(sizeof(iree_task_post_batch_t) +
+                  executor->worker_count * sizeof(iree_task_list_t));
+  iree_task_post_batch_initialize(executor, donor_worker, post_batch);
+  iree_task_t* task = NULL;
+  while ((task = iree_task_queue_pop_front(&donor_worker->local_task_queue))) {
+    iree_task_executor_relay_to_worker(executor, post_batch, task);
+  }
+  iree_task_post_batch_submit(post_batch);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Pumps the donor worker from the calling thread one task at a time until
+// |wait_source| resolves or |timeout| is reached. The caller must hold the
+// donor_mutex.
+static iree_status_t iree_task_executor_pump_donor(
+    iree_task_executor_t* executor, iree_wait_source_t wait_source,
+    iree_timeout_t timeout) {
+  iree_task_worker_t* donor_worker = executor->donor_worker;
+  const bool threadless = iree_task_executor_is_threadless(executor);
+  const iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
+
+  // Match the FPU state used by the worker threads as we may be executing the
+  // same tasks.
+  iree_fpu_state_t fpu_state =
+      iree_fpu_state_push(IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
+
+  iree_status_t status = iree_ok_status();
+  while (true) {
+    // Tasks posted to a threadless executor wake the donor worker; we prepare
+    // the wait before pumping so that we can't miss any.
+    iree_wait_token_t wait_token =
+        iree_notification_prepare_wait(&donor_worker->wake_notification);
+
+    bool did_work = iree_task_worker_pump_donated(donor_worker);
+
+    iree_status_code_t wait_status_code = IREE_STATUS_OK;
+    status = iree_wait_source_query(wait_source, &wait_status_code);
+    if (!iree_status_is_ok(status) ||
+        wait_status_code != IREE_STATUS_DEFERRED) {
+      iree_notification_cancel_wait(&donor_worker->wake_notification);
+      break;
+    } else if (did_work) {
+      iree_notification_cancel_wait(&donor_worker->wake_notification);
+      if (iree_time_now() >= deadline_ns) {
+        status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+        break;
+      }
+      continue;
+    }
+
+    if (!threadless) {
+      // Nothing left to steal; the worker threads will complete the remaining
+      // tasks and we can just block.
+      iree_notification_cancel_wait(&donor_worker->wake_notification);
+      status = iree_wait_source_wait_one(wait_source, timeout);
+      break;
+    }
+
+    // Threadless: sleep until more tasks arrive (such as from the poller when a
+    // wait resolves) or it's time to check the wait source again.
+    iree_time_t now_ns = iree_time_now();
+    if (now_ns >= deadline_ns) {
+      iree_notification_cancel_wait(&donor_worker->wake_notification);
+      status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+      break;
+    }
+    IREE_TRACE_ZONE_BEGIN_NAMED(z_wait, "iree_task_executor_donor_wait");
+    iree_time_t poll_deadline_ns =
+        iree_min(deadline_ns, now_ns + IREE_TASK_EXECUTOR_DONOR_POLL_PERIOD_NS);
+    iree_notification_commit_wait(&donor_worker->wake_notification, wait_token,
+                                  poll_deadline_ns);
+    IREE_TRACE_ZONE_END(z_wait);
+  }
+
+  iree_fpu_state_pop(fpu_state);
+
+  if (!threadless) iree_task_executor_return_donor_tasks(executor);
+
+  // If the wait source resolved (possibly with a failure) return its result.
+  if (iree_status_is_ok(status)) {
+    status = iree_wait_source_wait_one(wait_source, iree_immediate_timeout());
+  }
+  return status;
+}
+
 iree_status_t iree_task_executor_donate_caller(iree_task_executor_t* executor,
                                                iree_wait_source_t wait_source,
                                                iree_timeout_t timeout) {
   IREE_TRACE_ZONE_BEGIN(z0);
+  iree_convert_timeout_to_absolute(&timeout);
 
   // Perform an immediate flush/coordination (in case the caller queued).
   iree_task_executor_flush(executor);
 
-  // Wait until completed.
-  // TODO(benvanik): make this steal tasks until wait_handle resolves?
-  // Somewhat dangerous as we don't know what kind of thread we are running on;
-  // it may have a smaller stack than we are expecting or have some weird thread
-  // local state (FPU rounding modes/etc).
-  iree_status_t status = iree_wait_source_wait_one(wait_source, timeout);
+  // A task running on this thread as part of an outer donation is donating
+  // again. The donor worker is busy executing that task and cannot be pumped
+  // reentrantly; with worker threads we can wait on them but a threadless
+  // executor would never complete the work.
+  const bool threadless = iree_task_executor_is_threadless(executor);
+  if (iree_task_executor_current_donee_ == executor) {
+    iree_status_t status =
+        threadless ? iree_make_status(
+                         IREE_STATUS_FAILED_PRECONDITION,
+                         "reentrant donation to a threadless executor from a "
+                         "task it is executing would deadlock; tasks must not "
+                         "block on work scheduled on their own executor")
+                   : iree_wait_source_wait_one(wait_source, timeout);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  // Only one thread at a time may own the donor worker. Threadless executors
+  // have no other way of making progress and must wait their turn while others
+  // can fall back to waiting on the worker threads.
+  bool is_donor = false;
+  if (threadless) {
+    iree_slim_mutex_lock(&executor->donor_mutex);
+    is_donor = true;
+  } else {
+    is_donor = iree_slim_mutex_try_lock(&executor->donor_mutex);
+  }
+
+  iree_status_t status = iree_ok_status();
+  if (is_donor) {
+    iree_task_executor_t* parent_donee = iree_task_executor_current_donee_;
+    iree_task_executor_current_donee_ = executor;
+    status = iree_task_executor_pump_donor(executor, wait_source, timeout);
+    iree_task_executor_current_donee_ = parent_donee;
+    iree_slim_mutex_unlock(&executor->donor_mutex);
+  } else {
+    status = iree_wait_source_wait_one(wait_source, timeout);
+  }
 
   IREE_TRACE_ZONE_END(z0);
   return status;
@@ -135,8 +135,8 @@ extern "C" {
 //    each worker will check its mailbox_slist to see if any tasks have been
 //    posted.
 //
-//    a. Tasks are flushed from the LIFO mailbox into the local_task_queue FIFO
-//       for the particular worker.
+//    a. Tasks are flushed from the LIFO mailbox into the local_task_queue deque
+//       for the particular worker such that they are popped in FIFO order.
 //
 //    b. If the mailbox is empty the worker *may* attempt to steal work from
 //       another nearby worker in the topology.
@@ -296,6 +296,12 @@ typedef struct iree_task_executor_t iree_task_executor_t;
 // amount of memory for their invocations and no more. May be 0 if no worker
 // local memory is required.
 //
+// If |topology| has no groups the executor is created in threadless mode: no
+// worker threads are created and all tasks are executed by threads donated to
+// the executor with iree_task_executor_donate_caller. This avoids all
+// cross-thread wakes for latency-sensitive workloads small enough that a single
+// core suffices but requires that every wait on executor work donates.
+//
 // |topology| is only used during creation and need not live beyond this call.
 // |out_executor| must be released by the caller.
 iree_status_t iree_task_executor_create(
@@ -318,6 +324,11 @@ void iree_task_executor_trim(iree_task_executor_t* executor);
 iree_host_size_t iree_task_executor_worker_count(
     iree_task_executor_t* executor);
 
+// Returns true if the executor has no worker threads and only makes progress
+// on threads donated with iree_task_executor_donate_caller. All blocking waits
+// on work submitted to a threadless executor must donate the waiting thread.
+bool iree_task_executor_is_threadless(iree_task_executor_t* executor);
+
 // Returns an iree_event_t pool managed by the executor.
 // Users of the task system should acquire their transient events from this.
 // Long-lived events should be allocated on their own in order to avoid
@@ -364,7 +375,19 @@ void iree_task_executor_flush(iree_task_executor_t* executor);
 // If there are no tasks available then the calling thread will block as if
 // iree_wait_source_wait_one had been used on |wait_source|. If tasks are ready
 // then the caller will not block prior to starting to perform work on behalf of
-// the executor.
+// the executor. Only one thread may be donated at a time: while another thread
+// is donated callers will block on |wait_source| (or, in threadless executors,
+// until the other thread has finished its donation).
+//
+// In threadless executors the donated thread executes all tasks until the
+// |wait_source| resolves. Otherwise it steals tasks from the worker threads
+// until none remain and then blocks.
+//
+// Tasks executing on a donated thread may themselves donate: with worker
+// threads available the nested call blocks on |wait_source| as the other
+// workers are able to make progress. Nested donation to a threadless executor
+// could never complete as the only thread able to run tasks is blocked in the
+// task that is donating and it fails with IREE_STATUS_FAILED_PRECONDITION.
 //
 // Donation is intended as an optimization to elide context switches when the
 // caller would have waited anyway; now instead of performing a kernel wait and
@@ -34,13 +34,15 @@ struct iree_task_executor_t {
   // TODO(benvanik): make mutable; currently always the same reserved value.
   iree_task_scheduling_mode_t scheduling_mode;
 
-  // State used by the work-stealing operations performed by donated threads.
-  // This is **NOT SYNCHRONIZED** and relies on the fact that we actually don't
-  // much care about the precise selection of workers enough to mind any tears
-  // we get in the PRNG state that lives inside. Cache write-back order and
-  // incidental cache line availability/visibility update frequency is like an
-  // extra layer of PRNG anyway ;)
-  iree_prng_minilcg128_state_t donation_theft_prng;
+  // Guards the donor worker; only one thread at a time may be donated to the
+  // executor with iree_task_executor_donate_caller and pump tasks.
+  iree_slim_mutex_t donor_mutex;
+
+  // Threadless worker pumped by the thread holding the donor_mutex.
+  // In threadless executors this is workers[0] and all tasks are routed to it.
+  // Otherwise it is not part of any worker set and only steals tasks from the
+  // worker threads into its local queue.
+  iree_task_worker_t* donor_worker;
 
   // Pools of transient dispatch tasks shared across all workers.
   // Depending on configuration the task pool may allocate after creation using
@@ -136,12 +138,15 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
                                    iree_task_worker_t* current_worker);
 
 // Tries to steal an entire task from a sibling worker (based on topology).
+// Only workers in |theft_mask| are considered and those in
+// |constructive_sharing_mask| are tried first.
 // Returns a task that is available (has not yet begun processing at all).
 // May steal multiple tasks and add them to the |local_task_queue|.
 iree_task_t* iree_task_executor_try_steal_task(
     iree_task_executor_t* executor,
     iree_task_affinity_set_t constructive_sharing_mask,
-    uint32_t max_theft_attempts, iree_prng_minilcg128_state_t* theft_prng,
+    iree_task_affinity_set_t theft_mask, uint32_t max_theft_attempts,
+    iree_prng_minilcg128_state_t* theft_prng,
     iree_task_queue_t* local_task_queue);
 
 #ifdef __cplusplus
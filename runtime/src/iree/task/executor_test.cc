@@ -6,13 +6,18 @@
 
 #include "iree/task/executor.h"
 
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <thread>
 
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
 
 namespace {
 
+using iree::testing::status::StatusIs;
+
 // Tests that an executor can be created and destroyed repeatedly without
 // running out of system resources. Since all systems are different there's no
 // guarantee this will fail but it does give ASAN/TSAN some nice stuff to chew
@@ -136,4 +141,281 @@ TEST(ExecutorTest, SubmissionStress) {
   iree_task_topology_deinitialize(&topology);
 }
 
+// Tests that a threadless executor runs all work on the donated thread.
+TEST(ExecutorTest, Threadless) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/0, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(
+      IREE_TASK_SCHEDULING_MODE_RESERVED, &topology,
+      /*worker_local_memory_size=*/0, iree_allocator_system(), &executor));
+  EXPECT_EQ(1, iree_task_executor_worker_count(executor));
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+  for (int i = 0; i < 100; ++i) {
+    static std::atomic<int> received_value = {0};
+    static std::thread::id received_thread_id;
+    iree_task_call_t call;
+    iree_task_call_initialize(
+        &scope,
+        iree_task_make_call_closure(
+            [](void* user_context, iree_task_t* task,
+               iree_task_submission_t* pending_submission) {
+              received_value = (int)(uintptr_t)user_context;
+              received_thread_id = std::this_thread::get_id();
+              return iree_ok_status();
+            },
+            (void*)(uintptr_t)i),
+        &call);
+
+    iree_task_fence_t* fence = NULL;
+    IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&call.header, &fence->header);
+
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &call.header);
+    iree_task_executor_submit(executor, &submission);
+
+    // Nothing will run until we donate.
+    IREE_ASSERT_OK(iree_task_executor_donate_caller(
+        executor, iree_task_scope_await_idle(&scope), iree_infinite_timeout()));
+
+    EXPECT_EQ(received_value, i) << "call did not correlate to loop";
+    EXPECT_EQ(received_thread_id, std::this_thread::get_id());
+  }
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests that donating to an executor with workers completes the work whether
+// the donated thread manages to steal any of it or not.
+TEST(ExecutorTest, DonateCaller) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/4, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(
+      IREE_TASK_SCHEDULING_MODE_RESERVED, &topology,
+      /*worker_local_memory_size=*/0, iree_allocator_system(), &executor));
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+  static std::atomic<int> call_count = {0};
+  for (int i = 0; i < 100; ++i) {
+    iree_task_fence_t* fence = NULL;
+    IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_call_t calls[8];
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    for (size_t j = 0; j < IREE_ARRAYSIZE(calls); ++j) {
+      iree_task_call_initialize(
+          &scope,
+          iree_task_make_call_closure(
+              [](void* user_context, iree_task_t* task,
+                 iree_task_submission_t* pending_submission) {
+                ++call_count;
+                return iree_ok_status();
+              },
+              NULL),
+          &calls[j]);
+      iree_task_set_completion_task(&calls[j].header, &fence->header);
+      iree_task_submission_enqueue(&submission, &calls[j].header);
+    }
+    iree_task_executor_submit(executor, &submission);
+    IREE_ASSERT_OK(iree_task_executor_donate_caller(
+        executor, iree_task_scope_await_idle(&scope), iree_infinite_timeout()));
+    EXPECT_EQ(call_count, (i + 1) * (int)IREE_ARRAYSIZE(calls));
+  }
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests that a task executing on a thread donated to a threadless executor
+// is rejected when it tries to donate again instead of deadlocking.
+TEST(ExecutorTest, ThreadlessReentrantDonation) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/0, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(
+      IREE_TASK_SCHEDULING_MODE_RESERVED, &topology,
+      /*worker_local_memory_size=*/0, iree_allocator_system(), &executor));
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+  static iree_status_code_t nested_status_code = IREE_STATUS_OK;
+  iree_task_call_t call;
+  iree_task_call_initialize(
+      &scope,
+      iree_task_make_call_closure(
+          [](void* user_context, iree_task_t* task,
+             iree_task_submission_t* pending_submission) {
+            iree_task_executor_t* executor =
+                (iree_task_executor_t*)user_context;
+            // Waits on a source that never resolves: were the donation to
+            // proceed it would hang forever.
+            nested_status_code = iree_status_consume_code(
+                iree_task_executor_donate_caller(
+                    executor,
+                    iree_wait_source_delay(IREE_TIME_INFINITE_FUTURE),
+                    iree_infinite_timeout()));
+            return iree_ok_status();
+          },
+          executor),
+      &call);
+  iree_task_fence_t* fence = NULL;
+  IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+  iree_task_set_completion_task(&call.header, &fence->header);
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &call.header);
+  iree_task_executor_submit(executor, &submission);
+
+  IREE_ASSERT_OK(iree_task_executor_donate_caller(
+      executor, iree_task_scope_await_idle(&scope), iree_infinite_timeout()));
+  EXPECT_EQ(nested_status_code, IREE_STATUS_FAILED_PRECONDITION);
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Submits |call_count| call tasks to |executor| that each sleep for
+// |duration_ms| and count themselves in |out_completed_count|.
+static void SubmitSleepCalls(iree_task_executor_t* executor,
+                             iree_task_scope_t* scope, iree_task_call_t* calls,
+                             iree_host_size_t call_count, int duration_ms,
+                             std::atomic<int>* out_completed_count) {
+  static int sleep_duration_ms = 0;
+  sleep_duration_ms = duration_ms;
+  iree_task_fence_t* fence = NULL;
+  IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, scope, &fence));
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  for (iree_host_size_t i = 0; i < call_count; ++i) {
+    iree_task_call_initialize(
+        scope,
+        iree_task_make_call_closure(
+            [](void* user_context, iree_task_t* task,
+               iree_task_submission_t* pending_submission) {
+              std::this_thread::sleep_for(
+                  std::chrono::milliseconds(sleep_duration_ms));
+              ++*(std::atomic<int>*)user_context;
+              return iree_ok_status();
+            },
+            out_completed_count),
+        &calls[i]);
+    iree_task_set_completion_task(&calls[i].header, &fence->header);
+    iree_task_submission_enqueue(&submission, &calls[i].header);
+  }
+  iree_task_executor_submit(executor, &submission);
+}
+
+// Tests that a donor with a short timeout returns while long work is queued on
+// a threadless executor instead of running all of it.
+TEST(ExecutorTest, ThreadlessDonationTimeout) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/0, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(
+      IREE_TASK_SCHEDULING_MODE_RESERVED, &topology,
+      /*worker_local_memory_size=*/0, iree_allocator_system(), &executor));
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+  std::atomic<int> completed_count = {0};
+  iree_task_call_t calls[32];
+  SubmitSleepCalls(executor, &scope, calls, IREE_ARRAYSIZE(calls),
+                   /*duration_ms=*/10, &completed_count);
+
+  // Running everything would take >=320ms.
+  iree_time_t start_ns = iree_time_now();
+  EXPECT_THAT(iree::Status(iree_task_executor_donate_caller(
+                  executor, iree_task_scope_await_idle(&scope),
+                  iree_make_timeout_ms(15))),
+              StatusIs(iree::StatusCode::kDeadlineExceeded));
+  EXPECT_LT(iree_time_now() - start_ns, 200 * 1000000ll);
+  EXPECT_LT(completed_count, (int)IREE_ARRAYSIZE(calls));
+
+  // The remaining work runs on the next donation.
+  IREE_ASSERT_OK(iree_task_executor_donate_caller(
+      executor, iree_task_scope_await_idle(&scope), iree_infinite_timeout()));
+  EXPECT_EQ(completed_count, (int)IREE_ARRAYSIZE(calls));
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests that a donor stops as soon as its wait source resolves even if more
+// work is queued.
+TEST(ExecutorTest, ThreadlessDonationWaitResolves) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/0, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(
+      IREE_TASK_SCHEDULING_MODE_RESERVED, &topology,
+      /*worker_local_memory_size=*/0, iree_allocator_system(), &executor));
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+  std::atomic<int> completed_count = {0};
+  iree_task_call_t calls[32];
+  SubmitSleepCalls(executor, &scope, calls, IREE_ARRAYSIZE(calls),
+                   /*duration_ms=*/10, &completed_count);
+
+  IREE_ASSERT_OK(iree_task_executor_donate_caller(
+      executor, iree_wait_source_delay(iree_time_now() + 15 * 1000000ll),
+      iree_infinite_timeout()));
+  EXPECT_LT(completed_count, (int)IREE_ARRAYSIZE(calls));
+
+  IREE_ASSERT_OK(iree_task_executor_donate_caller(
+      executor, iree_task_scope_await_idle(&scope), iree_infinite_timeout()));
+  EXPECT_EQ(completed_count, (int)IREE_ARRAYSIZE(calls));
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests that a donor with a short timeout returns while long stealable work is
+// queued on a worker and that any work it stole but did not run is completed
+// by the workers afterward.
+TEST(ExecutorTest, DonationTimeoutWithStealableWork) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/1, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(
+      IREE_TASK_SCHEDULING_MODE_RESERVED, &topology,
+      /*worker_local_memory_size=*/0, iree_allocator_system(), &executor));
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+  std::atomic<int> completed_count = {0};
+  iree_task_call_t calls[32];
+  SubmitSleepCalls(executor, &scope, calls, IREE_ARRAYSIZE(calls),
+                   /*duration_ms=*/20, &completed_count);
+
+  // Running everything would take >=320ms even with the donor helping.
+  iree_time_t start_ns = iree_time_now();
+  EXPECT_THAT(iree::Status(iree_task_executor_donate_caller(
+                  executor, iree_task_scope_await_idle(&scope),
+                  iree_make_timeout_ms(15))),
+              StatusIs(iree::StatusCode::kDeadlineExceeded));
+  EXPECT_LT(iree_time_now() - start_ns, 200 * 1000000ll);
+
+  // The worker completes everything without another donation.
+  IREE_ASSERT_OK(iree_task_scope_wait_idle(
+      &scope, iree_time_now() + 10 * 1000000000ll));
+  EXPECT_EQ(completed_count, (int)IREE_ARRAYSIZE(calls));
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
 }  // namespace
@@ -51,6 +51,11 @@ void iree_task_post_batch_initialize(iree_task_executor_t* executor,
 iree_host_size_t iree_task_post_batch_worker_count(
     const iree_task_post_batch_t* post_batch);
 
+// Returns the live workers in |affinity_set| that tasks may be posted to.
+// If no workers in |affinity_set| are live then all live workers are returned.
+iree_task_affinity_set_t iree_task_post_batch_worker_mask(
+    iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set);
+
 // Selects a random worker from the given affinity set.
 iree_host_size_t iree_task_post_batch_select_worker(
     iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set);
@@ -9,83 +9,242 @@
 #include <stddef.h>
 #include <string.h>
 
+static_assert((IREE_TASK_QUEUE_CAPACITY & (IREE_TASK_QUEUE_CAPACITY - 1)) == 0,
+              "queue capacity must be a power of two");
+#define IREE_TASK_QUEUE_SLOT_MASK (IREE_TASK_QUEUE_CAPACITY - 1)
+
+// Set in a slot when the task it holds must not be stolen by other workers.
+// Tasks are at least pointer aligned so the low bit of the pointer is free.
+#define IREE_TASK_QUEUE_SLOT_PINNED ((intptr_t)1)
+
+//===----------------------------------------------------------------------===//
+// Chase-Lev deque primitives
+//===----------------------------------------------------------------------===//
+// The memory orderings here follow "Correct and Efficient Work-Stealing for
+// Weak Memory Models" (Lê et al. 2013) with the simplification that our ring is
+// fixed-size and never needs to be grown.
+
+// Pushes |task| at the bottom of the deque if there is space available.
+// Must only be called by the owner.
+static bool iree_task_queue_try_push_bottom(iree_task_queue_t* queue,
+                                            iree_task_t* task) {
+  int64_t bottom =
+      iree_atomic_load_int64(&queue->bottom, iree_memory_order_relaxed);
+  int64_t top = iree_atomic_load_int64(&queue->top, iree_memory_order_acquire);
+  // NOTE: |top| may be stale but can only have moved forward, so at worst we
+  // conservatively report the deque as full.
+  if (bottom - top >= IREE_TASK_QUEUE_CAPACITY) return false;
+  intptr_t slot = (intptr_t)task;
+  if (iree_task_is_pinned(task)) slot |= IREE_TASK_QUEUE_SLOT_PINNED;
+  iree_atomic_store_intptr(&queue->slots[bottom & IREE_TASK_QUEUE_SLOT_MASK],
+                           slot, iree_memory_order_relaxed);
+  // Publish the slot (and the task contents) before thieves can observe the
+  // new bottom.
+  iree_atomic_thread_fence(iree_memory_order_release);
+  iree_atomic_store_int64(&queue->bottom, bottom + 1,
+                          iree_memory_order_relaxed);
+  return true;
+}
+
+// Takes the newest task from the bottom of the deque, if any.
+// Must only be called by the owner.
+static iree_task_t* iree_task_queue_take_bottom(iree_task_queue_t* queue) {
+  int64_t bottom =
+      iree_atomic_load_int64(&queue->bottom, iree_memory_order_relaxed) - 1;
+  iree_atomic_store_int64(&queue->bottom, bottom, iree_memory_order_relaxed);
+  // Our reservation of the bottom slot must be visible to thieves before we
+  // check |top| to see if they have raced us for it.
+  iree_atomic_thread_fence(iree_memory_order_seq_cst);
+  int64_t top = iree_atomic_load_int64(&queue->top, iree_memory_order_relaxed);
+  if (top > bottom) {
+    // Deque was empty; restore bottom.
+    iree_atomic_store_int64(&queue->bottom, bottom + 1,
+                            iree_memory_order_relaxed);
+    return NULL;
+  }
+  intptr_t slot =
+      iree_atomic_load_intptr(&queue->slots[bottom & IREE_TASK_QUEUE_SLOT_MASK],
+                              iree_memory_order_relaxed);
+  iree_task_t* task = (iree_task_t*)(slot & ~IREE_TASK_QUEUE_SLOT_PINNED);
+  if (top == bottom) {
+    // Last task in the deque: race any thieves for it by advancing top.
+    if (!iree_atomic_compare_exchange_strong_int64(
+            &queue->top, &top, top + 1, iree_memory_order_seq_cst,
+            iree_memory_order_relaxed)) {
+      task = NULL;  // lost to a thief
+    }
+    iree_atomic_store_int64(&queue->bottom, bottom + 1,
+                            iree_memory_order_relaxed);
+  }
+  return task;
+}
+
+// Steals the oldest task from the top of the deque, if any.
+// May be called from any thread. Returns NULL if the deque was empty, the task
+// was taken by another thread while we were trying to steal it, or the task is
+// pinned and |steal_pinned| is false. Only the owner may steal pinned tasks.
+static iree_task_t* iree_task_queue_steal_top(iree_task_queue_t* queue,
+                                              bool steal_pinned) {
+  int64_t top = iree_atomic_load_int64(&queue->top, iree_memory_order_acquire);
+  iree_atomic_thread_fence(iree_memory_order_seq_cst);
+  int64_t bottom =
+      iree_atomic_load_int64(&queue->bottom, iree_memory_order_acquire);
+  if (top >= bottom) return NULL;
+  intptr_t slot =
+      iree_atomic_load_intptr(&queue->slots[top & IREE_TASK_QUEUE_SLOT_MASK],
+                              iree_memory_order_relaxed);
+  // The pinned bit is checked without dereferencing the task as it may already
+  // have been taken and retired by the owner.
+  if ((slot & IREE_TASK_QUEUE_SLOT_PINNED) && !steal_pinned) return NULL;
+  iree_task_t* task = (iree_task_t*)(slot & ~IREE_TASK_QUEUE_SLOT_PINNED);
+  if (!iree_atomic_compare_exchange_strong_int64(
+          &queue->top, &top, top + 1, iree_memory_order_seq_cst,
+          iree_memory_order_relaxed)) {
+    return NULL;  // lost to the owner or another thief
+  }
+  return task;
+}
+
+// Pushes |task| at the bottom of the deque such that it is the next popped by
+// the owner. If the deque is full the task at the top (the one the owner would
+// get to last) is evicted to the front of the overflow list to make space.
+// This preserves the owner processing order of deque-then-overflow.
+// Must only be called by the owner.
+static void iree_task_queue_push_bottom(iree_task_queue_t* queue,
+                                        iree_task_t* task) {
+  while (!iree_task_queue_try_push_bottom(queue, task)) {
+    // NOTE: thieves may take the top task before we can; in that case there is
+    // now space for the push and we retry.
+    iree_task_t* evicted_task =
+        iree_task_queue_steal_top(queue, /*steal_pinned=*/true);
+    if (evicted_task) {
+      iree_task_list_push_front(&queue->overflow_list, evicted_task);
+    }
+  }
+}
+
+// Moves up to a deque worth of tasks from the overflow list into the deque.
+// Tasks are pushed in reverse so that they are popped in overflow list order.
+// Must only be called by the owner when the deque is empty such that no tasks
+// are evicted back to the overflow list.
+static void iree_task_queue_refill_from_overflow(iree_task_queue_t* queue) {
+  iree_task_list_t batch;
+  iree_task_list_initialize(&batch);
+  for (iree_host_size_t i = 0; i < IREE_TASK_QUEUE_CAPACITY; ++i) {
+    iree_task_t* task = iree_task_list_pop_front(&queue->overflow_list);
+    if (!task) break;
+    iree_task_list_push_front(&batch, task);
+  }
+  iree_task_t* task = batch.head;
+  while (task) {
+    // NOTE: the task may be stolen and retired as soon as it is pushed so we
+    // must read its next pointer first.
+    iree_task_t* next_task = task->next_task;
+    iree_task_queue_push_bottom(queue, task);
+    task = next_task;
+  }
+}
+
+// Pushes a LIFO linked list of tasks starting at |head| so that the tail of
+// the list will be the first popped by the owner.
+static void iree_task_queue_push_lifo_tasks(iree_task_queue_t* queue,
+                                            iree_task_t* head) {
+  iree_task_t* task = head;
+  while (task) {
+    iree_task_t* next_task = task->next_task;
+    iree_task_queue_push_bottom(queue, task);
+    task = next_task;
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// iree_task_queue_t
+//===----------------------------------------------------------------------===//
+
 void iree_task_queue_initialize(iree_task_queue_t* out_queue) {
   memset(out_queue, 0, sizeof(*out_queue));
-  iree_slim_mutex_initialize(&out_queue->mutex);
-  iree_task_list_initialize(&out_queue->list);
+  iree_task_list_initialize(&out_queue->overflow_list);
 }
 
 void iree_task_queue_deinitialize(iree_task_queue_t* queue) {
-  iree_task_list_discard(&queue->list);
-  iree_slim_mutex_deinitialize(&queue->mutex);
+  iree_task_list_t remaining_tasks;
+  iree_task_list_initialize(&remaining_tasks);
+  iree_task_t* task = NULL;
+  while ((task = iree_task_queue_take_bottom(queue)) != NULL) {
+    iree_task_list_push_front(&remaining_tasks, task);
+  }
+  iree_task_list_append(&remaining_tasks, &queue->overflow_list);
+  iree_task_list_discard(&remaining_tasks);
 }
 
 bool iree_task_queue_is_empty(iree_task_queue_t* queue) {
-  iree_slim_mutex_lock(&queue->mutex);
-  bool is_empty = iree_task_list_is_empty(&queue->list);
-  iree_slim_mutex_unlock(&queue->mutex);
-  return is_empty;
+  int64_t top = iree_atomic_load_int64(&queue->top, iree_memory_order_relaxed);
+  int64_t bottom =
+      iree_atomic_load_int64(&queue->bottom, iree_memory_order_relaxed);
+  return bottom <= top && iree_task_list_is_empty(&queue->overflow_list);
 }
 
 void iree_task_queue_push_front(iree_task_queue_t* queue, iree_task_t* task) {
-  iree_slim_mutex_lock(&queue->mutex);
-  iree_task_list_push_front(&queue->list, task);
-  iree_slim_mutex_unlock(&queue->mutex);
+  iree_task_queue_push_bottom(queue, task);
 }
 
 void iree_task_queue_append_from_lifo_list_unsafe(iree_task_queue_t* queue,
                                                   iree_task_list_t* list) {
-  // NOTE: reversing the list outside of the lock.
-  iree_task_list_reverse(list);
-  iree_slim_mutex_lock(&queue->mutex);
-  iree_task_list_append(&queue->list, list);
-  iree_slim_mutex_unlock(&queue->mutex);
+  iree_task_queue_push_lifo_tasks(queue, list->head);
+  iree_task_list_initialize(list);
 }
 
 iree_task_t* iree_task_queue_flush_from_lifo_slist(
     iree_task_queue_t* queue, iree_atomic_task_slist_t* source_slist) {
-  // Perform the flush and swap outside of the lock; acquiring the list is
-  // atomic and then we own it exclusively.
-  iree_task_list_t suffix;
-  iree_task_list_initialize(&suffix);
-  const bool did_flush = iree_atomic_task_slist_flush(
-      source_slist, IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_FIFO,
-      &suffix.head, &suffix.tail);
-
-  // Append the tasks and pop off the front for return.
-  iree_slim_mutex_lock(&queue->mutex);
-  if (did_flush) iree_task_list_append(&queue->list, &suffix);
-  iree_task_t* next_task = iree_task_list_pop_front(&queue->list);
-  iree_slim_mutex_unlock(&queue->mutex);
-
-  return next_task;
+  // Acquiring the list is atomic and then we own it exclusively. We keep it in
+  // LIFO order so that pushing walks from newest to oldest and the owner pops
+  // in FIFO order.
+  iree_task_t* head = NULL;
+  iree_task_t* tail = NULL;
+  if (iree_atomic_task_slist_flush(source_slist,
+                                   IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_LIFO,
+                                   &head, &tail)) {
+    iree_task_queue_push_lifo_tasks(queue, head);
+  }
+  return iree_task_queue_pop_front(queue);
 }
 
 iree_task_t* iree_task_queue_pop_front(iree_task_queue_t* queue) {
-  iree_slim_mutex_lock(&queue->mutex);
-  iree_task_t* next_task = iree_task_list_pop_front(&queue->list);
-  iree_slim_mutex_unlock(&queue->mutex);
+  iree_task_t* next_task = iree_task_queue_take_bottom(queue);
+  // NOTE: thieves may steal everything we refill before we get to it so we
+  // loop until we get a task or the overflow list is exhausted.
+  while (!next_task && !iree_task_list_is_empty(&queue->overflow_list)) {
+    iree_task_queue_refill_from_overflow(queue);
+    next_task = iree_task_queue_take_bottom(queue);
+  }
   return next_task;
 }
 
 iree_task_t* iree_task_queue_try_steal(iree_task_queue_t* source_queue,
                                        iree_task_queue_t* target_queue,
                                        iree_host_size_t max_tasks) {
-  // First attempt to steal up to max_tasks from the source queue.
-  iree_task_list_t stolen_tasks;
-  iree_task_list_initialize(&stolen_tasks);
-  if (iree_slim_mutex_try_lock(&source_queue->mutex)) {
-    iree_task_list_split(&source_queue->list, max_tasks, &stolen_tasks);
-    iree_slim_mutex_unlock(&source_queue->mutex);
-  }
+  // Estimate how many tasks are available so that we take at most ~half. This
+  // races with the owner and other thieves and is only used as a bound.
+  int64_t top =
+      iree_atomic_load_int64(&source_queue->top, iree_memory_order_relaxed);
+  int64_t bottom =
+      iree_atomic_load_int64(&source_queue->bottom, iree_memory_order_relaxed);
+  if (bottom <= top) return NULL;
+  iree_host_size_t steal_count =
+      iree_min(max_tasks, (iree_host_size_t)((bottom - top + 1) / 2));
 
-  // Add any stolen tasks to the target queue and pop off the head for return.
-  iree_task_t* next_task = NULL;
-  if (!iree_task_list_is_empty(&stolen_tasks)) {
-    iree_slim_mutex_lock(&target_queue->mutex);
-    iree_task_list_append(&target_queue->list, &stolen_tasks);
-    next_task = iree_task_list_pop_front(&target_queue->list);
-    iree_slim_mutex_unlock(&target_queue->mutex);
+  // Steal one task at a time from the top of the source deque. All but the most
+  // recently stolen task are pushed to the target queue such that the target
+  // owner processes them in the order the source owner would have.
+  iree_task_t* next_task =
+      iree_task_queue_steal_top(source_queue, /*steal_pinned=*/false);
+  if (!next_task) return NULL;
+  for (iree_host_size_t i = 1; i < steal_count; ++i) {
+    iree_task_t* task =
+        iree_task_queue_steal_top(source_queue, /*steal_pinned=*/false);
+    if (!task) break;
+    iree_task_queue_push_bottom(target_queue, next_task);
+    next_task = task;
   }
   return next_task;
 }
@@ -10,66 +10,46 @@
 #include <stdbool.h>
 
 #include "iree/base/api.h"
-#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/task/list.h"
 #include "iree/task/task.h"
+#include "iree/task/tuning.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif  // __cplusplus
 
-// A simple work-stealing LIFO queue modeled on a Chase-Lev concurrent deque.
+// A work-stealing deque implementing the Chase-Lev concurrent deque.
 // This is used by workers to maintain their thread-local working lists. The
-// workers keep the tasks they will process in FIFO order. They allow it to
-// empty and then refresh it with more tasks from the incoming worker mailbox.
-// The performance bias here is to the workers as they are >90% of the
-// accesses and the only other accesses are thieves that hopefully we can just
-// improve our distribution to vs. introducing a slowdown here.
-//
-// A futex is used to synchronize access; because the common case is that of
-// only the worker that owns the queue touching it for pushing and popping items
-// this puts us into the sweet-spot of uncontended lightweight exclusive locks.
-// Since futices are effectively just single machine words managed with atomic
-// ops we can avoid a lot of the traditional atomic tomfoolery one finds in
-// systems like these that originated prior to the introduction of futices while
-// also keeping the tiny overhead of the pure atomic solutions.
-//
-// We can also take advantage of the futex providing an actual exclusive region
-// such that our data structure can be whatever we want as opposed to needing to
-// be something that someone had figured out how to make atomic. For example,
-// common implementations of work-stealing queues are all bounded as unbounded
-// atomic deques are an unsolved problem in CS.
+// owning worker pushes and pops tasks at the bottom of the deque in LIFO order
+// while other workers may concurrently steal tasks from the top in FIFO order.
+// The performance bias here is to the owner as it is >90% of the accesses:
+// pushing and popping are a handful of relaxed loads/stores and a fence with an
+// atomic compare-exchange only required when racing with a thief for the last
+// task in the deque. Thieves only ever contend with each other on |top|.
 //
 // Very rarely when another worker runs out of work it'll try to steal tasks
-// from nearby workers and use this queue type to do it: the assumption is that
-// it's better to take the last task the victim worker will get to so that in a
-// long list of tasks it remains chugging through the head of the list with good
-// cache locality. If we end up with a lot of theft, though, it's possible for
-// the cache benefits of the pop_back approach to the worker to outweigh the
-// cache pessimism for all thieves. Let's hope we can schedule deterministic-
-// enough tiles such that theft is rare!
-//
-// Our queue variant here is tuned for the use case we have: we exclusively
-// push in multiple tasks at a time (flushed from the mailbox) and exclusively
-// pop a single task a time (what to work on next). The stealing part is batched
-// so that when a remote worker has to perform a theft it takes a good chunk of
-// tasks in one go (hopefully roughly half) to reduce the total overhead when
+// from nearby workers: the assumption is that it's better to take the last
+// task the victim worker will get to so that in a long list of tasks it remains
+// chugging through the bottom of the deque with good cache locality. Stealing
+// is batched so that when a remote worker has to perform a theft it takes a
+// good chunk of tasks (up to roughly half) to reduce the total overhead when
 // there is high imbalance in workloads.
 //
-// Flushing from the mailbox slist (LIFO) to our list (FIFO) requires a full
-// walk of the incoming task linked list. This is generally fine as the number
-// of tasks in any given flush is low(ish) and by walking in reverse order to
-// then process forward the cache should be hot as the worker starts making its
-// way back through the tasks. As we walk forward we'll be using the task fields
-// for execution and retiring of tasks (notifing dependencies/etc) and the
-// intrusive next pointer sitting next to those should be in-cache when we need
-// to access it. This, combined with slab allocation of tasks in command buffers
-// to begin with gives us the (probabilistically) same characteristics of a flat
-// array walked with an index as is common in other work queues but with the
-// flexibility to reorder tasks as we see fit (theft, redistribution/rotation,
-// reprioritization, etc).
+// Batches of tasks (flushed from the mailbox or appended from a list) are
+// pushed in reverse so that the owner pops them in their original FIFO order
+// and thieves take the tasks the owner would have gotten to last.
 //
-// Similar concepts, though implemented with atomics:
+// Classic work-stealing deques are bounded and our deque uses a fixed ring of
+// IREE_TASK_QUEUE_CAPACITY slots. Because the number of tasks flushed to a
+// worker is unbounded pushing to a full deque evicts the task at the top (the
+// one the owner would process last) into an owner-private overflow list that
+// is processed after the deque. This keeps pushed tasks at the front of the
+// queue and batches in FIFO order regardless of how many tasks spill. Tasks in
+// the overflow list are not visible to thieves until the owner drains the
+// deque and refills it from the overflow list.
+//
+// References:
 //   "Dynamic Circular Work-Stealing Deque":
 //   http://citeseerx.ist.psu.edu/viewdoc/download?doi=10.1.1.170.1097&rep=rep1&type=pdf
 //   "Correct and Efficient Work-Stealing for Weak Memory Models":
@@ -78,36 +58,34 @@ extern "C" {
 //   https://blog.molecular-matters.com/2015/08/24/job-system-2-0-lock-free-work-stealing-part-1-basics/
 //
 // Useful diagram from https://github.com/injinj/WSQ
-// Much of this implementation is inspired from that; though significant
-// reworking was required for our FIFO->LIFO->FIFO sandwich.
-//  +--------+ <- tasks[0]
-//  |  top   | <- stealers consume here: task = tasks[top++]
+//  +--------+ <- slots[0]
+//  |  top   | <- stealers consume here: task = slots[top++]
 //  |        |
 //  |   ||   |
 //  |        |
 //  |   vv   |
-//  | bottom | <- owner pushes here:    tasks[bottom++] = task
-//  |        |    owner consumes here:  task = tasks[--bottom]
+//  | bottom | <- owner pushes here:    slots[bottom++] = task
+//  |        |    owner consumes here:  task = slots[--bottom]
 //  |        |
-//  +--------+ <- tasks[IREE_TASK_QUEUE_CAPACITY-1]
-//
-// Unlike that implementation, though, our task list is unbounded because we use
-// a linked list. To keep our options open, though, I've left the API of this
-// implementation compatible with classic atomic work-stealing queues. I'm
-// hopeful this will not need to be revisted for awhile, though!
+//  +--------+ <- slots[IREE_TASK_QUEUE_CAPACITY-1]
 //
-// Future improvement idea: have the owner of the queue maintain a theft point
-// skip list that makes it possible for thieves to quickly come in and slice
-// off batches of tasks at the tail of the queue. Since we are a singly-linked
-// list we can't easily just walk backward and we don't want to be introducing
-// cache line contention as thieves start touching the same tasks as the worker
-// is while processing.
+// |top| and |bottom| are monotonically increasing 64-bit indices that are
+// wrapped into the slot ring and as such will never overflow in practice.
 typedef struct iree_task_queue_t {
-  // Must be held when manipulating the queue. >90% accesses are by the owner.
-  iree_slim_mutex_t mutex;
+  // Index of the oldest task in the deque. Thieves steal from here.
+  iree_atomic_int64_t top;
+  uint8_t top_padding[iree_hardware_destructive_interference_size -
+                      sizeof(iree_atomic_int64_t)];
 
-  // FIFO task list.
-  iree_task_list_t list IREE_GUARDED_BY(mutex);
+  // Index one past the newest task in the deque. Only the owner modifies this.
+  iree_atomic_int64_t bottom;
+
+  // FIFO list of tasks that did not fit in the deque. Only the owner may
+  // access this and it is drained into the deque as the deque empties.
+  iree_task_list_t overflow_list;
+
+  // Ring of iree_task_t* slots indexed by |top| and |bottom|.
+  iree_atomic_intptr_t slots[IREE_TASK_QUEUE_CAPACITY];
 } iree_task_queue_t;
 
 // Initializes a work-stealing task queue in-place.
@@ -119,6 +97,8 @@ void iree_task_queue_deinitialize(iree_task_queue_t* queue);
 
 // Returns true if the queue is empty.
 // Note that due to races this may return both false-positives and -negatives.
+//
+// Must only be called from the owning worker's thread.
 bool iree_task_queue_is_empty(iree_task_queue_t* queue);
 
 // Pushes a task to the front of the queue.
@@ -148,13 +128,18 @@ iree_task_t* iree_task_queue_flush_from_lifo_slist(
 // Must only be called from the owning worker's thread.
 iree_task_t* iree_task_queue_pop_front(iree_task_queue_t* queue);
 
-// Tries to steal up to |max_tasks| from the back of the queue.
+// Tries to steal up to |max_tasks| from the top of the queue.
 // Returns NULL if no tasks are available and otherwise up to |max_tasks| tasks
-// that were at the tail of the |source_queue| will be moved to the
-// |target_queue| and the first of the stolen tasks is returned.
+// (and no more than roughly half of the deque) that the |source_queue| owner
+// would have processed last will be moved to the |target_queue| and the last of
+// the stolen tasks is returned.
+//
+// Tasks with an affinity set restricted to a subset of workers are pinned to
+// the queue they were pushed to and are never stolen. Stealing stops at the
+// first pinned task found at the top of |source_queue|.
 //
-// It's expected this is not called from the queue's owning worker, though it's
-// valid to do so.
+// May be called from any thread but |target_queue| must be owned by the
+// calling thread.
 iree_task_t* iree_task_queue_try_steal(iree_task_queue_t* source_queue,
                                        iree_task_queue_t* target_queue,
                                        iree_host_size_t max_tasks);
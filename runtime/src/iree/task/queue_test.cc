@@ -6,6 +6,10 @@
 
 #include "iree/task/queue.h"
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include "iree/testing/gtest.h"
 
 namespace {
@@ -193,6 +197,32 @@ TEST(QueueTest, TryStealEmpty) {
   iree_task_queue_deinitialize(&target_queue);
 }
 
+TEST(QueueTest, TryStealPinned) {
+  iree_task_queue_t source_queue;
+  iree_task_queue_initialize(&source_queue);
+  iree_task_queue_t target_queue;
+  iree_task_queue_initialize(&target_queue);
+
+  iree_task_t task_a = {0};
+  task_a.affinity_set = iree_task_affinity_for_worker(1);
+  iree_task_queue_push_front(&source_queue, &task_a);
+  iree_task_t task_b = {0};
+  task_b.affinity_set = iree_task_affinity_for_any_worker();
+  iree_task_queue_push_front(&source_queue, &task_b);
+
+  // Pinned tasks at the top of the queue stop thieves.
+  EXPECT_EQ(NULL, iree_task_queue_try_steal(&source_queue, &target_queue, 1));
+  EXPECT_TRUE(iree_task_queue_is_empty(&target_queue));
+
+  // The owner still processes pinned tasks.
+  EXPECT_EQ(&task_b, iree_task_queue_pop_front(&source_queue));
+  EXPECT_EQ(&task_a, iree_task_queue_pop_front(&source_queue));
+  EXPECT_TRUE(iree_task_queue_is_empty(&source_queue));
+
+  iree_task_queue_deinitialize(&source_queue);
+  iree_task_queue_deinitialize(&target_queue);
+}
+
 TEST(QueueTest, TryStealLast) {
   iree_task_queue_t source_queue;
   iree_task_queue_initialize(&source_queue);
@@ -250,13 +280,13 @@ TEST(QueueTest, TryStealIntoExisting) {
   iree_task_t task_existing = {0};
   iree_task_queue_push_front(&target_queue, &task_existing);
 
-  EXPECT_EQ(&task_existing,
+  EXPECT_EQ(&task_b,
             iree_task_queue_try_steal(&source_queue, &target_queue, 1));
 
   EXPECT_EQ(&task_a, iree_task_queue_pop_front(&source_queue));
   EXPECT_TRUE(iree_task_queue_is_empty(&source_queue));
 
-  EXPECT_EQ(&task_b, iree_task_queue_pop_front(&target_queue));
+  EXPECT_EQ(&task_existing, iree_task_queue_pop_front(&target_queue));
   EXPECT_TRUE(iree_task_queue_is_empty(&target_queue));
 
   iree_task_queue_deinitialize(&source_queue);
@@ -319,4 +349,113 @@ TEST(QueueTest, TryStealAll) {
   iree_task_queue_deinitialize(&target_queue);
 }
 
+// Pushes more tasks than fit in the deque and ensures they all come back out
+// in FIFO order via the overflow list.
+TEST(QueueTest, AppendListOverflow) {
+  iree_task_queue_t queue;
+  iree_task_queue_initialize(&queue);
+
+  const size_t task_count = IREE_TASK_QUEUE_CAPACITY * 2 + 3;
+  std::vector<iree_task_t> tasks(task_count);
+  iree_task_list_t list = {0};
+  for (size_t i = 0; i < task_count; ++i) {
+    iree_task_list_push_front(&list, &tasks[i]);
+  }
+
+  iree_task_queue_append_from_lifo_list_unsafe(&queue, &list);
+  EXPECT_TRUE(iree_task_list_is_empty(&list));
+
+  // Tasks spilled to the overflow list must still be popped in FIFO order.
+  for (size_t i = 0; i < task_count; ++i) {
+    EXPECT_EQ(&tasks[i], iree_task_queue_pop_front(&queue));
+  }
+  EXPECT_TRUE(iree_task_queue_is_empty(&queue));
+  EXPECT_FALSE(iree_task_queue_pop_front(&queue));
+
+  iree_task_queue_deinitialize(&queue);
+}
+
+// Tests that tasks pushed to the front of a full queue are popped first.
+TEST(QueueTest, PushFrontOverflow) {
+  iree_task_queue_t queue;
+  iree_task_queue_initialize(&queue);
+
+  const size_t task_count = IREE_TASK_QUEUE_CAPACITY + 3;
+  std::vector<iree_task_t> tasks(task_count);
+  iree_task_list_t list = {0};
+  for (size_t i = 0; i < task_count; ++i) {
+    iree_task_list_push_front(&list, &tasks[i]);
+  }
+  iree_task_queue_append_from_lifo_list_unsafe(&queue, &list);
+
+  iree_task_t task_a = {0};
+  iree_task_queue_push_front(&queue, &task_a);
+  iree_task_t task_b = {0};
+  iree_task_queue_push_front(&queue, &task_b);
+
+  EXPECT_EQ(&task_b, iree_task_queue_pop_front(&queue));
+  EXPECT_EQ(&task_a, iree_task_queue_pop_front(&queue));
+  for (size_t i = 0; i < task_count; ++i) {
+    EXPECT_EQ(&tasks[i], iree_task_queue_pop_front(&queue));
+  }
+  EXPECT_TRUE(iree_task_queue_is_empty(&queue));
+
+  iree_task_queue_deinitialize(&queue);
+}
+
+// Has the owner pop tasks while several thieves steal concurrently and ensures
+// every task is received by exactly one thread.
+TEST(QueueTest, ConcurrentSteal) {
+  static constexpr int kThiefCount = 4;
+  static constexpr size_t kTaskCount = 64 * 1024;
+  std::vector<iree_task_t> tasks(kTaskCount);
+  std::vector<std::atomic<int>> hits(kTaskCount);
+  for (auto& hit : hits) hit = 0;
+
+  iree_task_queue_t source_queue;
+  iree_task_queue_initialize(&source_queue);
+  std::atomic<bool> done{false};
+
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < kThiefCount; ++i) {
+    thieves.emplace_back([&]() {
+      iree_task_queue_t target_queue;
+      iree_task_queue_initialize(&target_queue);
+      while (!done.load()) {
+        iree_task_t* task =
+            iree_task_queue_try_steal(&source_queue, &target_queue, 4);
+        while (task) {
+          ++hits[task - tasks.data()];
+          task = iree_task_queue_pop_front(&target_queue);
+        }
+      }
+      iree_task_queue_deinitialize(&target_queue);
+    });
+  }
+
+  // Push in small batches and pop some of them locally.
+  size_t next_index = 0;
+  while (next_index < kTaskCount) {
+    for (int i = 0; i < 16 && next_index < kTaskCount; ++i) {
+      iree_task_queue_push_front(&source_queue, &tasks[next_index++]);
+    }
+    for (int i = 0; i < 8; ++i) {
+      iree_task_t* task = iree_task_queue_pop_front(&source_queue);
+      if (!task) break;
+      ++hits[task - tasks.data()];
+    }
+  }
+  while (iree_task_t* task = iree_task_queue_pop_front(&source_queue)) {
+    ++hits[task - tasks.data()];
+  }
+  done = true;
+  for (auto& thief : thieves) thief.join();
+
+  for (size_t i = 0; i < kTaskCount; ++i) {
+    EXPECT_EQ(1, hits[i].load()) << "task " << i;
+  }
+
+  iree_task_queue_deinitialize(&source_queue);
+}
+
 }  // namespace
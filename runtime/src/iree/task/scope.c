@@ -161,3 +161,34 @@ iree_status_t iree_task_scope_wait_idle(iree_task_scope_t* scope,
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
+
+static iree_status_t iree_task_scope_idle_wait_source_ctl(
+    iree_wait_source_t wait_source, iree_wait_source_command_t command,
+    const void* params, void** inout_ptr) {
+  iree_task_scope_t* scope = (iree_task_scope_t*)wait_source.self;
+  switch (command) {
+    case IREE_WAIT_SOURCE_COMMAND_QUERY: {
+      iree_status_code_t* out_wait_status_code = (iree_status_code_t*)inout_ptr;
+      *out_wait_status_code = iree_task_scope_is_idle(scope)
+                                  ? IREE_STATUS_OK
+                                  : IREE_STATUS_DEFERRED;
+      return iree_ok_status();
+    }
+    case IREE_WAIT_SOURCE_COMMAND_WAIT_ONE: {
+      const iree_timeout_t timeout =
+          ((const iree_wait_source_wait_params_t*)params)->timeout;
+      return iree_task_scope_wait_idle(scope,
+                                       iree_timeout_as_deadline_ns(timeout));
+    }
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unimplemented wait_source command");
+  }
+}
+
+iree_wait_source_t iree_task_scope_await_idle(iree_task_scope_t* scope) {
+  iree_wait_source_t wait_source = iree_wait_source_immediate();
+  wait_source.self = scope;
+  wait_source.ctl = iree_task_scope_idle_wait_source_ctl;
+  return wait_source;
+}
@@ -573,15 +573,13 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
   // Fetch the workgroup count (directly or indirectly).
   if (dispatch_task->header.flags & IREE_TASK_FLAG_DISPATCH_INDIRECT) {
     // By the task being ready to execute we know any dependencies on the
-    // indirection buffer have been satisfied and its safe to read. We perform
-    // the indirection here and convert the dispatch to a direct one such that
-    // following code can read the value.
-    // TODO(benvanik): non-one-shot command buffers won't be able to do this as
-    // the intent is that they can be dynamic per execution.
+    // indirection buffer have been satisfied and its safe to read. We sample
+    // the indirection here such that following code can read the value. The
+    // dispatch remains indirect so that reusable command buffers reissuing the
+    // task observe the workgroup count as it is at each execution.
     const uint32_t* source_ptr = dispatch_task->workgroup_count.ptr;
     memcpy(dispatch_task->workgroup_count.value, source_ptr,
            sizeof(dispatch_task->workgroup_count.value));
-    dispatch_task->header.flags ^= IREE_TASK_FLAG_DISPATCH_INDIRECT;
   }
   const uint32_t* workgroup_count = dispatch_task->workgroup_count.value;
 
@@ -599,9 +597,23 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
   dispatch_task->tile_count =
       workgroup_count[0] * workgroup_count[1] * workgroup_count[2];
 
+  // Shards are only issued to workers in the dispatch affinity set. This allows
+  // for restricting dispatches to a subset of the machine such as a single
+  // NUMA node (see iree_task_topology_group_mask_for_node).
+  iree_task_affinity_set_t worker_mask = iree_task_post_batch_worker_mask(
+      post_batch, dispatch_task->header.affinity_set);
+  if (!worker_mask) {
+    // No live workers (shutting down); fall back to distributing across all.
+    iree_host_size_t all_worker_count =
+        iree_task_post_batch_worker_count(post_batch);
+    worker_mask = all_worker_count >= 64 ? UINT64_MAX
+                                         : (1ull << all_worker_count) - 1;
+  }
+
   // Compute shard count - almost always worker_count unless we are a very small
   // dispatch (1x1x1, etc).
-  iree_host_size_t worker_count = iree_task_post_batch_worker_count(post_batch);
+  iree_host_size_t worker_count =
+      iree_task_affinity_set_count_ones(worker_mask);
   iree_host_size_t shard_count =
       iree_min(dispatch_task->tile_count, worker_count);
 
@@ -618,17 +630,27 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
   }
 
   // Randomize starting worker.
-  iree_host_size_t worker_offset = iree_task_post_batch_select_worker(
-      post_batch, dispatch_task->header.affinity_set);
-  iree_host_size_t worker_index = worker_offset;
+  iree_host_size_t worker_index =
+      iree_task_post_batch_select_worker(post_batch, worker_mask);
 
   for (iree_host_size_t i = 0; i < shard_count; ++i) {
     // Allocate and initialize the shard.
     iree_task_dispatch_shard_t* shard_task =
         iree_task_dispatch_shard_allocate(dispatch_task, shard_task_pool);
 
-    // Enqueue on the worker selected for the task.
-    iree_task_post_batch_enqueue(post_batch, worker_index % worker_count,
+    // Shards of dispatches restricted to a subset of workers inherit the
+    // affinity and are pinned to the worker they are posted to so that they
+    // are not stolen by workers outside of the set.
+    shard_task->header.affinity_set = dispatch_task->header.affinity_set;
+
+    // Advance to the next worker in the mask (wrapping around) and enqueue on
+    // it. shard_count <= popcnt(worker_mask) so each worker gets one shard.
+    worker_index =
+        (worker_index + iree_task_affinity_set_count_trailing_zeros(
+                            iree_task_affinity_set_rotr(worker_mask,
+                                                        worker_index))) %
+        (8 * sizeof(iree_task_affinity_set_t));
+    iree_task_post_batch_enqueue(post_batch, worker_index,
                                  &shard_task->header);
     ++worker_index;
   }
@@ -707,8 +729,8 @@ iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
 }
 
 void iree_task_dispatch_shard_execute(
-    iree_task_dispatch_shard_t* task, iree_cpu_processor_id_t processor_id,
-    iree_byte_span_t worker_local_memory,
+    iree_task_dispatch_shard_t* task, uint32_t worker_id,
+    iree_cpu_processor_id_t processor_id, iree_byte_span_t worker_local_memory,
     iree_task_submission_t* pending_submission) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -754,6 +776,7 @@ void iree_task_dispatch_shard_execute(
   tile_context.statistics = &shard_statistics;
 
   // Hint as to which processor we are running on.
+  tile_context.worker_id = worker_id;
   tile_context.processor_id = processor_id;
 
   // Loop over all tiles until they are all processed.
@@ -216,6 +216,14 @@ void iree_task_set_completion_task(iree_task_t* task,
 // all tiles to complete).
 bool iree_task_is_ready(iree_task_t* task);
 
+// Returns true if the |task| affinity is restricted to a subset of workers.
+// Pinned tasks execute on the worker they are posted to and are never stolen
+// by other workers. An empty affinity set is treated as unrestricted.
+static inline bool iree_task_is_pinned(const iree_task_t* task) {
+  return task->affinity_set &&
+         task->affinity_set != iree_task_affinity_for_any_worker();
+}
+
 // Discards the task and any dependent tasks.
 // Any dependent tasks that need to be discarded will be added to
 // |discard_worklist| for the caller to continue discarding.
@@ -532,6 +540,9 @@ typedef iree_alignas(iree_max_align_t) struct {
   // TODO(benvanik): workgroup index to amortize calculating linear offsets.
   // (like gl_GlobalInvocationID)
 
+  // Index of the executor worker executing the tile.
+  uint32_t worker_id;
+
   // Opaque ID of the processor executing the tile.
   // May be slightly out of date or 0 if the processor could not be queried.
   iree_cpu_processor_id_t processor_id;
@@ -612,11 +623,13 @@ typedef iree_alignas(iree_max_align_t) struct iree_task_dispatch_t {
   // 3D workgroup count used to tile the dispatch.
   // [1,1,1] specifies single invocation of the function. A value of 0 in
   // any dimension will skip execution of the function.
-  union {
-    // Embedded immutable 3D workgroup count value.
+  struct {
+    // 3D workgroup count value used when issuing the dispatch. For indirect
+    // dispatches this is overwritten from |ptr| each time the task is issued.
     uint32_t value[3];
-    // Pointer to the uint32_t[3] containing the 3D workgroup count.
-    // Sampled immediately prior to execution.
+    // Pointer to the uint32_t[3] containing the 3D workgroup count when
+    // IREE_TASK_FLAG_DISPATCH_INDIRECT is set. Sampled immediately prior to
+    // execution and kept so that the task may be reissued.
     const uint32_t* ptr;
   } workgroup_count;
 
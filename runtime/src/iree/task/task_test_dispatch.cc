@@ -4,9 +4,11 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <chrono>
 #include <cstdint>
 #include <cstdio>
 #include <memory>
+#include <thread>
 
 #include "iree/base/api.h"
 #include "iree/task/submission.h"
@@ -113,6 +115,70 @@ TEST_F(TaskDispatchTest, Issue345) {
   DispatchAndVerifyGrid(kWorkgroupSize, kWorkgroupCount, IREE_TASK_FLAG_NONE);
 }
 
+TEST_F(TaskDispatchTest, IssueAffinity) {
+  IREE_TRACE_SCOPE();
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {3, 4, 5};
+  const iree_task_affinity_set_t kAffinitySet =
+      iree_task_affinity_for_worker(1) | iree_task_affinity_for_worker(3);
+
+  // Records the set of workers that executed any tile.
+  struct Placement {
+    GridCoverage coverage;
+    iree_atomic_int64_t worker_mask;
+  } placement = {GridCoverage(kWorkgroupCount), IREE_ATOMIC_VAR_INIT(0)};
+  auto tile = [](void* user_context,
+                 const iree_task_tile_context_t* tile_context,
+                 iree_task_submission_t* pending_submission) {
+    Placement* placement = reinterpret_cast<Placement*>(user_context);
+    iree_atomic_fetch_or_int64(
+        &placement->worker_mask,
+        (int64_t)iree_task_affinity_for_worker(tile_context->worker_id),
+        iree_memory_order_relaxed);
+    return GridCoverage::Tile(&placement->coverage, tile_context,
+                              pending_submission);
+  };
+  iree_task_dispatch_t dispatch_task;
+  iree_task_dispatch_initialize(
+      &scope_, iree_task_make_dispatch_closure(tile, (void*)&placement),
+      kWorkgroupSize, kWorkgroupCount, &dispatch_task);
+  dispatch_task.header.affinity_set = kAffinitySet;
+
+  // Keep the workers in the affinity set busy so that the shards sit in their
+  // queues while the other workers run out of work and look for some to steal.
+  auto sleep = [](void* user_context, iree_task_t* task,
+                  iree_task_submission_t* pending_submission) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    return iree_ok_status();
+  };
+  iree_task_nop_t join_task;
+  iree_task_nop_initialize(&scope_, &join_task);
+  iree_task_set_completion_task(&dispatch_task.header, &join_task.header);
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &dispatch_task.header);
+  iree_task_call_t sleep_tasks[8];
+  for (int i = 0; i < IREE_ARRAYSIZE(sleep_tasks); ++i) {
+    iree_task_call_initialize(&scope_, iree_task_make_call_closure(sleep, NULL),
+                              &sleep_tasks[i]);
+    if (i < 2) {
+      sleep_tasks[i].header.affinity_set =
+          iree_task_affinity_for_worker(i == 0 ? 1 : 3);
+    }
+    iree_task_set_completion_task(&sleep_tasks[i].header, &join_task.header);
+    iree_task_submission_enqueue(&submission, &sleep_tasks[i].header);
+  }
+  IREE_ASSERT_OK(SubmitAndWaitIdle(&submission, &join_task.header));
+
+  // Tiles only execute on the workers in the affinity set even though other
+  // workers were idle.
+  EXPECT_TRUE(placement.coverage.Verify());
+  iree_task_affinity_set_t worker_mask = (iree_task_affinity_set_t)
+      iree_atomic_load_int64(&placement.worker_mask, iree_memory_order_relaxed);
+  EXPECT_NE(worker_mask, 0);
+  EXPECT_EQ(worker_mask & ~kAffinitySet, 0);
+}
+
 TEST_F(TaskDispatchTest, IssueIndirect) {
   IREE_TRACE_SCOPE();
 
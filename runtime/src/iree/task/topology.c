@@ -6,6 +6,7 @@
 
 #include "iree/task/topology.h"
 
+#include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -21,6 +22,7 @@ void iree_task_topology_group_initialize(
            group_index);
   iree_thread_affinity_set_any(&out_group->ideal_thread_affinity);
   out_group->constructive_sharing_mask = IREE_TASK_TOPOLOGY_GROUP_MASK_ALL;
+  out_group->theft_mask = IREE_TASK_TOPOLOGY_GROUP_MASK_ALL;
 }
 
 void iree_task_topology_initialize(iree_task_topology_t* out_topology) {
@@ -78,6 +80,57 @@ iree_status_t iree_task_topology_push_group(
   return iree_ok_status();
 }
 
+iree_task_topology_group_mask_t iree_task_topology_group_mask_for_node(
+    const iree_task_topology_t* topology, uint32_t node_id) {
+  iree_task_topology_group_mask_t mask = 0;
+  for (iree_host_size_t i = 0; i < topology->group_count; ++i) {
+    const iree_task_topology_group_t* group = &topology->groups[i];
+    if (group->node_id == node_id) mask |= 1ull << group->group_index;
+  }
+  return mask;
+}
+
+void iree_task_topology_share_by_domain(iree_task_topology_t* topology,
+                                        const uint32_t* group_domain_keys,
+                                        bool restrict_theft_to_node) {
+  for (iree_host_size_t i = 0; i < topology->group_count; ++i) {
+    iree_task_topology_group_t* group = &topology->groups[i];
+    iree_task_topology_group_mask_t sharing_mask = 0;
+    iree_task_topology_group_mask_t node_mask = 0;
+    for (iree_host_size_t j = 0; j < topology->group_count; ++j) {
+      if (i == j) continue;
+      const iree_task_topology_group_t* other_group = &topology->groups[j];
+      if (group_domain_keys[i] == group_domain_keys[j]) {
+        sharing_mask |= 1ull << other_group->group_index;
+      }
+      if (group->node_id == other_group->node_id) {
+        node_mask |= 1ull << other_group->group_index;
+      }
+    }
+    group->constructive_sharing_mask = sharing_mask;
+    if (restrict_theft_to_node) group->theft_mask = node_mask;
+  }
+}
+
+void iree_task_topology_fprint(FILE* file,
+                               const iree_task_topology_t* topology) {
+  fprintf(file, "task topology: %" PRIhsz " groups\n", topology->group_count);
+  for (iree_host_size_t i = 0; i < topology->group_count; ++i) {
+    const iree_task_topology_group_t* group = &topology->groups[i];
+    fprintf(file, "  [%2u] %-15s processor=%-4u node=%-2u", group->group_index,
+            group->name, group->processor_index, group->node_id);
+    const iree_thread_affinity_t* affinity = &group->ideal_thread_affinity;
+    if (affinity->specified) {
+      fprintf(file, " affinity=%u.%u%s", affinity->group, affinity->id,
+              affinity->smt ? "+smt" : "");
+    } else {
+      fprintf(file, " affinity=any");
+    }
+    fprintf(file, " sharing=%016" PRIx64 " theft=%016" PRIx64 "\n",
+            group->constructive_sharing_mask, group->theft_mask);
+  }
+}
+
 void iree_task_topology_initialize_from_group_count(
     iree_host_size_t group_count, iree_task_topology_t* out_topology) {
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -10,6 +10,7 @@
 #include <limits.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #include "iree/base/api.h"
 #include "iree/base/internal/threading.h"
@@ -46,12 +47,21 @@ typedef struct iree_task_topology_group_t {
   // allows us to model Simultaneous Multi-Threading (SMT) (aka hyperthreading).
   iree_thread_affinity_t ideal_thread_affinity;
 
+  // NUMA node the processor resides on. Groups on the same node have
+  // uniform access to the node-local memory.
+  uint32_t node_id;
+
   // A bitmask of other group indices that share some level of the cache
   // hierarchy. Workers of this group are more likely to constructively share
   // some cache levels higher up with these other groups. For example, if the
   // workers in a group all share an L2 cache then the groups indicated here may
   // all share the same L3 cache.
   iree_task_topology_group_mask_t constructive_sharing_mask;
+
+  // A bitmask of other group indices that workers of this group may steal
+  // tasks from. Defaults to all groups; topologies that want to avoid
+  // cross-node memory traffic can restrict this to groups on the same node.
+  iree_task_topology_group_mask_t theft_mask;
 } iree_task_topology_group_t;
 
 // Initializes |out_group| with a |group_index| derived name.
@@ -113,6 +123,24 @@ const iree_task_topology_group_t* iree_task_topology_get_group(
 iree_status_t iree_task_topology_push_group(
     iree_task_topology_t* topology, const iree_task_topology_group_t* group);
 
+// Returns a bitmask of all groups in |topology| that reside on |node_id|.
+// As executor worker indices match group indices the returned mask can be
+// used as an iree_task_affinity_set_t to restrict tasks to a single node.
+iree_task_topology_group_mask_t iree_task_topology_group_mask_for_node(
+    const iree_task_topology_t* topology, uint32_t node_id);
+
+// Sets the constructive sharing mask of each group in |topology| to the other
+// groups with the same entry in |group_domain_keys| (one per group). If
+// |restrict_theft_to_node| is true the theft mask of each group is limited to
+// the other groups on the same NUMA node.
+void iree_task_topology_share_by_domain(iree_task_topology_t* topology,
+                                        const uint32_t* group_domain_keys,
+                                        bool restrict_theft_to_node);
+
+// Prints a human-readable description of |topology| to |file|.
+void iree_task_topology_fprint(FILE* file,
+                               const iree_task_topology_t* topology);
+
 // Initializes a topology with the specified number of groups.
 // 0 is a valid value, indicating that only donated threads will be used to
 // perform work. Groups will have no specific affinity and rely on the OS
@@ -126,6 +154,38 @@ void iree_task_topology_initialize_from_group_count(
 void iree_task_topology_initialize_from_physical_cores(
     iree_host_size_t max_core_count, iree_task_topology_t* out_topology);
 
+// Level of the machine hierarchy used to distribute topology groups.
+typedef enum iree_task_topology_sharing_level_e {
+  // Groups are distributed across L2 caches and share with groups on the same
+  // L2 cache.
+  IREE_TASK_TOPOLOGY_SHARING_LEVEL_L2_CACHE = 0,
+  // Groups are distributed across L3 caches and share with groups on the same
+  // L3 cache. Falls back to L2 caches on systems without an L3.
+  IREE_TASK_TOPOLOGY_SHARING_LEVEL_L3_CACHE,
+  // Groups are distributed across NUMA nodes and share with groups on the same
+  // node. Workers will only steal tasks from other workers on the same node.
+  IREE_TASK_TOPOLOGY_SHARING_LEVEL_NUMA_NODE,
+} iree_task_topology_sharing_level_t;
+
+// Indicates that cores from any NUMA node may be used.
+#define IREE_TASK_TOPOLOGY_NODE_ID_ANY UINT32_MAX
+
+// Returns the number of NUMA nodes in the machine or 1 if it cannot be queried.
+// Node IDs used by the topology functions are in the range [0, count).
+iree_host_size_t iree_task_topology_query_node_count(void);
+
+// Initializes a topology with one group per physical core, distributing up to
+// |max_core_count| groups round-robin across the cache or NUMA domains at the
+// given |sharing_level|. Groups sharing a domain are marked as constructively
+// sharing. If |node_id| is not IREE_TASK_TOPOLOGY_NODE_ID_ANY then only cores
+// on that NUMA node will be used.
+//
+// If the machine topology cannot be queried this falls back to the same
+// behavior as iree_task_topology_initialize_from_physical_cores.
+void iree_task_topology_initialize_from_sharing_level(
+    iree_task_topology_sharing_level_t sharing_level, uint32_t node_id,
+    iree_host_size_t max_core_count, iree_task_topology_t* out_topology);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
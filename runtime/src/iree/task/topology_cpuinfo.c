@@ -29,11 +29,19 @@ static void iree_task_topology_initialize_fallback(
 
 #if defined(IREE_TASK_CPUINFO_DISABLED)
 
+iree_host_size_t iree_task_topology_query_node_count(void) { return 1; }
+
 void iree_task_topology_initialize_from_physical_cores(
     iree_host_size_t max_core_count, iree_task_topology_t* out_topology) {
   iree_task_topology_initialize_fallback(max_core_count, out_topology);
 }
 
+void iree_task_topology_initialize_from_sharing_level(
+    iree_task_topology_sharing_level_t sharing_level, uint32_t node_id,
+    iree_host_size_t max_core_count, iree_task_topology_t* out_topology) {
+  iree_task_topology_initialize_fallback(max_core_count, out_topology);
+}
+
 #else
 
 #include <cpuinfo.h>
@@ -132,12 +140,24 @@ static uint64_t iree_task_topology_calculate_constructive_sharing_mask(
   mask |= iree_task_topology_calculate_cache_bits(processor->cache.l1i);
   mask |= iree_task_topology_calculate_cache_bits(processor->cache.l1d);
   mask |= iree_task_topology_calculate_cache_bits(processor->cache.l2);
-  // TODO(benvanik): include L3 here too (for systems that have it)? Or use L3
-  // info purely for distribution and focus the group mask on lower-latency
-  // caches?
+  // NOTE: L3 info is used for distribution by
+  // iree_task_topology_initialize_from_sharing_level instead so that the group
+  // mask here focuses on lower-latency caches.
   return mask;
 }
 
+// Returns the NUMA node ID of |core|.
+static uint32_t iree_task_topology_core_node_id(
+    const struct cpuinfo_core* core) {
+  if (!core->package) return 0;
+  return (uint32_t)(core->package - cpuinfo_get_packages());
+}
+
+iree_host_size_t iree_task_topology_query_node_count(void) {
+  if (!iree_task_topology_is_cpuinfo_available()) return 1;
+  return iree_max(1, (iree_host_size_t)cpuinfo_get_packages_count());
+}
+
 // Populates |our_group| with the information from |core|.
 static void iree_task_topology_group_initialize_from_core(
     uint32_t group_index, const struct cpuinfo_core* core,
@@ -154,6 +174,11 @@ static void iree_task_topology_group_initialize_from_core(
       cpuinfo_get_processor(processor_i);
   iree_task_topology_set_affinity_from_processor(
       processor, &out_group->ideal_thread_affinity);
+
+  // cpuinfo does not expose NUMA nodes so we use the package (socket) as a
+  // proxy. This matches the common multi-socket configuration where each
+  // socket has its own memory controller.
+  out_group->node_id = iree_task_topology_core_node_id(core);
 }
 
 // Fixes constructive_sharing_mask values such that they represent other chosen
@@ -224,10 +249,9 @@ static void iree_task_topology_initialize_from_physical_cores_with_filter(
   iree_task_topology_initialize(out_topology);
 
   // Build each core up to the max allowed.
-  // TODO(benvanik): if our group_count <= core_count/2 then distribute better;
-  // for now we just do a straight-line through (cores 0-N) when instead we may
-  // want to take advantage of L3 cache info (half of groups on one L3 cache,
-  // half of groups on another, etc).
+  // NOTE: this does a straight-line walk through (cores 0-N); see
+  // iree_task_topology_initialize_from_sharing_level for distributing groups
+  // across caches or NUMA nodes when group_count < core_count.
   out_topology->group_count = core_count;
   for (uint32_t core_i = 0, group_i = 0; group_i < out_topology->group_count;
        ++core_i) {
@@ -253,4 +277,117 @@ void iree_task_topology_initialize_from_physical_cores(
       iree_task_topology_core_filter_all, 0, max_core_count, out_topology);
 }
 
+// Matches cores on the NUMA node specified in |user_data|.
+static bool iree_task_topology_core_filter_node(const struct cpuinfo_core* core,
+                                                uintptr_t user_data) {
+  uint32_t node_id = (uint32_t)user_data;
+  return node_id == IREE_TASK_TOPOLOGY_NODE_ID_ANY ||
+         iree_task_topology_core_node_id(core) == node_id;
+}
+
+// Returns a key identifying the domain |core| belongs to at |sharing_level|.
+// Cores with the same key share the same cache or NUMA node.
+static uint32_t iree_task_topology_core_domain_key(
+    iree_task_topology_sharing_level_t sharing_level,
+    const struct cpuinfo_core* core) {
+  const struct cpuinfo_processor* processor =
+      cpuinfo_get_processor(core->processor_start);
+  if (sharing_level == IREE_TASK_TOPOLOGY_SHARING_LEVEL_NUMA_NODE) {
+    return iree_task_topology_core_node_id(core);
+  }
+  // Systems without an L3 fall back to L2.
+  if (sharing_level == IREE_TASK_TOPOLOGY_SHARING_LEVEL_L3_CACHE &&
+      processor->cache.l3) {
+    return processor->cache.l3->processor_start;
+  }
+  if (processor->cache.l2) return processor->cache.l2->processor_start;
+  // No shared cache info; each core is its own domain.
+  return core->processor_start;
+}
+
+void iree_task_topology_initialize_from_sharing_level(
+    iree_task_topology_sharing_level_t sharing_level, uint32_t node_id,
+    iree_host_size_t max_core_count, iree_task_topology_t* out_topology) {
+  max_core_count = iree_min(max_core_count, IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT);
+  if (!iree_task_topology_is_cpuinfo_available()) {
+    iree_task_topology_initialize_fallback(max_core_count, out_topology);
+    return;
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, max_core_count);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)sharing_level);
+
+  iree_task_topology_initialize(out_topology);
+  const uint32_t core_count = cpuinfo_get_cores_count();
+
+  // Gather the unique domains containing matching cores. Each domain tracks a
+  // cursor into the (rotated) core list indicating the next core to consider.
+  // We only ever need as many domains as we have groups.
+  uint32_t domain_keys[IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT];
+  uint32_t domain_cursors[IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT];
+  iree_host_size_t domain_count = 0;
+  for (uint32_t core_i = 0;
+       core_i < core_count && domain_count < IREE_ARRAYSIZE(domain_keys);
+       ++core_i) {
+    const struct cpuinfo_core* core =
+        cpuinfo_get_core(iree_task_topology_rotate_from_base_core(core_i));
+    if (!iree_task_topology_core_filter_node(core, node_id)) continue;
+    uint32_t key = iree_task_topology_core_domain_key(sharing_level, core);
+    bool is_new = true;
+    for (iree_host_size_t i = 0; i < domain_count; ++i) {
+      if (domain_keys[i] == key) {
+        is_new = false;
+        break;
+      }
+    }
+    if (is_new) {
+      domain_keys[domain_count] = key;
+      domain_cursors[domain_count] = core_i;
+      ++domain_count;
+    }
+  }
+
+  // Assign cores to groups round-robin across domains so that when we have
+  // fewer groups than cores they are spread across all caches/nodes instead of
+  // filling up the first domain (cores 0-N) and leaving the rest idle.
+  uint32_t group_domain_keys[IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT];
+  iree_host_size_t group_count = 0;
+  bool did_add = true;
+  while (did_add && group_count < max_core_count) {
+    did_add = false;
+    for (iree_host_size_t i = 0;
+         i < domain_count && group_count < max_core_count; ++i) {
+      const struct cpuinfo_core* core = NULL;
+      for (; domain_cursors[i] < core_count; ++domain_cursors[i]) {
+        const struct cpuinfo_core* candidate_core = cpuinfo_get_core(
+            iree_task_topology_rotate_from_base_core(domain_cursors[i]));
+        if (iree_task_topology_core_filter_node(candidate_core, node_id) &&
+            iree_task_topology_core_domain_key(sharing_level,
+                                               candidate_core) ==
+                domain_keys[i]) {
+          core = candidate_core;
+          ++domain_cursors[i];
+          break;
+        }
+      }
+      if (!core) continue;  // domain exhausted
+      iree_task_topology_group_initialize_from_core(
+          (uint32_t)group_count, core, &out_topology->groups[group_count]);
+      group_domain_keys[group_count] = domain_keys[i];
+      ++group_count;
+      did_add = true;
+    }
+  }
+  out_topology->group_count = group_count;
+
+  // Groups in the same domain constructively share; when distributing across
+  // NUMA nodes we also prevent theft across nodes.
+  iree_task_topology_share_by_domain(
+      out_topology, group_domain_keys,
+      sharing_level == IREE_TASK_TOPOLOGY_SHARING_LEVEL_NUMA_NODE);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
 #endif  // IREE_TASK_CPUINFO_DISABLED
@@ -143,4 +143,109 @@ TEST(TopologyTest, FromPhysicalCores) {
   iree_task_topology_deinitialize(&topology);
 }
 
+TEST(TopologyTest, GroupMaskForNode) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize(&topology);
+
+  for (iree_host_size_t i = 0; i < 6; ++i) {
+    iree_task_topology_group_t group;
+    iree_task_topology_group_initialize(i, &group);
+    group.node_id = i % 2;
+    IREE_EXPECT_OK(iree_task_topology_push_group(&topology, &group));
+  }
+
+  EXPECT_EQ(0b010101, iree_task_topology_group_mask_for_node(&topology, 0));
+  EXPECT_EQ(0b101010, iree_task_topology_group_mask_for_node(&topology, 1));
+  EXPECT_EQ(0, iree_task_topology_group_mask_for_node(&topology, 2));
+
+  iree_task_topology_deinitialize(&topology);
+}
+
+TEST(TopologyTest, ShareByDomain) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize(&topology);
+  for (iree_host_size_t i = 0; i < 4; ++i) {
+    iree_task_topology_group_t group;
+    iree_task_topology_group_initialize(i, &group);
+    group.node_id = i / 2;
+    IREE_EXPECT_OK(iree_task_topology_push_group(&topology, &group));
+  }
+
+  // Groups 0 and 2 share one cache and groups 1 and 3 another; theft is
+  // unrestricted.
+  const uint32_t kDomainKeys[4] = {7, 9, 7, 9};
+  iree_task_topology_share_by_domain(&topology, kDomainKeys,
+                                     /*restrict_theft_to_node=*/false);
+  const iree_task_topology_group_mask_t kSharingMasks[4] = {0b0100, 0b1000,
+                                                            0b0001, 0b0010};
+  for (iree_host_size_t i = 0; i < 4; ++i) {
+    const iree_task_topology_group_t* group =
+        iree_task_topology_get_group(&topology, i);
+    EXPECT_EQ(kSharingMasks[i], group->constructive_sharing_mask);
+    EXPECT_EQ(IREE_TASK_TOPOLOGY_GROUP_MASK_ALL, group->theft_mask);
+  }
+
+  // Theft restricted to the other group on the same node.
+  iree_task_topology_share_by_domain(&topology, kDomainKeys,
+                                     /*restrict_theft_to_node=*/true);
+  const iree_task_topology_group_mask_t kTheftMasks[4] = {0b0010, 0b0001,
+                                                          0b1000, 0b0100};
+  for (iree_host_size_t i = 0; i < 4; ++i) {
+    const iree_task_topology_group_t* group =
+        iree_task_topology_get_group(&topology, i);
+    EXPECT_EQ(kSharingMasks[i], group->constructive_sharing_mask);
+    EXPECT_EQ(kTheftMasks[i], group->theft_mask);
+  }
+
+  iree_task_topology_deinitialize(&topology);
+}
+
+TEST(TopologyTest, FromSharingLevel) {
+  static const iree_task_topology_sharing_level_t kLevels[] = {
+      IREE_TASK_TOPOLOGY_SHARING_LEVEL_L2_CACHE,
+      IREE_TASK_TOPOLOGY_SHARING_LEVEL_L3_CACHE,
+      IREE_TASK_TOPOLOGY_SHARING_LEVEL_NUMA_NODE,
+  };
+  for (auto level : kLevels) {
+    SCOPED_TRACE(level);
+    iree_task_topology_t topology;
+    iree_task_topology_initialize_from_sharing_level(
+        level, IREE_TASK_TOPOLOGY_NODE_ID_ANY, /*max_core_count=*/4,
+        &topology);
+    iree_host_size_t group_count = iree_task_topology_group_count(&topology);
+    EXPECT_LE(group_count, 4);
+    iree_task_topology_group_mask_t all_mask = (1ull << group_count) - 1;
+    for (iree_host_size_t i = 0; i < group_count; ++i) {
+      const iree_task_topology_group_t* group =
+          iree_task_topology_get_group(&topology, i);
+      EXPECT_EQ(i, group->group_index);
+      iree_task_topology_group_mask_t self_mask = 1ull << i;
+      iree_task_topology_group_mask_t node_mask =
+          iree_task_topology_group_mask_for_node(&topology, group->node_id);
+
+      // Sharing is symmetric: groups share with each other or not at all.
+      for (iree_host_size_t j = 0; j < group_count; ++j) {
+        if (i == j) continue;
+        const iree_task_topology_group_t* other_group =
+            iree_task_topology_get_group(&topology, j);
+        EXPECT_EQ((group->constructive_sharing_mask >> j) & 1,
+                  (other_group->constructive_sharing_mask >> i) & 1)
+            << "groups " << i << " and " << j;
+      }
+
+      // Workers may always steal from other groups on the same node and only
+      // from those when distributing across NUMA nodes.
+      EXPECT_EQ(node_mask & ~self_mask,
+                group->theft_mask & node_mask & ~self_mask);
+      if (level == IREE_TASK_TOPOLOGY_SHARING_LEVEL_NUMA_NODE) {
+        EXPECT_EQ(0, group->theft_mask & all_mask & ~node_mask);
+      } else {
+        EXPECT_EQ(all_mask & ~self_mask,
+                  group->theft_mask & all_mask & ~self_mask);
+      }
+    }
+    iree_task_topology_deinitialize(&topology);
+  }
+}
+
 }  // namespace
@@ -53,12 +53,27 @@ extern "C" {
 // 1ms may result in 10-15ms.
 #define IREE_TASK_EXECUTOR_DELAY_SLOP_NS (1 /*ms*/ * 1000000)
 
+// Maximum amount of time a thread donated to a threadless executor will sleep
+// waiting for new tasks before checking whether the wait source it is blocked
+// on has resolved. Tasks posted to the executor always wake the donor
+// immediately; this only bounds the latency of wait sources that are resolved
+// externally (such as a semaphore signaled from another thread).
+#define IREE_TASK_EXECUTOR_DONOR_POLL_PERIOD_NS (1 /*ms*/ * 1000000)
+
 // Allows for dividing the total number of attempts that a worker will make to
 // steal tasks from other workers. By default all other workers will be
 // attempted while setting this to 2, for example, will try for only half of
 // the available workers.
 #define IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR (1)
 
+// Number of task slots in each worker's lock-free work-stealing deque.
+// Must be a power of two. Tasks pushed while the deque is full spill into an
+// owner-private overflow list that thieves cannot see; the overflow list is
+// drained back into the deque as the worker empties it. Larger values allow
+// more of a large flush to be visible to thieves at the cost of one pointer of
+// storage per slot in every worker.
+#define IREE_TASK_QUEUE_CAPACITY (512)
+
 // Maximum number of tasks that will be stolen in one go from another worker.
 //
 // Too few tasks will cause additional overhead as the worker repeatedly sips
@@ -20,18 +20,18 @@
 
 static int iree_task_worker_main(iree_task_worker_t* worker);
 
-iree_status_t iree_task_worker_initialize(
+// Initializes all worker state except for the thread.
+static void iree_task_worker_initialize_state(
     iree_task_executor_t* executor, iree_host_size_t worker_index,
     const iree_task_topology_group_t* topology_group,
     iree_byte_span_t local_memory, iree_prng_splitmix64_state_t* seed_prng,
-    iree_task_worker_t* out_worker) {
-  IREE_TRACE_ZONE_BEGIN(z0);
-
+    iree_task_worker_state_t initial_state, iree_task_worker_t* out_worker) {
   out_worker->executor = executor;
   out_worker->worker_bit = iree_task_affinity_for_worker(worker_index);
   out_worker->ideal_thread_affinity = topology_group->ideal_thread_affinity;
   out_worker->constructive_sharing_mask =
       topology_group->constructive_sharing_mask;
+  out_worker->theft_mask = topology_group->theft_mask;
   out_worker->max_theft_attempts =
       executor->worker_count / IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR;
   iree_prng_minilcg128_initialize(iree_prng_splitmix64_next(seed_prng),
@@ -40,6 +40,22 @@ iree_status_t iree_task_worker_initialize(
   out_worker->processor_id = 0;
   out_worker->processor_tag = 0;
 
+  iree_atomic_store_int32(&out_worker->state, initial_state,
+                          iree_memory_order_seq_cst);
+
+  iree_notification_initialize(&out_worker->wake_notification);
+  iree_notification_initialize(&out_worker->state_notification);
+  iree_atomic_task_slist_initialize(&out_worker->mailbox_slist);
+  iree_task_queue_initialize(&out_worker->local_task_queue);
+}
+
+iree_status_t iree_task_worker_initialize(
+    iree_task_executor_t* executor, iree_host_size_t worker_index,
+    const iree_task_topology_group_t* topology_group,
+    iree_byte_span_t local_memory, iree_prng_splitmix64_state_t* seed_prng,
+    iree_task_worker_t* out_worker) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
   iree_task_worker_state_t initial_state = IREE_TASK_WORKER_STATE_RUNNING;
   if (executor->scheduling_mode &
       IREE_TASK_SCHEDULING_MODE_DEFER_WORKER_STARTUP) {
@@ -49,13 +65,9 @@ iree_status_t iree_task_worker_initialize(
     // blocking startup time.
     initial_state = IREE_TASK_WORKER_STATE_SUSPENDED;
   }
-  iree_atomic_store_int32(&out_worker->state, initial_state,
-                          iree_memory_order_seq_cst);
-
-  iree_notification_initialize(&out_worker->wake_notification);
-  iree_notification_initialize(&out_worker->state_notification);
-  iree_atomic_task_slist_initialize(&out_worker->mailbox_slist);
-  iree_task_queue_initialize(&out_worker->local_task_queue);
+  iree_task_worker_initialize_state(executor, worker_index, topology_group,
+                                    local_memory, seed_prng, initial_state,
+                                    out_worker);
 
   iree_thread_create_params_t thread_params;
   memset(&thread_params, 0, sizeof(thread_params));
@@ -76,6 +88,21 @@ iree_status_t iree_task_worker_initialize(
   return status;
 }
 
+void iree_task_worker_initialize_threadless(
+    iree_task_executor_t* executor, iree_host_size_t worker_index,
+    const iree_task_topology_group_t* topology_group,
+    iree_byte_span_t local_memory, iree_prng_splitmix64_state_t* seed_prng,
+    iree_task_worker_t* out_worker) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  // Threadless workers are always running as they only ever process tasks on
+  // threads that have been donated to them.
+  iree_task_worker_initialize_state(executor, worker_index, topology_group,
+                                    local_memory, seed_prng,
+                                    IREE_TASK_WORKER_STATE_RUNNING, out_worker);
+  out_worker->thread = NULL;
+  IREE_TRACE_ZONE_END(z0);
+}
+
 void iree_task_worker_request_exit(iree_task_worker_t* worker) {
   if (!worker->thread) return;
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -129,8 +156,8 @@ void iree_task_worker_await_exit(iree_task_worker_t* worker) {
 void iree_task_worker_deinitialize(iree_task_worker_t* worker) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  // Must have called request_exit/await_exit.
-  IREE_ASSERT_TRUE(iree_task_worker_is_zombie(worker));
+  // Must have called request_exit/await_exit if the worker has a thread.
+  IREE_ASSERT_TRUE(!worker->thread || iree_task_worker_is_zombie(worker));
 
   iree_thread_release(worker->thread);
   worker->thread = NULL;
@@ -139,12 +166,11 @@ void iree_task_worker_deinitialize(iree_task_worker_t* worker) {
   // get anything more posted to it) and then discarding everything we still
   // have a reference to.
   iree_atomic_task_slist_discard(&worker->mailbox_slist);
-  iree_task_list_discard(&worker->local_task_queue.list);
+  iree_task_queue_deinitialize(&worker->local_task_queue);
 
   iree_notification_deinitialize(&worker->wake_notification);
   iree_notification_deinitialize(&worker->state_notification);
   iree_atomic_task_slist_deinitialize(&worker->mailbox_slist);
-  iree_task_queue_deinitialize(&worker->local_task_queue);
 
   IREE_TRACE_ZONE_END(z0);
 }
@@ -161,14 +187,21 @@ iree_task_t* iree_task_worker_try_steal_task(iree_task_worker_t* worker,
                                              iree_task_queue_t* target_queue,
                                              iree_host_size_t max_tasks) {
   // Try to grab tasks from the worker; if more than one task is stolen then the
-  // first will be returned and the remaining will be added to the target queue.
-  iree_task_t* task = iree_task_queue_try_steal(
-      &worker->local_task_queue, target_queue,
-      /*max_tasks=*/IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT);
+  // last will be returned and the remaining will be added to the target queue.
+  iree_task_t* task = iree_task_queue_try_steal(&worker->local_task_queue,
+                                                target_queue, max_tasks);
   if (task) return task;
 
   // If we still didn't steal any tasks then let's try the slist instead.
   task = iree_atomic_task_slist_pop(&worker->mailbox_slist);
+  if (task && iree_task_is_pinned(task)) {
+    // Task is pinned to the worker it was posted to; put it back and make sure
+    // the worker wakes to process it in case it checked the mailbox while we
+    // were holding the task.
+    iree_atomic_task_slist_push(&worker->mailbox_slist, task);
+    iree_notification_post(&worker->wake_notification, 1);
+    return NULL;
+  }
   if (task) return task;
 
   return NULL;
@@ -195,8 +228,9 @@ static void iree_task_worker_execute(
     }
     case IREE_TASK_TYPE_DISPATCH_SHARD: {
       iree_task_dispatch_shard_execute(
-          (iree_task_dispatch_shard_t*)task, worker->processor_id,
-          worker->local_memory, pending_submission);
+          (iree_task_dispatch_shard_t*)task,
+          iree_task_affinity_set_count_trailing_zeros(worker->worker_bit),
+          worker->processor_id, worker->local_memory, pending_submission);
       break;
     }
     default:
@@ -241,7 +275,7 @@ static bool iree_task_worker_pump_once(
   if (!task) {
     task = iree_task_executor_try_steal_task(
         worker->executor, worker->constructive_sharing_mask,
-        worker->max_theft_attempts, &worker->theft_prng,
+        worker->theft_mask, worker->max_theft_attempts, &worker->theft_prng,
         &worker->local_task_queue);
   }
 
@@ -354,6 +388,31 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
   }
 }
 
+bool iree_task_worker_pump_donated(iree_task_worker_t* worker) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Donated threads can come from anywhere and move between calls.
+  iree_task_worker_update_processor_id(worker);
+
+  iree_task_submission_t pending_submission;
+  iree_task_submission_initialize(&pending_submission);
+
+  // Only a single task is executed per pump so that the caller can check
+  // whether it should stop donating between each one.
+  bool did_work = iree_task_worker_pump_once(worker, &pending_submission);
+
+  if (!iree_task_submission_is_empty(&pending_submission)) {
+    iree_task_executor_merge_submission(worker->executor, &pending_submission);
+  }
+
+  // Schedule anything that became ready. In threadless executors this routes
+  // tasks right back into our local queue for the next pump.
+  iree_task_executor_coordinate(worker->executor, worker);
+
+  IREE_TRACE_ZONE_END(z0);
+  return did_work || !iree_task_queue_is_empty(&worker->local_task_queue);
+}
+
 // Thread entry point for each worker.
 static int iree_task_worker_main(iree_task_worker_t* worker) {
   IREE_TRACE_ZONE_BEGIN(thread_zone);
@@ -97,6 +97,9 @@ typedef struct iree_task_worker_t {
   // all share the same L3 cache.
   iree_task_affinity_set_t constructive_sharing_mask;
 
+  // A bitmask of other workers this worker may steal tasks from.
+  iree_task_affinity_set_t theft_mask;
+
   // Maximum number of attempts to make when trying to steal tasks from other
   // workers. This could be 64 (try stealing from all workers) or just a handful
   // (try stealing from these 3 other cores that share your L3 cache).
@@ -107,7 +110,8 @@ typedef struct iree_task_worker_t {
   iree_prng_minilcg128_state_t theft_prng;
 
   // Thread handle of the worker. If the thread has exited the handle will
-  // remain valid so that the executor can query its state.
+  // remain valid so that the executor can query its state. NULL for threadless
+  // workers that are pumped by donated threads.
   iree_thread_t* thread;
 
   // Guess at the current processor ID.
@@ -136,9 +140,9 @@ typedef struct iree_task_worker_t {
   // workers.
   iree_byte_span_t local_memory;
 
-  // Worker-local FIFO queue containing the tasks that will be processed by the
-  // worker. This queue supports work-stealing by other workers if they run out
-  // of work of their own.
+  // Worker-local Chase-Lev deque containing the tasks that will be processed by
+  // the worker. This deque supports lock-free work-stealing by other workers if
+  // they run out of work of their own.
   // LAYOUT: must be 64b away from mailbox_slist.
   iree_task_queue_t local_task_queue;
 } iree_task_worker_t;
@@ -161,6 +165,14 @@ iree_status_t iree_task_worker_initialize(
     iree_byte_span_t local_memory, iree_prng_splitmix64_state_t* seed_prng,
     iree_task_worker_t* out_worker);
 
+// Initializes a threadless worker that will only process tasks when pumped
+// by a thread donated to the executor via iree_task_worker_pump_donated.
+void iree_task_worker_initialize_threadless(
+    iree_task_executor_t* executor, iree_host_size_t worker_index,
+    const iree_task_topology_group_t* topology_group,
+    iree_byte_span_t local_memory, iree_prng_splitmix64_state_t* seed_prng,
+    iree_task_worker_t* out_worker);
+
 // Requests that the worker begin exiting (if it hasn't already).
 // If the worker is actively processing tasks it will wait until it has
 // completed all it can and is about to go idle prior to exiting.
@@ -174,7 +186,8 @@ void iree_task_worker_request_exit(iree_task_worker_t* worker);
 void iree_task_worker_await_exit(iree_task_worker_t* worker);
 
 // Deinitializes a worker that has successfully exited.
-// The worker must be in the IREE_TASK_WORKER_STATE_ZOMBIE state.
+// The worker must be in the IREE_TASK_WORKER_STATE_ZOMBIE state unless it is
+// threadless.
 //
 // Expected shutdown sequence:
 //  - request_exit on all workers
@@ -189,15 +202,24 @@ void iree_task_worker_deinitialize(iree_task_worker_t* worker);
 void iree_task_worker_post_tasks(iree_task_worker_t* worker,
                                  iree_task_list_t* list);
 
-// Tries to steal up to |max_tasks| from the back of the queue.
+// Tries to steal up to |max_tasks| from the top of the worker deque.
 // Returns NULL if no tasks are available and otherwise up to |max_tasks| tasks
-// that were at the tail of the worker FIFO will be moved to the |target_queue|
-// and the first of the stolen tasks is returned. While tasks from the FIFO
-// are preferred this may also steal tasks from the mailbox.
+// that the worker would have processed last will be moved to the
+// |target_queue| and one of the stolen tasks is returned. While tasks from the
+// deque are preferred this may also steal tasks from the mailbox.
 iree_task_t* iree_task_worker_try_steal_task(iree_task_worker_t* worker,
                                              iree_task_queue_t* target_queue,
                                              iree_host_size_t max_tasks);
 
+// Pumps a threadless |worker| from the calling thread to execute at most one
+// task, then coordinates to schedule any tasks that became ready.
+// Returns true if a task was executed or tasks are now queued for the worker.
+// Callers check whether they still need to donate between pumps.
+//
+// The caller must have exclusive ownership of the worker and is responsible
+// for setting up the thread state (FPU modes/etc) expected by tasks.
+bool iree_task_worker_pump_donated(iree_task_worker_t* worker);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
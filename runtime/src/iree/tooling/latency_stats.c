@@ -0,0 +1,84 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/tooling/latency_stats.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+//===----------------------------------------------------------------------===//
+// iree_latency_samples_t
+//===----------------------------------------------------------------------===//
+
+void iree_latency_samples_initialize(iree_allocator_t host_allocator,
+                                     iree_latency_samples_t* out_samples) {
+  memset(out_samples, 0, sizeof(*out_samples));
+  out_samples->host_allocator = host_allocator;
+}
+
+void iree_latency_samples_deinitialize(iree_latency_samples_t* samples) {
+  iree_allocator_free(samples->host_allocator, samples->values);
+  memset(samples, 0, sizeof(*samples));
+}
+
+void iree_latency_samples_reset(iree_latency_samples_t* samples) {
+  samples->count = 0;
+}
+
+iree_status_t iree_latency_samples_append(iree_latency_samples_t* samples,
+                                          iree_duration_t value) {
+  if (samples->count == samples->capacity) {
+    iree_host_size_t new_capacity = iree_max(64, samples->capacity * 2);
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        samples->host_allocator, new_capacity * sizeof(*samples->values),
+        (void**)&samples->values));
+    samples->capacity = new_capacity;
+  }
+  samples->values[samples->count++] = value;
+  return iree_ok_status();
+}
+
+static int iree_latency_samples_compare(const void* lhs_ptr,
+                                        const void* rhs_ptr) {
+  iree_duration_t lhs = *(const iree_duration_t*)lhs_ptr;
+  iree_duration_t rhs = *(const iree_duration_t*)rhs_ptr;
+  return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+}
+
+iree_duration_t iree_latency_samples_quantile(
+    const iree_latency_samples_t* samples, double quantile) {
+  if (!samples->count) return 0;
+  // Nearest-rank: the smallest sample such that at least |quantile| of the
+  // samples are less than or equal to it.
+  double rank = ceil(quantile * (double)samples->count);
+  iree_host_size_t index = rank < 1.0 ? 0 : (iree_host_size_t)rank - 1;
+  if (index >= samples->count) index = samples->count - 1;
+  return samples->values[index];
+}
+
+void iree_latency_samples_summarize(iree_latency_samples_t* samples,
+                                    iree_latency_summary_t* out_summary) {
+  memset(out_summary, 0, sizeof(*out_summary));
+  if (!samples->count) return;
+
+  qsort(samples->values, samples->count, sizeof(*samples->values),
+        iree_latency_samples_compare);
+
+  iree_duration_t total = 0;
+  for (iree_host_size_t i = 0; i < samples->count; ++i) {
+    total += samples->values[i];
+  }
+  out_summary->count = samples->count;
+  out_summary->total = total;
+  out_summary->min = samples->values[0];
+  out_summary->mean = total / (iree_duration_t)samples->count;
+  out_summary->p50 = iree_latency_samples_quantile(samples, 0.50);
+  out_summary->p90 = iree_latency_samples_quantile(samples, 0.90);
+  out_summary->p99 = iree_latency_samples_quantile(samples, 0.99);
+  out_summary->p999 = iree_latency_samples_quantile(samples, 0.999);
+  out_summary->max = samples->values[samples->count - 1];
+}
@@ -0,0 +1,83 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===----------------------------------------------------------------------===//
+// Latency sample collection and summarization
+//===----------------------------------------------------------------------===//
+//
+// Utilities for tools that measure the latency distribution of operations
+// such as VM invocations. Samples are stored exactly and percentiles are
+// computed with the nearest-rank method so that tail latencies (p99.9, etc)
+// are reported precisely instead of being interpolated from bins.
+//
+// NOTE: this is intended for tooling and retains every sample; it is not
+// intended to be used in long-running production processes.
+
+#ifndef IREE_TOOLING_LATENCY_STATS_H_
+#define IREE_TOOLING_LATENCY_STATS_H_
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_latency_samples_t
+//===----------------------------------------------------------------------===//
+
+// A growable list of latency samples in nanoseconds.
+typedef struct iree_latency_samples_t {
+  iree_allocator_t host_allocator;
+  iree_host_size_t count;
+  iree_host_size_t capacity;
+  iree_duration_t* values;
+} iree_latency_samples_t;
+
+// Initializes an empty sample list in |out_samples|.
+void iree_latency_samples_initialize(iree_allocator_t host_allocator,
+                                     iree_latency_samples_t* out_samples);
+
+// Deinitializes |samples| and frees all sample storage.
+void iree_latency_samples_deinitialize(iree_latency_samples_t* samples);
+
+// Removes all samples from |samples| while retaining the storage.
+void iree_latency_samples_reset(iree_latency_samples_t* samples);
+
+// Appends a sample of |value| nanoseconds to |samples|.
+iree_status_t iree_latency_samples_append(iree_latency_samples_t* samples,
+                                          iree_duration_t value);
+
+// Summary statistics of a set of latency samples in nanoseconds.
+// All fields are zero if there were no samples.
+typedef struct iree_latency_summary_t {
+  iree_host_size_t count;
+  iree_duration_t total;
+  iree_duration_t min;
+  iree_duration_t mean;
+  iree_duration_t p50;
+  iree_duration_t p90;
+  iree_duration_t p99;
+  iree_duration_t p999;
+  iree_duration_t max;
+} iree_latency_summary_t;
+
+// Summarizes all samples in |samples| into |out_summary|.
+// The samples are sorted in place.
+void iree_latency_samples_summarize(iree_latency_samples_t* samples,
+                                    iree_latency_summary_t* out_summary);
+
+// Returns the nearest-rank |quantile| in [0, 1] of the samples in |samples|.
+// Requires that the samples have been sorted by
+// iree_latency_samples_summarize. Returns 0 if there are no samples.
+iree_duration_t iree_latency_samples_quantile(
+    const iree_latency_samples_t* samples, double quantile);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_TOOLING_LATENCY_STATS_H_
@@ -0,0 +1,61 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/tooling/latency_stats.h"
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace {
+
+TEST(LatencyStatsTest, Empty) {
+  iree_latency_samples_t samples;
+  iree_latency_samples_initialize(iree_allocator_system(), &samples);
+  iree_latency_summary_t summary;
+  iree_latency_samples_summarize(&samples, &summary);
+  EXPECT_EQ(summary.count, 0);
+  EXPECT_EQ(summary.max, 0);
+  EXPECT_EQ(iree_latency_samples_quantile(&samples, 0.5), 0);
+  iree_latency_samples_deinitialize(&samples);
+}
+
+TEST(LatencyStatsTest, Summary) {
+  iree_latency_samples_t samples;
+  iree_latency_samples_initialize(iree_allocator_system(), &samples);
+  // Appended in reverse to verify the samples are sorted.
+  for (int i = 1000; i >= 1; --i) {
+    IREE_ASSERT_OK(iree_latency_samples_append(&samples, i));
+  }
+  iree_latency_summary_t summary;
+  iree_latency_samples_summarize(&samples, &summary);
+  EXPECT_EQ(summary.count, 1000);
+  EXPECT_EQ(summary.total, 500500);
+  EXPECT_EQ(summary.min, 1);
+  EXPECT_EQ(summary.mean, 500);
+  EXPECT_EQ(summary.p50, 500);
+  EXPECT_EQ(summary.p90, 900);
+  EXPECT_EQ(summary.p99, 990);
+  EXPECT_EQ(summary.p999, 999);
+  EXPECT_EQ(summary.max, 1000);
+  iree_latency_samples_deinitialize(&samples);
+}
+
+TEST(LatencyStatsTest, Reset) {
+  iree_latency_samples_t samples;
+  iree_latency_samples_initialize(iree_allocator_system(), &samples);
+  IREE_ASSERT_OK(iree_latency_samples_append(&samples, 100));
+  iree_latency_samples_reset(&samples);
+  IREE_ASSERT_OK(iree_latency_samples_append(&samples, 7));
+  iree_latency_summary_t summary;
+  iree_latency_samples_summarize(&samples, &summary);
+  EXPECT_EQ(summary.count, 1);
+  EXPECT_EQ(summary.p999, 7);
+  iree_latency_samples_deinitialize(&samples);
+}
+
+}  // namespace
+}  // namespace iree
@@ -0,0 +1,45 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/tooling/module_util.h"
+
+#include "iree/base/internal/flags.h"
+#include "iree/base/tracing.h"
+#include "iree/vm/native_image.h"
+
+#if defined(IREE_HAVE_ELF_NATIVE_IMAGE_LOADER)
+#include "iree/hal/local/elf/native_image_loader.h"
+#endif  // IREE_HAVE_ELF_NATIVE_IMAGE_LOADER
+
+IREE_FLAG(bool, native_images, false,
+          "Loads ahead-of-time compiled native images embedded in modules "
+          "instead of interpreting their bytecode. Native code is not "
+          "verified and must only be enabled for trusted modules.");
+
+iree_status_t iree_tooling_create_module_from_flags(
+    iree_const_byte_span_t archive_contents, iree_allocator_t archive_allocator,
+    iree_allocator_t host_allocator, iree_vm_module_t** out_module) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  const iree_vm_native_image_loader_t* loader = NULL;
+#if defined(IREE_HAVE_ELF_NATIVE_IMAGE_LOADER)
+  iree_vm_native_image_loader_t elf_loader;
+  iree_elf_native_image_loader_initialize(&elf_loader);
+  if (FLAG_native_images) loader = &elf_loader;
+#else
+  if (FLAG_native_images) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(
+        IREE_STATUS_UNAVAILABLE,
+        "native images are not supported in this build; drop --native_images");
+  }
+#endif  // IREE_HAVE_ELF_NATIVE_IMAGE_LOADER
+
+  iree_status_t status = iree_vm_native_image_module_create(
+      archive_contents, archive_allocator, loader, host_allocator, out_module);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -0,0 +1,32 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_TOOLING_MODULE_UTIL_H_
+#define IREE_TOOLING_MODULE_UTIL_H_
+
+#include "iree/base/api.h"
+#include "iree/vm/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Creates a VM module from the in-memory ModuleDef FlatBuffer archive in
+// |archive_contents|. Ahead-of-time compiled native images embedded in the
+// archive are only used when the --native_images flag is passed as they are
+// not verified like bytecode is; otherwise the bytecode is always used.
+//
+// If a |archive_allocator| is provided then it will be used to free the
+// |archive_contents| once they are no longer required.
+iree_status_t iree_tooling_create_module_from_flags(
+    iree_const_byte_span_t archive_contents, iree_allocator_t archive_allocator,
+    iree_allocator_t host_allocator, iree_vm_module_t** out_module);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_TOOLING_MODULE_UTIL_H_
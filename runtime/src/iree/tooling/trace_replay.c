@@ -110,7 +110,8 @@ static iree_status_t iree_trace_replay_load_builtin_module(
     IREE_RETURN_IF_ERROR(iree_trace_replay_create_device(
         replay, driver_node, replay->host_allocator, &replay->device));
     IREE_RETURN_IF_ERROR(iree_hal_module_create(
-        replay->device, replay->host_allocator, &module));
+        replay->device, IREE_HAL_MODULE_FLAG_NONE, replay->host_allocator,
+        &module));
   }
   if (!module) {
     return iree_make_status(
@@ -143,8 +144,9 @@ static iree_status_t iree_trace_replay_load_bytecode_module(
     IREE_RETURN_IF_ERROR(iree_file_path_join(
         replay->root_path, iree_yaml_node_as_string(path_node),
         replay->host_allocator, &full_path));
-    status = iree_file_read_contents(full_path, replay->host_allocator,
-                                     &flatbuffer_contents);
+    status = iree_file_read_contents_with_flags(
+        full_path, IREE_FILE_READ_FLAG_MMAP, replay->host_allocator,
+        &flatbuffer_contents);
     iree_allocator_free(replay->host_allocator, full_path);
   }
 
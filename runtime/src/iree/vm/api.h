@@ -16,6 +16,7 @@
 #include "iree/vm/list.h"           // IWYU pragma: export
 #include "iree/vm/module.h"         // IWYU pragma: export
 #include "iree/vm/native_module.h"  // IWYU pragma: export
+#include "iree/vm/profile.h"        // IWYU pragma: export
 #include "iree/vm/ref.h"            // IWYU pragma: export
 #include "iree/vm/shims.h"          // IWYU pragma: export
 #include "iree/vm/stack.h"          // IWYU pragma: export
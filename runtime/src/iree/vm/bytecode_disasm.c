@@ -1548,6 +1548,50 @@ iree_status_t iree_vm_bytecode_disasm_op(
       break;
     }
 
+#define DISASM_OP_CORE_COND_BRANCH_CMP(op_name, type, op_mnemonic)           \
+  DISASM_OP(CORE, op_name) {                                                \
+    uint16_t lhs_reg = VM_ParseOperandReg##type("lhs");                     \
+    uint16_t rhs_reg = VM_ParseOperandReg##type("rhs");                     \
+    int32_t true_block_pc = VM_ParseBranchTarget("true_dest");              \
+    const iree_vm_register_remap_list_t* true_remap_list =                  \
+        VM_ParseBranchOperands("true_operands");                            \
+    int32_t false_block_pc = VM_ParseBranchTarget("false_dest");            \
+    const iree_vm_register_remap_list_t* false_remap_list =                 \
+        VM_ParseBranchOperands("false_operands");                           \
+    IREE_RETURN_IF_ERROR(                                                   \
+        iree_string_builder_append_format(b, "%s ", op_mnemonic));          \
+    EMIT_##type##_REG_NAME(lhs_reg);                                        \
+    EMIT_OPTIONAL_VALUE_##type(regs->i32[lhs_reg]);                         \
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, ", "));      \
+    EMIT_##type##_REG_NAME(rhs_reg);                                        \
+    EMIT_OPTIONAL_VALUE_##type(regs->i32[rhs_reg]);                         \
+    IREE_RETURN_IF_ERROR(                                                   \
+        iree_string_builder_append_format(b, ", ^%08X(", true_block_pc));   \
+    EMIT_REMAP_LIST(true_remap_list);                                       \
+    IREE_RETURN_IF_ERROR(                                                   \
+        iree_string_builder_append_format(b, "), ^%08X(", false_block_pc)); \
+    EMIT_REMAP_LIST(false_remap_list);                                      \
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, ")"));       \
+    break;                                                                  \
+  }
+
+    DISASM_OP_CORE_COND_BRANCH_CMP(CondBranchCmpEQI32, I32,
+                                   "vm.cond_br.cmp.eq.i32");
+    DISASM_OP_CORE_COND_BRANCH_CMP(CondBranchCmpNEI32, I32,
+                                   "vm.cond_br.cmp.ne.i32");
+    DISASM_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI32S, I32,
+                                   "vm.cond_br.cmp.lt.i32.s");
+    DISASM_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI32U, I32,
+                                   "vm.cond_br.cmp.lt.i32.u");
+    DISASM_OP_CORE_COND_BRANCH_CMP(CondBranchCmpEQI64, I64,
+                                   "vm.cond_br.cmp.eq.i64");
+    DISASM_OP_CORE_COND_BRANCH_CMP(CondBranchCmpNEI64, I64,
+                                   "vm.cond_br.cmp.ne.i64");
+    DISASM_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI64S, I64,
+                                   "vm.cond_br.cmp.lt.i64.s");
+    DISASM_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI64U, I64,
+                                   "vm.cond_br.cmp.lt.i64.u");
+
     DISASM_OP(CORE, Call) {
       int32_t function_ordinal = VM_ParseFuncAttr("callee");
       const iree_vm_register_list_t* src_reg_list =
@@ -37,10 +37,10 @@ static void iree_vm_bytecode_dispatch_remap_branch_registers(
     uint16_t dst_reg = remap_list->pairs[i].dst_reg;
     if (src_reg & IREE_REF_REGISTER_TYPE_BIT) {
       iree_vm_ref_retain_or_move(src_reg & IREE_REF_REGISTER_MOVE_BIT,
-                                 &regs.ref[src_reg & regs.ref_mask],
-                                 &regs.ref[dst_reg & regs.ref_mask]);
+                                 &regs.ref[VM_RegRef(regs, src_reg)],
+                                 &regs.ref[VM_RegRef(regs, dst_reg)]);
     } else {
-      regs.i32[dst_reg & regs.i32_mask] = regs.i32[src_reg & regs.i32_mask];
+      regs.i32[VM_RegI32(regs, dst_reg)] = regs.i32[VM_RegI32(regs, src_reg)];
     }
   }
 }
@@ -56,7 +56,7 @@ static void iree_vm_bytecode_dispatch_discard_registers(
     uint16_t reg = reg_list->registers[i];
     if ((reg & (IREE_REF_REGISTER_TYPE_BIT | IREE_REF_REGISTER_MOVE_BIT)) ==
         (IREE_REF_REGISTER_TYPE_BIT | IREE_REF_REGISTER_MOVE_BIT)) {
-      iree_vm_ref_release(&regs.ref[reg & regs.ref_mask]);
+      iree_vm_ref_release(&regs.ref[VM_RegRef(regs, reg)]);
     }
   }
 }
@@ -90,6 +90,16 @@ static iree_vm_registers_t iree_vm_bytecode_get_register_storage(
   return registers;
 }
 
+// Returns the storage within |frame| that yielding imports write results into.
+static iree_byte_span_t iree_vm_bytecode_get_import_results(
+    iree_vm_stack_frame_t* frame) {
+  iree_vm_bytecode_frame_storage_t* stack_storage =
+      (iree_vm_bytecode_frame_storage_t*)iree_vm_stack_frame_storage(frame);
+  return iree_make_byte_span(
+      (uint8_t*)stack_storage + stack_storage->import_result_offset,
+      stack_storage->import_result_capacity);
+}
+
 // Releases any remaining refs held in the frame storage.
 static void iree_vm_bytecode_stack_frame_cleanup(iree_vm_stack_frame_t* frame) {
   iree_vm_registers_t regs = iree_vm_bytecode_get_register_storage(frame);
@@ -99,6 +109,30 @@ static void iree_vm_bytecode_stack_frame_cleanup(iree_vm_stack_frame_t* frame) {
     iree_vm_ref_t* ref = &regs.ref[i];
     if (ref->ptr) iree_vm_ref_release(ref);
   }
+
+  // Release any results of a yielded import call that were never marshaled.
+  iree_vm_bytecode_frame_storage_t* stack_storage =
+      (iree_vm_bytecode_frame_storage_t*)iree_vm_stack_frame_storage(frame);
+  if (stack_storage->pending_import) {
+    iree_string_view_t cconv_results = stack_storage->pending_import_results;
+    uint8_t* p = iree_vm_bytecode_get_import_results(frame).data;
+    for (iree_host_size_t i = 0; i < cconv_results.size; ++i) {
+      switch (cconv_results.data[i]) {
+        case IREE_VM_CCONV_TYPE_I32:
+        case IREE_VM_CCONV_TYPE_F32:
+          p += sizeof(int32_t);
+          break;
+        case IREE_VM_CCONV_TYPE_I64:
+        case IREE_VM_CCONV_TYPE_F64:
+          p += sizeof(int64_t);
+          break;
+        case IREE_VM_CCONV_TYPE_REF:
+          iree_vm_ref_release((iree_vm_ref_t*)p);
+          p += sizeof(iree_vm_ref_t);
+          break;
+      }
+    }
+  }
 }
 
 static iree_status_t iree_vm_bytecode_function_enter(
@@ -148,8 +182,11 @@ static iree_status_t iree_vm_bytecode_function_enter(
       iree_host_align(i32_register_count * sizeof(int32_t), 16);
   iree_host_size_t ref_register_size =
       iree_host_align(ref_register_count * sizeof(iree_vm_ref_t), 16);
+  // Imports that yield write their results into the frame when resumed.
+  iree_host_size_t import_result_size = iree_host_align(
+      module->function_import_result_sizes[function.ordinal], 16);
   iree_host_size_t frame_size =
-      header_size + i32_register_size + ref_register_size;
+      header_size + i32_register_size + ref_register_size + import_result_size;
 
   // Enter function and allocate stack frame storage.
   IREE_RETURN_IF_ERROR(iree_vm_stack_function_enter(
@@ -165,6 +202,9 @@ static iree_status_t iree_vm_bytecode_function_enter(
   stack_storage->ref_register_count = ref_register_count;
   stack_storage->i32_register_offset = header_size;
   stack_storage->ref_register_offset = header_size + i32_register_size;
+  stack_storage->import_result_offset =
+      header_size + i32_register_size + ref_register_size;
+  stack_storage->import_result_capacity = import_result_size;
   *out_callee_registers =
       iree_vm_bytecode_get_register_storage(*out_callee_frame);
 
@@ -476,35 +516,12 @@ static void iree_vm_bytecode_populate_import_cconv_arguments(
   }
 }
 
-// Issues a populated import call and marshals the results into |dst_reg_list|.
-static iree_status_t iree_vm_bytecode_issue_import_call(
-    iree_vm_stack_t* stack, const iree_vm_function_call_t call,
-    iree_string_view_t cconv_results,
+// Marshals import call |results| from the ABI results buffer to registers.
+static void iree_vm_bytecode_marshal_import_results(
+    iree_string_view_t cconv_results, iree_byte_span_t results,
     const iree_vm_register_list_t* IREE_RESTRICT dst_reg_list,
-    iree_vm_stack_frame_t** out_caller_frame,
-    iree_vm_registers_t* out_caller_registers,
-    iree_vm_execution_result_t* out_result) {
-  // Call external function.
-  iree_status_t call_status = call.function.module->begin_call(
-      call.function.module->self, stack, &call, out_result);
-  if (iree_status_is_deferred(call_status)) {
-    return call_status;  // deferred for future resume
-  } else if (IREE_UNLIKELY(!iree_status_is_ok(call_status))) {
-    // TODO(benvanik): set execution result to failure/capture stack.
-    return iree_status_annotate(call_status,
-                                iree_make_cstring_view("while calling import"));
-  }
-
-  // NOTE: we don't support yielding within imported functions right now so it's
-  // safe to assume the stack is still valid here. If the called function can
-  // yield then we'll need to requery all pointers here.
-  *out_caller_frame = iree_vm_stack_current_frame(stack);
-  *out_caller_registers =
-      iree_vm_bytecode_get_register_storage(*out_caller_frame);
-
-  // Marshal outputs from the ABI results buffer to registers.
-  iree_vm_registers_t caller_registers = *out_caller_registers;
-  uint8_t* IREE_RESTRICT p = call.results.data;
+    iree_vm_registers_t caller_registers) {
+  uint8_t* IREE_RESTRICT p = results.data;
   for (iree_host_size_t i = 0; i < cconv_results.size && i < dst_reg_list->size;
        ++i) {
     uint16_t dst_reg = dst_reg_list->registers[i];
@@ -532,6 +549,71 @@ static iree_status_t iree_vm_bytecode_issue_import_call(
         break;
     }
   }
+}
+
+// Issues a populated import call and marshals the results into |dst_reg_list|.
+static iree_status_t iree_vm_bytecode_issue_import_call(
+    iree_vm_stack_t* stack, const iree_vm_function_call_t call,
+    iree_string_view_t cconv_results,
+    const iree_vm_register_list_t* IREE_RESTRICT dst_reg_list,
+    iree_vm_stack_frame_t** out_caller_frame,
+    iree_vm_registers_t* out_caller_registers,
+    iree_vm_execution_result_t* out_result) {
+  // If the import yields it will be resumed after this frame has been
+  // suspended and our |call| results buffer is gone. Point the callee at
+  // storage within our frame instead and marshal the results on resume.
+  // The frame may move if the stack grows during the call so nothing here
+  // can be accessed again until we requery it.
+  iree_vm_stack_frame_t* caller_frame = iree_vm_stack_current_frame(stack);
+  iree_vm_bytecode_frame_storage_t* caller_storage =
+      (iree_vm_bytecode_frame_storage_t*)iree_vm_stack_frame_storage(
+          caller_frame);
+  bool can_yield =
+      call.results.data_length <= caller_storage->import_result_capacity;
+  if (can_yield) {
+    iree_byte_span_t import_results =
+        iree_vm_bytecode_get_import_results(caller_frame);
+    import_results.data_length = call.results.data_length;
+    memset(import_results.data, 0, import_results.data_length);
+    caller_storage->return_registers = dst_reg_list;
+    caller_storage->pending_import = true;
+    caller_storage->pending_import_results = cconv_results;
+    iree_vm_stack_set_call_results(stack, caller_frame, import_results);
+  }
+
+  // Call external function.
+  iree_status_t call_status = call.function.module->begin_call(
+      call.function.module->self, stack, &call, out_result);
+  if (iree_status_is_deferred(call_status)) {
+    if (IREE_UNLIKELY(!can_yield)) {
+      return iree_make_status(
+          IREE_STATUS_UNIMPLEMENTED,
+          "import yielded with results larger than the frame reserved");
+    }
+    return call_status;  // deferred for future resume
+  } else if (IREE_UNLIKELY(!iree_status_is_ok(call_status))) {
+    // TODO(benvanik): set execution result to failure/capture stack.
+    return iree_status_annotate(call_status,
+                                iree_make_cstring_view("while calling import"));
+  }
+
+  // The import completed synchronously and the stack may have grown while it
+  // ran so we need to requery all pointers here.
+  *out_caller_frame = iree_vm_stack_current_frame(stack);
+  *out_caller_registers =
+      iree_vm_bytecode_get_register_storage(*out_caller_frame);
+  if (can_yield) {
+    caller_storage =
+        (iree_vm_bytecode_frame_storage_t*)iree_vm_stack_frame_storage(
+            *out_caller_frame);
+    caller_storage->pending_import = false;
+    iree_vm_stack_set_call_results(stack, *out_caller_frame,
+                                   iree_byte_span_empty());
+  }
+
+  // Marshal outputs from the ABI results buffer to registers.
+  iree_vm_bytecode_marshal_import_results(cconv_results, call.results,
+                                          dst_reg_list, *out_caller_registers);
 
   return iree_ok_status();
 }
@@ -685,16 +767,110 @@ iree_status_t iree_vm_bytecode_dispatch_resume(
       iree_vm_bytecode_get_register_storage(current_frame);
   // TODO(benvanik): assert the module is at the top of the frame? We should
   // only be coming in from a call based on the current frame.
+
+  // If we yielded while calling an import it has now completed and its
+  // results are waiting in our frame.
+  iree_vm_bytecode_frame_storage_t* stack_storage =
+      (iree_vm_bytecode_frame_storage_t*)iree_vm_stack_frame_storage(
+          current_frame);
+  if (stack_storage->pending_import) {
+    stack_storage->pending_import = false;
+    iree_vm_stack_set_call_results(stack, current_frame,
+                                   iree_byte_span_empty());
+    iree_vm_bytecode_marshal_import_results(
+        stack_storage->pending_import_results,
+        iree_vm_bytecode_get_import_results(current_frame),
+        stack_storage->return_registers, regs);
+  }
+
+  // If our caller is still on the stack it provides the results storage; it's
+  // only valid until the stack grows so the return looks it up again.
+  if (!iree_byte_span_is_empty(
+          iree_vm_stack_call_results(stack, current_frame))) {
+    call_results = iree_byte_span_empty();
+  }
+
   return iree_vm_bytecode_dispatch(stack, module, current_frame, regs,
                                    call_results, out_result);
 }
 
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+
+// Resolves the profile counters for |module| when |stack| is being profiled.
+// |cursor->module| remains NULL when profiling is disabled.
+static iree_status_t iree_vm_bytecode_profile_begin(
+    iree_vm_stack_t* stack, iree_vm_bytecode_module_t* module,
+    iree_vm_bytecode_profile_cursor_t* cursor) {
+  memset(cursor, 0, sizeof(*cursor));
+  cursor->function_ordinal = -1;
+  cursor->profile = iree_vm_stack_profile(stack);
+  if (!cursor->profile) return iree_ok_status();
+  return iree_vm_profile_lookup_module(cursor->profile, &module->interface,
+                                       module->function_descriptor_count,
+                                       &cursor->module);
+}
+
+// Charges the in-flight instruction with the ticks elapsed since it started
+// and begins counting the instruction at |pc| in |current_frame|.
+static iree_status_t iree_vm_bytecode_profile_instruction(
+    iree_vm_bytecode_profile_cursor_t* cursor,
+    iree_vm_bytecode_module_t* module, iree_vm_stack_frame_t* current_frame,
+    iree_vm_source_offset_t pc, iree_host_size_t opcode_slot,
+    const char* opcode_name) {
+  uint64_t ticks = iree_vm_profile_ticks();
+  if (cursor->pending_pc) {
+    uint64_t elapsed = ticks - cursor->pending_ticks;
+    cursor->pending_function->ticks += elapsed;
+    cursor->pending_opcode->ticks += elapsed;
+    cursor->pending_pc->ticks += elapsed;
+  }
+
+  // Internal calls and returns switch functions without leaving the dispatch.
+  int32_t function_ordinal = (int32_t)current_frame->function.ordinal;
+  if (IREE_UNLIKELY(function_ordinal != cursor->function_ordinal)) {
+    iree_vm_profile_function_t* function =
+        &cursor->module->functions[function_ordinal];
+    IREE_RETURN_IF_ERROR(iree_vm_profile_reserve_function(
+        cursor->profile, function,
+        module->function_descriptor_table[function_ordinal].bytecode_length));
+    cursor->function_ordinal = function_ordinal;
+    cursor->function = function;
+  }
+
+  iree_vm_profile_function_t* function = cursor->function;
+  iree_vm_profile_opcode_t* opcode =
+      &iree_vm_profile_opcodes(cursor->profile)[opcode_slot];
+  iree_vm_profile_pc_t* pc_counters = &function->pcs[pc];
+  ++function->instruction_count;
+  opcode->name = opcode_name;
+  ++opcode->count;
+  pc_counters->name = opcode_name;
+  ++pc_counters->count;
+
+  cursor->pending_function = function;
+  cursor->pending_opcode = opcode;
+  cursor->pending_pc = pc_counters;
+  cursor->pending_ticks = ticks;
+  return iree_ok_status();
+}
+
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
+
 static iree_status_t iree_vm_bytecode_dispatch(
     iree_vm_stack_t* stack, iree_vm_bytecode_module_t* module,
     iree_vm_stack_frame_t* current_frame, iree_vm_registers_t regs,
     iree_byte_span_t call_results, iree_vm_execution_result_t* out_result) {
   memset(out_result, 0, sizeof(*out_result));
 
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+  // Profiling is resolved once per dispatch as internal calls never leave the
+  // module. The last instruction executed before leaving the dispatch (a
+  // return or a yielding call) is counted but its ticks are not recorded.
+  iree_vm_bytecode_profile_cursor_t profile_cursor;
+  IREE_RETURN_IF_ERROR(
+      iree_vm_bytecode_profile_begin(stack, module, &profile_cursor));
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
+
   // When required emit the dispatch tables here referencing the labels we are
   // defining below.
   DEFINE_DISPATCH_TABLES();
@@ -721,8 +897,8 @@ static iree_status_t iree_vm_bytecode_dispatch(
 
     DISPATCH_OP(CORE, GlobalLoadI32, {
       uint32_t byte_offset = VM_DecGlobalAttr("global");
-      if (IREE_UNLIKELY(byte_offset >=
-                        module_state->rwdata_storage.data_length)) {
+      if (IREE_UNLIKELY(VM_UNVERIFIED(
+              byte_offset >= module_state->rwdata_storage.data_length))) {
         return iree_make_status(
             IREE_STATUS_OUT_OF_RANGE,
             "global byte_offset out of range: %d (rwdata=%zu)", byte_offset,
@@ -736,8 +912,8 @@ static iree_status_t iree_vm_bytecode_dispatch(
 
     DISPATCH_OP(CORE, GlobalStoreI32, {
       uint32_t byte_offset = VM_DecGlobalAttr("global");
-      if (IREE_UNLIKELY(byte_offset >=
-                        module_state->rwdata_storage.data_length)) {
+      if (IREE_UNLIKELY(VM_UNVERIFIED(
+              byte_offset >= module_state->rwdata_storage.data_length))) {
         return iree_make_status(
             IREE_STATUS_OUT_OF_RANGE,
             "global byte_offset out of range: %d (rwdata=%zu)", byte_offset,
@@ -779,8 +955,8 @@ static iree_status_t iree_vm_bytecode_dispatch(
 
     DISPATCH_OP(CORE, GlobalLoadI64, {
       uint32_t byte_offset = VM_DecGlobalAttr("global");
-      if (IREE_UNLIKELY(byte_offset >=
-                        module_state->rwdata_storage.data_length)) {
+      if (IREE_UNLIKELY(VM_UNVERIFIED(
+              byte_offset >= module_state->rwdata_storage.data_length))) {
         return iree_make_status(
             IREE_STATUS_OUT_OF_RANGE,
             "global byte_offset out of range: %d (rwdata=%zu)", byte_offset,
@@ -794,8 +970,8 @@ static iree_status_t iree_vm_bytecode_dispatch(
 
     DISPATCH_OP(CORE, GlobalStoreI64, {
       uint32_t byte_offset = VM_DecGlobalAttr("global");
-      if (IREE_UNLIKELY(byte_offset >=
-                        module_state->rwdata_storage.data_length)) {
+      if (IREE_UNLIKELY(VM_UNVERIFIED(
+              byte_offset >= module_state->rwdata_storage.data_length))) {
         return iree_make_status(
             IREE_STATUS_OUT_OF_RANGE,
             "global byte_offset out of range: %d (rwdata=%zu)", byte_offset,
@@ -837,7 +1013,8 @@ static iree_status_t iree_vm_bytecode_dispatch(
 
     DISPATCH_OP(CORE, GlobalLoadRef, {
       uint32_t global = VM_DecGlobalAttr("global");
-      if (IREE_UNLIKELY(global >= module_state->global_ref_count)) {
+      if (IREE_UNLIKELY(
+              VM_UNVERIFIED(global >= module_state->global_ref_count))) {
         return iree_make_status(
             IREE_STATUS_OUT_OF_RANGE,
             "global ref ordinal out of range: %d (table=%zu)", global,
@@ -853,7 +1030,8 @@ static iree_status_t iree_vm_bytecode_dispatch(
 
     DISPATCH_OP(CORE, GlobalStoreRef, {
       uint32_t global = VM_DecGlobalAttr("global");
-      if (IREE_UNLIKELY(global >= module_state->global_ref_count)) {
+      if (IREE_UNLIKELY(
+              VM_UNVERIFIED(global >= module_state->global_ref_count))) {
         return iree_make_status(
             IREE_STATUS_OUT_OF_RANGE,
             "global ref ordinal out of range: %d (table=%zu)", global,
@@ -933,7 +1111,8 @@ static iree_status_t iree_vm_bytecode_dispatch(
 
     DISPATCH_OP(CORE, ConstRefRodata, {
       uint32_t rodata_ordinal = VM_DecRodataAttr("rodata");
-      if (IREE_UNLIKELY(rodata_ordinal >= module_state->rodata_ref_count)) {
+      if (IREE_UNLIKELY(
+              VM_UNVERIFIED(rodata_ordinal >= module_state->rodata_ref_count))) {
         return iree_make_status(
             IREE_STATUS_OUT_OF_RANGE,
             "rodata ref ordinal out of range: %d (table=%zu)", rodata_ordinal,
@@ -1468,7 +1647,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
           VM_DecVariadicOperands("values");
       int32_t* result = VM_DecResultRegI32("result");
       if (index >= 0 && index < value_reg_list->size) {
-        *result = regs.i32[value_reg_list->registers[index] & regs.i32_mask];
+        *result = regs.i32[VM_RegI32(regs, value_reg_list->registers[index])];
       } else {
         *result = default_value;
       }
@@ -1482,7 +1661,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
       int64_t* result = VM_DecResultRegI64("result");
       if (index >= 0 && index < value_reg_list->size) {
         *result =
-            regs.i32[value_reg_list->registers[index] & (regs.i32_mask & ~1)];
+            regs.i32[VM_RegI64(regs, value_reg_list->registers[index])];
       } else {
         *result = default_value;
       }
@@ -1502,7 +1681,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
         bool is_move =
             value_reg_list->registers[index] & IREE_REF_REGISTER_MOVE_BIT;
         iree_vm_ref_t* new_value =
-            &regs.ref[value_reg_list->registers[index] & regs.ref_mask];
+            &regs.ref[VM_RegRef(regs, value_reg_list->registers[index])];
         IREE_RETURN_IF_ERROR(iree_vm_ref_retain_or_move_checked(
             is_move, new_value, type_def->ref_type, result));
       } else {
@@ -1686,6 +1865,43 @@ static iree_status_t iree_vm_bytecode_dispatch(
       }
     });
 
+    //===------------------------------------------------------------------===//
+    // Superinstructions
+    //===------------------------------------------------------------------===//
+    // Fused sequences emitted by the compiler in place of a vm.cmp.* whose
+    // only use is the immediately following vm.cond_br. Saves a dispatch and
+    // the round-trip of the condition through the register file.
+
+#define DISPATCH_OP_CORE_COND_BRANCH_CMP(op_name, bits, op_func)          \
+  DISPATCH_OP(CORE, op_name, {                                            \
+    int##bits##_t lhs = VM_DecOperandRegI##bits("lhs");                   \
+    int##bits##_t rhs = VM_DecOperandRegI##bits("rhs");                   \
+    int32_t true_block_pc = VM_DecBranchTarget("true_dest");              \
+    const iree_vm_register_remap_list_t* true_remap_list =                \
+        VM_DecBranchOperands("true_operands");                            \
+    int32_t false_block_pc = VM_DecBranchTarget("false_dest");            \
+    const iree_vm_register_remap_list_t* false_remap_list =               \
+        VM_DecBranchOperands("false_operands");                           \
+    if (op_func(lhs, rhs)) {                                              \
+      pc = true_block_pc;                                                 \
+      iree_vm_bytecode_dispatch_remap_branch_registers(regs,              \
+                                                       true_remap_list);  \
+    } else {                                                              \
+      pc = false_block_pc;                                                \
+      iree_vm_bytecode_dispatch_remap_branch_registers(regs,              \
+                                                       false_remap_list); \
+    }                                                                     \
+  });
+
+    DISPATCH_OP_CORE_COND_BRANCH_CMP(CondBranchCmpEQI32, 32, vm_cmp_eq_i32);
+    DISPATCH_OP_CORE_COND_BRANCH_CMP(CondBranchCmpNEI32, 32, vm_cmp_ne_i32);
+    DISPATCH_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI32S, 32, vm_cmp_lt_i32s);
+    DISPATCH_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI32U, 32, vm_cmp_lt_i32u);
+    DISPATCH_OP_CORE_COND_BRANCH_CMP(CondBranchCmpEQI64, 64, vm_cmp_eq_i64);
+    DISPATCH_OP_CORE_COND_BRANCH_CMP(CondBranchCmpNEI64, 64, vm_cmp_ne_i64);
+    DISPATCH_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI64S, 64, vm_cmp_lt_i64s);
+    DISPATCH_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI64U, 64, vm_cmp_lt_i64u);
+
     DISPATCH_OP(CORE, Call, {
       int32_t function_ordinal = VM_DecFuncAttr("callee");
       const iree_vm_register_list_t* src_reg_list =
@@ -1753,8 +1969,14 @@ static iree_status_t iree_vm_bytecode_dispatch(
       if (!parent_frame ||
           parent_frame->module_state != current_frame->module_state) {
         // Return from the top-level entry frame - return back to call().
+        // Callers that remained on the stack while we yielded have their
+        // results storage in their own frame.
+        iree_byte_span_t results = call_results;
+        if (iree_byte_span_is_empty(results)) {
+          results = iree_vm_stack_call_results(stack, current_frame);
+        }
         return iree_vm_bytecode_external_leave(stack, current_frame, &regs,
-                                               src_reg_list, call_results);
+                                               src_reg_list, results);
       }
 
       // Store results into the caller frame and pop back to the parent.
@@ -1778,13 +2000,21 @@ static iree_status_t iree_vm_bytecode_dispatch(
         return iree_status_allocate_f(status_code, "<vm>", 0, "%.*s",
                                       (int)message.size, message.data);
       }
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE
+      // Verification treats vm.fail as a terminator and execution must not
+      // fall through to whatever follows it in the bytecode.
+      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "vm.fail with an OK status code: %.*s",
+                              (int)message.size, message.data);
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE
     });
 
     DISPATCH_OP(CORE, ImportResolved, {
       uint32_t function_ordinal = VM_DecFuncAttr("import");
       int32_t* result = VM_DecResultRegI32("result");
       uint32_t import_ordinal = function_ordinal & 0x7FFFFFFFu;
-      if (IREE_UNLIKELY(import_ordinal >= module_state->import_count)) {
+      if (IREE_UNLIKELY(
+              VM_UNVERIFIED(import_ordinal >= module_state->import_count))) {
         return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                                 "import ordinal out of range");
       }
@@ -1867,8 +2097,8 @@ static iree_status_t iree_vm_bytecode_dispatch(
 
       DISPATCH_OP(EXT_F32, GlobalLoadF32, {
         uint32_t byte_offset = VM_DecGlobalAttr("global");
-        if (IREE_UNLIKELY(byte_offset >=
-                          module_state->rwdata_storage.data_length)) {
+        if (IREE_UNLIKELY(VM_UNVERIFIED(
+                byte_offset >= module_state->rwdata_storage.data_length))) {
           return iree_make_status(
               IREE_STATUS_OUT_OF_RANGE,
               "global byte_offset out of range: %d (rwdata=%zu)", byte_offset,
@@ -1882,8 +2112,8 @@ static iree_status_t iree_vm_bytecode_dispatch(
 
       DISPATCH_OP(EXT_F32, GlobalStoreF32, {
         uint32_t byte_offset = VM_DecGlobalAttr("global");
-        if (IREE_UNLIKELY(byte_offset >=
-                          module_state->rwdata_storage.data_length)) {
+        if (IREE_UNLIKELY(VM_UNVERIFIED(
+                byte_offset >= module_state->rwdata_storage.data_length))) {
           return iree_make_status(
               IREE_STATUS_OUT_OF_RANGE,
               "global byte_offset out of range: %d (rwdata=%zu)", byte_offset,
@@ -1989,8 +2219,8 @@ static iree_status_t iree_vm_bytecode_dispatch(
             VM_DecVariadicOperands("values");
         float* result = VM_DecResultRegF32("result");
         if (index >= 0 && index < value_reg_list->size) {
-          *result = *((float*)&regs.i32[value_reg_list->registers[index] &
-                                        (regs.i32_mask & ~1)]);
+          *result = *((float*)&regs.i32[VM_RegI64(
+              regs, value_reg_list->registers[index])]);
         } else {
           *result = default_value;
         }
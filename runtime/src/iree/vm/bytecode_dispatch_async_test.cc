@@ -15,6 +15,7 @@
 #include "iree/testing/status_matchers.h"
 #include "iree/vm/api.h"
 #include "iree/vm/bytecode_module.h"
+#include "iree/vm/native_module.h"
 
 // Compiled module embedded here to avoid file IO:
 #include "iree/vm/test/async_bytecode_modules.h"
@@ -24,6 +25,52 @@ namespace {
 
 using iree::testing::status::StatusIs;
 
+// Value passed to yieldable_test.yield_add_1 stashed across its yield as the
+// resume does not receive the arguments again.
+static int32_t yield_add_1_pending_value = 0;
+
+// Native import (i32)->i32 that yields on a wait frame before returning its
+// argument + 1.
+static iree_status_t yieldable_test_yield_add_1(
+    iree_vm_stack_t* stack, iree_vm_native_function_flags_t flags,
+    iree_byte_span_t args_storage, iree_byte_span_t rets_storage,
+    iree_vm_native_function_target_t target_fn, void* module,
+    void* module_state, iree_vm_execution_result_t* out_result) {
+  if (flags & IREE_VM_NATIVE_FUNCTION_CALL_BEGIN) {
+    memcpy(&yield_add_1_pending_value, args_storage.data, sizeof(int32_t));
+    iree_vm_wait_frame_t* wait_frame = NULL;
+    IREE_RETURN_IF_ERROR(iree_vm_stack_wait_enter(stack, IREE_VM_WAIT_UNTIL, 0,
+                                                  iree_immediate_timeout(), 0,
+                                                  &wait_frame));
+    return iree_status_from_code(IREE_STATUS_DEFERRED);
+  }
+  iree_vm_wait_result_t wait_result;
+  IREE_RETURN_IF_ERROR(iree_vm_stack_wait_leave(stack, &wait_result));
+  IREE_RETURN_IF_ERROR(wait_result.status);
+  int32_t ret0 = yield_add_1_pending_value + 1;
+  memcpy(rets_storage.data, &ret0, sizeof(ret0));
+  return iree_ok_status();
+}
+
+static const iree_vm_native_export_descriptor_t yieldable_test_exports_[] = {
+    {iree_make_cstring_view("yield_add_1"), iree_make_cstring_view("0i_i"), 0,
+     NULL},
+};
+static const iree_vm_native_function_ptr_t yieldable_test_funcs_[] = {
+    {yieldable_test_yield_add_1, NULL},
+};
+static const iree_vm_native_module_descriptor_t yieldable_test_descriptor_ = {
+    iree_make_cstring_view("yieldable_test"),
+    0,
+    NULL,
+    IREE_ARRAYSIZE(yieldable_test_exports_),
+    yieldable_test_exports_,
+    IREE_ARRAYSIZE(yieldable_test_funcs_),
+    yieldable_test_funcs_,
+    0,
+    NULL,
+};
+
 class VMBytecodeDispatchAsyncTest : public ::testing::Test {
  protected:
   static void SetUpTestSuite() {
@@ -36,12 +83,18 @@ class VMBytecodeDispatchAsyncTest : public ::testing::Test {
 
     IREE_CHECK_OK(iree_vm_instance_create(iree_allocator_system(), &instance_));
 
+    iree_vm_module_t interface;
+    IREE_CHECK_OK(iree_vm_module_initialize(&interface, NULL));
+    IREE_CHECK_OK(iree_vm_native_module_create(
+        &interface, &yieldable_test_descriptor_, iree_allocator_system(),
+        &native_module_));
+
     IREE_CHECK_OK(iree_vm_bytecode_module_create(
         iree_const_byte_span_t{reinterpret_cast<const uint8_t*>(file->data),
                                file->size},
         iree_allocator_null(), iree_allocator_system(), &bytecode_module_));
 
-    std::vector<iree_vm_module_t*> modules = {bytecode_module_};
+    std::vector<iree_vm_module_t*> modules = {native_module_, bytecode_module_};
     IREE_CHECK_OK(iree_vm_context_create_with_modules(
         instance_, IREE_VM_CONTEXT_FLAG_NONE, modules.size(), modules.data(),
         iree_allocator_system(), &context_));
@@ -50,12 +103,14 @@ class VMBytecodeDispatchAsyncTest : public ::testing::Test {
   void TearDown() override {
     IREE_TRACE_SCOPE();
     iree_vm_module_release(bytecode_module_);
+    iree_vm_module_release(native_module_);
     iree_vm_context_release(context_);
     iree_vm_instance_release(instance_);
   }
 
   iree_vm_instance_t* instance_ = nullptr;
   iree_vm_context_t* context_ = nullptr;
+  iree_vm_module_t* native_module_ = nullptr;
   iree_vm_module_t* bytecode_module_ = nullptr;
 };
 
@@ -160,5 +215,39 @@ TEST_F(VMBytecodeDispatchAsyncTest, YieldDivergent) {
   iree_vm_stack_deinitialize(stack);
 }
 
+// Tests calling an import that yields on a wait frame; the import results must
+// be delivered to the caller when it resumes.
+// See iree/vm/test/async_ops.mlir > @call_yielding_import
+TEST_F(VMBytecodeDispatchAsyncTest, CallYieldingImport) {
+  IREE_TRACE_SCOPE();
+
+  iree_vm_function_t function;
+  IREE_ASSERT_OK(iree_vm_module_lookup_function_by_name(
+      bytecode_module_, IREE_VM_FUNCTION_LINKAGE_EXPORT,
+      IREE_SV("call_yielding_import"), &function));
+
+  iree_vm_list_t* inputs = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(nullptr, 1, iree_allocator_system(), &inputs));
+  iree_vm_value_t arg0 = iree_vm_value_make_i32(97);
+  IREE_ASSERT_OK(iree_vm_list_push_value(inputs, &arg0));
+  iree_vm_list_t* outputs = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(nullptr, 1, iree_allocator_system(), &outputs));
+
+  // iree_vm_invoke performs the wait and resumes the import and then the
+  // bytecode caller.
+  IREE_ASSERT_OK(iree_vm_invoke(
+      context_, function, IREE_VM_INVOCATION_FLAG_NONE, /*policy=*/nullptr,
+      inputs, outputs, iree_allocator_system()));
+
+  iree_vm_value_t ret0;
+  IREE_ASSERT_OK(iree_vm_list_get_value(outputs, 0, &ret0));
+  ASSERT_EQ(ret0.i32, 97 + 2);
+
+  iree_vm_list_release(inputs);
+  iree_vm_list_release(outputs);
+}
+
 }  // namespace
 }  // namespace iree
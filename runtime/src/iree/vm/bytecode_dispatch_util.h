@@ -8,6 +8,7 @@
 #define IREE_VM_BYTECODE_DISPATCH_UTIL_H_
 
 #include <assert.h>
+#include <stdbool.h>
 #include <string.h>
 
 #include "iree/base/alignment.h"
@@ -15,6 +16,7 @@
 #include "iree/base/target_platform.h"
 #include "iree/vm/bytecode_module_impl.h"
 #include "iree/vm/generated/bytecode_op_table.h"
+#include "iree/vm/profile.h"
 
 //===----------------------------------------------------------------------===//
 // Shared data structures
@@ -33,6 +35,13 @@
 // sneak in. The iree_vm_registers_t struct is often kept in cache and the
 // masking is cheap relative to any other validation we could be performing.
 //
+// When IREE_VM_BYTECODE_VERIFICATION_ENABLE is set all bytecode is verified
+// when modules are loaded (see bytecode_verifier.h) and register ordinals
+// decoded from the bytecode are known to be in range of the function register
+// counts. In that mode the masking is dropped from the per-operation decoding
+// and only the ref type/move bits are stripped. Registers produced at runtime
+// (such as those marshaled across frames) continue to be masked.
+//
 // Alternative register widths
 // ---------------------------
 // Registers in the VM are just a blob of memory and not physical device
@@ -93,6 +102,17 @@ typedef struct iree_vm_bytecode_frame_storage_t {
   // Relative byte offsets from the head of this struct.
   iree_host_size_t i32_register_offset;
   iree_host_size_t ref_register_offset;
+
+  // Storage for the results of an import call that yields, relative to the
+  // head of this struct. The callee writes its results here when it is resumed
+  // and they are marshaled into |return_registers| when this frame resumes.
+  iree_host_size_t import_result_offset;
+  iree_host_size_t import_result_capacity;
+
+  // True if an import call yielded and its results are pending.
+  bool pending_import;
+  // Calling convention results fragment of the pending import call.
+  iree_string_view_t pending_import_results;
 } iree_vm_bytecode_frame_storage_t;
 
 // Interleaved src-dst register sets for branch register remapping.
@@ -111,12 +131,35 @@ static_assert(offsetof(iree_vm_register_remap_list_t, pairs) == 2,
               "Expect no padding in the struct");
 
 // Maps a type ID to a type def with clamping for out of bounds values.
+// Verified bytecode only contains valid type IDs and needs no clamping.
 static inline const iree_vm_type_def_t* iree_vm_map_type(
     iree_vm_bytecode_module_t* module, int32_t type_id) {
+#if !IREE_VM_BYTECODE_VERIFICATION_ENABLE
   type_id = type_id >= module->type_count ? 0 : type_id;
+#endif  // !IREE_VM_BYTECODE_VERIFICATION_ENABLE
   return &module->type_table[type_id];
 }
 
+// Maps register ordinals decoded from the bytecode to indices into the typed
+// register storage of |regs|.
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE
+#define VM_RegI32(regs, reg) (reg)
+#define VM_RegI64(regs, reg) (reg)
+#define VM_RegRef(regs, reg) ((reg)&IREE_REF_REGISTER_MASK)
+#else
+#define VM_RegI32(regs, reg) ((reg) & (regs).i32_mask)
+#define VM_RegI64(regs, reg) ((reg) & ((regs).i32_mask & ~1))
+#define VM_RegRef(regs, reg) ((reg) & (regs).ref_mask)
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE
+
+// Checks a condition that is guaranteed by load-time verification and only
+// needs to be checked at runtime when verification is disabled.
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE
+#define VM_UNVERIFIED(expr) 0
+#else
+#define VM_UNVERIFIED(expr) (expr)
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE
+
 //===----------------------------------------------------------------------===//
 // Debugging utilities
 //===----------------------------------------------------------------------===//
@@ -140,6 +183,42 @@ static inline const iree_vm_type_def_t* iree_vm_map_type(
 #define IREE_DISPATCH_TRACE_INSTRUCTION(...)
 #endif  // IREE_VM_EXECUTION_TRACING_ENABLE
 
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+
+// Per-dispatch profiling state. Each instruction is charged the ticks from its
+// start until the start of the next instruction executed in the same dispatch.
+typedef struct iree_vm_bytecode_profile_cursor_t {
+  // Profile being recorded into or NULL if profiling is disabled.
+  iree_vm_profile_t* profile;
+  // Counters for the dispatching module.
+  iree_vm_profile_module_t* module;
+  // Ordinal of the function |function| counts or -1 if not yet resolved.
+  int32_t function_ordinal;
+  iree_vm_profile_function_t* function;
+  // Counters of the in-flight instruction, if any.
+  iree_vm_profile_function_t* pending_function;
+  iree_vm_profile_opcode_t* pending_opcode;
+  iree_vm_profile_pc_t* pending_pc;
+  uint64_t pending_ticks;
+} iree_vm_bytecode_profile_cursor_t;
+
+// Opcode slot base of each extension prefix in iree_vm_profile_opcodes.
+#define VM_PROFILE_SLOT_CORE IREE_VM_PROFILE_OPCODE_SLOT_CORE
+#define VM_PROFILE_SLOT_EXT_I32 IREE_VM_PROFILE_OPCODE_SLOT_EXT_I32
+#define VM_PROFILE_SLOT_EXT_F32 IREE_VM_PROFILE_OPCODE_SLOT_EXT_F32
+#define VM_PROFILE_SLOT_EXT_F64 IREE_VM_PROFILE_OPCODE_SLOT_EXT_F64
+
+#define IREE_DISPATCH_PROFILE_INSTRUCTION(pc_offset, ext, op_name)        \
+  if (IREE_UNLIKELY(profile_cursor.module)) {                             \
+    IREE_RETURN_IF_ERROR(iree_vm_bytecode_profile_instruction(            \
+        &profile_cursor, module, current_frame, (pc - (pc_offset)),       \
+        VM_PROFILE_SLOT_##ext + IREE_VM_OP_##ext##_##op_name, #op_name)); \
+  }
+
+#else
+#define IREE_DISPATCH_PROFILE_INSTRUCTION(...)
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
+
 #if defined(IREE_COMPILER_MSVC) && !defined(IREE_COMPILER_CLANG)
 #define IREE_DISPATCH_MODE_SWITCH 1
 #else
@@ -221,22 +300,22 @@ static inline const iree_vm_register_remap_list_t* VM_DecBranchOperandsImpl(
   *pc = *pc + kRegSize + list->size * 2 * kRegSize;
   return list;
 }
-#define VM_DecOperandRegI32(name)      \
-  regs.i32[OP_I16(0) & regs.i32_mask]; \
+#define VM_DecOperandRegI32(name)          \
+  regs.i32[VM_RegI32(regs, OP_I16(0))]; \
   pc += kRegSize;
-#define VM_DecOperandRegI64(name)                           \
-  *((int64_t*)&regs.i32[OP_I16(0) & (regs.i32_mask & ~1)]); \
+#define VM_DecOperandRegI64(name)                        \
+  *((int64_t*)&regs.i32[VM_RegI64(regs, OP_I16(0))]); \
   pc += kRegSize;
 #define VM_DecOperandRegI64HostSize(name) \
   (iree_host_size_t) VM_DecOperandRegI64(name)
-#define VM_DecOperandRegF32(name)                  \
-  *((float*)&regs.i32[OP_I16(0) & regs.i32_mask]); \
+#define VM_DecOperandRegF32(name)                      \
+  *((float*)&regs.i32[VM_RegI32(regs, OP_I16(0))]); \
   pc += kRegSize;
-#define VM_DecOperandRegF64(name)                          \
-  *((double*)&regs.i32[OP_I16(0) & (regs.i32_mask & ~1)]); \
+#define VM_DecOperandRegF64(name)                       \
+  *((double*)&regs.i32[VM_RegI64(regs, OP_I16(0))]); \
   pc += kRegSize;
 #define VM_DecOperandRegRef(name, out_is_move)                      \
-  &regs.ref[OP_I16(0) & regs.ref_mask];                             \
+  &regs.ref[VM_RegRef(regs, OP_I16(0))];                            \
   *(out_is_move) = 0; /*= OP_I16(0) & IREE_REF_REGISTER_MOVE_BIT;*/ \
   pc += kRegSize;
 #define VM_DecVariadicOperands(name) \
@@ -249,20 +328,20 @@ static inline const iree_vm_register_list_t* VM_DecVariadicOperandsImpl(
   *pc = *pc + kRegSize + list->size * kRegSize;
   return list;
 }
-#define VM_DecResultRegI32(name)        \
-  &regs.i32[OP_I16(0) & regs.i32_mask]; \
+#define VM_DecResultRegI32(name)            \
+  &regs.i32[VM_RegI32(regs, OP_I16(0))]; \
   pc += kRegSize;
-#define VM_DecResultRegI64(name)                           \
-  ((int64_t*)&regs.i32[OP_I16(0) & (regs.i32_mask & ~1)]); \
+#define VM_DecResultRegI64(name)                        \
+  ((int64_t*)&regs.i32[VM_RegI64(regs, OP_I16(0))]); \
   pc += kRegSize;
-#define VM_DecResultRegF32(name)                  \
-  ((float*)&regs.i32[OP_I16(0) & regs.i32_mask]); \
+#define VM_DecResultRegF32(name)                      \
+  ((float*)&regs.i32[VM_RegI32(regs, OP_I16(0))]); \
   pc += kRegSize;
-#define VM_DecResultRegF64(name)                          \
-  ((double*)&regs.i32[OP_I16(0) & (regs.i32_mask & ~1)]); \
+#define VM_DecResultRegF64(name)                       \
+  ((double*)&regs.i32[VM_RegI64(regs, OP_I16(0))]); \
   pc += kRegSize;
 #define VM_DecResultRegRef(name, out_is_move)                       \
-  &regs.ref[OP_I16(0) & regs.ref_mask];                             \
+  &regs.ref[VM_RegRef(regs, OP_I16(0))];                            \
   *(out_is_move) = 0; /*= OP_I16(0) & IREE_REF_REGISTER_MOVE_BIT;*/ \
   pc += kRegSize;
 #define VM_DecVariadicResults(name) VM_DecVariadicOperands(name)
@@ -343,10 +422,11 @@ static inline const iree_vm_register_list_t* VM_DecVariadicOperandsImpl(
                             "unhandled dispatch extension " #ext); \
   }
 
-#define DISPATCH_OP(ext, op_name, body)                          \
-  _dispatch_##ext##_##op_name:;                                  \
-  IREE_DISPATCH_TRACE_INSTRUCTION(VM_PC_OFFSET_##ext, #op_name); \
-  body;                                                          \
+#define DISPATCH_OP(ext, op_name, body)                                \
+  _dispatch_##ext##_##op_name:;                                        \
+  IREE_DISPATCH_TRACE_INSTRUCTION(VM_PC_OFFSET_##ext, #op_name);       \
+  IREE_DISPATCH_PROFILE_INSTRUCTION(VM_PC_OFFSET_##ext, ext, op_name); \
+  body;                                                                \
   goto* kDispatchTable_CORE[bytecode_data[pc++]];
 
 #define BEGIN_DISPATCH_PREFIX(op_name, ext)                                   \
@@ -379,10 +459,11 @@ static inline const iree_vm_register_list_t* VM_DecVariadicOperandsImpl(
                             "unhandled dispatch extension " #ext); \
   }
 
-#define DISPATCH_OP(ext, op_name, body)                            \
-  case IREE_VM_OP_##ext##_##op_name: {                             \
-    IREE_DISPATCH_TRACE_INSTRUCTION(VM_PC_OFFSET_##ext, #op_name); \
-    body;                                                          \
+#define DISPATCH_OP(ext, op_name, body)                                  \
+  case IREE_VM_OP_##ext##_##op_name: {                                   \
+    IREE_DISPATCH_TRACE_INSTRUCTION(VM_PC_OFFSET_##ext, #op_name);       \
+    IREE_DISPATCH_PROFILE_INSTRUCTION(VM_PC_OFFSET_##ext, ext, op_name); \
+    body;                                                                \
   } break;
 
 #define BEGIN_DISPATCH_PREFIX(op_name, ext) \
@@ -0,0 +1,244 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Tests covering forking of contexts containing bytecode modules.
+//
+// iree/vm/test/fork_ops.mlir contains the functions used here for testing.
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "iree/base/status_cc.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+#include "iree/vm/bytecode_module.h"
+#include "iree/vm/ref_cc.h"
+
+// Compiled module embedded here to avoid file IO:
+#include "iree/vm/test/fork_bytecode_modules.h"
+
+namespace iree {
+namespace {
+
+using iree::testing::status::StatusIs;
+
+class VMBytecodeForkTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    IREE_CHECK_OK(iree_vm_register_builtin_types());
+  }
+
+  void SetUp() override {
+    IREE_TRACE_SCOPE();
+    const iree_file_toc_t* file = fork_bytecode_modules_c_create();
+
+    IREE_CHECK_OK(iree_vm_instance_create(iree_allocator_system(), &instance_));
+
+    IREE_CHECK_OK(iree_vm_bytecode_module_create(
+        iree_const_byte_span_t{reinterpret_cast<const uint8_t*>(file->data),
+                               file->size},
+        iree_allocator_null(), iree_allocator_system(), &bytecode_module_));
+
+    std::vector<iree_vm_module_t*> modules = {bytecode_module_};
+    IREE_CHECK_OK(iree_vm_context_create_with_modules(
+        instance_, IREE_VM_CONTEXT_FLAG_NONE, modules.size(), modules.data(),
+        iree_allocator_system(), &context_));
+  }
+
+  void TearDown() override {
+    IREE_TRACE_SCOPE();
+    iree_vm_module_release(bytecode_module_);
+    iree_vm_context_release(context_);
+    iree_vm_instance_release(instance_);
+  }
+
+  // Invokes fork_ops.|function_name| in |context| and returns its results.
+  static StatusOr<vm::ref<iree_vm_list_t>> Invoke(
+      iree_vm_context_t* context, const char* function_name) {
+    std::string full_name = std::string("fork_ops.") + function_name;
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(iree_vm_context_resolve_function(
+        context, iree_make_string_view(full_name.data(), full_name.size()),
+        &function));
+    vm::ref<iree_vm_list_t> outputs;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(
+        /*element_type=*/nullptr, 1, iree_allocator_system(), &outputs));
+    IREE_RETURN_IF_ERROR(iree_vm_invoke(
+        context, function, IREE_VM_INVOCATION_FLAG_NONE, /*policy=*/nullptr,
+        /*inputs=*/nullptr, outputs.get(), iree_allocator_system()));
+    return std::move(outputs);
+  }
+
+  // Invokes fork_ops.|function_name| in |context| and returns its i32 result.
+  static StatusOr<int32_t> InvokeI32(iree_vm_context_t* context,
+                                     const char* function_name) {
+    IREE_ASSIGN_OR_RETURN(auto outputs, Invoke(context, function_name));
+    iree_vm_value_t value;
+    IREE_RETURN_IF_ERROR(iree_vm_list_get_value(outputs.get(), 0, &value));
+    return value.i32;
+  }
+
+  // Invokes fork_ops.get_shared in |context| and returns the buffer pointer.
+  static StatusOr<void*> GetShared(iree_vm_context_t* context) {
+    IREE_ASSIGN_OR_RETURN(auto outputs, Invoke(context, "get_shared"));
+    iree_vm_ref_t ref = {0};
+    IREE_RETURN_IF_ERROR(iree_vm_list_get_ref_assign(outputs.get(), 0, &ref));
+    return ref.ptr;
+  }
+
+  iree_vm_instance_t* instance_ = nullptr;
+  iree_vm_context_t* context_ = nullptr;
+  iree_vm_module_t* bytecode_module_ = nullptr;
+};
+
+// Primitive globals are copied into the fork and stores are isolated.
+TEST_F(VMBytecodeForkTest, CopiesPrimitiveGlobals) {
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v0, InvokeI32(context_, "increment"));
+  EXPECT_EQ(v0, 1);
+
+  iree_vm_context_t* forked_context = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_context_fork(context_, iree_allocator_system(), &forked_context));
+
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v1, InvokeI32(forked_context, "increment"));
+  EXPECT_EQ(v1, 2);
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v2, InvokeI32(forked_context, "increment"));
+  EXPECT_EQ(v2, 3);
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v3, InvokeI32(context_, "increment"));
+  EXPECT_EQ(v3, 2);
+
+  iree_vm_context_release(forked_context);
+}
+
+// Ref globals only assigned by the initializer are shared with the parent and
+// the initializer is not run again.
+TEST_F(VMBytecodeForkTest, SharesInitializedRefGlobals) {
+  IREE_ASSERT_OK_AND_ASSIGN(void* parent_shared, GetShared(context_));
+  ASSERT_NE(parent_shared, nullptr);
+
+  iree_vm_context_t* forked_context = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_context_fork(context_, iree_allocator_system(), &forked_context));
+  IREE_ASSERT_OK_AND_ASSIGN(void* forked_shared, GetShared(forked_context));
+  EXPECT_EQ(parent_shared, forked_shared);
+
+  iree_vm_context_release(forked_context);
+}
+
+// Forks retain their parent such that shared ref globals remain valid after
+// the caller releases the parent.
+TEST_F(VMBytecodeForkTest, ForkOutlivesParent) {
+  IREE_ASSERT_OK_AND_ASSIGN(void* parent_shared, GetShared(context_));
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v0, InvokeI32(context_, "increment"));
+  EXPECT_EQ(v0, 1);
+
+  iree_vm_context_t* forked_context = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_context_fork(context_, iree_allocator_system(), &forked_context));
+  iree_vm_context_release(context_);
+  context_ = nullptr;
+
+  IREE_ASSERT_OK_AND_ASSIGN(void* forked_shared, GetShared(forked_context));
+  EXPECT_EQ(parent_shared, forked_shared);
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v1, InvokeI32(forked_context, "increment"));
+  EXPECT_EQ(v1, 2);
+
+  iree_vm_context_release(forked_context);
+}
+
+// Buffers stored in mutable ref globals are cloned such that in-place updates
+// in the fork are not visible to the parent and vice versa.
+TEST_F(VMBytecodeForkTest, ClonesMutableBufferGlobals) {
+  IREE_ASSERT_OK(Invoke(context_, "alloc_scratch").status());
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v0,
+                            InvokeI32(context_, "increment_scratch"));
+  EXPECT_EQ(v0, 1);
+
+  iree_vm_context_t* forked_context = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_context_fork(context_, iree_allocator_system(), &forked_context));
+
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v1,
+                            InvokeI32(forked_context, "increment_scratch"));
+  EXPECT_EQ(v1, 2);
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v2,
+                            InvokeI32(forked_context, "increment_scratch"));
+  EXPECT_EQ(v2, 3);
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v3,
+                            InvokeI32(context_, "increment_scratch"));
+  EXPECT_EQ(v3, 2);
+
+  iree_vm_context_release(forked_context);
+}
+
+// Objects that cannot be cloned in mutable ref globals fail the fork instead
+// of being aliased by the parent and the fork.
+TEST_F(VMBytecodeForkTest, RejectsUncloneableMutableGlobals) {
+  iree_vm_context_t* forked_context = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_context_fork(context_, iree_allocator_system(), &forked_context));
+  iree_vm_context_release(forked_context);
+
+  IREE_ASSERT_OK(Invoke(context_, "alloc_list").status());
+  forked_context = nullptr;
+  EXPECT_THAT(Status(iree_vm_context_fork(context_, iree_allocator_system(),
+                                          &forked_context)),
+              StatusIs(StatusCode::kFailedPrecondition));
+  EXPECT_EQ(forked_context, nullptr);
+}
+
+// Forks are invoked concurrently from multiple threads without observing each
+// other's state.
+TEST_F(VMBytecodeForkTest, ConcurrentForks) {
+  IREE_ASSERT_OK(Invoke(context_, "alloc_scratch").status());
+
+  static const int kThreadCount = 8;
+  static const int kIterationCount = 100;
+  std::vector<iree_vm_context_t*> forked_contexts(kThreadCount, nullptr);
+  for (auto& forked_context : forked_contexts) {
+    IREE_ASSERT_OK(iree_vm_context_fork(context_, iree_allocator_system(),
+                                        &forked_context));
+  }
+
+  std::vector<Status> statuses(kThreadCount);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([&, i]() {
+      for (int j = 1; j <= kIterationCount; ++j) {
+        auto counter = InvokeI32(forked_contexts[i], "increment");
+        auto scratch = InvokeI32(forked_contexts[i], "increment_scratch");
+        if (!counter.ok()) {
+          statuses[i] = std::move(counter).status();
+          return;
+        } else if (!scratch.ok()) {
+          statuses[i] = std::move(scratch).status();
+          return;
+        } else if (counter.value() != j || scratch.value() != j) {
+          statuses[i] = Status(StatusCode::kDataLoss, "state shared by forks");
+          return;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  for (int i = 0; i < kThreadCount; ++i) {
+    IREE_EXPECT_OK(statuses[i]);
+    iree_vm_context_release(forked_contexts[i]);
+  }
+
+  // The parent state is unchanged.
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v0, InvokeI32(context_, "increment"));
+  EXPECT_EQ(v0, 1);
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v1,
+                            InvokeI32(context_, "increment_scratch"));
+  EXPECT_EQ(v1, 1);
+}
+
+}  // namespace
+}  // namespace iree
@@ -14,6 +14,7 @@
 #include "iree/base/tracing.h"
 #include "iree/vm/api.h"
 #include "iree/vm/bytecode_module_impl.h"
+#include "iree/vm/bytecode_verifier.h"
 
 // Alignment applied to each segment of the archive.
 // All embedded file contents (FlatBuffers, rodata, etc) are aligned to this
@@ -278,6 +279,25 @@ static iree_status_t iree_vm_bytecode_module_flatbuffer_verify(
     }
   }
 
+  iree_vm_ModuleStateDef_table_t module_state_def =
+      iree_vm_BytecodeModuleDef_module_state(module_def);
+  if (module_state_def) {
+    int32_t global_ref_count =
+        iree_vm_ModuleStateDef_global_ref_count(module_state_def);
+    flatbuffers_int32_vec_t mutable_global_refs =
+        iree_vm_ModuleStateDef_mutable_global_refs(module_state_def);
+    for (size_t i = 0; i < flatbuffers_int32_vec_len(mutable_global_refs);
+         ++i) {
+      int32_t ordinal = flatbuffers_int32_vec_at(mutable_global_refs, i);
+      if (ordinal < 0 || ordinal >= global_ref_count) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "mutable_global_refs[%zu] ordinal %d out of "
+                                "range (global_ref_count=%d)",
+                                i, ordinal, global_ref_count);
+      }
+    }
+  }
+
   iree_vm_RodataSegmentDef_vec_t rodata_segments =
       iree_vm_BytecodeModuleDef_rodata_segments(module_def);
   for (size_t i = 0; i < iree_vm_RodataSegmentDef_vec_len(rodata_segments);
@@ -371,6 +391,7 @@ static iree_status_t iree_vm_bytecode_module_flatbuffer_verify(
     iree_vm_FunctionDescriptor_struct_t function_descriptor =
         iree_vm_FunctionDescriptor_vec_at(function_descriptors, i);
     if (function_descriptor->bytecode_offset < 0 ||
+        function_descriptor->bytecode_length < 0 ||
         function_descriptor->bytecode_offset +
                 function_descriptor->bytecode_length >
             flatbuffers_uint8_vec_len(bytecode_data)) {
@@ -386,8 +407,6 @@ static iree_status_t iree_vm_bytecode_module_flatbuffer_verify(
           IREE_STATUS_INVALID_ARGUMENT,
           "functions[%zu] descriptor register count out of range", i);
     }
-
-    // TODO(benvanik): run bytecode verifier on contents.
   }
 
   return iree_ok_status();
@@ -935,6 +954,92 @@ static iree_status_t iree_vm_bytecode_module_alloc_state(
   return iree_ok_status();
 }
 
+static void iree_vm_bytecode_module_free_state(
+    void* self, iree_vm_module_state_t* module_state);
+
+// Clones the value of the mutable ref global |ordinal| from |parent_ref| into
+// |out_ref| so that the parent and child do not alias mutable objects.
+static iree_status_t iree_vm_bytecode_module_fork_mutable_global_ref(
+    int32_t ordinal, iree_vm_ref_t* parent_ref, iree_allocator_t allocator,
+    iree_vm_ref_t* out_ref) {
+  if (!parent_ref->ptr) return iree_ok_status();
+  if (parent_ref->type == iree_vm_buffer_type_id()) {
+    iree_vm_buffer_t* parent_buffer = (iree_vm_buffer_t*)parent_ref->ptr;
+    if (!iree_all_bits_set(parent_buffer->access,
+                           IREE_VM_BUFFER_ACCESS_MUTABLE)) {
+      // Read-only buffers cannot be modified and are safe to share.
+      iree_vm_ref_retain(parent_ref, out_ref);
+      return iree_ok_status();
+    }
+    iree_vm_buffer_t* buffer = NULL;
+    IREE_RETURN_IF_ERROR(iree_vm_buffer_clone(
+        IREE_VM_BUFFER_ACCESS_MUTABLE | IREE_VM_BUFFER_ACCESS_ORIGIN_GUEST,
+        parent_buffer, 0, iree_vm_buffer_length(parent_buffer), allocator,
+        &buffer));
+    *out_ref = iree_vm_buffer_move_ref(buffer);
+    return iree_ok_status();
+  }
+  iree_string_view_t type_name = iree_vm_ref_type_name(parent_ref->type);
+  return iree_make_status(
+      IREE_STATUS_FAILED_PRECONDITION,
+      "mutable ref global %d holds a '%.*s' that cannot be cloned; contexts "
+      "storing mutable objects in globals cannot be forked",
+      ordinal, (int)type_name.size, type_name.data);
+}
+
+static iree_status_t iree_vm_bytecode_module_fork_state(
+    void* self, iree_vm_module_state_t* parent_module_state,
+    iree_allocator_t allocator, iree_vm_module_state_t** out_module_state) {
+  IREE_ASSERT_ARGUMENT(parent_module_state);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_vm_bytecode_module_t* module = (iree_vm_bytecode_module_t*)self;
+
+  // Allocate the state with the same layout as the parent. Rodata references
+  // point at the module FlatBuffer and are already shared.
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_bytecode_module_alloc_state(self, allocator,
+                                              out_module_state));
+  iree_vm_bytecode_module_state_t* parent_state =
+      (iree_vm_bytecode_module_state_t*)parent_module_state;
+  iree_vm_bytecode_module_state_t* state =
+      (iree_vm_bytecode_module_state_t*)*out_module_state;
+
+  // Primitive globals are copied so that stores in the child are isolated.
+  memcpy(state->rwdata_storage.data, parent_state->rwdata_storage.data,
+         state->rwdata_storage.data_length);
+
+  // Ref globals only assigned by initializers are retained so that the
+  // referenced objects (buffers holding weights, executables, etc) are shared.
+  // Mutable ref globals are cloned as the objects they reference may be
+  // modified in-place by either the parent or the child.
+  iree_vm_ModuleStateDef_table_t module_state_def =
+      iree_vm_BytecodeModuleDef_module_state(module->def);
+  flatbuffers_int32_vec_t mutable_global_refs =
+      module_state_def
+          ? iree_vm_ModuleStateDef_mutable_global_refs(module_state_def)
+          : NULL;
+  for (iree_host_size_t i = 0; i < state->global_ref_count; ++i) {
+    iree_vm_ref_retain(&parent_state->global_ref_table[i],
+                       &state->global_ref_table[i]);
+  }
+  iree_status_t status = iree_ok_status();
+  for (size_t i = 0; i < flatbuffers_int32_vec_len(mutable_global_refs); ++i) {
+    int32_t ordinal = flatbuffers_int32_vec_at(mutable_global_refs, i);
+    iree_vm_ref_release(&state->global_ref_table[ordinal]);
+    status = iree_vm_bytecode_module_fork_mutable_global_ref(
+        ordinal, &parent_state->global_ref_table[ordinal], allocator,
+        &state->global_ref_table[ordinal]);
+    if (!iree_status_is_ok(status)) break;
+  }
+
+  if (!iree_status_is_ok(status)) {
+    iree_vm_bytecode_module_free_state(self, *out_module_state);
+    *out_module_state = NULL;
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static void iree_vm_bytecode_module_free_state(
     void* self, iree_vm_module_state_t* module_state) {
   if (!module_state) return;
@@ -1073,6 +1178,44 @@ static iree_status_t iree_vm_bytecode_module_resume_call(
                                           out_result);  // tail
 }
 
+#if !IREE_VM_BYTECODE_VERIFICATION_ENABLE
+// Conservatively sizes the import results storage of every function in
+// |module_def| to hold the results of any imported function. When verifying
+// the sizes are instead computed per function from the calls it makes.
+static iree_status_t iree_vm_bytecode_module_compute_import_result_sizes(
+    iree_vm_BytecodeModuleDef_table_t module_def,
+    iree_host_size_t function_count, uint32_t* out_import_result_sizes) {
+  iree_host_size_t max_result_size = 0;
+  iree_vm_ImportFunctionDef_vec_t imported_functions =
+      iree_vm_BytecodeModuleDef_imported_functions(module_def);
+  for (size_t i = 0; i < iree_vm_ImportFunctionDef_vec_len(imported_functions);
+       ++i) {
+    iree_vm_FunctionSignatureDef_table_t signature_def =
+        iree_vm_ImportFunctionDef_signature(
+            iree_vm_ImportFunctionDef_vec_at(imported_functions, i));
+    if (!signature_def) continue;
+    flatbuffers_string_t calling_convention =
+        iree_vm_FunctionSignatureDef_calling_convention(signature_def);
+    iree_vm_function_signature_t signature = {
+        .calling_convention = iree_make_string_view(
+            calling_convention, flatbuffers_string_len(calling_convention)),
+    };
+    iree_string_view_t arguments = iree_string_view_empty();
+    iree_string_view_t results = iree_string_view_empty();
+    IREE_RETURN_IF_ERROR(iree_vm_function_call_get_cconv_fragments(
+        &signature, &arguments, &results));
+    iree_host_size_t result_size = 0;
+    IREE_RETURN_IF_ERROR(iree_vm_function_call_compute_cconv_fragment_size(
+        results, /*segment_size_list=*/NULL, &result_size));
+    max_result_size = iree_max(max_result_size, result_size);
+  }
+  for (iree_host_size_t i = 0; i < function_count; ++i) {
+    out_import_result_sizes[i] = (uint32_t)max_result_size;
+  }
+  return iree_ok_status();
+}
+#endif  // !IREE_VM_BYTECODE_VERIFICATION_ENABLE
+
 IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
     iree_const_byte_span_t archive_contents, iree_allocator_t archive_allocator,
     iree_allocator_t allocator, iree_vm_module_t** out_module) {
@@ -1110,18 +1253,40 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
   iree_vm_TypeDef_vec_t type_defs = iree_vm_BytecodeModuleDef_types(module_def);
   size_t type_table_size =
       iree_vm_TypeDef_vec_len(type_defs) * sizeof(iree_vm_type_def_t);
+  iree_vm_FunctionDescriptor_vec_t function_descriptors =
+      iree_vm_BytecodeModuleDef_function_descriptors(module_def);
+  iree_host_size_t function_count =
+      iree_vm_FunctionDescriptor_vec_len(function_descriptors);
 
   iree_vm_bytecode_module_t* module = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_allocator_malloc(allocator, sizeof(*module) + type_table_size,
+      z0, iree_allocator_malloc(allocator,
+                                sizeof(*module) + type_table_size +
+                                    function_count * sizeof(uint32_t),
                                 (void**)&module));
   module->allocator = allocator;
 
-  iree_vm_FunctionDescriptor_vec_t function_descriptors =
-      iree_vm_BytecodeModuleDef_function_descriptors(module_def);
-  module->function_descriptor_count =
-      iree_vm_FunctionDescriptor_vec_len(function_descriptors);
+  module->function_descriptor_count = function_count;
   module->function_descriptor_table = function_descriptors;
+  uint32_t* function_import_result_sizes =
+      (uint32_t*)((uint8_t*)module->type_table + type_table_size);
+  module->function_import_result_sizes = function_import_result_sizes;
+
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE
+  // Verify all function bytecode so that the interpreter can skip checking
+  // each operation as it executes.
+  iree_status_t verify_status = iree_vm_bytecode_module_verify_bytecode(
+      module_def, function_import_result_sizes, allocator);
+#else
+  iree_status_t verify_status =
+      iree_vm_bytecode_module_compute_import_result_sizes(
+          module_def, function_count, function_import_result_sizes);
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE
+  if (!iree_status_is_ok(verify_status)) {
+    iree_allocator_free(allocator, module);
+    IREE_TRACE_ZONE_END(z0);
+    return verify_status;
+  }
 
   flatbuffers_uint8_vec_t bytecode_data =
       iree_vm_BytecodeModuleDef_bytecode_data(module_def);
@@ -1154,6 +1319,7 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
 #endif  // IREE_VM_BACKTRACE_ENABLE
   module->interface.alloc_state = iree_vm_bytecode_module_alloc_state;
   module->interface.free_state = iree_vm_bytecode_module_free_state;
+  module->interface.fork_state = iree_vm_bytecode_module_fork_state;
   module->interface.resolve_import = iree_vm_bytecode_module_resolve_import;
   module->interface.notify = iree_vm_bytecode_module_notify;
   module->interface.begin_call = iree_vm_bytecode_module_begin_call;
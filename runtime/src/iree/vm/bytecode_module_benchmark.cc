@@ -5,6 +5,7 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 #include <array>
+#include <utility>
 #include <vector>
 
 #include "benchmark/benchmark.h"
@@ -12,6 +13,7 @@
 #include "iree/vm/api.h"
 #include "iree/vm/bytecode_module.h"
 #include "iree/vm/bytecode_module_benchmark_module_c.h"
+#include "iree/vm/bytecode_module_benchmark_unfused_module_c.h"
 
 namespace {
 
@@ -33,6 +35,29 @@ static iree_status_t native_import_module_add_1(
   return iree_ok_status();
 }
 
+// Benchmarks the given exported function, optionally passing in arguments.
+static iree_status_t RunFunction(benchmark::State& state,
+                                 iree_string_view_t function_name,
+                                 std::vector<int32_t> i32_args,
+                                 int result_count, int64_t batch_size = 1) {
+  return RunFunctionInModule(
+      state, iree_vm_bytecode_module_benchmark_module_create(), function_name,
+      std::move(i32_args), result_count, batch_size);
+}
+
+// Benchmarks the given exported function in a module compiled without
+// superinstructions. Comparing against RunFunction shows the dispatch overhead
+// saved by fusing instructions.
+static iree_status_t RunUnfusedFunction(benchmark::State& state,
+                                        iree_string_view_t function_name,
+                                        std::vector<int32_t> i32_args,
+                                        int result_count,
+                                        int64_t batch_size = 1) {
+  return RunFunctionInModule(
+      state, iree_vm_bytecode_module_benchmark_unfused_module_create(),
+      function_name, std::move(i32_args), result_count, batch_size);
+}
+
 static const iree_vm_native_export_descriptor_t
     native_import_module_exports_[] = {
         {iree_make_cstring_view("add_1"), iree_make_cstring_view("0i_i"), 0,
@@ -65,11 +90,14 @@ static iree_status_t native_import_module_create(
       &interface, &native_import_module_descriptor_, allocator, out_module);
 }
 
-// Benchmarks the given exported function, optionally passing in arguments.
-static iree_status_t RunFunction(benchmark::State& state,
-                                 iree_string_view_t function_name,
-                                 std::vector<int32_t> i32_args,
-                                 int result_count, int64_t batch_size = 1) {
+// Benchmarks the given exported function in the module defined by
+// |module_file_toc|, optionally passing in arguments.
+static iree_status_t RunFunctionInModule(benchmark::State& state,
+                                         const iree_file_toc_t* module_file_toc,
+                                         iree_string_view_t function_name,
+                                         std::vector<int32_t> i32_args,
+                                         int result_count,
+                                         int64_t batch_size = 1) {
   iree_vm_instance_t* instance = NULL;
   IREE_CHECK_OK(iree_vm_instance_create(iree_allocator_system(), &instance));
 
@@ -77,8 +105,6 @@ static iree_status_t RunFunction(benchmark::State& state,
   IREE_CHECK_OK(
       native_import_module_create(iree_allocator_system(), &import_module));
 
-  const auto* module_file_toc =
-      iree_vm_bytecode_module_benchmark_module_create();
   iree_vm_module_t* bytecode_module = nullptr;
   IREE_CHECK_OK(iree_vm_bytecode_module_create(
       iree_const_byte_span_t{
@@ -298,6 +324,55 @@ static void BM_LoopSumBytecode(benchmark::State& state) {
 }
 BENCHMARK(BM_LoopSumBytecode)->Arg(100000);
 
+static void BM_LoopSumBytecodeUnfused(benchmark::State& state) {
+  IREE_CHECK_OK(RunUnfusedFunction(
+      state, iree_make_cstring_view("bytecode_module_benchmark.loop_sum"),
+      {static_cast<int32_t>(state.range(0))},
+      /*result_count=*/1,
+      /*batch_size=*/state.range(0)));
+}
+BENCHMARK(BM_LoopSumBytecodeUnfused)->Arg(100000);
+
+static void BM_ShapeCalcReference(benchmark::State& state) {
+  static auto work = +[](int i) {
+    int dim = i % 7;
+    benchmark::DoNotOptimize(dim);
+    if (dim == 0) return 1;
+    return dim < 4 ? dim : 4;
+  };
+  static auto loop = +[](int count) {
+    int sum = 0;
+    for (int i = 0; i < count; ++i) {
+      benchmark::DoNotOptimize(sum += work(i));
+    }
+    return sum;
+  };
+  while (state.KeepRunningBatch(state.range(0))) {
+    int ret = loop(static_cast<int>(state.range(0)));
+    benchmark::DoNotOptimize(ret);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_ShapeCalcReference)->Arg(100000);
+
+static void BM_ShapeCalcBytecode(benchmark::State& state) {
+  IREE_CHECK_OK(RunFunction(
+      state, iree_make_cstring_view("bytecode_module_benchmark.shape_calc"),
+      {static_cast<int32_t>(state.range(0))},
+      /*result_count=*/1,
+      /*batch_size=*/state.range(0)));
+}
+BENCHMARK(BM_ShapeCalcBytecode)->Arg(100000);
+
+static void BM_ShapeCalcBytecodeUnfused(benchmark::State& state) {
+  IREE_CHECK_OK(RunUnfusedFunction(
+      state, iree_make_cstring_view("bytecode_module_benchmark.shape_calc"),
+      {static_cast<int32_t>(state.range(0))},
+      /*result_count=*/1,
+      /*batch_size=*/state.range(0)));
+}
+BENCHMARK(BM_ShapeCalcBytecodeUnfused)->Arg(100000);
+
 static void BM_BufferReduceReference(benchmark::State& state) {
   static auto work = +[](int32_t* buffer, int i, int sum) {
     int new_sum = buffer[i] + sum;
@@ -77,6 +77,32 @@ vm.module @bytecode_module_benchmark {
     vm.return %ie : i32
   }
 
+  // Measures the cost of branch-heavy scalar code like that found in host-side
+  // shape calculations: each iteration normalizes a dimension by replacing
+  // zeros with 1 and clamping to a maximum before accumulating.
+  vm.export @shape_calc
+  vm.func @shape_calc(%count : i32) -> i32 {
+    %c0 = vm.const.i32.zero
+    %c1 = vm.const.i32 1
+    %c7 = vm.const.i32 7
+    %c4 = vm.const.i32 4
+    vm.br ^loop(%c0, %c0 : i32, i32)
+  ^loop(%i : i32, %sum : i32):
+    %dim = vm.rem.i32.u %i, %c7 : i32
+    %is_zero = vm.cmp.eq.i32 %dim, %c0 : i32
+    vm.cond_br %is_zero, ^accumulate(%c1 : i32), ^check_max
+  ^check_max:
+    %is_small = vm.cmp.lt.i32.u %dim, %c4 : i32
+    vm.cond_br %is_small, ^accumulate(%dim : i32), ^accumulate(%c4 : i32)
+  ^accumulate(%norm_dim : i32):
+    %new_sum = vm.add.i32 %sum, %norm_dim : i32
+    %in = vm.add.i32 %i, %c1 : i32
+    %cmp = vm.cmp.lt.i32.s %in, %count : i32
+    vm.cond_br %cmp, ^loop(%in, %new_sum : i32, i32), ^loop_exit(%new_sum : i32)
+  ^loop_exit(%result : i32):
+    vm.return %result : i32
+  }
+
   // Measures the cost of lots of buffer loads.
   vm.export @buffer_reduce
   vm.func @buffer_reduce(%count : i32) -> i32 {
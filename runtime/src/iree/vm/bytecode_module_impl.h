@@ -39,7 +39,7 @@ extern "C" {
 // Higher versions are disallowed as they occur when new ops are added that
 // otherwise cannot be executed by older runtimes.
 // Matches BytecodeEncoder::kVersionMinor in the compiler.
-#define IREE_VM_BYTECODE_VERSION_MINOR 0
+#define IREE_VM_BYTECODE_VERSION_MINOR 1
 
 // Maximum register count per bank.
 // This determines the bits required to reference registers in the VM bytecode.
@@ -83,6 +83,11 @@ typedef struct iree_vm_bytecode_module_t {
   // Loaded FlatBuffer module pointing into the archive contents.
   iree_vm_BytecodeModuleDef_table_t def;
 
+  // Table mapped 1:1 with internal functions of the largest size in bytes of
+  // the results of any import each function calls. Stack frames of a function
+  // reserve this much storage to receive the results of imports that yield.
+  const uint32_t* function_import_result_sizes;
+
   // Type table mapping module type IDs to registered VM types.
   iree_host_size_t type_count;
   iree_vm_type_def_t type_table[];
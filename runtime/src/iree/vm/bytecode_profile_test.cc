@@ -0,0 +1,126 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Tests covering execution profiling of bytecode modules. Requires building
+// with -DIREE_VM_EXECUTION_PROFILING_ENABLE=1 and is skipped otherwise.
+//
+// iree/vm/test/fork_ops.mlir contains the functions used here for testing.
+
+#include <cstring>
+#include <vector>
+
+#include "iree/base/status_cc.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+#include "iree/vm/bytecode_module.h"
+#include "iree/vm/ref_cc.h"
+
+// Compiled module embedded here to avoid file IO:
+#include "iree/vm/test/fork_bytecode_modules.h"
+
+namespace iree {
+namespace {
+
+class VMBytecodeProfileTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    IREE_CHECK_OK(iree_vm_register_builtin_types());
+  }
+
+  void SetUp() override {
+    const iree_file_toc_t* file = fork_bytecode_modules_c_create();
+
+    IREE_CHECK_OK(iree_vm_instance_create(iree_allocator_system(), &instance_));
+
+    IREE_CHECK_OK(iree_vm_bytecode_module_create(
+        iree_const_byte_span_t{reinterpret_cast<const uint8_t*>(file->data),
+                               file->size},
+        iree_allocator_null(), iree_allocator_system(), &bytecode_module_));
+
+    std::vector<iree_vm_module_t*> modules = {bytecode_module_};
+    IREE_CHECK_OK(iree_vm_context_create_with_modules(
+        instance_, IREE_VM_CONTEXT_FLAG_PROFILE_EXECUTION, modules.size(),
+        modules.data(), iree_allocator_system(), &context_));
+  }
+
+  void TearDown() override {
+    iree_vm_module_release(bytecode_module_);
+    iree_vm_context_release(context_);
+    iree_vm_instance_release(instance_);
+  }
+
+  // Invokes fork_ops.increment in |context_|.
+  Status InvokeIncrement() {
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(iree_vm_context_resolve_function(
+        context_, IREE_SV("fork_ops.increment"), &function));
+    vm::ref<iree_vm_list_t> outputs;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(
+        /*element_type=*/nullptr, 1, iree_allocator_system(), &outputs));
+    return iree_vm_invoke(context_, function, IREE_VM_INVOCATION_FLAG_NONE,
+                          /*policy=*/nullptr, /*inputs=*/nullptr,
+                          outputs.get(), iree_allocator_system());
+  }
+
+  iree_vm_instance_t* instance_ = nullptr;
+  iree_vm_context_t* context_ = nullptr;
+  iree_vm_module_t* bytecode_module_ = nullptr;
+};
+
+// Tests that executed instructions are counted per opcode and per function
+// and that core opcodes are counted in the core slots.
+TEST_F(VMBytecodeProfileTest, CountsInstructions) {
+  iree_vm_profile_t* profile = iree_vm_context_profile(context_);
+  if (!profile) {
+    GTEST_SKIP() << "execution profiling not compiled in";
+  }
+  iree_vm_profile_reset(profile);
+
+  for (int i = 0; i < 3; ++i) {
+    IREE_ASSERT_OK(InvokeIncrement());
+  }
+
+  const iree_vm_profile_opcode_t* opcodes = iree_vm_profile_opcodes(profile);
+  uint64_t opcode_instruction_count = 0;
+  iree_host_size_t add_slot = IREE_VM_PROFILE_OPCODE_SLOT_CAPACITY;
+  for (iree_host_size_t i = 0; i < IREE_VM_PROFILE_OPCODE_SLOT_CAPACITY; ++i) {
+    opcode_instruction_count += opcodes[i].count;
+    if (opcodes[i].name && strcmp(opcodes[i].name, "AddI32") == 0) {
+      EXPECT_EQ(add_slot, IREE_VM_PROFILE_OPCODE_SLOT_CAPACITY)
+          << "AddI32 counted in multiple slots";
+      add_slot = i;
+    }
+  }
+  ASSERT_LT(add_slot, IREE_VM_PROFILE_OPCODE_SLOT_CORE + 256);
+  EXPECT_EQ(opcodes[add_slot].count, 3);
+
+  // All instructions were executed in the module and attributed to functions.
+  iree_vm_profile_module_t* profile_module = iree_vm_profile_modules(profile);
+  ASSERT_NE(profile_module, nullptr);
+  EXPECT_EQ(profile_module->module, bytecode_module_);
+  EXPECT_EQ(profile_module->next, nullptr);
+  uint64_t function_instruction_count = 0;
+  for (iree_host_size_t i = 0; i < profile_module->function_count; ++i) {
+    function_instruction_count +=
+        profile_module->functions[i].instruction_count;
+  }
+  EXPECT_GT(function_instruction_count, 0);
+  EXPECT_EQ(function_instruction_count, opcode_instruction_count);
+}
+
+// Tests that contexts created without the profiling flag have no profile.
+TEST_F(VMBytecodeProfileTest, DisabledWithoutFlag) {
+  iree_vm_context_t* context = nullptr;
+  IREE_ASSERT_OK(iree_vm_context_create_with_modules(
+      instance_, IREE_VM_CONTEXT_FLAG_NONE, 1, &bytecode_module_,
+      iree_allocator_system(), &context));
+  EXPECT_EQ(iree_vm_context_profile(context), nullptr);
+  iree_vm_context_release(context);
+}
+
+}  // namespace
+}  // namespace iree
@@ -0,0 +1,1486 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/bytecode_verifier.h"
+
+#include <inttypes.h>
+
+#include "iree/base/config.h"
+#include "iree/base/internal/math.h"
+#include "iree/base/tracing.h"
+#include "iree/vm/bytecode_dispatch_util.h"
+
+//===----------------------------------------------------------------------===//
+// Verifier state
+//===----------------------------------------------------------------------===//
+
+// Register bank expected by an operand.
+typedef enum iree_vm_bytecode_register_type_e {
+  // Any register of any bank (such as call operands with no known signature).
+  IREE_VM_BYTECODE_REGISTER_ANY = 0,
+  // 32-bit register (i32 or f32).
+  IREE_VM_BYTECODE_REGISTER_I32,
+  // 64-bit register pair (i64 or f64) aligned to 2 32-bit registers.
+  IREE_VM_BYTECODE_REGISTER_I64,
+  // Ref register.
+  IREE_VM_BYTECODE_REGISTER_REF,
+} iree_vm_bytecode_register_type_t;
+
+typedef struct iree_vm_bytecode_verifier_t {
+  // Module tables referenced by ordinal from the bytecode.
+  iree_host_size_t type_count;
+  iree_host_size_t global_bytes_capacity;
+  iree_host_size_t global_ref_count;
+  iree_host_size_t rodata_segment_count;
+  iree_host_size_t function_count;
+  iree_vm_ImportFunctionDef_vec_t imported_functions;
+
+  // Calling conventions of each internal function taken from the exports that
+  // reference them. Functions that are not exported have no signature in the
+  // module and are indicated with a NULL string view.
+  iree_string_view_t* function_cconvs;
+
+  // Function currently being verified.
+  iree_host_size_t function_ordinal;
+  const uint8_t* bytecode_data;
+  iree_vm_source_offset_t bytecode_length;
+  uint16_t i32_register_count;
+  uint16_t ref_register_count;
+  // Largest result size in bytes of the imports called by the function.
+  iree_host_size_t import_result_size;
+
+  // Bitmaps with one bit per byte of function bytecode marking the offsets
+  // where instructions begin and the offsets that are targeted by branches.
+  uint32_t* instruction_starts;
+  uint32_t* branch_targets;
+} iree_vm_bytecode_verifier_t;
+
+static inline void iree_vm_bytecode_bitmap_set(uint32_t* bitmap,
+                                               iree_vm_source_offset_t i) {
+  bitmap[i >> 5] |= 1u << (i & 31);
+}
+
+//===----------------------------------------------------------------------===//
+// Operand verification
+//===----------------------------------------------------------------------===//
+
+// Verifies that |length| bytes starting at |pc| are within the function.
+static iree_status_t iree_vm_bytecode_verify_bytes(
+    const iree_vm_bytecode_verifier_t* verifier, iree_vm_source_offset_t pc,
+    iree_host_size_t length) {
+  if (IREE_UNLIKELY(pc + (iree_vm_source_offset_t)length >
+                    verifier->bytecode_length)) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "operand data overruns the function bytecode (%" PRId64 " + %" PRIhsz
+        " > %" PRId64 ")",
+        pc, length, verifier->bytecode_length);
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_vm_bytecode_verify_read_i32(
+    const iree_vm_bytecode_verifier_t* verifier, iree_vm_source_offset_t* pc,
+    uint32_t* out_value) {
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_bytes(verifier, *pc, 4));
+  *out_value =
+      iree_unaligned_load_le((uint32_t*)&verifier->bytecode_data[*pc]);
+  *pc += 4;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_vm_bytecode_verify_register(
+    const iree_vm_bytecode_verifier_t* verifier, uint16_t reg,
+    iree_vm_bytecode_register_type_t type) {
+  if (reg & IREE_REF_REGISTER_TYPE_BIT) {
+    if (IREE_UNLIKELY(type != IREE_VM_BYTECODE_REGISTER_ANY &&
+                      type != IREE_VM_BYTECODE_REGISTER_REF)) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "expected a primitive register but got ref "
+                              "register %u",
+                              reg & IREE_REF_REGISTER_MASK);
+    }
+    if (IREE_UNLIKELY((reg & IREE_REF_REGISTER_MASK) >=
+                      verifier->ref_register_count)) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "ref register %u out of range (count=%u)",
+                              reg & IREE_REF_REGISTER_MASK,
+                              verifier->ref_register_count);
+    }
+    return iree_ok_status();
+  }
+  if (IREE_UNLIKELY(type == IREE_VM_BYTECODE_REGISTER_REF)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "expected a ref register but got primitive "
+                            "register %u",
+                            reg);
+  } else if (type == IREE_VM_BYTECODE_REGISTER_I64) {
+    if (IREE_UNLIKELY(reg & 1)) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "64-bit register %u is not 2-aligned", reg);
+    }
+    if (IREE_UNLIKELY(reg + 1 >= verifier->i32_register_count)) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "64-bit register %u out of range (count=%u)",
+                              reg, verifier->i32_register_count);
+    }
+  } else if (IREE_UNLIKELY(reg >= verifier->i32_register_count)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "register %u out of range (count=%u)", reg,
+                            verifier->i32_register_count);
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_vm_bytecode_verify_register_operand(
+    const iree_vm_bytecode_verifier_t* verifier, iree_vm_source_offset_t* pc,
+    iree_vm_bytecode_register_type_t type) {
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_bytes(verifier, *pc, kRegSize));
+  uint16_t reg =
+      iree_unaligned_load_le((uint16_t*)&verifier->bytecode_data[*pc]);
+  *pc += kRegSize;
+  return iree_vm_bytecode_verify_register(verifier, reg, type);
+}
+
+// Verifies a 2-aligned list of |element_size| 16-bit values prefixed by a
+// 16-bit element count and returns a pointer to the list in the bytecode.
+static iree_status_t iree_vm_bytecode_verify_list(
+    const iree_vm_bytecode_verifier_t* verifier, iree_vm_source_offset_t* pc,
+    iree_host_size_t element_size, const uint16_t** out_list) {
+  VM_AlignPC(*pc, kRegSize);
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_bytes(verifier, *pc, kRegSize));
+  const uint16_t* list = (const uint16_t*)&verifier->bytecode_data[*pc];
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_bytes(
+      verifier, *pc, kRegSize + list[0] * element_size * kRegSize));
+  *pc += kRegSize + list[0] * element_size * kRegSize;
+  *out_list = list;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_vm_bytecode_verify_register_list(
+    const iree_vm_bytecode_verifier_t* verifier, iree_vm_source_offset_t* pc,
+    iree_vm_bytecode_register_type_t type,
+    const iree_vm_register_list_t** out_list) {
+  const uint16_t* list_ptr = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_vm_bytecode_verify_list(verifier, pc, 1, &list_ptr));
+  const iree_vm_register_list_t* list =
+      (const iree_vm_register_list_t*)list_ptr;
+  for (uint16_t i = 0; i < list->size; ++i) {
+    IREE_RETURN_IF_ERROR(
+        iree_vm_bytecode_verify_register(verifier, list->registers[i], type));
+  }
+  if (out_list) *out_list = list;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_vm_bytecode_verify_branch_target(
+    iree_vm_bytecode_verifier_t* verifier, iree_vm_source_offset_t* pc) {
+  uint32_t target_pc = 0;
+  IREE_RETURN_IF_ERROR(
+      iree_vm_bytecode_verify_read_i32(verifier, pc, &target_pc));
+  if (IREE_UNLIKELY((iree_vm_source_offset_t)target_pc >=
+                    verifier->bytecode_length)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "branch target %u out of range (length=%" PRId64
+                            ")",
+                            target_pc, verifier->bytecode_length);
+  }
+  // Checked against instruction boundaries after all instructions are known.
+  iree_vm_bytecode_bitmap_set(verifier->branch_targets, target_pc);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_vm_bytecode_verify_branch_operands(
+    const iree_vm_bytecode_verifier_t* verifier, iree_vm_source_offset_t* pc) {
+  const uint16_t* list_ptr = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_vm_bytecode_verify_list(verifier, pc, 2, &list_ptr));
+  const iree_vm_register_remap_list_t* list =
+      (const iree_vm_register_remap_list_t*)list_ptr;
+  for (uint16_t i = 0; i < list->size; ++i) {
+    // Both sides of a remapping must be in the same bank.
+    uint16_t src_reg = list->pairs[i].src_reg;
+    uint16_t dst_reg = list->pairs[i].dst_reg;
+    iree_vm_bytecode_register_type_t type =
+        (src_reg & IREE_REF_REGISTER_TYPE_BIT) ? IREE_VM_BYTECODE_REGISTER_REF
+                                               : IREE_VM_BYTECODE_REGISTER_I32;
+    IREE_RETURN_IF_ERROR(
+        iree_vm_bytecode_verify_register(verifier, src_reg, type));
+    IREE_RETURN_IF_ERROR(
+        iree_vm_bytecode_verify_register(verifier, dst_reg, type));
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_vm_bytecode_verify_str_attr(
+    const iree_vm_bytecode_verifier_t* verifier, iree_vm_source_offset_t* pc) {
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_bytes(verifier, *pc, 2));
+  uint16_t length =
+      iree_unaligned_load_le((uint16_t*)&verifier->bytecode_data[*pc]);
+  IREE_RETURN_IF_ERROR(
+      iree_vm_bytecode_verify_bytes(verifier, *pc, 2 + length));
+  *pc += 2 + length;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_vm_bytecode_verify_type(
+    const iree_vm_bytecode_verifier_t* verifier, iree_vm_source_offset_t* pc) {
+  uint32_t type_id = 0;
+  IREE_RETURN_IF_ERROR(
+      iree_vm_bytecode_verify_read_i32(verifier, pc, &type_id));
+  if (IREE_UNLIKELY(type_id >= verifier->type_count)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "type id %u out of range (count=%" PRIhsz ")",
+                            type_id, verifier->type_count);
+  }
+  return iree_ok_status();
+}
+
+// Verifies a global byte offset for a value of |byte_width| in rwdata.
+static iree_status_t iree_vm_bytecode_verify_global_attr(
+    const iree_vm_bytecode_verifier_t* verifier, iree_vm_source_offset_t* pc,
+    iree_host_size_t byte_width) {
+  uint32_t byte_offset = 0;
+  IREE_RETURN_IF_ERROR(
+      iree_vm_bytecode_verify_read_i32(verifier, pc, &byte_offset));
+  if (IREE_UNLIKELY((uint64_t)byte_offset + byte_width >
+                    verifier->global_bytes_capacity)) {
+    return iree_make_status(
+        IREE_STATUS_OUT_OF_RANGE,
+        "global byte_offset out of range: %u (rwdata=%" PRIhsz ")",
+        byte_offset, verifier->global_bytes_capacity);
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_vm_bytecode_verify_global_ref_attr(
+    const iree_vm_bytecode_verifier_t* verifier, iree_vm_source_offset_t* pc) {
+  uint32_t global = 0;
+  IREE_RETURN_IF_ERROR(
+      iree_vm_bytecode_verify_read_i32(verifier, pc, &global));
+  if (IREE_UNLIKELY(global >= verifier->global_ref_count)) {
+    return iree_make_status(
+        IREE_STATUS_OUT_OF_RANGE,
+        "global ref ordinal out of range: %u (table=%" PRIhsz ")", global,
+        verifier->global_ref_count);
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_vm_bytecode_verify_rodata_attr(
+    const iree_vm_bytecode_verifier_t* verifier, iree_vm_source_offset_t* pc) {
+  uint32_t rodata_ordinal = 0;
+  IREE_RETURN_IF_ERROR(
+      iree_vm_bytecode_verify_read_i32(verifier, pc, &rodata_ordinal));
+  if (IREE_UNLIKELY(rodata_ordinal >= verifier->rodata_segment_count)) {
+    return iree_make_status(
+        IREE_STATUS_OUT_OF_RANGE,
+        "rodata ref ordinal out of range: %u (table=%" PRIhsz ")",
+        rodata_ordinal, verifier->rodata_segment_count);
+  }
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Calling convention verification
+//===----------------------------------------------------------------------===//
+
+// Verifies the next register in |reg_list| matches the cconv |type|.
+static iree_status_t iree_vm_bytecode_verify_cconv_register(
+    const iree_vm_bytecode_verifier_t* verifier, char type,
+    const iree_vm_register_list_t* reg_list, iree_host_size_t* reg_i) {
+  iree_vm_bytecode_register_type_t register_type;
+  switch (type) {
+    case IREE_VM_CCONV_TYPE_VOID:
+      return iree_ok_status();
+    case IREE_VM_CCONV_TYPE_I32:
+    case IREE_VM_CCONV_TYPE_F32:
+      register_type = IREE_VM_BYTECODE_REGISTER_I32;
+      break;
+    case IREE_VM_CCONV_TYPE_I64:
+    case IREE_VM_CCONV_TYPE_F64:
+      register_type = IREE_VM_BYTECODE_REGISTER_I64;
+      break;
+    case IREE_VM_CCONV_TYPE_REF:
+      register_type = IREE_VM_BYTECODE_REGISTER_REF;
+      break;
+    default:
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "unsupported cconv type '%c'", type);
+  }
+  if (IREE_UNLIKELY(*reg_i >= reg_list->size)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "register list has fewer registers (%u) than "
+                            "required by the calling convention",
+                            reg_list->size);
+  }
+  return iree_vm_bytecode_verify_register(
+      verifier, reg_list->registers[(*reg_i)++], register_type);
+}
+
+// Verifies that |reg_list| matches the values in |cconv_fragment|.
+// |segment_size_list| provides the span counts of variadic calls and must be
+// provided if the fragment contains spans.
+static iree_status_t iree_vm_bytecode_verify_cconv_registers(
+    const iree_vm_bytecode_verifier_t* verifier,
+    iree_string_view_t cconv_fragment,
+    const iree_vm_register_list_t* segment_size_list,
+    const iree_vm_register_list_t* reg_list) {
+  iree_host_size_t reg_i = 0;
+  for (iree_host_size_t i = 0, seg_i = 0; i < cconv_fragment.size;
+       ++i, ++seg_i) {
+    if (cconv_fragment.data[i] != IREE_VM_CCONV_TYPE_SPAN_START) {
+      IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_cconv_register(
+          verifier, cconv_fragment.data[i], reg_list, &reg_i));
+      continue;
+    }
+    if (IREE_UNLIKELY(!segment_size_list)) {
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "variadic calling convention `%.*s` requires a variadic call",
+          (int)cconv_fragment.size, cconv_fragment.data);
+    } else if (IREE_UNLIKELY(seg_i >= segment_size_list->size)) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "segment size list missing segment %" PRIhsz,
+                              seg_i);
+    }
+    iree_host_size_t span_start = i + 1;
+    iree_host_size_t span_end = span_start;
+    while (span_end < cconv_fragment.size &&
+           cconv_fragment.data[span_end] != IREE_VM_CCONV_TYPE_SPAN_END) {
+      ++span_end;
+    }
+    if (IREE_UNLIKELY(span_end >= cconv_fragment.size)) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "unterminated span in calling convention `%.*s`",
+                              (int)cconv_fragment.size, cconv_fragment.data);
+    }
+    uint16_t span_count = segment_size_list->registers[seg_i];
+    for (uint16_t j = 0; j < span_count; ++j) {
+      for (iree_host_size_t k = span_start; k < span_end; ++k) {
+        IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_cconv_register(
+            verifier, cconv_fragment.data[k], reg_list, &reg_i));
+      }
+    }
+    i = span_end;
+  }
+  if (IREE_UNLIKELY(reg_i != reg_list->size)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "register list has more registers (%u) than "
+                            "required by the calling convention (%" PRIhsz ")",
+                            reg_list->size, reg_i);
+  }
+  return iree_ok_status();
+}
+
+// Verifies the operand and result lists of a call to |function_ordinal|
+// against the callee calling convention, if known.
+static iree_status_t iree_vm_bytecode_verify_call(
+    iree_vm_bytecode_verifier_t* verifier, uint32_t function_ordinal,
+    const iree_vm_register_list_t* segment_size_list,
+    const iree_vm_register_list_t* src_reg_list,
+    const iree_vm_register_list_t* dst_reg_list) {
+  iree_vm_function_signature_t signature;
+  memset(&signature, 0, sizeof(signature));
+  if (function_ordinal & 0x80000000u) {
+    uint32_t import_ordinal = function_ordinal & 0x7FFFFFFFu;
+    if (IREE_UNLIKELY(import_ordinal >= iree_vm_ImportFunctionDef_vec_len(
+                                            verifier->imported_functions))) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "import ordinal %u out of range", import_ordinal);
+    }
+    iree_vm_ImportFunctionDef_table_t import_def =
+        iree_vm_ImportFunctionDef_vec_at(verifier->imported_functions,
+                                         import_ordinal);
+    iree_vm_FunctionSignatureDef_table_t signature_def =
+        iree_vm_ImportFunctionDef_signature(import_def);
+    flatbuffers_string_t calling_convention =
+        signature_def
+            ? iree_vm_FunctionSignatureDef_calling_convention(signature_def)
+            : NULL;
+    if (!calling_convention) return iree_ok_status();
+    signature.calling_convention = iree_make_string_view(
+        calling_convention, flatbuffers_string_len(calling_convention));
+  } else {
+    if (IREE_UNLIKELY(segment_size_list)) {
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "variadic calls are only supported for import callees");
+    } else if (IREE_UNLIKELY(function_ordinal >= verifier->function_count)) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "function ordinal %u out of range",
+                              function_ordinal);
+    }
+    signature.calling_convention =
+        verifier->function_cconvs[function_ordinal];
+    // Internal callees are entered without marshaling spans and functions
+    // without an export have no signature we can check against.
+    if (!signature.calling_convention.data ||
+        iree_vm_function_call_is_variadic_cconv(
+            signature.calling_convention)) {
+      return iree_ok_status();
+    }
+  }
+  iree_string_view_t cconv_arguments = iree_string_view_empty();
+  iree_string_view_t cconv_results = iree_string_view_empty();
+  IREE_RETURN_IF_ERROR(iree_vm_function_call_get_cconv_fragments(
+      &signature, &cconv_arguments, &cconv_results));
+  IREE_RETURN_IF_ERROR(
+      iree_vm_bytecode_verify_cconv_registers(
+          verifier, cconv_arguments, segment_size_list, src_reg_list),
+      "call operands");
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_cconv_registers(
+                           verifier, cconv_results, NULL, dst_reg_list),
+                       "call results");
+  if (function_ordinal & 0x80000000u) {
+    iree_host_size_t result_size = 0;
+    IREE_RETURN_IF_ERROR(iree_vm_function_call_compute_cconv_fragment_size(
+        cconv_results, /*segment_size_list=*/NULL, &result_size));
+    verifier->import_result_size =
+        VMMAX(verifier->import_result_size, result_size);
+  }
+  return iree_ok_status();
+}
+
+// Verifies that a return |src_reg_list| matches the function results.
+static iree_status_t iree_vm_bytecode_verify_return(
+    const iree_vm_bytecode_verifier_t* verifier,
+    const iree_vm_register_list_t* src_reg_list) {
+  iree_vm_function_signature_t signature;
+  memset(&signature, 0, sizeof(signature));
+  signature.calling_convention =
+      verifier->function_cconvs[verifier->function_ordinal];
+  if (!signature.calling_convention.data ||
+      iree_vm_function_call_is_variadic_cconv(signature.calling_convention)) {
+    return iree_ok_status();
+  }
+  iree_string_view_t cconv_arguments = iree_string_view_empty();
+  iree_string_view_t cconv_results = iree_string_view_empty();
+  IREE_RETURN_IF_ERROR(iree_vm_function_call_get_cconv_fragments(
+      &signature, &cconv_arguments, &cconv_results));
+  return iree_vm_bytecode_verify_cconv_registers(verifier, cconv_results, NULL,
+                                                 src_reg_list);
+}
+
+//===----------------------------------------------------------------------===//
+// Instruction verification
+//===----------------------------------------------------------------------===//
+// These match the VM_Dec* decoding macros used by the dispatch loop 1:1 such
+// that each op can be verified by mirroring its decode sequence.
+
+#define BEGIN_VERIFY_PREFIX(op_name, ext)                                 \
+  case IREE_VM_OP_CORE_##op_name: {                                       \
+    IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_bytes(verifier, pc, 1)); \
+    switch (bytecode_data[pc++]) {
+#define END_VERIFY_PREFIX()                                  \
+  default:                                                   \
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,       \
+                            "unsupported ext opcode 0x%02X", \
+                            bytecode_data[pc - 1]);          \
+    }                                                        \
+    break;                                                   \
+    }
+#define UNHANDLED_VERIFY_PREFIX(op_name, ext)                        \
+  case IREE_VM_OP_CORE_##op_name: {                                  \
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,               \
+                            "unsupported dispatch extension " #ext); \
+  }
+
+#define VERIFY_OP(ext, op_name) case IREE_VM_OP_##ext##_##op_name:
+
+#define VM_VerifyConst(byte_width)                                \
+  IREE_RETURN_IF_ERROR(                                           \
+      iree_vm_bytecode_verify_bytes(verifier, pc, (byte_width))); \
+  pc += (byte_width);
+#define VM_VerifyIntAttr32(name) VM_VerifyConst(4)
+#define VM_VerifyIntAttr64(name) VM_VerifyConst(8)
+#define VM_VerifyFloatAttr32(name) VM_VerifyConst(4)
+#define VM_VerifyGlobalAttr(name, byte_width)                          \
+  IREE_RETURN_IF_ERROR(                                                \
+      iree_vm_bytecode_verify_global_attr(verifier, &pc, byte_width));
+#define VM_VerifyGlobalRefAttr(name) \
+  IREE_RETURN_IF_ERROR(              \
+      iree_vm_bytecode_verify_global_ref_attr(verifier, &pc));
+#define VM_VerifyRodataAttr(name)                                           \
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_rodata_attr(verifier, &pc));
+#define VM_VerifyFuncAttr(name, out_ordinal)                         \
+  IREE_RETURN_IF_ERROR(                                              \
+      iree_vm_bytecode_verify_read_i32(verifier, &pc, out_ordinal));
+#define VM_VerifyTypeOf(name)                                        \
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_type(verifier, &pc));
+#define VM_VerifyStrAttr(name)                                           \
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_str_attr(verifier, &pc));
+#define VM_VerifyBranchTarget(name)                                           \
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_branch_target(verifier, &pc));
+#define VM_VerifyBranchOperands(name) \
+  IREE_RETURN_IF_ERROR(               \
+      iree_vm_bytecode_verify_branch_operands(verifier, &pc));
+#define VM_VerifyRegister(name, type)                            \
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_register_operand( \
+      verifier, &pc, IREE_VM_BYTECODE_REGISTER_##type));
+#define VM_VerifyOperandRegI32(name) VM_VerifyRegister(name, I32)
+#define VM_VerifyOperandRegI64(name) VM_VerifyRegister(name, I64)
+#define VM_VerifyOperandRegF32(name) VM_VerifyRegister(name, I32)
+#define VM_VerifyOperandRegRef(name) VM_VerifyRegister(name, REF)
+#define VM_VerifyResultRegI32(name) VM_VerifyRegister(name, I32)
+#define VM_VerifyResultRegI64(name) VM_VerifyRegister(name, I64)
+#define VM_VerifyResultRegF32(name) VM_VerifyRegister(name, I32)
+#define VM_VerifyResultRegRef(name) VM_VerifyRegister(name, REF)
+#define VM_VerifyVariadicOperands(name, type, out_list)            \
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_register_list(      \
+      verifier, &pc, IREE_VM_BYTECODE_REGISTER_##type, out_list));
+#define VM_VerifyVariadicResults(name, type, out_list) \
+  VM_VerifyVariadicOperands(name, type, out_list)
+
+#define VERIFY_OP_CORE_UNARY_I32(op_name) \
+  VERIFY_OP(CORE, op_name) {              \
+    VM_VerifyOperandRegI32("operand");    \
+    VM_VerifyResultRegI32("result");      \
+    break;                                \
+  }
+#define VERIFY_OP_CORE_BINARY_I32(op_name) \
+  VERIFY_OP(CORE, op_name) {               \
+    VM_VerifyOperandRegI32("lhs");         \
+    VM_VerifyOperandRegI32("rhs");         \
+    VM_VerifyResultRegI32("result");       \
+    break;                                 \
+  }
+#define VERIFY_OP_CORE_TERNARY_I32(op_name) \
+  VERIFY_OP(CORE, op_name) {                \
+    VM_VerifyOperandRegI32("a");            \
+    VM_VerifyOperandRegI32("b");            \
+    VM_VerifyOperandRegI32("c");            \
+    VM_VerifyResultRegI32("result");        \
+    break;                                  \
+  }
+#define VERIFY_OP_CORE_UNARY_I64(op_name) \
+  VERIFY_OP(CORE, op_name) {              \
+    VM_VerifyOperandRegI64("operand");    \
+    VM_VerifyResultRegI64("result");      \
+    break;                                \
+  }
+#define VERIFY_OP_CORE_BINARY_I64(op_name) \
+  VERIFY_OP(CORE, op_name) {               \
+    VM_VerifyOperandRegI64("lhs");         \
+    VM_VerifyOperandRegI64("rhs");         \
+    VM_VerifyResultRegI64("result");       \
+    break;                                 \
+  }
+#define VERIFY_OP_CORE_TERNARY_I64(op_name) \
+  VERIFY_OP(CORE, op_name) {                \
+    VM_VerifyOperandRegI64("a");            \
+    VM_VerifyOperandRegI64("b");            \
+    VM_VerifyOperandRegI64("c");            \
+    VM_VerifyResultRegI64("result");        \
+    break;                                  \
+  }
+#define VERIFY_OP_CORE_SHIFT_I64(op_name) \
+  VERIFY_OP(CORE, op_name) {              \
+    VM_VerifyOperandRegI64("operand");    \
+    VM_VerifyOperandRegI32("amount");     \
+    VM_VerifyResultRegI64("result");      \
+    break;                                \
+  }
+#define VERIFY_OP_CORE_CMP_I64(op_name) \
+  VERIFY_OP(CORE, op_name) {            \
+    VM_VerifyOperandRegI64("lhs");      \
+    VM_VerifyOperandRegI64("rhs");      \
+    VM_VerifyResultRegI32("result");    \
+    break;                              \
+  }
+#define VERIFY_OP_CORE_COND_BRANCH_CMP(op_name, type) \
+  VERIFY_OP(CORE, op_name) {                          \
+    VM_VerifyOperandReg##type("lhs");                 \
+    VM_VerifyOperandReg##type("rhs");                 \
+    VM_VerifyBranchTarget("true_dest");               \
+    VM_VerifyBranchOperands("true_operands");         \
+    VM_VerifyBranchTarget("false_dest");              \
+    VM_VerifyBranchOperands("false_operands");        \
+    is_terminator = true;                             \
+    break;                                            \
+  }
+#define VERIFY_OP_CORE_BUFFER_LOAD(op_name, result_type) \
+  VERIFY_OP(CORE, op_name) {                             \
+    VM_VerifyOperandRegRef("source_buffer");             \
+    VM_VerifyOperandRegI64("source_offset");             \
+    VM_VerifyResultReg##result_type("result");           \
+    break;                                               \
+  }
+#define VERIFY_OP_CORE_BUFFER_STORE(op_name, value_type) \
+  VERIFY_OP(CORE, op_name) {                             \
+    VM_VerifyOperandRegRef("target_buffer");             \
+    VM_VerifyOperandRegI64("target_offset");             \
+    VM_VerifyOperandReg##value_type("value");            \
+    break;                                               \
+  }
+#define VERIFY_OP_CORE_BUFFER_FILL(op_name, value_type) \
+  VERIFY_OP(CORE, op_name) {                            \
+    VM_VerifyOperandRegRef("target_buffer");            \
+    VM_VerifyOperandRegI64("target_offset");            \
+    VM_VerifyOperandRegI64("length");                   \
+    VM_VerifyOperandReg##value_type("value");           \
+    break;                                              \
+  }
+
+#define VERIFY_OP_EXT_F32_UNARY_F32(op_name) \
+  VERIFY_OP(EXT_F32, op_name) {              \
+    VM_VerifyOperandRegF32("operand");       \
+    VM_VerifyResultRegF32("result");         \
+    break;                                   \
+  }
+#define VERIFY_OP_EXT_F32_BINARY_F32(op_name) \
+  VERIFY_OP(EXT_F32, op_name) {               \
+    VM_VerifyOperandRegF32("lhs");            \
+    VM_VerifyOperandRegF32("rhs");            \
+    VM_VerifyResultRegF32("result");          \
+    break;                                    \
+  }
+
+// Verifies the instruction at |pc| and returns the offset of the next
+// instruction in |out_next_pc|. |out_is_terminator| is set if the instruction
+// never falls through to the next instruction.
+static iree_status_t iree_vm_bytecode_verify_op(
+    iree_vm_bytecode_verifier_t* verifier, iree_vm_source_offset_t pc,
+    iree_vm_source_offset_t* out_next_pc, bool* out_is_terminator) {
+  const uint8_t* IREE_RESTRICT bytecode_data = verifier->bytecode_data;
+  bool is_terminator = false;
+  switch (bytecode_data[pc++]) {
+    //===------------------------------------------------------------------===//
+    // Globals
+    //===------------------------------------------------------------------===//
+
+    VERIFY_OP(CORE, GlobalLoadI32) {
+      VM_VerifyGlobalAttr("global", sizeof(int32_t));
+      VM_VerifyResultRegI32("value");
+      break;
+    }
+    VERIFY_OP(CORE, GlobalStoreI32) {
+      VM_VerifyGlobalAttr("global", sizeof(int32_t));
+      VM_VerifyOperandRegI32("value");
+      break;
+    }
+    VERIFY_OP(CORE, GlobalLoadIndirectI32) {
+      VM_VerifyOperandRegI32("global");
+      VM_VerifyResultRegI32("value");
+      break;
+    }
+    VERIFY_OP(CORE, GlobalStoreIndirectI32) {
+      VM_VerifyOperandRegI32("global");
+      VM_VerifyOperandRegI32("value");
+      break;
+    }
+    VERIFY_OP(CORE, GlobalLoadI64) {
+      VM_VerifyGlobalAttr("global", sizeof(int64_t));
+      VM_VerifyResultRegI64("value");
+      break;
+    }
+    VERIFY_OP(CORE, GlobalStoreI64) {
+      VM_VerifyGlobalAttr("global", sizeof(int64_t));
+      VM_VerifyOperandRegI64("value");
+      break;
+    }
+    VERIFY_OP(CORE, GlobalLoadIndirectI64) {
+      VM_VerifyOperandRegI32("global");
+      VM_VerifyResultRegI64("value");
+      break;
+    }
+    VERIFY_OP(CORE, GlobalStoreIndirectI64) {
+      VM_VerifyOperandRegI32("global");
+      VM_VerifyOperandRegI64("value");
+      break;
+    }
+    VERIFY_OP(CORE, GlobalLoadRef) {
+      VM_VerifyGlobalRefAttr("global");
+      VM_VerifyTypeOf("value");
+      VM_VerifyResultRegRef("value");
+      break;
+    }
+    VERIFY_OP(CORE, GlobalStoreRef) {
+      VM_VerifyGlobalRefAttr("global");
+      VM_VerifyTypeOf("value");
+      VM_VerifyOperandRegRef("value");
+      break;
+    }
+    VERIFY_OP(CORE, GlobalLoadIndirectRef) {
+      VM_VerifyOperandRegI32("global");
+      VM_VerifyTypeOf("value");
+      VM_VerifyResultRegRef("value");
+      break;
+    }
+    VERIFY_OP(CORE, GlobalStoreIndirectRef) {
+      VM_VerifyOperandRegI32("global");
+      VM_VerifyTypeOf("value");
+      VM_VerifyOperandRegRef("value");
+      break;
+    }
+
+    //===------------------------------------------------------------------===//
+    // Constants
+    //===------------------------------------------------------------------===//
+
+    VERIFY_OP(CORE, ConstI32) {
+      VM_VerifyIntAttr32("value");
+      VM_VerifyResultRegI32("result");
+      break;
+    }
+    VERIFY_OP(CORE, ConstI32Zero) {
+      VM_VerifyResultRegI32("result");
+      break;
+    }
+    VERIFY_OP(CORE, ConstI64) {
+      VM_VerifyIntAttr64("value");
+      VM_VerifyResultRegI64("result");
+      break;
+    }
+    VERIFY_OP(CORE, ConstI64Zero) {
+      VM_VerifyResultRegI64("result");
+      break;
+    }
+    VERIFY_OP(CORE, ConstRefZero) {
+      VM_VerifyResultRegRef("result");
+      break;
+    }
+    VERIFY_OP(CORE, ConstRefRodata) {
+      VM_VerifyRodataAttr("rodata");
+      VM_VerifyResultRegRef("value");
+      break;
+    }
+
+    //===------------------------------------------------------------------===//
+    // Buffers
+    //===------------------------------------------------------------------===//
+
+    VERIFY_OP(CORE, BufferAlloc) {
+      VM_VerifyOperandRegI64("length");
+      VM_VerifyResultRegRef("result");
+      break;
+    }
+    VERIFY_OP(CORE, BufferClone) {
+      VM_VerifyOperandRegRef("source");
+      VM_VerifyOperandRegI64("offset");
+      VM_VerifyOperandRegI64("length");
+      VM_VerifyResultRegRef("result");
+      break;
+    }
+    VERIFY_OP(CORE, BufferLength) {
+      VM_VerifyOperandRegRef("buffer");
+      VM_VerifyResultRegI64("result");
+      break;
+    }
+    VERIFY_OP(CORE, BufferCopy) {
+      VM_VerifyOperandRegRef("source_buffer");
+      VM_VerifyOperandRegI64("source_offset");
+      VM_VerifyOperandRegRef("target_buffer");
+      VM_VerifyOperandRegI64("target_offset");
+      VM_VerifyOperandRegI64("length");
+      break;
+    }
+    VERIFY_OP(CORE, BufferCompare) {
+      VM_VerifyOperandRegRef("lhs_buffer");
+      VM_VerifyOperandRegI64("lhs_offset");
+      VM_VerifyOperandRegRef("rhs_buffer");
+      VM_VerifyOperandRegI64("rhs_offset");
+      VM_VerifyOperandRegI64("length");
+      VM_VerifyResultRegI32("result");
+      break;
+    }
+    VERIFY_OP_CORE_BUFFER_FILL(BufferFillI8, I32);
+    VERIFY_OP_CORE_BUFFER_FILL(BufferFillI16, I32);
+    VERIFY_OP_CORE_BUFFER_FILL(BufferFillI32, I32);
+    VERIFY_OP_CORE_BUFFER_FILL(BufferFillI64, I64);
+    VERIFY_OP_CORE_BUFFER_LOAD(BufferLoadI8U, I32);
+    VERIFY_OP_CORE_BUFFER_LOAD(BufferLoadI8S, I32);
+    VERIFY_OP_CORE_BUFFER_LOAD(BufferLoadI16U, I32);
+    VERIFY_OP_CORE_BUFFER_LOAD(BufferLoadI16S, I32);
+    VERIFY_OP_CORE_BUFFER_LOAD(BufferLoadI32, I32);
+    VERIFY_OP_CORE_BUFFER_LOAD(BufferLoadI64, I64);
+    VERIFY_OP_CORE_BUFFER_STORE(BufferStoreI8, I32);
+    VERIFY_OP_CORE_BUFFER_STORE(BufferStoreI16, I32);
+    VERIFY_OP_CORE_BUFFER_STORE(BufferStoreI32, I32);
+    VERIFY_OP_CORE_BUFFER_STORE(BufferStoreI64, I64);
+
+    //===------------------------------------------------------------------===//
+    // Lists
+    //===------------------------------------------------------------------===//
+
+    VERIFY_OP(CORE, ListAlloc) {
+      VM_VerifyTypeOf("element_type");
+      VM_VerifyOperandRegI32("initial_capacity");
+      VM_VerifyResultRegRef("result");
+      break;
+    }
+    VERIFY_OP(CORE, ListReserve) {
+      VM_VerifyOperandRegRef("list");
+      VM_VerifyOperandRegI32("minimum_capacity");
+      break;
+    }
+    VERIFY_OP(CORE, ListSize) {
+      VM_VerifyOperandRegRef("list");
+      VM_VerifyResultRegI32("result");
+      break;
+    }
+    VERIFY_OP(CORE, ListResize) {
+      VM_VerifyOperandRegRef("list");
+      VM_VerifyOperandRegI32("new_size");
+      break;
+    }
+    VERIFY_OP(CORE, ListGetI32) {
+      VM_VerifyOperandRegRef("list");
+      VM_VerifyOperandRegI32("index");
+      VM_VerifyResultRegI32("result");
+      break;
+    }
+    VERIFY_OP(CORE, ListSetI32) {
+      VM_VerifyOperandRegRef("list");
+      VM_VerifyOperandRegI32("index");
+      VM_VerifyOperandRegI32("raw_value");
+      break;
+    }
+    VERIFY_OP(CORE, ListGetI64) {
+      VM_VerifyOperandRegRef("list");
+      VM_VerifyOperandRegI32("index");
+      VM_VerifyResultRegI64("result");
+      break;
+    }
+    VERIFY_OP(CORE, ListSetI64) {
+      VM_VerifyOperandRegRef("list");
+      VM_VerifyOperandRegI32("index");
+      VM_VerifyOperandRegI64("value");
+      break;
+    }
+    VERIFY_OP(CORE, ListGetRef) {
+      VM_VerifyOperandRegRef("list");
+      VM_VerifyOperandRegI32("index");
+      VM_VerifyTypeOf("result");
+      VM_VerifyResultRegRef("result");
+      break;
+    }
+    VERIFY_OP(CORE, ListSetRef) {
+      VM_VerifyOperandRegRef("list");
+      VM_VerifyOperandRegI32("index");
+      VM_VerifyOperandRegRef("value");
+      break;
+    }
+
+    //===------------------------------------------------------------------===//
+    // Conditional assignment
+    //===------------------------------------------------------------------===//
+
+    VERIFY_OP(CORE, SelectI32) {
+      VM_VerifyOperandRegI32("condition");
+      VM_VerifyOperandRegI32("true_value");
+      VM_VerifyOperandRegI32("false_value");
+      VM_VerifyResultRegI32("result");
+      break;
+    }
+    VERIFY_OP(CORE, SelectI64) {
+      VM_VerifyOperandRegI32("condition");
+      VM_VerifyOperandRegI64("true_value");
+      VM_VerifyOperandRegI64("false_value");
+      VM_VerifyResultRegI64("result");
+      break;
+    }
+    VERIFY_OP(CORE, SelectRef) {
+      VM_VerifyOperandRegI32("condition");
+      VM_VerifyTypeOf("true_value");
+      VM_VerifyOperandRegRef("true_value");
+      VM_VerifyOperandRegRef("false_value");
+      VM_VerifyResultRegRef("result");
+      break;
+    }
+    VERIFY_OP(CORE, SwitchI32) {
+      VM_VerifyOperandRegI32("index");
+      VM_VerifyIntAttr32("default_value");
+      VM_VerifyVariadicOperands("values", I32, NULL);
+      VM_VerifyResultRegI32("result");
+      break;
+    }
+    VERIFY_OP(CORE, SwitchI64) {
+      VM_VerifyOperandRegI32("index");
+      VM_VerifyIntAttr64("default_value");
+      VM_VerifyVariadicOperands("values", I64, NULL);
+      VM_VerifyResultRegI64("result");
+      break;
+    }
+    VERIFY_OP(CORE, SwitchRef) {
+      VM_VerifyOperandRegI32("index");
+      VM_VerifyTypeOf("result");
+      VM_VerifyOperandRegRef("default_value");
+      VM_VerifyVariadicOperands("values", REF, NULL);
+      VM_VerifyResultRegRef("result");
+      break;
+    }
+
+    //===------------------------------------------------------------------===//
+    // Native integer arithmetic
+    //===------------------------------------------------------------------===//
+
+    VERIFY_OP_CORE_BINARY_I32(AddI32);
+    VERIFY_OP_CORE_BINARY_I32(SubI32);
+    VERIFY_OP_CORE_BINARY_I32(MulI32);
+    VERIFY_OP_CORE_BINARY_I32(DivI32S);
+    VERIFY_OP_CORE_BINARY_I32(DivI32U);
+    VERIFY_OP_CORE_BINARY_I32(RemI32S);
+    VERIFY_OP_CORE_BINARY_I32(RemI32U);
+    VERIFY_OP_CORE_TERNARY_I32(FMAI32);
+    VERIFY_OP_CORE_UNARY_I32(NotI32);
+    VERIFY_OP_CORE_BINARY_I32(AndI32);
+    VERIFY_OP_CORE_BINARY_I32(OrI32);
+    VERIFY_OP_CORE_BINARY_I32(XorI32);
+    VERIFY_OP_CORE_UNARY_I32(CtlzI32);
+
+    VERIFY_OP_CORE_BINARY_I64(AddI64);
+    VERIFY_OP_CORE_BINARY_I64(SubI64);
+    VERIFY_OP_CORE_BINARY_I64(MulI64);
+    VERIFY_OP_CORE_BINARY_I64(DivI64S);
+    VERIFY_OP_CORE_BINARY_I64(DivI64U);
+    VERIFY_OP_CORE_BINARY_I64(RemI64S);
+    VERIFY_OP_CORE_BINARY_I64(RemI64U);
+    VERIFY_OP_CORE_TERNARY_I64(FMAI64);
+    VERIFY_OP_CORE_UNARY_I64(NotI64);
+    VERIFY_OP_CORE_BINARY_I64(AndI64);
+    VERIFY_OP_CORE_BINARY_I64(OrI64);
+    VERIFY_OP_CORE_BINARY_I64(XorI64);
+    VERIFY_OP_CORE_UNARY_I64(CtlzI64);
+
+    //===------------------------------------------------------------------===//
+    // Casting and type conversion/emulation
+    //===------------------------------------------------------------------===//
+
+    VERIFY_OP_CORE_UNARY_I32(TruncI32I8);
+    VERIFY_OP_CORE_UNARY_I32(TruncI32I16);
+    VERIFY_OP_CORE_UNARY_I32(ExtI8I32S);
+    VERIFY_OP_CORE_UNARY_I32(ExtI8I32U);
+    VERIFY_OP_CORE_UNARY_I32(ExtI16I32S);
+    VERIFY_OP_CORE_UNARY_I32(ExtI16I32U);
+    VERIFY_OP(CORE, TruncI64I32) {
+      VM_VerifyOperandRegI64("operand");
+      VM_VerifyResultRegI32("result");
+      break;
+    }
+    VERIFY_OP(CORE, ExtI32I64S) {
+      VM_VerifyOperandRegI32("operand");
+      VM_VerifyResultRegI64("result");
+      break;
+    }
+    VERIFY_OP(CORE, ExtI32I64U) {
+      VM_VerifyOperandRegI32("operand");
+      VM_VerifyResultRegI64("result");
+      break;
+    }
+
+    //===------------------------------------------------------------------===//
+    // Native bitwise shifts and rotates
+    //===------------------------------------------------------------------===//
+
+    VERIFY_OP_CORE_BINARY_I32(ShlI32);
+    VERIFY_OP_CORE_BINARY_I32(ShrI32S);
+    VERIFY_OP_CORE_BINARY_I32(ShrI32U);
+    VERIFY_OP_CORE_SHIFT_I64(ShlI64);
+    VERIFY_OP_CORE_SHIFT_I64(ShrI64S);
+    VERIFY_OP_CORE_SHIFT_I64(ShrI64U);
+
+    //===------------------------------------------------------------------===//
+    // Comparison ops
+    //===------------------------------------------------------------------===//
+
+    VERIFY_OP_CORE_BINARY_I32(CmpEQI32);
+    VERIFY_OP_CORE_BINARY_I32(CmpNEI32);
+    VERIFY_OP_CORE_BINARY_I32(CmpLTI32S);
+    VERIFY_OP_CORE_BINARY_I32(CmpLTI32U);
+    VERIFY_OP_CORE_UNARY_I32(CmpNZI32);
+    VERIFY_OP_CORE_CMP_I64(CmpEQI64);
+    VERIFY_OP_CORE_CMP_I64(CmpNEI64);
+    VERIFY_OP_CORE_CMP_I64(CmpLTI64S);
+    VERIFY_OP_CORE_CMP_I64(CmpLTI64U);
+    VERIFY_OP(CORE, CmpNZI64) {
+      VM_VerifyOperandRegI64("operand");
+      VM_VerifyResultRegI32("result");
+      break;
+    }
+    VERIFY_OP(CORE, CmpEQRef) {
+      VM_VerifyOperandRegRef("lhs");
+      VM_VerifyOperandRegRef("rhs");
+      VM_VerifyResultRegI32("result");
+      break;
+    }
+    VERIFY_OP(CORE, CmpNERef) {
+      VM_VerifyOperandRegRef("lhs");
+      VM_VerifyOperandRegRef("rhs");
+      VM_VerifyResultRegI32("result");
+      break;
+    }
+    VERIFY_OP(CORE, CmpNZRef) {
+      VM_VerifyOperandRegRef("operand");
+      VM_VerifyResultRegI32("result");
+      break;
+    }
+
+    //===------------------------------------------------------------------===//
+    // Control flow
+    //===------------------------------------------------------------------===//
+
+    VERIFY_OP(CORE, Branch) {
+      VM_VerifyBranchTarget("dest");
+      VM_VerifyBranchOperands("operands");
+      is_terminator = true;
+      break;
+    }
+    VERIFY_OP(CORE, CondBranch) {
+      VM_VerifyOperandRegI32("condition");
+      VM_VerifyBranchTarget("true_dest");
+      VM_VerifyBranchOperands("true_operands");
+      VM_VerifyBranchTarget("false_dest");
+      VM_VerifyBranchOperands("false_operands");
+      is_terminator = true;
+      break;
+    }
+    VERIFY_OP_CORE_COND_BRANCH_CMP(CondBranchCmpEQI32, I32);
+    VERIFY_OP_CORE_COND_BRANCH_CMP(CondBranchCmpNEI32, I32);
+    VERIFY_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI32S, I32);
+    VERIFY_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI32U, I32);
+    VERIFY_OP_CORE_COND_BRANCH_CMP(CondBranchCmpEQI64, I64);
+    VERIFY_OP_CORE_COND_BRANCH_CMP(CondBranchCmpNEI64, I64);
+    VERIFY_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI64S, I64);
+    VERIFY_OP_CORE_COND_BRANCH_CMP(CondBranchCmpLTI64U, I64);
+    VERIFY_OP(CORE, Call) {
+      uint32_t function_ordinal = 0;
+      VM_VerifyFuncAttr("callee", &function_ordinal);
+      const iree_vm_register_list_t* src_reg_list = NULL;
+      VM_VerifyVariadicOperands("operands", ANY, &src_reg_list);
+      const iree_vm_register_list_t* dst_reg_list = NULL;
+      VM_VerifyVariadicResults("results", ANY, &dst_reg_list);
+      IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_call(
+          verifier, function_ordinal, NULL, src_reg_list, dst_reg_list));
+      break;
+    }
+    VERIFY_OP(CORE, CallVariadic) {
+      uint32_t function_ordinal = 0;
+      VM_VerifyFuncAttr("callee", &function_ordinal);
+      const uint16_t* segment_size_list = NULL;
+      IREE_RETURN_IF_ERROR(
+          iree_vm_bytecode_verify_list(verifier, &pc, 1, &segment_size_list));
+      const iree_vm_register_list_t* src_reg_list = NULL;
+      VM_VerifyVariadicOperands("operands", ANY, &src_reg_list);
+      const iree_vm_register_list_t* dst_reg_list = NULL;
+      VM_VerifyVariadicResults("results", ANY, &dst_reg_list);
+      IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_call(
+          verifier, function_ordinal,
+          (const iree_vm_register_list_t*)segment_size_list, src_reg_list,
+          dst_reg_list));
+      break;
+    }
+    VERIFY_OP(CORE, Return) {
+      const iree_vm_register_list_t* src_reg_list = NULL;
+      VM_VerifyVariadicOperands("operands", ANY, &src_reg_list);
+      IREE_RETURN_IF_ERROR(
+          iree_vm_bytecode_verify_return(verifier, src_reg_list));
+      is_terminator = true;
+      break;
+    }
+    VERIFY_OP(CORE, Fail) {
+      VM_VerifyOperandRegI32("status");
+      VM_VerifyStrAttr("message");
+      is_terminator = true;
+      break;
+    }
+    VERIFY_OP(CORE, ImportResolved) {
+      uint32_t function_ordinal = 0;
+      VM_VerifyFuncAttr("import", &function_ordinal);
+      uint32_t import_ordinal = function_ordinal & 0x7FFFFFFFu;
+      if (IREE_UNLIKELY(import_ordinal >= iree_vm_ImportFunctionDef_vec_len(
+                                              verifier->imported_functions))) {
+        return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                                "import ordinal %u out of range",
+                                import_ordinal);
+      }
+      VM_VerifyResultRegI32("result");
+      break;
+    }
+
+    //===------------------------------------------------------------------===//
+    // Async/fiber ops
+    //===------------------------------------------------------------------===//
+
+    VERIFY_OP(CORE, Yield) {
+      VM_VerifyBranchTarget("dest");
+      VM_VerifyBranchOperands("operands");
+      is_terminator = true;
+      break;
+    }
+
+    //===------------------------------------------------------------------===//
+    // Debugging
+    //===------------------------------------------------------------------===//
+
+    VERIFY_OP(CORE, Trace) {
+      VM_VerifyStrAttr("event_name");
+      VM_VerifyVariadicOperands("operands", ANY, NULL);
+      break;
+    }
+    VERIFY_OP(CORE, Print) {
+      VM_VerifyStrAttr("event_name");
+      VM_VerifyVariadicOperands("operands", ANY, NULL);
+      break;
+    }
+    VERIFY_OP(CORE, Break) {
+      VM_VerifyBranchTarget("dest");
+      VM_VerifyBranchOperands("operands");
+      is_terminator = true;
+      break;
+    }
+    VERIFY_OP(CORE, CondBreak) {
+      VM_VerifyOperandRegI32("condition");
+      VM_VerifyBranchTarget("dest");
+      VM_VerifyBranchOperands("operands");
+      is_terminator = true;
+      break;
+    }
+
+    //===------------------------------------------------------------------===//
+    // Extension trampolines
+    //===------------------------------------------------------------------===//
+
+#if IREE_VM_EXT_F32_ENABLE
+    BEGIN_VERIFY_PREFIX(PrefixExtF32, EXT_F32)
+
+    //===----------------------------------------------------------------===//
+    // ExtF32: Globals
+    //===----------------------------------------------------------------===//
+
+    VERIFY_OP(EXT_F32, GlobalLoadF32) {
+      VM_VerifyGlobalAttr("global", sizeof(float));
+      VM_VerifyResultRegF32("value");
+      break;
+    }
+    VERIFY_OP(EXT_F32, GlobalStoreF32) {
+      VM_VerifyGlobalAttr("global", sizeof(float));
+      VM_VerifyOperandRegF32("value");
+      break;
+    }
+    VERIFY_OP(EXT_F32, GlobalLoadIndirectF32) {
+      VM_VerifyOperandRegI32("global");
+      VM_VerifyResultRegF32("value");
+      break;
+    }
+    VERIFY_OP(EXT_F32, GlobalStoreIndirectF32) {
+      VM_VerifyOperandRegI32("global");
+      VM_VerifyOperandRegF32("value");
+      break;
+    }
+
+    //===----------------------------------------------------------------===//
+    // ExtF32: Constants
+    //===----------------------------------------------------------------===//
+
+    VERIFY_OP(EXT_F32, ConstF32) {
+      VM_VerifyFloatAttr32("value");
+      VM_VerifyResultRegF32("result");
+      break;
+    }
+    VERIFY_OP(EXT_F32, ConstF32Zero) {
+      VM_VerifyResultRegF32("result");
+      break;
+    }
+
+    //===----------------------------------------------------------------===//
+    // ExtF32: Lists
+    //===----------------------------------------------------------------===//
+
+    VERIFY_OP(EXT_F32, ListGetF32) {
+      VM_VerifyOperandRegRef("list");
+      VM_VerifyOperandRegI32("index");
+      VM_VerifyResultRegF32("result");
+      break;
+    }
+    VERIFY_OP(EXT_F32, ListSetF32) {
+      VM_VerifyOperandRegRef("list");
+      VM_VerifyOperandRegI32("index");
+      VM_VerifyOperandRegF32("value");
+      break;
+    }
+
+    //===----------------------------------------------------------------===//
+    // ExtF32: Conditional assignment
+    //===----------------------------------------------------------------===//
+
+    VERIFY_OP(EXT_F32, SelectF32) {
+      VM_VerifyOperandRegI32("condition");
+      VM_VerifyOperandRegF32("true_value");
+      VM_VerifyOperandRegF32("false_value");
+      VM_VerifyResultRegF32("result");
+      break;
+    }
+    VERIFY_OP(EXT_F32, SwitchF32) {
+      VM_VerifyOperandRegI32("index");
+      VM_VerifyFloatAttr32("default_value");
+      VM_VerifyVariadicOperands("values", I32, NULL);
+      VM_VerifyResultRegF32("result");
+      break;
+    }
+
+    //===----------------------------------------------------------------===//
+    // ExtF32: Native floating-point arithmetic
+    //===----------------------------------------------------------------===//
+
+    VERIFY_OP_EXT_F32_BINARY_F32(AddF32);
+    VERIFY_OP_EXT_F32_BINARY_F32(SubF32);
+    VERIFY_OP_EXT_F32_BINARY_F32(MulF32);
+    VERIFY_OP_EXT_F32_BINARY_F32(DivF32);
+    VERIFY_OP_EXT_F32_BINARY_F32(RemF32);
+    VERIFY_OP(EXT_F32, FMAF32) {
+      VM_VerifyOperandRegF32("a");
+      VM_VerifyOperandRegF32("b");
+      VM_VerifyOperandRegF32("c");
+      VM_VerifyResultRegF32("result");
+      break;
+    }
+    VERIFY_OP_EXT_F32_UNARY_F32(AbsF32);
+    VERIFY_OP_EXT_F32_UNARY_F32(NegF32);
+    VERIFY_OP_EXT_F32_UNARY_F32(CeilF32);
+    VERIFY_OP_EXT_F32_UNARY_F32(FloorF32);
+
+    VERIFY_OP_EXT_F32_UNARY_F32(AtanF32);
+    VERIFY_OP_EXT_F32_BINARY_F32(Atan2F32);
+    VERIFY_OP_EXT_F32_UNARY_F32(CosF32);
+    VERIFY_OP_EXT_F32_UNARY_F32(SinF32);
+    VERIFY_OP_EXT_F32_UNARY_F32(ExpF32);
+    VERIFY_OP_EXT_F32_UNARY_F32(Exp2F32);
+    VERIFY_OP_EXT_F32_UNARY_F32(ExpM1F32);
+    VERIFY_OP_EXT_F32_UNARY_F32(LogF32);
+    VERIFY_OP_EXT_F32_UNARY_F32(Log10F32);
+    VERIFY_OP_EXT_F32_UNARY_F32(Log1pF32);
+    VERIFY_OP_EXT_F32_UNARY_F32(Log2F32);
+    VERIFY_OP_EXT_F32_BINARY_F32(PowF32);
+    VERIFY_OP_EXT_F32_UNARY_F32(RsqrtF32);
+    VERIFY_OP_EXT_F32_UNARY_F32(SqrtF32);
+    VERIFY_OP_EXT_F32_UNARY_F32(TanhF32);
+    VERIFY_OP_EXT_F32_UNARY_F32(ErfF32);
+
+    //===----------------------------------------------------------------===//
+    // ExtF32: Casting and type conversion/emulation
+    //===----------------------------------------------------------------===//
+
+    VERIFY_OP_EXT_F32_UNARY_F32(CastSI32F32);
+    VERIFY_OP_EXT_F32_UNARY_F32(CastUI32F32);
+    VERIFY_OP_EXT_F32_UNARY_F32(CastF32SI32);
+    VERIFY_OP_EXT_F32_UNARY_F32(CastF32UI32);
+    VERIFY_OP_EXT_F32_UNARY_F32(BitcastI32F32);
+    VERIFY_OP_EXT_F32_UNARY_F32(BitcastF32I32);
+
+    //===----------------------------------------------------------------===//
+    // ExtF32: Comparison ops
+    //===----------------------------------------------------------------===//
+
+    VERIFY_OP_EXT_F32_BINARY_F32(CmpEQF32O);
+    VERIFY_OP_EXT_F32_BINARY_F32(CmpEQF32U);
+    VERIFY_OP_EXT_F32_BINARY_F32(CmpNEF32O);
+    VERIFY_OP_EXT_F32_BINARY_F32(CmpNEF32U);
+    VERIFY_OP_EXT_F32_BINARY_F32(CmpLTF32O);
+    VERIFY_OP_EXT_F32_BINARY_F32(CmpLTF32U);
+    VERIFY_OP_EXT_F32_BINARY_F32(CmpLTEF32O);
+    VERIFY_OP_EXT_F32_BINARY_F32(CmpLTEF32U);
+    VERIFY_OP_EXT_F32_UNARY_F32(CmpNaNF32);
+
+    //===----------------------------------------------------------------===//
+    // ExtF32: Buffers
+    //===----------------------------------------------------------------===//
+
+    VERIFY_OP(EXT_F32, BufferFillF32) {
+      VM_VerifyOperandRegRef("target_buffer");
+      VM_VerifyOperandRegI64("target_offset");
+      VM_VerifyOperandRegI64("length");
+      VM_VerifyOperandRegF32("value");
+      break;
+    }
+    VERIFY_OP(EXT_F32, BufferLoadF32) {
+      VM_VerifyOperandRegRef("source_buffer");
+      VM_VerifyOperandRegI64("source_offset");
+      VM_VerifyResultRegF32("result");
+      break;
+    }
+    VERIFY_OP(EXT_F32, BufferStoreF32) {
+      VM_VerifyOperandRegRef("target_buffer");
+      VM_VerifyOperandRegI64("target_offset");
+      VM_VerifyOperandRegF32("value");
+      break;
+    }
+
+    END_VERIFY_PREFIX();
+#else
+    UNHANDLED_VERIFY_PREFIX(PrefixExtF32, EXT_F32);
+#endif  // IREE_VM_EXT_F32_ENABLE
+
+    // The interpreter has no f64 implementation.
+    UNHANDLED_VERIFY_PREFIX(PrefixExtF64, EXT_F64);
+
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unsupported core opcode 0x%02X",
+                              bytecode_data[pc - 1]);
+  }
+  *out_next_pc = pc;
+  *out_is_terminator = is_terminator;
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Function verification
+//===----------------------------------------------------------------------===//
+
+// Returns true if all bytes from |pc| to the end of the function are zeros as
+// used to pad functions to their required alignment.
+static bool iree_vm_bytecode_is_trailing_padding(
+    const iree_vm_bytecode_verifier_t* verifier, iree_vm_source_offset_t pc) {
+  // Functions are padded to 8 byte alignment by the compiler.
+  if (verifier->bytecode_length - pc >= 8) return false;
+  for (; pc < verifier->bytecode_length; ++pc) {
+    if (verifier->bytecode_data[pc] != 0) return false;
+  }
+  return true;
+}
+
+static iree_status_t iree_vm_bytecode_verify_function(
+    iree_vm_bytecode_verifier_t* verifier) {
+  // Linear sweep over all instructions; functions contain no data other than
+  // instructions and trailing padding.
+  iree_vm_source_offset_t pc = 0;
+  bool is_terminator = false;
+  while (pc < verifier->bytecode_length) {
+    if (is_terminator && iree_vm_bytecode_is_trailing_padding(verifier, pc)) {
+      break;
+    }
+    iree_vm_bytecode_bitmap_set(verifier->instruction_starts, pc);
+    iree_status_t status =
+        iree_vm_bytecode_verify_op(verifier, pc, &pc, &is_terminator);
+    if (!iree_status_is_ok(status)) {
+      return iree_status_annotate_f(status, "at pc %" PRId64, pc);
+    }
+  }
+
+  // Execution must never be able to run off the end of the function.
+  if (IREE_UNLIKELY(!is_terminator)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "function does not end with a terminator");
+  }
+
+  // All branches must target the start of an instruction.
+  iree_host_size_t word_count = (verifier->bytecode_length + 31) / 32;
+  for (iree_host_size_t i = 0; i < word_count; ++i) {
+    uint32_t invalid_targets =
+        verifier->branch_targets[i] & ~verifier->instruction_starts[i];
+    if (IREE_UNLIKELY(invalid_targets)) {
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "branch target %" PRIhsz " is not at an instruction boundary",
+          i * 32 + iree_math_count_trailing_zeros_u32(invalid_targets));
+    }
+  }
+
+  return iree_ok_status();
+}
+
+iree_status_t iree_vm_bytecode_module_verify_bytecode(
+    iree_vm_BytecodeModuleDef_table_t module_def,
+    uint32_t* out_import_result_sizes, iree_allocator_t allocator) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_vm_bytecode_verifier_t verifier;
+  memset(&verifier, 0, sizeof(verifier));
+  verifier.type_count =
+      iree_vm_TypeDef_vec_len(iree_vm_BytecodeModuleDef_types(module_def));
+  iree_vm_ModuleStateDef_table_t module_state_def =
+      iree_vm_BytecodeModuleDef_module_state(module_def);
+  if (module_state_def) {
+    verifier.global_bytes_capacity =
+        iree_vm_ModuleStateDef_global_bytes_capacity(module_state_def);
+    verifier.global_ref_count =
+        iree_vm_ModuleStateDef_global_ref_count(module_state_def);
+  }
+  verifier.rodata_segment_count = iree_vm_RodataSegmentDef_vec_len(
+      iree_vm_BytecodeModuleDef_rodata_segments(module_def));
+  verifier.imported_functions =
+      iree_vm_BytecodeModuleDef_imported_functions(module_def);
+  iree_vm_FunctionDescriptor_vec_t function_descriptors =
+      iree_vm_BytecodeModuleDef_function_descriptors(module_def);
+  verifier.function_count =
+      iree_vm_FunctionDescriptor_vec_len(function_descriptors);
+  flatbuffers_uint8_vec_t bytecode_data =
+      iree_vm_BytecodeModuleDef_bytecode_data(module_def);
+
+  // Scratch storage for the signature table and the per-function bitmaps,
+  // which are sized for the largest function and reused.
+  iree_host_size_t max_bytecode_length = 0;
+  for (iree_host_size_t i = 0; i < verifier.function_count; ++i) {
+    max_bytecode_length = VMMAX(
+        max_bytecode_length,
+        (iree_host_size_t)iree_vm_FunctionDescriptor_vec_at(
+            function_descriptors, i)
+            ->bytecode_length);
+  }
+  iree_host_size_t bitmap_word_count = (max_bytecode_length + 31) / 32;
+  iree_host_size_t cconv_table_size =
+      verifier.function_count * sizeof(iree_string_view_t);
+  iree_host_size_t bitmap_size = bitmap_word_count * sizeof(uint32_t);
+  uint8_t* scratch = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(allocator, cconv_table_size + 2 * bitmap_size,
+                                (void**)&scratch));
+  memset(scratch, 0, cconv_table_size);
+  verifier.function_cconvs = (iree_string_view_t*)scratch;
+  verifier.instruction_starts = (uint32_t*)(scratch + cconv_table_size);
+  verifier.branch_targets =
+      (uint32_t*)(scratch + cconv_table_size + bitmap_size);
+
+  // Only exported functions carry signatures.
+  iree_vm_ExportFunctionDef_vec_t exported_functions =
+      iree_vm_BytecodeModuleDef_exported_functions(module_def);
+  for (iree_host_size_t i = 0;
+       i < iree_vm_ExportFunctionDef_vec_len(exported_functions); ++i) {
+    iree_vm_ExportFunctionDef_table_t export_def =
+        iree_vm_ExportFunctionDef_vec_at(exported_functions, i);
+    iree_vm_FunctionSignatureDef_table_t signature_def =
+        iree_vm_ExportFunctionDef_signature(export_def);
+    if (!signature_def) continue;
+    iree_string_view_t* cconv =
+        &verifier.function_cconvs[iree_vm_ExportFunctionDef_internal_ordinal(
+            export_def)];
+    if (cconv->data) continue;
+    flatbuffers_string_t calling_convention =
+        iree_vm_FunctionSignatureDef_calling_convention(signature_def);
+    *cconv = calling_convention
+                 ? iree_make_string_view(
+                       calling_convention,
+                       flatbuffers_string_len(calling_convention))
+                 : iree_make_cstring_view("");
+  }
+
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < verifier.function_count; ++i) {
+    iree_vm_FunctionDescriptor_struct_t function_descriptor =
+        iree_vm_FunctionDescriptor_vec_at(function_descriptors, i);
+    verifier.function_ordinal = i;
+    verifier.bytecode_data =
+        bytecode_data + function_descriptor->bytecode_offset;
+    verifier.bytecode_length = function_descriptor->bytecode_length;
+    verifier.i32_register_count = function_descriptor->i32_register_count;
+    verifier.ref_register_count = function_descriptor->ref_register_count;
+    verifier.import_result_size = 0;
+    memset(verifier.instruction_starts, 0, 2 * bitmap_size);
+    status = iree_vm_bytecode_verify_function(&verifier);
+    if (!iree_status_is_ok(status)) {
+      status = iree_status_annotate_f(status, "verifying functions[%" PRIhsz
+                                      "]", i);
+      break;
+    }
+    out_import_result_sizes[i] = (uint32_t)verifier.import_result_size;
+  }
+
+  iree_allocator_free(allocator, scratch);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -0,0 +1,48 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_VM_BYTECODE_VERIFIER_H_
+#define IREE_VM_BYTECODE_VERIFIER_H_
+
+#include "iree/base/api.h"
+#include "iree/vm/bytecode_module_impl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Verifies the bytecode of every function in |module_def|.
+// The FlatBuffer structure (including the function descriptor spans) must
+// already have been verified.
+//
+// Verification ensures that for every function:
+//  - each instruction is a supported opcode and fully decodes within the
+//    function bytecode span, ending in a terminator;
+//  - all register operands reference registers of the expected bank that are
+//    within the function register counts (with i64 registers 2-aligned);
+//  - all branch targets land on instruction boundaries;
+//  - static global, rodata, type, import, and function ordinals/offsets are in
+//    range of the module tables;
+//  - call and return register lists match the calling conventions of imports
+//    and exported functions when they are known.
+//
+// The interpreter relies on these invariants when
+// IREE_VM_BYTECODE_VERIFICATION_ENABLE is set and no longer checks them as
+// each operation is executed.
+//
+// |out_import_result_sizes| has one entry per function and receives the
+// largest size in bytes of the results of any import the function calls.
+//
+// |allocator| is used for scratch memory that is released before returning.
+iree_status_t iree_vm_bytecode_module_verify_bytecode(
+    iree_vm_BytecodeModuleDef_table_t module_def,
+    uint32_t* out_import_result_sizes, iree_allocator_t allocator);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_VM_BYTECODE_VERIFIER_H_
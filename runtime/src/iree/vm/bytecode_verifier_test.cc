@@ -0,0 +1,344 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Tests for the load-time bytecode verifier in bytecode_verifier.c.
+// Modules are built by hand such that iree_vm_bytecode_module_create can be
+// checked to reject malformed bytecode the compiler would never produce.
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/flatcc/building.h"
+#include "iree/schemas/bytecode_module_def_builder.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+#include "iree/vm/bytecode_module.h"
+
+namespace iree {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+// Matches IREE_VM_BYTECODE_VERSION_MAJOR in bytecode_module_impl.h.
+static const uint32_t kBytecodeVersion = 4u << 16;
+
+// Opcodes from iree/vm/generated/bytecode_op_table.h.
+static const uint8_t kOpConstI32 = 0x0D;
+static const uint8_t kOpAddI32 = 0x22;
+static const uint8_t kOpBranch = 0x56;
+static const uint8_t kOpReturn = 0x5A;
+static const uint8_t kOpReserved = 0x7F;
+
+// Ref registers are indicated by the high bit of the register ordinal.
+static const uint16_t kRefRegisterBit = 0x8000;
+
+// Encodes a function's bytecode as the compiler BytecodeEncoder would.
+class BytecodeWriter {
+ public:
+  BytecodeWriter& Op(uint8_t opcode) {
+    data_.push_back(opcode);
+    return *this;
+  }
+  BytecodeWriter& I32(uint32_t value) {
+    for (int i = 0; i < 4; ++i) data_.push_back((value >> (i * 8)) & 0xFF);
+    return *this;
+  }
+  BytecodeWriter& Reg(uint16_t reg) {
+    data_.push_back(reg & 0xFF);
+    data_.push_back(reg >> 8);
+    return *this;
+  }
+  // Register lists are 2-byte aligned and prefixed with their count.
+  BytecodeWriter& RegList(const std::vector<uint16_t>& regs) {
+    if (data_.size() % 2) data_.push_back(0);
+    Reg(static_cast<uint16_t>(regs.size()));
+    for (uint16_t reg : regs) Reg(reg);
+    return *this;
+  }
+  // Branch operand lists are 2-byte aligned src/dst register pairs prefixed
+  // with the pair count.
+  BytecodeWriter& RemapList(const std::vector<uint16_t>& src_dst_regs) {
+    if (data_.size() % 2) data_.push_back(0);
+    Reg(static_cast<uint16_t>(src_dst_regs.size() / 2));
+    for (uint16_t reg : src_dst_regs) Reg(reg);
+    return *this;
+  }
+  // Overwrites the i32 at |offset| such as to patch a forward branch target.
+  void PatchI32(size_t offset, uint32_t value) {
+    for (int i = 0; i < 4; ++i) data_[offset + i] = (value >> (i * 8)) & 0xFF;
+  }
+  // Pads to 8 bytes as the compiler does for each function.
+  BytecodeWriter& Pad() {
+    while (data_.size() % 8) data_.push_back(0);
+    return *this;
+  }
+  size_t size() const { return data_.size(); }
+  std::vector<uint8_t> data() const { return data_; }
+
+ private:
+  std::vector<uint8_t> data_;
+};
+
+struct TestFunction {
+  std::vector<uint8_t> bytecode;
+  uint16_t i32_register_count = 0;
+  uint16_t ref_register_count = 0;
+  // Calling convention of the function if exported or NULL if internal.
+  const char* export_cconv = NULL;
+};
+
+// Builds a module archive named `test` containing |functions|.
+static std::vector<uint8_t> BuildModule(
+    const std::vector<TestFunction>& functions) {
+  flatcc_builder_t builder;
+  flatcc_builder_init(&builder);
+  iree_vm_BytecodeModuleDef_start_as_root_with_size(&builder);
+
+  // Functions are placed at 8 byte aligned offsets.
+  std::vector<uint8_t> bytecode_data;
+  std::vector<iree_vm_FunctionDescriptor_t> descriptors(functions.size());
+  for (size_t i = 0; i < functions.size(); ++i) {
+    while (bytecode_data.size() % 8) bytecode_data.push_back(0);
+    iree_vm_FunctionDescriptor_assign(
+        &descriptors[i], static_cast<int32_t>(bytecode_data.size()),
+        static_cast<int32_t>(functions[i].bytecode.size()),
+        functions[i].i32_register_count, functions[i].ref_register_count);
+    bytecode_data.insert(bytecode_data.end(), functions[i].bytecode.begin(),
+                         functions[i].bytecode.end());
+  }
+  flatbuffers_uint8_vec_ref_t bytecode_data_ref = flatbuffers_uint8_vec_create(
+      &builder, bytecode_data.data(), bytecode_data.size());
+  iree_vm_FunctionDescriptor_vec_ref_t descriptors_ref =
+      iree_vm_FunctionDescriptor_vec_create(&builder, descriptors.data(),
+                                            descriptors.size());
+
+  std::vector<iree_vm_ExportFunctionDef_ref_t> export_refs;
+  for (size_t i = 0; i < functions.size(); ++i) {
+    if (!functions[i].export_cconv) continue;
+    char local_name[16];
+    snprintf(local_name, sizeof(local_name), "fn%zu", i);
+    flatbuffers_string_ref_t local_name_ref =
+        flatbuffers_string_create_str(&builder, local_name);
+    flatbuffers_string_ref_t cconv_ref =
+        flatbuffers_string_create_str(&builder, functions[i].export_cconv);
+    iree_vm_FunctionSignatureDef_start(&builder);
+    iree_vm_FunctionSignatureDef_calling_convention_add(&builder, cconv_ref);
+    iree_vm_FunctionSignatureDef_ref_t signature_ref =
+        iree_vm_FunctionSignatureDef_end(&builder);
+    iree_vm_ExportFunctionDef_start(&builder);
+    iree_vm_ExportFunctionDef_local_name_add(&builder, local_name_ref);
+    iree_vm_ExportFunctionDef_signature_add(&builder, signature_ref);
+    iree_vm_ExportFunctionDef_internal_ordinal_add(&builder,
+                                                   static_cast<int32_t>(i));
+    export_refs.push_back(iree_vm_ExportFunctionDef_end(&builder));
+  }
+  iree_vm_ExportFunctionDef_vec_ref_t exports_ref =
+      iree_vm_ExportFunctionDef_vec_create(&builder, export_refs.data(),
+                                           export_refs.size());
+
+  flatbuffers_string_ref_t name_ref =
+      flatbuffers_string_create_str(&builder, "test");
+  iree_vm_BytecodeModuleDef_name_add(&builder, name_ref);
+  iree_vm_BytecodeModuleDef_exported_functions_add(&builder, exports_ref);
+  iree_vm_BytecodeModuleDef_function_descriptors_add(&builder,
+                                                     descriptors_ref);
+  iree_vm_BytecodeModuleDef_bytecode_version_add(&builder, kBytecodeVersion);
+  iree_vm_BytecodeModuleDef_bytecode_data_add(&builder, bytecode_data_ref);
+  iree_vm_BytecodeModuleDef_end_as_root(&builder);
+
+  size_t buffer_size = 0;
+  void* buffer = flatcc_builder_finalize_aligned_buffer(&builder, &buffer_size);
+  std::vector<uint8_t> archive((uint8_t*)buffer,
+                               (uint8_t*)buffer + buffer_size);
+  flatcc_builder_aligned_free(buffer);
+  flatcc_builder_clear(&builder);
+  return archive;
+}
+
+class VMBytecodeVerifierTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+#if !IREE_VM_BYTECODE_VERIFICATION_ENABLE
+    GTEST_SKIP() << "bytecode verification disabled in this build";
+#endif  // !IREE_VM_BYTECODE_VERIFICATION_ENABLE
+  }
+
+  // Loads a module containing |functions| and returns the load status.
+  Status Load(const std::vector<TestFunction>& functions) {
+    archive_ = BuildModule(functions);
+    iree_vm_module_t* module = NULL;
+    iree_status_t status = iree_vm_bytecode_module_create(
+        iree_make_const_byte_span(archive_.data(), archive_.size()),
+        iree_allocator_null(), iree_allocator_system(), &module);
+    iree_vm_module_release(module);
+    return Status(status);
+  }
+
+  // Returns a function that computes `1 + 2` and returns it through a branch.
+  static TestFunction MakeValidFunction() {
+    BytecodeWriter w;
+    w.Op(kOpConstI32).I32(1).Reg(0);
+    w.Op(kOpConstI32).I32(2).Reg(1);
+    w.Op(kOpAddI32).Reg(0).Reg(1).Reg(2);
+    w.Op(kOpBranch);
+    size_t branch_target_offset = w.size();
+    w.I32(0).RemapList({});
+    w.PatchI32(branch_target_offset, static_cast<uint32_t>(w.size()));
+    w.Op(kOpReturn).RegList({2}).Pad();
+    TestFunction function;
+    function.bytecode = w.data();
+    function.i32_register_count = 3;
+    function.export_cconv = "0v_i";
+    return function;
+  }
+
+  std::vector<uint8_t> archive_;
+};
+
+TEST_F(VMBytecodeVerifierTest, ValidFunction) {
+  IREE_EXPECT_OK(Load({MakeValidFunction()}));
+}
+
+TEST_F(VMBytecodeVerifierTest, InternalFunctionWithoutSignature) {
+  TestFunction function = MakeValidFunction();
+  function.export_cconv = NULL;
+  IREE_EXPECT_OK(Load({MakeValidFunction(), function}));
+}
+
+TEST_F(VMBytecodeVerifierTest, ResultRegisterOutOfRange) {
+  BytecodeWriter w;
+  w.Op(kOpConstI32).I32(1).Reg(5);
+  w.Op(kOpReturn).RegList({}).Pad();
+  TestFunction function;
+  function.bytecode = w.data();
+  function.i32_register_count = 1;
+  EXPECT_THAT(Load({function}), StatusIs(StatusCode::kOutOfRange));
+}
+
+TEST_F(VMBytecodeVerifierTest, OperandRegisterOutOfRange) {
+  BytecodeWriter w;
+  w.Op(kOpAddI32).Reg(0).Reg(3).Reg(0);
+  w.Op(kOpReturn).RegList({}).Pad();
+  TestFunction function;
+  function.bytecode = w.data();
+  function.i32_register_count = 2;
+  EXPECT_THAT(Load({function}), StatusIs(StatusCode::kOutOfRange));
+}
+
+TEST_F(VMBytecodeVerifierTest, RefRegisterOutOfRange) {
+  BytecodeWriter w;
+  w.Op(kOpReturn).RegList({kRefRegisterBit | 1}).Pad();
+  TestFunction function;
+  function.bytecode = w.data();
+  function.ref_register_count = 1;
+  EXPECT_THAT(Load({function}), StatusIs(StatusCode::kOutOfRange));
+}
+
+TEST_F(VMBytecodeVerifierTest, RegisterBankMismatch) {
+  BytecodeWriter w;
+  w.Op(kOpConstI32).I32(1).Reg(kRefRegisterBit | 0);
+  w.Op(kOpReturn).RegList({}).Pad();
+  TestFunction function;
+  function.bytecode = w.data();
+  function.i32_register_count = 1;
+  function.ref_register_count = 1;
+  EXPECT_THAT(Load({function}), StatusIs(StatusCode::kInvalidArgument));
+}
+
+TEST_F(VMBytecodeVerifierTest, BranchTargetOutOfRange) {
+  BytecodeWriter w;
+  w.Op(kOpBranch).I32(1000).RemapList({});
+  w.Op(kOpReturn).RegList({}).Pad();
+  TestFunction function;
+  function.bytecode = w.data();
+  EXPECT_THAT(Load({function}), StatusIs(StatusCode::kOutOfRange));
+}
+
+TEST_F(VMBytecodeVerifierTest, BranchTargetMidInstruction) {
+  BytecodeWriter w;
+  w.Op(kOpConstI32).I32(1).Reg(0);
+  w.Op(kOpBranch).I32(2).RemapList({});
+  w.Op(kOpReturn).RegList({}).Pad();
+  TestFunction function;
+  function.bytecode = w.data();
+  function.i32_register_count = 1;
+  EXPECT_THAT(Load({function}), StatusIs(StatusCode::kInvalidArgument));
+}
+
+TEST_F(VMBytecodeVerifierTest, BranchOperandOutOfRange) {
+  BytecodeWriter w;
+  w.Op(kOpBranch).I32(12).RemapList({0, 4});  // remap r0 -> r4
+  w.Op(kOpReturn).RegList({}).Pad();
+  TestFunction function;
+  function.bytecode = w.data();
+  function.i32_register_count = 1;
+  EXPECT_THAT(Load({function}), StatusIs(StatusCode::kOutOfRange));
+}
+
+TEST_F(VMBytecodeVerifierTest, TruncatedOperand) {
+  BytecodeWriter w;
+  w.Op(kOpReturn).RegList({}).Pad();
+  TestFunction function;
+  function.bytecode = w.data();
+  // Overwrite the padding with a const whose value runs off the end.
+  function.bytecode[4] = kOpConstI32;
+  function.bytecode[5] = 1;
+  function.i32_register_count = 1;
+  EXPECT_THAT(Load({function}), StatusIs(StatusCode::kInvalidArgument));
+}
+
+TEST_F(VMBytecodeVerifierTest, TruncatedRegisterList) {
+  BytecodeWriter w;
+  w.Op(kOpReturn).RegList({0, 0});
+  TestFunction function;
+  function.bytecode = w.data();
+  function.bytecode.resize(function.bytecode.size() - 2);
+  function.i32_register_count = 1;
+  EXPECT_THAT(Load({function}), StatusIs(StatusCode::kInvalidArgument));
+}
+
+TEST_F(VMBytecodeVerifierTest, MissingTerminator) {
+  BytecodeWriter w;
+  w.Op(kOpConstI32).I32(1).Reg(0);
+  TestFunction function;
+  function.bytecode = w.data();
+  function.i32_register_count = 1;
+  EXPECT_THAT(Load({function}), StatusIs(StatusCode::kInvalidArgument));
+}
+
+TEST_F(VMBytecodeVerifierTest, UnsupportedOpcode) {
+  BytecodeWriter w;
+  w.Op(kOpReserved);
+  w.Op(kOpReturn).RegList({}).Pad();
+  TestFunction function;
+  function.bytecode = w.data();
+  EXPECT_THAT(Load({function}), StatusIs(StatusCode::kUnimplemented));
+}
+
+TEST_F(VMBytecodeVerifierTest, ReturnCountMismatch) {
+  BytecodeWriter w;
+  w.Op(kOpReturn).RegList({}).Pad();
+  TestFunction function;
+  function.bytecode = w.data();
+  function.export_cconv = "0v_i";
+  EXPECT_THAT(Load({function}), StatusIs(StatusCode::kInvalidArgument));
+}
+
+TEST_F(VMBytecodeVerifierTest, ReturnTypeMismatch) {
+  BytecodeWriter w;
+  w.Op(kOpReturn).RegList({kRefRegisterBit | 0}).Pad();
+  TestFunction function;
+  function.bytecode = w.data();
+  function.ref_register_count = 1;
+  function.export_cconv = "0v_i";
+  EXPECT_THAT(Load({function}), StatusIs(StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace iree
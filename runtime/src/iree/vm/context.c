@@ -32,6 +32,13 @@ struct iree_vm_context_t {
   // Configuration flags.
   iree_vm_context_flags_t flags;
 
+  // Execution profile when IREE_VM_CONTEXT_FLAG_PROFILE_EXECUTION is set.
+  iree_vm_profile_t* profile;
+
+  // Context this one was forked from, if any. Retained for the lifetime of
+  // the fork as module states may share objects with the parent states.
+  iree_vm_context_t* parent;
+
   struct {
     iree_host_size_t count;
     iree_host_size_t capacity;
@@ -208,6 +215,7 @@ static void iree_vm_context_release_modules(iree_vm_context_t* context,
           ? IREE_VM_INVOCATION_FLAG_TRACE_EXECUTION
           : IREE_VM_INVOCATION_FLAG_NONE,
       iree_vm_context_state_resolver(context), context->allocator);
+  iree_vm_stack_set_profile(stack, context->profile);
   for (int i = (int)end; i >= (int)start; --i) {
     iree_vm_module_t* module = context->list.modules[i];
     iree_vm_module_state_t* module_state = context->list.module_states[i];
@@ -249,21 +257,19 @@ IREE_API_EXPORT iree_status_t iree_vm_context_create(
       out_context);
 }
 
-IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
+// Allocates a context with inline storage for |module_count| modules.
+// The context is frozen and static if |module_count| is non-zero.
+static iree_status_t iree_vm_context_allocate(
     iree_vm_instance_t* instance, iree_vm_context_flags_t flags,
-    iree_host_size_t module_count, iree_vm_module_t** modules,
-    iree_allocator_t allocator, iree_vm_context_t** out_context) {
-  IREE_TRACE_ZONE_BEGIN(z0);
-  IREE_ASSERT_ARGUMENT(out_context);
-  *out_context = NULL;
-
+    iree_host_size_t module_count, iree_allocator_t allocator,
+    iree_vm_context_t** out_context) {
   iree_host_size_t context_size =
       sizeof(iree_vm_context_t) + sizeof(iree_vm_module_t*) * module_count +
       sizeof(iree_vm_module_state_t*) * module_count;
 
   iree_vm_context_t* context = NULL;
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_allocator_malloc(allocator, context_size, (void**)&context));
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(allocator, context_size, (void**)&context));
   iree_atomic_ref_count_init(&context->ref_count);
   context->instance = instance;
   iree_vm_instance_retain(context->instance);
@@ -284,6 +290,34 @@ IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
   context->list.count = 0;
   context->list.capacity = module_count;
 
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+  if (flags & IREE_VM_CONTEXT_FLAG_PROFILE_EXECUTION) {
+    iree_status_t profile_status =
+        iree_vm_profile_allocate(allocator, &context->profile);
+    if (!iree_status_is_ok(profile_status)) {
+      iree_vm_context_destroy(context);
+      return profile_status;
+    }
+  }
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
+
+  *out_context = context;
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
+    iree_vm_instance_t* instance, iree_vm_context_flags_t flags,
+    iree_host_size_t module_count, iree_vm_module_t** modules,
+    iree_allocator_t allocator, iree_vm_context_t** out_context) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_ASSERT_ARGUMENT(out_context);
+  *out_context = NULL;
+
+  iree_vm_context_t* context = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_context_allocate(instance, flags, module_count, allocator,
+                                   &context));
+
   iree_status_t register_status =
       iree_vm_context_register_modules(context, module_count, modules);
   if (!iree_status_is_ok(register_status)) {
@@ -297,6 +331,81 @@ IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
   return iree_ok_status();
 }
 
+IREE_API_EXPORT iree_status_t
+iree_vm_context_fork(iree_vm_context_t* parent, iree_allocator_t allocator,
+                     iree_vm_context_t** out_context) {
+  IREE_ASSERT_ARGUMENT(parent);
+  IREE_ASSERT_ARGUMENT(out_context);
+  *out_context = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_host_size_t module_count = parent->list.count;
+  iree_vm_context_t* context = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_context_allocate(parent->instance, parent->flags,
+                                   module_count, allocator, &context));
+  context->is_frozen = 1;
+  context->parent = parent;
+  iree_vm_context_retain(context->parent);
+
+  // VM stack used to call into module __init methods of unforkable modules.
+  IREE_VM_INLINE_STACK_INITIALIZE(
+      stack,
+      context->flags & IREE_VM_CONTEXT_FLAG_TRACE_EXECUTION
+          ? IREE_VM_INVOCATION_FLAG_TRACE_EXECUTION
+          : IREE_VM_INVOCATION_FLAG_NONE,
+      iree_vm_context_state_resolver(context), context->allocator);
+  iree_vm_stack_set_profile(stack, context->profile);
+
+  // Fork module state in registration order so that imports resolve as they
+  // did in the parent.
+  iree_status_t status = iree_ok_status();
+  iree_host_size_t i = 0;
+  for (i = 0; i < module_count; ++i) {
+    iree_vm_module_t* module = parent->list.modules[i];
+    context->list.modules[i] = module;
+    context->list.module_states[i] = NULL;
+    iree_vm_module_retain(module);
+
+    iree_vm_module_state_t* module_state = NULL;
+    if (module->fork_state) {
+      status = module->fork_state(module->self, parent->list.module_states[i],
+                                  context->allocator, &module_state);
+    } else {
+      status =
+          module->alloc_state(module->self, context->allocator, &module_state);
+    }
+    if (!iree_status_is_ok(status)) break;
+    context->list.module_states[i] = module_state;
+
+    status =
+        iree_vm_context_resolve_module_imports(context, module, module_state);
+    if (!iree_status_is_ok(status)) break;
+
+    ++context->list.count;
+
+    if (!module->fork_state) {
+      status = iree_vm_context_run_function(context, stack, module,
+                                            iree_make_cstring_view("__init"));
+      if (!iree_status_is_ok(status)) break;
+    }
+  }
+
+  iree_vm_stack_deinitialize(stack);
+
+  if (!iree_status_is_ok(status)) {
+    iree_vm_context_release_modules(context, 0, i);
+    context->list.count = 0;
+    iree_vm_context_destroy(context);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  *out_context = context;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 static void iree_vm_context_destroy(iree_vm_context_t* context) {
   if (!context) return;
 
@@ -315,6 +424,13 @@ static void iree_vm_context_destroy(iree_vm_context_t* context) {
     context->list.module_states = NULL;
   }
 
+  iree_vm_profile_free(context->profile);
+  context->profile = NULL;
+
+  // Released after the module states as they may reference the parent states.
+  iree_vm_context_release(context->parent);
+  context->parent = NULL;
+
   iree_vm_instance_release(context->instance);
   context->instance = NULL;
 
@@ -349,6 +465,25 @@ iree_vm_context_flags(const iree_vm_context_t* context) {
   return context->flags;
 }
 
+IREE_API_EXPORT iree_vm_profile_t* iree_vm_context_profile(
+    const iree_vm_context_t* context) {
+  IREE_ASSERT_ARGUMENT(context);
+  return context->profile;
+}
+
+IREE_API_EXPORT iree_host_size_t
+iree_vm_context_module_count(const iree_vm_context_t* context) {
+  IREE_ASSERT_ARGUMENT(context);
+  return context->list.count;
+}
+
+IREE_API_EXPORT iree_vm_module_t* iree_vm_context_module_at(
+    const iree_vm_context_t* context, iree_host_size_t i) {
+  IREE_ASSERT_ARGUMENT(context);
+  if (i >= context->list.count) return NULL;
+  return context->list.modules[i];
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_context_register_modules(
     iree_vm_context_t* context, iree_host_size_t module_count,
     iree_vm_module_t** modules) {
@@ -412,6 +547,7 @@ IREE_API_EXPORT iree_status_t iree_vm_context_register_modules(
           ? IREE_VM_INVOCATION_FLAG_TRACE_EXECUTION
           : IREE_VM_INVOCATION_FLAG_NONE,
       iree_vm_context_state_resolver(context), context->allocator);
+  iree_vm_stack_set_profile(stack, context->profile);
 
   // Retain all modules and allocate their state.
   assert(context->list.capacity >= context->list.count + module_count);
@@ -626,6 +762,7 @@ IREE_API_EXPORT iree_status_t iree_vm_context_notify(iree_vm_context_t* context,
           ? IREE_VM_INVOCATION_FLAG_TRACE_EXECUTION
           : IREE_VM_INVOCATION_FLAG_NONE,
       iree_vm_context_state_resolver(context), context->allocator);
+  iree_vm_stack_set_profile(stack, context->profile);
 
   // Resumes are walked forward while suspends are walked backward.
   // This follows the expected construction/destruction pattern where for
@@ -47,6 +47,14 @@ enum iree_vm_context_flag_bits_t {
   // is not performed by the context and callers must ensure the executing
   // programs support concurrency.
   IREE_VM_CONTEXT_FLAG_CONCURRENT = 1u << 1,
+
+  // Enables instruction-level profiling of execution (when available).
+  // See iree/base/config.h for the flags that control whether this
+  // functionality is available; specifically:
+  //   -DIREE_VM_EXECUTION_PROFILING_ENABLE=1
+  // All invocations made to this context - including initializers - will be
+  // recorded into the profile returned by `iree_vm_context_profile`.
+  IREE_VM_CONTEXT_FLAG_PROFILE_EXECUTION = 1u << 2,
 };
 typedef uint32_t iree_vm_context_flags_t;
 
@@ -68,6 +76,28 @@ IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
     iree_host_size_t module_count, iree_vm_module_t** modules,
     iree_allocator_t allocator, iree_vm_context_t** out_context);
 
+// Forks |parent| into a new context that shares its modules and immutable
+// state. Modules implementing `fork_state` start from a copy of the parent
+// module state. For bytecode modules primitive globals are copied and ref
+// globals only assigned by initializers are retained such that the objects
+// they reference (weights, executables, etc) are shared without duplication.
+// Ref globals stored to after initialization are cloned when they reference VM
+// buffers and otherwise fail the fork with IREE_STATUS_FAILED_PRECONDITION as
+// objects such as HAL buffers cannot be safely copied; null values are always
+// allowed.
+// Modules without `fork_state` get new state and have their initializers run.
+//
+// Forking is intended for serving one program from many threads: fork one
+// context per thread (or per concurrent request) and invoke each fork
+// independently. The parent must not be executing or modified while it is
+// being forked. Forks are frozen and cannot have additional modules
+// registered. The fork retains |parent| until it is destroyed and callers may
+// release their reference to the parent at any time.
+// |out_context| must be released by the caller.
+IREE_API_EXPORT iree_status_t
+iree_vm_context_fork(iree_vm_context_t* parent, iree_allocator_t allocator,
+                     iree_vm_context_t** out_context);
+
 // Retains the given |context| for the caller.
 IREE_API_EXPORT void iree_vm_context_retain(iree_vm_context_t* context);
 
@@ -82,6 +112,22 @@ iree_vm_context_id(const iree_vm_context_t* context);
 IREE_API_EXPORT iree_vm_context_flags_t
 iree_vm_context_flags(const iree_vm_context_t* context);
 
+// Returns the execution profile of |context| or NULL if the context was not
+// created with IREE_VM_CONTEXT_FLAG_PROFILE_EXECUTION or profiling is not
+// available in this build.
+IREE_API_EXPORT iree_vm_profile_t* iree_vm_context_profile(
+    const iree_vm_context_t* context);
+
+// Returns the total number of modules registered.
+IREE_API_EXPORT iree_host_size_t
+iree_vm_context_module_count(const iree_vm_context_t* context);
+
+// Returns the module registered at index |i|, or NULL if out of range.
+// Modules are stored in registration order and the returned pointer is owned by
+// the context.
+IREE_API_EXPORT iree_vm_module_t* iree_vm_context_module_at(
+    const iree_vm_context_t* context, iree_host_size_t i);
+
 // Registers a list of modules with the context and resolves imports in the
 // order provided.
 // The modules will be retained by the context until destruction.
@@ -126,14 +126,14 @@ typedef enum {
   IREE_VM_OP_CORE_BufferFillI64 = 0x74,
   IREE_VM_OP_CORE_CtlzI32 = 0x75,
   IREE_VM_OP_CORE_CtlzI64 = 0x76,
-  IREE_VM_OP_CORE_RSV_0x77,
-  IREE_VM_OP_CORE_RSV_0x78,
-  IREE_VM_OP_CORE_RSV_0x79,
-  IREE_VM_OP_CORE_RSV_0x7A,
-  IREE_VM_OP_CORE_RSV_0x7B,
-  IREE_VM_OP_CORE_RSV_0x7C,
-  IREE_VM_OP_CORE_RSV_0x7D,
-  IREE_VM_OP_CORE_RSV_0x7E,
+  IREE_VM_OP_CORE_CondBranchCmpEQI32 = 0x77,
+  IREE_VM_OP_CORE_CondBranchCmpNEI32 = 0x78,
+  IREE_VM_OP_CORE_CondBranchCmpLTI32S = 0x79,
+  IREE_VM_OP_CORE_CondBranchCmpLTI32U = 0x7A,
+  IREE_VM_OP_CORE_CondBranchCmpEQI64 = 0x7B,
+  IREE_VM_OP_CORE_CondBranchCmpNEI64 = 0x7C,
+  IREE_VM_OP_CORE_CondBranchCmpLTI64S = 0x7D,
+  IREE_VM_OP_CORE_CondBranchCmpLTI64U = 0x7E,
   IREE_VM_OP_CORE_RSV_0x7F,
   IREE_VM_OP_CORE_RSV_0x80,
   IREE_VM_OP_CORE_RSV_0x81,
@@ -385,14 +385,14 @@ typedef enum {
     OPC(0x74, BufferFillI64) \
     OPC(0x75, CtlzI32) \
     OPC(0x76, CtlzI64) \
-    RSV(0x77) \
-    RSV(0x78) \
-    RSV(0x79) \
-    RSV(0x7A) \
-    RSV(0x7B) \
-    RSV(0x7C) \
-    RSV(0x7D) \
-    RSV(0x7E) \
+    OPC(0x77, CondBranchCmpEQI32) \
+    OPC(0x78, CondBranchCmpNEI32) \
+    OPC(0x79, CondBranchCmpLTI32S) \
+    OPC(0x7A, CondBranchCmpLTI32U) \
+    OPC(0x7B, CondBranchCmpEQI64) \
+    OPC(0x7C, CondBranchCmpNEI64) \
+    OPC(0x7D, CondBranchCmpLTI64S) \
+    OPC(0x7E, CondBranchCmpLTI64U) \
     RSV(0x7F) \
     RSV(0x80) \
     RSV(0x81) \
@@ -433,6 +433,7 @@ IREE_API_EXPORT iree_status_t iree_vm_begin_invoke(
                   sizeof(state->stack_storage) - result_storage_size),
               flags, iree_vm_context_state_resolver(context), host_allocator,
               &stack));
+  iree_vm_stack_set_profile(stack, iree_vm_context_profile(context));
 
   // NOTE: at this point the stack must be properly deinitialized if we bail.
 
@@ -471,23 +472,27 @@ IREE_API_EXPORT iree_status_t iree_vm_begin_invoke(
   return iree_ok_status();
 }
 
+// Resumes execution of |stack| until it completes, yields, or fails.
+// |inout_status| holds the status of the invocation as with
+// iree_vm_invoke_state_t::status and |results| receives the results of the
+// outermost frame.
+//
 // WARNING: this function cannot have any trace markers that span the resume
 // call; the resume may yield with zones still open.
-IREE_API_EXPORT iree_status_t
-iree_vm_resume_invoke(iree_vm_invoke_state_t* state) {
-  IREE_ASSERT_ARGUMENT(state);
-
+static iree_status_t iree_vm_invoke_resume_stack(iree_vm_stack_t* stack,
+                                                 iree_byte_span_t results,
+                                                 iree_status_t* inout_status) {
   // In a stackless world resuming may pop a stack frame that needs to be
   // executed inline. We run here until either all stack frames have been popped
   // (indicating the invocation has completed) or we yield/error and want to
   // return to the scheduler.
   do {
-    if (iree_status_is_deferred(state->status)) {
+    if (iree_status_is_deferred(*inout_status)) {
       // Wait required; top of the stack should be a wait frame.
-      IREE_ASSERT_EQ(iree_vm_stack_current_frame(state->stack)->type,
+      IREE_ASSERT_EQ(iree_vm_stack_current_frame(stack)->type,
                      IREE_VM_STACK_FRAME_WAIT);
       return iree_status_from_code(IREE_STATUS_DEFERRED);
-    } else if (!iree_status_is_ok(state->status)) {
+    } else if (!iree_status_is_ok(*inout_status)) {
       // Invocation previously failed so return immediately. The user should
       // then call end() to get the result. By returning OK here we are telling
       // the user the resume operation succeeded.
@@ -495,7 +500,7 @@ iree_vm_resume_invoke(iree_vm_invoke_state_t* state) {
     }
 
     // Get the top execution frame of the stack where we will resume execution.
-    iree_vm_stack_frame_t* resume_frame = iree_vm_stack_top(state->stack);
+    iree_vm_stack_frame_t* resume_frame = iree_vm_stack_top(stack);
     if (IREE_UNLIKELY(!resume_frame)) {
       return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
                               "resume called with no parent frame");
@@ -505,11 +510,11 @@ iree_vm_resume_invoke(iree_vm_invoke_state_t* state) {
     // defer to be waited/resumed later, or fail.
     iree_vm_function_t resume_function = resume_frame->function;
     iree_vm_execution_result_t result;
-    state->status = resume_function.module->resume_call(
-        resume_function.module->self, state->stack, state->results, &result);
+    *inout_status = resume_function.module->resume_call(
+        resume_function.module->self, stack, results, &result);
 
     // If the call yielded then return that so the user knows to resume again.
-    if (iree_status_is_deferred(state->status)) {
+    if (iree_status_is_deferred(*inout_status)) {
       return iree_status_from_code(IREE_STATUS_DEFERRED);
     }
 
@@ -520,27 +525,27 @@ iree_vm_resume_invoke(iree_vm_invoke_state_t* state) {
     // got to continue running. To keep the trace cleaner and reduce overhead we
     // jump back up and pop the next frame, which also helps us avoid
     // introducing latency between pops where otherwise there should be none.
-  } while (iree_status_is_ok(state->status) &&
-           iree_vm_stack_current_frame(state->stack) != NULL);
+  } while (iree_status_is_ok(*inout_status) &&
+           iree_vm_stack_current_frame(stack) != NULL);
 
   // We're indicating the resume operation was successful, not the result of the
   // VM call; the user will call end() to get that.
   return iree_ok_status();
 }
 
+// WARNING: this function cannot have any trace markers that span the resume
+// call; the resume may yield with zones still open.
 IREE_API_EXPORT iree_status_t
-iree_vm_wait_invoke(iree_vm_invoke_state_t* state,
-                    iree_vm_wait_frame_t* wait_frame, iree_time_t deadline_ns) {
+iree_vm_resume_invoke(iree_vm_invoke_state_t* state) {
   IREE_ASSERT_ARGUMENT(state);
-  if (IREE_UNLIKELY(!iree_status_is_deferred(state->status))) {
-    // Can only wait if the invocation is actually waiting.
-    // We could make this OK and act as a no-op but it can be useful for
-    // ensuring scheduler implementations don't do extraneous work.
-    return iree_make_status(
-        IREE_STATUS_FAILED_PRECONDITION,
-        "wait-invoke attempted on a non-waiting invocation");
-  }
+  return iree_vm_invoke_resume_stack(state->stack, state->results,
+                                     &state->status);
+}
 
+// Synchronously performs the operation specified by |wait_frame| and stores
+// the result of the wait on the frame.
+static iree_status_t iree_vm_invoke_perform_wait(
+    iree_vm_wait_frame_t* wait_frame, iree_time_t deadline_ns) {
   // Combine the wait-invoke deadline with the one specified by the wait
   // operation itself. This allows schedulers to timeslice waits without
   // worrying whether user programs request to wait forever.
@@ -563,6 +568,23 @@ iree_vm_wait_invoke(iree_vm_invoke_state_t* state,
         IREE_STATUS_UNIMPLEMENTED,
         "multi-wait in synchronous invocations not yet implemented");
   }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t
+iree_vm_wait_invoke(iree_vm_invoke_state_t* state,
+                    iree_vm_wait_frame_t* wait_frame, iree_time_t deadline_ns) {
+  IREE_ASSERT_ARGUMENT(state);
+  if (IREE_UNLIKELY(!iree_status_is_deferred(state->status))) {
+    // Can only wait if the invocation is actually waiting.
+    // We could make this OK and act as a no-op but it can be useful for
+    // ensuring scheduler implementations don't do extraneous work.
+    return iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "wait-invoke attempted on a non-waiting invocation");
+  }
+
+  IREE_RETURN_IF_ERROR(iree_vm_invoke_perform_wait(wait_frame, deadline_ns));
 
   // Reset status to OK - the next resume will pick back up in the waiter.
   iree_status_free(state->status);
@@ -647,6 +669,399 @@ IREE_API_EXPORT void iree_vm_abort_invoke(iree_vm_invoke_state_t* state) {
   IREE_TRACE_ZONE_END(z0);
 }
 
+//===----------------------------------------------------------------------===//
+// Prepared synchronous invocation
+//===----------------------------------------------------------------------===//
+
+// Location of an argument or result value within the ABI buffers.
+typedef struct iree_vm_prepared_call_value_t {
+  // IREE_VM_CCONV_TYPE_* of the value.
+  char type;
+  // Byte offset of the value in the ABI buffer.
+  uint32_t offset;
+} iree_vm_prepared_call_value_t;
+
+struct iree_vm_prepared_call_t {
+  iree_allocator_t host_allocator;
+  // Retains the context the call is made within.
+  iree_vm_context_t* context;
+  iree_vm_function_t function;
+  iree_vm_invocation_flags_t flags;
+
+  iree_string_view_t cconv_arguments;
+  iree_host_size_t argument_count;
+  iree_vm_prepared_call_value_t* argument_values;
+  iree_byte_span_t arguments;
+
+  iree_string_view_t cconv_results;
+  iree_host_size_t result_count;
+  iree_vm_prepared_call_value_t* result_values;
+  iree_byte_span_t results;
+
+  // Storage for the VM stack reinitialized on each invocation.
+  iree_byte_span_t stack_storage;
+};
+
+// Populates |out_values| with the location of each value in |cconv_fragment|
+// and returns the number of values and the total ABI buffer size.
+static void iree_vm_prepared_call_layout_values(
+    iree_string_view_t cconv_fragment, iree_vm_prepared_call_value_t* values,
+    iree_host_size_t* out_count, iree_host_size_t* out_size) {
+  iree_host_size_t count = 0;
+  iree_host_size_t offset = 0;
+  for (iree_host_size_t i = 0; i < cconv_fragment.size; ++i) {
+    char type = cconv_fragment.data[i];
+    iree_host_size_t size = 0;
+    switch (type) {
+      default:
+      case IREE_VM_CCONV_TYPE_VOID:
+        continue;
+      case IREE_VM_CCONV_TYPE_I32:
+      case IREE_VM_CCONV_TYPE_F32:
+        size = sizeof(int32_t);
+        break;
+      case IREE_VM_CCONV_TYPE_I64:
+      case IREE_VM_CCONV_TYPE_F64:
+        size = sizeof(int64_t);
+        break;
+      case IREE_VM_CCONV_TYPE_REF:
+        size = sizeof(iree_vm_ref_t);
+        break;
+    }
+    if (values) {
+      values[count].type = type;
+      values[count].offset = (uint32_t)offset;
+    }
+    ++count;
+    offset += size;
+  }
+  *out_count = count;
+  *out_size = offset;
+}
+
+// Releases all refs in the ABI |storage| described by |values|.
+static void iree_vm_prepared_call_release_values(
+    iree_host_size_t count, const iree_vm_prepared_call_value_t* values,
+    iree_byte_span_t storage) {
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    if (values[i].type == IREE_VM_CCONV_TYPE_REF) {
+      iree_vm_ref_release((iree_vm_ref_t*)(storage.data + values[i].offset));
+    }
+  }
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_prepared_call_allocate(
+    iree_vm_context_t* context, iree_vm_function_t function,
+    iree_vm_invocation_flags_t flags, iree_host_size_t stack_size,
+    iree_allocator_t host_allocator, iree_vm_prepared_call_t** out_call) {
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(out_call);
+  *out_call = NULL;
+  if (stack_size < IREE_VM_STACK_MIN_SIZE) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "stack size under minimum required amount: %" PRIhsz " < %d",
+        stack_size, IREE_VM_STACK_MIN_SIZE);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Force tracing if specified on the context.
+  if (iree_vm_context_flags(context) & IREE_VM_CONTEXT_FLAG_TRACE_EXECUTION) {
+    flags |= IREE_VM_INVOCATION_FLAG_TRACE_EXECUTION;
+  }
+
+  iree_vm_function_signature_t signature =
+      iree_vm_function_signature(&function);
+  if (iree_vm_function_call_is_variadic_cconv(signature.calling_convention)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "prepared calls to variadic functions are not "
+                            "supported");
+  }
+  iree_string_view_t cconv_arguments = iree_string_view_empty();
+  iree_string_view_t cconv_results = iree_string_view_empty();
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_function_call_get_cconv_fragments(
+              &signature, &cconv_arguments, &cconv_results));
+
+  // Compute the layout of the values in the ABI buffers.
+  iree_host_size_t argument_count = 0;
+  iree_host_size_t argument_size = 0;
+  iree_vm_prepared_call_layout_values(cconv_arguments, NULL, &argument_count,
+                                      &argument_size);
+  iree_host_size_t result_count = 0;
+  iree_host_size_t result_size = 0;
+  iree_vm_prepared_call_layout_values(cconv_results, NULL, &result_count,
+                                      &result_size);
+
+  // Allocate everything in a single block:
+  // [call] [argument values] [result values] [arguments] [results] [stack]
+  iree_host_size_t argument_values_offset =
+      iree_host_align(sizeof(iree_vm_prepared_call_t), iree_max_align_t);
+  iree_host_size_t result_values_offset =
+      argument_values_offset +
+      argument_count * sizeof(iree_vm_prepared_call_value_t);
+  iree_host_size_t arguments_offset = iree_host_align(
+      result_values_offset +
+          result_count * sizeof(iree_vm_prepared_call_value_t),
+      iree_max_align_t);
+  iree_host_size_t results_offset =
+      iree_host_align(arguments_offset + argument_size, iree_max_align_t);
+  iree_host_size_t stack_offset =
+      iree_host_align(results_offset + result_size, iree_max_align_t);
+  iree_host_size_t total_size = stack_offset + stack_size;
+
+  iree_vm_prepared_call_t* call = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, total_size, (void**)&call));
+  uint8_t* base = (uint8_t*)call;
+  call->host_allocator = host_allocator;
+  call->context = context;
+  iree_vm_context_retain(context);
+  call->function = function;
+  call->flags = flags;
+  call->cconv_arguments = cconv_arguments;
+  call->argument_values =
+      (iree_vm_prepared_call_value_t*)(base + argument_values_offset);
+  iree_vm_prepared_call_layout_values(cconv_arguments, call->argument_values,
+                                      &call->argument_count, &argument_size);
+  call->arguments = iree_make_byte_span(base + arguments_offset, argument_size);
+  call->cconv_results = cconv_results;
+  call->result_values =
+      (iree_vm_prepared_call_value_t*)(base + result_values_offset);
+  iree_vm_prepared_call_layout_values(cconv_results, call->result_values,
+                                      &call->result_count, &result_size);
+  call->results = iree_make_byte_span(base + results_offset, result_size);
+  call->stack_storage = iree_make_byte_span(base + stack_offset, stack_size);
+
+  *out_call = call;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT void iree_vm_prepared_call_free(iree_vm_prepared_call_t* call) {
+  if (!call) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_vm_prepared_call_release_values(call->argument_count,
+                                       call->argument_values, call->arguments);
+  iree_vm_prepared_call_release_values(call->result_count, call->result_values,
+                                       call->results);
+  iree_vm_context_release(call->context);
+  iree_allocator_free(call->host_allocator, call);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT iree_host_size_t
+iree_vm_prepared_call_argument_count(const iree_vm_prepared_call_t* call) {
+  IREE_ASSERT_ARGUMENT(call);
+  return call->argument_count;
+}
+
+IREE_API_EXPORT iree_host_size_t
+iree_vm_prepared_call_result_count(const iree_vm_prepared_call_t* call) {
+  IREE_ASSERT_ARGUMENT(call);
+  return call->result_count;
+}
+
+// Returns a pointer to the storage of value |i| of |type| in |storage|.
+static iree_status_t iree_vm_prepared_call_lookup_value(
+    iree_host_size_t count, const iree_vm_prepared_call_value_t* values,
+    iree_byte_span_t storage, iree_host_size_t i, char type, void** out_ptr) {
+  if (IREE_UNLIKELY(i >= count)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "value index %" PRIhsz " out of range (%" PRIhsz
+                            " values)",
+                            i, count);
+  } else if (IREE_UNLIKELY(values[i].type != type)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "value %" PRIhsz " type mismatch; expected '%c' "
+                            "but the function signature has '%c'",
+                            i, type, values[i].type);
+  }
+  *out_ptr = storage.data + values[i].offset;
+  return iree_ok_status();
+}
+
+#define IREE_VM_PREPARED_CALL_PRIMITIVE_ACCESSORS(suffix, type, cconv_type)   \
+  IREE_API_EXPORT iree_status_t iree_vm_prepared_call_set_##suffix(           \
+      iree_vm_prepared_call_t* call, iree_host_size_t i, type value) {        \
+    IREE_ASSERT_ARGUMENT(call);                                               \
+    void* ptr = NULL;                                                         \
+    IREE_RETURN_IF_ERROR(iree_vm_prepared_call_lookup_value(                  \
+        call->argument_count, call->argument_values, call->arguments, i,      \
+        cconv_type, &ptr));                                                   \
+    memcpy(ptr, &value, sizeof(value));                                       \
+    return iree_ok_status();                                                  \
+  }                                                                           \
+  IREE_API_EXPORT iree_status_t iree_vm_prepared_call_get_##suffix(           \
+      const iree_vm_prepared_call_t* call, iree_host_size_t i,                \
+      type* out_value) {                                                      \
+    IREE_ASSERT_ARGUMENT(call);                                               \
+    IREE_ASSERT_ARGUMENT(out_value);                                          \
+    void* ptr = NULL;                                                         \
+    IREE_RETURN_IF_ERROR(iree_vm_prepared_call_lookup_value(                  \
+        call->result_count, call->result_values, call->results, i,            \
+        cconv_type, &ptr));                                                   \
+    memcpy(out_value, ptr, sizeof(*out_value));                               \
+    return iree_ok_status();                                                  \
+  }
+IREE_VM_PREPARED_CALL_PRIMITIVE_ACCESSORS(i32, int32_t, IREE_VM_CCONV_TYPE_I32)
+IREE_VM_PREPARED_CALL_PRIMITIVE_ACCESSORS(i64, int64_t, IREE_VM_CCONV_TYPE_I64)
+IREE_VM_PREPARED_CALL_PRIMITIVE_ACCESSORS(f32, float, IREE_VM_CCONV_TYPE_F32)
+IREE_VM_PREPARED_CALL_PRIMITIVE_ACCESSORS(f64, double, IREE_VM_CCONV_TYPE_F64)
+#undef IREE_VM_PREPARED_CALL_PRIMITIVE_ACCESSORS
+
+IREE_API_EXPORT iree_status_t iree_vm_prepared_call_set_ref_retain(
+    iree_vm_prepared_call_t* call, iree_host_size_t i, iree_vm_ref_t* ref) {
+  IREE_ASSERT_ARGUMENT(call);
+  IREE_ASSERT_ARGUMENT(ref);
+  void* ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_prepared_call_lookup_value(
+      call->argument_count, call->argument_values, call->arguments, i,
+      IREE_VM_CCONV_TYPE_REF, &ptr));
+  iree_vm_ref_retain(ref, (iree_vm_ref_t*)ptr);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_prepared_call_set_ref_move(
+    iree_vm_prepared_call_t* call, iree_host_size_t i, iree_vm_ref_t* ref) {
+  IREE_ASSERT_ARGUMENT(call);
+  IREE_ASSERT_ARGUMENT(ref);
+  void* ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_prepared_call_lookup_value(
+      call->argument_count, call->argument_values, call->arguments, i,
+      IREE_VM_CCONV_TYPE_REF, &ptr));
+  iree_vm_ref_move(ref, (iree_vm_ref_t*)ptr);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_prepared_call_set_inputs(
+    iree_vm_prepared_call_t* call, const iree_vm_list_t* inputs) {
+  IREE_ASSERT_ARGUMENT(call);
+  iree_vm_prepared_call_release_values(call->argument_count,
+                                       call->argument_values, call->arguments);
+  iree_status_t status = iree_vm_invoke_marshal_inputs(call->cconv_arguments,
+                                                       inputs, call->arguments);
+  if (!iree_status_is_ok(status)) {
+    iree_vm_prepared_call_release_values(
+        call->argument_count, call->argument_values, call->arguments);
+  }
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t
+iree_vm_prepared_call_invoke(iree_vm_prepared_call_t* call) {
+  IREE_ASSERT_ARGUMENT(call);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Drop the results of the previous invocation; the callee expects zeroed
+  // result storage.
+  iree_vm_prepared_call_release_values(call->result_count, call->result_values,
+                                       call->results);
+  memset(call->results.data, 0, call->results.data_length);
+
+  // Reinitialize the stack on the prepared storage. This only allocates if the
+  // invocation exceeds the prepared stack size.
+  iree_vm_stack_t* stack = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_stack_initialize(
+              call->stack_storage, call->flags,
+              iree_vm_context_state_resolver(call->context),
+              call->host_allocator, &stack));
+  iree_vm_stack_set_profile(stack, iree_vm_context_profile(call->context));
+
+  // NOTE: we must end the zone here as the begin_call will return with
+  // unbalanced zones if we yield.
+  IREE_TRACE_ZONE_END(z0);
+
+  // Run the invocation to completion, performing waits synchronously.
+  iree_vm_function_call_t function_call = {
+      .function = call->function,
+      .arguments = call->arguments,
+      .results = call->results,
+  };
+  iree_vm_execution_result_t result;
+  iree_status_t invoke_status = call->function.module->begin_call(
+      call->function.module->self, stack, &function_call, &result);
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_deferred(invoke_status)) {
+    iree_vm_stack_frame_t* current_frame = iree_vm_stack_current_frame(stack);
+    if (IREE_UNLIKELY(!current_frame)) {
+      status = iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                                "unbalanced stack after yield");
+      break;
+    } else if (current_frame->type == IREE_VM_STACK_FRAME_WAIT) {
+      iree_status_free(invoke_status);
+      invoke_status = iree_ok_status();
+      status = iree_vm_invoke_perform_wait(
+          (iree_vm_wait_frame_t*)iree_vm_stack_frame_storage(current_frame),
+          IREE_TIME_INFINITE_FUTURE);
+      if (!iree_status_is_ok(status)) break;
+    } else {
+      iree_status_free(invoke_status);
+      invoke_status = iree_ok_status();
+    }
+    status = iree_vm_invoke_resume_stack(stack, call->results, &invoke_status);
+    if (!iree_status_is_ok(status) && !iree_status_is_deferred(status)) break;
+    iree_status_ignore(status);
+    status = iree_ok_status();
+  }
+  iree_vm_stack_suspend_trace_zones(stack);
+
+  IREE_TRACE_ZONE_BEGIN_NAMED(z1, "iree_vm_prepared_call_end");
+  if (iree_status_is_ok(status) && !iree_status_is_ok(invoke_status)) {
+    // Annotate failures with the stack trace (if compiled in).
+    status =
+        IREE_VM_STACK_ANNOTATE_BACKTRACE_IF_ENABLED(stack, invoke_status);
+    invoke_status = iree_ok_status();
+  }
+  iree_status_ignore(invoke_status);
+  iree_vm_stack_deinitialize(stack);
+
+  // Ref arguments are consumed by the invocation (or dropped if it failed) and
+  // results are only valid if the invocation succeeded.
+  iree_vm_prepared_call_release_values(call->argument_count,
+                                       call->argument_values, call->arguments);
+  if (!iree_status_is_ok(status)) {
+    iree_vm_prepared_call_release_values(
+        call->result_count, call->result_values, call->results);
+  }
+
+  IREE_TRACE_ZONE_END(z1);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_prepared_call_get_ref_retain(
+    iree_vm_prepared_call_t* call, iree_host_size_t i, iree_vm_ref_t* out_ref) {
+  IREE_ASSERT_ARGUMENT(call);
+  IREE_ASSERT_ARGUMENT(out_ref);
+  void* ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_prepared_call_lookup_value(
+      call->result_count, call->result_values, call->results, i,
+      IREE_VM_CCONV_TYPE_REF, &ptr));
+  iree_vm_ref_retain((iree_vm_ref_t*)ptr, out_ref);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_prepared_call_get_ref_move(
+    iree_vm_prepared_call_t* call, iree_host_size_t i, iree_vm_ref_t* out_ref) {
+  IREE_ASSERT_ARGUMENT(call);
+  IREE_ASSERT_ARGUMENT(out_ref);
+  void* ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_prepared_call_lookup_value(
+      call->result_count, call->result_values, call->results, i,
+      IREE_VM_CCONV_TYPE_REF, &ptr));
+  iree_vm_ref_move((iree_vm_ref_t*)ptr, out_ref);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_prepared_call_get_outputs(
+    iree_vm_prepared_call_t* call, iree_vm_list_t* outputs) {
+  IREE_ASSERT_ARGUMENT(call);
+  return iree_vm_invoke_marshal_outputs(call->cconv_results, call->results,
+                                        outputs);
+}
+
 //===----------------------------------------------------------------------===//
 // Loop-based asynchronous invocation
 //===----------------------------------------------------------------------===//
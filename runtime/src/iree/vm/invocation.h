@@ -177,6 +177,118 @@ IREE_API_EXPORT iree_status_t iree_vm_end_invoke(iree_vm_invoke_state_t* state,
 // succeeded then iree_vm_end_invoke must be used instead.
 IREE_API_EXPORT void iree_vm_abort_invoke(iree_vm_invoke_state_t* state);
 
+//===----------------------------------------------------------------------===//
+// Prepared synchronous invocation
+//===----------------------------------------------------------------------===//
+
+// A synchronous invocation of a single function that can be repeated without
+// allocating. All storage required for the call - the VM stack, the argument
+// and result buffers, and the marshaling tables - is allocated once when the
+// call is prepared and reused by each invocation. Arguments and results are
+// accessed by index directly in the VM ABI buffers and no iree_vm_list_t is
+// required.
+//
+// The stack is not grown beyond |stack_size| without allocating; size it for
+// the deepest call chain of the function to keep the steady state
+// allocation-free.
+//
+// Usage:
+//   iree_vm_prepared_call_t* call = NULL;
+//   iree_vm_prepared_call_allocate(context, function, flags,
+//                                  IREE_VM_STACK_DEFAULT_SIZE, allocator,
+//                                  &call);
+//   for (...) {
+//     iree_vm_prepared_call_set_i32(call, 0, x);
+//     iree_vm_prepared_call_set_ref_retain(call, 1, &buffer_view_ref);
+//     IREE_RETURN_IF_ERROR(iree_vm_prepared_call_invoke(call));
+//     iree_vm_prepared_call_get_ref_move(call, 0, &result_ref);
+//   }
+//   iree_vm_prepared_call_free(call);
+//
+// Thread-compatible: a prepared call may be invoked from any thread but only
+// one invocation may be in-flight at a time. Callers making concurrent calls
+// should prepare one call per thread.
+typedef struct iree_vm_prepared_call_t iree_vm_prepared_call_t;
+
+// Prepares a reusable call to |function| in |context|.
+// The context is retained for the lifetime of the call. |stack_size| bytes of
+// VM stack storage are allocated from |host_allocator| along with the call
+// and must be at least IREE_VM_STACK_MIN_SIZE.
+//
+// Variadic functions are not supported.
+IREE_API_EXPORT iree_status_t iree_vm_prepared_call_allocate(
+    iree_vm_context_t* context, iree_vm_function_t function,
+    iree_vm_invocation_flags_t flags, iree_host_size_t stack_size,
+    iree_allocator_t host_allocator, iree_vm_prepared_call_t** out_call);
+
+// Frees |call| and releases any arguments and results it holds.
+IREE_API_EXPORT void iree_vm_prepared_call_free(iree_vm_prepared_call_t* call);
+
+// Returns the number of arguments the function takes.
+IREE_API_EXPORT iree_host_size_t
+iree_vm_prepared_call_argument_count(const iree_vm_prepared_call_t* call);
+
+// Returns the number of results the function produces.
+IREE_API_EXPORT iree_host_size_t
+iree_vm_prepared_call_result_count(const iree_vm_prepared_call_t* call);
+
+// Sets the primitive argument at |i| to |value|. The argument type must match
+// the function signature. Primitive arguments keep their value across
+// invocations.
+IREE_API_EXPORT iree_status_t iree_vm_prepared_call_set_i32(
+    iree_vm_prepared_call_t* call, iree_host_size_t i, int32_t value);
+IREE_API_EXPORT iree_status_t iree_vm_prepared_call_set_i64(
+    iree_vm_prepared_call_t* call, iree_host_size_t i, int64_t value);
+IREE_API_EXPORT iree_status_t iree_vm_prepared_call_set_f32(
+    iree_vm_prepared_call_t* call, iree_host_size_t i, float value);
+IREE_API_EXPORT iree_status_t iree_vm_prepared_call_set_f64(
+    iree_vm_prepared_call_t* call, iree_host_size_t i, double value);
+
+// Sets the ref argument at |i| to |ref|, retaining or moving it into the call.
+// Ref arguments are consumed by each invocation and must be set again before
+// the next invoke.
+IREE_API_EXPORT iree_status_t iree_vm_prepared_call_set_ref_retain(
+    iree_vm_prepared_call_t* call, iree_host_size_t i, iree_vm_ref_t* ref);
+IREE_API_EXPORT iree_status_t iree_vm_prepared_call_set_ref_move(
+    iree_vm_prepared_call_t* call, iree_host_size_t i, iree_vm_ref_t* ref);
+
+// Sets all arguments from the values in |inputs| as with iree_vm_invoke.
+IREE_API_EXPORT iree_status_t iree_vm_prepared_call_set_inputs(
+    iree_vm_prepared_call_t* call, const iree_vm_list_t* inputs);
+
+// Synchronously invokes the function with the current arguments.
+// The function will be run to completion and may block on external resources.
+// Results from any previous invocation are released and replaced with the new
+// results on success.
+IREE_API_EXPORT iree_status_t
+iree_vm_prepared_call_invoke(iree_vm_prepared_call_t* call);
+
+// Returns the primitive result at |i| from the last successful invocation.
+// The result type must match the function signature.
+IREE_API_EXPORT iree_status_t iree_vm_prepared_call_get_i32(
+    const iree_vm_prepared_call_t* call, iree_host_size_t i,
+    int32_t* out_value);
+IREE_API_EXPORT iree_status_t iree_vm_prepared_call_get_i64(
+    const iree_vm_prepared_call_t* call, iree_host_size_t i,
+    int64_t* out_value);
+IREE_API_EXPORT iree_status_t iree_vm_prepared_call_get_f32(
+    const iree_vm_prepared_call_t* call, iree_host_size_t i, float* out_value);
+IREE_API_EXPORT iree_status_t iree_vm_prepared_call_get_f64(
+    const iree_vm_prepared_call_t* call, iree_host_size_t i,
+    double* out_value);
+
+// Returns the ref result at |i| from the last successful invocation either
+// retained (leaving the result in the call) or moved out of the call.
+IREE_API_EXPORT iree_status_t iree_vm_prepared_call_get_ref_retain(
+    iree_vm_prepared_call_t* call, iree_host_size_t i, iree_vm_ref_t* out_ref);
+IREE_API_EXPORT iree_status_t iree_vm_prepared_call_get_ref_move(
+    iree_vm_prepared_call_t* call, iree_host_size_t i, iree_vm_ref_t* out_ref);
+
+// Moves all results of the last successful invocation into |outputs| as with
+// iree_vm_invoke.
+IREE_API_EXPORT iree_status_t iree_vm_prepared_call_get_outputs(
+    iree_vm_prepared_call_t* call, iree_vm_list_t* outputs);
+
 //===----------------------------------------------------------------------===//
 // Loop-based asynchronous invocation
 //===----------------------------------------------------------------------===//
@@ -345,6 +345,56 @@ static void iree_vm_list_convert_value_type(
   }
 }
 
+// Loads the |element_size| byte primitive at |element_ptr| into |out_value|.
+// The value storage of |out_value| must be zeroed.
+static inline void iree_vm_list_load_value_storage(
+    uintptr_t element_ptr, iree_host_size_t element_size,
+    iree_vm_value_t* out_value) {
+#if defined(IREE_ENDIANNESS_LITTLE)
+  // The narrower value members alias the low bytes of value_storage.
+  memcpy(out_value->value_storage, (const void*)element_ptr, element_size);
+#else
+  switch (element_size) {
+    case 1:
+      out_value->i8 = *(int8_t*)element_ptr;
+      break;
+    case 2:
+      out_value->i16 = *(int16_t*)element_ptr;
+      break;
+    case 4:
+      out_value->i32 = *(int32_t*)element_ptr;
+      break;
+    case 8:
+      out_value->i64 = *(int64_t*)element_ptr;
+      break;
+  }
+#endif  // IREE_ENDIANNESS_LITTLE
+}
+
+// Stores the low |element_size| bytes of |value| to |element_ptr|.
+static inline void iree_vm_list_store_value_storage(
+    const iree_vm_value_t* value, iree_host_size_t element_size,
+    uintptr_t element_ptr) {
+#if defined(IREE_ENDIANNESS_LITTLE)
+  memcpy((void*)element_ptr, value->value_storage, element_size);
+#else
+  switch (element_size) {
+    case 1:
+      *(int8_t*)element_ptr = value->i8;
+      break;
+    case 2:
+      *(int16_t*)element_ptr = value->i16;
+      break;
+    case 4:
+      *(int32_t*)element_ptr = value->i32;
+      break;
+    case 8:
+      *(int64_t*)element_ptr = value->i64;
+      break;
+  }
+#endif  // IREE_ENDIANNESS_LITTLE
+}
+
 IREE_API_EXPORT iree_status_t
 iree_vm_list_get_value(const iree_vm_list_t* list, iree_host_size_t i,
                        iree_vm_value_t* out_value) {
@@ -357,21 +407,8 @@ iree_vm_list_get_value(const iree_vm_list_t* list, iree_host_size_t i,
   switch (list->storage_mode) {
     case IREE_VM_LIST_STORAGE_MODE_VALUE: {
       out_value->type = list->element_type.value_type;
-      // TODO(benvanik): #ifdef on LITTLE/BIG_ENDIAN and just memcpy.
-      switch (list->element_size) {
-        case 1:
-          out_value->i8 = *(int8_t*)element_ptr;
-          break;
-        case 2:
-          out_value->i16 = *(int16_t*)element_ptr;
-          break;
-        case 4:
-          out_value->i32 = *(int32_t*)element_ptr;
-          break;
-        case 8:
-          out_value->i64 = *(int64_t*)element_ptr;
-          break;
-      }
+      iree_vm_list_load_value_storage(element_ptr, list->element_size,
+                                      out_value);
       break;
     }
     case IREE_VM_LIST_STORAGE_MODE_VARIANT: {
@@ -404,21 +441,7 @@ IREE_API_EXPORT iree_status_t iree_vm_list_get_value_as(
   switch (list->storage_mode) {
     case IREE_VM_LIST_STORAGE_MODE_VALUE: {
       value.type = list->element_type.value_type;
-      // TODO(benvanik): #ifdef on LITTLE/BIG_ENDIAN and just memcpy.
-      switch (list->element_size) {
-        case 1:
-          value.i8 = *(int8_t*)element_ptr;
-          break;
-        case 2:
-          value.i16 = *(int16_t*)element_ptr;
-          break;
-        case 4:
-          value.i32 = *(int32_t*)element_ptr;
-          break;
-        case 8:
-          value.i64 = *(int64_t*)element_ptr;
-          break;
-      }
+      iree_vm_list_load_value_storage(element_ptr, list->element_size, &value);
       break;
     }
     case IREE_VM_LIST_STORAGE_MODE_VARIANT: {
@@ -465,21 +488,8 @@ IREE_API_EXPORT iree_status_t iree_vm_list_set_value(
   uintptr_t element_ptr = (uintptr_t)list->storage + i * list->element_size;
   switch (list->storage_mode) {
     case IREE_VM_LIST_STORAGE_MODE_VALUE: {
-      // TODO(benvanik): #ifdef on LITTLE/BIG_ENDIAN and just memcpy.
-      switch (list->element_size) {
-        case 1:
-          *(int8_t*)element_ptr = converted_value.i8;
-          break;
-        case 2:
-          *(int16_t*)element_ptr = converted_value.i16;
-          break;
-        case 4:
-          *(int32_t*)element_ptr = converted_value.i32;
-          break;
-        case 8:
-          *(int64_t*)element_ptr = converted_value.i64;
-          break;
-      }
+      iree_vm_list_store_value_storage(&converted_value, list->element_size,
+                                       element_ptr);
       break;
     }
     case IREE_VM_LIST_STORAGE_MODE_VARIANT: {
@@ -507,6 +517,106 @@ iree_vm_list_push_value(iree_vm_list_t* list, const iree_vm_value_t* value) {
   return iree_vm_list_set_value(list, i, value);
 }
 
+// Returns true if |list| stores primitive values of exactly |value_type| such
+// that elements can be accessed directly as a dense array.
+static bool iree_vm_list_is_dense_value_type(const iree_vm_list_t* list,
+                                             iree_vm_value_type_t value_type) {
+  return list->storage_mode == IREE_VM_LIST_STORAGE_MODE_VALUE &&
+         list->element_type.value_type == value_type;
+}
+
+static iree_status_t iree_vm_list_verify_value_range(
+    const iree_vm_list_t* list, iree_host_size_t offset,
+    iree_host_size_t count, iree_vm_value_type_t value_type) {
+  if (offset > list->count || count > list->count - offset) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "range [%zu, %zu) out of bounds (%zu)", offset,
+                            offset + count, list->count);
+  }
+  if (iree_vm_value_type_size(value_type) == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "invalid value type %d", (int)value_type);
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_get_values(
+    const iree_vm_list_t* list, iree_host_size_t offset,
+    iree_host_size_t count, iree_vm_value_type_t value_type,
+    void* out_values) {
+  IREE_RETURN_IF_ERROR(
+      iree_vm_list_verify_value_range(list, offset, count, value_type));
+  iree_host_size_t value_size = iree_vm_value_type_size(value_type);
+  if (iree_vm_list_is_dense_value_type(list, value_type)) {
+    memcpy(out_values,
+           (const uint8_t*)list->storage + offset * list->element_size,
+           count * value_size);
+    return iree_ok_status();
+  }
+  uintptr_t value_ptr = (uintptr_t)out_values;
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    iree_vm_value_t value;
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_get_value_as(list, offset + i, value_type, &value));
+    iree_vm_list_store_value_storage(&value, value_size, value_ptr);
+    value_ptr += value_size;
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_set_values(
+    iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t count,
+    iree_vm_value_type_t value_type, const void* values) {
+  IREE_RETURN_IF_ERROR(
+      iree_vm_list_verify_value_range(list, offset, count, value_type));
+  iree_host_size_t value_size = iree_vm_value_type_size(value_type);
+  if (iree_vm_list_is_dense_value_type(list, value_type)) {
+    memcpy((uint8_t*)list->storage + offset * list->element_size, values,
+           count * value_size);
+    return iree_ok_status();
+  }
+  uintptr_t value_ptr = (uintptr_t)values;
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    iree_vm_value_t value;
+    value.type = value_type;
+    value.i64 = 0;
+    iree_vm_list_load_value_storage(value_ptr, value_size, &value);
+    IREE_RETURN_IF_ERROR(iree_vm_list_set_value(list, offset + i, &value));
+    value_ptr += value_size;
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_push_values(
+    iree_vm_list_t* list, iree_host_size_t count,
+    iree_vm_value_type_t value_type, const void* values) {
+  iree_host_size_t offset = iree_vm_list_size(list);
+  IREE_RETURN_IF_ERROR(iree_vm_list_resize(list, offset + count));
+  iree_status_t status =
+      iree_vm_list_set_values(list, offset, count, value_type, values);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(iree_vm_list_resize(list, offset));
+  }
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_map_values(
+    iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t count,
+    iree_vm_value_type_t value_type, iree_byte_span_t* out_span) {
+  *out_span = iree_make_byte_span(NULL, 0);
+  IREE_RETURN_IF_ERROR(
+      iree_vm_list_verify_value_range(list, offset, count, value_type));
+  if (!iree_vm_list_is_dense_value_type(list, value_type)) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "list does not store values of type %d densely",
+                            (int)value_type);
+  }
+  *out_span = iree_make_byte_span(
+      (uint8_t*)list->storage + offset * list->element_size,
+      count * list->element_size);
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT void* iree_vm_list_get_ref_deref(
     const iree_vm_list_t* list, iree_host_size_t i,
     const iree_vm_ref_type_descriptor_t* type_descriptor) {
@@ -121,6 +121,37 @@ IREE_API_EXPORT iree_status_t iree_vm_list_set_value(
 IREE_API_EXPORT iree_status_t
 iree_vm_list_push_value(iree_vm_list_t* list, const iree_vm_value_t* value);
 
+// Copies |count| elements starting at index |offset| into |out_values| as a
+// dense array of |value_type| elements. Lists storing |value_type| elements
+// are copied with a single memcpy while other lists convert each element using
+// the value type semantics as with iree_vm_list_get_value_as.
+IREE_API_EXPORT iree_status_t iree_vm_list_get_values(
+    const iree_vm_list_t* list, iree_host_size_t offset,
+    iree_host_size_t count, iree_vm_value_type_t value_type,
+    void* out_values);
+
+// Sets |count| elements starting at index |offset| from |values|, a dense
+// array of |value_type| elements. Lists storing |value_type| elements are
+// copied with a single memcpy while other lists convert each element using the
+// value type semantics as with iree_vm_list_set_value.
+IREE_API_EXPORT iree_status_t iree_vm_list_set_values(
+    iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t count,
+    iree_vm_value_type_t value_type, const void* values);
+
+// Pushes |count| elements from |values|, a dense array of |value_type|
+// elements, to the end of the list. The list is left unchanged on failure.
+IREE_API_EXPORT iree_status_t iree_vm_list_push_values(
+    iree_vm_list_t* list, iree_host_size_t count,
+    iree_vm_value_type_t value_type, const void* values);
+
+// Returns a view of |count| elements starting at index |offset| directly over
+// the list storage in |out_span|. Fails if the list does not store primitive
+// values of exactly |value_type|. The view is invalidated when the list is
+// reserved, resized, or released.
+IREE_API_EXPORT iree_status_t iree_vm_list_map_values(
+    iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t count,
+    iree_vm_value_type_t value_type, iree_byte_span_t* out_span);
+
 // Returns a dereferenced pointer to the given type if the element at the given
 // index matches the type. Returns NULL on error.
 IREE_API_EXPORT void* iree_vm_list_get_ref_deref(
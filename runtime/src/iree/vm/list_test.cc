@@ -227,6 +227,87 @@ TEST_F(VMListTest, Reserve) {
   iree_vm_list_release(list);
 }
 
+// Tests bulk access to primitive value lists with and without conversion.
+TEST_F(VMListTest, BulkValuesI32) {
+  iree_vm_type_def_t element_type =
+      iree_vm_type_def_make_value_type(IREE_VM_VALUE_TYPE_I32);
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(&element_type, 4, iree_allocator_system(), &list));
+
+  // Push [0, 5) as i32 (dense) and [5, 8) as i64 (converted).
+  const int32_t values_i32[5] = {0, 1, 2, 3, 4};
+  IREE_ASSERT_OK(iree_vm_list_push_values(list, 5, IREE_VM_VALUE_TYPE_I32,
+                                          values_i32));
+  const int64_t values_i64[3] = {5, 6, 7};
+  IREE_ASSERT_OK(iree_vm_list_push_values(list, 3, IREE_VM_VALUE_TYPE_I64,
+                                          values_i64));
+  EXPECT_EQ(8, iree_vm_list_size(list));
+
+  int32_t read_i32[8] = {0};
+  IREE_ASSERT_OK(
+      iree_vm_list_get_values(list, 0, 8, IREE_VM_VALUE_TYPE_I32, read_i32));
+  for (int32_t i = 0; i < 8; ++i) {
+    EXPECT_EQ(i, read_i32[i]);
+  }
+  int64_t read_i64[2] = {0};
+  IREE_ASSERT_OK(
+      iree_vm_list_get_values(list, 6, 2, IREE_VM_VALUE_TYPE_I64, read_i64));
+  EXPECT_EQ(6, read_i64[0]);
+  EXPECT_EQ(7, read_i64[1]);
+
+  // Mapped views alias the list storage.
+  iree_byte_span_t span;
+  IREE_ASSERT_OK(
+      iree_vm_list_map_values(list, 2, 3, IREE_VM_VALUE_TYPE_I32, &span));
+  ASSERT_EQ(3 * sizeof(int32_t), span.data_length);
+  int32_t* mapped_values = (int32_t*)span.data;
+  EXPECT_EQ(2, mapped_values[0]);
+  mapped_values[0] = 100;
+  iree_vm_value_t value;
+  IREE_ASSERT_OK(
+      iree_vm_list_get_value_as(list, 2, IREE_VM_VALUE_TYPE_I32, &value));
+  EXPECT_EQ(100, value.i32);
+  EXPECT_THAT(Status(iree_vm_list_map_values(list, 0, 1,
+                                             IREE_VM_VALUE_TYPE_I64, &span)),
+              StatusIs(iree::StatusCode::kFailedPrecondition));
+
+  // Out of range accesses fail without modifying the list.
+  EXPECT_THAT(Status(iree_vm_list_get_values(list, 6, 3,
+                                             IREE_VM_VALUE_TYPE_I32, read_i32)),
+              StatusIs(iree::StatusCode::kOutOfRange));
+  EXPECT_THAT(Status(iree_vm_list_set_values(
+                  list, 9, 0, IREE_VM_VALUE_TYPE_I32, values_i32)),
+              StatusIs(iree::StatusCode::kOutOfRange));
+  EXPECT_EQ(8, iree_vm_list_size(list));
+
+  iree_vm_list_release(list);
+}
+
+// Tests bulk access to variant lists, which converts each element.
+TEST_F(VMListTest, BulkValuesVariant) {
+  iree_vm_type_def_t element_type = iree_vm_type_def_make_variant_type();
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(&element_type, 4, iree_allocator_system(), &list));
+
+  const float values_f32[3] = {1.0f, 2.5f, -3.0f};
+  IREE_ASSERT_OK(iree_vm_list_push_values(list, 3, IREE_VM_VALUE_TYPE_F32,
+                                          values_f32));
+  float read_f32[3] = {0.0f};
+  IREE_ASSERT_OK(
+      iree_vm_list_get_values(list, 0, 3, IREE_VM_VALUE_TYPE_F32, read_f32));
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(values_f32[i], read_f32[i]);
+  }
+  iree_byte_span_t span;
+  EXPECT_THAT(Status(iree_vm_list_map_values(list, 0, 3,
+                                             IREE_VM_VALUE_TYPE_F32, &span)),
+              StatusIs(iree::StatusCode::kFailedPrecondition));
+
+  iree_vm_list_release(list);
+}
+
 // Tests the behavior of resize for truncation and extension on primitives.
 TEST_F(VMListTest, ResizeI32) {
   iree_vm_type_def_t element_type =
@@ -426,6 +426,22 @@ typedef struct iree_vm_module_t {
       void* self, iree_vm_function_linkage_t linkage, iree_host_size_t ordinal,
       iree_host_size_t index, iree_string_view_t* key,
       iree_string_view_t* value);
+
+  // Optional: allocates module state data for a forked context that starts
+  // from the current contents of |parent_module_state|. Immutable data (such as
+  // the objects referenced by globals) should be shared with the parent while
+  // any mutable data must be copied such that the child can execute
+  // concurrently with the parent and its other children. The module initializer
+  // is not run on forked state. If omitted forked contexts allocate new state
+  // and run the module initializer as if the module was newly registered.
+  // Returns IREE_STATUS_FAILED_PRECONDITION if the current state holds mutable
+  // data that cannot be copied, in which case the fork fails.
+  //
+  // NOTE: this is the last member so that the layout of the interface prior to
+  // its addition is unchanged.
+  iree_status_t(IREE_API_PTR* fork_state)(
+      void* self, iree_vm_module_state_t* parent_module_state,
+      iree_allocator_t allocator, iree_vm_module_state_t** out_module_state);
 } iree_vm_module_t;
 
 // Initializes the interface of a module handle.
@@ -0,0 +1,484 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/native_image.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "iree/base/tracing.h"
+#include "iree/vm/bytecode_module.h"
+
+// flatcc schemas:
+#include "iree/base/internal/flatcc/parsing.h"
+#include "iree/schemas/bytecode_module_def_reader.h"
+#include "iree/schemas/bytecode_module_def_verifier.h"
+
+// NOTE: native images use the host C ABI for all calls into and out of the
+// image. On Windows the embedded ELF ABI differs from the host ABI and the
+// image could only be called through thunks so native images are not
+// supported there.
+#if !defined(IREE_PLATFORM_WINDOWS)
+#define IREE_VM_NATIVE_IMAGE_SUPPORTED 1
+#endif  // !IREE_PLATFORM_WINDOWS
+
+//===----------------------------------------------------------------------===//
+// Target matching
+//===----------------------------------------------------------------------===//
+
+IREE_API_EXPORT bool iree_vm_native_image_is_target_supported(
+    iree_string_view_t target_triple) {
+#if defined(IREE_VM_NATIVE_IMAGE_SUPPORTED)
+  // Only the architecture component of the triple is checked: the images are
+  // freestanding and all OS interaction happens through the runtime.
+  iree_string_view_t arch = iree_string_view_empty();
+  iree_string_view_t remaining = iree_string_view_empty();
+  iree_string_view_split(target_triple, '-', &arch, &remaining);
+#if defined(IREE_ARCH_ARM_32)
+  return iree_string_view_starts_with(arch, IREE_SV("arm")) ||
+         iree_string_view_starts_with(arch, IREE_SV("thumb"));
+#elif defined(IREE_ARCH_ARM_64)
+  return iree_string_view_equal(arch, IREE_SV("aarch64")) ||
+         iree_string_view_equal(arch, IREE_SV("arm64"));
+#elif defined(IREE_ARCH_RISCV_32)
+  return iree_string_view_equal(arch, IREE_SV("riscv32"));
+#elif defined(IREE_ARCH_RISCV_64)
+  return iree_string_view_equal(arch, IREE_SV("riscv64"));
+#elif defined(IREE_ARCH_X86_32)
+  return iree_string_view_equal(arch, IREE_SV("i386")) ||
+         iree_string_view_equal(arch, IREE_SV("i686")) ||
+         iree_string_view_equal(arch, IREE_SV("x86"));
+#elif defined(IREE_ARCH_X86_64)
+  return iree_string_view_equal(arch, IREE_SV("x86_64")) ||
+         iree_string_view_equal(arch, IREE_SV("amd64"));
+#else
+  return false;
+#endif  // IREE_ARCH_*
+#else
+  return false;
+#endif  // IREE_VM_NATIVE_IMAGE_SUPPORTED
+}
+
+//===----------------------------------------------------------------------===//
+// Runtime imports
+//===----------------------------------------------------------------------===//
+
+// Native images are linked with -nostdlib and resolve everything the generated
+// C module code references against the hosting runtime. The set here must
+// cover all non-inline runtime functions used by the VM-to-C conversion and
+// vm/ops.h as well as the C library functions compilers may emit calls to.
+#define IREE_VM_NATIVE_IMAGE_IMPORT(fn) {#fn, (void*)&fn}
+static const iree_vm_native_image_import_t iree_vm_native_image_imports[] = {
+    // C library:
+    IREE_VM_NATIVE_IMAGE_IMPORT(memcmp),
+    IREE_VM_NATIVE_IMAGE_IMPORT(memcpy),
+    IREE_VM_NATIVE_IMAGE_IMPORT(memmove),
+    IREE_VM_NATIVE_IMAGE_IMPORT(memset),
+    IREE_VM_NATIVE_IMAGE_IMPORT(atan2f),
+    IREE_VM_NATIVE_IMAGE_IMPORT(atanf),
+    IREE_VM_NATIVE_IMAGE_IMPORT(ceilf),
+    IREE_VM_NATIVE_IMAGE_IMPORT(cosf),
+    IREE_VM_NATIVE_IMAGE_IMPORT(erff),
+    IREE_VM_NATIVE_IMAGE_IMPORT(exp2f),
+    IREE_VM_NATIVE_IMAGE_IMPORT(expf),
+    IREE_VM_NATIVE_IMAGE_IMPORT(expm1f),
+    IREE_VM_NATIVE_IMAGE_IMPORT(fabsf),
+    IREE_VM_NATIVE_IMAGE_IMPORT(floorf),
+    IREE_VM_NATIVE_IMAGE_IMPORT(fmaf),
+    IREE_VM_NATIVE_IMAGE_IMPORT(llroundf),
+    IREE_VM_NATIVE_IMAGE_IMPORT(log10f),
+    IREE_VM_NATIVE_IMAGE_IMPORT(log1pf),
+    IREE_VM_NATIVE_IMAGE_IMPORT(log2f),
+    IREE_VM_NATIVE_IMAGE_IMPORT(logf),
+    IREE_VM_NATIVE_IMAGE_IMPORT(lroundf),
+    IREE_VM_NATIVE_IMAGE_IMPORT(powf),
+    IREE_VM_NATIVE_IMAGE_IMPORT(remainderf),
+    IREE_VM_NATIVE_IMAGE_IMPORT(sinf),
+    IREE_VM_NATIVE_IMAGE_IMPORT(sqrtf),
+    IREE_VM_NATIVE_IMAGE_IMPORT(tanhf),
+
+    // iree/base/:
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_allocator_free),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_allocator_malloc),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_status_allocate),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_status_allocate_f),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_status_annotate_f),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_status_free),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_status_ignore),
+
+    // iree/vm/:
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_buffer_check_deref),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_buffer_deref),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_buffer_initialize),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_buffer_retain_ref),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_buffer_type_id),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_list_check_deref),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_list_create),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_list_deref),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_list_get_ref_retain),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_list_get_value_as),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_list_reserve),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_list_resize),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_list_retain_ref),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_list_set_ref_move),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_list_set_ref_retain),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_list_set_value),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_list_size),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_list_type_id),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_module_initialize),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_native_module_create),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_ref_assign),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_ref_equal),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_ref_lookup_registered_type),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_ref_move),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_ref_release),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_ref_retain),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_ref_retain_checked),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_ref_retain_or_move),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_ref_retain_or_move_checked),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_ref_wrap_assign),
+    IREE_VM_NATIVE_IMAGE_IMPORT(iree_vm_ref_wrap_retain),
+};
+#undef IREE_VM_NATIVE_IMAGE_IMPORT
+
+static const iree_vm_native_image_import_table_t
+    iree_vm_native_image_import_table = {
+        .count = IREE_ARRAYSIZE(iree_vm_native_image_imports),
+        .values = iree_vm_native_image_imports,
+};
+
+//===----------------------------------------------------------------------===//
+// iree_vm_native_image_module_t
+//===----------------------------------------------------------------------===//
+
+// Module owning a loaded native image and forwarding all calls to the module
+// created by the image. Functions returned from the module reference the inner
+// module directly so there's no additional overhead when calling them.
+typedef struct iree_vm_native_image_module_t {
+  iree_vm_module_t interface;
+  iree_allocator_t allocator;
+  // Module created by the image; released before the image is unloaded.
+  iree_vm_module_t* inner;
+  // Loader used to load the image; unloads |handle| when the module is
+  // destroyed.
+  iree_vm_native_image_loader_t loader;
+  // Loaded image containing the module code and data.
+  void* handle;
+} iree_vm_native_image_module_t;
+
+static void IREE_API_PTR iree_vm_native_image_module_destroy(void* self) {
+  iree_vm_native_image_module_t* module =
+      (iree_vm_native_image_module_t*)self;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_vm_module_release(module->inner);
+  module->loader.unload(module->loader.self, module->handle);
+  iree_allocator_free(module->allocator, module);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_string_view_t IREE_API_PTR
+iree_vm_native_image_module_name(void* self) {
+  iree_vm_native_image_module_t* module =
+      (iree_vm_native_image_module_t*)self;
+  return module->inner->name(module->inner->self);
+}
+
+static iree_vm_module_signature_t IREE_API_PTR
+iree_vm_native_image_module_signature(void* self) {
+  iree_vm_native_image_module_t* module =
+      (iree_vm_native_image_module_t*)self;
+  return module->inner->signature(module->inner->self);
+}
+
+static iree_status_t IREE_API_PTR iree_vm_native_image_module_get_function(
+    void* self, iree_vm_function_linkage_t linkage, iree_host_size_t ordinal,
+    iree_vm_function_t* out_function, iree_string_view_t* out_name,
+    iree_vm_function_signature_t* out_signature) {
+  iree_vm_native_image_module_t* module =
+      (iree_vm_native_image_module_t*)self;
+  return module->inner->get_function(module->inner->self, linkage, ordinal,
+                                     out_function, out_name, out_signature);
+}
+
+static iree_status_t IREE_API_PTR iree_vm_native_image_module_lookup_function(
+    void* self, iree_vm_function_linkage_t linkage, iree_string_view_t name,
+    iree_vm_function_t* out_function) {
+  iree_vm_native_image_module_t* module =
+      (iree_vm_native_image_module_t*)self;
+  return module->inner->lookup_function(module->inner->self, linkage, name,
+                                        out_function);
+}
+
+static iree_status_t IREE_API_PTR
+iree_vm_native_image_module_resolve_source_location(
+    void* self, iree_vm_stack_frame_t* frame,
+    iree_vm_source_location_t* out_source_location) {
+  iree_vm_native_image_module_t* module =
+      (iree_vm_native_image_module_t*)self;
+  if (!module->inner->resolve_source_location) {
+    return iree_status_from_code(IREE_STATUS_UNAVAILABLE);
+  }
+  return module->inner->resolve_source_location(module->inner->self, frame,
+                                                out_source_location);
+}
+
+static iree_status_t IREE_API_PTR iree_vm_native_image_module_alloc_state(
+    void* self, iree_allocator_t allocator,
+    iree_vm_module_state_t** out_module_state) {
+  iree_vm_native_image_module_t* module =
+      (iree_vm_native_image_module_t*)self;
+  return module->inner->alloc_state(module->inner->self, allocator,
+                                    out_module_state);
+}
+
+static iree_status_t IREE_API_PTR iree_vm_native_image_module_fork_state(
+    void* self, iree_vm_module_state_t* parent_module_state,
+    iree_allocator_t allocator, iree_vm_module_state_t** out_module_state) {
+  iree_vm_native_image_module_t* module =
+      (iree_vm_native_image_module_t*)self;
+  return module->inner->fork_state(module->inner->self, parent_module_state,
+                                   allocator, out_module_state);
+}
+
+static void IREE_API_PTR iree_vm_native_image_module_free_state(
+    void* self, iree_vm_module_state_t* module_state) {
+  iree_vm_native_image_module_t* module =
+      (iree_vm_native_image_module_t*)self;
+  module->inner->free_state(module->inner->self, module_state);
+}
+
+static iree_status_t IREE_API_PTR iree_vm_native_image_module_resolve_import(
+    void* self, iree_vm_module_state_t* module_state, iree_host_size_t ordinal,
+    const iree_vm_function_t* function,
+    const iree_vm_function_signature_t* signature) {
+  iree_vm_native_image_module_t* module =
+      (iree_vm_native_image_module_t*)self;
+  return module->inner->resolve_import(module->inner->self, module_state,
+                                       ordinal, function, signature);
+}
+
+static iree_status_t IREE_API_PTR iree_vm_native_image_module_notify(
+    void* self, iree_vm_module_state_t* module_state, iree_vm_signal_t signal) {
+  iree_vm_native_image_module_t* module =
+      (iree_vm_native_image_module_t*)self;
+  if (!module->inner->notify) return iree_ok_status();
+  return module->inner->notify(module->inner->self, module_state, signal);
+}
+
+static iree_status_t IREE_API_PTR iree_vm_native_image_module_begin_call(
+    void* self, iree_vm_stack_t* stack, const iree_vm_function_call_t* call,
+    iree_vm_execution_result_t* out_result) {
+  iree_vm_native_image_module_t* module =
+      (iree_vm_native_image_module_t*)self;
+  return module->inner->begin_call(module->inner->self, stack, call,
+                                   out_result);
+}
+
+static iree_status_t IREE_API_PTR iree_vm_native_image_module_resume_call(
+    void* self, iree_vm_stack_t* stack, iree_byte_span_t call_results,
+    iree_vm_execution_result_t* out_result) {
+  iree_vm_native_image_module_t* module =
+      (iree_vm_native_image_module_t*)self;
+  return module->inner->resume_call(module->inner->self, stack, call_results,
+                                    out_result);
+}
+
+static iree_status_t IREE_API_PTR
+iree_vm_native_image_module_get_function_reflection_attr(
+    void* self, iree_vm_function_linkage_t linkage, iree_host_size_t ordinal,
+    iree_host_size_t index, iree_string_view_t* key,
+    iree_string_view_t* value) {
+  iree_vm_native_image_module_t* module =
+      (iree_vm_native_image_module_t*)self;
+  if (!module->inner->get_function_reflection_attr) {
+    return iree_status_from_code(IREE_STATUS_NOT_FOUND);
+  }
+  return module->inner->get_function_reflection_attr(
+      module->inner->self, linkage, ordinal, index, key, value);
+}
+
+// Loads |image| and creates the module it contains.
+// |expected_name| must match the name of the module in the image to guard
+// against mismatched images.
+static iree_status_t iree_vm_native_image_module_load(
+    const iree_vm_native_image_loader_t* loader, iree_const_byte_span_t image,
+    iree_string_view_t expected_name, iree_allocator_t allocator,
+    iree_vm_module_t** out_module) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_vm_native_image_module_t* module = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(allocator, sizeof(*module), (void**)&module));
+  memset(module, 0, sizeof(*module));
+  module->allocator = allocator;
+  module->loader = *loader;
+
+  // Load the image into executable memory, resolving all runtime imports.
+  iree_status_t status =
+      loader->load(loader->self, image, &iree_vm_native_image_import_table,
+                   allocator, &module->handle);
+  if (!iree_status_is_ok(status)) {
+    iree_allocator_free(allocator, module);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  // Query the image interface.
+  iree_vm_native_image_query_fn_t query_fn = NULL;
+  status = loader->lookup_export(loader->self, module->handle,
+                                 IREE_VM_NATIVE_IMAGE_EXPORT_NAME,
+                                 (void**)&query_fn);
+  const iree_vm_native_image_v0_t* image_v0 = NULL;
+  if (iree_status_is_ok(status)) {
+    image_v0 = query_fn(IREE_VM_NATIVE_IMAGE_VERSION_LATEST);
+    if (!image_v0 || image_v0->version > IREE_VM_NATIVE_IMAGE_VERSION_LATEST) {
+      status = iree_make_status(
+          IREE_STATUS_FAILED_PRECONDITION,
+          "native image does not support runtime ABI version %u",
+          (uint32_t)IREE_VM_NATIVE_IMAGE_VERSION_LATEST);
+    } else if (!iree_string_view_equal(iree_make_cstring_view(image_v0->name),
+                                       expected_name)) {
+      status = iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "native image module '%s' does not match bytecode module '%.*s'",
+          image_v0->name, (int)expected_name.size, expected_name.data);
+    }
+  }
+
+  // Create the module implementation within the image.
+  if (iree_status_is_ok(status)) {
+    status = image_v0->create_module(allocator, &module->inner);
+  }
+
+  if (iree_status_is_ok(status)) {
+    iree_vm_module_initialize(&module->interface, module);
+    module->interface.destroy = iree_vm_native_image_module_destroy;
+    module->interface.name = iree_vm_native_image_module_name;
+    module->interface.signature = iree_vm_native_image_module_signature;
+    module->interface.get_function = iree_vm_native_image_module_get_function;
+    module->interface.lookup_function =
+        iree_vm_native_image_module_lookup_function;
+    module->interface.resolve_source_location =
+        iree_vm_native_image_module_resolve_source_location;
+    module->interface.alloc_state = iree_vm_native_image_module_alloc_state;
+    module->interface.free_state = iree_vm_native_image_module_free_state;
+    if (module->inner->fork_state) {
+      module->interface.fork_state = iree_vm_native_image_module_fork_state;
+    }
+    module->interface.resolve_import =
+        iree_vm_native_image_module_resolve_import;
+    module->interface.notify = iree_vm_native_image_module_notify;
+    module->interface.begin_call = iree_vm_native_image_module_begin_call;
+    module->interface.resume_call = iree_vm_native_image_module_resume_call;
+    module->interface.get_function_reflection_attr =
+        iree_vm_native_image_module_get_function_reflection_attr;
+    *out_module = &module->interface;
+  } else {
+    loader->unload(loader->self, module->handle);
+    iree_allocator_free(allocator, module);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Selects the first native image in |module_def| that can be loaded on the
+// host, if any.
+static iree_vm_NativeImageDef_table_t iree_vm_native_image_select(
+    iree_vm_BytecodeModuleDef_table_t module_def) {
+  iree_vm_NativeImageDef_vec_t native_images =
+      iree_vm_BytecodeModuleDef_native_images(module_def);
+  for (size_t i = 0; i < iree_vm_NativeImageDef_vec_len(native_images); ++i) {
+    iree_vm_NativeImageDef_table_t native_image =
+        iree_vm_NativeImageDef_vec_at(native_images, i);
+    flatbuffers_string_t target_triple =
+        iree_vm_NativeImageDef_target_triple(native_image);
+    if (iree_vm_NativeImageDef_abi_version(native_image) >
+        IREE_VM_NATIVE_IMAGE_VERSION_LATEST) {
+      continue;  // newer than this runtime
+    } else if (!flatbuffers_uint8_vec_len(
+                   iree_vm_NativeImageDef_image(native_image))) {
+      continue;  // empty image
+    } else if (!iree_vm_native_image_is_target_supported(
+                   iree_make_string_view(
+                       target_triple,
+                       flatbuffers_string_len(target_triple)))) {
+      continue;  // different architecture
+    }
+    return native_image;
+  }
+  return NULL;
+}
+
+// Loads the native image in |archive_contents| targeting the host, if any.
+// |out_module| is left NULL if there is no suitable image.
+static iree_status_t iree_vm_native_image_module_try_create(
+    iree_const_byte_span_t archive_contents, iree_allocator_t archive_allocator,
+    const iree_vm_native_image_loader_t* loader, iree_allocator_t allocator,
+    iree_vm_module_t** out_module) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_const_byte_span_t flatbuffer_contents = iree_const_byte_span_empty();
+  iree_host_size_t archive_rodata_offset = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_bytecode_module_parse_header(
+              archive_contents, &flatbuffer_contents, &archive_rodata_offset));
+
+  // Only the structure needed to find the native images is verified here; if
+  // we fall back to bytecode the bytecode module performs full verification.
+  int verify_ret = iree_vm_BytecodeModuleDef_verify_as_root(
+      flatbuffer_contents.data, flatbuffer_contents.data_length);
+  if (verify_ret != flatcc_verify_ok) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "FlatBuffer verification failed: %s",
+                            flatcc_verify_error_string(verify_ret));
+  }
+  iree_vm_BytecodeModuleDef_table_t module_def =
+      iree_vm_BytecodeModuleDef_as_root(flatbuffer_contents.data);
+
+  iree_status_t status = iree_ok_status();
+  iree_vm_NativeImageDef_table_t native_image =
+      iree_vm_native_image_select(module_def);
+  if (native_image) {
+    // The image targets the host: failures past this point indicate an
+    // invalid or incompatible module and are not hidden by falling back.
+    flatbuffers_string_t name = iree_vm_BytecodeModuleDef_name(module_def);
+    flatbuffers_uint8_vec_t image = iree_vm_NativeImageDef_image(native_image);
+    status = iree_vm_native_image_module_load(
+        loader,
+        iree_make_const_byte_span(image, flatbuffers_uint8_vec_len(image)),
+        iree_make_string_view(name, flatbuffers_string_len(name)), allocator,
+        out_module);
+    if (iree_status_is_ok(status)) {
+      // The image has been copied into its own pages and the archive is no
+      // longer needed.
+      iree_allocator_free(archive_allocator, (void*)archive_contents.data);
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_native_image_module_create(
+    iree_const_byte_span_t archive_contents, iree_allocator_t archive_allocator,
+    const iree_vm_native_image_loader_t* loader, iree_allocator_t allocator,
+    iree_vm_module_t** out_module) {
+  IREE_ASSERT_ARGUMENT(out_module);
+  *out_module = NULL;
+
+  // Native images are only used when the hosting application opts in by
+  // providing a loader.
+  if (loader) {
+    IREE_RETURN_IF_ERROR(iree_vm_native_image_module_try_create(
+        archive_contents, archive_allocator, loader, allocator, out_module));
+    if (*out_module) return iree_ok_status();
+  }
+
+  return iree_vm_bytecode_module_create(archive_contents, archive_allocator,
+                                        allocator, out_module);
+}
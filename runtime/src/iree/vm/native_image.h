@@ -0,0 +1,131 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_VM_NATIVE_IMAGE_H_
+#define IREE_VM_NATIVE_IMAGE_H_
+
+#include "iree/base/api.h"
+#include "iree/vm/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// Native image ABI
+//===----------------------------------------------------------------------===//
+
+// NOTE: this section is shared with the compiler-generated native image entry
+// point. Native images are compiled against the runtime VM headers and call
+// back into the hosting runtime for all of their dependencies, so any change
+// to the runtime VM/base API used by generated C modules must be versioned as
+// if this was a schema.
+
+// Known versions of the native image ABI.
+enum iree_vm_native_image_version_e {
+  // Initial version; native images export a query function returning a
+  // iree_vm_native_image_v0_t.
+  IREE_VM_NATIVE_IMAGE_VERSION_0 = 0u,
+
+  // The latest version; bumped when the runtime API used by the generated
+  // module code changes in an incompatible way.
+  IREE_VM_NATIVE_IMAGE_VERSION_LATEST = IREE_VM_NATIVE_IMAGE_VERSION_0,
+};
+typedef uint32_t iree_vm_native_image_version_t;
+
+// Name of the function exported from native images used to query the image
+// interface.
+#define IREE_VM_NATIVE_IMAGE_EXPORT_NAME "iree_vm_native_image_query"
+
+// Native image interface.
+typedef struct iree_vm_native_image_v0_t {
+  // ABI version the image was compiled against.
+  iree_vm_native_image_version_t version;
+  // Name of the module; must match the bytecode module name.
+  const char* name;
+  // Creates a new instance of the module. The returned module may reference
+  // code and data within the image and must be released before the image is
+  // unloaded.
+  iree_status_t(IREE_API_PTR* create_module)(iree_allocator_t allocator,
+                                             iree_vm_module_t** out_module);
+} iree_vm_native_image_v0_t;
+
+// Exported function returning the image interface for the requested
+// |max_version| or NULL if the version is not supported by the image.
+typedef const iree_vm_native_image_v0_t*(IREE_API_PTR*
+                                             iree_vm_native_image_query_fn_t)(
+    iree_vm_native_image_version_t max_version);
+
+//===----------------------------------------------------------------------===//
+// Native image loader
+//===----------------------------------------------------------------------===//
+
+// A runtime symbol that native images may import.
+typedef struct iree_vm_native_image_import_t {
+  // Name of the symbol as referenced by the image.
+  const char* name;
+  // Host address of the symbol.
+  void* address;
+} iree_vm_native_image_import_t;
+
+// Table of runtime symbols provided to native images.
+typedef struct iree_vm_native_image_import_table_t {
+  iree_host_size_t count;
+  const iree_vm_native_image_import_t* values;
+} iree_vm_native_image_import_table_t;
+
+// Loads native image code into executable memory.
+// The VM does not contain any object file loader itself and hosting
+// applications provide one (such as the one in iree/hal/local/elf/) when they
+// want to allow native images to be used. Native code is not verified like
+// bytecode is and hosting applications should only provide a loader when the
+// modules being loaded are trusted.
+typedef struct iree_vm_native_image_loader_t {
+  // Loader-defined user data passed to all functions.
+  void* self;
+
+  // Loads |image| into executable memory resolving any imports from
+  // |import_table| and returns an opaque handle to the loaded image.
+  iree_status_t(IREE_API_PTR* load)(
+      void* self, iree_const_byte_span_t image,
+      const iree_vm_native_image_import_table_t* import_table,
+      iree_allocator_t host_allocator, void** out_handle);
+
+  // Returns the host address of the exported |symbol_name| in a loaded image.
+  iree_status_t(IREE_API_PTR* lookup_export)(void* self, void* handle,
+                                             const char* symbol_name,
+                                             void** out_address);
+
+  // Unloads an image returned from |load|. Invalidates all addresses
+  // previously returned from |lookup_export|.
+  void(IREE_API_PTR* unload)(void* self, void* handle);
+} iree_vm_native_image_loader_t;
+
+// Creates a VM module from an in-memory ModuleDef FlatBuffer archive
+// preferring an ahead-of-time compiled native image embedded in the archive
+// over the bytecode interpreter. When no |loader| is provided, no embedded
+// image targets the host, or native images are not supported on the host
+// platform the module is created with iree_vm_bytecode_module_create.
+//
+// If a |archive_allocator| is provided then it will be used to free the
+// |archive_contents| once they are no longer required (immediately after
+// loading a native image or when the bytecode module is destroyed) and
+// otherwise the ownership of the memory remains with the caller.
+IREE_API_EXPORT iree_status_t iree_vm_native_image_module_create(
+    iree_const_byte_span_t archive_contents, iree_allocator_t archive_allocator,
+    const iree_vm_native_image_loader_t* loader, iree_allocator_t allocator,
+    iree_vm_module_t** out_module);
+
+// Returns true if native images compiled for |target_triple| can be loaded on
+// the host.
+IREE_API_EXPORT bool iree_vm_native_image_is_target_supported(
+    iree_string_view_t target_triple);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_VM_NATIVE_IMAGE_H_
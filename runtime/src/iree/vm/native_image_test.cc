@@ -0,0 +1,288 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/native_image.h"
+
+#include <cstring>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/flatcc/building.h"
+#include "iree/schemas/bytecode_module_def_builder.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+#include "iree/vm/native_module_test.h"
+
+namespace iree {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+// Native image interface for module_a from native_module_test.h.
+static const iree_vm_native_image_v0_t kModuleAImage = {
+    IREE_VM_NATIVE_IMAGE_VERSION_0,
+    "module_a",
+    module_a_create,
+};
+
+// Query function of an image compatible with this runtime.
+static const iree_vm_native_image_v0_t* QueryModuleA(
+    iree_vm_native_image_version_t max_version) {
+  return &kModuleAImage;
+}
+
+// Query function of an image that requires a newer runtime.
+static const iree_vm_native_image_v0_t* QueryFutureVersion(
+    iree_vm_native_image_version_t max_version) {
+  if (max_version < IREE_VM_NATIVE_IMAGE_VERSION_LATEST + 1) return NULL;
+  return &kModuleAImage;
+}
+
+// Loader that returns |query_fn| for any image instead of loading native code.
+struct MockLoader {
+  iree_vm_native_image_query_fn_t query_fn = QueryModuleA;
+  int load_count = 0;
+  int unload_count = 0;
+  std::vector<uint8_t> loaded_image;
+  iree_host_size_t import_count = 0;
+
+  static iree_status_t Load(
+      void* self, iree_const_byte_span_t image,
+      const iree_vm_native_image_import_table_t* import_table,
+      iree_allocator_t host_allocator, void** out_handle) {
+    auto* loader = reinterpret_cast<MockLoader*>(self);
+    ++loader->load_count;
+    loader->loaded_image.assign(image.data, image.data + image.data_length);
+    loader->import_count = import_table->count;
+    *out_handle = loader;
+    return iree_ok_status();
+  }
+
+  static iree_status_t LookupExport(void* self, void* handle,
+                                    const char* symbol_name,
+                                    void** out_address) {
+    auto* loader = reinterpret_cast<MockLoader*>(self);
+    if (strcmp(symbol_name, IREE_VM_NATIVE_IMAGE_EXPORT_NAME) != 0) {
+      return iree_make_status(IREE_STATUS_NOT_FOUND, "symbol '%s' not found",
+                              symbol_name);
+    }
+    *out_address = reinterpret_cast<void*>(loader->query_fn);
+    return iree_ok_status();
+  }
+
+  static void Unload(void* self, void* handle) {
+    auto* loader = reinterpret_cast<MockLoader*>(self);
+    ++loader->unload_count;
+  }
+
+  iree_vm_native_image_loader_t interface() {
+    iree_vm_native_image_loader_t loader;
+    loader.self = this;
+    loader.load = Load;
+    loader.lookup_export = LookupExport;
+    loader.unload = Unload;
+    return loader;
+  }
+};
+
+struct TestImage {
+  const char* target_triple;
+  uint32_t abi_version;
+  std::vector<uint8_t> data;
+};
+
+// Builds a ModuleDef archive named |module_name| containing |images|.
+// The archive has no valid bytecode (no bytecode version is set) so loading
+// fails if the bytecode module is used instead of a native image.
+static std::vector<uint8_t> BuildArchive(const char* module_name,
+                                         const std::vector<TestImage>& images) {
+  flatcc_builder_t builder;
+  flatcc_builder_init(&builder);
+  iree_vm_BytecodeModuleDef_start_as_root_with_size(&builder);
+
+  std::vector<iree_vm_NativeImageDef_ref_t> image_refs;
+  for (const auto& image : images) {
+    flatbuffers_string_ref_t target_triple_ref =
+        flatbuffers_string_create_str(&builder, image.target_triple);
+    flatbuffers_uint8_vec_ref_t data_ref = flatbuffers_uint8_vec_create(
+        &builder, image.data.data(), image.data.size());
+    iree_vm_NativeImageDef_start(&builder);
+    iree_vm_NativeImageDef_target_triple_add(&builder, target_triple_ref);
+    iree_vm_NativeImageDef_abi_version_add(&builder, image.abi_version);
+    iree_vm_NativeImageDef_image_add(&builder, data_ref);
+    image_refs.push_back(iree_vm_NativeImageDef_end(&builder));
+  }
+  iree_vm_NativeImageDef_vec_ref_t images_ref =
+      iree_vm_NativeImageDef_vec_create(&builder, image_refs.data(),
+                                        image_refs.size());
+  flatbuffers_string_ref_t name_ref =
+      flatbuffers_string_create_str(&builder, module_name);
+
+  iree_vm_BytecodeModuleDef_name_add(&builder, name_ref);
+  iree_vm_BytecodeModuleDef_native_images_add(&builder, images_ref);
+  iree_vm_BytecodeModuleDef_end_as_root(&builder);
+
+  size_t buffer_size = 0;
+  void* buffer = flatcc_builder_finalize_aligned_buffer(&builder, &buffer_size);
+  std::vector<uint8_t> archive((uint8_t*)buffer,
+                               (uint8_t*)buffer + buffer_size);
+  flatcc_builder_aligned_free(buffer);
+  flatcc_builder_clear(&builder);
+  return archive;
+}
+
+// Returns a target triple the host can load images for or NULL if the host
+// does not support native images.
+static const char* FindHostTargetTriple() {
+  static const char* kTargetTriples[] = {
+      "x86_64-unknown-linux-gnu", "aarch64-unknown-linux-gnu",
+      "riscv64-unknown-linux-gnu", "riscv32-unknown-elf",
+      "i686-unknown-linux-gnu",    "armv7-unknown-linux-gnueabihf",
+  };
+  for (const char* target_triple : kTargetTriples) {
+    if (iree_vm_native_image_is_target_supported(
+            iree_make_cstring_view(target_triple))) {
+      return target_triple;
+    }
+  }
+  return NULL;
+}
+
+class VMNativeImageTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    host_target_triple_ = FindHostTargetTriple();
+    if (!host_target_triple_) {
+      GTEST_SKIP() << "native images not supported on the host";
+    }
+  }
+
+  iree_status_t CreateModule(const std::vector<uint8_t>& archive,
+                             const iree_vm_native_image_loader_t* loader,
+                             iree_vm_module_t** out_module) {
+    return iree_vm_native_image_module_create(
+        iree_make_const_byte_span(archive.data(), archive.size()),
+        iree_allocator_null(), loader, iree_allocator_system(), out_module);
+  }
+
+  const char* host_target_triple_ = NULL;
+  MockLoader mock_loader_;
+};
+
+// Tests that an image targeting the host is loaded and its module created.
+TEST_F(VMNativeImageTest, LoadsHostImage) {
+  auto archive = BuildArchive(
+      "module_a",
+      {
+          {"unknown-unknown-unknown", IREE_VM_NATIVE_IMAGE_VERSION_LATEST, {9}},
+          {host_target_triple_, IREE_VM_NATIVE_IMAGE_VERSION_LATEST, {1, 2, 3}},
+      });
+  auto loader = mock_loader_.interface();
+  iree_vm_module_t* module = NULL;
+  IREE_ASSERT_OK(CreateModule(archive, &loader, &module));
+  EXPECT_EQ(1, mock_loader_.load_count);
+  EXPECT_EQ(std::vector<uint8_t>({1, 2, 3}), mock_loader_.loaded_image);
+  EXPECT_GT(mock_loader_.import_count, 0);
+  EXPECT_TRUE(iree_string_view_equal(iree_vm_module_name(module),
+                                     IREE_SV("module_a")));
+
+  iree_vm_function_t function;
+  IREE_EXPECT_OK(iree_vm_module_lookup_function_by_name(
+      module, IREE_VM_FUNCTION_LINKAGE_EXPORT, IREE_SV("add_1"), &function));
+
+  EXPECT_EQ(0, mock_loader_.unload_count);
+  iree_vm_module_release(module);
+  EXPECT_EQ(1, mock_loader_.unload_count);
+}
+
+// Tests that without a loader the bytecode is always used (and verified) even
+// if the archive contains an image targeting the host.
+TEST_F(VMNativeImageTest, NoLoaderUsesBytecode) {
+  auto archive = BuildArchive(
+      "module_a",
+      {{host_target_triple_, IREE_VM_NATIVE_IMAGE_VERSION_LATEST, {1, 2, 3}}});
+  iree_vm_module_t* module = NULL;
+  EXPECT_THAT(Status(CreateModule(archive, /*loader=*/NULL, &module)),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_EQ(NULL, module);
+  EXPECT_EQ(0, mock_loader_.load_count);
+}
+
+// Tests that images for other targets and empty images are skipped and the
+// verified bytecode is used instead.
+TEST_F(VMNativeImageTest, ForeignTargetFallsBackToBytecode) {
+  auto archive = BuildArchive(
+      "module_a",
+      {{"unknown-unknown-unknown", IREE_VM_NATIVE_IMAGE_VERSION_LATEST, {1}},
+       {host_target_triple_, IREE_VM_NATIVE_IMAGE_VERSION_LATEST, {}}});
+  auto loader = mock_loader_.interface();
+  iree_vm_module_t* module = NULL;
+  EXPECT_THAT(Status(CreateModule(archive, &loader, &module)),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_EQ(0, mock_loader_.load_count);
+}
+
+// Tests that images compiled against a newer ABI are skipped without loading
+// them.
+TEST_F(VMNativeImageTest, NewerABIVersionSkipped) {
+  auto archive = BuildArchive(
+      "module_a", {{host_target_triple_,
+                    IREE_VM_NATIVE_IMAGE_VERSION_LATEST + 1, {1, 2, 3}}});
+  auto loader = mock_loader_.interface();
+  iree_vm_module_t* module = NULL;
+  EXPECT_THAT(Status(CreateModule(archive, &loader, &module)),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_EQ(0, mock_loader_.load_count);
+}
+
+// Tests that images rejecting the runtime ABI version from their query
+// function fail to load and are unloaded.
+TEST_F(VMNativeImageTest, QueryVersionMismatch) {
+  auto archive = BuildArchive(
+      "module_a",
+      {{host_target_triple_, IREE_VM_NATIVE_IMAGE_VERSION_LATEST, {1, 2, 3}}});
+  mock_loader_.query_fn = QueryFutureVersion;
+  auto loader = mock_loader_.interface();
+  iree_vm_module_t* module = NULL;
+  EXPECT_THAT(Status(CreateModule(archive, &loader, &module)),
+              StatusIs(StatusCode::kFailedPrecondition));
+  EXPECT_EQ(NULL, module);
+  EXPECT_EQ(1, mock_loader_.load_count);
+  EXPECT_EQ(1, mock_loader_.unload_count);
+}
+
+// Tests that images containing a different module than the bytecode are
+// rejected.
+TEST_F(VMNativeImageTest, ModuleNameMismatch) {
+  auto archive = BuildArchive(
+      "module_b",
+      {{host_target_triple_, IREE_VM_NATIVE_IMAGE_VERSION_LATEST, {1, 2, 3}}});
+  auto loader = mock_loader_.interface();
+  iree_vm_module_t* module = NULL;
+  EXPECT_THAT(Status(CreateModule(archive, &loader, &module)),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_EQ(1, mock_loader_.load_count);
+  EXPECT_EQ(1, mock_loader_.unload_count);
+}
+
+// Tests that malformed archives are rejected before any image is loaded.
+TEST_F(VMNativeImageTest, MalformedArchive) {
+  auto archive = BuildArchive(
+      "module_a",
+      {{host_target_triple_, IREE_VM_NATIVE_IMAGE_VERSION_LATEST, {1, 2, 3}}});
+  // Corrupt the root table offset following the size prefix.
+  archive[4] = 0xFF;
+  archive[5] = 0xFF;
+  auto loader = mock_loader_.interface();
+  iree_vm_module_t* module = NULL;
+  EXPECT_THAT(Status(CreateModule(archive, &loader, &module)),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_EQ(0, mock_loader_.load_count);
+}
+
+}  // namespace
+}  // namespace iree
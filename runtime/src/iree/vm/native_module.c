@@ -249,6 +249,20 @@ iree_vm_native_module_alloc_state(void* self, iree_allocator_t allocator,
   return iree_ok_status();
 }
 
+static iree_status_t IREE_API_PTR iree_vm_native_module_fork_state(
+    void* self, iree_vm_module_state_t* parent_module_state,
+    iree_allocator_t allocator, iree_vm_module_state_t** out_module_state) {
+  iree_vm_native_module_t* module = (iree_vm_native_module_t*)self;
+  *out_module_state = NULL;
+  if (module->user_interface.fork_state) {
+    return module->user_interface.fork_state(module->self, parent_module_state,
+                                             allocator, out_module_state);
+  }
+  // Stateless modules can be trivially forked.
+  IREE_ASSERT_EQ(parent_module_state, NULL);
+  return iree_ok_status();
+}
+
 static void IREE_API_PTR iree_vm_native_module_free_state(
     void* self, iree_vm_module_state_t* module_state) {
   iree_vm_native_module_t* module = (iree_vm_native_module_t*)self;
@@ -374,6 +388,11 @@ static iree_status_t IREE_API_PTR iree_vm_native_module_resume_call(
     return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
                             "no frame at top of stack to resume");
   }
+  // Callers that remain on the stack across the yield (such as bytecode
+  // calling an import) receive the results in their own frame.
+  iree_byte_span_t frame_results =
+      iree_vm_stack_call_results(stack, callee_frame);
+  if (!iree_byte_span_is_empty(frame_results)) call_results = frame_results;
   return iree_vm_native_module_issue_call(
       module, stack, callee_frame, IREE_VM_NATIVE_FUNCTION_CALL_RESUME,
       iree_byte_span_empty(), call_results, out_result);  // tail
@@ -472,6 +491,12 @@ IREE_API_EXPORT iree_status_t iree_vm_native_module_initialize(
       iree_vm_native_module_lookup_function;
   module->base_interface.alloc_state = iree_vm_native_module_alloc_state;
   module->base_interface.free_state = iree_vm_native_module_free_state;
+  // Modules with user state can only be forked if they support it; otherwise
+  // forked contexts allocate new state.
+  if (module->user_interface.fork_state ||
+      !module->user_interface.alloc_state) {
+    module->base_interface.fork_state = iree_vm_native_module_fork_state;
+  }
   module->base_interface.resolve_import = iree_vm_native_module_resolve_import;
   module->base_interface.notify = iree_vm_native_module_notify;
   module->base_interface.begin_call = iree_vm_native_module_begin_call;
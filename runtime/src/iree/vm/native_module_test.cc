@@ -21,6 +21,19 @@
 namespace iree {
 namespace {
 
+using ::iree::testing::status::StatusIs;
+
+// Forwards to the system allocator and counts allocations made through it.
+static iree_status_t CountingAllocatorCtl(void* self,
+                                          iree_allocator_command_t command,
+                                          const void* params,
+                                          void** inout_ptr) {
+  if (command != IREE_ALLOCATOR_COMMAND_FREE) {
+    ++*reinterpret_cast<int*>(self);
+  }
+  return iree_allocator_system_ctl(/*self=*/NULL, command, params, inout_ptr);
+}
+
 // Test suite that uses module_a and module_b defined in native_module_test.h.
 // Both modules are put in a context and the module_b.entry function can be
 // executed with RunFunction.
@@ -56,12 +69,18 @@ class VMNativeModuleTest : public ::testing::Test {
 
   StatusOr<int32_t> RunFunction(iree_string_view_t function_name,
                                 int32_t arg0) {
+    return RunFunction(context_, function_name, arg0);
+  }
+
+  StatusOr<int32_t> RunFunction(iree_vm_context_t* context,
+                                iree_string_view_t function_name,
+                                int32_t arg0) {
     // Lookup the entry function. This can be cached in an application if
     // multiple calls will be made.
     iree_vm_function_t function;
     IREE_RETURN_IF_ERROR(
         iree_vm_context_resolve_function(
-            context_, iree_make_cstring_view("module_b.entry"), &function),
+            context, iree_make_cstring_view("module_b.entry"), &function),
         "unable to resolve entry point");
 
     // Setup I/O lists and pass in the argument. The result list will be
@@ -78,7 +97,7 @@ class VMNativeModuleTest : public ::testing::Test {
 
     // Invoke the entry function to do our work. Runs synchronously.
     IREE_RETURN_IF_ERROR(
-        iree_vm_invoke(context_, function, IREE_VM_INVOCATION_FLAG_NONE,
+        iree_vm_invoke(context, function, IREE_VM_INVOCATION_FLAG_NONE,
                        /*policy=*/nullptr, input_list.get(), output_list.get(),
                        iree_allocator_system()));
 
@@ -89,6 +108,9 @@ class VMNativeModuleTest : public ::testing::Test {
     return ret0_value.i32;
   }
 
+ protected:
+  iree_vm_context_t* context() const { return context_; }
+
  private:
   iree_vm_instance_t* instance_ = nullptr;
   iree_vm_context_t* context_ = nullptr;
@@ -106,5 +128,100 @@ TEST_F(VMNativeModuleTest, Example) {
   ASSERT_EQ(v2, 8);
 }
 
+// Repeatedly invokes the entry function through a single prepared call.
+TEST_F(VMNativeModuleTest, PreparedCall) {
+  iree_vm_function_t function;
+  IREE_ASSERT_OK(iree_vm_context_resolve_function(
+      context(), iree_make_cstring_view("module_b.entry"), &function));
+  int allocation_count = 0;
+  iree_allocator_t host_allocator = {&allocation_count, CountingAllocatorCtl};
+  iree_vm_prepared_call_t* call = nullptr;
+  IREE_ASSERT_OK(iree_vm_prepared_call_allocate(
+      context(), function, IREE_VM_INVOCATION_FLAG_NONE,
+      IREE_VM_STACK_DEFAULT_SIZE, host_allocator, &call));
+  ASSERT_EQ(iree_vm_prepared_call_argument_count(call), 1);
+  ASSERT_EQ(iree_vm_prepared_call_result_count(call), 1);
+  EXPECT_GT(allocation_count, 0);
+
+  // All storage is allocated up front and invocations must not allocate.
+  allocation_count = 0;
+  const int32_t expected_results[] = {1, 4, 8};
+  for (int32_t i = 0; i < 3; ++i) {
+    IREE_ASSERT_OK(iree_vm_prepared_call_set_i32(call, 0, i + 1));
+    IREE_ASSERT_OK(iree_vm_prepared_call_invoke(call));
+    int32_t result = 0;
+    IREE_ASSERT_OK(iree_vm_prepared_call_get_i32(call, 0, &result));
+    EXPECT_EQ(result, expected_results[i]);
+  }
+  EXPECT_EQ(allocation_count, 0);
+
+  // Mismatched types and out of range indices are rejected.
+  EXPECT_THAT(Status(iree_vm_prepared_call_set_f32(call, 0, 1.0f)),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_THAT(Status(iree_vm_prepared_call_set_i32(call, 1, 1)),
+              StatusIs(StatusCode::kOutOfRange));
+
+  iree_vm_prepared_call_free(call);
+}
+
+// Modules are enumerated in registration order.
+TEST_F(VMNativeModuleTest, ModuleEnumeration) {
+  ASSERT_EQ(iree_vm_context_module_count(context()), 2);
+  iree_string_view_t name_a =
+      iree_vm_module_name(iree_vm_context_module_at(context(), 0));
+  iree_string_view_t name_b =
+      iree_vm_module_name(iree_vm_context_module_at(context(), 1));
+  EXPECT_TRUE(iree_string_view_equal(name_a, IREE_SV("module_a")));
+  EXPECT_TRUE(iree_string_view_equal(name_b, IREE_SV("module_b")));
+  EXPECT_EQ(iree_vm_context_module_at(context(), 2), nullptr);
+}
+
+// Forked contexts share the modules of the parent but have their own state.
+// module_b has no fork_state and gets a fresh counter in the fork.
+TEST_F(VMNativeModuleTest, ForkedContext) {
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v0, RunFunction(iree_make_cstring_view("module_b.entry"), 1));
+  ASSERT_EQ(v0, 1);
+
+  iree_vm_context_t* forked_context = nullptr;
+  IREE_ASSERT_OK(iree_vm_context_fork(context(), iree_allocator_system(),
+                                      &forked_context));
+  EXPECT_NE(iree_vm_context_id(forked_context), iree_vm_context_id(context()));
+
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v1, RunFunction(forked_context,
+                              iree_make_cstring_view("module_b.entry"), 1));
+  EXPECT_EQ(v1, 1);
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v2, RunFunction(iree_make_cstring_view("module_b.entry"), 2));
+  EXPECT_EQ(v2, 4);
+
+  iree_vm_context_release(forked_context);
+}
+
+// Forked contexts retain their parent and remain usable after the caller
+// releases it. The parent is itself a fork so that the test holds its only
+// reference.
+TEST_F(VMNativeModuleTest, ForkedContextOutlivesParent) {
+  iree_vm_context_t* parent_context = nullptr;
+  IREE_ASSERT_OK(iree_vm_context_fork(context(), iree_allocator_system(),
+                                      &parent_context));
+  iree_vm_context_t* forked_context = nullptr;
+  IREE_ASSERT_OK(iree_vm_context_fork(parent_context, iree_allocator_system(),
+                                      &forked_context));
+  iree_vm_context_release(parent_context);
+
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v0, RunFunction(forked_context,
+                              iree_make_cstring_view("module_b.entry"), 1));
+  EXPECT_EQ(v0, 1);
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v1, RunFunction(forked_context,
+                              iree_make_cstring_view("module_b.entry"), 2));
+  EXPECT_EQ(v1, 4);
+
+  iree_vm_context_release(forked_context);
+}
+
 }  // namespace
 }  // namespace iree
@@ -0,0 +1,386 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/profile.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+
+struct iree_vm_profile_t {
+  iree_allocator_t allocator;
+
+  // Guards registration of modules and functions. Counters are updated
+  // without synchronization.
+  iree_slim_mutex_t mutex;
+
+  // Linked list of modules that have been executed.
+  iree_vm_profile_module_t* modules;
+
+  iree_vm_profile_opcode_t opcodes[IREE_VM_PROFILE_OPCODE_SLOT_CAPACITY];
+};
+
+IREE_API_EXPORT iree_status_t iree_vm_profile_allocate(
+    iree_allocator_t allocator, iree_vm_profile_t** out_profile) {
+  IREE_ASSERT_ARGUMENT(out_profile);
+  *out_profile = NULL;
+  iree_vm_profile_t* profile = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(allocator, sizeof(*profile), (void**)&profile));
+  profile->allocator = allocator;
+  iree_slim_mutex_initialize(&profile->mutex);
+  *out_profile = profile;
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT void iree_vm_profile_free(iree_vm_profile_t* profile) {
+  if (!profile) return;
+  iree_allocator_t allocator = profile->allocator;
+  iree_vm_profile_module_t* profile_module = profile->modules;
+  while (profile_module) {
+    iree_vm_profile_module_t* next = profile_module->next;
+    for (iree_host_size_t i = 0; i < profile_module->function_count; ++i) {
+      iree_allocator_free(allocator, profile_module->functions[i].pcs);
+    }
+    iree_vm_module_release(profile_module->module);
+    iree_allocator_free(allocator, profile_module);
+    profile_module = next;
+  }
+  iree_slim_mutex_deinitialize(&profile->mutex);
+  iree_allocator_free(allocator, profile);
+}
+
+IREE_API_EXPORT void iree_vm_profile_reset(iree_vm_profile_t* profile) {
+  IREE_ASSERT_ARGUMENT(profile);
+  iree_slim_mutex_lock(&profile->mutex);
+  memset(profile->opcodes, 0, sizeof(profile->opcodes));
+  for (iree_vm_profile_module_t* profile_module = profile->modules;
+       profile_module; profile_module = profile_module->next) {
+    for (iree_host_size_t i = 0; i < profile_module->function_count; ++i) {
+      iree_vm_profile_function_t* function = &profile_module->functions[i];
+      function->instruction_count = 0;
+      function->ticks = 0;
+      if (function->pcs) {
+        memset(function->pcs, 0,
+               function->pc_capacity * sizeof(*function->pcs));
+      }
+    }
+  }
+  iree_slim_mutex_unlock(&profile->mutex);
+}
+
+IREE_API_EXPORT iree_vm_profile_opcode_t* iree_vm_profile_opcodes(
+    iree_vm_profile_t* profile) {
+  IREE_ASSERT_ARGUMENT(profile);
+  return profile->opcodes;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_profile_lookup_module(
+    iree_vm_profile_t* profile, iree_vm_module_t* module,
+    iree_host_size_t function_count, iree_vm_profile_module_t** out_module) {
+  IREE_ASSERT_ARGUMENT(profile);
+  IREE_ASSERT_ARGUMENT(module);
+  IREE_ASSERT_ARGUMENT(out_module);
+  *out_module = NULL;
+
+  iree_slim_mutex_lock(&profile->mutex);
+  for (iree_vm_profile_module_t* profile_module = profile->modules;
+       profile_module; profile_module = profile_module->next) {
+    if (profile_module->module == module) {
+      iree_slim_mutex_unlock(&profile->mutex);
+      *out_module = profile_module;
+      return iree_ok_status();
+    }
+  }
+
+  // First execution of the module; allocate the module and function counters
+  // together.
+  iree_vm_profile_module_t* profile_module = NULL;
+  iree_host_size_t total_size =
+      sizeof(*profile_module) +
+      function_count * sizeof(profile_module->functions[0]);
+  iree_status_t status = iree_allocator_malloc(
+      profile->allocator, total_size, (void**)&profile_module);
+  if (iree_status_is_ok(status)) {
+    profile_module->module = module;
+    iree_vm_module_retain(module);
+    profile_module->function_count = function_count;
+    profile_module->functions =
+        (iree_vm_profile_function_t*)((uint8_t*)profile_module +
+                                      sizeof(*profile_module));
+    profile_module->next = profile->modules;
+    profile->modules = profile_module;
+    *out_module = profile_module;
+  }
+  iree_slim_mutex_unlock(&profile->mutex);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_profile_reserve_function(
+    iree_vm_profile_t* profile, iree_vm_profile_function_t* function,
+    iree_host_size_t code_length) {
+  IREE_ASSERT_ARGUMENT(profile);
+  IREE_ASSERT_ARGUMENT(function);
+  iree_status_t status = iree_ok_status();
+  iree_slim_mutex_lock(&profile->mutex);
+  if (!function->pcs) {
+    status = iree_allocator_malloc(profile->allocator,
+                                   code_length * sizeof(*function->pcs),
+                                   (void**)&function->pcs);
+    if (iree_status_is_ok(status)) {
+      function->pc_capacity = code_length;
+    }
+  }
+  iree_slim_mutex_unlock(&profile->mutex);
+  return status;
+}
+
+static void iree_vm_profile_merge_counters(const char* name, uint64_t count,
+                                           uint64_t ticks,
+                                           const char** inout_name,
+                                           uint64_t* inout_count,
+                                           uint64_t* inout_ticks) {
+  if (!count && !ticks) return;
+  if (!*inout_name) *inout_name = name;
+  *inout_count += count;
+  *inout_ticks += ticks;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_profile_merge(iree_vm_profile_t* profile,
+                                                    iree_vm_profile_t* source) {
+  IREE_ASSERT_ARGUMENT(profile);
+  IREE_ASSERT_ARGUMENT(source);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(source->opcodes); ++i) {
+    const iree_vm_profile_opcode_t* opcode = &source->opcodes[i];
+    iree_vm_profile_merge_counters(
+        opcode->name, opcode->count, opcode->ticks, &profile->opcodes[i].name,
+        &profile->opcodes[i].count, &profile->opcodes[i].ticks);
+  }
+
+  iree_status_t status = iree_ok_status();
+  for (iree_vm_profile_module_t* source_module = source->modules;
+       source_module && iree_status_is_ok(status);
+       source_module = source_module->next) {
+    iree_vm_profile_module_t* profile_module = NULL;
+    status = iree_vm_profile_lookup_module(profile, source_module->module,
+                                           source_module->function_count,
+                                           &profile_module);
+    for (iree_host_size_t i = 0;
+         i < source_module->function_count && iree_status_is_ok(status); ++i) {
+      const iree_vm_profile_function_t* source_function =
+          &source_module->functions[i];
+      iree_vm_profile_function_t* function = &profile_module->functions[i];
+      function->instruction_count += source_function->instruction_count;
+      function->ticks += source_function->ticks;
+      if (!source_function->pcs) continue;
+      status = iree_vm_profile_reserve_function(profile, function,
+                                                source_function->pc_capacity);
+      iree_host_size_t pc_count = iree_status_is_ok(status)
+                                      ? iree_min(source_function->pc_capacity,
+                                                 function->pc_capacity)
+                                      : 0;
+      for (iree_host_size_t pc = 0; pc < pc_count; ++pc) {
+        const iree_vm_profile_pc_t* source_pc = &source_function->pcs[pc];
+        iree_vm_profile_merge_counters(
+            source_pc->name, source_pc->count, source_pc->ticks,
+            &function->pcs[pc].name, &function->pcs[pc].count,
+            &function->pcs[pc].ticks);
+      }
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_vm_profile_module_t* iree_vm_profile_modules(
+    iree_vm_profile_t* profile) {
+  IREE_ASSERT_ARGUMENT(profile);
+  return profile->modules;
+}
+
+//===----------------------------------------------------------------------===//
+// Reporting
+//===----------------------------------------------------------------------===//
+
+// A row in one of the report tables.
+typedef struct iree_vm_profile_row_t {
+  iree_vm_profile_module_t* module;
+  iree_host_size_t function_ordinal;
+  iree_host_size_t pc;
+  const char* name;
+  uint64_t count;
+  uint64_t ticks;
+} iree_vm_profile_row_t;
+
+static int iree_vm_profile_row_compare(const void* lhs_ptr,
+                                       const void* rhs_ptr) {
+  const iree_vm_profile_row_t* lhs = (const iree_vm_profile_row_t*)lhs_ptr;
+  const iree_vm_profile_row_t* rhs = (const iree_vm_profile_row_t*)rhs_ptr;
+  if (lhs->ticks != rhs->ticks) return lhs->ticks > rhs->ticks ? -1 : 1;
+  if (lhs->count != rhs->count) return lhs->count > rhs->count ? -1 : 1;
+  return 0;
+}
+
+static double iree_vm_profile_percent(uint64_t value, uint64_t total) {
+  return total ? 100.0 * (double)value / (double)total : 0.0;
+}
+
+static void iree_vm_profile_fprint_function_name(
+    FILE* file, iree_vm_profile_module_t* profile_module,
+    iree_host_size_t function_ordinal) {
+  iree_string_view_t module_name = iree_vm_module_name(profile_module->module);
+  iree_string_view_t function_name = iree_string_view_empty();
+  iree_status_t status = profile_module->module->get_function(
+      profile_module->module->self, IREE_VM_FUNCTION_LINKAGE_INTERNAL,
+      function_ordinal, /*out_function=*/NULL, &function_name,
+      /*out_signature=*/NULL);
+  if (iree_status_is_ok(status) && !iree_string_view_is_empty(function_name)) {
+    fprintf(file, "%.*s.%.*s", (int)module_name.size, module_name.data,
+            (int)function_name.size, function_name.data);
+  } else {
+    fprintf(file, "%.*s@%" PRIhsz, (int)module_name.size, module_name.data,
+            function_ordinal);
+  }
+  iree_status_ignore(status);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_profile_fprint(
+    FILE* file, iree_vm_profile_t* profile, iree_host_size_t top_count) {
+  IREE_ASSERT_ARGUMENT(file);
+  IREE_ASSERT_ARGUMENT(profile);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_slim_mutex_lock(&profile->mutex);
+
+  // Size the scratch table to hold the largest of the three reports.
+  iree_host_size_t function_count = 0;
+  iree_host_size_t pc_count = 0;
+  for (iree_vm_profile_module_t* profile_module = profile->modules;
+       profile_module; profile_module = profile_module->next) {
+    function_count += profile_module->function_count;
+    for (iree_host_size_t i = 0; i < profile_module->function_count; ++i) {
+      const iree_vm_profile_function_t* function =
+          &profile_module->functions[i];
+      for (iree_host_size_t j = 0; j < function->pc_capacity; ++j) {
+        if (function->pcs[j].count) ++pc_count;
+      }
+    }
+  }
+  iree_host_size_t row_capacity = IREE_VM_PROFILE_OPCODE_SLOT_CAPACITY;
+  row_capacity = iree_max(row_capacity, function_count);
+  row_capacity = iree_max(row_capacity, pc_count);
+  iree_vm_profile_row_t* rows = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      profile->allocator, row_capacity * sizeof(*rows), (void**)&rows);
+  if (!iree_status_is_ok(status)) {
+    iree_slim_mutex_unlock(&profile->mutex);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  // Opcodes.
+  iree_host_size_t row_count = 0;
+  uint64_t total_count = 0;
+  uint64_t total_ticks = 0;
+  for (iree_host_size_t i = 0; i < IREE_VM_PROFILE_OPCODE_SLOT_CAPACITY; ++i) {
+    const iree_vm_profile_opcode_t* opcode = &profile->opcodes[i];
+    if (!opcode->count) continue;
+    total_count += opcode->count;
+    total_ticks += opcode->ticks;
+    rows[row_count++] = (iree_vm_profile_row_t){
+        .name = opcode->name,
+        .count = opcode->count,
+        .ticks = opcode->ticks,
+    };
+  }
+  qsort(rows, row_count, sizeof(*rows), iree_vm_profile_row_compare);
+  fprintf(file,
+          "[[ VM profile: %" PRIu64 " instructions, %" PRIu64 " ticks ]]\n",
+          total_count, total_ticks);
+  fprintf(file, "\nOpcodes:\n");
+  fprintf(file, "  %7s %14s %16s  %s\n", "ticks%", "count", "ticks", "opcode");
+  for (iree_host_size_t i = 0; i < iree_min(row_count, top_count); ++i) {
+    fprintf(file, "  %6.2f%% %14" PRIu64 " %16" PRIu64 "  %s\n",
+            iree_vm_profile_percent(rows[i].ticks, total_ticks), rows[i].count,
+            rows[i].ticks, rows[i].name ? rows[i].name : "?");
+  }
+
+  // Functions. Calls are the number of times the function entry instruction
+  // executed: the entry block of a function cannot be a branch target.
+  row_count = 0;
+  for (iree_vm_profile_module_t* profile_module = profile->modules;
+       profile_module; profile_module = profile_module->next) {
+    for (iree_host_size_t i = 0; i < profile_module->function_count; ++i) {
+      const iree_vm_profile_function_t* function =
+          &profile_module->functions[i];
+      if (!function->instruction_count) continue;
+      rows[row_count++] = (iree_vm_profile_row_t){
+          .module = profile_module,
+          .function_ordinal = i,
+          .pc = function->pc_capacity ? function->pcs[0].count : 0,
+          .count = function->instruction_count,
+          .ticks = function->ticks,
+      };
+    }
+  }
+  qsort(rows, row_count, sizeof(*rows), iree_vm_profile_row_compare);
+  fprintf(file, "\nFunctions (exclusive):\n");
+  fprintf(file, "  %7s %10s %14s %16s  %s\n", "ticks%", "calls",
+          "instructions", "ticks", "function");
+  for (iree_host_size_t i = 0; i < iree_min(row_count, top_count); ++i) {
+    fprintf(file, "  %6.2f%% %10" PRIhsz " %14" PRIu64 " %16" PRIu64 "  ",
+            iree_vm_profile_percent(rows[i].ticks, total_ticks), rows[i].pc,
+            rows[i].count, rows[i].ticks);
+    iree_vm_profile_fprint_function_name(file, rows[i].module,
+                                         rows[i].function_ordinal);
+    fprintf(file, "\n");
+  }
+
+  // Instructions.
+  row_count = 0;
+  for (iree_vm_profile_module_t* profile_module = profile->modules;
+       profile_module; profile_module = profile_module->next) {
+    for (iree_host_size_t i = 0; i < profile_module->function_count; ++i) {
+      const iree_vm_profile_function_t* function =
+          &profile_module->functions[i];
+      for (iree_host_size_t j = 0; j < function->pc_capacity; ++j) {
+        const iree_vm_profile_pc_t* pc = &function->pcs[j];
+        if (!pc->count) continue;
+        rows[row_count++] = (iree_vm_profile_row_t){
+            .module = profile_module,
+            .function_ordinal = i,
+            .pc = j,
+            .name = pc->name,
+            .count = pc->count,
+            .ticks = pc->ticks,
+        };
+      }
+    }
+  }
+  qsort(rows, row_count, sizeof(*rows), iree_vm_profile_row_compare);
+  fprintf(file, "\nInstructions:\n");
+  fprintf(file, "  %7s %14s %16s  %s\n", "ticks%", "count", "ticks",
+          "function+pc opcode");
+  for (iree_host_size_t i = 0; i < iree_min(row_count, top_count); ++i) {
+    fprintf(file, "  %6.2f%% %14" PRIu64 " %16" PRIu64 "  ",
+            iree_vm_profile_percent(rows[i].ticks, total_ticks), rows[i].count,
+            rows[i].ticks);
+    iree_vm_profile_fprint_function_name(file, rows[i].module,
+                                         rows[i].function_ordinal);
+    fprintf(file, "+%08" PRIhsz " %s\n", rows[i].pc,
+            rows[i].name ? rows[i].name : "?");
+  }
+
+  iree_allocator_free(profile->allocator, rows);
+  iree_slim_mutex_unlock(&profile->mutex);
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
@@ -0,0 +1,162 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_VM_PROFILE_H_
+#define IREE_VM_PROFILE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "iree/base/api.h"
+#include "iree/vm/module.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_vm_profile_t
+//===----------------------------------------------------------------------===//
+// Instruction-level execution profile of VM invocations.
+//
+// When enabled the bytecode interpreter counts every instruction executed and
+// measures the ticks spent between the start of one instruction and the start
+// of the next. Ticks are attributed to the opcode, the function, and the
+// bytecode offset (PC) of the instruction. Calls to imports are attributed to
+// the calling instruction and include the time spent in the import.
+//
+// Profiling must be compiled in with -DIREE_VM_EXECUTION_PROFILING_ENABLE=1
+// and is enabled per-context with IREE_VM_CONTEXT_FLAG_PROFILE_EXECUTION.
+// Profiling has a significant overhead on each instruction and the absolute
+// ticks will be inflated; use the relative distribution to find hot spots.
+//
+// Counters are updated without synchronization and invocations made
+// concurrently in the same context may lose counts.
+
+// Base opcode slot of each bytecode prefix. Each prefix has its own table of
+// 256 slots indexed by opcode such that opcodes with the same value in
+// different prefixes are counted separately.
+#define IREE_VM_PROFILE_OPCODE_SLOT_CORE (0 * 256)
+#define IREE_VM_PROFILE_OPCODE_SLOT_EXT_I32 (1 * 256)
+#define IREE_VM_PROFILE_OPCODE_SLOT_EXT_F32 (2 * 256)
+#define IREE_VM_PROFILE_OPCODE_SLOT_EXT_F64 (3 * 256)
+
+// Maximum number of opcode slots: the core opcode table followed by one table
+// per extension prefix.
+#define IREE_VM_PROFILE_OPCODE_SLOT_CAPACITY (4 * 256)
+
+// Execution counters for a single opcode.
+typedef struct iree_vm_profile_opcode_t {
+  // Opcode name or NULL if the opcode has not been executed.
+  const char* name;
+  // Total number of times the opcode was executed.
+  uint64_t count;
+  // Total ticks spent executing the opcode.
+  uint64_t ticks;
+} iree_vm_profile_opcode_t;
+
+// Execution counters for an instruction at a bytecode offset in a function.
+typedef struct iree_vm_profile_pc_t {
+  // Opcode name or NULL if the instruction has not been executed.
+  const char* name;
+  // Total number of times the instruction was executed.
+  uint64_t count;
+  // Total ticks spent executing the instruction.
+  uint64_t ticks;
+} iree_vm_profile_pc_t;
+
+// Execution counters for an internal function of a module.
+typedef struct iree_vm_profile_function_t {
+  // Total number of instructions executed in the function.
+  uint64_t instruction_count;
+  // Total ticks spent executing instructions in the function, excluding the
+  // instructions of internal callees.
+  uint64_t ticks;
+  // Counters for each bytecode offset in the function or NULL if the function
+  // has not been executed. Only offsets that start instructions are populated.
+  iree_host_size_t pc_capacity;
+  iree_vm_profile_pc_t* pcs;
+} iree_vm_profile_function_t;
+
+// Execution counters for all internal functions in a module.
+typedef struct iree_vm_profile_module_t {
+  struct iree_vm_profile_module_t* next;
+  // Module the counters are for; retained by the profile.
+  iree_vm_module_t* module;
+  // Counters for each internal function by ordinal.
+  iree_host_size_t function_count;
+  iree_vm_profile_function_t* functions;
+} iree_vm_profile_module_t;
+
+typedef struct iree_vm_profile_t iree_vm_profile_t;
+
+// Returns the current value of the profiling tick counter.
+// This is a cycle counter on architectures where one is cheaply available and
+// nanoseconds otherwise.
+static inline uint64_t iree_vm_profile_ticks(void) {
+#if defined(IREE_COMPILER_CLANG) || defined(IREE_COMPILER_GCC)
+#if defined(IREE_ARCH_X86_64) || defined(IREE_ARCH_X86_32)
+  return __builtin_ia32_rdtsc();
+#elif defined(IREE_ARCH_ARM_64)
+  uint64_t value = 0;
+  __asm__ volatile("mrs %0, cntvct_el0" : "=r"(value));
+  return value;
+#else
+  return (uint64_t)iree_time_now();
+#endif  // IREE_ARCH_*
+#else
+  return (uint64_t)iree_time_now();
+#endif  // IREE_COMPILER_*
+}
+
+// Allocates an empty profile.
+IREE_API_EXPORT iree_status_t iree_vm_profile_allocate(
+    iree_allocator_t allocator, iree_vm_profile_t** out_profile);
+
+// Frees |profile| and releases all retained modules.
+IREE_API_EXPORT void iree_vm_profile_free(iree_vm_profile_t* profile);
+
+// Resets all counters in |profile| to zero.
+IREE_API_EXPORT void iree_vm_profile_reset(iree_vm_profile_t* profile);
+
+// Adds all counters of |source| to |profile|, registering any modules and
+// functions |source| has executed that |profile| has not. Used to combine the
+// profiles of contexts forked to run concurrently. |source| must not be
+// executing while it is merged.
+IREE_API_EXPORT iree_status_t iree_vm_profile_merge(iree_vm_profile_t* profile,
+                                                    iree_vm_profile_t* source);
+
+// Returns the table of IREE_VM_PROFILE_OPCODE_SLOT_CAPACITY opcode counters.
+IREE_API_EXPORT iree_vm_profile_opcode_t* iree_vm_profile_opcodes(
+    iree_vm_profile_t* profile);
+
+// Returns the per-function counters of |module| in |out_module|, registering
+// the module with |function_count| internal functions if it has not been
+// executed yet. The returned pointer remains valid for the life of |profile|.
+IREE_API_EXPORT iree_status_t iree_vm_profile_lookup_module(
+    iree_vm_profile_t* profile, iree_vm_module_t* module,
+    iree_host_size_t function_count, iree_vm_profile_module_t** out_module);
+
+// Ensures |function| has per-PC counters for |code_length| bytes of bytecode.
+IREE_API_EXPORT iree_status_t iree_vm_profile_reserve_function(
+    iree_vm_profile_t* profile, iree_vm_profile_function_t* function,
+    iree_host_size_t code_length);
+
+// Returns the first module in |profile| that has been executed or NULL.
+// Subsequent modules are linked via iree_vm_profile_module_t::next.
+IREE_API_EXPORT iree_vm_profile_module_t* iree_vm_profile_modules(
+    iree_vm_profile_t* profile);
+
+// Prints a report of the |top_count| most expensive opcodes, functions, and
+// instructions in |profile| to |file|.
+IREE_API_EXPORT iree_status_t iree_vm_profile_fprint(
+    FILE* file, iree_vm_profile_t* profile, iree_host_size_t top_count);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_VM_PROFILE_H_
@@ -0,0 +1,221 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/profile.h"
+
+#include <cstdio>
+#include <string>
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/native_module_test.h"
+
+namespace {
+
+class VMProfileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(
+        iree_vm_profile_allocate(iree_allocator_system(), &profile_));
+    IREE_ASSERT_OK(module_a_create(iree_allocator_system(), &module_));
+  }
+
+  void TearDown() override {
+    iree_vm_profile_free(profile_);
+    iree_vm_module_release(module_);
+  }
+
+  // Returns the report of |profile_| printed with |top_count| rows per table.
+  std::string Print(iree_host_size_t top_count) {
+    FILE* file = tmpfile();
+    IREE_CHECK_OK(iree_vm_profile_fprint(file, profile_, top_count));
+    std::string report(ftell(file), '\0');
+    rewind(file);
+    report.resize(fread(&report[0], 1, report.size(), file));
+    fclose(file);
+    return report;
+  }
+
+  iree_vm_profile_t* profile_ = nullptr;
+  iree_vm_module_t* module_ = nullptr;
+};
+
+// Tests that each bytecode prefix has its own range of opcode slots.
+TEST(VMProfileSlotTest, PrefixSlotsAreDisjoint) {
+  const iree_host_size_t slots[] = {
+      IREE_VM_PROFILE_OPCODE_SLOT_CORE,
+      IREE_VM_PROFILE_OPCODE_SLOT_EXT_I32,
+      IREE_VM_PROFILE_OPCODE_SLOT_EXT_F32,
+      IREE_VM_PROFILE_OPCODE_SLOT_EXT_F64,
+  };
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(slots); ++i) {
+    EXPECT_LE(slots[i] + 256, IREE_VM_PROFILE_OPCODE_SLOT_CAPACITY);
+    for (iree_host_size_t j = i + 1; j < IREE_ARRAYSIZE(slots); ++j) {
+      EXPECT_GE(slots[i] > slots[j] ? slots[i] - slots[j]
+                                    : slots[j] - slots[i],
+                256);
+    }
+  }
+}
+
+// Tests that a module is registered on first lookup and reused afterward.
+TEST_F(VMProfileTest, LookupModuleRegistersOnce) {
+  EXPECT_EQ(iree_vm_profile_modules(profile_), nullptr);
+
+  iree_vm_profile_module_t* profile_module = nullptr;
+  IREE_ASSERT_OK(iree_vm_profile_lookup_module(profile_, module_,
+                                               /*function_count=*/2,
+                                               &profile_module));
+  ASSERT_NE(profile_module, nullptr);
+  EXPECT_EQ(profile_module->module, module_);
+  EXPECT_EQ(profile_module->function_count, 2);
+  EXPECT_EQ(profile_module->functions[0].instruction_count, 0);
+  EXPECT_EQ(profile_module->functions[1].pcs, nullptr);
+
+  iree_vm_profile_module_t* second_module = nullptr;
+  IREE_ASSERT_OK(iree_vm_profile_lookup_module(profile_, module_,
+                                               /*function_count=*/2,
+                                               &second_module));
+  EXPECT_EQ(second_module, profile_module);
+  EXPECT_EQ(iree_vm_profile_modules(profile_), profile_module);
+  EXPECT_EQ(profile_module->next, nullptr);
+}
+
+// Tests that per-PC counters are only allocated the first time.
+TEST_F(VMProfileTest, ReserveFunctionAllocatesOnce) {
+  iree_vm_profile_module_t* profile_module = nullptr;
+  IREE_ASSERT_OK(iree_vm_profile_lookup_module(profile_, module_,
+                                               /*function_count=*/1,
+                                               &profile_module));
+  iree_vm_profile_function_t* function = &profile_module->functions[0];
+  IREE_ASSERT_OK(
+      iree_vm_profile_reserve_function(profile_, function, /*code_length=*/16));
+  ASSERT_NE(function->pcs, nullptr);
+  EXPECT_EQ(function->pc_capacity, 16);
+  EXPECT_EQ(function->pcs[15].count, 0);
+
+  iree_vm_profile_pc_t* pcs = function->pcs;
+  IREE_ASSERT_OK(
+      iree_vm_profile_reserve_function(profile_, function, /*code_length=*/16));
+  EXPECT_EQ(function->pcs, pcs);
+}
+
+// Tests that reset clears all counters but keeps registered modules.
+TEST_F(VMProfileTest, ResetClearsCounters) {
+  iree_vm_profile_module_t* profile_module = nullptr;
+  IREE_ASSERT_OK(iree_vm_profile_lookup_module(profile_, module_,
+                                               /*function_count=*/1,
+                                               &profile_module));
+  iree_vm_profile_function_t* function = &profile_module->functions[0];
+  IREE_ASSERT_OK(
+      iree_vm_profile_reserve_function(profile_, function, /*code_length=*/4));
+  iree_vm_profile_opcode_t* opcodes = iree_vm_profile_opcodes(profile_);
+  opcodes[IREE_VM_PROFILE_OPCODE_SLOT_EXT_F64 + 255] = {"Op", 3, 30};
+  function->instruction_count = 3;
+  function->ticks = 30;
+  function->pcs[2] = {"Op", 3, 30};
+
+  iree_vm_profile_reset(profile_);
+
+  EXPECT_EQ(opcodes[IREE_VM_PROFILE_OPCODE_SLOT_EXT_F64 + 255].count, 0);
+  EXPECT_EQ(opcodes[IREE_VM_PROFILE_OPCODE_SLOT_EXT_F64 + 255].ticks, 0);
+  EXPECT_EQ(iree_vm_profile_modules(profile_), profile_module);
+  EXPECT_EQ(function->instruction_count, 0);
+  EXPECT_EQ(function->ticks, 0);
+  EXPECT_EQ(function->pc_capacity, 4);
+  EXPECT_EQ(function->pcs[2].count, 0);
+}
+
+// Tests that an empty profile prints empty tables.
+TEST_F(VMProfileTest, PrintEmpty) {
+  std::string report = Print(/*top_count=*/10);
+  EXPECT_NE(report.find("[[ VM profile: 0 instructions, 0 ticks ]]"),
+            std::string::npos);
+  EXPECT_NE(report.find("Opcodes:"), std::string::npos);
+  EXPECT_NE(report.find("Functions (exclusive):"), std::string::npos);
+  EXPECT_NE(report.find("Instructions:"), std::string::npos);
+}
+
+// Tests that opcodes with the same value in different prefixes are reported
+// separately and rows are ordered by ticks.
+TEST_F(VMProfileTest, PrintOrdersByTicks) {
+  iree_vm_profile_module_t* profile_module = nullptr;
+  IREE_ASSERT_OK(iree_vm_profile_lookup_module(profile_, module_,
+                                               /*function_count=*/2,
+                                               &profile_module));
+  iree_vm_profile_function_t* function = &profile_module->functions[1];
+  IREE_ASSERT_OK(
+      iree_vm_profile_reserve_function(profile_, function, /*code_length=*/8));
+  iree_vm_profile_opcode_t* opcodes = iree_vm_profile_opcodes(profile_);
+  opcodes[IREE_VM_PROFILE_OPCODE_SLOT_CORE + 0x10] = {"CoreOp", 2, 100};
+  opcodes[IREE_VM_PROFILE_OPCODE_SLOT_EXT_F32 + 0x10] = {"F32Op", 1, 300};
+  function->instruction_count = 3;
+  function->ticks = 400;
+  function->pcs[0] = {"CoreOp", 2, 100};
+  function->pcs[5] = {"F32Op", 1, 300};
+
+  std::string report = Print(/*top_count=*/10);
+  EXPECT_NE(report.find("[[ VM profile: 3 instructions, 400 ticks ]]"),
+            std::string::npos);
+  size_t f32_pos = report.find("F32Op\n");
+  size_t core_pos = report.find("CoreOp\n");
+  ASSERT_NE(f32_pos, std::string::npos);
+  ASSERT_NE(core_pos, std::string::npos);
+  EXPECT_LT(f32_pos, core_pos);
+  EXPECT_NE(report.find(" 75.00%"), std::string::npos);
+  EXPECT_NE(report.find(" 25.00%"), std::string::npos);
+  EXPECT_NE(report.find("+00000005 F32Op"), std::string::npos);
+  EXPECT_NE(report.find("+00000000 CoreOp"), std::string::npos);
+
+  // Only the hottest row of each table is printed.
+  report = Print(/*top_count=*/1);
+  EXPECT_NE(report.find("F32Op"), std::string::npos);
+  EXPECT_EQ(report.find("CoreOp"), std::string::npos);
+}
+
+// Tests that merging adds counters and registers modules the target lacks.
+TEST_F(VMProfileTest, MergeAddsCounters) {
+  iree_vm_profile_t* source = nullptr;
+  IREE_ASSERT_OK(iree_vm_profile_allocate(iree_allocator_system(), &source));
+  iree_vm_profile_module_t* source_module = nullptr;
+  IREE_ASSERT_OK(iree_vm_profile_lookup_module(source, module_,
+                                               /*function_count=*/2,
+                                               &source_module));
+  iree_vm_profile_function_t* source_function = &source_module->functions[1];
+  IREE_ASSERT_OK(iree_vm_profile_reserve_function(source, source_function,
+                                                  /*code_length=*/8));
+  iree_vm_profile_opcodes(source)[IREE_VM_PROFILE_OPCODE_SLOT_CORE + 1] = {
+      "Op", 2, 20};
+  source_function->instruction_count = 2;
+  source_function->ticks = 20;
+  source_function->pcs[3] = {"Op", 2, 20};
+
+  // The first merge registers the module in the empty target.
+  IREE_ASSERT_OK(iree_vm_profile_merge(profile_, source));
+  IREE_ASSERT_OK(iree_vm_profile_merge(profile_, source));
+  iree_vm_profile_free(source);
+
+  iree_vm_profile_opcode_t* opcode =
+      &iree_vm_profile_opcodes(profile_)[IREE_VM_PROFILE_OPCODE_SLOT_CORE + 1];
+  EXPECT_STREQ(opcode->name, "Op");
+  EXPECT_EQ(opcode->count, 4);
+  EXPECT_EQ(opcode->ticks, 40);
+  iree_vm_profile_module_t* profile_module = iree_vm_profile_modules(profile_);
+  ASSERT_NE(profile_module, nullptr);
+  EXPECT_EQ(profile_module->module, module_);
+  EXPECT_EQ(profile_module->next, nullptr);
+  iree_vm_profile_function_t* function = &profile_module->functions[1];
+  EXPECT_EQ(function->instruction_count, 4);
+  EXPECT_EQ(function->ticks, 40);
+  ASSERT_EQ(function->pc_capacity, 8);
+  EXPECT_STREQ(function->pcs[3].name, "Op");
+  EXPECT_EQ(function->pcs[3].count, 4);
+  EXPECT_EQ(function->pcs[3].ticks, 40);
+  EXPECT_EQ(profile_module->functions[0].pcs, nullptr);
+}
+
+}  // namespace
@@ -7,6 +7,7 @@
 #include "iree/vm/shims.h"
 
 IREE_VM_ABI_DEFINE_SHIM(irIi, v);
+IREE_VM_ABI_DEFINE_SHIM(irIIII, v);
 IREE_VM_ABI_DEFINE_SHIM(r, i);
 IREE_VM_ABI_DEFINE_SHIM(r, I);
 IREE_VM_ABI_DEFINE_SHIM(r, ii);
@@ -25,6 +26,10 @@ IREE_VM_ABI_DEFINE_SHIM(ri, v);
 IREE_VM_ABI_DEFINE_SHIM(rI, i);
 IREE_VM_ABI_DEFINE_SHIM(rI, r);
 IREE_VM_ABI_DEFINE_SHIM(rI, v);
+IREE_VM_ABI_DEFINE_SHIM(rIIIrIIIII, v);
+IREE_VM_ABI_DEFINE_SHIM(rIIIrIIIrIIIII, v);
+IREE_VM_ABI_DEFINE_SHIM(rIIrIIrIIIIIi, v);
+IREE_VM_ABI_DEFINE_SHIM(rIIrIIrIIIIIiiii, v);
 IREE_VM_ABI_DEFINE_SHIM(riCiD, r);
 IREE_VM_ABI_DEFINE_SHIM(riiCID, r);
 IREE_VM_ABI_DEFINE_SHIM(riCiiD, r);
@@ -47,8 +52,10 @@ IREE_VM_ABI_DEFINE_SHIM(rr, v);
 IREE_VM_ABI_DEFINE_SHIM(rr, ii);
 IREE_VM_ABI_DEFINE_SHIM(rrr, ii);
 IREE_VM_ABI_DEFINE_SHIM(rrCirIID, r);
+IREE_VM_ABI_DEFINE_SHIM(rrCrD, v);
 IREE_VM_ABI_DEFINE_SHIM(rriCiD, v);
 IREE_VM_ABI_DEFINE_SHIM(rriiCID, v);
+IREE_VM_ABI_DEFINE_SHIM(rriCiiIID, v);
 IREE_VM_ABI_DEFINE_SHIM(rriCirIID, v);
 IREE_VM_ABI_DEFINE_SHIM(rriiii, v);
 IREE_VM_ABI_DEFINE_SHIM(rrIIii, v);
@@ -196,6 +196,13 @@ IREE_VM_ABI_FIXED_STRUCT(iiii, {
   int32_t i3;
 });
 
+IREE_VM_ABI_FIXED_STRUCT(iiII, {
+  int32_t i0;
+  int32_t i1;
+  int64_t i2;
+  int64_t i3;
+});
+
 IREE_VM_ABI_FIXED_STRUCT(irIi, {
   int32_t i0;
   iree_vm_ref_t r1;
@@ -210,6 +217,15 @@ IREE_VM_ABI_FIXED_STRUCT(irII, {
   int64_t i3;
 });
 
+IREE_VM_ABI_FIXED_STRUCT(irIIII, {
+  int32_t i0;
+  iree_vm_ref_t r1;
+  int64_t i2;
+  int64_t i3;
+  int64_t i4;
+  int64_t i5;
+});
+
 IREE_VM_ABI_FIXED_STRUCT(r, { iree_vm_ref_t r0; });
 
 IREE_VM_ABI_FIXED_STRUCT(rr, {
@@ -259,6 +275,71 @@ IREE_VM_ABI_FIXED_STRUCT(rII, {
   int64_t i2;
 });
 
+IREE_VM_ABI_FIXED_STRUCT(rIIIrIIIII, {
+  iree_vm_ref_t r0;
+  int64_t i1;
+  int64_t i2;
+  int64_t i3;
+  iree_vm_ref_t r4;
+  int64_t i5;
+  int64_t i6;
+  int64_t i7;
+  int64_t i8;
+  int64_t i9;
+});
+
+IREE_VM_ABI_FIXED_STRUCT(rIIIrIIIrIIIII, {
+  iree_vm_ref_t r0;
+  int64_t i1;
+  int64_t i2;
+  int64_t i3;
+  iree_vm_ref_t r4;
+  int64_t i5;
+  int64_t i6;
+  int64_t i7;
+  iree_vm_ref_t r8;
+  int64_t i9;
+  int64_t i10;
+  int64_t i11;
+  int64_t i12;
+  int64_t i13;
+});
+
+IREE_VM_ABI_FIXED_STRUCT(rIIrIIrIIIIIi, {
+  iree_vm_ref_t r0;
+  int64_t i1;
+  int64_t i2;
+  iree_vm_ref_t r3;
+  int64_t i4;
+  int64_t i5;
+  iree_vm_ref_t r6;
+  int64_t i7;
+  int64_t i8;
+  int64_t i9;
+  int64_t i10;
+  int64_t i11;
+  int32_t i12;
+});
+
+IREE_VM_ABI_FIXED_STRUCT(rIIrIIrIIIIIiiii, {
+  iree_vm_ref_t r0;
+  int64_t i1;
+  int64_t i2;
+  iree_vm_ref_t r3;
+  int64_t i4;
+  int64_t i5;
+  iree_vm_ref_t r6;
+  int64_t i7;
+  int64_t i8;
+  int64_t i9;
+  int64_t i10;
+  int64_t i11;
+  int32_t i12;
+  int32_t i13;
+  int32_t i14;
+  int32_t i15;
+});
+
 IREE_VM_ABI_FIXED_STRUCT(rif, {
   iree_vm_ref_t r0;
   int32_t i1;
@@ -401,6 +482,13 @@ IREE_VM_ABI_VLA_STRUCT(rirCrD, a3_count, a3, {
   iree_vm_abi_r_t a3[0];
 });
 
+IREE_VM_ABI_VLA_STRUCT(rrCrD, a2_count, a2, {
+  iree_vm_ref_t r0;
+  iree_vm_ref_t r1;
+  iree_vm_size_t a2_count;
+  iree_vm_abi_r_t a2[0];
+});
+
 IREE_VM_ABI_VLA_STRUCT(rrrrCrD, a4_count, a4, {
   iree_vm_ref_t r0;
   iree_vm_ref_t r1;
@@ -441,6 +529,14 @@ IREE_VM_ABI_VLA_STRUCT(rrCirIID, a2_count, a2, {
   iree_vm_abi_irII_t a2[0];
 });
 
+IREE_VM_ABI_VLA_STRUCT(rriCiiIID, a3_count, a3, {
+  iree_vm_ref_t r0;
+  iree_vm_ref_t r1;
+  int32_t i2;
+  iree_vm_size_t a3_count;
+  iree_vm_abi_iiII_t a3[0];
+});
+
 IREE_VM_ABI_VLA_STRUCT(rriCirIID, a3_count, a3, {
   iree_vm_ref_t r0;
   iree_vm_ref_t r1;
@@ -458,6 +554,7 @@ IREE_VM_ABI_VLA_STRUCT(rriCirIID, a3_count, a3, {
 //===----------------------------------------------------------------------===//
 
 IREE_VM_ABI_DECLARE_SHIM(irIi, v);
+IREE_VM_ABI_DECLARE_SHIM(irIIII, v);
 IREE_VM_ABI_DECLARE_SHIM(r, i);
 IREE_VM_ABI_DECLARE_SHIM(r, I);
 IREE_VM_ABI_DECLARE_SHIM(r, ii);
@@ -476,6 +573,10 @@ IREE_VM_ABI_DECLARE_SHIM(ri, v);
 IREE_VM_ABI_DECLARE_SHIM(rI, i);
 IREE_VM_ABI_DECLARE_SHIM(rI, r);
 IREE_VM_ABI_DECLARE_SHIM(rI, v);
+IREE_VM_ABI_DECLARE_SHIM(rIIIrIIIII, v);
+IREE_VM_ABI_DECLARE_SHIM(rIIIrIIIrIIIII, v);
+IREE_VM_ABI_DECLARE_SHIM(rIIrIIrIIIIIi, v);
+IREE_VM_ABI_DECLARE_SHIM(rIIrIIrIIIIIiiii, v);
 IREE_VM_ABI_DECLARE_SHIM(riCiD, r);
 IREE_VM_ABI_DECLARE_SHIM(riiCID, r);
 IREE_VM_ABI_DECLARE_SHIM(riCiiD, r);
@@ -498,8 +599,10 @@ IREE_VM_ABI_DECLARE_SHIM(rr, v);
 IREE_VM_ABI_DECLARE_SHIM(rr, ii);
 IREE_VM_ABI_DECLARE_SHIM(rrr, ii);
 IREE_VM_ABI_DECLARE_SHIM(rrCirIID, r);
+IREE_VM_ABI_DECLARE_SHIM(rrCrD, v);
 IREE_VM_ABI_DECLARE_SHIM(rriCiD, v);
 IREE_VM_ABI_DECLARE_SHIM(rriiCID, v);
+IREE_VM_ABI_DECLARE_SHIM(rriCiiIID, v);
 IREE_VM_ABI_DECLARE_SHIM(rriCirIID, v);
 IREE_VM_ABI_DECLARE_SHIM(rriiii, v);
 IREE_VM_ABI_DECLARE_SHIM(rrIIii, v);
@@ -9,6 +9,7 @@
 #include <assert.h>
 #include <inttypes.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <string.h>
 
 #include "iree/base/alignment.h"
@@ -145,6 +146,12 @@ typedef struct iree_vm_stack_frame_header_t {
   // Function called when the stack frame is left.
   iree_vm_stack_frame_cleanup_fn_t frame_cleanup_fn;
 
+  // Byte offset relative to this header and length of the storage within the
+  // frame that a yielding callee writes its results into when resumed. Empty
+  // if the frame has no call in-flight that may yield.
+  iree_host_size_t results_offset;
+  iree_host_size_t results_length;
+
   // Actual stack frame as visible through the API.
   // The registers within the frame will (likely) point to addresses immediately
   // following this header in memory.
@@ -185,6 +192,9 @@ struct iree_vm_stack_t {
   // This will be called on function entry whenever module transitions occur.
   iree_vm_state_resolver_t state_resolver;
 
+  // Optional unowned profile that execution is recorded into.
+  iree_vm_profile_t* profile;
+
   // Allocator used for dynamic stack allocations. May be the null allocator
   // if growth is prohibited.
   iree_allocator_t allocator;
@@ -283,6 +293,16 @@ iree_vm_stack_invocation_flags(const iree_vm_stack_t* stack) {
   return stack->flags;
 }
 
+IREE_API_EXPORT iree_vm_profile_t* iree_vm_stack_profile(
+    const iree_vm_stack_t* stack) {
+  return stack->profile;
+}
+
+IREE_API_EXPORT void iree_vm_stack_set_profile(iree_vm_stack_t* stack,
+                                               iree_vm_profile_t* profile) {
+  stack->profile = profile;
+}
+
 IREE_API_EXPORT iree_vm_stack_frame_t* iree_vm_stack_top(
     iree_vm_stack_t* stack) {
   if (!stack->top) {
@@ -614,6 +634,41 @@ iree_vm_stack_function_leave(iree_vm_stack_t* stack) {
   return iree_ok_status();
 }
 
+// Returns the header of |frame| that precedes it in the stack storage.
+static iree_vm_stack_frame_header_t* iree_vm_stack_frame_header(
+    iree_vm_stack_frame_t* frame) {
+  return (iree_vm_stack_frame_header_t*)((uintptr_t)frame -
+                                         offsetof(iree_vm_stack_frame_header_t,
+                                                  frame));
+}
+
+IREE_API_EXPORT void iree_vm_stack_set_call_results(
+    iree_vm_stack_t* stack, iree_vm_stack_frame_t* caller_frame,
+    iree_byte_span_t results) {
+  iree_vm_stack_frame_header_t* frame_header =
+      iree_vm_stack_frame_header(caller_frame);
+  IREE_ASSERT(iree_byte_span_is_empty(results) ||
+              ((uintptr_t)results.data >= (uintptr_t)frame_header &&
+               (uintptr_t)results.data + results.data_length <=
+                   (uintptr_t)frame_header + frame_header->frame_size));
+  frame_header->results_offset =
+      results.data_length ? (uintptr_t)results.data - (uintptr_t)frame_header
+                          : 0;
+  frame_header->results_length = results.data_length;
+}
+
+IREE_API_EXPORT iree_byte_span_t iree_vm_stack_call_results(
+    iree_vm_stack_t* stack, iree_vm_stack_frame_t* callee_frame) {
+  iree_vm_stack_frame_header_t* caller_header =
+      iree_vm_stack_frame_header(callee_frame)->parent;
+  if (!caller_header || !caller_header->results_length) {
+    return iree_byte_span_empty();
+  }
+  return iree_make_byte_span(
+      (uint8_t*)caller_header + caller_header->results_offset,
+      caller_header->results_length);
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_stack_format_backtrace(
     iree_vm_stack_t* stack, iree_string_builder_t* builder) {
   for (iree_vm_stack_frame_header_t* frame = stack->top; frame != NULL;
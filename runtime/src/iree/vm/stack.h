@@ -16,6 +16,7 @@
 #include "iree/base/string_builder.h"
 #include "iree/base/tracing.h"
 #include "iree/vm/module.h"
+#include "iree/vm/profile.h"
 #include "iree/vm/ref.h"
 
 #ifdef __cplusplus
@@ -244,6 +245,15 @@ IREE_API_EXPORT void iree_vm_stack_free(iree_vm_stack_t* stack);
 IREE_API_EXPORT iree_vm_invocation_flags_t
 iree_vm_stack_invocation_flags(const iree_vm_stack_t* stack);
 
+// Returns the profile that execution on the stack is recorded into, if any.
+IREE_API_EXPORT iree_vm_profile_t* iree_vm_stack_profile(
+    const iree_vm_stack_t* stack);
+
+// Sets the |profile| that execution on the stack is recorded into. The profile
+// is unowned and must remain valid for the lifetime of the stack.
+IREE_API_EXPORT void iree_vm_stack_set_profile(iree_vm_stack_t* stack,
+                                               iree_vm_profile_t* profile);
+
 // Returns the top stack execution frame, ignore wait frames.
 IREE_API_EXPORT iree_vm_stack_frame_t* iree_vm_stack_top(
     iree_vm_stack_t* stack);
@@ -306,6 +316,21 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_function_enter(
 IREE_API_EXPORT iree_status_t
 iree_vm_stack_function_leave(iree_vm_stack_t* stack);
 
+// Records |results| within the storage of |caller_frame| as where the callee
+// of |caller_frame| writes its results if it yields and is later resumed.
+// The location is tracked relative to the frame such that it remains valid
+// across stack growth. Pass an empty span to clear the results once the call
+// has completed.
+IREE_API_EXPORT void iree_vm_stack_set_call_results(
+    iree_vm_stack_t* stack, iree_vm_stack_frame_t* caller_frame,
+    iree_byte_span_t results);
+
+// Returns the results storage the caller of |callee_frame| recorded with
+// iree_vm_stack_set_call_results or an empty span if none was recorded.
+// The returned pointer is invalidated when the stack grows.
+IREE_API_EXPORT iree_byte_span_t iree_vm_stack_call_results(
+    iree_vm_stack_t* stack, iree_vm_stack_frame_t* callee_frame);
+
 // Formats a backtrace of the current stack to the given string |builder|.
 IREE_API_EXPORT iree_status_t iree_vm_stack_format_backtrace(
     iree_vm_stack_t* stack, iree_string_builder_t* builder);
@@ -50,4 +50,22 @@ vm.module @async_ops {
     vm.return %result : i32
   }
 
+  //===--------------------------------------------------------------------===//
+  // Yielding imports
+  //===--------------------------------------------------------------------===//
+
+  vm.import @yieldable_test.yield_add_1(%arg0 : i32) -> i32
+
+  // Tests calling an import that yields; the import results must be available
+  // to the caller after it is resumed.
+  //
+  // Expects a result of %arg0 + 2.
+  vm.export @call_yielding_import
+  vm.func @call_yielding_import(%arg0: i32) -> i32 {
+    %0 = vm.call @yieldable_test.yield_add_1(%arg0) : (i32) -> i32
+    %c1 = vm.const.i32 1
+    %1 = vm.add.i32 %0, %c1 : i32
+    vm.return %1 : i32
+  }
+
 }
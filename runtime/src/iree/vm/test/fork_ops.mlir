@@ -0,0 +1,74 @@
+// Tested by iree/vm/bytecode_fork_test.cc.
+//
+// Each function changes module state such that the test can check that the
+// state of forked contexts is isolated from their parent and siblings.
+
+vm.module @fork_ops {
+
+  // Primitive global copied into forks.
+  vm.global.i32 private mutable @counter : i32
+
+  // Buffer only assigned by the initializer that forks share with the parent.
+  vm.global.ref private @shared : !vm.buffer
+
+  // Buffer stored to after initialization that forks must clone.
+  vm.global.ref private mutable @scratch : !vm.buffer
+
+  // List stored to after initialization that cannot be cloned.
+  vm.global.ref private mutable @list : !vm.list<i32>
+
+  vm.initializer {
+    %c16 = vm.const.i64 16
+    %buffer = vm.buffer.alloc %c16 : !vm.buffer
+    vm.global.store.ref %buffer, @shared : !vm.buffer
+    vm.return
+  }
+
+  // Increments @counter and returns the new value.
+  vm.export @increment
+  vm.func @increment() -> i32 {
+    %c1 = vm.const.i32 1
+    %value = vm.global.load.i32 @counter : i32
+    %new_value = vm.add.i32 %value, %c1 : i32
+    vm.global.store.i32 %new_value, @counter : i32
+    vm.return %new_value : i32
+  }
+
+  // Returns the @shared buffer such that its identity can be compared.
+  vm.export @get_shared
+  vm.func @get_shared() -> !vm.buffer {
+    %buffer = vm.global.load.ref @shared : !vm.buffer
+    vm.return %buffer : !vm.buffer
+  }
+
+  // Allocates a zeroed @scratch buffer.
+  vm.export @alloc_scratch
+  vm.func @alloc_scratch() {
+    %c4 = vm.const.i64 4
+    %buffer = vm.buffer.alloc %c4 : !vm.buffer
+    vm.global.store.ref %buffer, @scratch : !vm.buffer
+    vm.return
+  }
+
+  // Increments the i32 stored in @scratch in-place and returns the new value.
+  vm.export @increment_scratch
+  vm.func @increment_scratch() -> i32 {
+    %c0 = vm.const.i64 0
+    %c1 = vm.const.i32 1
+    %buffer = vm.global.load.ref @scratch : !vm.buffer
+    %value = vm.buffer.load.i32 %buffer[%c0] : !vm.buffer -> i32
+    %new_value = vm.add.i32 %value, %c1 : i32
+    vm.buffer.store.i32 %new_value, %buffer[%c0] : i32 -> !vm.buffer
+    vm.return %new_value : i32
+  }
+
+  // Allocates an empty @list.
+  vm.export @alloc_list
+  vm.func @alloc_list() {
+    %c1 = vm.const.i32 1
+    %list = vm.list.alloc %c1 : (i32) -> !vm.list<i32>
+    vm.global.store.ref %list, @list : !vm.list<i32>
+    vm.return
+  }
+
+}
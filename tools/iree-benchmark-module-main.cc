@@ -51,12 +51,25 @@
 // how the full program will run, though, and YMMV. Always verify timings with
 // an appropriate device-specific tool before trusting the more generic and
 // higher-level numbers from this tool.
+//
+// Google Benchmark runs calls back-to-back on a single thread and cannot
+// measure latency under load. For that an open-loop load test can be run with
+// --load_concurrency=N and --load_rate=R: requests to --entry_function arrive
+// at a fixed rate of R per second regardless of whether earlier requests have
+// completed and N callers (each with its own fork of the context) service them
+// in arrival order. Latency is measured from the scheduled arrival time so
+// that queueing behind slow requests is included instead of hidden (avoiding
+// coordinated omission). Latency percentiles, achieved throughput, and a time
+// series of queueing delay are reported.
 
 #include <array>
+#include <atomic>
 #include <cstdio>
 #include <iostream>
 #include <iterator>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -70,9 +83,10 @@
 #include "iree/hal/api.h"
 #include "iree/modules/hal/module.h"
 #include "iree/tooling/device_util.h"
+#include "iree/tooling/latency_stats.h"
+#include "iree/tooling/module_util.h"
 #include "iree/tooling/vm_util.h"
 #include "iree/vm/api.h"
-#include "iree/vm/bytecode_module.h"
 #include "iree/vm/ref_cc.h"
 
 IREE_FLAG(string, module_file, "-",
@@ -92,7 +106,26 @@ IREE_FLAG(string, entry_function, "",
           "benchmarked and they are expected to not have input arguments.");
 
 IREE_FLAG(bool, print_statistics, false,
-          "Prints runtime statistics to stderr on exit.");
+          "Prints runtime statistics and any live buffers to stderr on exit.");
+
+IREE_FLAG(bool, print_vm_profile, false,
+          "Prints the VM instruction profile to stderr on exit. Requires a "
+          "runtime built with -DIREE_VM_EXECUTION_PROFILING_ENABLE=1. Load "
+          "tests print the combined profile of all callers.");
+
+IREE_FLAG(int32_t, load_concurrency, 0,
+          "Runs an open-loop load test of --entry_function with this many "
+          "concurrent callers instead of the benchmarks. Each caller invokes "
+          "its own fork of the context; programs holding non-VM objects "
+          "(such as HAL buffers) in mutable globals cannot be forked.");
+IREE_FLAG(double, load_rate, 0.0,
+          "Target arrival rate of the load test in requests per second across "
+          "all callers. Requests arrive on a fixed schedule regardless of "
+          "whether earlier requests have completed.");
+IREE_FLAG(double, load_duration, 10.0,
+          "Duration in seconds over which load test requests arrive.");
+IREE_FLAG(double, load_report_interval, 1.0,
+          "Interval in seconds of the load test time series.");
 
 static iree_status_t parse_function_input(iree_string_view_t flag_name,
                                           void* storage,
@@ -247,6 +280,172 @@ void RegisterDispatchBenchmark(const std::string& function_name,
       ->Unit(benchmark::kMicrosecond);
 }
 
+//===----------------------------------------------------------------------===//
+// Open-loop load test
+//===----------------------------------------------------------------------===//
+
+// Timing of a single load test request relative to the start of the test.
+struct LoadRequest {
+  // Time the request was scheduled to arrive.
+  iree_duration_t scheduled_ns = 0;
+  // Time a caller began invoking the request.
+  iree_duration_t started_ns = 0;
+  // Time the invocation completed or 0 if it was never issued.
+  iree_duration_t completed_ns = 0;
+};
+
+// State shared by all callers in a load test.
+struct LoadState {
+  iree_time_t start_ns = 0;
+  iree_duration_t arrival_interval_ns = 0;
+  // One entry per request in arrival order. Each entry is only written by the
+  // caller that claimed it.
+  std::vector<LoadRequest> requests;
+  std::atomic<size_t> next_request{0};
+  std::atomic<bool> failed{false};
+  std::mutex status_mutex;
+  iree_status_t status = iree_ok_status();
+};
+
+// Services requests in arrival order until all have been claimed. Each request
+// is started no earlier than its scheduled arrival time and if all callers are
+// busy it queues until one becomes available.
+static void RunLoadCaller(LoadState* state, iree_vm_context_t* context,
+                          iree_vm_function_t function, iree_vm_list_t* inputs) {
+  IREE_TRACE_SCOPE0("RunLoadCaller");
+  vm::ref<iree_vm_list_t> outputs;
+  iree_status_t status = iree_vm_list_create(
+      /*element_type=*/nullptr, 16, iree_allocator_system(), &outputs);
+  while (iree_status_is_ok(status) && !state->failed.load()) {
+    size_t i = state->next_request.fetch_add(1);
+    if (i >= state->requests.size()) break;
+    LoadRequest& request = state->requests[i];
+    request.scheduled_ns = (iree_duration_t)i * state->arrival_interval_ns;
+    iree_wait_until(state->start_ns + request.scheduled_ns);
+    request.started_ns = iree_time_now() - state->start_ns;
+    IREE_TRACE_FRAME_MARK_NAMED("Request");
+    status = iree_vm_invoke(context, function, IREE_VM_INVOCATION_FLAG_NONE,
+                            /*policy=*/nullptr, inputs, outputs.get(),
+                            iree_allocator_system());
+    if (iree_status_is_ok(status)) {
+      status = iree_vm_list_resize(outputs.get(), 0);
+    }
+    request.completed_ns = iree_time_now() - state->start_ns;
+  }
+  if (!iree_status_is_ok(status)) {
+    std::lock_guard<std::mutex> lock(state->status_mutex);
+    state->failed = true;
+    if (iree_status_is_ok(state->status)) {
+      state->status = status;
+    } else {
+      iree_status_ignore(status);
+    }
+  }
+}
+
+static void PrintLatencySummary(const char* label,
+                                const iree_latency_summary_t& summary) {
+  fprintf(stdout,
+          "  %-10s p50 %9.3fms  p90 %9.3fms  p99 %9.3fms  p99.9 %9.3fms  "
+          "max %9.3fms\n",
+          label, summary.p50 / 1e6, summary.p90 / 1e6, summary.p99 / 1e6,
+          summary.p999 / 1e6, summary.max / 1e6);
+}
+
+// Prints the aggregate latency distribution and a time series of the requests
+// in |state|. Intervals in the time series are by scheduled arrival time with
+// the exception of completions which are counted in the interval they
+// completed in to report the achieved throughput over time.
+static iree_status_t ReportLoadTest(const LoadState& state) {
+  iree_latency_samples_t latency, queueing, service;
+  iree_latency_samples_initialize(iree_allocator_system(), &latency);
+  iree_latency_samples_initialize(iree_allocator_system(), &queueing);
+  iree_latency_samples_initialize(iree_allocator_system(), &service);
+
+  iree_duration_t report_interval_ns =
+      iree_max(1, (iree_duration_t)(FLAG_load_report_interval * 1e9));
+  iree_duration_t end_ns = 0;
+  for (const LoadRequest& request : state.requests) {
+    end_ns = iree_max(end_ns, request.completed_ns);
+  }
+  size_t interval_count = (size_t)(end_ns / report_interval_ns) + 1;
+  std::vector<size_t> interval_completions(interval_count, 0);
+
+  iree_status_t status = iree_ok_status();
+  for (const LoadRequest& request : state.requests) {
+    if (!iree_status_is_ok(status)) break;
+    status = iree_latency_samples_append(
+        &latency, request.completed_ns - request.scheduled_ns);
+    if (iree_status_is_ok(status)) {
+      status = iree_latency_samples_append(
+          &queueing, request.started_ns - request.scheduled_ns);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_latency_samples_append(
+          &service, request.completed_ns - request.started_ns);
+    }
+    ++interval_completions[request.completed_ns / report_interval_ns];
+  }
+
+  if (iree_status_is_ok(status)) {
+    iree_latency_summary_t latency_summary, queueing_summary, service_summary;
+    iree_latency_samples_summarize(&latency, &latency_summary);
+    iree_latency_samples_summarize(&queueing, &queueing_summary);
+    iree_latency_samples_summarize(&service, &service_summary);
+    fprintf(stdout,
+            "Open-loop load test: %d callers, %.3f req/s target over %.3fs\n",
+            FLAG_load_concurrency, FLAG_load_rate, FLAG_load_duration);
+    fprintf(stdout,
+            "  %-10s %zu completed in %.3fs (%.3f req/s achieved)\n",
+            "requests", state.requests.size(), end_ns / 1e9,
+            end_ns ? state.requests.size() / (end_ns / 1e9) : 0.0);
+    PrintLatencySummary("latency", latency_summary);
+    PrintLatencySummary("queueing", queueing_summary);
+    PrintLatencySummary("service", service_summary);
+  }
+
+  // Time series of latency and queueing delay by arrival interval.
+  if (iree_status_is_ok(status)) {
+    fprintf(stdout,
+            "  %10s %9s %12s %12s %12s %12s %12s\n", "interval", "arrivals",
+            "done req/s", "p50 ms", "p99 ms", "queue avg ms", "queue max ms");
+  }
+  size_t request_index = 0;
+  for (size_t interval = 0;
+       interval < interval_count && iree_status_is_ok(status); ++interval) {
+    iree_latency_samples_reset(&latency);
+    iree_latency_samples_reset(&queueing);
+    iree_duration_t interval_end_ns =
+        (iree_duration_t)(interval + 1) * report_interval_ns;
+    for (; request_index < state.requests.size() && iree_status_is_ok(status);
+         ++request_index) {
+      const LoadRequest& request = state.requests[request_index];
+      if (request.scheduled_ns >= interval_end_ns) break;
+      status = iree_latency_samples_append(
+          &latency, request.completed_ns - request.scheduled_ns);
+      if (iree_status_is_ok(status)) {
+        status = iree_latency_samples_append(
+            &queueing, request.started_ns - request.scheduled_ns);
+      }
+    }
+    if (!iree_status_is_ok(status)) break;
+    iree_latency_summary_t latency_summary, queueing_summary;
+    iree_latency_samples_summarize(&latency, &latency_summary);
+    iree_latency_samples_summarize(&queueing, &queueing_summary);
+    fprintf(stdout,
+            "  %9.3fs %9zu %12.3f %12.3f %12.3f %12.3f %12.3f\n",
+            (interval * report_interval_ns) / 1e9, latency_summary.count,
+            interval_completions[interval] / (report_interval_ns / 1e9),
+            latency_summary.p50 / 1e6, latency_summary.p99 / 1e6,
+            queueing_summary.mean / 1e6, queueing_summary.max / 1e6);
+  }
+
+  iree_latency_samples_deinitialize(&latency);
+  iree_latency_samples_deinitialize(&queueing);
+  iree_latency_samples_deinitialize(&service);
+  return status;
+}
+
 iree_status_t GetModuleContentsFromFlags(iree_file_contents_t** out_contents) {
   IREE_TRACE_SCOPE0("GetModuleContentsFromFlags");
   auto module_file = std::string(FLAG_module_file);
@@ -254,8 +453,9 @@ iree_status_t GetModuleContentsFromFlags(iree_file_contents_t** out_contents) {
     std::cout << "Reading module contents from stdin...\n";
     return iree_stdin_read_contents(iree_allocator_system(), out_contents);
   } else {
-    return iree_file_read_contents(module_file.c_str(), iree_allocator_system(),
-                                   out_contents);
+    return iree_file_read_contents_with_flags(
+        module_file.c_str(), IREE_FILE_READ_FLAG_MMAP, iree_allocator_system(),
+        out_contents);
   }
 }
 
@@ -274,6 +474,16 @@ class IREEBenchmark {
 
     // Order matters.
     inputs_.reset();
+    if (FLAG_print_vm_profile && context_) {
+      iree_vm_profile_t* profile = iree_vm_context_profile(context_);
+      if (profile) {
+        IREE_IGNORE_ERROR(
+            iree_vm_profile_fprint(stderr, profile, /*top_count=*/32));
+      } else {
+        fprintf(stderr,
+                "VM execution profiling not available in this build\n");
+      }
+    }
     iree_vm_context_release(context_);
     iree_vm_module_release(hal_module_);
     iree_vm_module_release(input_module_);
@@ -285,6 +495,87 @@ class IREEBenchmark {
     iree_vm_instance_release(instance_);
   };
 
+  // Runs the open-loop load test configured by the --load_* flags.
+  iree_status_t RunLoadTest() {
+    IREE_TRACE_SCOPE0("IREEBenchmark::RunLoadTest");
+
+    auto function_name = std::string(FLAG_entry_function);
+    if (function_name.empty()) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "--entry_function must be specified when "
+                              "running a load test");
+    }
+    if (FLAG_load_rate <= 0.0 || FLAG_load_duration <= 0.0) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "--load_rate and --load_duration must be > 0");
+    }
+
+    if (!instance_ || !device_ || !hal_module_ || !context_ || !input_module_) {
+      IREE_RETURN_IF_ERROR(Init());
+    }
+
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(iree_vm_module_lookup_function_by_name(
+        input_module_, IREE_VM_FUNCTION_LINKAGE_EXPORT,
+        iree_string_view_t{function_name.data(), function_name.size()},
+        &function));
+    IREE_RETURN_IF_ERROR(ParseToVariantList(
+        iree_hal_device_allocator(device_),
+        iree::span<const std::string>{FLAG_function_inputs.data(),
+                                      FLAG_function_inputs.size()},
+        &inputs_));
+
+    // Each caller gets its own fork of the context so that callers need not
+    // synchronize. The inputs are shared and must only be read by the callee.
+    std::vector<iree_vm_context_t*> caller_contexts(FLAG_load_concurrency,
+                                                    nullptr);
+    iree_status_t status = iree_ok_status();
+    for (auto& caller_context : caller_contexts) {
+      status = iree_vm_context_fork(context_, iree_allocator_system(),
+                                    &caller_context);
+      if (!iree_status_is_ok(status)) break;
+    }
+
+    LoadState state;
+    state.arrival_interval_ns = (iree_duration_t)(1e9 / FLAG_load_rate);
+    state.requests.resize(
+        iree_max(1, (size_t)(FLAG_load_duration * FLAG_load_rate)));
+    if (iree_status_is_ok(status)) {
+      state.start_ns = iree_time_now();
+      std::vector<std::thread> callers;
+      callers.reserve(caller_contexts.size());
+      for (iree_vm_context_t* caller_context : caller_contexts) {
+        callers.emplace_back(RunLoadCaller, &state, caller_context, function,
+                             inputs_.get());
+      }
+      for (auto& caller : callers) {
+        caller.join();
+      }
+      status = state.status;
+    }
+    // Callers ran in forks with their own profiles; fold them into the
+    // profile of the parent context that is printed on exit.
+    iree_vm_profile_t* profile =
+        context_ ? iree_vm_context_profile(context_) : nullptr;
+    for (iree_vm_context_t* caller_context : caller_contexts) {
+      iree_vm_profile_t* caller_profile =
+          caller_context ? iree_vm_context_profile(caller_context) : nullptr;
+      if (iree_status_is_ok(status) && profile && caller_profile) {
+        status = iree_vm_profile_merge(profile, caller_profile);
+      }
+      iree_vm_context_release(caller_context);
+    }
+
+    // Force a full flush and get the device back to an idle state.
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_device_wait_idle(device_, iree_infinite_timeout());
+    }
+    if (iree_status_is_ok(status)) {
+      status = ReportLoadTest(state);
+    }
+    return status;
+  }
+
   iree_status_t Register() {
     IREE_TRACE_SCOPE0("IREEBenchmark::Register");
 
@@ -318,8 +609,9 @@ class IREEBenchmark {
     IREE_RETURN_IF_ERROR(iree_hal_create_device_from_flags(
         iree_hal_default_device_uri(), iree_allocator_system(), &device_));
     IREE_RETURN_IF_ERROR(
-        iree_hal_module_create(device_, iree_allocator_system(), &hal_module_));
-    IREE_RETURN_IF_ERROR(iree_vm_bytecode_module_create(
+        iree_hal_module_create(device_, IREE_HAL_MODULE_FLAG_NONE,
+                               iree_allocator_system(), &hal_module_));
+    IREE_RETURN_IF_ERROR(iree_tooling_create_module_from_flags(
         flatbuffer_contents->const_buffer,
         iree_file_contents_deallocator(flatbuffer_contents),
         iree_allocator_system(), &input_module_));
@@ -328,8 +620,10 @@ class IREEBenchmark {
     // module.
     std::array<iree_vm_module_t*, 2> modules = {hal_module_, input_module_};
     IREE_RETURN_IF_ERROR(iree_vm_context_create_with_modules(
-        instance_, IREE_VM_CONTEXT_FLAG_NONE, modules.size(), modules.data(),
-        iree_allocator_system(), &context_));
+        instance_,
+        FLAG_print_vm_profile ? IREE_VM_CONTEXT_FLAG_PROFILE_EXECUTION
+                              : IREE_VM_CONTEXT_FLAG_NONE,
+        modules.size(), modules.data(), iree_allocator_system(), &context_));
 
     IREE_TRACE_FRAME_MARK_END_NAMED("init");
     return iree_ok_status();
@@ -428,12 +722,16 @@ int main(int argc, char** argv) {
   ::benchmark::Initialize(&argc, argv);
 
   iree::IREEBenchmark iree_benchmark;
-  iree_status_t status = iree_benchmark.Register();
+  const bool run_load_test = FLAG_load_concurrency > 0;
+  iree_status_t status = run_load_test ? iree_benchmark.RunLoadTest()
+                                       : iree_benchmark.Register();
   if (!iree_status_is_ok(status)) {
     int ret = static_cast<int>(iree_status_code(status));
     std::cout << iree::Status(std::move(status)) << std::endl;
     return ret;
   }
-  ::benchmark::RunSpecifiedBenchmarks();
+  if (!run_load_test) {
+    ::benchmark::RunSpecifiedBenchmarks();
+  }
   return 0;
 }
@@ -6,7 +6,21 @@
 
 // DISCLAIMER: this is leaky under error conditions as it's a benchmark tool and
 // not a correctness test.
-
+//
+// By default each trace file is registered as a benchmark that runs all calls
+// in the trace back-to-back. With --replay_repetitions=N each trace is instead
+// replayed N times (after --replay_warmup untimed repetitions) and the latency
+// distribution of every call and of the whole trace is reported along with the
+// allocator activity of the timed repetitions. Each repetition starts from a
+// fork of the context as loaded by the trace such that stateful calls observe
+// the same state every repetition. Programs that cannot be forked (such as
+// those holding HAL buffers in mutable globals) instead reload the context
+// before each repetition. --replay_json=path emits the results as JSON
+// that can be compared across runs to track regressions on captured production
+// call sequences.
+
+#include <errno.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -17,17 +31,36 @@
 #include "iree/hal/api.h"
 #include "iree/testing/benchmark.h"
 #include "iree/tooling/device_util.h"
+#include "iree/tooling/latency_stats.h"
 #include "iree/tooling/trace_replay.h"
 #include "iree/tooling/yaml_util.h"
 #include "iree/vm/api.h"
 
 IREE_FLAG(bool, print_statistics, false,
-          "Prints runtime statistics to stderr on exit.");
+          "Prints runtime statistics and any live buffers to stderr on exit.");
 
 IREE_FLAG(int32_t, call_iterations, 1,
           "Number of times to invoke each call in the trace. May break usage "
           "with stateful models.");
 
+IREE_FLAG(int32_t, replay_repetitions, 0,
+          "Replays each trace this many times and reports per-call latency "
+          "distributions instead of running the benchmarks.");
+IREE_FLAG(int32_t, replay_warmup, 1,
+          "Number of untimed repetitions of each trace before the timed "
+          "--replay_repetitions.");
+IREE_FLAG(bool, replay_reset_state, true,
+          "Runs each replay repetition on a fork of the context as loaded by "
+          "the trace so that stateful calls observe the same state each "
+          "repetition. Programs holding non-VM objects (such as HAL buffers) "
+          "in mutable globals cannot be forked and instead have their context "
+          "reloaded and initializers rerun before each repetition; allocator "
+          "statistics then include the initializers. When false state carries "
+          "over between repetitions.");
+IREE_FLAG(string, replay_json, "",
+          "Writes replay results as JSON to the given file path or stdout if "
+          "'-'.");
+
 // A benchmark registration for each file to run.
 typedef struct iree_replay_benchmark_registration_t {
   iree_benchmark_def_t benchmark_def;  // Must be first.
@@ -188,19 +221,17 @@ static iree_status_t iree_replay_benchmark_load_trace(
   return status;
 }
 
-// Benchmark function that runs a trace file.
-static iree_status_t iree_replay_benchmark_run_file(
-    const iree_benchmark_def_t* benchmark_def,
-    iree_benchmark_state_t* benchmark_state) {
-  const iree_replay_benchmark_registration_t* registration =
-      (const iree_replay_benchmark_registration_t*)benchmark_def->user_data;
-
+// Initializes |out_replay| and loads the trace file of |registration| such that
+// all modules are loaded and ready and the calls are in |out_call_list|.
+static iree_status_t iree_replay_benchmark_setup(
+    const iree_replay_benchmark_registration_t* registration,
+    iree_trace_replay_t* out_replay,
+    iree_replay_benchmark_call_list_t* out_call_list) {
   // Setup replay state used for this benchmark.
-  iree_trace_replay_t replay;
   IREE_RETURN_IF_ERROR(iree_trace_replay_initialize(
       registration->root_path, registration->instance,
       IREE_VM_CONTEXT_FLAG_NONE, iree_hal_available_driver_registry(),
-      iree_allocator_system(), &replay));
+      iree_allocator_system(), out_replay));
 
   // Query device overrides, if any. When omitted the devices from the trace
   // file will be used.
@@ -208,14 +239,26 @@ static iree_status_t iree_replay_benchmark_run_file(
   iree_host_size_t device_uri_count = 0;
   iree_string_view_t* device_uris = NULL;
   iree_hal_get_devices_flag_list(&device_uri_count, &device_uris);
-  iree_trace_replay_set_hal_devices_override(&replay, device_uri_count,
+  iree_trace_replay_set_hal_devices_override(out_replay, device_uri_count,
                                              device_uris);
 
   // Load YAML file and setup replay state with all modules loaded and ready.
+  iree_replay_benchmark_call_list_initialize(out_call_list);
+  return iree_replay_benchmark_load_trace(registration->file_path, out_replay,
+                                          out_call_list);
+}
+
+// Benchmark function that runs a trace file.
+static iree_status_t iree_replay_benchmark_run_file(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  const iree_replay_benchmark_registration_t* registration =
+      (const iree_replay_benchmark_registration_t*)benchmark_def->user_data;
+
+  iree_trace_replay_t replay;
   iree_replay_benchmark_call_list_t call_list;
-  iree_replay_benchmark_call_list_initialize(&call_list);
-  IREE_RETURN_IF_ERROR(iree_replay_benchmark_load_trace(registration->file_path,
-                                                        &replay, &call_list));
+  IREE_RETURN_IF_ERROR(
+      iree_replay_benchmark_setup(registration, &replay, &call_list));
 
   // Call the functions within the trace in order.
   while (iree_benchmark_keep_running(benchmark_state,
@@ -240,6 +283,428 @@ static iree_status_t iree_replay_benchmark_run_file(
   return iree_ok_status();
 }
 
+//===----------------------------------------------------------------------===//
+// Replay mode
+//===----------------------------------------------------------------------===//
+
+// Appends |value| to |builder| as a quoted and escaped JSON string.
+static iree_status_t iree_replay_benchmark_append_json_string(
+    iree_string_builder_t* builder, iree_string_view_t value) {
+  IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(builder, "\""));
+  for (iree_host_size_t i = 0; i < value.size; ++i) {
+    char c = value.data[i];
+    if (c == '"' || c == '\\') {
+      IREE_RETURN_IF_ERROR(
+          iree_string_builder_append_format(builder, "\\%c", c));
+    } else if ((unsigned char)c < 0x20) {
+      IREE_RETURN_IF_ERROR(
+          iree_string_builder_append_format(builder, "\\u%04x", c));
+    } else {
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_string(
+          builder, iree_make_string_view(&c, 1)));
+    }
+  }
+  return iree_string_builder_append_cstring(builder, "\"");
+}
+
+// Appends |summary| to |builder| as a JSON object with nanosecond values.
+static iree_status_t iree_replay_benchmark_append_json_summary(
+    iree_string_builder_t* builder, const iree_latency_summary_t* summary) {
+  return iree_string_builder_append_format(
+      builder,
+      "{\"count\": %" PRIhsz ", \"total_ns\": %" PRId64
+      ", \"min_ns\": %" PRId64 ", \"mean_ns\": %" PRId64
+      ", \"p50_ns\": %" PRId64 ", \"p90_ns\": %" PRId64
+      ", \"p99_ns\": %" PRId64 ", \"p999_ns\": %" PRId64
+      ", \"max_ns\": %" PRId64 "}",
+      summary->count, summary->total, summary->min, summary->mean,
+      summary->p50, summary->p90, summary->p99, summary->p999, summary->max);
+}
+
+// Appends the allocator |statistics| to |builder| as a JSON object or null if
+// statistics are not enabled. Counters cover only the timed repetitions while
+// peaks are process-wide high-water marks.
+static iree_status_t iree_replay_benchmark_append_json_statistics(
+    iree_string_builder_t* builder,
+    const iree_hal_allocator_statistics_t* statistics) {
+#if IREE_STATISTICS_ENABLE
+  IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+      builder,
+      "{\"host_bytes_peak\": %" PRIu64 ", \"host_bytes_allocated\": %" PRIu64
+      ", \"host_bytes_freed\": %" PRIu64 ", \"device_bytes_peak\": %" PRIu64
+      ", \"device_bytes_allocated\": %" PRIu64
+      ", \"device_bytes_freed\": %" PRIu64 ", \"allocation_count\": %" PRIu64
+      ", \"free_count\": %" PRIu64 ", \"map_count\": %" PRIu64
+      ", \"flush_count\": %" PRIu64 ", \"invalidate_count\": %" PRIu64
+      ", \"size_histogram\": [",
+      (uint64_t)statistics->host_bytes_peak,
+      (uint64_t)statistics->host_bytes_allocated,
+      (uint64_t)statistics->host_bytes_freed,
+      (uint64_t)statistics->device_bytes_peak,
+      (uint64_t)statistics->device_bytes_allocated,
+      (uint64_t)statistics->device_bytes_freed, statistics->allocation_count,
+      statistics->free_count, statistics->map_count, statistics->flush_count,
+      statistics->invalidate_count));
+  for (int i = 0; i < IREE_HAL_ALLOCATOR_STATISTICS_SIZE_BUCKET_COUNT; ++i) {
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder, "%s%" PRIu64, i ? ", " : "", statistics->size_histogram[i]));
+  }
+  return iree_string_builder_append_cstring(builder, "]}");
+#else
+  return iree_string_builder_append_cstring(builder, "null");
+#endif  // IREE_STATISTICS_ENABLE
+}
+
+// Stores the difference between allocator statistics |after| and |before| in
+// |out_delta| such that only activity between the two snapshots is reported.
+// Peaks are high-water marks that cannot be attributed to a window and are
+// passed through from |after|.
+static void iree_replay_benchmark_subtract_statistics(
+    const iree_hal_allocator_statistics_t* after,
+    const iree_hal_allocator_statistics_t* before,
+    iree_hal_allocator_statistics_t* out_delta) {
+  *out_delta = *after;
+#if IREE_STATISTICS_ENABLE
+  out_delta->host_bytes_allocated -= before->host_bytes_allocated;
+  out_delta->host_bytes_freed -= before->host_bytes_freed;
+  out_delta->device_bytes_allocated -= before->device_bytes_allocated;
+  out_delta->device_bytes_freed -= before->device_bytes_freed;
+  out_delta->allocation_count -= before->allocation_count;
+  out_delta->free_count -= before->free_count;
+  for (int i = 0; i < IREE_HAL_ALLOCATOR_STATISTICS_SIZE_BUCKET_COUNT; ++i) {
+    out_delta->size_histogram[i] -= before->size_histogram[i];
+  }
+  for (int i = 0; i < IREE_HAL_ALLOCATOR_USAGE_CATEGORY_COUNT; ++i) {
+    out_delta->usage[i].bytes_allocated -= before->usage[i].bytes_allocated;
+    out_delta->usage[i].bytes_freed -= before->usage[i].bytes_freed;
+  }
+  out_delta->map_count -= before->map_count;
+  out_delta->map_bytes -= before->map_bytes;
+  out_delta->flush_count -= before->flush_count;
+  out_delta->flush_bytes -= before->flush_bytes;
+  out_delta->invalidate_count -= before->invalidate_count;
+  out_delta->invalidate_bytes -= before->invalidate_bytes;
+#endif  // IREE_STATISTICS_ENABLE
+}
+
+// Prints the allocator activity of the timed repetitions in |delta|.
+static void iree_replay_benchmark_print_statistics(
+    FILE* file, const iree_hal_allocator_statistics_t* delta) {
+#if IREE_STATISTICS_ENABLE
+  fprintf(file,
+          "  allocator: %" PRIu64 " allocations (%" PRIu64
+          " host bytes, %" PRIu64 " device bytes), %" PRIu64 " frees, %" PRIu64
+          " maps\n",
+          delta->allocation_count, (uint64_t)delta->host_bytes_allocated,
+          (uint64_t)delta->device_bytes_allocated, delta->free_count,
+          delta->map_count);
+#endif  // IREE_STATISTICS_ENABLE
+}
+
+static void iree_replay_benchmark_print_summary(
+    FILE* file, const char* label, const iree_latency_summary_t* summary) {
+  fprintf(file,
+          "  %-32s p50 %9.3fms  p90 %9.3fms  p99 %9.3fms  p99.9 %9.3fms  "
+          "max %9.3fms  mean %9.3fms\n",
+          label, summary->p50 / 1e6, summary->p90 / 1e6, summary->p99 / 1e6,
+          summary->p999 / 1e6, summary->max / 1e6, summary->mean / 1e6);
+}
+
+// Creates in |out_context| a new context with the modules of the context
+// loaded by |replay|. Initializers run again such that all module state,
+// including objects that cannot be forked, starts as it did after loading.
+static iree_status_t iree_replay_benchmark_reload_context(
+    iree_trace_replay_t* replay, iree_vm_context_t** out_context) {
+  iree_host_size_t module_count = iree_vm_context_module_count(replay->context);
+  iree_vm_module_t** modules = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      replay->host_allocator, iree_max(1, module_count) * sizeof(*modules),
+      (void**)&modules));
+  for (iree_host_size_t i = 0; i < module_count; ++i) {
+    modules[i] = iree_vm_context_module_at(replay->context, i);
+  }
+  iree_status_t status = iree_vm_context_create_with_modules(
+      replay->instance, replay->context_flags, module_count, modules,
+      replay->host_allocator, out_context);
+  iree_allocator_free(replay->host_allocator, modules);
+  return status;
+}
+
+// Returns in |out_context| a context in the state the trace loaded it in.
+// Forks are preferred as they share immutable state with the loaded context.
+// If the program holds objects that cannot be forked in mutable globals the
+// context is reloaded instead and |inout_reload| is set so that subsequent
+// repetitions do not retry the fork.
+static iree_status_t iree_replay_benchmark_reset_context(
+    iree_trace_replay_t* replay, bool* inout_reload,
+    iree_vm_context_t** out_context) {
+  if (!*inout_reload) {
+    iree_status_t status = iree_vm_context_fork(
+        replay->context, replay->host_allocator, out_context);
+    if (!iree_status_is_failed_precondition(status)) return status;
+    iree_status_ignore(status);
+    *inout_reload = true;
+  }
+  return iree_replay_benchmark_reload_context(replay, out_context);
+}
+
+// Runs all calls in |call_list| once in trace order against |context|.
+// When |call_samples| is provided the latency of each call is recorded into
+// the corresponding entry and the latency of the full repetition into
+// |repetition_samples|.
+static iree_status_t iree_replay_benchmark_run_repetition(
+    iree_trace_replay_t* replay, iree_vm_context_t* context,
+    iree_replay_benchmark_call_list_t* call_list,
+    iree_latency_samples_t* call_samples,
+    iree_latency_samples_t* repetition_samples) {
+  iree_time_t repetition_start_ns = iree_time_now();
+  for (size_t i = 0; i < call_list->count; ++i) {
+    iree_replay_benchmark_call_t* call = &call_list->items[i];
+    iree_time_t call_start_ns = iree_time_now();
+    IREE_RETURN_IF_ERROR(iree_vm_invoke(
+        context, call->function, IREE_VM_INVOCATION_FLAG_NONE,
+        /*policy=*/NULL, call->input_list, call->output_list,
+        replay->host_allocator));
+    iree_time_t call_end_ns = iree_time_now();
+    IREE_RETURN_IF_ERROR(iree_vm_list_resize(call->output_list, 0));
+    if (call_samples) {
+      IREE_RETURN_IF_ERROR(iree_latency_samples_append(
+          &call_samples[i], call_end_ns - call_start_ns));
+    }
+  }
+  if (repetition_samples) {
+    IREE_RETURN_IF_ERROR(iree_latency_samples_append(
+        repetition_samples, iree_time_now() - repetition_start_ns));
+  }
+  return iree_ok_status();
+}
+
+// Replays the trace file of |registration| --replay_repetitions times and
+// reports the results to |report_file| and as a JSON object to
+// |json_builder|.
+static iree_status_t iree_replay_benchmark_replay_file(
+    const iree_replay_benchmark_registration_t* registration,
+    FILE* report_file, iree_string_builder_t* json_builder) {
+  iree_trace_replay_t replay;
+  iree_replay_benchmark_call_list_t call_list;
+  IREE_RETURN_IF_ERROR(
+      iree_replay_benchmark_setup(registration, &replay, &call_list));
+
+  iree_latency_samples_t repetition_samples;
+  iree_latency_samples_initialize(replay.host_allocator, &repetition_samples);
+  iree_latency_samples_t* call_samples = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      replay.host_allocator,
+      iree_max(1, call_list.count) * sizeof(*call_samples),
+      (void**)&call_samples);
+  for (size_t i = 0; i < call_list.count && iree_status_is_ok(status); ++i) {
+    iree_latency_samples_initialize(replay.host_allocator, &call_samples[i]);
+  }
+
+  // Replay the trace; only repetitions after the warmup are recorded.
+  // Allocator statistics are snapshotted once the warmup has drained so that
+  // only the allocations made by the timed repetitions are reported.
+  iree_hal_allocator_statistics_t baseline_statistics;
+  memset(&baseline_statistics, 0, sizeof(baseline_statistics));
+  bool reload_context = false;
+  const int32_t total_repetitions =
+      iree_max(0, FLAG_replay_warmup) + FLAG_replay_repetitions;
+  for (int32_t i = 0; i < total_repetitions && iree_status_is_ok(status);
+       ++i) {
+    const bool is_timed = i >= total_repetitions - FLAG_replay_repetitions;
+    if (i == total_repetitions - FLAG_replay_repetitions) {
+      status =
+          iree_hal_device_wait_idle(replay.device, iree_infinite_timeout());
+      if (!iree_status_is_ok(status)) break;
+      iree_hal_allocator_query_statistics(
+          iree_hal_device_allocator(replay.device), &baseline_statistics);
+    }
+    iree_vm_context_t* context = replay.context;
+    if (FLAG_replay_reset_state) {
+      status = iree_replay_benchmark_reset_context(&replay, &reload_context,
+                                                   &context);
+    } else {
+      iree_vm_context_retain(context);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_replay_benchmark_run_repetition(
+          &replay, context, &call_list, is_timed ? call_samples : NULL,
+          is_timed ? &repetition_samples : NULL);
+      iree_vm_context_release(context);
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_device_wait_idle(replay.device, iree_infinite_timeout());
+  }
+
+  iree_hal_allocator_statistics_t statistics;
+  if (iree_status_is_ok(status)) {
+    iree_hal_allocator_statistics_t final_statistics;
+    iree_hal_allocator_query_statistics(
+        iree_hal_device_allocator(replay.device), &final_statistics);
+    iree_replay_benchmark_subtract_statistics(
+        &final_statistics, &baseline_statistics, &statistics);
+  }
+
+  // Human-readable report.
+  if (iree_status_is_ok(status)) {
+    iree_latency_summary_t summary;
+    iree_latency_samples_summarize(&repetition_samples, &summary);
+    fprintf(report_file,
+            "Trace '%.*s': %d repetitions (%d warmup), %" PRIhsz " calls\n",
+            (int)registration->file_path.size, registration->file_path.data,
+            FLAG_replay_repetitions, iree_max(0, FLAG_replay_warmup),
+            call_list.count);
+    iree_replay_benchmark_print_summary(report_file, "(repetition)",
+                                        &summary);
+    for (size_t i = 0; i < call_list.count; ++i) {
+      iree_latency_samples_summarize(&call_samples[i], &summary);
+      iree_string_view_t function_name =
+          iree_vm_function_name(&call_list.items[i].function);
+      char label[64];
+      snprintf(label, sizeof(label), "[%" PRIhsz "] %.*s", i,
+               (int)function_name.size, function_name.data);
+      iree_replay_benchmark_print_summary(report_file, label, &summary);
+    }
+    iree_replay_benchmark_print_statistics(report_file, &statistics);
+    if (reload_context) {
+      fprintf(report_file,
+              "  state reset by reloading the context (mutable globals could "
+              "not be forked)\n");
+    }
+  }
+
+  // Machine-readable report.
+  if (iree_status_is_ok(status) && json_builder) {
+    iree_latency_summary_t summary;
+    iree_latency_samples_summarize(&repetition_samples, &summary);
+    status = iree_string_builder_append_cstring(json_builder,
+                                                "{\"trace\": ");
+    if (iree_status_is_ok(status)) {
+      status = iree_replay_benchmark_append_json_string(
+          json_builder, registration->file_path);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_string_builder_append_format(
+          json_builder,
+          ", \"repetitions\": %d, \"warmup\": %d, \"reset_state\": %s"
+          ", \"reset_by_reload\": %s, \"repetition_latency\": ",
+          FLAG_replay_repetitions, iree_max(0, FLAG_replay_warmup),
+          FLAG_replay_reset_state ? "true" : "false",
+          reload_context ? "true" : "false");
+    }
+    if (iree_status_is_ok(status)) {
+      status =
+          iree_replay_benchmark_append_json_summary(json_builder, &summary);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_string_builder_append_cstring(json_builder,
+                                                  ", \"calls\": [");
+    }
+    for (size_t i = 0; i < call_list.count && iree_status_is_ok(status); ++i) {
+      const iree_vm_function_t* function = &call_list.items[i].function;
+      iree_latency_samples_summarize(&call_samples[i], &summary);
+      status = iree_string_builder_append_format(
+          json_builder, "%s{\"index\": %" PRIhsz ", \"module\": ",
+          i ? ", " : "", i);
+      if (iree_status_is_ok(status)) {
+        status = iree_replay_benchmark_append_json_string(
+            json_builder, iree_vm_module_name(function->module));
+      }
+      if (iree_status_is_ok(status)) {
+        status = iree_string_builder_append_cstring(json_builder,
+                                                    ", \"function\": ");
+      }
+      if (iree_status_is_ok(status)) {
+        status = iree_replay_benchmark_append_json_string(
+            json_builder, iree_vm_function_name(function));
+      }
+      if (iree_status_is_ok(status)) {
+        status = iree_string_builder_append_cstring(json_builder,
+                                                    ", \"latency\": ");
+      }
+      if (iree_status_is_ok(status)) {
+        status =
+            iree_replay_benchmark_append_json_summary(json_builder, &summary);
+      }
+      if (iree_status_is_ok(status)) {
+        status = iree_string_builder_append_cstring(json_builder, "}");
+      }
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_string_builder_append_cstring(
+          json_builder, "], \"allocator_statistics\": ");
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_replay_benchmark_append_json_statistics(json_builder,
+                                                            &statistics);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_string_builder_append_cstring(json_builder, "}");
+    }
+  }
+
+  for (size_t i = 0; call_samples && i < call_list.count; ++i) {
+    iree_latency_samples_deinitialize(&call_samples[i]);
+  }
+  iree_allocator_free(replay.host_allocator, call_samples);
+  iree_latency_samples_deinitialize(&repetition_samples);
+  iree_replay_benchmark_call_list_deinitialize(&call_list);
+  iree_trace_replay_deinitialize(
+      &replay, FLAG_print_statistics
+                   ? IREE_TRACE_REPLAY_SHUTDOWN_PRINT_STATISTICS
+                   : IREE_TRACE_REPLAY_SHUTDOWN_QUIET);
+  return status;
+}
+
+// Replays each trace file and writes the JSON results if requested.
+static iree_status_t iree_replay_benchmark_replay_trace_files(
+    int file_count, char** file_paths, iree_vm_instance_t* instance) {
+  const bool emit_json = strlen(FLAG_replay_json) > 0;
+  const bool json_to_stdout = strcmp(FLAG_replay_json, "-") == 0;
+  // Keep stdout clean for the JSON when it is written there.
+  FILE* report_file = json_to_stdout ? stderr : stdout;
+
+  iree_string_builder_t json_builder;
+  iree_string_builder_initialize(iree_allocator_system(), &json_builder);
+  iree_status_t status =
+      iree_string_builder_append_cstring(&json_builder, "{\"traces\": [");
+  for (int i = 0; i < file_count && iree_status_is_ok(status); ++i) {
+    iree_string_view_t file_path = iree_make_cstring_view(file_paths[i]);
+    iree_replay_benchmark_registration_t registration;
+    memset(&registration, 0, sizeof(registration));
+    registration.root_path = iree_file_path_dirname(file_path);
+    registration.file_path = file_path;
+    registration.instance = instance;
+    if (i > 0) {
+      status = iree_string_builder_append_cstring(&json_builder, ", ");
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_replay_benchmark_replay_file(
+          &registration, report_file, emit_json ? &json_builder : NULL);
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_string_builder_append_cstring(&json_builder, "]}\n");
+  }
+
+  if (iree_status_is_ok(status) && emit_json) {
+    FILE* file = json_to_stdout ? stdout : fopen(FLAG_replay_json, "wb");
+    if (!file) {
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "failed to open JSON output file '%s'",
+                                FLAG_replay_json);
+    } else {
+      fwrite(iree_string_builder_buffer(&json_builder), 1,
+             iree_string_builder_size(&json_builder), file);
+      if (!json_to_stdout) fclose(file);
+    }
+  }
+
+  iree_string_builder_deinitialize(&json_builder);
+  return status;
+}
+
 // Registers benchmarks for each trace file.
 static void iree_replay_benchmark_register_trace_files(
     int file_count, char** file_paths, iree_vm_instance_t* instance) {
@@ -283,10 +748,22 @@ int main(int argc, char** argv) {
   iree_vm_instance_t* instance = NULL;
   IREE_CHECK_OK(iree_vm_instance_create(iree_allocator_system(), &instance));
 
-  // Register a benchmark per file provided and run them.
-  iree_replay_benchmark_register_trace_files(argc - 1, argv + 1, instance);
-  iree_benchmark_run_specified();
+  int exit_code = 0;
+  if (FLAG_replay_repetitions > 0) {
+    // Replay each file provided and report the results.
+    iree_status_t status = iree_replay_benchmark_replay_trace_files(
+        argc - 1, argv + 1, instance);
+    if (!iree_status_is_ok(status)) {
+      iree_status_fprint(stderr, status);
+      exit_code = (int)iree_status_code(status);
+      iree_status_free(status);
+    }
+  } else {
+    // Register a benchmark per file provided and run them.
+    iree_replay_benchmark_register_trace_files(argc - 1, argv + 1, instance);
+    iree_benchmark_run_specified();
+  }
 
   iree_vm_instance_release(instance);
-  return 0;
+  return exit_code;
 }
@@ -98,9 +98,9 @@ iree_status_t Run(std::string module_file_path, int* out_exit_code) {
     IREE_RETURN_IF_ERROR(iree_stdin_read_contents(iree_allocator_system(),
                                                   &flatbuffer_contents));
   } else {
-    IREE_RETURN_IF_ERROR(iree_file_read_contents(module_file_path.c_str(),
-                                                 iree_allocator_system(),
-                                                 &flatbuffer_contents));
+    IREE_RETURN_IF_ERROR(iree_file_read_contents_with_flags(
+        module_file_path.c_str(), IREE_FILE_READ_FLAG_MMAP,
+        iree_allocator_system(), &flatbuffer_contents));
   }
 
   iree_vm_module_t* input_module = nullptr;
@@ -114,7 +114,8 @@ iree_status_t Run(std::string module_file_path, int* out_exit_code) {
       iree_hal_default_device_uri(), iree_allocator_system(), &device));
   iree_vm_module_t* hal_module = nullptr;
   IREE_RETURN_IF_ERROR(
-      iree_hal_module_create(device, iree_allocator_system(), &hal_module));
+      iree_hal_module_create(device, IREE_HAL_MODULE_FLAG_NONE,
+                             iree_allocator_system(), &hal_module));
   iree_vm_module_t* check_module = nullptr;
   IREE_RETURN_IF_ERROR(
       iree_check_module_create(iree_allocator_system(), &check_module));
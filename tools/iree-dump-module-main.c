@@ -24,8 +24,9 @@ int main(int argc, char** argv) {
   }
 
   iree_file_contents_t* file_contents = NULL;
-  IREE_CHECK_OK(iree_file_read_contents(argv[1], iree_allocator_system(),
-                                        &file_contents));
+  IREE_CHECK_OK(iree_file_read_contents_with_flags(
+      argv[1], IREE_FILE_READ_FLAG_MMAP, iree_allocator_system(),
+      &file_contents));
 
   iree_const_byte_span_t flatbuffer_contents = iree_const_byte_span_empty();
   IREE_CHECK_OK(iree_vm_bytecode_module_parse_header(
@@ -20,9 +20,9 @@
 #include "iree/hal/api.h"
 #include "iree/modules/hal/module.h"
 #include "iree/tooling/device_util.h"
+#include "iree/tooling/module_util.h"
 #include "iree/tooling/vm_util.h"
 #include "iree/vm/api.h"
-#include "iree/vm/bytecode_module.h"
 #include "iree/vm/ref_cc.h"
 
 IREE_FLAG(string, module_file, "-",
@@ -40,7 +40,16 @@ IREE_FLAG(int32_t, print_max_element_count, 1024,
           "eliding the remainder.");
 
 IREE_FLAG(bool, print_statistics, false,
-          "Prints runtime statistics to stderr on exit.");
+          "Prints runtime statistics and any live buffers to stderr on exit.");
+
+IREE_FLAG(bool, print_vm_profile, false,
+          "Prints the VM instruction profile to stderr on exit. Requires a "
+          "runtime built with -DIREE_VM_EXECUTION_PROFILING_ENABLE=1.");
+
+IREE_FLAG(bool, hal_module_async, false,
+          "Creates the HAL module with IREE_HAL_MODULE_FLAG_ASYNCHRONOUS such "
+          "that semaphore waits yield to the invocation instead of blocking "
+          "inside the HAL module.");
 
 static iree_status_t parse_function_input(iree_string_view_t flag_name,
                                           void* storage,
@@ -87,8 +96,9 @@ iree_status_t GetModuleContentsFromFlags(iree_file_contents_t** out_contents) {
     std::cout << "Reading module contents from stdin...\n";
     return iree_stdin_read_contents(iree_allocator_system(), out_contents);
   } else {
-    return iree_file_read_contents(module_file.c_str(), iree_allocator_system(),
-                                   out_contents);
+    return iree_file_read_contents_with_flags(
+        module_file.c_str(), IREE_FILE_READ_FLAG_MMAP, iree_allocator_system(),
+        out_contents);
   }
 }
 
@@ -105,7 +115,7 @@ iree_status_t Run() {
   iree_file_contents_t* flatbuffer_contents = NULL;
   IREE_RETURN_IF_ERROR(GetModuleContentsFromFlags(&flatbuffer_contents));
   iree_vm_module_t* input_module = nullptr;
-  IREE_RETURN_IF_ERROR(iree_vm_bytecode_module_create(
+  IREE_RETURN_IF_ERROR(iree_tooling_create_module_from_flags(
       flatbuffer_contents->const_buffer,
       iree_file_contents_deallocator(flatbuffer_contents),
       iree_allocator_system(), &input_module));
@@ -115,7 +125,11 @@ iree_status_t Run() {
       iree_hal_default_device_uri(), iree_allocator_system(), &device));
   iree_vm_module_t* hal_module = nullptr;
   IREE_RETURN_IF_ERROR(
-      iree_hal_module_create(device, iree_allocator_system(), &hal_module));
+      iree_hal_module_create(device,
+                             FLAG_hal_module_async
+                                 ? IREE_HAL_MODULE_FLAG_ASYNCHRONOUS
+                                 : IREE_HAL_MODULE_FLAG_NONE,
+                             iree_allocator_system(), &hal_module));
 
   iree_vm_context_t* context = nullptr;
   // Order matters. The input module will likely be dependent on the hal module.
@@ -123,8 +137,10 @@ iree_status_t Run() {
   IREE_RETURN_IF_ERROR(
       iree_vm_context_create_with_modules(
           instance,
-          FLAG_trace_execution ? IREE_VM_CONTEXT_FLAG_TRACE_EXECUTION
-                               : IREE_VM_CONTEXT_FLAG_NONE,
+          (FLAG_trace_execution ? IREE_VM_CONTEXT_FLAG_TRACE_EXECUTION
+                                : IREE_VM_CONTEXT_FLAG_NONE) |
+              (FLAG_print_vm_profile ? IREE_VM_CONTEXT_FLAG_PROFILE_EXECUTION
+                                     : IREE_VM_CONTEXT_FLAG_NONE),
           modules.size(), modules.data(), iree_allocator_system(), &context),
       "creating context");
 
@@ -164,6 +180,16 @@ iree_status_t Run() {
       PrintVariantList(outputs.get(), (size_t)FLAG_print_max_element_count),
       "printing results");
 
+  if (FLAG_print_vm_profile) {
+    iree_vm_profile_t* profile = iree_vm_context_profile(context);
+    if (profile) {
+      IREE_IGNORE_ERROR(
+          iree_vm_profile_fprint(stderr, profile, /*top_count=*/32));
+    } else {
+      fprintf(stderr, "VM execution profiling not available in this build\n");
+    }
+  }
+
   inputs.reset();
   outputs.reset();
   iree_vm_module_release(hal_module);
@@ -20,7 +20,7 @@
 IREE_FLAG(bool, trace_execution, false, "Traces VM execution to stderr.");
 
 IREE_FLAG(bool, print_statistics, false,
-          "Prints runtime statistics to stderr on exit.");
+          "Prints runtime statistics and any live buffers to stderr on exit.");
 
 // Runs the trace in |file| using |root_path| as the base for any path lookups
 // required for external files referenced in |file|.
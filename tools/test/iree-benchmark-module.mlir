@@ -1,8 +1,24 @@
 // RUN: iree-compile --iree-hal-target-backends=vmvx %s | iree-benchmark-module --device=local-task --entry_function=abs --function_input=f32=-2 | FileCheck %s
 // RUN: [[ $IREE_VULKAN_DISABLE == 1 ]] || (iree-compile --iree-hal-target-backends=vulkan-spirv %s | iree-benchmark-module --device=vulkan --entry_function=abs --function_input=f32=-2 | FileCheck %s)
 // RUN: iree-compile --iree-hal-target-backends=dylib-llvm-aot %s | iree-benchmark-module --device=local-task --entry_function=abs --function_input=f32=-2 | FileCheck %s
+// RUN: iree-compile --iree-hal-target-backends=vmvx %s | iree-benchmark-module --device=local-task --entry_function=abs --function_input=f32=-2 --load_concurrency=2 --load_rate=200 --load_duration=0.25 --load_report_interval=0.1 | FileCheck --check-prefix=LOAD %s
+// RUN: iree-compile --iree-hal-target-backends=vmvx %s | (iree-benchmark-module --device=local-task --entry_function=abs --function_input=f32=-2 --load_concurrency=1 --load_rate=0 || [[ $? == 3 ]]) | FileCheck --check-prefix=LOAD-RATE %s
 
 // CHECK-LABEL: BM_abs
+
+// LOAD: Open-loop load test: 2 callers, 200.000 req/s target over 0.250s
+// LOAD-NEXT: requests 50 completed in
+// LOAD-NEXT: latency p50 {{.*}} max
+// LOAD-NEXT: queueing p50 {{.*}} max
+// LOAD-NEXT: service p50 {{.*}} max
+// LOAD-NEXT: interval arrivals done req/s p50 ms p99 ms queue avg ms queue max ms
+// LOAD-NEXT: 0.000s 20
+// LOAD-NEXT: 0.100s 20
+// LOAD-NEXT: 0.200s 10
+// LOAD-NOT: BM_abs
+
+// LOAD-RATE: --load_rate and --load_duration must be > 0
+
 func.func @abs(%input : tensor<f32>) -> (tensor<f32>) {
   %result = math.abs %input : tensor<f32>
   return %result : tensor<f32>
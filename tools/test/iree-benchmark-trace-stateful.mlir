@@ -0,0 +1,35 @@
+// RUN: mkdir -p %t && \
+// RUN:   iree-compile --iree-hal-target-backends=vmvx %s -o %t/module.vmfb && \
+// RUN:   printf 'type: context_load\n---\ntype: module_load\nmodule:\n  name: hal\n  type: builtin\n---\ntype: module_load\nmodule:\n  name: module\n  type: bytecode\n  path: module.vmfb\n---\ntype: call\nfunction: module.increment\n' > %t/trace.yml && \
+// RUN:   iree-benchmark-trace --device=local-task --replay_repetitions=4 --replay_warmup=2 %t/trace.yml | FileCheck %s
+// RUN: iree-benchmark-trace --device=local-task --replay_repetitions=4 --replay_warmup=2 --replay_json=- %t/trace.yml 2>/dev/null | FileCheck --check-prefix=JSON %s
+// RUN: (iree-benchmark-trace --device=local-task --replay_repetitions=4 --replay_warmup=0 --replay_reset_state=false %t/trace.yml 2>&1 || true) | FileCheck --check-prefix=CARRY %s
+
+// The counter is held in a HAL buffer in a mutable global which prevents
+// forking. Each repetition must still observe the counter as initialized.
+
+// CHECK: Trace '{{.*}}trace.yml': 4 repetitions (2 warmup), 1 calls
+// CHECK: [0] increment p50 {{.*}} max
+// CHECK: state reset by reloading the context
+
+// JSON: "reset_state": true, "reset_by_reload": true, "repetition_latency": {"count": 4,
+
+// Without resetting the second repetition observes the first's increment.
+// CARRY: repetition did not start from the loaded state
+
+util.global private mutable @counter = dense<0> : tensor<i32>
+
+func.func @increment() -> tensor<i32> {
+  %counter = util.global.load @counter : tensor<i32>
+  %value = tensor.extract %counter[] : tensor<i32>
+  %c0 = arith.constant 0 : i32
+  %c9 = arith.constant 9 : i32
+  %is_initial = arith.cmpi eq, %value, %c0 : i32
+  // 9 = IREE_STATUS_FAILED_PRECONDITION
+  %status = arith.select %is_initial, %c0, %c9 : i32
+  util.status.check_ok %status, "repetition did not start from the loaded state"
+  %c1 = arith.constant dense<1> : tensor<i32>
+  %result = arith.addi %counter, %c1 : tensor<i32>
+  util.global.store %result, @counter : tensor<i32>
+  return %result : tensor<i32>
+}
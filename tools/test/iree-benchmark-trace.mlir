@@ -0,0 +1,22 @@
+// RUN: mkdir -p %t && \
+// RUN:   iree-compile --iree-hal-target-backends=vmvx %s -o %t/module.vmfb && \
+// RUN:   printf 'type: context_load\n---\ntype: module_load\nmodule:\n  name: hal\n  type: builtin\n---\ntype: module_load\nmodule:\n  name: module\n  type: bytecode\n  path: module.vmfb\n---\ntype: call\nfunction: module.abs\nargs:\n- !hal.buffer_view f32=-2\n' > %t/trace.yml && \
+// RUN:   iree-benchmark-trace --device=local-task --replay_repetitions=4 --replay_warmup=2 %t/trace.yml | FileCheck %s
+// RUN: iree-benchmark-trace --device=local-task --replay_repetitions=4 --replay_warmup=2 --replay_json=- %t/trace.yml 2>/dev/null | FileCheck --check-prefix=JSON %s
+// RUN: iree-benchmark-trace --device=local-task --replay_repetitions=3 --replay_reset_state=false --replay_json=%t/results.json %t/trace.yml && \
+// RUN:   FileCheck --check-prefix=JSON-FILE %s < %t/results.json
+
+// CHECK: Trace '{{.*}}trace.yml': 4 repetitions (2 warmup), 1 calls
+// CHECK-NEXT: (repetition) p50 {{.*}} max
+// CHECK-NEXT: [0] abs p50 {{.*}} max
+
+// JSON: {"traces": [{"trace": "{{.*}}trace.yml", "repetitions": 4, "warmup": 2, "reset_state": true, "reset_by_reload": false, "repetition_latency": {"count": 4,
+// JSON-SAME: "calls": [{"index": 0, "module": "module", "function": "abs", "latency": {"count": 4,
+// JSON-SAME: "allocator_statistics":
+
+// JSON-FILE: "repetitions": 3, "warmup": 1, "reset_state": false, "reset_by_reload": false, "repetition_latency": {"count": 3,
+
+func.func @abs(%input : tensor<f32>) -> (tensor<f32>) {
+  %result = math.abs %input : tensor<f32>
+  return %result : tensor<f32>
+}